@@ -0,0 +1,170 @@
+/**
+ * @file    bin_report.c
+ *
+ * @brief   Compact binary framing of FiRa ranging results
+ *
+ *          Replaces the per-measurement snprintf() JSON output of report_cb()
+ *          when selected with the BINREP command. Frames are decoded on the
+ *          host by tools/bin_report_decode.py.
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <string.h>
+#include "bin_report.h"
+#include "crc16.h"
+#include "debug_config.h"
+
+static inline uint8_t *put_u8(uint8_t *p, uint8_t v)
+{
+    *p++ = v;
+    return p;
+}
+
+static inline uint8_t *put_le16(uint8_t *p, uint16_t v)
+{
+    *p++ = (uint8_t)(v);
+    *p++ = (uint8_t)(v >> 8);
+    return p;
+}
+
+static inline uint8_t *put_le32(uint8_t *p, uint32_t v)
+{
+    *p++ = (uint8_t)(v);
+    *p++ = (uint8_t)(v >> 8);
+    *p++ = (uint8_t)(v >> 16);
+    *p++ = (uint8_t)(v >> 24);
+    return p;
+}
+
+/* @brief writes sync/type/length in front of the payload and the CRC16 after it
+ * @return total frame length
+ * */
+static uint16_t frame_seal(uint8_t *frame, bin_report_type_e type, uint16_t payload_len)
+{
+    uint8_t *p = frame;
+    uint16_t crc;
+
+    p = put_u8(p, BIN_REPORT_SYNC0);
+    p = put_u8(p, BIN_REPORT_SYNC1);
+    p = put_u8(p, (uint8_t)type);
+    p = put_le16(p, payload_len);
+
+    /* CRC covers everything after the sync bytes */
+    crc = calc_crc16(&frame[2], (uint16_t)(BIN_REPORT_HDR_LEN - 2 + payload_len));
+    put_le16(&frame[BIN_REPORT_HDR_LEN + payload_len], crc);
+
+    return (uint16_t)(BIN_REPORT_HDR_LEN + payload_len + BIN_REPORT_CRC_LEN);
+}
+
+bool bin_report_is_enabled(void)
+{
+    return (get_debug_config()->binReportEn != 0);
+}
+
+uint16_t bin_report_encode_block(uint8_t *frame, uint16_t max_len,
+                                 const struct ranging_results *results,
+                                 const bin_report_diag_t *diag, bool is_responder)
+{
+    int n = results->n_measurements;
+    uint16_t payload_len;
+    uint8_t flags = 0;
+    uint8_t *p;
+
+    if (n < 0)
+    {
+        n = 0;
+    }
+    if (n > FIRA_CONTROLEES_MAX)
+    {
+        n = FIRA_CONTROLEES_MAX;
+    }
+
+    payload_len = (uint16_t)(BIN_REPORT_BLOCK_HDR_LEN + n * BIN_REPORT_MEAS_LEN);
+
+    if (max_len < BIN_REPORT_HDR_LEN + payload_len + BIN_REPORT_CRC_LEN)
+    {
+        return 0;
+    }
+
+    if (diag && diag->valid)
+    {
+        flags |= BIN_REPORT_FLAG_DIAG;
+    }
+    if (is_responder)
+    {
+        flags |= BIN_REPORT_FLAG_RESPONDER;
+    }
+
+    p = &frame[BIN_REPORT_HDR_LEN];
+    p = put_le32(p, results->block_index);
+    p = put_u8(p, (uint8_t)n);
+    p = put_u8(p, flags);
+    p = put_le16(p, (uint16_t)((flags & BIN_REPORT_FLAG_DIAG) ? diag->rssi_ddbm : 0));
+    p = put_u8(p, (flags & BIN_REPORT_FLAG_DIAG) ? diag->nlos_pct : 0);
+    p = put_u8(p, BIN_REPORT_VERSION);
+    p = put_le16(p, (uint16_t)(int16_t)(diag ? diag->cfo : 0));
+
+    for (int i = 0; i < n; i++)
+    {
+        const struct ranging_measurements *rm = &results->measurements[i];
+
+        p = put_le16(p, rm->short_addr);
+        p = put_u8(p, rm->status);
+        p = put_u8(p, rm->slot_index);
+        p = put_le32(p, (uint32_t)rm->distance_mm);
+        p = put_le16(p, (uint16_t)rm->local_aoa_measurements[0].pdoa_2pi);
+        p = put_le16(p, (uint16_t)rm->local_aoa_measurements[0].aoa_2pi);
+        p = put_le16(p, (uint16_t)rm->remote_aoa_azimuth_2pi);
+        p = put_u8(p, rm->local_aoa_measurements[0].aoa_fom);
+        p = put_u8(p, rm->remote_aoa_azimuth_fom);
+        p = put_u8(p, rm->rssi);
+        p = put_u8(p, (uint8_t)rm->sp1_data_len);
+        p = put_le16(p, (uint16_t)rm->payload_seq_sent);
+    }
+
+    return frame_seal(frame, BIN_REPORT_TYPE_BLOCK, payload_len);
+}
+
+uint16_t bin_report_encode_stop(uint8_t *frame, uint16_t max_len,
+                                uint32_t block_index, uint8_t stopped_reason)
+{
+    uint8_t *p;
+
+    if (max_len < BIN_REPORT_HDR_LEN + BIN_REPORT_STOP_LEN + BIN_REPORT_CRC_LEN)
+    {
+        return 0;
+    }
+
+    p = &frame[BIN_REPORT_HDR_LEN];
+    p = put_le32(p, block_index);
+    p = put_u8(p, stopped_reason);
+    p = put_u8(p, BIN_REPORT_VERSION);
+
+    return frame_seal(frame, BIN_REPORT_TYPE_STOP, BIN_REPORT_STOP_LEN);
+}
+
+uint16_t bin_report_encode_log(uint8_t *frame, uint16_t max_len, uint32_t fmt_id,
+                               uint8_t module, uint8_t level,
+                               const uint32_t *args, int n_args)
+{
+    uint16_t payload_len = (uint16_t)(BIN_REPORT_LOG_HDR_LEN + n_args * 4);
+    uint8_t *p;
+
+    if (max_len < BIN_REPORT_HDR_LEN + payload_len + BIN_REPORT_CRC_LEN)
+    {
+        return 0;
+    }
+
+    p = &frame[BIN_REPORT_HDR_LEN];
+    p = put_le32(p, fmt_id);
+    p = put_u8(p, module);
+    p = put_u8(p, level);
+    for (int i = 0; i < n_args; i++)
+    {
+        p = put_le32(p, args[i]);
+    }
+
+    return frame_seal(frame, BIN_REPORT_TYPE_LOG, payload_len);
+}
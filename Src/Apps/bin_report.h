@@ -0,0 +1,108 @@
+/**
+ * @file    bin_report.h
+ *
+ * @brief   Compact binary framing of FiRa ranging results
+ *
+ *          Frame layout, all multi-byte fields little-endian:
+ *
+ *          offset  size  field
+ *          0       2     sync, BIN_REPORT_SYNC0 BIN_REPORT_SYNC1
+ *          2       1     frame type, bin_report_type_e
+ *          3       2     payload length N
+ *          5       N     payload
+ *          5+N     2     CRC16 (calc_crc16) over type, length and payload
+ *
+ *          BIN_REPORT_TYPE_BLOCK payload is a block header followed by
+ *          n_measurements fixed-size measurement records, see below.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef BIN_REPORT_H
+#define BIN_REPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fira_helper.h"
+
+#define BIN_REPORT_SYNC0            0xA5
+#define BIN_REPORT_SYNC1            0x5A
+#define BIN_REPORT_VERSION          1
+
+#define BIN_REPORT_HDR_LEN          5   /**< sync + type + length */
+#define BIN_REPORT_CRC_LEN          2
+#define BIN_REPORT_BLOCK_HDR_LEN    12  /**< block header, see bin_report_encode_block() */
+#define BIN_REPORT_MEAS_LEN         20  /**< one measurement record */
+#define BIN_REPORT_STOP_LEN         6   /**< block index + reason + version */
+#define BIN_REPORT_LOG_HDR_LEN      6   /**< format id + module + level, then 4 bytes per argument */
+
+#define BIN_REPORT_BLOCK_FRAME_LEN(n) (BIN_REPORT_HDR_LEN + BIN_REPORT_BLOCK_HDR_LEN + \
+                                       (n) * BIN_REPORT_MEAS_LEN + BIN_REPORT_CRC_LEN)
+#define BIN_REPORT_MAX_FRAME        BIN_REPORT_BLOCK_FRAME_LEN(FIRA_CONTROLEES_MAX)
+
+typedef enum {
+    BIN_REPORT_TYPE_BLOCK = 1,  /**< Ranging block results */
+    BIN_REPORT_TYPE_STOP = 2,   /**< Session stopped */
+    BIN_REPORT_TYPE_LOG = 3,    /**< Deferred log line, see dlog.h */
+} bin_report_type_e;
+
+/* Block header flags */
+#define BIN_REPORT_FLAG_DIAG        0x01 /**< rssi/nlos fields are valid */
+#define BIN_REPORT_FLAG_RESPONDER   0x02 /**< frame produced by a controlee */
+
+/**
+ * @brief Per-block diagnostic snapshot, taken once by the caller
+ */
+typedef struct {
+    bool valid;         /**< Diagnostics enabled and read */
+    int16_t rssi_ddbm;  /**< RSSI in 0.1 dBm units */
+    uint8_t nlos_pct;   /**< Non line of sight probability, % */
+    int32_t cfo;        /**< Clock offset, same units as the JSON "CFO_100ppm" */
+} bin_report_diag_t;
+
+/**
+ * @brief Check if the binary report mode is selected (BINREP command)
+ */
+bool bin_report_is_enabled(void);
+
+/**
+ * @brief Serialize one ranging block into a frame
+ *
+ * Block header (BIN_REPORT_BLOCK_HDR_LEN):
+ *   u32 block_index, u8 n_measurements, u8 flags, i16 rssi_ddbm,
+ *   u8 nlos_pct, u8 version, i16 cfo
+ *
+ * Measurement record (BIN_REPORT_MEAS_LEN):
+ *   u16 short_addr, u8 status, u8 slot_index, i32 distance_mm,
+ *   i16 local_pdoa_2pi, i16 local_aoa_2pi, i16 remote_aoa_azimuth_2pi,
+ *   u8 local_aoa_fom, u8 remote_aoa_azimuth_fom, u8 rssi, u8 sp1_data_len,
+ *   u16 payload_seq_sent (low 16 bits)
+ *
+ * @return frame length, or 0 if it does not fit in max_len
+ */
+uint16_t bin_report_encode_block(uint8_t *frame, uint16_t max_len,
+                                 const struct ranging_results *results,
+                                 const bin_report_diag_t *diag, bool is_responder);
+
+/**
+ * @brief Serialize a "session stopped" notification into a frame
+ *
+ * @return frame length, or 0 if it does not fit in max_len
+ */
+uint16_t bin_report_encode_stop(uint8_t *frame, uint16_t max_len,
+                                uint32_t block_index, uint8_t stopped_reason);
+
+/**
+ * @brief Serialize a deferred log line into a frame
+ *
+ * Payload: u32 format string address, u8 module, u8 level,
+ *          n_args x u32 arguments
+ *
+ * @return frame length, or 0 if it does not fit in max_len
+ */
+uint16_t bin_report_encode_log(uint8_t *frame, uint16_t max_len, uint32_t fmt_id,
+                               uint8_t module, uint8_t level,
+                               const uint32_t *args, int n_args);
+
+#endif /* BIN_REPORT_H */
@@ -55,8 +55,10 @@
 #include "nrfx_gpiote.h"
 #include <FreeRTOS.h>
 #include <timers.h>
+#include <stdio.h>
 #include <string.h>
 #include "reporter.h"
+#include "HAL_rtc.h"
 
 /* Button configuration */
 static const uint32_t button_pins[BUTTON_NUM] = {
@@ -66,40 +68,103 @@ static const uint32_t button_pins[BUTTON_NUM] = {
 
 /* Button state tracking */
 static struct {
-    bool pressed;
-    uint8_t debounce_count;
+    bool pressed;           /* debounced state */
+    volatile bool armed;    /* lockout timer running, further edges are bounces */
+    uint32_t t_edge;        /* Rtc ticks, first edge of the pending change */
+    uint32_t t_confirm;     /* Rtc ticks, last change confirmed */
 } button_state[BUTTON_NUM];
 
-/* Periodic timer to run debouncing */
-static TimerHandle_t button_timer = NULL;
+/* One-shot lockout timer per button, the timer ID is the button */
+static TimerHandle_t button_timer[BUTTON_NUM];
 
-/* Debounce counter threshold (in ms, assuming process called every 5ms) */
-#define DEBOUNCE_THRESHOLD 10
+static button_stats_t button_stats;
 
 /* Event callback */
 static button_event_callback_t button_callback = NULL;
 
 /**
  * @brief GPIOTE event handler for buttons
+ *
+ * The first edge stamps the change and arms the lockout timer, the edges
+ * that follow while it runs are bounces.
  */
 static void gpiote_event_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
 {
+    BaseType_t woken = pdFALSE;
+
+    (void)action;
+
     /* Find which button triggered the interrupt */
     for (uint8_t i = 0; i < BUTTON_NUM; i++)
     {
         if (button_pins[i] == pin)
         {
-            /* Reset debounce counter on edge */
-            button_state[i].debounce_count = 0;
+            if (button_state[i].armed)
+            {
+                button_stats.bounces++;
+                break;
+            }
+            button_state[i].t_edge = Rtc.getTimestamp();
+            button_state[i].armed = true;
+            if (xTimerStartFromISR(button_timer[i], &woken) != pdPASS)
+            {
+                /* timer queue full: the next edge tries again */
+                button_state[i].armed = false;
+            }
             break;
         }
     }
+    portYIELD_FROM_ISR(woken);
 }
 
+/**
+ * @brief End of the lockout: sample the pin, report the change if any
+ */
 static void button_timer_callback(TimerHandle_t xTimer)
 {
-    (void)xTimer;
-    button_handler_process();
+    uint8_t i = (uint8_t)(uintptr_t)pvTimerGetTimerID(xTimer);
+    bool pin_state;
+
+    /* edges from now on arm a new lockout, none can be missed */
+    button_state[i].armed = false;
+
+    /* Read current pin state (buttons are active low with pullup) */
+    pin_state = (nrf_gpio_pin_read(button_pins[i]) == 0);
+
+    if (pin_state == button_state[i].pressed)
+    {
+        /* back to the debounced state within the lockout */
+        button_stats.glitches++;
+        return;
+    }
+
+    /* State change confirmed after the lockout */
+    button_state[i].pressed = pin_state;
+    button_state[i].t_confirm = Rtc.getTimestamp();
+
+    if (pin_state)
+    {
+        uint32_t us = RTC_TICKS_TO_US(Rtc.getTimeElapsed(button_state[i].t_edge, button_state[i].t_confirm));
+
+        button_stats.presses++;
+        button_stats.confirm_sum_us += us;
+        if (us > button_stats.confirm_max_us)
+        {
+            button_stats.confirm_max_us = us;
+        }
+    }
+
+    /* Debug output */
+    char debug_str[64];
+    int len = snprintf(debug_str, sizeof(debug_str),
+        "BTN[%d] %s\r\n", i, pin_state ? "PRESS" : "RELEASE");
+    reporter_instance.print(debug_str, len);
+
+    /* Invoke callback if registered */
+    if (button_callback != NULL)
+    {
+        button_callback((button_id_e)i, pin_state);
+    }
 }
 
 void button_handler_init(void)
@@ -118,34 +183,33 @@ void button_handler_init(void)
     /* Configure each button */
     for (uint8_t i = 0; i < BUTTON_NUM; i++)
     {
-        nrfx_gpiote_in_config_t in_config = NRFX_GPIOTE_CONFIG_IN_SENSE_LOTOHI(true);
-        in_config.pull = NRF_GPIO_PIN_PULLUP;
-        
-        err = nrfx_gpiote_in_init(button_pins[i], &in_config, gpiote_event_handler);
-        if (err == NRFX_SUCCESS)
+        /* One-shot lockout timer, only runs after an edge */
+        if (button_timer[i] == NULL)
         {
-            /* Enable interrupt for this pin */
-            nrfx_gpiote_in_event_enable(button_pins[i], true);
+            button_timer[i] = xTimerCreate(
+                "BtnDebounce",
+                pdMS_TO_TICKS(BUTTON_LOCKOUT_MS),
+                pdFALSE,
+                (void *)(uintptr_t)i,
+                button_timer_callback
+            );
+            if (button_timer[i] == NULL)
+                continue;
         }
+
+        /* Both edges, PORT event: no high frequency clock kept running while idle */
+        nrfx_gpiote_in_config_t in_config = NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(false);
+        in_config.pull = NRF_GPIO_PIN_PULLUP;
         
         /* Initialize button state */
         button_state[i].pressed = false;
-        button_state[i].debounce_count = 0;
-    }
+        button_state[i].armed = false;
 
-    /* Start periodic debounce timer (runs every 5ms) */
-    if (button_timer == NULL)
-    {
-        button_timer = xTimerCreate(
-            "BtnDebounce",
-            pdMS_TO_TICKS(5),
-            pdTRUE,
-            NULL,
-            button_timer_callback
-        );
-        if (button_timer != NULL)
+        err = nrfx_gpiote_in_init(button_pins[i], &in_config, gpiote_event_handler);
+        if (err == NRFX_SUCCESS)
         {
-            xTimerStart(button_timer, 0);
+            /* Enable interrupt for this pin */
+            nrfx_gpiote_in_event_enable(button_pins[i], true);
         }
     }
 }
@@ -162,41 +226,37 @@ bool button_is_pressed(button_id_e button_id)
     return button_state[button_id].pressed;
 }
 
-void button_handler_process(void)
+uint32_t button_handler_get_edge_time(button_id_e button_id)
 {
-    for (uint8_t i = 0; i < BUTTON_NUM; i++)
+    if (button_id >= BUTTON_NUM)
+        return 0;
+    return button_state[button_id].t_edge;
+}
+
+void button_handler_mark_enqueue(button_id_e button_id)
+{
+    uint32_t us;
+
+    if (button_id >= BUTTON_NUM)
+        return;
+
+    us = RTC_TICKS_TO_US(Rtc.getTimeElapsed(button_state[button_id].t_edge, Rtc.getTimestamp()));
+
+    button_stats.enqueued++;
+    button_stats.enqueue_last_us = us;
+    button_stats.enqueue_sum_us += us;
+    if (us > button_stats.enqueue_max_us)
     {
-        /* Read current pin state (buttons are active low with pullup) */
-        bool pin_state = (nrf_gpio_pin_read(button_pins[i]) == 0);
-        
-        /* Debounce logic */
-        if (pin_state != button_state[i].pressed)
-        {
-            button_state[i].debounce_count++;
-            
-            if (button_state[i].debounce_count >= DEBOUNCE_THRESHOLD)
-            {
-                /* State change confirmed after debounce period */
-                button_state[i].pressed = pin_state;
-                button_state[i].debounce_count = 0;
-                
-                /* Debug output */
-                char debug_str[64];
-                int len = snprintf(debug_str, sizeof(debug_str), 
-                    "BTN[%d] %s\r\n", i, pin_state ? "PRESS" : "RELEASE");
-                reporter_instance.print(debug_str, len);
-                
-                /* Invoke callback if registered */
-                if (button_callback != NULL)
-                {
-                    button_callback((button_id_e)i, button_state[i].pressed);
-                }
-            }
-        }
-        else
-        {
-            /* State stable, reset debounce counter */
-            button_state[i].debounce_count = 0;
-        }
+        button_stats.enqueue_max_us = us;
     }
 }
+
+void button_handler_get_stats(button_stats_t *stats)
+{
+    *stats = button_stats;
+}
+
+void button_handler_reset_stats(void)
+{
+    memset(&button_stats, 0, sizeof(button_stats));
+}
@@ -64,6 +64,27 @@ typedef enum {
     BUTTON_NUM = 2     /* Total number of buttons */
 } button_id_e;
 
+#ifndef BUTTON_LOCKOUT_MS
+#define BUTTON_LOCKOUT_MS   20  /**< after the first edge, bounces are ignored this long, then the pin is sampled */
+#endif
+
+/**
+ * @brief Debounce and press latency statistics, BTNLAT command
+ *
+ * Latencies are measured from the first edge of a press.
+ */
+typedef struct {
+    uint32_t presses;           /* presses confirmed */
+    uint32_t bounces;           /* edges ignored in a lockout */
+    uint32_t glitches;          /* lockouts that ended on the previous state */
+    uint32_t confirm_max_us;    /* edge to debounce confirm */
+    uint32_t confirm_sum_us;
+    uint32_t enqueued;          /* presses handed to the SP1 payload */
+    uint32_t enqueue_last_us;   /* edge to SP1 enqueue */
+    uint32_t enqueue_max_us;
+    uint32_t enqueue_sum_us;
+} button_stats_t;
+
 /**
  * @brief Button event callback function type
  *
@@ -79,7 +100,9 @@ typedef void (*button_event_callback_t)(button_id_e button_id, bool is_pressed);
  *
  * @brief Initialize button handler
  *
- * Configures GPIO and interrupts for button inputs.
+ * Configures GPIO and interrupts for button inputs: an edge arms a
+ * one-shot lockout timer of BUTTON_LOCKOUT_MS, at its end the pin is
+ * sampled and a change is reported. No timer runs while idle.
  * Must be called once during initialization.
  *
  * @return void
@@ -107,14 +130,42 @@ void button_handler_register_callback(button_event_callback_t callback);
 bool button_is_pressed(button_id_e button_id);
 
 /**
- * @fn void button_handler_process(void)
+ * @fn uint32_t button_handler_get_edge_time(button_id_e button_id)
+ *
+ * @brief Rtc timestamp of the first edge of the last change of a button
+ *
+ * @param button_id The button to check
+ * @return Rtc ticks
+ */
+uint32_t button_handler_get_edge_time(button_id_e button_id);
+
+/**
+ * @fn void button_handler_mark_enqueue(button_id_e button_id)
  *
- * @brief Process button debouncing (call periodically from timer or task)
+ * @brief Timestamp the SP1 enqueue of the last press of a button
+ *
+ * @param button_id The button whose press was sent
+ * @return void
+ */
+void button_handler_mark_enqueue(button_id_e button_id);
+
+/**
+ * @fn void button_handler_get_stats(button_stats_t *stats)
+ *
+ * @brief Get the debounce and press latency statistics
+ *
+ * @param stats Copy of the statistics
+ * @return void
+ */
+void button_handler_get_stats(button_stats_t *stats);
+
+/**
+ * @fn void button_handler_reset_stats(void)
  *
- * Handles debouncing logic for button presses
+ * @brief Clear the debounce and press latency statistics
  *
  * @return void
  */
-void button_handler_process(void);
+void button_handler_reset_stats(void);
 
 #endif /* BUTTON_HANDLER_H */
@@ -139,6 +139,7 @@ void command_parser(usb_data_e res, char *text)
         equal = _NO_COMMAND;
         json_params = NULL;
         json_root = NULL;
+        val = 0; // no argument
         cmd[0] = 0; // Initialize no command
 
         if (*text == '{')
@@ -152,14 +153,14 @@ void command_parser(usb_data_e res, char *text)
                     json_params = cJSON_GetObjectItem(json_root, CMD_PARAMS); // Get command params
                     if (json_params != NULL)
                     { // We have a Json so we need to update command.
-                        sscanf(temp_str, "%9s", cmd);
+                        sscanf(temp_str, "%19s", cmd);
                     }
                 }
             }
         }
         else
         { // It is not a Json command
-            sscanf(text, "%9s %d", cmd, &val);
+            sscanf(text, "%19s %d", cmd, &val);
         }
 
 
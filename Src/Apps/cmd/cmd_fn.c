@@ -68,11 +68,27 @@
 #include "HAL_error.h"
 #include "HAL_uart.h"
 #include "thread_fn.h"
+#include "log_arena.h"
+#include "dlog.h"
 #include "driver_app_config.h"
 #include "debug_config.h"
 #include "comm_config.h"
 #include "rf_tuning_config.h"
 #include "HAL_uwb.h"
+#include "skb_pool.h"
+#include "dw3000_mcps_mcu.h"
+#include "fh_schedule.h"
+#include "button_handler.h"
+#include "trace_point.h"
+#include "uwb_servo_responder.h"
+#include "HAL_SPI.h"
+#include "nrf.h"
+#include "peer_table.h"
+#include "sp1_frame.h"
+#include "sp1_xport.h"
+#include "sp1_txq.h"
+#include "fira_app.h"
+#include "fira_app_config.h"
 
 #define CMD_COLUMN_WIDTH 10
 #define CMD_COLUMN_MAX   4
@@ -183,12 +199,184 @@ REG_FN(f_stop)
 }
 
 /**
- * @brief show current threads and stack depth
+ * @brief show current threads: stack depth, CPU share and switches, heap
+ *        THREAD : table
+ *        THREAD 1 : CPU profile, one JSON line
  *
  * */
 REG_FN(f_thread)
 {
-    return thread_fn();
+    return (val == 1) ? thread_cpu_fn() : thread_fn();
+}
+
+/**
+ * @brief show report buffer usage per producer
+ *
+ * */
+REG_FN(f_logstat)
+{
+    log_arena_report();
+    return (CMD_FN_RET_OK);
+}
+
+/**
+ * @brief show or set the runtime log levels
+ *        LOGLVL, LOGLVL <level>, LOGLVL <level> <module>
+ *
+ * */
+REG_FN(f_loglvl)
+{
+    char mod_name[10];
+    int lvl;
+    dlog_module_e mod = DLOG_MOD_COUNT;
+    int n = sscanf(text, "%*s %d %9s", &lvl, mod_name);
+
+    if (n < 1)
+    {
+        dlog_report_levels();
+        return (CMD_FN_RET_OK);
+    }
+
+    if ((lvl < DLOG_LVL_OFF) || (lvl > DLOG_LVL_DBG))
+    {
+        return (NULL);
+    }
+
+    if (n == 2)
+    {
+        mod = dlog_module_by_name(mod_name);
+        if (mod == DLOG_MOD_COUNT)
+        {
+            return (NULL);
+        }
+    }
+
+    dlog_set_level(mod, (dlog_level_e)lvl);
+    return (CMD_FN_RET_OK);
+}
+
+/**
+ * @brief show the MCPS task ISR to handler latency histograms
+ *        MCPSLAT, MCPSLAT 1 : show and reset
+ *
+ * */
+REG_FN(f_mcpslat)
+{
+    static const char *const evt_names[MCPS_EVT_COUNT] = {
+        [MCPS_EVT_TX_DONE] = "TX_DONE",
+        [MCPS_EVT_RX] = "RX",
+        [MCPS_EVT_RX_TIMEOUT] = "RX_TO",
+        [MCPS_EVT_RX_ERROR] = "RX_ERR",
+        [MCPS_EVT_TIMER] = "TIMER",
+    };
+    mcps_latency_t lat[MCPS_EVT_COUNT];
+    char str[160];
+    int len;
+
+    dw3000_mcps_get_latency(lat);
+
+    /* bucket i ends at 2^i Rtc ticks */
+    len = snprintf(str, sizeof(str), "%-8s\t%6s\t%6s", "EVENT", "count", "max_us");
+    for (int b = 0; b < MCPS_LAT_BUCKETS - 1; b++)
+    {
+        len += snprintf(&str[len], sizeof(str) - len, "\t<%lu", (unsigned long)(((1000000UL << b) + 16384) / 32768));
+    }
+    len += snprintf(&str[len], sizeof(str) - len, "\tmore\r\n");
+    reporter_instance.print(str, len);
+
+    for (int i = 0; i < MCPS_EVT_COUNT; i++)
+    {
+        len = snprintf(str, sizeof(str), "%-8s\t%6lu\t%6lu", evt_names[i], (unsigned long)lat[i].count,
+                       (unsigned long)(((uint64_t)lat[i].max * 1000000UL) / 32768));
+        for (int b = 0; b < MCPS_LAT_BUCKETS; b++)
+        {
+            len += snprintf(&str[len], sizeof(str) - len, "\t%lu", (unsigned long)lat[i].hist[b]);
+        }
+        len += snprintf(&str[len], sizeof(str) - len, "\r\n");
+        reporter_instance.print(str, len);
+    }
+
+    if (val == 1)
+    {
+        dw3000_mcps_reset_latency();
+    }
+    return (CMD_FN_RET_OK);
+}
+
+/**
+ * @brief show the button debounce and press to SP1 enqueue latency
+ *        BTNLAT, BTNLAT 1 : show and reset
+ *
+ * */
+REG_FN(f_btnlat)
+{
+    button_stats_t st;
+    char str[160];
+    int len;
+
+    button_handler_get_stats(&st);
+
+    len = snprintf(str, sizeof(str), "BTN: presses %lu, bounces %lu, glitches %lu, lockout %u ms\r\n",
+                   (unsigned long)st.presses, (unsigned long)st.bounces,
+                   (unsigned long)st.glitches, (unsigned)BUTTON_LOCKOUT_MS);
+    reporter_instance.print(str, len);
+
+    len = snprintf(str, sizeof(str), "BTN: edge->confirm avg %lu max %lu us, edge->SP1 enqueue %lu: avg %lu max %lu last %lu us\r\n",
+                   (unsigned long)(st.presses ? st.confirm_sum_us / st.presses : 0),
+                   (unsigned long)st.confirm_max_us, (unsigned long)st.enqueued,
+                   (unsigned long)(st.enqueued ? st.enqueue_sum_us / st.enqueued : 0),
+                   (unsigned long)st.enqueue_max_us, (unsigned long)st.enqueue_last_us);
+    reporter_instance.print(str, len);
+
+    if (val == 1)
+    {
+        button_handler_reset_stats();
+    }
+    return (CMD_FN_RET_OK);
+}
+
+/**
+ * @brief print the trace point ring, tools/trace_merge.py input
+ *        TRACE, TRACE 1 : show and clear
+ *
+ * */
+REG_FN(f_trace)
+{
+    trace_dump(val == 1);
+    return (CMD_FN_RET_OK);
+}
+
+/**
+ * @brief benchmark the responder from report_cb to the servo command
+ *        RESPBENCH [<n>] : n simulated triggers, 1000 by default
+ *
+ * */
+REG_FN(f_respbench)
+{
+    uint32_t p50 = 0, p99 = 0, max = 0;
+    char str[96];
+    int n, len;
+
+    n = uwb_servo_responder_bench((val > 0) ? (uint32_t)val : 1000, &p50, &p99, &max);
+    if (n < 0)
+    {
+        return (NULL);
+    }
+
+    len = snprintf(str, sizeof(str), "RESPBENCH: %d triggers, p50 %lu us, p99 %lu us, max %lu us\r\n",
+                   n, (unsigned long)p50, (unsigned long)p99, (unsigned long)max);
+    reporter_instance.print(str, len);
+    return (CMD_FN_RET_OK);
+}
+
+/**
+ * @brief per-peer state of the session: measurements, distance, SP1 payloads
+ *
+ * */
+REG_FN(f_peers)
+{
+    peer_table_print();
+    return (CMD_FN_RET_OK);
 }
 
 /**
@@ -208,6 +396,13 @@ REG_FN(f_diag)
     return (CMD_FN_RET_OK);
 }
 
+REG_FN(f_binrep)
+{
+    debug_config_t *debug_config = get_debug_config();
+    debug_config->binReportEn = (uint8_t)val;
+    return (CMD_FN_RET_OK);
+}
+
 REG_FN(f_uart)
 {
     bool uartEn = get_uartEn();
@@ -268,6 +463,320 @@ REG_FN(f_decaid)
     return (CMD_FN_RET_OK);
 }
 
+/**
+ * @brief SPI register access throughput, DW3000 woken up for the run
+ *        SPIBENCH [<n>] : n accesses per test, 1000 by default
+ *
+ * */
+REG_FN(f_spibench)
+{
+    struct spi_s *spi = hal_uwb.uwbs->spi;
+    uint32_t n = (val > 0) ? (uint32_t)val : 1000;
+    uint32_t cyc_per_us = SystemCoreClock / 1000000UL;
+    uint32_t t0, t_single, t_burst, t_bulk;
+    uint8_t buf[127];
+    spi_stats_t s0, s1;
+    char str[128];
+    int len;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    hal_uwb.wakeup_with_io();
+    spi->get_stats(spi->handler, &s0);
+
+    /* SPIM enabled and disabled around every access */
+    t0 = DWT->CYCCNT;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        (void)dwt_readdevid();
+    }
+    t_single = DWT->CYCCNT - t0;
+
+    hal_uwb.spi_burst_begin();
+
+    t0 = DWT->CYCCNT;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        (void)dwt_readdevid();
+    }
+    t_burst = DWT->CYCCNT - t0;
+
+    t0 = DWT->CYCCNT;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        dwt_readrxdata(buf, sizeof(buf), 0);
+    }
+    t_bulk = DWT->CYCCNT - t0;
+
+    hal_uwb.spi_burst_end();
+
+    spi->get_stats(spi->handler, &s1);
+    hal_uwb.sleep_enter();
+
+    len = snprintf(str, sizeof(str), "SPIBENCH: %lu reads, %lu ns/read, %lu ns/read in a burst, %u byte reads %lu kB/s\r\n",
+                   (unsigned long)n,
+                   (unsigned long)(((uint64_t)t_single * 1000 / cyc_per_us) / n),
+                   (unsigned long)(((uint64_t)t_burst * 1000 / cyc_per_us) / n),
+                   (unsigned)sizeof(buf),
+                   (unsigned long)(((uint64_t)n * sizeof(buf) * 1000 * cyc_per_us) / (t_bulk ? t_bulk : 1)));
+    reporter_instance.print(str, len);
+
+    len = snprintf(str, sizeof(str), "SPI: %lu transactions, %lu DMA, %lu bytes, %lu copied, %lu SPIM enables\r\n",
+                   (unsigned long)(s1.xfers - s0.xfers), (unsigned long)(s1.dma - s0.dma),
+                   (unsigned long)(s1.bytes - s0.bytes), (unsigned long)(s1.copied - s0.copied),
+                   (unsigned long)(s1.enables - s0.enables));
+    reporter_instance.print(str, len);
+
+    return (CMD_FN_RET_OK);
+}
+
+/**
+ * @brief report path cost against the number of controlees
+ *        REPORTBENCH [<n>] : n simulated blocks per count, 50 by default
+ *
+ * */
+REG_FN(f_reportbench)
+{
+    uint32_t blocks = (val > 0) ? (uint32_t)val : 50;
+    fira_report_bench_t res;
+    char str[128];
+    int len;
+
+    for (int n = 1; n <= PEER_TABLE_MAX; n *= 2)
+    {
+        int rounds = fira_app_report_bench(n, blocks, &res);
+        if (rounds < 0)
+        {
+            return (NULL);
+        }
+        len = snprintf(str, sizeof(str), "REPORTBENCH: %d peers, %d reports/block, %lu us/block, lookup+state %lu ns, JSON %lu ns per peer, %u B buffer\r\n",
+                       n, rounds, (unsigned long)res.block_us, (unsigned long)res.state_ns,
+                       (unsigned long)res.json_ns, res.str_len);
+        reporter_instance.print(str, len);
+        len = snprintf(str, sizeof(str), "REPORTBENCH: %d peers, JSON %lu cycles, binary %lu cycles per block, binary %lu ns per peer\r\n",
+                       n, (unsigned long)res.json_cyc, (unsigned long)res.bin_cyc, (unsigned long)res.bin_ns);
+        reporter_instance.print(str, len);
+    }
+    return (CMD_FN_RET_OK);
+}
+/**
+ * @brief SP1 payload reception: explicit counter against trial decryption
+ *        SP1BENCH [<n>] : n frames over the simulated link, 1000 by default
+ *
+ * */
+REG_FN(f_sp1bench)
+{
+    static const char *const name[2] = {"counter", "trial"};
+    uint32_t n = (val > 0) ? (uint32_t)val : 1000;
+    uint32_t cyc_per_us = SystemCoreClock / 1000000UL;
+    sp1_bench_t res[2];
+    char str[160];
+    int len;
+
+    if (sp1_frame_bench(n, res) != 0)
+    {
+        return (NULL);
+    }
+    for (int k = 0; k < 2; k++)
+    {
+        uint32_t acc = res[k].accepted ? res[k].accepted : 1;
+
+        len = snprintf(str, sizeof(str), "SP1BENCH %s: %lu frames, %lu received, %lu accepted, %lu.%02lu decrypts/accepted, %lu replays dropped, %lu us/accepted\r\n",
+                       name[k], (unsigned long)n, (unsigned long)res[k].delivered, (unsigned long)res[k].accepted,
+                       (unsigned long)(res[k].decrypts / acc), (unsigned long)((res[k].decrypts % acc) * 100 / acc),
+                       (unsigned long)res[k].replays, (unsigned long)(res[k].cycles / cyc_per_us / acc));
+        reporter_instance.print(str, len);
+    }
+    return (CMD_FN_RET_OK);
+}
+
+/**
+ * @brief SP1 transport: queue a message, or show the statistics
+ *        SP1SEND : statistics
+ *        SP1SEND [0x<addr>] <text> : text to addr, to the first peer if omitted
+ *        SP1SEND [0x<addr>] *<n> : n bytes 0, 1, 2...
+ *
+ * */
+REG_FN(f_sp1send)
+{
+    const peer_t *peer = peer_table_get(0);
+    sp1_xport_stats_t st;
+    uint16_t dst = peer ? peer->addr : 0;
+    uint8_t *msg = NULL;
+    char *p = text;
+    unsigned addr, n_bytes;
+    bool busy;
+    char str[192];
+    int len, n, r;
+
+    /* past the command name */
+    p += strcspn(p, " ");
+    p += strspn(p, " ");
+
+    if (*p == '\0')
+    {
+        if (!fira_app_sp1_stats(&st, &busy))
+        {
+            return (NULL);
+        }
+        len = snprintf(str, sizeof(str), "SP1SEND: %s, sent %lu msgs %lu B, %lu failed, %lu segs %lu retx; received %lu msgs %lu B, %lu segs %lu dup %lu dropped\r\n",
+                       busy ? "busy" : "idle",
+                       (unsigned long)st.tx_msgs, (unsigned long)st.tx_bytes, (unsigned long)st.tx_fail,
+                       (unsigned long)st.tx_segs, (unsigned long)st.tx_retx,
+                       (unsigned long)st.rx_msgs, (unsigned long)st.rx_bytes,
+                       (unsigned long)st.rx_segs, (unsigned long)st.rx_dup, (unsigned long)st.rx_drop);
+        reporter_instance.print(str, len);
+        return (CMD_FN_RET_OK);
+    }
+
+    /* the command line is upper case */
+    if (sscanf(p, "0X%x%n", &addr, &n) == 1 && (p[n] == ' ' || p[n] == '\0'))
+    {
+        dst = (uint16_t)addr;
+        p += n;
+        p += strspn(p, " ");
+    }
+    if (!dst)
+    {
+        return (NULL);
+    }
+
+    if (sscanf(p, "*%u", &n_bytes) == 1)
+    {
+        if (n_bytes == 0 || n_bytes > SP1_XP_MSG_MAX || !(msg = malloc(n_bytes)))
+        {
+            return (NULL);
+        }
+        for (unsigned i = 0; i < n_bytes; i++)
+        {
+            msg[i] = (uint8_t)i;
+        }
+        r = fira_app_sp1_send(dst, msg, (uint16_t)n_bytes);
+        free(msg);
+    }
+    else
+    {
+        len = strcspn(p, "\r\n");
+        r = fira_app_sp1_send(dst, (const uint8_t *)p, (uint16_t)len);
+    }
+    return (r == 0) ? (CMD_FN_RET_OK) : (NULL);
+}
+
+/**
+ * @brief SP1 transport goodput against the frame loss rate
+ *        SP1XBENCH [<n>] : n simulated blocks per run, 2000 by default
+ *
+ * */
+REG_FN(f_sp1xbench)
+{
+    static const int loss[] = {0, 5, 10, 20, 30, 50};
+    static const int window[] = {SP1_XP_WINDOW, 1};
+    uint32_t blocks = (val > 0) ? (uint32_t)val : 2000;
+    uint32_t block_ms = get_fira_config()->session.block_duration_ms;
+    uint64_t ms = (uint64_t)blocks * (block_ms ? block_ms : 1);
+    sp1_xport_bench_t res;
+    char str[160];
+    int len;
+
+    for (unsigned i = 0; i < sizeof(loss) / sizeof(loss[0]); i++)
+    {
+        for (unsigned w = 0; w < sizeof(window) / sizeof(window[0]); w++)
+        {
+            uint32_t segs, first;
+
+            if (sp1_xport_bench(blocks, loss[i], window[w], SP1_TXQ_VAL_MAX, &res) != 0)
+            {
+                return (NULL);
+            }
+            segs = res.ab_segs ? res.ab_segs : 1;
+            first = (res.ab_segs > res.ab_retx) ? res.ab_segs - res.ab_retx : 1;
+            len = snprintf(str, sizeof(str), "SP1XBENCH loss %d%%, window %d: A->B %lu B/s, B->A %lu B/s, %lu.%02lu sends/segment, %lu msgs dropped, %lu corrupt\r\n",
+                           loss[i], window[w],
+                           (unsigned long)(res.ab_bytes * 1000ULL / ms), (unsigned long)(res.ba_bytes * 1000ULL / ms),
+                           (unsigned long)(segs / first), (unsigned long)((segs % first) * 100 / first),
+                           (unsigned long)res.ab_fail, (unsigned long)res.corrupt);
+            reporter_instance.print(str, len);
+        }
+    }
+    return (CMD_FN_RET_OK);
+}
+
+/**
+ * @brief SP1 message queue: statistics of the session
+ *
+ * */
+REG_FN(f_sp1q)
+{
+    static const char *prio[SP1_TXQ_PRIOS] = {"urgent", "normal", "bulk"};
+    sp1_txq_stats_t st;
+    char str[160];
+    int len;
+
+    if (!fira_app_sp1_txq_stats(&st))
+    {
+        return (NULL);
+    }
+    len = snprintf(str, sizeof(str), "SP1Q: %lu frames, %lu B/frame\r\n",
+                   (unsigned long)st.frames, (unsigned long)(st.frames ? st.bytes / st.frames : 0));
+    reporter_instance.print(str, len);
+
+    for (int p = 0; p < SP1_TXQ_PRIOS; p++)
+    {
+        uint32_t sent = st.sent[p] ? st.sent[p] : 1;
+
+        len = snprintf(str, sizeof(str), "SP1Q %s: %lu queued, %lu sent, %lu dropped, delay %lu.%02lu blocks, max %lu\r\n",
+                       prio[p], (unsigned long)st.pushed[p], (unsigned long)st.sent[p], (unsigned long)st.dropped[p],
+                       (unsigned long)(st.delay_sum[p] / sent), (unsigned long)((st.delay_sum[p] % sent) * 100 / sent),
+                       (unsigned long)st.delay_max[p]);
+        reporter_instance.print(str, len);
+    }
+    return (CMD_FN_RET_OK);
+}
+
+/**
+ * @brief SP1 message queue against one payload per block, over a mixed load
+ *        SP1QBENCH [<n>] : n simulated blocks per run, 2000 by default
+ *
+ * */
+REG_FN(f_sp1qbench)
+{
+    static const int telem[] = {10, 30, 50, 70, 90};
+    static const char *name[2] = {"queue", "last payload"};
+    uint32_t blocks = (val > 0) ? (uint32_t)val : 2000;
+    sp1_txq_bench_t res[2];
+    char str[224];
+    int len;
+
+    for (unsigned i = 0; i < sizeof(telem) / sizeof(telem[0]); i++)
+    {
+        if (sp1_txq_bench(blocks, telem[i], res) != 0)
+        {
+            return (NULL);
+        }
+        for (int k = 0; k < 2; k++)
+        {
+            const sp1_txq_bench_t *r = &res[k];
+            uint32_t urg = r->sent[SP1_TXQ_URGENT] ? r->sent[SP1_TXQ_URGENT] : 1;
+            uint32_t nrm = r->sent[SP1_TXQ_NORMAL] ? r->sent[SP1_TXQ_NORMAL] : 1;
+
+            len = snprintf(str, sizeof(str), "SP1QBENCH telemetry %d%%, %s: urgent %lu sent %lu lost, delay %lu.%02lu max %lu; normal %lu sent %lu lost, delay %lu.%02lu max %lu; bulk %lu B/block; %lu B/frame\r\n",
+                           telem[i], name[k],
+                           (unsigned long)r->sent[SP1_TXQ_URGENT], (unsigned long)r->lost[SP1_TXQ_URGENT],
+                           (unsigned long)(r->delay_sum[SP1_TXQ_URGENT] / urg),
+                           (unsigned long)((r->delay_sum[SP1_TXQ_URGENT] % urg) * 100 / urg),
+                           (unsigned long)r->delay_max[SP1_TXQ_URGENT],
+                           (unsigned long)r->sent[SP1_TXQ_NORMAL], (unsigned long)r->lost[SP1_TXQ_NORMAL],
+                           (unsigned long)(r->delay_sum[SP1_TXQ_NORMAL] / nrm),
+                           (unsigned long)((r->delay_sum[SP1_TXQ_NORMAL] % nrm) * 100 / nrm),
+                           (unsigned long)r->delay_max[SP1_TXQ_NORMAL],
+                           (unsigned long)(r->sent[SP1_TXQ_BULK] / blocks),
+                           (unsigned long)(r->frames ? r->bytes / r->frames : 0));
+            reporter_instance.print(str, len);
+        }
+    }
+    return (CMD_FN_RET_OK);
+}
 
 REG_FN(f_get_version)
 {
@@ -674,6 +1183,17 @@ REG_FN(f_stat)
 
     if (str)
     {
+        skb_pool_stats_t skb_stats;
+        mcps_rx_ring_stats_t rx_stats;
+        fh_schedule_stats_t fh_stats;
+        struct spi_s *spi = hal_uwb.uwbs->spi;
+        spi_stats_t spi_stats;
+
+        skb_pool_get_stats(&skb_stats);
+        spi->get_stats(spi->handler, &spi_stats);
+        dw3000_mcps_get_rx_ring_stats(&rx_stats);
+        fh_schedule_get_stats(&fh_stats);
+
         sprintf(str, "MODE: %s\r\n"
                      "LAST ERR CODE: %d\r\n"
                      "MAX MSG LEN: %d\r\n",
@@ -683,6 +1203,34 @@ REG_FN(f_stat)
 
         reporter_instance.print((char *)str, strlen(str));
 
+        sprintf(str, "SKB POOL: %lu/%lu used, hwm %lu, allocs %lu, exhausted %lu\r\n"
+                     "RX RING: depth %lu, hwm %lu, frames %lu, overruns %lu\r\n",
+                (unsigned long)skb_stats.used, (unsigned long)skb_stats.size,
+                (unsigned long)skb_stats.hwm, (unsigned long)skb_stats.allocs,
+                (unsigned long)skb_stats.exhausted,
+                (unsigned long)rx_stats.depth, (unsigned long)rx_stats.hwm,
+                (unsigned long)rx_stats.frames, (unsigned long)rx_stats.overruns);
+
+        reporter_instance.print((char *)str, strlen(str));
+
+        sprintf(str, "FREQ HOP: staged %lu, dropped %lu, reconf %lu, late %lu, "
+                     "last %lu us, max %lu us, avg %lu us\r\n",
+                (unsigned long)fh_stats.staged, (unsigned long)fh_stats.dropped,
+                (unsigned long)fh_stats.reconf, (unsigned long)fh_stats.reconf_late,
+                (unsigned long)fh_stats.reconf_last_us, (unsigned long)fh_stats.reconf_max_us,
+                (unsigned long)(fh_stats.reconf ? fh_stats.reconf_sum_us / fh_stats.reconf : 0));
+
+        reporter_instance.print((char *)str, strlen(str));
+
+        /* register reads of the RX path, per received frame */
+        sprintf(str, "SPI: xfers %lu, bytes %lu, RX reg reads %lu, %lu.%02lu per frame\r\n",
+                (unsigned long)spi_stats.xfers, (unsigned long)spi_stats.bytes,
+                (unsigned long)rx_stats.reg_reads,
+                (unsigned long)(rx_stats.frames ? rx_stats.reg_reads / rx_stats.frames : 0),
+                (unsigned long)(rx_stats.frames ? (rx_stats.reg_reads * 100 / rx_stats.frames) % 100 : 0));
+
+        reporter_instance.print((char *)str, strlen(str));
+
         CMD_FREE(str);
 #ifdef LATER
         app.lastErrorCode = 0;
@@ -989,15 +1537,30 @@ const char COMMENT_UART[] = {"Usage: To initialize selected UART \"UART <DEC>\""
 
 const char COMMENT_RESTORE[] = {"Restores the default configuration, both UWB and System."};
 const char COMMENT_DIAG[] = {"Diagnostic mode: Display of complementary information during ranging.\r\nUsage: \"DIAG <DEC>\" (0:OFF, 1:ON)"};
+const char COMMENT_BINREP[] = {"Ranging report format.\r\nUsage: \"BINREP <DEC>\" (0:JSON, 1:binary frames, see tools/bin_report_decode.py)"};
 
 const char COMMENT_UWBCFG[] = {"UWB configuration\r\nUsage: To see UWB parameters \"UWBCFG\". To set the UWB config, list the parameters as a string argument \"UWBCFG <List of parameters>\""};
 const char COMMENT_STSKEYIV[] = {"Sets STS Key, IV and their behavior mode.\r\nUsage: To see STS KEY, IV and Mode \"STSKEYIV\". To set\"STSKEYIV 0x<STS_KEY_HEX_16> 0x<IV_HEX_16> <MODE_DEC>\".\r\n<MODE_DEC>: 1 use fixed STS (Default), 0 use dynamic STS"};
 const char COMMENT_TXPOWER[] = {"Tx Power settings.\r\nUsage: To see Tx power \"TXPOWER\". To set the Tx power \"TXPOWER 0x<POWER_HEX> 0x<PGDLY_HEX> 0x<PGCOUNT_HEX>\""};
 const char COMMENT_ANTENNA[] = {"Sets Antenna Type.\r\nUsage: To see Antenna \"ANTENNA\". To set the current antenna type for each port \"ANTENNA <PORT1> <PORT2>...\". To see possible values \"antenna values\"."};
 
-const char COMMENT_THREAD[] = {"Displays Heap and Threads stack usage"};
+const char COMMENT_THREAD[] = {"Displays Heap and Threads stack usage, CPU share over the last 1 s and 10 s and context switches.\r\nUsage: \"THREAD\" for a table, \"THREAD 1\" for one JSON line"};
+const char COMMENT_LOGLVL[] = {"Log levels per module.\r\nUsage: To see the levels \"LOGLVL\". To set them \"LOGLVL <LEVEL> [<MODULE>]\", <LEVEL> 0:OFF 1:ERR 2:WARN 3:INFO 4:DBG, <MODULE> FIRA, BTN, RESP, SERVO or MON (all if omitted)"};
+const char COMMENT_MCPSLAT[] = {"Displays the MCPS task latency from the ISR to the handler per event: count, max and histogram in us.\r\nUsage: \"MCPSLAT\", \"MCPSLAT 1\" to reset after display"};
+const char COMMENT_BTNLAT[] = {"Displays the button debounce statistics and the latency from the first edge of a press to its debounce and to the SP1 payload enqueue.\r\nUsage: \"BTNLAT\", \"BTNLAT 1\" to reset after display"};
+const char COMMENT_TRACE[] = {"Prints the trace points of the button to servo path, timestamps in 32768 Hz ticks. Merge the dumps of both boards with tools/trace_merge.py.\r\nUsage: \"TRACE\", \"TRACE 1\" to clear after display"};
+const char COMMENT_RESPBENCH[] = {"Responder benchmark: latency from report_cb to the servo command over simulated triggers, the servo does not move.\r\nUsage: \"RESPBENCH\" for 1000 triggers, \"RESPBENCH <n>\""};
+const char COMMENT_PEERS[] = {"Displays the peers of the session: good and failed measurements, last block, filtered distance, SP1 payloads accepted and rejected"};
+const char COMMENT_LOGSTAT[] = {"Displays the report output statistics per thread: bytes/s since the last LOGSTAT, bytes, dropped messages and highest buffer fill"};
 
 const char COMMENT_DECAID[] = {"Displays UWB chip information"};
+const char COMMENT_SPIBENCH[] = {"SPI throughput: register reads with and without an SPI burst, then 127 byte reads.\r\nUsage: \"SPIBENCH\" for 1000 reads per test, \"SPIBENCH <n>\""};
+const char COMMENT_REPORTBENCH[] = {"Report path cost for 1 to 64 controlees over simulated ranging blocks: peer lookup and state update, JSON report and its buffer, binary report of the same blocks.\r\nUsage: \"REPORTBENCH\" for 50 blocks per count, \"REPORTBENCH <n>\""};
+const char COMMENT_SP1BENCH[] = {"SP1 payload reception over a simulated link with 10% loss, late and duplicated frames: explicit counter and replay window against trial decryption of 5 block indices.\r\nUsage: \"SP1BENCH\" for 1000 frames, \"SP1BENCH <n>\""};
+const char COMMENT_SP1SEND[] = {"SP1 transport: sends a message to a peer of the SP1 session over the SP1 payloads, in segments acked by the peer.\r\nUsage: \"SP1SEND\" for the statistics, \"SP1SEND [0x<ADDR_HEX>] <TEXT>\" or \"SP1SEND [0x<ADDR_HEX>] *<N>\" for N bytes, to the first peer if the address is omitted"};
+const char COMMENT_SP1Q[] = {"SP1 message queue: messages queued, sent in the SP1 frames and dropped per priority, and their delay in blocks.\r\nUsage: \"SP1Q\""};
+const char COMMENT_SP1QBENCH[] = {"SP1 message queue against one payload per block over a simulated load: button presses, 6 sensors sampling at 10 to 90% of the blocks, a backlogged transport.\r\nUsage: \"SP1QBENCH\" for 2000 blocks per run, \"SP1QBENCH <n>\""};
+const char COMMENT_SP1XBENCH[] = {"SP1 transport goodput over a simulated link losing 0 to 50% of the frames, with a window of 16 segments and of 1: A sends 4096 B messages, B 512 B messages, per the block duration of the configuration.\r\nUsage: \"SP1XBENCH\" for 2000 blocks per run, \"SP1XBENCH <n>\""};
 const char COMMENT_VERSION[] = {"Shows version of the SW"};
 
 command_t *known_commands;
@@ -1013,6 +1576,15 @@ const struct command_s known_commands_anytime_all [] __attribute__((section(".kn
     {"?",       mCmdGrp1 | mANY,   f_help_app,              COMMENT_HELP },
     {"STOP",    mCmdGrp1 | mANY,   f_stop,                  COMMENT_STOP },
     {"THREAD",  mCmdGrp1 | mANY,   f_thread,                COMMENT_THREAD },
+    {"LOGSTAT", mCmdGrp1 | mANY,   f_logstat,               COMMENT_LOGSTAT },
+    {"LOGLVL",  mCmdGrp1 | mANY,   f_loglvl,                COMMENT_LOGLVL },
+    {"MCPSLAT", mCmdGrp1 | mANY,   f_mcpslat,               COMMENT_MCPSLAT },
+    {"BTNLAT",  mCmdGrp1 | mANY,   f_btnlat,                COMMENT_BTNLAT },
+    {"TRACE",   mCmdGrp1 | mANY,   f_trace,                 COMMENT_TRACE },
+    {"RESPBENCH", mCmdGrp1 | mANY, f_respbench,             COMMENT_RESPBENCH },
+    {"PEERS",   mCmdGrp1 | mANY,   f_peers,                 COMMENT_PEERS },
+    {"SP1SEND", mCmdGrp1 | mANY,   f_sp1send,               COMMENT_SP1SEND },
+    {"SP1Q",    mCmdGrp1 | mANY,   f_sp1q,                  COMMENT_SP1Q    },
     {"STAT",    mCmdGrp1 | mANY,   f_stat,                  COMMENT_STAT },
     {"SAVE",    mCmdGrp1 | mANY,   f_save,                  COMMENT_SAVE },
     {"DECA$",   mCmdGrp1 | mANY,   f_decaJuniper,           COMMENT_DECAJUNIPER },
@@ -1026,12 +1598,18 @@ const struct command_s known_commands_service_all [] __attribute__((section(".kn
     /** 5. service commands */
     {"RESTORE", mCmdGrp1 | mIDLE,  f_restore,               COMMENT_RESTORE},
     {"DIAG",    mCmdGrp1 | mIDLE,  f_diag,                  COMMENT_DIAG},
+    {"BINREP",  mCmdGrp1 | mIDLE,  f_binrep,                COMMENT_BINREP},
 
     {"UWBCFG",  mCmdGrp1 | mIDLE,  f_uwbcfg,                COMMENT_UWBCFG},
     {"STSKEYIV",mCmdGrp1 | mIDLE,  f_stskeyiv,              COMMENT_STSKEYIV},
     {"TXPOWER", mCmdGrp1 | mIDLE,  f_power,                 COMMENT_TXPOWER},
     {"ANTENNA", mCmdGrp1 | mIDLE,  f_antenna,               COMMENT_ANTENNA},
     {"DECAID",  mCmdGrp1 | mIDLE,  f_decaid,                COMMENT_DECAID},
+    {"SPIBENCH",mCmdGrp1 | mIDLE,  f_spibench,              COMMENT_SPIBENCH},
+    {"REPORTBENCH", mCmdGrp1 | mIDLE, f_reportbench,        COMMENT_REPORTBENCH},
+    {"SP1BENCH",mCmdGrp1 | mIDLE,  f_sp1bench,              COMMENT_SP1BENCH},
+    {"SP1XBENCH", mCmdGrp1 | mIDLE, f_sp1xbench,            COMMENT_SP1XBENCH},
+    {"SP1QBENCH", mCmdGrp1 | mIDLE, f_sp1qbench,            COMMENT_SP1QBENCH},
     {"VERSION", mCmdGrp1 | mIDLE,  f_get_version,           COMMENT_VERSION},
 #ifdef LATER
     {"MCPS",    mCmdGrp1 | mIDLE,  f_test_mcps,             STD_CMD_COMMENT},
@@ -66,6 +66,7 @@
 #include "HAL_uwb.h"
 #include "rf_tuning_config.h"
 #include "dw3000_pdoa.h"
+#include "minmax.h"
 
 #ifdef FIRA_PARAM_CUSTOM
 #include "fira_custom_params.h"
@@ -75,7 +76,11 @@
 
 int sscanf(const char *__restrict, const char *__restrict, ...);
 
+#define FIRA_SCAN_ADDR_ARG  11      /**< INITF/RESPF parameters before the responder addresses, command included */
+#define FIRA_RSTU_PER_MS    1200    /**< ranging scheduling time unit, 416 chips at 499.2 MHz */
+
 static int local_pavrg_size;
+static uint8_t local_pavrg_mode;
 
 void show_fira_params()
 {
@@ -161,14 +166,107 @@ void show_fira_params()
 #undef REMAINING
 }
 
-void scan_fira_params(const char *text, bool controller)
+/* @brief responder addresses of an INITF/RESPF line: the parameters past
+ *        the FIRA_SCAN_ADDR_ARG first ones, any number of them
+ * @return number of addresses on the line, only the max first are stored
+ */
+static int scan_fira_addrs(const char *text, int *addr, int max)
+{
+    int arg = 0, n = 0;
+
+    while (*text)
+    {
+        char *end;
+
+        while (*text == ' ' || *text == '\t')
+        {
+            text++;
+        }
+        if (*text == '\0' || *text == '\r' || *text == '\n')
+        {
+            break;
+        }
+        if (arg++ < FIRA_SCAN_ADDR_ARG)
+        {
+            while (*text && *text != ' ' && *text != '\t')
+            {
+                text++;
+            }
+            continue;
+        }
+
+        long v = strtol(text, &end, 0);
+        if (end == text)
+        {
+            break;
+        }
+        if (n < max)
+        {
+            addr[n] = (int)v;
+        }
+        n++;
+        text = end;
+    }
+    return n;
+}
+
+/* @brief slots of a ranging round with n controlees, deferred mode: the
+ *        control message, the poll, one response per controlee, the final
+ *        in DS-TWR, the measurement report and, with the result report
+ *        phase, one result report per controlee */
+static int fira_round_slots_min(int n, uint8_t rr_usage, bool report_phase)
+{
+    return 2 + n + ((rr_usage == FIRA_RANGING_ROUND_USAGE_DSTWR) ? 1 : 0) + 1 + (report_phase ? n : 0);
+}
+
+/* @brief the session fits in its round and its block, the reason printed
+ *        if it does not
+ */
+static bool check_fira_round(const fira_param_t *fira_param, int n_addr)
+{
+    const struct session_parameters *s = &fira_param->session;
+    int n = fira_param->controlees_params.n_controlees;
+    int slots = fira_round_slots_min(n, s->ranging_round_usage, s->result_report_phase);
+    uint64_t round_rstu = (uint64_t)s->slot_duration_rstu * s->round_duration_slots;
+    char str[96];
+    int len = 0;
+
+    if (n_addr > FIRA_CONTROLEES_MAX)
+    {
+        len = snprintf(str, sizeof(str), "error: %d responders, a session takes %d\r\n",
+                       n_addr, FIRA_CONTROLEES_MAX);
+    }
+    else if (n > 1 && s->multi_node_mode == FIRA_MULTI_NODE_MODE_UNICAST)
+    {
+        len = snprintf(str, sizeof(str), "error: %d responders, unicast takes one, set the multi node mode to 1\r\n", n);
+    }
+    else if ((int)s->round_duration_slots < slots)
+    {
+        len = snprintf(str, sizeof(str), "error: round of %" PRIu32 " slots, %d responders need %d\r\n",
+                       s->round_duration_slots, n, slots);
+    }
+    else if (round_rstu > (uint64_t)s->block_duration_ms * FIRA_RSTU_PER_MS)
+    {
+        len = snprintf(str, sizeof(str), "error: round of %" PRIu32 " us, block of %" PRIu32 " ms\r\n",
+                       (uint32_t)(round_rstu * 1000 / FIRA_RSTU_PER_MS), s->block_duration_ms);
+    }
+
+    if (len > 0)
+    {
+        reporter_instance.print(str, MIN(len, (int)sizeof(str) - 1));
+        return false;
+    }
+    return true;
+}
+
+bool scan_fira_params(const char *text, bool controller)
 {
     char cmd[20];
     char vupper64[FIRA_VUPPER64_SIZE * 3];
-    int resp_addr[8] = {0};
+    int resp_addr[FIRA_CONTROLEES_MAX] = {0};
     int bprf_set, slot_rstu, block_ms, round_slots, session_id;
     int multi_mode, round_hop, init_addr, rr_usage;
-    int max = sizeof(resp_addr) / sizeof(resp_addr[0]);
+    int n_addr = 0;
 
     /* Get parameters from global configuration. */
     fira_param_t *fira_param = get_fira_config();
@@ -176,14 +274,16 @@ void scan_fira_params(const char *text, bool controller)
 
     int n = sscanf(
         text,
-        "%20s %i %i %i %i %i %i %24s %i %i %i %i %i %i %i %i %i %i %i",
+        "%20s %i %i %i %i %i %i %24s %i %i %i",
         cmd, &bprf_set, &slot_rstu, &block_ms, &round_slots, &rr_usage, &session_id,
-        vupper64, &multi_mode, &round_hop, &init_addr, &resp_addr[0], &resp_addr[1],
-        &resp_addr[2], &resp_addr[3], &resp_addr[4], &resp_addr[5], &resp_addr[6],
-        &resp_addr[7]);
+        vupper64, &multi_mode, &round_hop, &init_addr);
 
-    /* Make sure to update number of argument before responder address */
-    max = max > (n - 11) ? (n - 11) : max;
+    /* Responder addresses follow the initiator one */
+    if (n == FIRA_SCAN_ADDR_ARG)
+    {
+        n_addr = scan_fira_addrs(text, resp_addr, FIRA_CONTROLEES_MAX);
+    }
+    int max = MIN(n_addr, FIRA_CONTROLEES_MAX);
 
     fira_param->session.initiation_time_ms = 1000;
     fira_param->session.report_tof = 1;
@@ -272,14 +372,14 @@ void scan_fira_params(const char *text, bool controller)
     if (controller)
     {
         fira_param->session.short_addr = (n > 10) ? (init_addr) : FIRA_DEFAULT_CONTROLLER_SHORT_ADDR;
-        fira_param->session.destination_short_address = (n > 11) ? resp_addr[0] : FIRA_DEFAULT_CONTROLLEE_SHORT_ADDR;
+        fira_param->session.destination_short_address = (max > 0) ? resp_addr[0] : FIRA_DEFAULT_CONTROLLEE_SHORT_ADDR;
         fira_param->session.device_type = FIRA_DEVICE_TYPE_CONTROLLER;
         fira_param->session.device_role = FIRA_DEVICE_ROLE_INITIATOR;
     }
     else
     {
         fira_param->session.destination_short_address = (n > 10) ? (init_addr) : (FIRA_DEFAULT_CONTROLLER_SHORT_ADDR);
-        fira_param->session.short_addr = (n > 11) ? resp_addr[0] : FIRA_DEFAULT_CONTROLLEE_SHORT_ADDR;
+        fira_param->session.short_addr = (max > 0) ? resp_addr[0] : FIRA_DEFAULT_CONTROLLEE_SHORT_ADDR;
         fira_param->session.device_type = FIRA_DEVICE_TYPE_CONTROLEE;
         fira_param->session.device_role = FIRA_DEVICE_ROLE_RESPONDER;
     }
@@ -318,6 +418,8 @@ void scan_fira_params(const char *text, bool controller)
 
     fira_param->session.channel_number = dwt_config->chan;
     fira_param->session.preamble_code_index = dwt_config->txCode;
+
+    return check_fira_round(fira_param, n_addr);
 }
 
 
@@ -404,6 +506,7 @@ void set_local_pavrg_size(void)
 {
     rf_tuning_t *rf_tuning = get_rf_tuning_config();
     local_pavrg_size = rf_tuning->paverage;
+    local_pavrg_mode = rf_tuning->paverage_mode;
 }
 
 uint8_t get_local_pavrg_size(void)
@@ -411,9 +514,14 @@ uint8_t get_local_pavrg_size(void)
     return (local_pavrg_size);
 }
 
+uint8_t get_local_pavrg_mode(void)
+{
+    return (local_pavrg_mode);
+}
+
 int get_rx_ctx_size(void)
 {
     /* always allocating the minimum required size */
-    return sizeof(struct avrg_s) + (sizeof(float) * get_local_pavrg_size());
+    return sizeof(struct avrg_s) + (sizeof(int32_t) * get_local_pavrg_size());
 }
 //-----------------------------------------------------------------------------
\ No newline at end of file
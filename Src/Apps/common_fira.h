@@ -155,7 +155,7 @@ struct string_measurement
 // ----------------------------------------------------------------------------
 //
 void show_fira_params();
-void scan_fira_params(const char *text, bool controller);
+bool scan_fira_params(const char *text, bool controller);
 uwbmac_error fira_set_session_parameters(struct fira_context *fira_context, uint32_t session_id, struct session_parameters *session);
 
 void fira_uwb_mcps_init(fira_param_t *fira_param);
@@ -167,6 +167,7 @@ void fira_uwb_get_diag(float *rssi_dbm, int *nlos_pct);
 
 void set_local_pavrg_size(void);
 uint8_t get_local_pavrg_size(void);
+uint8_t get_local_pavrg_mode(void);
 
 #ifdef __cplusplus
 }
@@ -54,10 +54,12 @@
 
 #define DEFAULT_DIAG_READING 1 /**< Enable diagnostic reads (RSSI, FOM) */
 #define DEFAULT_DEBUG        0 /**< if 1, then the LED_RED used to show an error, if any */
+#define DEFAULT_BIN_REPORT   0 /**< if 1, then ranging results are reported as binary frames */
 
 static const debug_config_t debug_config_flash_default = {
     .diagEn = DEFAULT_DIAG_READING,
     .debugEn = DEFAULT_DEBUG,
+    .binReportEn = DEFAULT_BIN_REPORT,
 };
 
 static debug_config_t debug_config_ram __attribute__((section(".rconfig"))) = {0};
@@ -55,6 +55,7 @@ struct debug_config_s
 {
     uint8_t diagEn;  /**< Enable Diagnostics reading & reporting */
     uint8_t debugEn; /**< Enable Red "error" Led and error_handler() */
+    uint8_t binReportEn; /**< Report ranging results as binary frames instead of JSON */
 };
 
 typedef struct debug_config_s debug_config_t;
@@ -0,0 +1,115 @@
+/**
+ * @file    cpu_prof.c
+ *
+ * @brief   Per-task CPU time over sliding windows of 1 s and 10 s
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <string.h>
+
+#include "cpu_prof.h"
+
+_Static_assert(CPU_PROF_TASKS_MAX <= UINT8_MAX, "cpu_prof_snap_t.n is a byte");
+_Static_assert(CPU_PROF_PERIOD_MS * CPU_PROF_COARSE_DIV * (CPU_PROF_RING_LEN - 1) == 10000,
+               "the long window is 10 s");
+
+/* @brief the snapshot of the tasks of the last sample */
+static void prof_snap(const cpu_prof_t *p, cpu_prof_snap_t *s, uint32_t now)
+{
+    s->now = now;
+    s->n = (uint8_t)p->n_last;
+    for (int i = 0; i < p->n_last; i++)
+    {
+        s->t[i].id = p->last[i].id;
+        s->t[i].run = p->last[i].run;
+        s->t[i].switches = p->last[i].switches;
+    }
+}
+
+/* @brief the sample k samples before the last of a ring of n samples, the
+ *        oldest if there are fewer */
+static const cpu_prof_snap_t *prof_back(const cpu_prof_snap_t *ring, uint32_t n, uint32_t k)
+{
+    uint32_t i = (n > k) ? n - 1 - k : 0;
+
+    return &ring[i % CPU_PROF_RING_LEN];
+}
+
+void cpu_prof_init(cpu_prof_t *p, const cpu_prof_src_t *src)
+{
+    memset(p, 0, sizeof(*p));
+    p->src = *src;
+}
+
+int cpu_prof_sample(cpu_prof_t *p)
+{
+    uint32_t now;
+    int n = p->src.sample(p->src.arg, p->last, CPU_PROF_TASKS_MAX, &now);
+
+    if (n < 0 || n > CPU_PROF_TASKS_MAX)
+    {
+        p->n_last = 0;
+        return -1;
+    }
+    p->n_last = n;
+
+    prof_snap(p, &p->fine[p->n_fine % CPU_PROF_RING_LEN], now);
+    if (p->n_fine % CPU_PROF_COARSE_DIV == 0)
+    {
+        prof_snap(p, &p->coarse[p->n_coarse % CPU_PROF_RING_LEN], now);
+        p->n_coarse++;
+    }
+    p->n_fine++;
+    return 0;
+}
+
+int cpu_prof_get(const cpu_prof_t *p, cpu_prof_usage_t *u, int max, uint32_t span_us[CPU_PROF_WINDOWS])
+{
+    const cpu_prof_snap_t *cur, *old[CPU_PROF_WINDOWS];
+    uint32_t span[CPU_PROF_WINDOWS];
+    int n = (p->n_last < max) ? p->n_last : max;
+
+    if (p->n_fine == 0)
+    {
+        span_us[0] = span_us[1] = 0;
+        return 0;
+    }
+    cur = prof_back(p->fine, p->n_fine, 0);
+    old[0] = prof_back(p->fine, p->n_fine, CPU_PROF_RING_LEN - 1);
+    /* the 10 s window ends at the last sample, not at the last coarse one */
+    old[1] = prof_back(p->coarse, p->n_coarse, CPU_PROF_RING_LEN - 1);
+
+    for (int w = 0; w < CPU_PROF_WINDOWS; w++)
+    {
+        span[w] = cur->now - old[w]->now;
+        span_us[w] = (uint32_t)((uint64_t)span[w] * 1000000 / (p->src.freq ? p->src.freq : 1));
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        const cpu_prof_task_t *t = &p->last[i];
+
+        u[i].task = *t;
+        for (int w = 0; w < CPU_PROF_WINDOWS; w++)
+        {
+            uint32_t run = 0, sw = 0;
+
+            /* created within the window: its counters start at 0 */
+            for (int k = 0; k < old[w]->n; k++)
+            {
+                if (old[w]->t[k].id == t->id)
+                {
+                    run = old[w]->t[k].run;
+                    sw = old[w]->t[k].switches;
+                    break;
+                }
+            }
+            run = t->run - run;
+            u[i].switches[w] = t->switches - sw;
+            u[i].pct[w] = span[w] ? (uint32_t)((uint64_t)run * 10000 / span[w]) : 0;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file    cpu_prof.h
+ *
+ * @brief   Per-task CPU time over sliding windows of 1 s and 10 s
+ *
+ *          A source gives, for each task, its run-time counter and the times
+ *          it was switched in, both since the task was created, and the
+ *          free-running counter they are counted in: the FreeRTOS run-time
+ *          statistics on the target, a mock on a host. cpu_prof_sample(),
+ *          every CPU_PROF_PERIOD_MS, keeps the last second of samples and
+ *          one sample per second over the last 10 s. A window is the
+ *          difference between the last sample and the one a window before:
+ *          the share of the counter each task ran, its context switches.
+ *
+ *          A task created within a window counts from 0; a task deleted is
+ *          no longer reported. The windows are short of their length for
+ *          the first 10 s.
+ *
+ *          No allocation, no RTOS: the caller serializes the calls.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef CPU_PROF_H
+#define CPU_PROF_H
+
+#include <stdint.h>
+
+#ifndef CPU_PROF_TASKS_MAX
+#define CPU_PROF_TASKS_MAX  16      /**< tasks of a sample */
+#endif
+#define CPU_PROF_NAME_LEN   16
+
+#define CPU_PROF_PERIOD_MS  100     /**< cpu_prof_sample() period */
+#define CPU_PROF_WINDOWS    2       /**< 1 s, 10 s */
+#define CPU_PROF_RING_LEN   11      /**< samples of a window, both ends */
+#define CPU_PROF_COARSE_DIV 10      /**< samples of the 1 s window per sample of the 10 s one */
+
+typedef struct
+{
+    uint32_t id;            /**< unique per task created */
+    uint32_t run;           /**< counter ticks run */
+    uint32_t switches;      /**< times switched in */
+    uint32_t stack_free;    /**< bytes of stack never used */
+    char name[CPU_PROF_NAME_LEN];
+} cpu_prof_task_t;
+
+/**
+ * @brief the tasks, at most max, and the counter now
+ *
+ * @return tasks, -1 if they do not fit or on error
+ */
+typedef int (*cpu_prof_sample_fn_t)(void *arg, cpu_prof_task_t *t, int max, uint32_t *now);
+
+typedef struct
+{
+    cpu_prof_sample_fn_t sample;
+    void *arg;
+    uint32_t freq;          /**< counter ticks per second */
+} cpu_prof_src_t;
+
+typedef struct
+{
+    uint32_t now;
+    uint8_t n;
+    struct
+    {
+        uint32_t id;
+        uint32_t run;
+        uint32_t switches;
+    } t[CPU_PROF_TASKS_MAX];
+} cpu_prof_snap_t;
+
+typedef struct
+{
+    cpu_prof_src_t src;
+    cpu_prof_task_t last[CPU_PROF_TASKS_MAX];   /**< tasks of the last sample */
+    int n_last;
+    uint32_t n_fine;                            /**< samples taken */
+    uint32_t n_coarse;
+    cpu_prof_snap_t fine[CPU_PROF_RING_LEN];    /**< by sample % CPU_PROF_RING_LEN */
+    cpu_prof_snap_t coarse[CPU_PROF_RING_LEN];
+} cpu_prof_t;
+
+/* Use of a task over the windows */
+typedef struct
+{
+    cpu_prof_task_t task;                       /**< of the last sample */
+    uint32_t pct[CPU_PROF_WINDOWS];             /**< CPU share, 1/100 % */
+    uint32_t switches[CPU_PROF_WINDOWS];
+} cpu_prof_usage_t;
+
+void cpu_prof_init(cpu_prof_t *p, const cpu_prof_src_t *src);
+
+/**
+ * @brief sample the source, every CPU_PROF_PERIOD_MS
+ *
+ * @return 0, -1 if the source failed
+ */
+int cpu_prof_sample(cpu_prof_t *p);
+
+/**
+ * @brief use of the tasks of the last sample
+ *
+ * @param u         at most max tasks, in the order of the source
+ * @param span_us   length of each window, 0 before 2 samples
+ *
+ * @return tasks
+ */
+int cpu_prof_get(const cpu_prof_t *p, cpu_prof_usage_t *u, int max, uint32_t span_us[CPU_PROF_WINDOWS]);
+
+#endif /* CPU_PROF_H */
@@ -0,0 +1,124 @@
+/**
+ * @file    dlog.c
+ *
+ * @brief   Leveled logging with deferred formatting
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dlog.h"
+#include "bin_report.h"
+#include "reporter.h"
+
+#define DLOG_FRAME_MAX  (BIN_REPORT_HDR_LEN + BIN_REPORT_LOG_HDR_LEN + DLOG_ARGS_MAX * 4 + BIN_REPORT_CRC_LEN)
+
+static const char *const dlog_module_names[DLOG_MOD_COUNT] = {
+    [DLOG_MOD_FIRA] = "FIRA",
+    [DLOG_MOD_BTN] = "BTN",
+    [DLOG_MOD_RESP] = "RESP",
+    [DLOG_MOD_SERVO] = "SERVO",
+    [DLOG_MOD_MON] = "MON",
+};
+
+uint8_t dlog_level[DLOG_MOD_COUNT] = {
+    [0 ... DLOG_MOD_COUNT - 1] = DLOG_LEVEL_DEFAULT
+};
+
+bool dlog_is_deferred(void)
+{
+    return bin_report_is_enabled();
+}
+
+void dlog_emit(dlog_module_e mod, dlog_level_e lvl, const char *fmt, const uint32_t *args, int n_args)
+{
+    uint8_t frame[DLOG_FRAME_MAX];
+    uint16_t len;
+    uint8_t *p;
+
+    if (n_args > DLOG_ARGS_MAX)
+    {
+        n_args = DLOG_ARGS_MAX;
+    }
+
+    /* Straight into the report buffer when the reporter can, a few stores and a CRC */
+    len = (uint16_t)(BIN_REPORT_HDR_LEN + BIN_REPORT_LOG_HDR_LEN + n_args * 4 + BIN_REPORT_CRC_LEN);
+    if (reporter_instance.reserve)
+    {
+        p = reporter_instance.reserve(len);
+        if (p)
+        {
+            reporter_instance.commit(p, bin_report_encode_log(p, len, (uint32_t)(uintptr_t)fmt,
+                                                              (uint8_t)mod, (uint8_t)lvl, args, n_args));
+        }
+        return;
+    }
+
+    len = bin_report_encode_log(frame, sizeof(frame), (uint32_t)(uintptr_t)fmt,
+                                (uint8_t)mod, (uint8_t)lvl, args, n_args);
+    if (len)
+    {
+        reporter_instance.print((char *)frame, len);
+    }
+}
+
+void dlog_printf(const char *fmt, ...)
+{
+    char str[DLOG_LINE_MAX];
+    va_list ap;
+    int len;
+
+    va_start(ap, fmt);
+    len = vsnprintf(str, sizeof(str), fmt, ap);
+    va_end(ap);
+
+    if (len > (int)sizeof(str) - 1)
+    {
+        len = (int)sizeof(str) - 1;
+    }
+    if (len > 0)
+    {
+        reporter_instance.print(str, len);
+    }
+}
+
+void dlog_set_level(dlog_module_e mod, dlog_level_e lvl)
+{
+    if (mod >= DLOG_MOD_COUNT)
+    {
+        memset(dlog_level, lvl, sizeof(dlog_level));
+    }
+    else
+    {
+        dlog_level[mod] = (uint8_t)lvl;
+    }
+}
+
+dlog_module_e dlog_module_by_name(const char *name)
+{
+    for (int i = 0; i < DLOG_MOD_COUNT; i++)
+    {
+        if (strcmp(name, dlog_module_names[i]) == 0)
+        {
+            return (dlog_module_e)i;
+        }
+    }
+    return DLOG_MOD_COUNT;
+}
+
+void dlog_report_levels(void)
+{
+    char str[96];
+    int len = 0;
+
+    for (int i = 0; i < DLOG_MOD_COUNT; i++)
+    {
+        len += snprintf(&str[len], sizeof(str) - len, "%s=%u ", dlog_module_names[i], dlog_level[i]);
+    }
+    len += snprintf(&str[len], sizeof(str) - len, "(max %u)\r\n", DLOG_LEVEL_MAX);
+    reporter_instance.print(str, len);
+}
@@ -0,0 +1,136 @@
+/**
+ * @file    dlog.h
+ *
+ * @brief   Leveled logging with deferred formatting
+ *
+ *          DLOG(module, level, fmt, ...) replaces the snprintf() +
+ *          reporter_instance.print() pairs of the ranging path.
+ *
+ *          - Sites above DLOG_LEVEL_MAX are removed at compile time.
+ *          - Each module has a runtime level, LOGLVL command.
+ *          - In binary report mode (BINREP 1) nothing is formatted on the
+ *            target: the site emits a BIN_REPORT_TYPE_LOG frame holding the
+ *            address of its format string and the raw arguments, expanded on
+ *            the host by tools/bin_report_decode.py --elf <image>.
+ *            Otherwise the line is formatted and printed as before.
+ *
+ *          Format strings live in the .dlog_fmt flash section, so their
+ *          address identifies them. Arguments are passed as 32 bits each:
+ *          integers, characters and pointers to constant strings (%s is
+ *          resolved from the image on the host). Up to DLOG_ARGS_MAX
+ *          arguments, no floating point.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    DLOG_LVL_OFF = 0,
+    DLOG_LVL_ERR,
+    DLOG_LVL_WARN,
+    DLOG_LVL_INFO,
+    DLOG_LVL_DBG,
+} dlog_level_e;
+
+typedef enum {
+    DLOG_MOD_FIRA = 0,   /**< fira_app.c */
+    DLOG_MOD_BTN,        /**< uwb_button_initiator.c */
+    DLOG_MOD_RESP,       /**< uwb_servo_responder.c */
+    DLOG_MOD_SERVO,      /**< HAL_servo.c */
+    DLOG_MOD_MON,        /**< uwb_signal_monitor.c */
+    DLOG_MOD_COUNT
+} dlog_module_e;
+
+#ifndef DLOG_LEVEL_MAX
+#define DLOG_LEVEL_MAX          DLOG_LVL_DBG    /**< compile-time ceiling */
+#endif
+
+#define DLOG_LEVEL_DEFAULT      DLOG_LVL_INFO   /**< runtime level of every module at start */
+#define DLOG_ARGS_MAX           8
+#define DLOG_LINE_MAX           192             /**< immediate mode line buffer */
+
+#define DLOG_SECTION            __attribute__((section(".dlog_fmt")))
+
+extern uint8_t dlog_level[DLOG_MOD_COUNT];
+
+static inline bool dlog_is_enabled(dlog_module_e mod, dlog_level_e lvl)
+{
+    return (lvl <= dlog_level[mod]);
+}
+
+bool dlog_is_deferred(void);
+void dlog_emit(dlog_module_e mod, dlog_level_e lvl, const char *fmt, const uint32_t *args, int n_args);
+void dlog_printf(const char *fmt, ...);
+
+/* Never called: lets the compiler check the arguments against the literal format */
+static inline int __attribute__((format(printf, 1, 2))) dlog_check_format(const char *fmt, ...)
+{
+    (void)fmt;
+    return 0;
+}
+
+/**
+ * @brief Set the runtime level of one module, or of all with DLOG_MOD_COUNT
+ */
+void dlog_set_level(dlog_module_e mod, dlog_level_e lvl);
+
+/**
+ * @brief Look a module up by its upper case name (FIRA, BTN, RESP, SERVO, MON)
+ * @return module, DLOG_MOD_COUNT if unknown
+ */
+dlog_module_e dlog_module_by_name(const char *name);
+
+/**
+ * @brief Print the runtime level of every module, LOGLVL command
+ */
+void dlog_report_levels(void);
+
+/* Argument counting and 32-bit packing, 0..DLOG_ARGS_MAX arguments */
+#define DLOG_NARG(...)          DLOG_NARG_(_0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define DLOG_NARG_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define DLOG_CAT(a, b)          DLOG_CAT_(a, b)
+#define DLOG_CAT_(a, b)         a##b
+#define DLOG_U32(x)             , (uint32_t)(uintptr_t)(x)
+#define DLOG_MAP_0(M)
+#define DLOG_MAP_1(M, a)        M(a)
+#define DLOG_MAP_2(M, a, ...)   M(a) DLOG_MAP_1(M, __VA_ARGS__)
+#define DLOG_MAP_3(M, a, ...)   M(a) DLOG_MAP_2(M, __VA_ARGS__)
+#define DLOG_MAP_4(M, a, ...)   M(a) DLOG_MAP_3(M, __VA_ARGS__)
+#define DLOG_MAP_5(M, a, ...)   M(a) DLOG_MAP_4(M, __VA_ARGS__)
+#define DLOG_MAP_6(M, a, ...)   M(a) DLOG_MAP_5(M, __VA_ARGS__)
+#define DLOG_MAP_7(M, a, ...)   M(a) DLOG_MAP_6(M, __VA_ARGS__)
+#define DLOG_MAP_8(M, a, ...)   M(a) DLOG_MAP_7(M, __VA_ARGS__)
+#define DLOG_MAP(M, ...)        DLOG_CAT(DLOG_MAP_, DLOG_NARG(__VA_ARGS__))(M, ##__VA_ARGS__)
+
+#define DLOG(mod, lvl, fmt, ...)                                                        \
+    do                                                                                  \
+    {                                                                                   \
+        (void)sizeof(dlog_check_format(fmt, ##__VA_ARGS__));                            \
+        if (((lvl) <= DLOG_LEVEL_MAX) && dlog_is_enabled((mod), (lvl)))                 \
+        {                                                                               \
+            static const char DLOG_SECTION dlog_fmt_[] = fmt;                           \
+            if (dlog_is_deferred())                                                     \
+            {                                                                           \
+                const uint32_t dlog_args_[] = { 0 DLOG_MAP(DLOG_U32, ##__VA_ARGS__) };  \
+                dlog_emit((mod), (lvl), dlog_fmt_, &dlog_args_[1],                      \
+                          (int)(sizeof(dlog_args_) / sizeof(dlog_args_[0])) - 1);       \
+            }                                                                           \
+            else                                                                        \
+            {                                                                           \
+                dlog_printf(dlog_fmt_, ##__VA_ARGS__);                                  \
+            }                                                                           \
+        }                                                                               \
+    } while (0)
+
+#define DLOG_ERR(mod, ...)      DLOG(mod, DLOG_LVL_ERR, __VA_ARGS__)
+#define DLOG_WARN(mod, ...)     DLOG(mod, DLOG_LVL_WARN, __VA_ARGS__)
+#define DLOG_INFO(mod, ...)     DLOG(mod, DLOG_LVL_INFO, __VA_ARGS__)
+#define DLOG_DBG(mod, ...)      DLOG(mod, DLOG_LVL_DBG, __VA_ARGS__)
+
+#endif /* DLOG_H */
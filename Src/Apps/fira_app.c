@@ -60,33 +60,10 @@
 #include "default_config.h"
 #include "rf_tuning_config.h"
 
-// --- Rolling code encryption ---
-
-#define ROLLING_SECRET 0xA5C3F1B7u
-uint32_t rolling_code(uint32_t block_num) {
-    // Simple PRNG: xorshift with block_num and secret
-    uint32_t code = block_num ^ ROLLING_SECRET;
-    code ^= code << 13;
-    code ^= code >> 17;
-    code ^= code << 5;
-    return code;
-}
-
-void xor_encrypt(uint8_t *data, uint8_t len, uint32_t code) {
-    for (uint8_t i = 0; i < len; ++i) {
-        data[i] ^= ((code >> ((i % 4) * 8)) & 0xFF);
-    }
-}
+/* AES-CCM* key of the SP1 button payload, shared by initiator and responder */
+const uint8_t sp1_payload_key[16] = {0xA5, 0xC3, 0xF1, 0xB7, 0x01, 0x02, 0x03, 0x04,
+                                     0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C};
 
-// Frequency hopping: define allowed channels
-static const uint8_t fh_channels[] = {5, 7, 9};
-static const uint8_t fh_num_channels = sizeof(fh_channels) / sizeof(fh_channels[0]);
-static uint8_t fh_current_channel_idx = 0;
-
-// Helper to get next channel index (block-based hopping)
-static uint8_t fh_get_channel_idx(uint32_t block_num) {
-    return block_num % fh_num_channels;
-}
 #include "common_fira.h"
 #include "cmd_fn.h"
 #include "int_priority.h"
@@ -103,20 +80,24 @@ static uint8_t fh_get_channel_idx(uint32_t block_num) {
 #include "uwb_button_initiator.h"
 #include "uwb_servo_responder.h"
 #include "uwb_signal_monitor.h"
+#include "bin_report.h"
+#include "dlog.h"
+#include "minmax.h"
+#include "mcps_crypto_cache.h"
+#include "fh_schedule.h"
+#include "trace_point.h"
+#include "peer_table.h"
+#include "fira_report.h"
+#include "sp1_frame.h"
+#include "sp1_xport.h"
+#include "sp1_txq.h"
+#include <FreeRTOS.h>
+#include <semphr.h>
 
 extern void pdoaupdate_lut(void);
 
 #define DATA_TASK_STACK_SIZE_BYTES 1400
 
-/* 0 - no output of PDoA
- * 1 - output of PDoA from uwb_stack, this is supported in 10.x.x
- */
-#if CONFIG_PEG_UWB == 1
-#define OUTPUT_PDOA_ENABLE (1)
-#else
-#define OUTPUT_PDOA_ENABLE (1)
-#endif
-
 static struct uwbmac_context *uwbmac_ctx = NULL;
 static uint32_t current_block_index = 0;
 
@@ -130,6 +111,9 @@ uint32_t fira_get_current_block_index(void) {
  * Maximum IoT data excahnge limited to approx 70 bytes bidirectional per TWR.
  * uwb_stack encrypts and guarantee the integrity of the packet, however the flow control, and
  * retransmission shall be implemented on the upper layer.
+ * That layer is sp1_xport.c. data_task sends one SP1 payload per block, the messages queued in
+ * sp1_txq.c and a frame of the transport in the room left; report_cb hands the messages of the
+ * peers to the button and the transport.
  */
 #define PROPRIETARY_SP1_TWR_EXAMPLE_ENABLE (1)  /* Enabled to support SP1 payloads */
 
@@ -143,16 +127,55 @@ static struct data_parameters data_params = {
 #include <string.h>
 #endif
 
-#define STR_SIZE (256)
-
 uint32_t session_id = 42;  /* Made global for button initiator access */
 static task_signal_t dataTransferTask;
 static bool started = false;
 static bool is_controller = false;  /* Track if this board is controller/initiator */
+static uint16_t local_addr = 0;     /* short address, the source of the SP1 frames sent */
 static void report_cb(const struct ranging_results *results, void *user_data);
 static struct string_measurement output_result;
 struct fira_context fira_ctx;  /* Made global for button initiator access */
 
+/* Message queue and transport of an SP1 session, under sp1_lock: report_cb()
+ * passes the transport the frames of the peers, data_task packs the frame of
+ * the next block */
+static sp1_txq_t *txq = NULL;
+static sp1_xport_t *xport = NULL;
+static SemaphoreHandle_t sp1_lock = NULL;
+static sp1_xport_rx_cb_t xport_rx_cb = NULL;
+static void *xport_rx_arg = NULL;
+
+/* transport frame of the block xp_block, a repack of its SP1 frame reuses it */
+static uint8_t xp_frame[SP1_TXQ_VAL_MAX];
+static int xp_len = 0;
+static uint32_t xp_block = 0;
+
+#define SP1_RX_PRINT_BYTES 32   /* bytes of a transport message shown in hex */
+
+/* @brief receiver of the SP1 transport messages by default: a JSON line
+ *        with the first SP1_RX_PRINT_BYTES bytes
+ * */
+static void sp1_rx_print(uint16_t src, const uint8_t *msg, uint16_t len, void *arg)
+{
+    char str[128];
+    int n;
+
+    (void)arg;
+    DLOG_INFO(DLOG_MOD_FIRA, "SP1 transport: message of %u bytes from 0x%04x\r\n", len, src);
+    if (bin_report_is_enabled())
+    {
+        return;
+    }
+
+    n = snprintf(str, sizeof(str), "{\"SP1RX\":{\"Addr\":\"0x%04x\",\"Len\":%u,\"Data\":\"", src, len);
+    for (int i = 0; i < len && i < SP1_RX_PRINT_BYTES; i++)
+    {
+        n += snprintf(&str[n], sizeof(str) - n, "%02X", msg[i]);
+    }
+    n += snprintf(&str[n], sizeof(str) - n, "\"}}\r\n");
+    reporter_instance.print(str, n);
+}
+
 
 /* fira_app_process_init
  */
@@ -162,33 +185,25 @@ static error_e fira_app_process_init(bool controller, void const *arg)
 
     session_id = fira_param->session_id;
     is_controller = controller;  /* Save for later use */
+    local_addr = fira_param->session.short_addr;
     
-    char role_log[128];
-    int role_len = snprintf(role_log, sizeof(role_log), 
-                       "FiRA_APP_INIT: controller=%d (0=responder, 1=controller)\r\n", controller);
-    reporter_instance.print(role_log, role_len);
-    
+    DLOG_INFO(DLOG_MOD_FIRA, "FiRA_APP_INIT: controller=%d (0=responder, 1=controller)\r\n", controller);
+
     /* Log RF configuration at startup */
-    char rf_log[256];
-    int rlen = snprintf(rf_log, sizeof(rf_log),
-        "%s: RF Init chan=%u preamble=%u sfd=%u rframe=%u slot=%u ms=%u\r\n",
-        controller ? "INIT" : "RESP",
-        fira_param->session.channel_number,
-        fira_param->session.preamble_code_index,
-        fira_param->session.sfd_id,
-        fira_param->session.rframe_config,
-        fira_param->session.slot_duration_rstu,
-        fira_param->session.block_duration_ms);
-    reporter_instance.print(rf_log, rlen);
-    
-    char addr_log[128];
-    int alen = snprintf(addr_log, sizeof(addr_log),
-        "%s: Addr short=0x%04x dest=0x%04x device_type=%u\r\n",
-        controller ? "INIT" : "RESP",
-        fira_param->session.short_addr,
-        fira_param->session.destination_short_address,
-        fira_param->session.device_type);
-    reporter_instance.print(addr_log, alen);
+    DLOG_INFO(DLOG_MOD_FIRA, "%s: RF Init chan=%u preamble=%u sfd=%u rframe=%u slot=%u ms=%u\r\n",
+              controller ? "INIT" : "RESP",
+              fira_param->session.channel_number,
+              fira_param->session.preamble_code_index,
+              fira_param->session.sfd_id,
+              fira_param->session.rframe_config,
+              fira_param->session.slot_duration_rstu,
+              fira_param->session.block_duration_ms);
+
+    DLOG_INFO(DLOG_MOD_FIRA, "%s: Addr short=0x%04x dest=0x%04x device_type=%u\r\n",
+              controller ? "INIT" : "RESP",
+              fira_param->session.short_addr,
+              fira_param->session.destination_short_address,
+              fira_param->session.device_type);
     
     /* Initialize button initiator on controller (initiator) side */
     if (controller)
@@ -204,22 +219,79 @@ static error_e fira_app_process_init(bool controller, void const *arg)
     /* Initialize signal monitoring */
     uwb_signal_monitor_init();
     
-    uint16_t string_len = STR_SIZE * (controller ? fira_param->controlees_params.n_controlees : 1);
+    /* SP1 key of the session: a session run again with it keeps counting
+     * where it stopped, the peers keep their replay windows */
+    int sp1_key = sp1_frame_session_key(sp1_payload_key, session_id, fira_param->session.vupper64);
+    if (sp1_key < 0)
+    {
+        DLOG_WARN(DLOG_MOD_FIRA, "%s: no SP1 session key, CMAC\r\n", controller ? "INIT" : "RESP");
+    }
 
-    output_result.str = malloc(string_len);
+    /* Peers of the session: the controlees on the controller, the controller on a controlee */
+    peer_table_reset(sp1_key == 0);
+    if (controller)
+    {
+        for (int i = 0; i < fira_param->controlees_params.n_controlees; i++)
+        {
+            peer_table_add(fira_param->controlees_params.controlees[i].address);
+        }
+    }
+    else
+    {
+        peer_table_add(fira_param->session.destination_short_address);
+    }
+
+    /* Grows by FIRA_REPORT_STR_SIZE in report_cb up to the largest block reported */
+    output_result.str = malloc(FIRA_REPORT_STR_SIZE);
     if (!(output_result.str))
     {
         char *err = "not enough memory";
         reporter_instance.print((char *)err, strlen(err));
         return _ERR_Cannot_Alloc_Memory;
     }
-    output_result.len = string_len;
+    output_result.len = FIRA_REPORT_STR_SIZE;
+
+    // SP1 queue and transport restart with the session
+    if (fira_param->session.rframe_config == FIRA_RFRAME_CONFIG_SP1)
+    {
+        if (!sp1_lock)
+        {
+            sp1_lock = xSemaphoreCreateMutex();
+        }
+        txq = malloc(sizeof(sp1_txq_t));
+        xport = malloc(SP1_XPORT_SIZE(SP1_XP_MSG_MAX, SP1_XP_MSG_MAX));
+        if (!txq || !xport || !sp1_lock || mcps_crypto_ccm_cache_init() != 0)
+        {
+            free(txq);
+            free(xport);
+            txq = NULL;
+            xport = NULL;
+            DLOG_WARN(DLOG_MOD_FIRA, "%s: no SP1 messages, not enough memory\r\n",
+                      controller ? "INIT" : "RESP");
+        }
+        else
+        {
+            sp1_txq_init(txq);
+            sp1_xport_init(xport, fira_param->session.short_addr, SP1_XP_MSG_MAX, SP1_XP_MSG_MAX,
+                           xport_rx_cb ? xport_rx_cb : sp1_rx_print, xport_rx_arg);
+            xp_len = 0;
+        }
+    }
 
     // Update LUT for the current antenna set
     pdoaupdate_lut();
 
     fira_uwb_mcps_init(fira_param);
 
+    // Frequency hopping: both boards derive the same schedule from the session key
+    if (fh_schedule_init(sp1_payload_key, session_id, fira_param->session.vupper64,
+                         fira_param->session.channel_number,
+                         fira_param->session.preamble_code_index) != 0)
+    {
+        DLOG_WARN(DLOG_MOD_FIRA, "%s: no frequency hopping, AES context\r\n",
+                  controller ? "INIT" : "RESP");
+    }
+
     int r = uwbmac_init(&uwbmac_ctx);
     assert(r == UWBMAC_SUCCESS);
 
@@ -255,12 +327,9 @@ static error_e fira_app_process_init(bool controller, void const *arg)
     if (controller)
     {
         // Add controlee session parameters;
-        char clee_log[128];
-        int clen = snprintf(clee_log, sizeof(clee_log),
-            "INIT: Adding %d controlee(s) to session\r\n",
-            fira_param->controlees_params.n_controlees);
-        reporter_instance.print(clee_log, clen);
-        
+        DLOG_INFO(DLOG_MOD_FIRA, "INIT: Adding %d controlee(s) to session\r\n",
+                  fira_param->controlees_params.n_controlees);
+
         r = fira_helper_add_controlees(&fira_ctx, session_id, &fira_param->controlees_params);
         assert(r == UWBMAC_SUCCESS);
     }
@@ -269,23 +338,20 @@ static error_e fira_app_process_init(bool controller, void const *arg)
 
 static void fira_app_process_start(void)
 {
-    char str_start[] = ">>> FiRa process starting <<<\r\n";
-    reporter_instance.print(str_start, strlen(str_start));
-    
+    DLOG_INFO(DLOG_MOD_FIRA, ">>> FiRa process starting <<<\r\n");
+
     /* OK, let's start. */
     int r = uwbmac_start(uwbmac_ctx);
     assert(r == UWBMAC_SUCCESS);
-    
-    char str_mac[] = ">>> uwbmac_start OK <<<\r\n";
-    reporter_instance.print(str_mac, strlen(str_mac));
-    
+
+    DLOG_INFO(DLOG_MOD_FIRA, ">>> uwbmac_start OK <<<\r\n");
+
     // Start session;
     r = fira_helper_start_session(&fira_ctx, session_id);
     assert(r == UWBMAC_SUCCESS);
-    
-    char str_sess[] = ">>> fira_helper_start_session OK <<<\r\n";
-    reporter_instance.print(str_sess, strlen(str_sess));
-    
+
+    DLOG_INFO(DLOG_MOD_FIRA, ">>> fira_helper_start_session OK <<<\r\n");
+
     started = true;
 }
 
@@ -305,6 +371,10 @@ static error_e fira_app_process_terminate(void)
         assert(!r);
         fira_helper_close(&fira_ctx);
 
+        // drop the SP1 payload contexts with the session keys
+        mcps_crypto_ccm_cache_flush();
+        fh_schedule_deinit();
+
         // unregister driver;
         fira_uwb_mcps_deinit();
 
@@ -313,40 +383,71 @@ static error_e fira_app_process_terminate(void)
     return _NO_ERR;
 }
 
-static float convert_aoa_2pi_q16_to_deg(int16_t aoa_2pi_q16)
+/* @brief binary counterpart of the JSON output at the end of report_cb()
+ * */
+static void report_block_bin(const struct ranging_results *results, bool is_responder,
+                             float diag_rssi, int diag_nlos)
 {
-    return (360.0 * aoa_2pi_q16 / (1 << 16));
+    uint8_t frame[BIN_REPORT_MAX_FRAME];
+    bin_report_diag_t diag = {
+        .valid = fira_uwb_is_diag_enabled(),
+        .rssi_ddbm = (int16_t)(diag_rssi * 10.0f),
+        .nlos_pct = (uint8_t)diag_nlos,
+        .cfo = fira_uwb_mcps_get_cfo_ppm(),
+    };
+
+    /* Encode straight into the report buffer */
+    int n = MIN(MAX(results->n_measurements, 0), FIRA_CONTROLEES_MAX);
+    int need = BIN_REPORT_BLOCK_FRAME_LEN(n);
+    if (reporter_instance.reserve)
+    {
+        uint8_t *p = reporter_instance.reserve(need);
+        if (p)
+        {
+            reporter_instance.commit(p, bin_report_encode_block(p, (uint16_t)need, results, &diag, is_responder));
+        }
+        return;
+    }
+
+    uint16_t len = bin_report_encode_block(frame, sizeof(frame), results, &diag, is_responder);
+    if (len)
+    {
+        reporter_instance.print((char *)frame, len);
+    }
 }
 
 static void report_cb(const struct ranging_results *results, void *user_data)
 {
     fira_param_t *fira_param_local = get_fira_config();
     bool is_responder = (fira_param_local->session.device_type == FIRA_DEVICE_TYPE_CONTROLEE);
+    bool bin_mode = bin_report_is_enabled();
     
     /* Always log session events */
     if (results->stopped_reason != 0xFF)
     {
-        char stop_log[96];
-        int slen = snprintf(stop_log, sizeof(stop_log), "%s: Session stopped (reason=%u)\r\n",
-                           is_responder ? "RESP" : "INIT", results->stopped_reason);
-        reporter_instance.print(stop_log, slen);
+        if (bin_mode)
+        {
+            uint8_t frame[BIN_REPORT_HDR_LEN + BIN_REPORT_STOP_LEN + BIN_REPORT_CRC_LEN];
+            uint16_t flen = bin_report_encode_stop(frame, sizeof(frame), results->block_index,
+                                                   results->stopped_reason);
+            reporter_instance.print((char *)frame, flen);
+            return;
+        }
+        DLOG_INFO(DLOG_MOD_FIRA, "%s: Session stopped (reason=%u)\r\n",
+                  is_responder ? "RESP" : "INIT", results->stopped_reason);
         return;
     }
 
-    // Frequency hopping: update channel before each block
+    /* clock alignment anchor of tools/trace_merge.py */
+    TRACE_POINT(TRACE_BLOCK, 0, (uint16_t)results->block_index);
+
+    // Frequency hopping: stage the next block's hop, the chip is reconfigured
+    // when it wakes up for that block (both boards must use same schedule)
     current_block_index = results->block_index;
-    uint8_t next_channel_idx = fh_get_channel_idx(results->block_index);
-    if (next_channel_idx != fh_current_channel_idx) {
-        fh_current_channel_idx = next_channel_idx;
-        uint8_t next_channel = fh_channels[fh_current_channel_idx];
-        // Update session channel (both boards must use same schedule)
-        fira_param_t *fira_param = get_fira_config();
-        fira_param->session.channel_number = next_channel;
-        fira_set_session_parameters(&fira_ctx, session_id, &fira_param->session);
-        char ch_log[64];
-        int chlen = snprintf(ch_log, sizeof(ch_log), "%s: Frequency hop to channel %u (block %u)\r\n",
-            is_responder ? "RESP" : "INIT", next_channel, results->block_index);
-        reporter_instance.print(ch_log, chlen);
+    fh_hop_t hop;
+    if (fh_schedule_stage(results->block_index + 1, &hop)) {
+        DLOG_DBG(DLOG_MOD_FIRA, "%s: Frequency hop to channel %u code %u (block %" PRIu32 ")\r\n",
+                 is_responder ? "RESP" : "INIT", hop.chan, hop.pcode, results->block_index + 1);
     }
     
     /* Log all measurements with ultra-verbose status plus diag snapshot */
@@ -357,116 +458,99 @@ static void report_cb(const struct ranging_results *results, void *user_data)
         fira_uwb_get_diag(&diag_rssi, &diag_nlos);
     }
 
-    char block_log[196];
-    int blog = snprintf(block_log, sizeof(block_log), 
-                       "%s: Block %u measurements=%d stopped_reason=%u diag_rssi=%.1f diag_nlos=%d%%\r\n",
-                       is_responder ? "RESP" : "INIT", results->block_index, 
-                       results->n_measurements, results->stopped_reason,
-                       diag_rssi, diag_nlos);
-    reporter_instance.print(block_log, blog);
+    DLOG_DBG(DLOG_MOD_FIRA, "%s: Block %" PRIu32 " measurements=%d stopped_reason=%u diag_rssi_ddbm=%d diag_nlos=%d%%\r\n",
+             is_responder ? "RESP" : "INIT", results->block_index,
+             results->n_measurements, results->stopped_reason,
+             (int)(diag_rssi * 10.0f), diag_nlos);
     
     /* Check for button payload from initiator */
     if (results->n_measurements > 0)
     {
-        uint16_t expected_peer = fira_param_local->session.destination_short_address;
-
         for (int i = 0; i < results->n_measurements; i++)
         {
             struct ranging_measurements *rm_local = (struct ranging_measurements *)(&results->measurements[i]);
 
             /* Gate by peer short address to avoid stray devices */
-            if (rm_local->short_addr != expected_peer)
+            peer_t *peer = peer_table_find(rm_local->short_addr);
+            if (!peer)
             {
-                char skip_log[96];
-                int slog = snprintf(skip_log, sizeof(skip_log), 
-                                   "%s: [%d] SKIP addr 0x%04x (expected 0x%04x)\r\n",
-                                   is_responder ? "RESP" : "INIT", i, rm_local->short_addr, expected_peer);
-                reporter_instance.print(skip_log, slog);
+                DLOG_DBG(DLOG_MOD_FIRA, "%s: [%d] SKIP addr 0x%04x (not a peer)\r\n",
+                         is_responder ? "RESP" : "INIT", i, rm_local->short_addr);
                 continue;
             }
-
-            /* Decrypt SP1 payload if present, with rolling code window */
-            if (rm_local->sp1_data_len >= 12) {
-                uint8_t key[16] = {0xA5, 0xC3, 0xF1, 0xB7, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C};
-                uint8_t mac[8] = {0};
-                memcpy(mac, rm_local->sp1_data + (rm_local->sp1_data_len - 8), 8);
-                int window = 5; // Accept up to 5 future block indices
-                int accepted = 0;
-                uint32_t start_block = results->block_index;
-                for (int w = 0; w < window; ++w) {
-                    uint32_t try_block = start_block + w;
-                    uint8_t nonce[13] = {0};
-                    memcpy(nonce, &try_block, sizeof(try_block));
-                    void *ccm_ctx = mcps_crypto_aead_aes_ccm_star_128_create(key);
-                    int dec_result = mcps_crypto_aead_aes_ccm_star_128_decrypt(
-                        ccm_ctx,
-                        nonce,
-                        NULL, 0, // No header
-                        (uint8_t*)rm_local->sp1_data,
-                        rm_local->sp1_data_len - 8,
-                        mac,
-                        sizeof(mac)
-                    );
-                    char dbg[160];
-                    int dbglen = snprintf(dbg, sizeof(dbg),
-                        "[DEBUG][RESP] AES-CCM* window decrypt try_block=%lu result=%d len=%u MAC=[%02X %02X %02X %02X %02X %02X %02X %02X]\r\n",
-                        (unsigned long)try_block, dec_result, rm_local->sp1_data_len,
-                        mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], mac[6], mac[7]);
-                    reporter_instance.print(dbg, dbglen);
-                    mcps_crypto_aead_aes_ccm_star_128_destroy(ccm_ctx);
-                    if (dec_result == 0) {
-                        accepted = 1;
-                        // Optionally: update expected block index here if you track it
-                        char sync_log[96];
-                        int slen = snprintf(sync_log, sizeof(sync_log),
-                            "[DEBUG][RESP] Rolling code window sync: accepted block=%lu (offset=%d)\r\n",
-                            (unsigned long)try_block, w);
-                        reporter_instance.print(sync_log, slen);
-                        break;
+            /* Block index back to an earlier one: the controller started its
+             * session again and its transport with it. The replay window
+             * stays, it goes with the session key */
+            if (is_responder && results->block_index < peer->last_block && xport)
+            {
+                xSemaphoreTake(sp1_lock, portMAX_DELAY);
+                sp1_xport_reset(xport);
+                xSemaphoreGive(sp1_lock);
+            }
+            peer_table_measure(peer, results->block_index, rm_local->status, rm_local->distance_mm);
+
+            /* Decrypt SP1 payload if present: one decryption under the
+             * counter of the frame, replays dropped before it */
+            if (rm_local->sp1_data_len > 0) {
+                uint8_t plain[FIRA_DATA_PAYLOAD_SIZE_MAX];
+                uint32_t ctr = 0;
+                /* One keyed context, kept for the session */
+                void *ccm_ctx = mcps_crypto_ccm_cache_get(SP1_KEY_ID_RX, sp1_frame_key());
+                int plen = sp1_frame_open(ccm_ctx, &peer->sp1_rp, peer->addr,
+                                          is_responder ? SP1_DIR_DOWN : SP1_DIR_UP, rm_local->sp1_data,
+                                          (uint16_t)MIN(rm_local->sp1_data_len, FIRA_DATA_PAYLOAD_SIZE_MAX),
+                                          plain, &ctr);
+                mcps_crypto_ccm_cache_put(ccm_ctx);
+                if (plen > 0) {
+                    peer->n_sp1++;
+                    memcpy(rm_local->sp1_data, plain, plen);
+                    rm_local->sp1_data_len = plen;
+                    DLOG_DBG(DLOG_MOD_FIRA, "%s: SP1 counter=%lu accepted, len=%d\r\n",
+                             is_responder ? "RESP" : "INIT", (unsigned long)ctr, plen);
+                } else {
+                    if (plen == SP1_E_REPLAY) {
+                        peer->n_sp1_replay++;
+                    } else {
+                        peer->n_sp1_rej++;
                     }
-                }
-                if (!accepted) {
-                    char rej_log[96];
-                    int rlen = snprintf(rej_log, sizeof(rej_log),
-                        "[DEBUG][RESP] Rolling code window: all attempts failed, payload rejected\r\n");
-                    reporter_instance.print(rej_log, rlen);
+                    rm_local->sp1_data_len = 0;
+                    DLOG_WARN(DLOG_MOD_FIRA, "%s: SP1 counter=%lu from 0x%04x rejected: %s\r\n",
+                              is_responder ? "RESP" : "INIT", (unsigned long)ctr, peer->addr,
+                              (plen == SP1_E_REPLAY) ? "replay" : (plen == SP1_E_SHORT) ? "short" : "MIC");
                 }
             }
 
-            /* Detailed measurement status with human-readable error codes */
-            const char *status_str;
-            switch (rm_local->status) {
-                case 0:  status_str = "OK"; break;
-                case 1:  status_str = "TX_FAIL"; break;
-                case 2:  status_str = "RX_TIMEOUT"; break;
-                case 3:  status_str = "RX_PHY_DEC"; break;
-                case 4:  status_str = "RX_TOA"; break;
-                case 5:  status_str = "RX_STS"; break;
-                case 6:  status_str = "RX_MAC_DEC"; break;
-                case 7:  status_str = "RX_MAC_IE_DEC"; break;
-                case 8:  status_str = "RX_MAC_IE_MISS"; break;
-                default: status_str = "UNKNOWN"; break;
-            }
+            if (dlog_is_enabled(DLOG_MOD_FIRA, DLOG_LVL_DBG))
+            {
+                /* Detailed measurement status with human-readable error codes */
+                const char *status_str;
+                switch (rm_local->status) {
+                    case 0:  status_str = "OK"; break;
+                    case 1:  status_str = "TX_FAIL"; break;
+                    case 2:  status_str = "RX_TIMEOUT"; break;
+                    case 3:  status_str = "RX_PHY_DEC"; break;
+                    case 4:  status_str = "RX_TOA"; break;
+                    case 5:  status_str = "RX_STS"; break;
+                    case 6:  status_str = "RX_MAC_DEC"; break;
+                    case 7:  status_str = "RX_MAC_IE_DEC"; break;
+                    case 8:  status_str = "RX_MAC_IE_MISS"; break;
+                    default: status_str = "UNKNOWN"; break;
+                }
             
-            char meas_log[224];
-            int mlog = snprintf(meas_log, sizeof(meas_log), 
-                               "%s: [%d] 0x%04x status=%u(%s) payload_len=%u dist=%ld slot=%u "
-                               "nlos=%d los=%d rssi=%u fom=%u diag_rssi=%.1f diag_nlos=%d%%\r\n",
-                               is_responder ? "RESP" : "INIT", i,
-                               rm_local->short_addr, rm_local->status, status_str,
-                               rm_local->sp1_data_len, (long)rm_local->distance_mm,
-                               rm_local->slot_index, rm_local->nlos, rm_local->los,
-                               rm_local->rssi, rm_local->remote_aoa_azimuth_fom,
-                               diag_rssi, diag_nlos);
-            reporter_instance.print(meas_log, mlog);
-            // Deep debug: always print sp1_data_len and first 8 bytes of sp1_data
-            char debug_log[128];
-            int dlog = snprintf(debug_log, sizeof(debug_log),
-                "[DEBUG] RX: sp1_data_len=%u, sp1_data=[%02X %02X %02X %02X %02X %02X %02X %02X] (first 8 bytes)\r\n",
-                rm_local->sp1_data_len,
-                rm_local->sp1_data[0], rm_local->sp1_data[1], rm_local->sp1_data[2], rm_local->sp1_data[3],
-                rm_local->sp1_data[4], rm_local->sp1_data[5], rm_local->sp1_data[6], rm_local->sp1_data[7]);
-            reporter_instance.print(debug_log, dlog);
+                DLOG_DBG(DLOG_MOD_FIRA, "%s: [%d] 0x%04x status=%u(%s) payload_len=%u dist=%ld slot=%u\r\n",
+                         is_responder ? "RESP" : "INIT", i,
+                         rm_local->short_addr, rm_local->status, status_str,
+                         rm_local->sp1_data_len, (long)rm_local->distance_mm,
+                         rm_local->slot_index);
+                DLOG_DBG(DLOG_MOD_FIRA, "%s: [%d] nlos=%d los=%d rssi=%u fom=%u diag_rssi_ddbm=%d diag_nlos=%d%%\r\n",
+                         is_responder ? "RESP" : "INIT", i,
+                         rm_local->nlos, rm_local->los, rm_local->rssi, rm_local->remote_aoa_azimuth_fom,
+                         (int)(diag_rssi * 10.0f), diag_nlos);
+                DLOG_DBG(DLOG_MOD_FIRA, "[DEBUG] RX: sp1_data_len=%u, sp1_data=[%02X %02X %02X %02X %02X %02X %02X] (first 7 bytes)\r\n",
+                         rm_local->sp1_data_len,
+                         rm_local->sp1_data[0], rm_local->sp1_data[1], rm_local->sp1_data[2], rm_local->sp1_data[3],
+                         rm_local->sp1_data[4], rm_local->sp1_data[5], rm_local->sp1_data[6]);
+            }
             
             /* Log successful RX to signal monitor */
             if (rm_local->status == 0)
@@ -480,113 +564,79 @@ static void report_cb(const struct ranging_results *results, void *user_data)
                                         SIGNAL_EVENT_RX_ERROR, rm_local->status);
             }
 
-            /* On responder: check for BTN payload marker even if status is non-zero */
-            if (is_responder && rm_local->sp1_data_len >= 4)
+            /* The messages of the SP1 frame, even if status is non-zero */
+            if (rm_local->sp1_data_len > 0)
             {
                 const uint8_t *data = (const uint8_t *)(rm_local->sp1_data);
-                char payload_log[96];
-                int plog = snprintf(payload_log, sizeof(payload_log), 
-                                   "RESP: SP1 data: [0x%02x 0x%02x 0x%02x 0x%02x]\r\n",
-                                   data[0], data[1], data[2], data[3]);
-                reporter_instance.print(payload_log, plog);
-                
-                /* Signal payload reception */
-                uwb_signal_monitor_event(is_controller, rm_local->short_addr, 
-                                        SIGNAL_EVENT_PAYLOAD_RX, 
-                                        (data[3] << 24) | (data[2] << 16) | (data[1] << 8) | data[0]);
-                
-                if (data[0] == 'B' && data[1] == 'T' && data[2] == 'N')
-                {
-                    uint8_t btn_counter = data[3];
-                    char logbuf[96];
-                    int l = snprintf(logbuf, sizeof(logbuf), 
-                                    "RESP: *** BTN MATCH *** counter=%u SERVO TRIGGER\r\n", 
-                                    (unsigned)btn_counter);
-                    reporter_instance.print(logbuf, l);
-                    
-                    /* Trigger servo with button counter */
-                    uwb_servo_responder_signal_received(btn_counter);
-                    break;
-                }
-            }
-        }
-    }
-    int len = 0;
-    uint32_t seq = 0;
-    struct string_measurement *str_result = (struct string_measurement *)user_data;
-    struct ranging_measurements *rm;
-    fira_param_t *fira_param = get_fira_config();
-
-    if (results->stopped_reason != 0xFF)
-    {
-        len = sprintf(str_result->str, "{\"Session Stopped\":\"%s\"}\r\n",
-                      (results->stopped_reason == 0x0) ? "Stop request" :
-                      (results->stopped_reason == 0x1) ? "Inband Stop" :
-                      (results->stopped_reason == 0x2) ? "Max attempts" : "Unknown");
-
-        reporter_instance.print(str_result->str, len);
-        return;
-    }
-
-    len = sprintf(str_result->str, "{\"Block\":%" PRIu32 ", \"results\":[", results->block_index);
+                const uint8_t *p = data, *val;
+                uint8_t type, len;
+                int r;
 
-    for (int i = 0; i < results->n_measurements; i++)
-    {
-        if (i > 0)
-        {
-            len += snprintf(&str_result->str[len], str_result->len - len, ",");
-        }
-
-        rm = (struct ranging_measurements *)(&results->measurements[i]);
-
-        len += snprintf(&str_result->str[len], str_result->len - len,
-                        "{\"Addr\":\"0x%04x\",\"Status\":\"%s\"",
-                        rm->short_addr, (rm->status) ? ("Err") : ("Ok"));
-
-        if (rm->status == 0)
-        {
-            len += snprintf(&str_result->str[len], str_result->len - len, ",\"D_cm\":%d",
-                            (int)(rm->distance_mm / 10));
-
-#if (OUTPUT_PDOA_ENABLE == 1)
-            len += snprintf(&str_result->str[len], str_result->len - len,
-                            ",\"LPDoA_deg\":%0.2f,\"LAoA_deg\":%0.2f,\"LFoM\":%d,\"RAoA_deg\":%0.2f",
-                            convert_aoa_2pi_q16_to_deg(rm->local_aoa_measurements[0].pdoa_2pi),
-                            convert_aoa_2pi_q16_to_deg(rm->local_aoa_measurements[0].aoa_2pi),
-                            rm->local_aoa_measurements[0].aoa_fom,
-                            convert_aoa_2pi_q16_to_deg(rm->remote_aoa_azimuth_2pi));
-#endif
+                if (is_responder && rm_local->sp1_data_len >= 4)
+                {
+                    DLOG_DBG(DLOG_MOD_FIRA, "RESP: SP1 data: [0x%02x 0x%02x 0x%02x 0x%02x]\r\n",
+                             data[0], data[1], data[2], data[3]);
 
-            len += snprintf(&str_result->str[len], str_result->len - len, ",\"CFO_100ppm\":%d", (int)fira_uwb_mcps_get_cfo_ppm());
+                    /* Signal payload reception */
+                    uwb_signal_monitor_event(is_controller, rm_local->short_addr,
+                                            SIGNAL_EVENT_PAYLOAD_RX,
+                                            (data[3] << 24) | (data[2] << 16) | (data[1] << 8) | data[0]);
+                }
 
-#if (PROPRIETARY_SP1_TWR_EXAMPLE_ENABLE == 1)
-            if (fira_param->session.rframe_config == FIRA_RFRAME_CONFIG_SP1)
-            {
-                if (rm->payload_seq_sent > seq)
+                while ((r = sp1_tlv_next(&p, data + rm_local->sp1_data_len, &type, &val, &len)) == 1)
                 {
-                    if (osSignalSet(dataTransferTask.Handle, DATA_TRANSFER) == 0x80000000)
-                    {
-                        error_handler(1, _ERR_Signal_Bad);
-                    }
-
-                    seq = rm->payload_seq_sent;
+                    uint8_t btn_counter;
+                    uint16_t corr;
 
-                    len += snprintf(&str_result->str[len], str_result->len - len, ",\"SEQ\":%" PRIu32 "", seq);
+                    if (type == SP1_TLV_BTN && is_responder && sp1_btn_get(val, len, &btn_counter, &corr))
+                    {
+                        TRACE_POINT(TRACE_SP1_RX, corr, btn_counter);
+                        DLOG_INFO(DLOG_MOD_FIRA, "RESP: *** BTN MATCH *** counter=%u SERVO TRIGGER\r\n",
+                                  (unsigned)btn_counter);
 
-                    if (rm->sp1_data_len > 0)
+                        /* Trigger servo with button counter */
+                        uwb_servo_responder_signal_received(peer, btn_counter, corr);
+                    }
+                    else if (type == SP1_TLV_XPORT && xport)
                     {
-                        uint8_t *data = (uint8_t *)(rm->sp1_data);
-                        len += snprintf(&str_result->str[len], str_result->len - len,
-                                        ",\"DATA\":\"%02X:%02X:%02X\"", data[0], data[1], data[2]); // <- Printing of received data from another device
+                        xSemaphoreTake(sp1_lock, portMAX_DELAY);
+                        sp1_xport_rx(xport, peer->addr, val, len);
+                        xSemaphoreGive(sp1_lock);
                     }
                 }
+                if (r < 0)
+                {
+                    DLOG_WARN(DLOG_MOD_FIRA, "%s: SP1 frame of 0x%04x truncated\r\n",
+                              is_responder ? "RESP" : "INIT", peer->addr);
+                }
             }
-#endif
         }
-        len += snprintf(&str_result->str[len], str_result->len - len, "}");
     }
 
-    len += snprintf(&str_result->str[len], str_result->len - len, "]");
+#if (PROPRIETARY_SP1_TWR_EXAMPLE_ENABLE == 1)
+    /* one SP1 frame per block: data_task packs the next one */
+    if (txq && (sp1_txq_pending(txq) || sp1_xport_pending(xport)))
+    {
+        if (osSignalSet(dataTransferTask.Handle, DATA_TRANSFER) == 0x80000000)
+        {
+            error_handler(1, _ERR_Signal_Bad);
+        }
+    }
+#endif
+
+    if (bin_mode)
+    {
+        report_block_bin(results, is_responder, diag_rssi, diag_nlos);
+        return;
+    }
+
+    int len = 0;
+    uint32_t seq = 0;
+    struct string_measurement *str_result = (struct string_measurement *)user_data;
+    fira_param_t *fira_param = get_fira_config();
+    bool sp1 = (PROPRIETARY_SP1_TWR_EXAMPLE_ENABLE == 1) && (fira_param->session.rframe_config == FIRA_RFRAME_CONFIG_SP1);
+
+    len = fira_report_block_json(str_result, results, fira_uwb_mcps_get_cfo_ppm(), sp1 ? &seq : NULL);
 
     /* Display RSSI, CFO and NLOS */
     if (fira_uwb_is_diag_enabled())
@@ -599,7 +649,25 @@ static void report_cb(const struct ranging_results *results, void *user_data)
 }
 
 #if (PROPRIETARY_SP1_TWR_EXAMPLE_ENABLE == 1)
-/* @brief DW3000 RX : RTOS implementation
+/* @brief fill of the SP1 frame: the transport frame of block in a TLV. It is
+ *        built once per block, the segments in it count as sent; a repack
+ *        of the frame with less room drops it, the segments go again on
+ *        their timeout.
+ * */
+static int sp1_fill_xport(void *arg, uint32_t block, uint8_t *buf, int room)
+{
+    (void)arg;
+
+    if (xp_len <= 0 || block != xp_block)
+    {
+        xp_len = sp1_xport_build(xport, block, xp_frame, MIN(room - SP1_TLV_HDR_LEN, (int)sizeof(xp_frame)));
+        xp_block = block;
+    }
+    return (xp_len > 0) ? sp1_tlv_put(buf, room, SP1_TLV_XPORT, xp_frame, xp_len) : 0;
+}
+
+/* @brief SP1 data: the frame of the next block, woken by report_cb() while
+ *        messages or the transport wait, and by each message queued
  *
  * */
 static void data_task(void const *arg)
@@ -611,12 +679,35 @@ static void data_task(void const *arg)
         {
             break;
         }
-        // Encrypt payload before sending
-        if (data_params.data_payload_len > 0) {
-            uint32_t code = rolling_code(0); // TODO: replace 0 with current block number if available
-            xor_encrypt(data_params.data_payload, data_params.data_payload_len, code);
+        // Next SP1 frame, the only payload the MAC sends in the block: a
+        // message queued later in the block packs it again
+        struct data_parameters params;
+        uint8_t plain[sizeof(params.data_payload) - SP1_FRAME_OVERHEAD];
+        int n = 0;
+
+        if (txq)
+        {
+            xSemaphoreTake(sp1_lock, portMAX_DELAY);
+            n = sp1_txq_pack(txq, current_block_index + 1, plain, sizeof(plain), sp1_fill_xport, NULL);
+            xSemaphoreGive(sp1_lock);
+        }
+        if (n <= 0)
+        {
+            continue;
+        }
+
+        uint32_t ctr = sp1_frame_tx_next();
+        void *ccm_ctx = mcps_crypto_ccm_cache_get(SP1_KEY_ID_TX, sp1_frame_key());
+        int flen = sp1_frame_seal(ccm_ctx, ctr, local_addr, is_controller ? SP1_DIR_DOWN : SP1_DIR_UP,
+                                  plain, (uint16_t)n, params.data_payload, sizeof(params.data_payload));
+        mcps_crypto_ccm_cache_put(ccm_ctx);
+        if (flen < 0)
+        {
+            DLOG_ERR(DLOG_MOD_FIRA, "SP1: seal failed (%d)\r\n", flen);
+            continue;
         }
-        fira_helper_send_data(&fira_ctx, session_id, &data_params);
+        params.data_payload_len = flen;
+        fira_helper_send_data(&fira_ctx, session_id, &params);
     };
     dataTransferTask.Exit = 2;
     while (dataTransferTask.Exit == 2)
@@ -683,12 +774,9 @@ static void fira_app(bool controller, void *arg)
     int r = uwbmac_start(uwbmac_ctx);
     assert(r == UWBMAC_SUCCESS);
     
-    char startup_log[128];
-    int slen = snprintf(startup_log, sizeof(startup_log), 
-                       "%s: UWB MAC started, starting FiRa session...\r\n",
-                       is_controller ? "INIT" : "RESP");
-    reporter_instance.print(startup_log, slen);
-    
+    DLOG_INFO(DLOG_MOD_FIRA, "%s: UWB MAC started, starting FiRa session...\r\n",
+              is_controller ? "INIT" : "RESP");
+
     /* Both initiator and responder start sessions immediately for proper sync
      * Button controls application behavior (servo), not session lifecycle
      */
@@ -696,11 +784,8 @@ static void fira_app(bool controller, void *arg)
     assert(r == UWBMAC_SUCCESS);
     started = true;
     
-    char session_log[128];
-    int slen2 = snprintf(session_log, sizeof(session_log), 
-                        "%s: FiRa session %u started!\r\n",
-                        is_controller ? "INIT" : "RESP", session_id);
-    reporter_instance.print(session_log, slen2);
+    DLOG_INFO(DLOG_MOD_FIRA, "%s: FiRa session %" PRIu32 " started!\r\n",
+              is_controller ? "INIT" : "RESP", session_id);
 
     leave_critical_section(); /**< all RTOS tasks can be scheduled */
 }
@@ -716,6 +801,16 @@ void fira_terminate(void)
     fira_app_process_terminate();
     terminate_task(&dataTransferTask);
 
+    if (txq)
+    {
+        xSemaphoreTake(sp1_lock, portMAX_DELAY);
+        free(txq);
+        free(xport);
+        txq = NULL;
+        xport = NULL;
+        xSemaphoreGive(sp1_lock);
+    }
+
     uwbmac_exit(uwbmac_ctx);
 
     hal_uwb.sleep_enter();
@@ -736,6 +831,105 @@ void fira_helper_controlee(const void *arg_fira_param)
     fira_app(false, fira_param);
 }
 
+int fira_app_sp1_push(uint8_t type, const uint8_t *val, uint8_t len)
+{
+    int r = FIRA_APP_SP1_E_NONE;
+
+    if (!sp1_lock)
+    {
+        return r;
+    }
+    xSemaphoreTake(sp1_lock, portMAX_DELAY);
+    if (started && txq)
+    {
+        r = sp1_txq_push(txq, current_block_index, type, val, len);
+    }
+    xSemaphoreGive(sp1_lock);
+
+    /* into the frame of the next block, packed again if need be */
+    if (r == 0 && dataTransferTask.Handle)
+    {
+        osSignalSet(dataTransferTask.Handle, DATA_TRANSFER);
+    }
+    return r;
+}
+
+bool fira_app_sp1_txq_stats(sp1_txq_stats_t *st)
+{
+    bool ok = false;
+
+    if (!sp1_lock)
+    {
+        return false;
+    }
+    xSemaphoreTake(sp1_lock, portMAX_DELAY);
+    if (txq)
+    {
+        *st = txq->st;
+        ok = true;
+    }
+    xSemaphoreGive(sp1_lock);
+    return ok;
+}
+
+int fira_app_sp1_send(uint16_t dst, const uint8_t *msg, uint16_t len)
+{
+    int r = FIRA_APP_SP1_E_NONE;
+
+    if (!sp1_lock)
+    {
+        return r;
+    }
+    xSemaphoreTake(sp1_lock, portMAX_DELAY);
+    if (started && xport)
+    {
+        r = sp1_xport_send(xport, dst, msg, len);
+    }
+    xSemaphoreGive(sp1_lock);
+
+    /* the first segment goes in the next block */
+    if (r == 0 && dataTransferTask.Handle)
+    {
+        osSignalSet(dataTransferTask.Handle, DATA_TRANSFER);
+    }
+    return r;
+}
+
+void fira_app_sp1_set_rx_cb(sp1_xport_rx_cb_t cb, void *arg)
+{
+    xport_rx_cb = cb;
+    xport_rx_arg = arg;
+}
+
+bool fira_app_sp1_stats(sp1_xport_stats_t *st, bool *tx_busy)
+{
+    bool ok = false;
+
+    if (!sp1_lock)
+    {
+        return false;
+    }
+    xSemaphoreTake(sp1_lock, portMAX_DELAY);
+    if (xport)
+    {
+        *st = xport->st;
+        *tx_busy = sp1_xport_tx_busy(xport);
+        ok = true;
+    }
+    xSemaphoreGive(sp1_lock);
+    return ok;
+}
+
+int fira_app_report_bench(int n_peers, uint32_t blocks, fira_report_bench_t *res)
+{
+    /* the bench fills the peer table of report_cb() */
+    if (started)
+    {
+        return -1;
+    }
+    return fira_report_bench(n_peers, blocks, res);
+}
+
 const app_definition_t helpers_app_fira[] __attribute__((
     section(".known_apps"))) = {
         {"INITF", mAPP | APP_SAVEABLE, fira_helper_controller, fira_terminate, waitForCommand, command_parser, NULL},
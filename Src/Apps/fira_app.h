@@ -56,9 +56,50 @@
 extern "C" {
 #endif
 
-// Rolling code encryption API
-uint32_t rolling_code(uint32_t block_num);
-void xor_encrypt(uint8_t *data, uint8_t len, uint32_t code);
+#include <stdint.h>
+#include <stdbool.h>
+#include "sp1_xport.h"
+#include "sp1_txq.h"
+#include "fira_report.h"
+
+/* SP1 payload AES-CCM* key and its mcps_crypto_ccm_cache_get() key IDs.
+ * TX (data task) and RX (report task) use separate cached contexts, one at
+ * a time under the cache lock. */
+#define SP1_KEY_ID_TX 0
+#define SP1_KEY_ID_RX 1
+extern const uint8_t sp1_payload_key[16];
+
+#define FIRA_APP_SP1_E_NONE (-5) /* no SP1 session running */
+
+/* @brief queue a message for the SP1 frame of a next block, see sp1_txq.h
+ * @return 0, SP1_TXQ_E_xx or FIRA_APP_SP1_E_NONE
+ * */
+int fira_app_sp1_push(uint8_t type, const uint8_t *val, uint8_t len);
+
+/* @brief statistics of the SP1 message queue of the session
+ * @return false without an SP1 session
+ * */
+bool fira_app_sp1_txq_stats(sp1_txq_stats_t *st);
+
+/* @brief queue a message of the SP1 transport for peer dst, see sp1_xport.h
+ * @return 0, SP1_XP_E_xx or FIRA_APP_SP1_E_NONE
+ * */
+int fira_app_sp1_send(uint16_t dst, const uint8_t *msg, uint16_t len);
+
+/* @brief messages of the SP1 transport delivered to cb, from the next
+ *        session on; NULL: printed as JSON
+ * */
+void fira_app_sp1_set_rx_cb(sp1_xport_rx_cb_t cb, void *arg);
+
+/* @brief statistics of the SP1 transport of the session
+ * @return false without an SP1 session
+ * */
+bool fira_app_sp1_stats(sp1_xport_stats_t *st, bool *tx_busy);
+
+/* @brief fira_report_bench(), only with no session running
+ * @return ranging results per block, -1 if a session runs or no memory
+ */
+int fira_app_report_bench(int n_peers, uint32_t blocks, fira_report_bench_t *res);
 
 void fira_terminate(void);
 void fira_helper_controller(const void *arg);
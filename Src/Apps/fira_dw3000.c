@@ -50,6 +50,7 @@
  */
 
 #include "dw3000_mcps_mcu.h"
+#include "dw3000_statistics.h"
 #include "common_fira.h"
 #include "rf_tuning_config.h"
 #include "debug_config.h"
@@ -153,26 +154,36 @@ bool fira_uwb_is_diag_enabled(void)
 
 void fira_uwb_get_diag(float *rssi_dbm, int *nlos_pct)
 {
+    struct mcps_diag_s *diag = &dw->mcps_runtime->diag;
+
+    calculateStats(diag);
+
     if (rssi_dbm)
     {
-        *rssi_dbm = dw->mcps_runtime->diag.rssi;
+        *rssi_dbm = (float)diag->rssi_mdbm / 1000.f;
     }
     if (nlos_pct)
     {
-        *nlos_pct = (int)dw->mcps_runtime->diag.non_line_of_sight;
+        *nlos_pct = diag->nlos_pct;
     }
 }
 
 int fira_uwb_add_diag(char *str, int len, int max_len)
 {
-    if (dw->mcps_runtime->diag.rssi < 0.0)
+    struct mcps_diag_s *diag = &dw->mcps_runtime->diag;
+
+    calculateStats(diag);
+
+    if (diag->rssi_mdbm < 0)
     {
-        len += snprintf(&str[len], max_len - len, ",\"RSSI_dBm\":\"%.1f\"", dw->mcps_runtime->diag.rssi);
+        int rssi_ddbm = (-diag->rssi_mdbm + 50) / 100; /* rounded to 0.1 dB */
+
+        len += snprintf(&str[len], max_len - len, ",\"RSSI_dBm\":\"-%d.%d\"", rssi_ddbm / 10, rssi_ddbm % 10);
     }
     else
     {
         len += snprintf(&str[len], max_len - len, ",\"RSSI_dBm\":\"Invalid\"");
     }
-    len += snprintf(&str[len], max_len - len, ",\"NLOS_%%\":%d", (int)dw->mcps_runtime->diag.non_line_of_sight);
+    len += snprintf(&str[len], max_len - len, ",\"NLOS_%%\":%d", diag->nlos_pct);
     return len;
 }
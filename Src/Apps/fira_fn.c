@@ -57,17 +57,20 @@
 #include "EventManager.h"
 #include "reporter.h"
 #include "rf_tuning_config.h"
+#include "dw3000_pdoa.h"
 
 #define INITF_OFFSET 0
 #define RESPF_OFFSET 1
 
 static const char COMMENT_FIRA_OPT[] = { "FiRa Options -----" };
 static const char INITF_CMD_COMMENT[] = {
-    "INITF [RFRAME BPRF set] [Slot duration rstu] [Block duration ms] [Round duration slots] [RR usage] [Session id] [vupper64 xx:xx:xx:xx:xx:xx:xx:xx] [Multi node mode] [Round hopping] [Initiator Addr] [Responder 1 Addr] ... [Responder n Addr]"};
+    "INITF [RFRAME BPRF set] [Slot duration rstu] [Block duration ms] [Round duration slots] [RR usage] [Session id] [vupper64 xx:xx:xx:xx:xx:xx:xx:xx] [Multi node mode] [Round hopping] [Initiator Addr] [Responder 1 Addr] ... [Responder n Addr]\r\n"
+    "The round must hold the slots of all the responders and fit in the block, the session is not started otherwise"};
 static const char RESPF_CMD_COMMENT[] = {
     "RESPF [RFRAME BPRF set] [Slot duration rstu] [Block duration ms] [Round duration slots] [RR usage] [Session id] [vupper64 xx:xx:xx:xx:xx:xx:xx:xx] [Multi node mode] [Round hopping] [Initiator Addr] [Responder Addr]"};
 static const char COMMENT_AVERAGE[] = {
-    "Phase Difference Average. \r\nUsage: To see averaging value \"PAVRG\". To set the averaging value \"PAVRG <DEC>\""};
+    "Phase Difference Average. \r\nUsage: To see averaging value \"PAVRG\". To set the averaging value \"PAVRG <DEC> [<MODE>]\"\r\n"
+    "MODE: 0 - linear mean (default), 1 - circular mean"};
 
 extern const app_definition_t helpers_app_fira[];
 
@@ -76,8 +79,12 @@ REG_FN(f_initiator_f)
 {
     const char *ret = CMD_FN_RET_OK;
 
-    scan_fira_params(text, true);
+    bool ok = scan_fira_params(text, true);
     show_fira_params();
+    if (!ok)
+    {
+        return (NULL);
+    }
 
     const app_definition_t *app_ptr = &helpers_app_fira[INITF_OFFSET];
     EventManagerRegisterApp(&app_ptr);
@@ -89,8 +96,12 @@ REG_FN(f_responder_f)
 {
     const char *ret = CMD_FN_RET_OK;
 
-    scan_fira_params(text, false);
+    bool ok = scan_fira_params(text, false);
     show_fira_params();
+    if (!ok)
+    {
+        return (NULL);
+    }
 
     const app_definition_t *app_ptr = &helpers_app_fira[RESPF_OFFSET];
     EventManagerRegisterApp(&app_ptr);
@@ -104,22 +115,31 @@ REG_FN(f_pdoa_average)
 
     char *str = CMD_MALLOC(MAX_STR_SIZE);
 
-    int n, dummy;
+    int n, dummy, mode;
 
     if (str)
     {
         rf_tuning_t *rf_tuning = get_rf_tuning_config();
-        n = sscanf(text, "%9s %d", str, &dummy); // to count the number of arguments
+        n = sscanf(text, "%9s %d %d", str, &dummy, &mode); // to count the number of arguments
 
-        if (n == 2)
+        if (n >= 2)
         {
             rf_tuning->paverage = (int16_t)val; // val is the input
         }
+        if (n == 3)
+        {
+            if (mode != PDOA_AVRG_LINEAR && mode != PDOA_AVRG_CIRCULAR)
+            {
+                CMD_FREE(str);
+                return (NULL);
+            }
+            rf_tuning->paverage_mode = (uint8_t)mode;
+        }
 
         int hlen;
 
         hlen = sprintf(str, "JS%04X", 0x5A5A);
-        sprintf(&str[strlen(str)], "{\"AVERAGE\":%d}", rf_tuning->paverage);
+        sprintf(&str[strlen(str)], "{\"AVERAGE\":%d,\"MODE\":%d}", rf_tuning->paverage, rf_tuning->paverage_mode);
 
         sprintf(&str[2], "%04X", strlen(str) - hlen);
         str[hlen] = '{';
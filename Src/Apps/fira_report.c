@@ -0,0 +1,242 @@
+/**
+ * @file    fira_report.c
+ *
+ * @brief   JSON report of the ranging blocks of report_cb(), and the
+ *          REPORTBENCH cost of the report path
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "fira_report.h"
+#include "common_fira.h"
+#include "bin_report.h"
+#include "peer_table.h"
+#include "minmax.h"
+#include "nrf.h"
+
+/* 0 - no output of PDoA
+ * 1 - output of PDoA from uwb_stack, this is supported in 10.x.x
+ */
+#if CONFIG_PEG_UWB == 1
+#define OUTPUT_PDOA_ENABLE (1)
+#else
+#define OUTPUT_PDOA_ENABLE (1)
+#endif
+
+static float convert_aoa_2pi_q16_to_deg(int16_t aoa_2pi_q16)
+{
+    return (360.0 * aoa_2pi_q16 / (1 << 16));
+}
+
+/* @brief the MAC sent a new SP1 payload to the peer of rm
+ * @return true if payload_seq_sent advanced past *seq
+ * */
+static bool report_data_seq(const struct ranging_measurements *rm, uint32_t *seq)
+{
+    if (rm->payload_seq_sent <= *seq)
+    {
+        return false;
+    }
+
+    *seq = rm->payload_seq_sent;
+    return true;
+}
+
+/* @brief room for one more measurement and the end of the JSON report past
+ *        len: the buffer grows FIRA_REPORT_STR_SIZE at a time, to the
+ *        largest block reported so far
+ * @return false if out of memory
+ * */
+static bool report_str_reserve(struct string_measurement *s, int len)
+{
+    int need = len + FIRA_REPORT_STR_SIZE + FIRA_REPORT_STR_TAIL_SIZE;
+    char *str;
+
+    if (need <= s->len)
+    {
+        return true;
+    }
+    need = s->len + FIRA_REPORT_STR_SIZE * ((need - s->len + FIRA_REPORT_STR_SIZE - 1) / FIRA_REPORT_STR_SIZE);
+    if (need > UINT16_MAX)
+    {
+        return false;
+    }
+    str = realloc(s->str, need);
+    if (!str)
+    {
+        return false;
+    }
+    s->str = str;
+    s->len = (uint16_t)need;
+    return true;
+}
+
+/* @brief JSON object of a measurement, appended at len
+ * @param seq   SP1 sequence of the block, NULL without SP1
+ * @return the new length
+ * */
+static int report_measurement_json(struct string_measurement *s, int len,
+                                   const struct ranging_measurements *rm, int32_t cfo, uint32_t *seq)
+{
+    len += snprintf(&s->str[len], s->len - len,
+                    "{\"Addr\":\"0x%04x\",\"Status\":\"%s\"",
+                    rm->short_addr, (rm->status) ? ("Err") : ("Ok"));
+
+    if (rm->status == 0)
+    {
+        len += snprintf(&s->str[len], s->len - len, ",\"D_cm\":%d",
+                        (int)(rm->distance_mm / 10));
+
+#if (OUTPUT_PDOA_ENABLE == 1)
+        len += snprintf(&s->str[len], s->len - len,
+                        ",\"LPDoA_deg\":%0.2f,\"LAoA_deg\":%0.2f,\"LFoM\":%d,\"RAoA_deg\":%0.2f",
+                        convert_aoa_2pi_q16_to_deg(rm->local_aoa_measurements[0].pdoa_2pi),
+                        convert_aoa_2pi_q16_to_deg(rm->local_aoa_measurements[0].aoa_2pi),
+                        rm->local_aoa_measurements[0].aoa_fom,
+                        convert_aoa_2pi_q16_to_deg(rm->remote_aoa_azimuth_2pi));
+#endif
+
+        len += snprintf(&s->str[len], s->len - len, ",\"CFO_100ppm\":%d", (int)cfo);
+
+        if (seq && report_data_seq(rm, seq))
+        {
+            len += snprintf(&s->str[len], s->len - len, ",\"SEQ\":%" PRIu32 "", *seq);
+
+            if (rm->sp1_data_len > 0)
+            {
+                uint8_t *data = (uint8_t *)(rm->sp1_data);
+                len += snprintf(&s->str[len], s->len - len,
+                                ",\"DATA\":\"%02X:%02X:%02X\"", data[0], data[1], data[2]); // <- Printing of received data from another device
+            }
+        }
+    }
+    len += snprintf(&s->str[len], s->len - len, "}");
+    return len;
+}
+
+int fira_report_block_json(struct string_measurement *s, const struct ranging_results *results,
+                           int32_t cfo, uint32_t *seq)
+{
+    int len = sprintf(s->str, "{\"Block\":%" PRIu32 ", \"results\":[", results->block_index);
+
+    for (int i = 0; i < results->n_measurements; i++)
+    {
+        if (!report_str_reserve(s, len))
+        {
+            break;
+        }
+        if (i > 0)
+        {
+            len += snprintf(&s->str[len], s->len - len, ",");
+        }
+        len = report_measurement_json(s, len, &results->measurements[i], cfo, seq);
+    }
+
+    len += snprintf(&s->str[len], s->len - len, "]");
+    return len;
+}
+
+/* @brief short address of the i-th REPORTBENCH peer, scattered as the
+ *        addresses of a batch of devices are
+ * */
+#define BENCH_PEER_ADDR(i)  ((uint16_t)(0x2B + (i) * 0x9D1))
+
+int fira_report_bench(int n_peers, uint32_t blocks, fira_report_bench_t *res)
+{
+    struct string_measurement s = {0};
+    struct ranging_results *results;
+    int rounds = (n_peers + FIRA_CONTROLEES_MAX - 1) / FIRA_CONTROLEES_MAX;
+    uint32_t cyc_per_us = SystemCoreClock / 1000000UL;
+    uint64_t cyc_state = 0, cyc_json = 0, cyc_bin = 0;
+    uint32_t n_meas = 0;
+    uint8_t frame[BIN_REPORT_MAX_FRAME];
+    bin_report_diag_t diag = {0};
+
+    if (n_peers <= 0 || n_peers > PEER_TABLE_MAX || blocks == 0)
+    {
+        return -1;
+    }
+    results = calloc(1, sizeof(*results));
+    s.str = malloc(FIRA_REPORT_STR_SIZE);
+    s.len = FIRA_REPORT_STR_SIZE;
+    if (!results || !s.str)
+    {
+        free(results);
+        free(s.str);
+        return -1;
+    }
+
+    peer_table_reset(false);
+    for (int i = 0; i < n_peers; i++)
+    {
+        peer_table_add(BENCH_PEER_ADDR(i));
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    /* A block of n_peers takes one report of FIRA_CONTROLEES_MAX
+     * measurements at most per round */
+    for (uint32_t b = 0; b < blocks; b++)
+    {
+        for (int r = 0; r < rounds; r++)
+        {
+            uint32_t t0;
+
+            results->block_index = b;
+            results->stopped_reason = 0xFF;
+            results->n_measurements = MIN(n_peers - r * FIRA_CONTROLEES_MAX, FIRA_CONTROLEES_MAX);
+            for (int k = 0; k < results->n_measurements; k++)
+            {
+                struct ranging_measurements *rm = &results->measurements[k];
+
+                rm->short_addr = BENCH_PEER_ADDR(r * FIRA_CONTROLEES_MAX + k);
+                rm->status = ((b + k) % 8) ? 0 : 2; /* an RX timeout in 8 */
+                rm->distance_mm = 1000 + 100 * k + (int32_t)(b & 0xF);
+            }
+
+            t0 = DWT->CYCCNT;
+            for (int k = 0; k < results->n_measurements; k++)
+            {
+                const struct ranging_measurements *rm = &results->measurements[k];
+                peer_t *peer = peer_table_find(rm->short_addr);
+
+                if (peer)
+                {
+                    peer_table_measure(peer, b, rm->status, rm->distance_mm);
+                }
+            }
+            cyc_state += DWT->CYCCNT - t0;
+
+            t0 = DWT->CYCCNT;
+            int len = fira_report_block_json(&s, results, 0, NULL);
+            snprintf(&s.str[len], s.len - len, "}\r\n");
+            cyc_json += DWT->CYCCNT - t0;
+
+            t0 = DWT->CYCCNT;
+            bin_report_encode_block(frame, sizeof(frame), results, &diag, false);
+            cyc_bin += DWT->CYCCNT - t0;
+
+            n_meas += results->n_measurements;
+        }
+    }
+
+    res->state_ns = (uint32_t)(cyc_state * 1000 / cyc_per_us / n_meas);
+    res->json_ns = (uint32_t)(cyc_json * 1000 / cyc_per_us / n_meas);
+    res->bin_ns = (uint32_t)(cyc_bin * 1000 / cyc_per_us / n_meas);
+    res->json_cyc = (uint32_t)(cyc_json / blocks);
+    res->bin_cyc = (uint32_t)(cyc_bin / blocks);
+    res->block_us = (uint32_t)((cyc_state + cyc_json) / cyc_per_us / blocks);
+    res->str_len = s.len;
+
+    /* the next session fills the table with its own peers */
+    peer_table_reset(false);
+    free(s.str);
+    free(results);
+    return rounds;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file    fira_report.h
+ *
+ * @brief   JSON report of the ranging blocks of report_cb(), and the
+ *          REPORTBENCH cost of the report path
+ *
+ *          Built without the session, the MAC or the RTOS, the report path
+ *          runs on the host as on the board.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef FIRA_REPORT_H
+#define FIRA_REPORT_H
+
+#include <stdint.h>
+
+#define FIRA_REPORT_STR_SIZE        (256)   /* JSON report: the header or one measurement, at most */
+#define FIRA_REPORT_STR_TAIL_SIZE   (64)    /* JSON report: diag and end of a block */
+
+struct string_measurement;
+struct ranging_results;
+
+/* REPORTBENCH result */
+typedef struct
+{
+    uint32_t state_ns;  /* peer lookup and state update, per measurement */
+    uint32_t json_ns;   /* JSON report, per measurement */
+    uint32_t bin_ns;    /* binary report, per measurement */
+    uint32_t json_cyc;  /* JSON report, cycles per block */
+    uint32_t bin_cyc;   /* binary report, cycles per block */
+    uint32_t block_us;  /* lookup, state and JSON, per block */
+    uint16_t str_len;   /* JSON report buffer at the end of the run */
+} fira_report_bench_t;
+
+/* @brief JSON report of a block up to the results array included, the
+ *        buffer grown for its measurements; measurements that do not fit in
+ *        memory are left out
+ * @param seq   SP1 sequence of the session, NULL without SP1
+ * @return the length
+ * */
+int fira_report_block_json(struct string_measurement *s, const struct ranging_results *results,
+                           int32_t cfo, uint32_t *seq);
+
+/* @brief report path cost of blocks with n_peers controlees, over
+ *        simulated ranging results: the peer lookup and state update of
+ *        report_cb() and its JSON report, without the output, and the
+ *        binary report of the same results for comparison. The peer table
+ *        is emptied after the run.
+ * @return ranging results per block, -1 if no memory
+ */
+int fira_report_bench(int n_peers, uint32_t blocks, fira_report_bench_t *res);
+
+#endif /* FIRA_REPORT_H */
@@ -78,13 +78,13 @@ void FlushTask(void const *argument)
     }
 }
 
+/* @brief drop the pending output: the flush thread drops it on its next pass */
 void FlushTask_reset(void)
 {
     if (flushTask.Handle)
     {
-        enter_critical_section();
         reset_report_buf();
-        leave_critical_section();
+        NotifyFlushTask();
     }
 }
 
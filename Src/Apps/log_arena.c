@@ -0,0 +1,340 @@
+/**
+ * @file    log_arena.c
+ *
+ * @brief   Multi-producer report buffer
+ *
+ *          Records never wrap: when the claim does not fit before the end of
+ *          the buffer, the tail end is claimed together with it and published
+ *          as an empty padding record. The consumer zeroes every record it
+ *          releases, so a claimed but unpublished header always reads as 0.
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cmsis_os.h"
+#include "log_arena.h"
+#include "reporter.h"
+
+#define LOG_REC_ALIGN(x)    (((x) + 3UL) & ~3UL)
+#define LOG_REC_SIZE(h)     ((h) & 0xFFFFUL)
+#define LOG_REC_LEN(h)      (((h) >> 16) & 0x7FFFUL)
+
+#define LOG_PRODUCER_SHARED LOG_ARENA_PRODUCERS_MAX /**< ISRs, pre-scheduler and overflow */
+
+static log_producer_t producers[LOG_ARENA_PRODUCERS_MAX + 1] = {
+    [LOG_PRODUCER_SHARED] = { .name = "ISR/other" }
+};
+
+/* id of a slot taken, not set yet: no task's */
+#define LOG_PRODUCER_SETTING ((void *)&producers[LOG_PRODUCER_SHARED])
+
+static uint32_t arena_hwm;
+
+static inline uint32_t *rec_hdr(log_arena_t *a, uint32_t pos)
+{
+    return (uint32_t *)&a->buf[pos & (a->size - 1)];
+}
+
+static void atomic_max(uint32_t *p, uint32_t v)
+{
+    uint32_t cur = __atomic_load_n(p, __ATOMIC_RELAXED);
+
+    while (v > cur && !__atomic_compare_exchange_n(p, &cur, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/* @brief statistics slot of the calling context, a task gets its own slot
+ *        on its first print
+ * */
+static log_producer_t *producer_get(void)
+{
+    void *id;
+
+    if ((__get_IPSR() != 0) || (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED))
+    {
+        return &producers[LOG_PRODUCER_SHARED];
+    }
+
+    id = (void *)xTaskGetCurrentTaskHandle();
+
+    /* only the task itself sets its slot: found, or none yet */
+    for (int i = 0; i < LOG_ARENA_PRODUCERS_MAX; i++)
+    {
+        if (__atomic_load_n(&producers[i].id, __ATOMIC_ACQUIRE) == id)
+        {
+            return &producers[i];
+        }
+    }
+
+    for (int i = 0; i < LOG_ARENA_PRODUCERS_MAX; i++)
+    {
+        log_producer_t *p = &producers[i];
+        void *cur = NULL;
+
+        /* a task only races with other tasks for a free slot; the slot is
+         * set before its id is published, LOGSTAT never shows it half set */
+        if (__atomic_compare_exchange_n(&p->id, &cur, LOG_PRODUCER_SETTING, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            memset(&p->name, 0, sizeof(*p) - offsetof(log_producer_t, name));
+            strncpy(p->name, pcTaskGetName(NULL), LOG_ARENA_NAME_LEN - 1);
+            p->tick_last = xTaskGetTickCount();
+            __atomic_store_n(&p->id, id, __ATOMIC_RELEASE);
+            return p;
+        }
+    }
+    return &producers[LOG_PRODUCER_SHARED];
+}
+
+void log_arena_producer_free(void *task)
+{
+    for (int i = 0; i < LOG_ARENA_PRODUCERS_MAX; i++)
+    {
+        if (__atomic_load_n(&producers[i].id, __ATOMIC_ACQUIRE) == task)
+        {
+            __atomic_store_n(&producers[i].id, NULL, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+void log_arena_init(log_arena_t *a, uint8_t *buf, uint32_t size)
+{
+    memset(buf, 0, size);
+    a->buf = buf;
+    a->size = size;
+    a->head = 0;
+    a->tail = 0;
+    a->rd_off = 0;
+}
+
+uint8_t *log_arena_claim(log_arena_t *a, int len)
+{
+    log_producer_t *prod = producer_get();
+    uint32_t need, total, pad, head, tail, idx;
+
+    if (len < 0)
+    {
+        len = 0;
+    }
+    need = LOG_REC_ALIGN(LOG_REC_HDR_LEN + (uint32_t)len);
+
+    head = __atomic_load_n(&a->head, __ATOMIC_RELAXED);
+    do
+    {
+        tail = __atomic_load_n(&a->tail, __ATOMIC_ACQUIRE);
+        idx = head & (a->size - 1);
+        pad = (a->size - idx < need) ? (a->size - idx) : 0;
+        total = pad + need;
+
+        if ((need > a->size) || (a->size - (head - tail) < total))
+        {
+            __atomic_fetch_add(&prod->drops, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&a->head, &head, head + total, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    atomic_max(&prod->hwm, head + total - tail);
+    atomic_max(&arena_hwm, head + total - tail);
+    __atomic_fetch_add(&prod->msgs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&prod->bytes, (uint32_t)len, __ATOMIC_RELAXED);
+
+    if (pad)
+    {
+        __atomic_store_n(rec_hdr(a, head), pad | LOG_REC_COMMITTED, __ATOMIC_RELEASE);
+        head += pad;
+    }
+
+    /* size only: not visible to the consumer until committed */
+    *rec_hdr(a, head) = need;
+
+    return (uint8_t *)rec_hdr(a, head) + LOG_REC_HDR_LEN;
+}
+
+void log_arena_commit(log_arena_t *a, uint8_t *payload, int len)
+{
+    uint32_t *hdr = (uint32_t *)(payload - LOG_REC_HDR_LEN);
+    uint32_t size = LOG_REC_SIZE(*hdr);
+
+    (void)a;
+
+    if (len < 0)
+    {
+        len = 0;
+    }
+    if ((uint32_t)len > size - LOG_REC_HDR_LEN)
+    {
+        len = (int)(size - LOG_REC_HDR_LEN);
+    }
+
+    __atomic_store_n(hdr, size | ((uint32_t)len << 16) | LOG_REC_COMMITTED, __ATOMIC_RELEASE);
+}
+
+bool log_arena_write(log_arena_t *a, const uint8_t *src, int len)
+{
+    uint8_t *p = log_arena_claim(a, len);
+
+    if (!p)
+    {
+        return false;
+    }
+    memcpy(p, src, (size_t)len);
+    log_arena_commit(a, p, len);
+    return true;
+}
+
+/* @brief walks published records from the tail, copying out (dst != NULL)
+ *        and/or releasing (release) up to max payload bytes
+ * */
+static uint32_t arena_walk(log_arena_t *a, uint8_t *dst, uint32_t max, bool release)
+{
+    uint32_t pos = a->tail;
+    uint32_t off = a->rd_off;
+    uint32_t n = 0;
+
+    while (n < max && pos != __atomic_load_n(&a->head, __ATOMIC_ACQUIRE))
+    {
+        uint32_t *hdr = rec_hdr(a, pos);
+        uint32_t h = __atomic_load_n(hdr, __ATOMIC_ACQUIRE);
+        uint32_t take;
+
+        if (!(h & LOG_REC_COMMITTED))
+        {
+            break; /**< claimed, producer still copying */
+        }
+
+        take = LOG_REC_LEN(h) - off;
+        if (take > max - n)
+        {
+            take = max - n;
+        }
+        if (dst)
+        {
+            memcpy(&dst[n], (uint8_t *)hdr + LOG_REC_HDR_LEN + off, take);
+        }
+        n += take;
+        off += take;
+
+        if (off < LOG_REC_LEN(h))
+        {
+            break;
+        }
+
+        /* whole record read */
+        if (release)
+        {
+            memset(hdr, 0, LOG_REC_SIZE(h));
+            __atomic_store_n(&a->tail, pos + LOG_REC_SIZE(h), __ATOMIC_RELEASE);
+        }
+        pos += LOG_REC_SIZE(h);
+        off = 0;
+    }
+
+    if (release)
+    {
+        a->rd_off = off;
+    }
+    return n;
+}
+
+/* @brief consumer: release the records up to the head of the last discard
+ *        asked, those published; the rest on the next call
+ * */
+static void arena_discard_pending(log_arena_t *a)
+{
+    uint32_t req = __atomic_load_n(&a->discard_req, __ATOMIC_ACQUIRE);
+    uint32_t to = __atomic_load_n(&a->discard_to, __ATOMIC_RELAXED);
+    uint32_t pos = a->tail;
+
+    if (req == a->discard_done)
+    {
+        return;
+    }
+
+    while ((int32_t)(to - pos) > 0)
+    {
+        uint32_t *hdr = rec_hdr(a, pos);
+        uint32_t h = __atomic_load_n(hdr, __ATOMIC_ACQUIRE);
+
+        if (!(h & LOG_REC_COMMITTED))
+        {
+            return; /**< claimed before the discard, producer still copying */
+        }
+        memset(hdr, 0, LOG_REC_SIZE(h));
+        pos += LOG_REC_SIZE(h);
+        a->rd_off = 0;
+        __atomic_store_n(&a->tail, pos, __ATOMIC_RELEASE);
+    }
+    a->discard_done = req;
+}
+
+uint32_t log_arena_peek(log_arena_t *a, uint8_t *dst, uint32_t max)
+{
+    arena_discard_pending(a);
+    return arena_walk(a, dst, max, false);
+}
+
+void log_arena_consume(log_arena_t *a, uint32_t n)
+{
+    (void)arena_walk(a, NULL, n, true);
+}
+
+void log_arena_discard(log_arena_t *a)
+{
+    uint32_t to = __atomic_load_n(&a->discard_to, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&a->head, __ATOMIC_ACQUIRE);
+
+    /* up to the head now, unless another task asked for further meanwhile */
+    while ((int32_t)(head - to) > 0 &&
+           !__atomic_compare_exchange_n(&a->discard_to, &to, head, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+    __atomic_fetch_add(&a->discard_req, 1, __ATOMIC_RELEASE);
+}
+
+void log_arena_report(void)
+{
+    char str[96];
+    int len;
+    uint32_t now = xTaskGetTickCount();
+
+    len = snprintf(str, sizeof(str), "%-12s\t%8s\t%8s\t%6s\t%6s\r\n",
+                   "PRODUCER", "B/s", "bytes", "drops", "hwm");
+    reporter_instance.print(str, len);
+
+    for (int i = 0; i <= LOG_ARENA_PRODUCERS_MAX; i++)
+    {
+        log_producer_t *p = &producers[i];
+        uint32_t bytes = __atomic_load_n(&p->bytes, __ATOMIC_RELAXED);
+        uint32_t dt = now - p->tick_last;
+        uint32_t rate;
+
+        if (i < LOG_ARENA_PRODUCERS_MAX)
+        {
+            void *id = __atomic_load_n(&p->id, __ATOMIC_ACQUIRE);
+
+            if (id == NULL || id == LOG_PRODUCER_SETTING)
+            {
+                continue;
+            }
+        }
+
+        /* rate since the previous LOGSTAT, or since the first print */
+        rate = (dt > 0) ? (uint32_t)(((uint64_t)(bytes - p->bytes_last) * configTICK_RATE_HZ) / dt) : 0;
+        p->bytes_last = bytes;
+        p->tick_last = now;
+
+        len = snprintf(str, sizeof(str), "%-12.12s\t%8lu\t%8lu\t%6lu\t%6lu\r\n",
+                       p->name, (unsigned long)rate, (unsigned long)bytes,
+                       (unsigned long)p->drops, (unsigned long)p->hwm);
+        reporter_instance.print(str, len);
+    }
+
+    len = snprintf(str, sizeof(str), "%-12s\t%8s\t%8s\t%6s\t%6lu\r\n",
+                   "Total", "", "", "", (unsigned long)arena_hwm);
+    reporter_instance.print(str, len);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file    log_arena.h
+ *
+ * @brief   Multi-producer report buffer
+ *
+ *          Any task or ISR appends whole messages to one ring without a lock:
+ *          a producer claims space by advancing the claim index with a
+ *          compare-and-swap, fills it and then publishes it by writing the
+ *          record header. The flush thread is the only consumer; it stops at
+ *          the first record not yet published, so messages of one producer
+ *          come out in order and a producer preempted in the middle of a copy
+ *          delays, but does not corrupt or drop, the others.
+ *
+ *          A message is dropped only when the ring is full. Drops, bytes and
+ *          the ring fill level are accounted per producer (task), see LOGSTAT.
+ *          A task takes a slot on its first message and frees it when it is
+ *          deleted (traceTASK_DELETE), its counts go with it.
+ *
+ *          Any task may ask for the published records to be dropped; the
+ *          consumer drops them, between two of its reads.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef LOG_ARENA_H
+#define LOG_ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LOG_ARENA_PRODUCERS_MAX     12  /**< tasks tracked individually */
+#define LOG_ARENA_NAME_LEN          12  /**< configMAX_TASK_NAME_LEN */
+
+/* Record header: size[15:0] | len[30:16] | committed[31] */
+#define LOG_REC_HDR_LEN             4
+#define LOG_REC_COMMITTED           0x80000000UL
+
+typedef struct
+{
+    uint32_t head;      /**< claim index, advanced by producers with CAS */
+    uint32_t tail;      /**< release index, consumer only */
+    uint32_t size;      /**< 1<<N, at most 0x8000 */
+    uint32_t rd_off;    /**< consumer: bytes already read from the record at tail */
+    uint8_t  *buf;      /**< 4-byte aligned, zeroed */
+    uint32_t discard_to;    /**< head when the last discard was asked */
+    uint32_t discard_req;   /**< discards asked */
+    uint32_t discard_done;  /**< consumer: discards carried out */
+} log_arena_t;
+
+typedef struct
+{
+    void     *id;                       /**< task handle, NULL: slot free, published once the slot is set */
+    char     name[LOG_ARENA_NAME_LEN];
+    uint32_t bytes;                     /**< payload bytes accepted */
+    uint32_t msgs;
+    uint32_t drops;                     /**< messages lost, ring full */
+    uint32_t hwm;                       /**< highest ring fill seen by this producer, bytes */
+    uint32_t bytes_last;                /**< LOGSTAT: snapshot for the rate */
+    uint32_t tick_last;
+} log_producer_t;
+
+void log_arena_init(log_arena_t *a, uint8_t *buf, uint32_t size);
+
+/**
+ * @brief producer: claim a contiguous payload area of len bytes
+ *
+ * @return payload pointer to fill, then publish it with log_arena_commit(),
+ *         NULL if the ring is full (the drop is accounted)
+ */
+uint8_t *log_arena_claim(log_arena_t *a, int len);
+
+/**
+ * @brief producer: publish len bytes of a claimed area, len may be less than
+ *        claimed, 0 publishes an empty record
+ */
+void log_arena_commit(log_arena_t *a, uint8_t *payload, int len);
+
+/**
+ * @brief producer: claim, copy and commit
+ *
+ * @return true if accepted, false if dropped
+ */
+bool log_arena_write(log_arena_t *a, const uint8_t *src, int len);
+
+/**
+ * @brief consumer: copy up to max published bytes without consuming them,
+ *        once the discard asked, if any, is carried out
+ *
+ * @return number of bytes copied
+ */
+uint32_t log_arena_peek(log_arena_t *a, uint8_t *dst, uint32_t max);
+
+/**
+ * @brief consumer: consume n bytes previously peeked
+ */
+void log_arena_consume(log_arena_t *a, uint32_t n);
+
+/**
+ * @brief any task: drop the records claimed so far, at the next
+ *        log_arena_peek()
+ */
+void log_arena_discard(log_arena_t *a);
+
+/**
+ * @brief free the statistics slot of a task deleted, traceTASK_DELETE
+ */
+void log_arena_producer_free(void *task);
+
+/**
+ * @brief Print the per-producer statistics, LOGSTAT command
+ */
+void log_arena_report(void);
+
+#endif /* LOG_ARENA_H */
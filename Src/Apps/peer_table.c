@@ -0,0 +1,156 @@
+/**
+ * @file    peer_table.c
+ *
+ * @brief   Per-peer state of a FiRa session, indexed by short address
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "peer_table.h"
+#include "reporter.h"
+
+_Static_assert(PEER_TABLE_MAX <= 255, "slot holds the record index + 1 in a byte");
+
+#define PEER_HASH_MUL       0x9E3779B1UL    /**< Fibonacci hashing, 2^32 / golden ratio */
+#define PEER_DIST_SHIFT     2               /**< IIR weight of a new distance: 1/4 */
+
+/* SP1 window of a peer of the last session, kept apart from the records so
+ * that a new peer cannot take the room of one */
+typedef struct
+{
+    sp1_replay_t rp;
+    uint16_t addr;
+} peer_kept_t;
+
+static peer_t peers[PEER_TABLE_MAX];
+static uint8_t slots[PEER_TABLE_SLOTS];     /**< record index + 1, 0: free */
+static int n_peers;
+static peer_kept_t kept[PEER_TABLE_MAX];
+static int n_kept;
+
+/* @brief home slot of addr: the top bits of the product spread the short
+ *        addresses of a batch of devices, which often differ in a few low bits */
+static inline uint32_t peer_hash(uint16_t addr)
+{
+    return (uint32_t)(addr * PEER_HASH_MUL) >> (32 - PEER_TABLE_SLOT_BITS);
+}
+
+/* @brief slot of addr, or the free slot where it goes */
+static uint32_t peer_slot(uint16_t addr)
+{
+    uint32_t s = peer_hash(addr);
+
+    /* the table is at most half full, a free slot ends the probe */
+    while (slots[s] && peers[slots[s] - 1].addr != addr)
+    {
+        s = (s + 1) & (PEER_TABLE_SLOTS - 1);
+    }
+    return s;
+}
+
+void peer_table_reset(bool keep_sp1)
+{
+    n_kept = 0;
+    for (int i = 0; keep_sp1 && i < n_peers; i++)
+    {
+        kept[n_kept].rp = peers[i].sp1_rp;
+        kept[n_kept++].addr = peers[i].addr;
+    }
+    memset(slots, 0, sizeof(slots));
+    n_peers = 0;
+}
+
+peer_t *peer_table_add(uint16_t addr)
+{
+    uint32_t s = peer_slot(addr);
+    peer_t *p;
+
+    if (slots[s])
+    {
+        return &peers[slots[s] - 1];
+    }
+    if (n_peers >= PEER_TABLE_MAX)
+    {
+        return NULL;
+    }
+
+    p = &peers[n_peers++];
+    memset(p, 0, sizeof(*p));
+    p->addr = addr;
+    /* a peer of the last session comes with its window */
+    for (int i = 0; i < n_kept; i++)
+    {
+        if (kept[i].addr == addr)
+        {
+            p->sp1_rp = kept[i].rp;
+            break;
+        }
+    }
+    slots[s] = (uint8_t)n_peers;
+    return p;
+}
+
+peer_t *peer_table_find(uint16_t addr)
+{
+    uint32_t s = peer_slot(addr);
+
+    return slots[s] ? &peers[slots[s] - 1] : NULL;
+}
+
+int peer_table_count(void)
+{
+    return n_peers;
+}
+
+peer_t *peer_table_get(int i)
+{
+    return (i >= 0 && i < n_peers) ? &peers[i] : NULL;
+}
+
+void peer_table_measure(peer_t *p, uint32_t block, uint8_t status, int32_t distance_mm)
+{
+    p->last_block = block;
+
+    if (status)
+    {
+        p->n_err++;
+        return;
+    }
+    p->n_ok++;
+
+    if (p->flags & PEER_F_DIST)
+    {
+        p->dist_mm += (distance_mm - p->dist_mm) >> PEER_DIST_SHIFT;
+    }
+    else
+    {
+        p->dist_mm = distance_mm;
+        p->flags |= PEER_F_DIST;
+    }
+}
+
+void peer_table_print(void)
+{
+    char str[160];
+    int len;
+
+    len = snprintf(str, sizeof(str), "PEERS: %d of %d\r\n", n_peers, PEER_TABLE_MAX);
+    reporter_instance.print(str, len);
+
+    for (int i = 0; i < n_peers; i++)
+    {
+        const peer_t *p = &peers[i];
+
+        len = snprintf(str, sizeof(str),
+                       "0x%04X: ok %lu, err %lu, last block %lu, D_cm %ld, SP1 %u accepted %u rejected %u replayed, counter %lu\r\n",
+                       p->addr, (unsigned long)p->n_ok, (unsigned long)p->n_err,
+                       (unsigned long)p->last_block,
+                       (p->flags & PEER_F_DIST) ? (long)(p->dist_mm / 10) : -1L,
+                       p->n_sp1, p->n_sp1_rej, p->n_sp1_replay, (unsigned long)p->sp1_rp.top);
+        reporter_instance.print(str, len);
+    }
+}
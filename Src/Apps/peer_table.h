@@ -0,0 +1,97 @@
+/**
+ * @file    peer_table.h
+ *
+ * @brief   Per-peer state of a FiRa session, indexed by short address
+ *
+ *          One compact record per peer of the session: the controlees on
+ *          the controller, the controller on a controlee. report_cb() looks
+ *          the peer of every measurement up by its short address, which also
+ *          drops the measurements of devices outside the session, and keeps
+ *          there what used to be kept once for a single peer: the last
+ *          block, the SP1 anti-replay window, the button counter the responder
+ *          acted on, a filtered distance and the measurement statistics.
+ *
+ *          The records are a dense array in insertion order. The index is an
+ *          open addressing hash table of PEER_TABLE_SLOTS bytes, twice as
+ *          many slots as records, so a lookup takes one or two probes
+ *          whatever the number of peers. Records are only added between
+ *          sessions, the table has no removal.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef PEER_TABLE_H
+#define PEER_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sp1_frame.h"
+
+#ifndef PEER_TABLE_SLOT_BITS
+#define PEER_TABLE_SLOT_BITS    7
+#endif
+
+#define PEER_TABLE_SLOTS        (1 << PEER_TABLE_SLOT_BITS)
+#define PEER_TABLE_MAX          (PEER_TABLE_SLOTS / 2)  /**< peers, load factor 1/2 at most */
+
+#define PEER_F_DIST             0x01    /**< dist_mm holds a measurement */
+#define PEER_F_BTN              0x02    /**< btn_counter holds a press */
+
+typedef struct
+{
+    sp1_replay_t sp1_rp;    /**< SP1 counters accepted */
+    uint16_t addr;
+    uint8_t flags;          /**< PEER_F_xx */
+    uint8_t btn_counter;    /**< last button counter the responder acted on */
+    uint32_t last_block;    /**< block of the last measurement */
+    int32_t dist_mm;        /**< distance, first order IIR of the good measurements */
+    uint32_t n_ok;          /**< measurements, good */
+    uint32_t n_err;         /**< and with an error status */
+    uint16_t n_sp1;         /**< payloads accepted */
+    uint16_t n_sp1_rej;     /**< payloads failing authentication */
+    uint16_t n_sp1_replay;  /**< payloads replayed, or older than the window */
+} peer_t;
+
+/**
+ * @brief empty the table
+ *
+ * @param keep_sp1  the SP1 key is that of the last session: a peer added
+ *                  again keeps its replay window, its frames of that session
+ *                  stay replays
+ */
+void peer_table_reset(bool keep_sp1);
+
+/**
+ * @brief record of addr, added if addr is not a peer yet
+ *
+ * @return NULL if PEER_TABLE_MAX peers are in the table
+ */
+peer_t *peer_table_add(uint16_t addr);
+
+/**
+ * @brief record of addr, NULL if addr is not a peer
+ */
+peer_t *peer_table_find(uint16_t addr);
+
+int peer_table_count(void);
+
+/**
+ * @brief i-th record, in insertion order
+ */
+peer_t *peer_table_get(int i);
+
+/**
+ * @brief account a measurement of block to peer p
+ *
+ * @param status        status of the measurement, 0 if good
+ * @param distance_mm   distance, used if status is 0
+ */
+void peer_table_measure(peer_t *p, uint32_t block, uint8_t status, int32_t distance_mm);
+
+/**
+ * @brief print the records, PEERS command
+ */
+void peer_table_print(void);
+
+#endif /* PEER_TABLE_H */
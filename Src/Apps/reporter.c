@@ -59,7 +59,9 @@ static void usb_init(void);
 
 reporter_t reporter_instance = {
     .init = usb_init,
-    .print = usb_print
+    .print = usb_print,
+    .reserve = port_tx_reserve,
+    .commit = port_tx_commit
 };
 
 static error_e usb_print(char *buff, int len)
@@ -52,12 +52,20 @@
 #ifndef REPORTER_H
 #define REPORTER_H
 
+#include <stdint.h>
 #include "deca_error.h"
 
 struct reporter_s
 {
     void (*init)(void);
     error_e (*print)(char *buff, int len);
+    /* Optional in-place output: reserve() returns a contiguous area of len
+     * bytes, or NULL if the buffer is full: the message is dropped, and the
+     * drop reported, as print() would. A non-NULL reserve() must be followed
+     * by commit() of that area with the number of bytes written, 0 to cancel.
+     * Without reserve(), use print(). */
+    uint8_t *(*reserve)(int len);
+    void (*commit)(uint8_t *area, int len);
 };
 typedef struct reporter_s reporter_t;
 
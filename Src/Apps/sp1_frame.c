@@ -0,0 +1,318 @@
+/**
+ * @file    sp1_frame.c
+ *
+ * @brief   Secured SP1 payload: explicit counter, AES-CCM*, anti-replay window
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sp1_frame.h"
+#include "mcps_crypto.h"
+#include "nrf.h"
+
+/* SP1BENCH link: one frame per block, lost or duplicated in SP1_BENCH_PCT
+ * percent of the blocks each, late by 1 to 7 blocks in SP1_BENCH_PCT
+ * percent; a duplicate comes 8 to 15 blocks after its frame */
+#define SP1_BENCH_PCT       10
+#define SP1_BENCH_TRIALS    5       /**< block indices tried per frame by the trial decryption */
+#define SP1_BENCH_LEN       6       /**< payload of a button press */
+#define SP1_BENCH_SRC       0x0001  /**< controller of the SP1BENCH link */
+
+/* SP 800-108 input of the session key: i = 1 | label | 0 | context | L = 128 */
+#define SP1_KDF_LABEL       "SP1 payload"
+#define SP1_KDF_LEN         (1 + sizeof(SP1_KDF_LABEL) + 4 + 8 + 2)
+
+static uint32_t sp1_decrypts;
+static uint32_t sp1_tx_ctr;     /**< counter of the last frame sent */
+static uint8_t sp1_key[SP1_KEY_LEN];
+
+/* @brief CCM* nonce of a frame: | counter LE | source short address LE |
+ *        direction | zero padding | */
+static void sp1_nonce(uint8_t nonce[MCPS_CRYPTO_AES_CCM_STAR_NONCE_LEN], uint32_t ctr, uint16_t src,
+                      uint8_t dir)
+{
+    memset(nonce, 0, MCPS_CRYPTO_AES_CCM_STAR_NONCE_LEN);
+    memcpy(nonce, &ctr, sizeof(ctr));
+    nonce[4] = (uint8_t)src;
+    nonce[5] = (uint8_t)(src >> 8);
+    nonce[6] = dir;
+}
+
+int sp1_frame_seal(void *ccm_ctx, uint32_t ctr, uint16_t src, uint8_t dir,
+                   const uint8_t *payload, uint16_t len, uint8_t *frame, uint16_t max)
+{
+    uint8_t nonce[MCPS_CRYPTO_AES_CCM_STAR_NONCE_LEN];
+
+    if (len == 0 || len + SP1_FRAME_OVERHEAD > max)
+    {
+        return SP1_E_SHORT;
+    }
+    if (ccm_ctx == NULL)
+    {
+        return SP1_E_AUTH;
+    }
+
+    sp1_nonce(nonce, ctr, src, dir);
+    memcpy(frame, &ctr, SP1_CTR_LEN);
+    memcpy(frame + SP1_CTR_LEN, payload, len);
+    if (mcps_crypto_aead_aes_ccm_star_128_encrypt(ccm_ctx, nonce, frame, SP1_CTR_LEN,
+                                                  frame + SP1_CTR_LEN, len,
+                                                  frame + SP1_CTR_LEN + len, SP1_MIC_LEN) != UWBMAC_SUCCESS)
+    {
+        return SP1_E_AUTH;
+    }
+    return len + SP1_FRAME_OVERHEAD;
+}
+
+int sp1_frame_open(void *ccm_ctx, sp1_replay_t *rp, uint16_t src, uint8_t dir,
+                   const uint8_t *frame, uint16_t len, uint8_t *payload, uint32_t *ctr)
+{
+    uint8_t nonce[MCPS_CRYPTO_AES_CCM_STAR_NONCE_LEN];
+    uint8_t mic[SP1_MIC_LEN];
+    uint16_t plen;
+
+    if (len <= SP1_FRAME_OVERHEAD)
+    {
+        return SP1_E_SHORT;
+    }
+    plen = len - SP1_FRAME_OVERHEAD;
+    memcpy(ctr, frame, SP1_CTR_LEN);
+
+    /* a replay costs no decryption */
+    if (!sp1_replay_check(rp, *ctr))
+    {
+        return SP1_E_REPLAY;
+    }
+    if (ccm_ctx == NULL)
+    {
+        return SP1_E_AUTH;
+    }
+
+    sp1_nonce(nonce, *ctr, src, dir);
+    memcpy(mic, frame + SP1_CTR_LEN + plen, SP1_MIC_LEN);
+    memcpy(payload, frame + SP1_CTR_LEN, plen);
+    sp1_decrypts++;
+    if (mcps_crypto_aead_aes_ccm_star_128_decrypt(ccm_ctx, nonce, frame, SP1_CTR_LEN,
+                                                  payload, plen, mic, SP1_MIC_LEN) != UWBMAC_SUCCESS)
+    {
+        memset(payload, 0, plen);
+        return SP1_E_AUTH;
+    }
+
+    sp1_replay_update(rp, *ctr);
+    return plen;
+}
+
+bool sp1_replay_check(const sp1_replay_t *rp, uint32_t ctr)
+{
+    uint32_t back = rp->top - ctr;
+
+    if (rp->bitmap == 0 || (int32_t)back < 0)
+    {
+        return true;
+    }
+    if (back >= SP1_REPLAY_WINDOW)
+    {
+        return false;
+    }
+    return !((rp->bitmap >> back) & 1);
+}
+
+void sp1_replay_update(sp1_replay_t *rp, uint32_t ctr)
+{
+    uint32_t ahead = ctr - rp->top;
+
+    if (rp->bitmap == 0)
+    {
+        rp->top = ctr;
+        rp->bitmap = 1;
+    }
+    else if ((int32_t)ahead > 0)
+    {
+        rp->bitmap = (ahead < SP1_REPLAY_WINDOW) ? (rp->bitmap << ahead) | 1 : 1;
+        rp->top = ctr;
+    }
+    else if (-ahead < SP1_REPLAY_WINDOW)
+    {
+        rp->bitmap |= 1ULL << -ahead;
+    }
+}
+
+uint32_t sp1_frame_tx_next(void)
+{
+    return __atomic_add_fetch(&sp1_tx_ctr, 1, __ATOMIC_RELAXED);
+}
+
+int sp1_frame_session_key(const uint8_t *key, uint32_t session_id, const uint8_t *vupper64)
+{
+    uint8_t in[SP1_KDF_LEN] = {1};
+    uint8_t out[SP1_KEY_LEN];
+    uint8_t *p = &in[1 + sizeof(SP1_KDF_LABEL)];
+
+    memcpy(&in[1], SP1_KDF_LABEL, sizeof(SP1_KDF_LABEL));
+    p[0] = (uint8_t)session_id;
+    p[1] = (uint8_t)(session_id >> 8);
+    p[2] = (uint8_t)(session_id >> 16);
+    p[3] = (uint8_t)(session_id >> 24);
+    memcpy(&p[4], vupper64, 8);
+    p[13] = 128;
+
+    if (mcps_crypto_cmac_aes_128_digest(key, in, sizeof(in), out) != UWBMAC_SUCCESS)
+    {
+        return -1;
+    }
+    if (memcmp(out, sp1_key, sizeof(out)) == 0)
+    {
+        return 0;
+    }
+
+    /* a new key, the counters of the old one restart */
+    memcpy(sp1_key, out, sizeof(out));
+    __atomic_store_n(&sp1_tx_ctr, 0, __ATOMIC_RELAXED);
+    return 1;
+}
+
+const uint8_t *sp1_frame_key(void)
+{
+    return sp1_key;
+}
+
+uint32_t sp1_frame_decrypts(void)
+{
+    return sp1_decrypts;
+}
+
+/* @brief xorshift32, the link draws of SP1BENCH */
+static uint32_t bench_rand(uint32_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+/* A reception of the simulated link: frame i at block rx */
+typedef struct
+{
+    uint32_t rx;
+    uint32_t i;
+} bench_rx_t;
+
+static int bench_rx_cmp(const void *a, const void *b)
+{
+    const bench_rx_t *x = a, *y = b;
+
+    if (x->rx != y->rx)
+    {
+        return (x->rx > y->rx) - (x->rx < y->rx);
+    }
+    return (x->i > y->i) - (x->i < y->i);
+}
+
+int sp1_frame_bench(uint32_t n, sp1_bench_t res[2])
+{
+    static const uint8_t key[16] = {0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+                                    0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C};
+    uint8_t payload[SP1_BENCH_LEN] = {'B', 'T', 'N'};
+    uint8_t frame[SP1_BENCH_LEN + SP1_FRAME_OVERHEAD];
+    uint8_t plain[SP1_BENCH_LEN];
+    uint8_t nonce[MCPS_CRYPTO_AES_CCM_STAR_NONCE_LEN];
+    sp1_replay_t rp = {0};
+    uint32_t seed = 0x5EED5EEDUL;
+    uint32_t m = 0;
+    bench_rx_t *rx;
+    void *ctx;
+
+    memset(res, 0, 2 * sizeof(sp1_bench_t));
+    rx = malloc(2 * n * sizeof(bench_rx_t));
+    ctx = mcps_crypto_aead_aes_ccm_star_128_create(key);
+    if (!rx || !ctx)
+    {
+        free(rx);
+        if (ctx)
+        {
+            mcps_crypto_aead_aes_ccm_star_128_destroy(ctx);
+        }
+        return -1;
+    }
+
+    /* the link: frame i sent in block i */
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (bench_rand(&seed) % 100 < SP1_BENCH_PCT)
+        {
+            continue;
+        }
+        rx[m].i = i;
+        rx[m].rx = i + ((bench_rand(&seed) % 100 < SP1_BENCH_PCT) ? 1 + bench_rand(&seed) % 7 : 0);
+        if (bench_rand(&seed) % 100 < SP1_BENCH_PCT)
+        {
+            rx[m + 1].i = i;
+            rx[m + 1].rx = rx[m].rx + 8 + bench_rand(&seed) % 8;
+            m++;
+        }
+        m++;
+    }
+    qsort(rx, m, sizeof(bench_rx_t), bench_rx_cmp);
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    /* explicit counter: the counter of frame i is i + 1 */
+    for (uint32_t k = 0; k < m; k++)
+    {
+        uint32_t ctr, d0 = sp1_decrypts, t0;
+        int len, r;
+
+        payload[3] = (uint8_t)rx[k].i;
+        len = sp1_frame_seal(ctx, rx[k].i + 1, SP1_BENCH_SRC, SP1_DIR_DOWN, payload, sizeof(payload),
+                             frame, sizeof(frame));
+
+        t0 = DWT->CYCCNT;
+        r = sp1_frame_open(ctx, &rp, SP1_BENCH_SRC, SP1_DIR_DOWN, frame, (uint16_t)len, plain, &ctr);
+        res[0].cycles += DWT->CYCCNT - t0;
+
+        res[0].delivered++;
+        res[0].decrypts += sp1_decrypts - d0;
+        res[0].accepted += (r > 0);
+        res[0].replays += (r == SP1_E_REPLAY);
+    }
+
+    /* trial decryption: frame i under block i, tried from its reception block */
+    for (uint32_t k = 0; k < m; k++)
+    {
+        uint8_t mic[SP1_MIC_LEN];
+        uint32_t t0;
+
+        payload[3] = (uint8_t)rx[k].i;
+        memcpy(frame, payload, sizeof(payload));
+        sp1_nonce(nonce, rx[k].i, SP1_BENCH_SRC, SP1_DIR_DOWN);
+        mcps_crypto_aead_aes_ccm_star_128_encrypt(ctx, nonce, NULL, 0, frame, sizeof(payload),
+                                                  mic, sizeof(mic));
+
+        t0 = DWT->CYCCNT;
+        for (uint32_t w = 0; w < SP1_BENCH_TRIALS; w++)
+        {
+            /* a failed attempt wipes its output: decrypt a copy */
+            memcpy(plain, frame, sizeof(plain));
+            sp1_nonce(nonce, rx[k].rx + w, SP1_BENCH_SRC, SP1_DIR_DOWN);
+            res[1].decrypts++;
+            if (mcps_crypto_aead_aes_ccm_star_128_decrypt(ctx, nonce, NULL, 0, plain, sizeof(plain),
+                                                          mic, sizeof(mic)) == UWBMAC_SUCCESS)
+            {
+                res[1].accepted++;
+                break;
+            }
+        }
+        res[1].cycles += DWT->CYCCNT - t0;
+        res[1].delivered++;
+    }
+
+    mcps_crypto_aead_aes_ccm_star_128_destroy(ctx);
+    free(rx);
+    return 0;
+}
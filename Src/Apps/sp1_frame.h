@@ -0,0 +1,148 @@
+/**
+ * @file    sp1_frame.h
+ *
+ * @brief   Secured SP1 payload: explicit counter, AES-CCM*, anti-replay window
+ *
+ *          An SP1 payload of the application travels as
+ *
+ *              | counter, 4 bytes LE | payload, encrypted | MIC, 8 bytes |
+ *
+ *          The counter is the authenticated header: the sender increments it
+ *          for every frame, the receiver reads it from the frame and runs
+ *          exactly one decryption. The CCM* nonce is the counter, the short
+ *          address of the sender and the direction of the frame, so the
+ *          senders of a key never share a nonce: the controller and each
+ *          controlee count on their own. Replays are caught
+ *          before the decryption by a sliding window of the last
+ *          SP1_REPLAY_WINDOW counters per peer (RFC 4303, appendix A2); the
+ *          window only moves once the MIC is verified. Frames may be lost or
+ *          arrive out of order by up to SP1_REPLAY_WINDOW - 1 counters.
+ *
+ *          Counters compare in serial number arithmetic, so the window
+ *          follows a counter wrapping past 0xFFFFFFFF. The key does not
+ *          change with the counter: a sender must not send 2^32 frames with
+ *          one key.
+ *
+ *          The key is that of the session, derived from the application key,
+ *          the session ID and vUpper64 by sp1_frame_session_key(). A session
+ *          run again in the same boot with the same ID and vUpper64 keeps
+ *          counting; after a reboot, the counters restart from 0, so a
+ *          session must get a new ID or vUpper64 then, as its static STS
+ *          does.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef SP1_FRAME_H
+#define SP1_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SP1_CTR_LEN         4
+#define SP1_MIC_LEN         8
+#define SP1_FRAME_OVERHEAD  (SP1_CTR_LEN + SP1_MIC_LEN)
+#define SP1_REPLAY_WINDOW   64  /**< bits of sp1_replay_t.bitmap */
+#define SP1_KEY_LEN         16
+
+#define SP1_DIR_DOWN        0       /**< controller to controlee */
+#define SP1_DIR_UP          1       /**< controlee to controller */
+
+#define SP1_E_SHORT         (-1)    /**< no room for the counter, a byte and the MIC */
+#define SP1_E_REPLAY        (-2)    /**< counter accepted already, or too old */
+#define SP1_E_AUTH          (-3)    /**< MIC mismatch, or no crypto context */
+
+/* Anti-replay state of a peer, all zero before its first frame */
+typedef struct
+{
+    uint64_t bitmap;    /**< bit i: counter top - i accepted, 0: none yet */
+    uint32_t top;       /**< highest counter accepted */
+} sp1_replay_t;
+
+/**
+ * @brief frame of len bytes of payload under counter ctr
+ *
+ * @param ccm_ctx   AES-CCM* context of sp1_frame_key(), mcps_crypto_ccm_cache_get()
+ * @param src       short address of this device
+ * @param dir       SP1_DIR_xx of the frame
+ * @param frame     len + SP1_FRAME_OVERHEAD bytes, may not overlap payload
+ *
+ * @return frame length, SP1_E_SHORT if it exceeds max, SP1_E_AUTH if the
+ *         encryption fails
+ */
+int sp1_frame_seal(void *ccm_ctx, uint32_t ctr, uint16_t src, uint8_t dir,
+                   const uint8_t *payload, uint16_t len, uint8_t *frame, uint16_t max);
+
+/**
+ * @brief check, decrypt and authenticate a frame of peer rp
+ *
+ * @param src       short address of the peer
+ * @param dir       SP1_DIR_xx of the frame, from the peer
+ * @param payload   decrypted payload, len - SP1_FRAME_OVERHEAD bytes; left
+ *                  wiped if the frame is rejected
+ * @param ctr       counter of the frame, set once it is read
+ *
+ * @return payload length, or SP1_E_xx
+ */
+int sp1_frame_open(void *ccm_ctx, sp1_replay_t *rp, uint16_t src, uint8_t dir,
+                   const uint8_t *frame, uint16_t len, uint8_t *payload, uint32_t *ctr);
+
+/**
+ * @brief ctr is not in the window of rp: newer than its top, or in the
+ *        last SP1_REPLAY_WINDOW and not accepted yet
+ */
+bool sp1_replay_check(const sp1_replay_t *rp, uint32_t ctr);
+
+/**
+ * @brief mark ctr accepted, sliding the window if it is the new top
+ */
+void sp1_replay_update(sp1_replay_t *rp, uint32_t ctr);
+
+/**
+ * @brief counter of the next frame this device sends: one counter for all
+ *        the senders of the key, tasks included
+ */
+uint32_t sp1_frame_tx_next(void);
+
+/**
+ * @brief key of the session: AES-CMAC of the application key over the
+ *        session ID and vUpper64 (NIST SP 800-108, counter mode). The
+ *        counter of sp1_frame_tx_next() restarts only with a new key.
+ *
+ * @return 1 new key, 0 the key of the last session, -1 if CMAC fails
+ */
+int sp1_frame_session_key(const uint8_t *key, uint32_t session_id, const uint8_t *vupper64);
+
+/**
+ * @brief key of the session, for mcps_crypto_ccm_cache_get()
+ */
+const uint8_t *sp1_frame_key(void);
+
+/**
+ * @brief decryptions run by sp1_frame_open() since boot
+ */
+uint32_t sp1_frame_decrypts(void);
+
+/* SP1BENCH result of a scheme */
+typedef struct
+{
+    uint32_t delivered;     /**< frames received, duplicates included */
+    uint32_t accepted;      /**< frames decrypted and authenticated */
+    uint32_t decrypts;      /**< decryptions run */
+    uint32_t replays;       /**< duplicates rejected before decryption */
+    uint32_t cycles;        /**< CPU cycles of the receiver */
+} sp1_bench_t;
+
+/**
+ * @brief n frames over a simulated link that loses, delays and duplicates
+ *        them, received with sp1_frame_open() and with the trial decryption
+ *        of 5 block indices it replaces
+ *
+ * @param res   [0] explicit counter, [1] trial decryption
+ *
+ * @return 0, -1 if out of memory
+ */
+int sp1_frame_bench(uint32_t n, sp1_bench_t res[2]);
+
+#endif /* SP1_FRAME_H */
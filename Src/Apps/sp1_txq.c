@@ -0,0 +1,358 @@
+/**
+ * @file    sp1_txq.c
+ *
+ * @brief   Outgoing SP1 messages: priority queue packed into one frame per
+ *          block
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sp1_txq.h"
+
+_Static_assert(SP1_TXQ_VAL_MAX <= UINT8_MAX, "TLV length is a byte");
+
+/* SP1QBENCH load */
+#define TXQ_BENCH_BTN_PCT   5
+#define TXQ_BENCH_SENSORS   6
+#define TXQ_BENCH_BTN_LEN   3
+#define TXQ_BENCH_TELEM_LEN 12
+#define TXQ_BENCH_BULK_MIN  8       /**< bulk bytes worth a segment, SP1_XP_SEG_MIN */
+
+/* @brief the messages packed in the frame of a block before block are sent */
+static void txq_commit(sp1_txq_t *q, uint32_t block)
+{
+    for (int i = 0; i < SP1_TXQ_SLOTS; i++)
+    {
+        sp1_txq_msg_t *m = &q->msg[i];
+        int p = SP1_TLV_PRIO(m->type);
+        uint32_t d;
+
+        if (!m->used || !m->packed || (int32_t)(m->frame - block) >= 0)
+        {
+            continue;
+        }
+        d = m->frame - m->block;
+        q->st.sent[p]++;
+        q->st.delay_sum[p] += d;
+        if (d > q->st.delay_max[p])
+        {
+            q->st.delay_max[p] = d;
+        }
+        m->used = false;
+    }
+}
+
+void sp1_txq_init(sp1_txq_t *q)
+{
+    memset(q, 0, sizeof(*q));
+}
+
+int sp1_txq_push(sp1_txq_t *q, uint32_t block, uint8_t type, const uint8_t *val, uint8_t len)
+{
+    int p = SP1_TLV_PRIO(type);
+    sp1_txq_msg_t *m = NULL;
+
+    if (len == 0 || len > SP1_TXQ_VAL_MAX)
+    {
+        return SP1_TXQ_E_SIZE;
+    }
+    /* the frame of block is over */
+    txq_commit(q, block + 1);
+    q->st.pushed[p]++;
+
+    for (int i = 0; i < SP1_TXQ_SLOTS && !m; i++)
+    {
+        if (!q->msg[i].used)
+        {
+            m = &q->msg[i];
+        }
+    }
+    if (!m)
+    {
+        /* full: the newest message of the lowest priority below p makes room */
+        for (int i = 0; i < SP1_TXQ_SLOTS; i++)
+        {
+            sp1_txq_msg_t *v = &q->msg[i];
+            int pv = SP1_TLV_PRIO(v->type);
+
+            if (v->packed || pv <= p)
+            {
+                continue;
+            }
+            if (!m || pv > SP1_TLV_PRIO(m->type) || (pv == SP1_TLV_PRIO(m->type) && v->seq > m->seq))
+            {
+                m = v;
+            }
+        }
+        if (!m)
+        {
+            q->st.dropped[p]++;
+            return SP1_TXQ_E_FULL;
+        }
+        q->st.dropped[SP1_TLV_PRIO(m->type)]++;
+    }
+
+    m->seq = q->seq++;
+    m->block = block;
+    m->type = type;
+    m->len = len;
+    m->packed = false;
+    m->used = true;
+    memcpy(m->val, val, len);
+    return 0;
+}
+
+bool sp1_txq_pending(const sp1_txq_t *q)
+{
+    for (int i = 0; i < SP1_TXQ_SLOTS; i++)
+    {
+        if (q->msg[i].used && !q->msg[i].packed)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int sp1_txq_pack(sp1_txq_t *q, uint32_t block, uint8_t *frame, int max, sp1_txq_fill_t fill, void *arg)
+{
+    uint8_t order[SP1_TXQ_SLOTS];
+    int n = 0, k = 0;
+
+    txq_commit(q, block);
+
+    /* the queued messages by priority then age; packing the frame of block
+     * again starts over */
+    for (int i = 0; i < SP1_TXQ_SLOTS; i++)
+    {
+        sp1_txq_msg_t *m = &q->msg[i];
+        int j = k++;
+
+        if (!m->used)
+        {
+            k--;
+            continue;
+        }
+        m->packed = false;
+        while (j > 0)
+        {
+            const sp1_txq_msg_t *o = &q->msg[order[j - 1]];
+            int po = SP1_TLV_PRIO(o->type), pm = SP1_TLV_PRIO(m->type);
+
+            if (po < pm || (po == pm && o->seq < m->seq))
+            {
+                break;
+            }
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = (uint8_t)i;
+    }
+
+    for (int i = 0, skip = -1; i < k; i++)
+    {
+        sp1_txq_msg_t *m = &q->msg[order[i]];
+        int p = SP1_TLV_PRIO(m->type);
+
+        /* one that does not fit holds the rest of its priority */
+        if (p == skip)
+        {
+            continue;
+        }
+        if (!sp1_tlv_put(&frame[n], max - n, m->type, m->val, m->len))
+        {
+            skip = p;
+            continue;
+        }
+        n += SP1_TLV_HDR_LEN + m->len;
+        m->packed = true;
+        m->frame = block;
+    }
+
+    if (fill && max - n > SP1_TLV_HDR_LEN)
+    {
+        n += fill(arg, block, &frame[n], max - n);
+    }
+
+    if (block != q->frame_block)
+    {
+        if (q->frame_len > 0)
+        {
+            q->st.frames++;
+            q->st.bytes += q->frame_len;
+        }
+        q->frame_block = block;
+    }
+    q->frame_len = n;
+    return n;
+}
+
+int sp1_tlv_put(uint8_t *buf, int room, uint8_t type, const uint8_t *val, int len)
+{
+    if (len > UINT8_MAX || SP1_TLV_HDR_LEN + len > room)
+    {
+        return 0;
+    }
+    buf[0] = type;
+    buf[1] = (uint8_t)len;
+    memmove(&buf[SP1_TLV_HDR_LEN], val, len);
+    return SP1_TLV_HDR_LEN + len;
+}
+
+int sp1_tlv_next(const uint8_t **p, const uint8_t *end, uint8_t *type, const uint8_t **val, uint8_t *len)
+{
+    const uint8_t *b = *p;
+
+    if (b >= end)
+    {
+        return 0;
+    }
+    if (end - b < SP1_TLV_HDR_LEN || end - b - SP1_TLV_HDR_LEN < b[1])
+    {
+        return -1;
+    }
+    *type = b[0];
+    *len = b[1];
+    *val = &b[SP1_TLV_HDR_LEN];
+    *p = b + SP1_TLV_HDR_LEN + b[1];
+    return 1;
+}
+
+int sp1_btn_put(uint8_t *val, uint8_t counter, uint16_t corr)
+{
+    val[0] = counter;
+    val[1] = (uint8_t)corr;
+    val[2] = (uint8_t)(corr >> 8);
+    return SP1_BTN_LEN;
+}
+
+bool sp1_btn_get(const uint8_t *val, uint8_t len, uint8_t *counter, uint16_t *corr)
+{
+    if (len < SP1_BTN_LEN)
+    {
+        return false;
+    }
+    *counter = val[0];
+    *corr = (uint16_t)(val[1] | (val[2] << 8));
+    return true;
+}
+
+/* @brief xorshift32, the load draws */
+static uint32_t txq_bench_rand(uint32_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+/* @brief fill of SP1QBENCH: a backlogged transport takes the room left */
+static int txq_bench_fill(void *arg, uint32_t block, uint8_t *buf, int room)
+{
+    static const uint8_t bulk[SP1_TXQ_VAL_MAX];
+    uint32_t *bytes = arg;
+    int len = room - SP1_TLV_HDR_LEN;
+    (void)block;
+
+    if (len < TXQ_BENCH_BULK_MIN)
+    {
+        return 0;
+    }
+    *bytes += len;
+    return sp1_tlv_put(buf, room, SP1_TLV_XPORT, bulk, len);
+}
+
+int sp1_txq_bench(uint32_t blocks, int telem_pct, sp1_txq_bench_t res[2])
+{
+    static const uint8_t val[SP1_TXQ_VAL_MAX];
+    uint8_t frame[SP1_TXQ_FRAME_MAX];
+    uint32_t seed = 0x5EED5EEDUL, bulk = 0;
+    sp1_txq_t *q;
+
+    memset(res, 0, 2 * sizeof(sp1_txq_bench_t));
+    q = malloc(sizeof(*q));
+    if (!q)
+    {
+        return -1;
+    }
+    sp1_txq_init(q);
+
+    for (uint32_t blk = 1; blk <= blocks; blk++)
+    {
+        /* the messages of the block before this one, in their order */
+        uint8_t type[1 + TXQ_BENCH_SENSORS];
+        int n = 0, last;
+
+        if ((int)(txq_bench_rand(&seed) % 100) < TXQ_BENCH_BTN_PCT)
+        {
+            type[n++] = SP1_TLV_BTN;
+        }
+        for (int s = 0; s < TXQ_BENCH_SENSORS; s++)
+        {
+            if ((int)(txq_bench_rand(&seed) % 100) < telem_pct)
+            {
+                type[n++] = SP1_TLV_TELEM;
+            }
+        }
+        if (n > 1 && type[0] == SP1_TLV_BTN)
+        {
+            /* the press comes at any point of the block */
+            int k = 1 + txq_bench_rand(&seed) % n;
+
+            type[0] = type[k - 1];
+            type[k - 1] = SP1_TLV_BTN;
+        }
+
+        /* queue */
+        for (int i = 0; i < n; i++)
+        {
+            sp1_txq_push(q, blk - 1, type[i], val,
+                         (type[i] == SP1_TLV_BTN) ? TXQ_BENCH_BTN_LEN : TXQ_BENCH_TELEM_LEN);
+        }
+        res[0].bytes += sp1_txq_pack(q, blk, frame, sizeof(frame), txq_bench_fill, &bulk);
+
+        /* one payload: data_task sends the transport frame after the
+         * report, each message sent later in the block replaces it */
+        res[1].frames++;
+        res[1].bytes += sizeof(frame);
+        last = n - 1;
+        if (last < 0)
+        {
+            res[1].sent[SP1_TXQ_BULK] += sizeof(frame);
+        }
+        for (int i = 0; i < n; i++)
+        {
+            int p = SP1_TLV_PRIO(type[i]);
+
+            if (i == last)
+            {
+                res[1].sent[p]++;
+                res[1].delay_sum[p]++;
+                res[1].delay_max[p] = 1;
+                res[1].bytes -= sizeof(frame) - ((p == SP1_TXQ_URGENT) ? TXQ_BENCH_BTN_LEN : TXQ_BENCH_TELEM_LEN);
+            }
+            else
+            {
+                res[1].lost[p]++;
+            }
+        }
+    }
+    txq_commit(q, blocks + 1);
+
+    res[0].frames = q->st.frames + (q->frame_len > 0);
+    for (int p = 0; p < SP1_TXQ_PRIOS; p++)
+    {
+        res[0].sent[p] = q->st.sent[p];
+        res[0].lost[p] = q->st.dropped[p];
+        res[0].delay_sum[p] = q->st.delay_sum[p];
+        res[0].delay_max[p] = q->st.delay_max[p];
+    }
+    res[0].sent[SP1_TXQ_BULK] = bulk;
+
+    free(q);
+    return 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file    sp1_txq.h
+ *
+ * @brief   Outgoing SP1 messages: priority queue packed into one frame per
+ *          block
+ *
+ *          The MAC holds a single SP1 payload, which each
+ *          fira_helper_send_data() replaces. The application messages of a
+ *          block go through this queue instead, and data_task sends one
+ *          frame per block, the plaintext of an sp1_frame.h frame:
+ *
+ *              | type | len | value | type | len | value | ...
+ *
+ *          The high nibble of the type is its priority: urgent messages,
+ *          the button presses, go first, then the normal ones, then bulk.
+ *          Within a priority the messages keep their order: the first one
+ *          that does not fit waits for the next frame, and the lower
+ *          priorities fill what is left. Past the queued messages, a fill
+ *          callback builds the frame of the SP1 transport, sized to the
+ *          room left.
+ *
+ *          A frame can be packed again for its block, until the block
+ *          starts: a message queued meanwhile joins the frame, and the
+ *          messages of the first packing stay in it if they still fit. The
+ *          messages leave the queue once their block is over.
+ *
+ *          No allocation, no RTOS: the caller serializes the calls.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef SP1_TXQ_H
+#define SP1_TXQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sp1_frame.h"
+
+#define SP1_TXQ_FRAME_MAX   (84 - SP1_FRAME_OVERHEAD)   /**< plaintext of FIRA_DATA_PAYLOAD_SIZE_MAX */
+#define SP1_TLV_HDR_LEN     2
+#define SP1_TXQ_VAL_MAX     (SP1_TXQ_FRAME_MAX - SP1_TLV_HDR_LEN)
+
+#ifndef SP1_TXQ_SLOTS
+#define SP1_TXQ_SLOTS       16      /**< messages queued at most */
+#endif
+
+#define SP1_TXQ_PRIOS       3
+#define SP1_TXQ_URGENT      0
+#define SP1_TXQ_NORMAL      1
+#define SP1_TXQ_BULK        2
+#define SP1_TLV_PRIO(type)  ((((type) >> 4) < SP1_TXQ_PRIOS) ? ((type) >> 4) : SP1_TXQ_BULK)
+
+#define SP1_TLV_BTN         0x01    /**< button press: counter, trace correlation ID LE */
+#define SP1_TLV_TELEM       0x10    /**< telemetry sample */
+#define SP1_TLV_XPORT       0x20    /**< frame of the SP1 transport, sp1_xport.h */
+
+#define SP1_BTN_LEN         3       /**< value of SP1_TLV_BTN */
+
+#define SP1_TXQ_E_SIZE      (-1)    /**< value empty or longer than SP1_TXQ_VAL_MAX */
+#define SP1_TXQ_E_FULL      (-2)    /**< no slot, none of a lower priority to take */
+
+/**
+ * @brief bytes past the queued messages: write TLVs of at most room bytes
+ *        to buf for block
+ *
+ * @return bytes written
+ */
+typedef int (*sp1_txq_fill_t)(void *arg, uint32_t block, uint8_t *buf, int room);
+
+typedef struct
+{
+    uint32_t pushed[SP1_TXQ_PRIOS];
+    uint32_t sent[SP1_TXQ_PRIOS];       /**< messages of a block over */
+    uint32_t dropped[SP1_TXQ_PRIOS];    /**< queue full, or taken by a higher priority */
+    uint32_t delay_sum[SP1_TXQ_PRIOS];  /**< blocks from the push to the block of the frame */
+    uint32_t delay_max[SP1_TXQ_PRIOS];
+    uint32_t frames;                    /**< frames of a block over */
+    uint32_t bytes;                     /**< and their bytes */
+} sp1_txq_stats_t;
+
+typedef struct
+{
+    int32_t seq;        /**< order within the priority */
+    uint32_t block;     /**< block of the push */
+    uint32_t frame;     /**< block of the frame it is packed in */
+    uint8_t type;
+    uint8_t len;
+    bool used;
+    bool packed;
+    uint8_t val[SP1_TXQ_VAL_MAX];
+} sp1_txq_msg_t;
+
+typedef struct
+{
+    sp1_txq_msg_t msg[SP1_TXQ_SLOTS];
+    int32_t seq;
+    uint32_t frame_block;   /**< block of the last frame packed */
+    int frame_len;
+    sp1_txq_stats_t st;
+} sp1_txq_t;
+
+void sp1_txq_init(sp1_txq_t *q);
+
+/**
+ * @brief queue a message, pushed after block
+ *
+ * @return 0, SP1_TXQ_E_SIZE or SP1_TXQ_E_FULL
+ */
+int sp1_txq_push(sp1_txq_t *q, uint32_t block, uint8_t type, const uint8_t *val, uint8_t len);
+
+/**
+ * @brief messages queued and not in a frame yet
+ */
+bool sp1_txq_pending(const sp1_txq_t *q);
+
+/**
+ * @brief frame of block: the queued messages by priority, then fill
+ *
+ * @param fill  NULL if none
+ *
+ * @return frame length, 0 if empty
+ */
+int sp1_txq_pack(sp1_txq_t *q, uint32_t block, uint8_t *frame, int max, sp1_txq_fill_t fill, void *arg);
+
+/**
+ * @brief TLV of type and value at buf, room bytes at most
+ *
+ * @return bytes written, 0 if it does not fit
+ */
+int sp1_tlv_put(uint8_t *buf, int room, uint8_t type, const uint8_t *val, int len);
+
+/**
+ * @brief next TLV of a frame, *p past it
+ *
+ * @return 1, 0 at the end, -1 if the frame is truncated
+ */
+int sp1_tlv_next(const uint8_t **p, const uint8_t *end, uint8_t *type, const uint8_t **val, uint8_t *len);
+
+/**
+ * @brief value of a SP1_TLV_BTN: the press counter, then the trace
+ *        correlation ID of the press, little endian
+ *
+ * @return SP1_BTN_LEN
+ */
+int sp1_btn_put(uint8_t *val, uint8_t counter, uint16_t corr);
+
+/**
+ * @brief counter and correlation ID of a SP1_TLV_BTN value
+ *
+ * @return false if it is too short
+ */
+bool sp1_btn_get(const uint8_t *val, uint8_t len, uint8_t *counter, uint16_t *corr);
+
+/* SP1QBENCH result of a scheme */
+typedef struct
+{
+    uint32_t sent[SP1_TXQ_PRIOS];       /**< urgent, normal messages on air; bulk bytes */
+    uint32_t lost[SP1_TXQ_PRIOS];       /**< messages overwritten or dropped */
+    uint32_t delay_sum[SP1_TXQ_PRIOS];  /**< blocks */
+    uint32_t delay_max[SP1_TXQ_PRIOS];
+    uint32_t frames;
+    uint32_t bytes;                     /**< frame bytes, TLV headers included */
+} sp1_txq_bench_t;
+
+/**
+ * @brief blocks of a mixed load: a button press in 5% of the blocks, 6
+ *        sensors sampling 12 bytes in telem_pct percent of the blocks each,
+ *        a bulk transport always backlogged
+ *
+ * @param res   [0] this queue, [1] one payload per block, the last
+ *              fira_helper_send_data() of the block
+ *
+ * @return 0, -1 if out of memory
+ */
+int sp1_txq_bench(uint32_t blocks, int telem_pct, sp1_txq_bench_t res[2]);
+
+#endif /* SP1_TXQ_H */
@@ -0,0 +1,533 @@
+/**
+ * @file    sp1_xport.c
+ *
+ * @brief   Bulk transport over SP1 payloads: segmentation, sliding window,
+ *          selective ACKs
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sp1_xport.h"
+
+_Static_assert(SP1_XP_MSG_MAX <= UINT16_MAX, "total and offset are 16 bits");
+_Static_assert(SP1_XP_WINDOW <= 16, "SACK bitmap of 16 bits");
+
+#define XP_BENCH_A          0x000A
+#define XP_BENCH_B          0x000B
+#define XP_BENCH_BLOB       4096    /**< A to B, a config blob */
+#define XP_BENCH_LOG        512     /**< B to A, a log */
+
+static inline uint16_t rd16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline void wr16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+/* @brief blocks before the next try of a segment sent tries times */
+static uint32_t xp_rto(uint8_t tries)
+{
+    uint32_t rto = (uint32_t)SP1_XP_RTO_BLOCKS << (tries ? tries - 1 : 0);
+
+    return (rto < SP1_XP_RTO_MAX) ? rto : SP1_XP_RTO_MAX;
+}
+
+static void xp_tx_restart(sp1_xport_t *x)
+{
+    x->tx_off = 0;
+    x->tx_msg++;
+    x->snd_una = x->snd_nxt;
+    memset(x->seg, 0, sizeof(x->seg));
+}
+
+void sp1_xport_init(sp1_xport_t *x, uint16_t addr, uint16_t tx_max, uint16_t rx_max,
+                    sp1_xport_rx_cb_t cb, void *arg)
+{
+    memset(x, 0, offsetof(sp1_xport_t, buf));
+    x->addr = addr;
+    x->tx_max = (tx_max < SP1_XP_MSG_MAX) ? tx_max : SP1_XP_MSG_MAX;
+    x->rx_max = (rx_max < SP1_XP_MSG_MAX) ? rx_max : SP1_XP_MSG_MAX;
+    x->rx_buf = &x->buf[x->tx_max];
+    x->window = SP1_XP_WINDOW;
+    x->rx_msg = SP1_XP_NO_MSG;
+    x->rx_cb = cb;
+    x->rx_arg = arg;
+}
+
+void sp1_xport_reset(sp1_xport_t *x)
+{
+    x->rx_active = false;
+    x->ack_pending = false;
+    x->rx_msg = SP1_XP_NO_MSG;
+    x->rcv_sack = 0;
+    if (x->tx_len)
+    {
+        xp_tx_restart(x);
+    }
+}
+
+int sp1_xport_send(sp1_xport_t *x, uint16_t dst, const uint8_t *msg, uint16_t len)
+{
+    if (x->tx_len)
+    {
+        return SP1_XP_E_BUSY;
+    }
+    if (len == 0 || len > x->tx_max)
+    {
+        return SP1_XP_E_SIZE;
+    }
+    memcpy(x->buf, msg, len);
+    x->tx_len = len;
+    x->tx_dst = dst;
+    xp_tx_restart(x);
+    return 0;
+}
+
+bool sp1_xport_tx_busy(const sp1_xport_t *x)
+{
+    return x->tx_len != 0;
+}
+
+bool sp1_xport_pending(const sp1_xport_t *x)
+{
+    return x->tx_len != 0 || x->ack_pending;
+}
+
+/* @brief segment to send again in block, oldest first: acked out of order
+ *        after a later one, or past its timeout; the message is dropped
+ *        once a segment has had all its tries
+ * @return the sequence, -1 if none */
+static int xp_retx(sp1_xport_t *x, uint32_t block)
+{
+    for (uint8_t q = x->snd_una; q != x->snd_nxt; q++)
+    {
+        sp1_xp_seg_t *s = &x->seg[q % SP1_XP_WINDOW];
+
+        if (s->acked || !(s->lost || block - s->tx_block >= xp_rto(s->tries)))
+        {
+            continue;
+        }
+        if (s->tries >= SP1_XP_TRIES_MAX)
+        {
+            x->st.tx_fail++;
+            x->tx_len = 0;
+            x->snd_una = x->snd_nxt;
+            return -1;
+        }
+        return q;
+    }
+    return -1;
+}
+
+int sp1_xport_build(sp1_xport_t *x, uint32_t block, uint8_t *frame, int max)
+{
+    int room = ((max < UINT8_MAX) ? max : UINT8_MAX) - SP1_XP_HDR_LEN - SP1_XP_SEG_HDR_LEN;
+    bool ack = x->ack_pending;
+    sp1_xp_seg_t *s = NULL;
+    int seq = -1, len = 0, n;
+
+    if (x->tx_len)
+    {
+        seq = xp_retx(x, block);
+    }
+    if (seq >= 0)
+    {
+        s = &x->seg[seq % SP1_XP_WINDOW];
+        len = s->len;
+        /* a retransmission keeps its size, the ACK waits if both do not fit */
+        if (ack && len > room - SP1_XP_ACK_LEN)
+        {
+            ack = false;
+        }
+        if (len > room)
+        {
+            s = NULL;
+            ack = x->ack_pending;
+        }
+    }
+    else if (x->tx_len && x->tx_off < x->tx_len && (uint8_t)(x->snd_nxt - x->snd_una) < x->window)
+    {
+        /* a new segment fills what the header and the ACK leave */
+        len = room - (ack ? SP1_XP_ACK_LEN : 0);
+        if (len > x->tx_len - x->tx_off)
+        {
+            len = x->tx_len - x->tx_off;
+        }
+        if (len >= SP1_XP_SEG_MIN || (len > 0 && len == x->tx_len - x->tx_off))
+        {
+            seq = x->snd_nxt++;
+            s = &x->seg[seq % SP1_XP_WINDOW];
+            memset(s, 0, sizeof(*s));
+            s->off = x->tx_off;
+            s->len = (uint8_t)len;
+            x->tx_off += len;
+        }
+    }
+
+    /* one destination per frame: ACKs of another peer take every other turn */
+    if (s && ack && x->rx_src != x->tx_dst)
+    {
+        x->ack_turn = !x->ack_turn;
+        if (x->ack_turn)
+        {
+            ack = false;
+        }
+        else if (s->tries == 0)
+        {
+            /* the new segment is not sent, undo it */
+            x->snd_nxt--;
+            x->tx_off -= s->len;
+            s = NULL;
+        }
+        else
+        {
+            s = NULL;
+        }
+    }
+    if (!s && !ack)
+    {
+        return 0;
+    }
+    if (!s && max < SP1_XP_HDR_LEN + SP1_XP_ACK_LEN)
+    {
+        return 0;
+    }
+
+    frame[0] = (ack ? SP1_XP_F_ACK : 0) | (s ? SP1_XP_F_DATA : 0);
+    wr16(&frame[1], s ? x->tx_dst : x->rx_src);
+    n = SP1_XP_HDR_LEN;
+
+    if (ack)
+    {
+        frame[n] = x->rcv_nxt;
+        wr16(&frame[n + 1], x->rcv_sack);
+        n += SP1_XP_ACK_LEN;
+        x->ack_pending = false;
+        x->st.tx_acks++;
+    }
+    if (s)
+    {
+        frame[n] = (uint8_t)seq;
+        frame[n + 1] = x->tx_msg;
+        wr16(&frame[n + 2], x->tx_len);
+        wr16(&frame[n + 4], s->off);
+        memcpy(&frame[n + SP1_XP_SEG_HDR_LEN], &x->buf[s->off], s->len);
+        n += SP1_XP_SEG_HDR_LEN + s->len;
+
+        x->st.tx_segs++;
+        x->st.tx_retx += (s->tries > 0);
+        s->tries++;
+        s->tx_block = block;
+        s->lost = false;
+    }
+    return n;
+}
+
+/* @brief ACK of the receiver of our message: next sequence it expects, and
+ *        the ones past it it has */
+static void xp_ack(sp1_xport_t *x, uint16_t src, uint8_t next, uint16_t sack)
+{
+    uint8_t inflight = x->snd_nxt - x->snd_una;
+    uint32_t newest = 0;
+    bool sacked = false;
+
+    if (!x->tx_len || src != x->tx_dst || (uint8_t)(next - x->snd_una) > inflight)
+    {
+        return;
+    }
+
+    for (uint8_t q = x->snd_una; q != next; q++)
+    {
+        x->seg[q % SP1_XP_WINDOW].acked = true;
+    }
+    for (int i = 0; i < SP1_XP_WINDOW; i++)
+    {
+        uint8_t q = next + 1 + i;
+        sp1_xp_seg_t *s = &x->seg[q % SP1_XP_WINDOW];
+
+        if (!((sack >> i) & 1) || (uint8_t)(q - x->snd_una) >= inflight)
+        {
+            continue;
+        }
+        if (!s->acked)
+        {
+            s->acked = true;
+        }
+        if (!sacked || (int32_t)(s->tx_block - newest) > 0)
+        {
+            newest = s->tx_block;
+        }
+        sacked = true;
+    }
+
+    /* a segment sent before one the receiver has is lost, no need to wait */
+    if (sacked)
+    {
+        for (uint8_t q = x->snd_una; q != x->snd_nxt; q++)
+        {
+            sp1_xp_seg_t *s = &x->seg[q % SP1_XP_WINDOW];
+
+            if (!s->acked && (int32_t)(s->tx_block - newest) < 0)
+            {
+                s->lost = true;
+            }
+        }
+    }
+
+    while (x->snd_una != x->snd_nxt && x->seg[x->snd_una % SP1_XP_WINDOW].acked)
+    {
+        x->snd_una++;
+    }
+    if (x->snd_una == x->snd_nxt && x->tx_off == x->tx_len)
+    {
+        x->st.tx_msgs++;
+        x->st.tx_bytes += x->tx_len;
+        x->tx_len = 0;
+    }
+}
+
+/* @brief segment of peer src, n bytes with its header */
+static void xp_seg(sp1_xport_t *x, uint16_t src, const uint8_t *p, int n)
+{
+    uint8_t seq = p[0], msg = p[1];
+    uint16_t total = rd16(&p[2]), off = rd16(&p[4]);
+    int len = n - SP1_XP_SEG_HDR_LEN;
+    uint8_t d;
+
+    x->st.rx_segs++;
+    if (len <= 0 || total > x->rx_max || off + len > total)
+    {
+        x->st.rx_drop++;
+        return;
+    }
+
+    if (src != x->rx_src || msg != x->rx_msg)
+    {
+        /* another message: its first segment sets the sequences, the
+         * others wait for it; a message of another peer waits for the end
+         * of the one reassembled */
+        if (off != 0 || (x->rx_active && src != x->rx_src))
+        {
+            x->st.rx_drop++;
+            return;
+        }
+        x->rx_src = src;
+        x->rx_msg = msg;
+        x->rx_total = total;
+        x->rx_got = 0;
+        x->rx_active = true;
+        x->rcv_nxt = seq;
+        x->rcv_sack = 0;
+    }
+
+    x->ack_pending = true;
+    d = seq - x->rcv_nxt;
+    if (d >= SP1_XP_WINDOW)
+    {
+        /* acked already: the ACK was lost, the new one goes out */
+        if ((uint8_t)(x->rcv_nxt - seq) <= SP1_XP_WINDOW)
+        {
+            x->st.rx_dup++;
+        }
+        else
+        {
+            x->st.rx_drop++;
+        }
+        return;
+    }
+    if ((d && ((x->rcv_sack >> (d - 1)) & 1)) || !x->rx_active)
+    {
+        x->st.rx_dup++;
+        return;
+    }
+    if (total != x->rx_total)
+    {
+        x->st.rx_drop++;
+        return;
+    }
+
+    memcpy(&x->rx_buf[off], &p[SP1_XP_SEG_HDR_LEN], len);
+    x->rx_got += len;
+    if (d == 0)
+    {
+        /* slide over the segments received past it */
+        x->rcv_nxt++;
+        while (x->rcv_sack & 1)
+        {
+            x->rcv_sack >>= 1;
+            x->rcv_nxt++;
+        }
+        x->rcv_sack >>= 1;
+    }
+    else
+    {
+        x->rcv_sack |= 1 << (d - 1);
+    }
+
+    if (x->rx_got == x->rx_total)
+    {
+        x->rx_active = false;
+        x->st.rx_msgs++;
+        x->st.rx_bytes += x->rx_total;
+        if (x->rx_cb)
+        {
+            x->rx_cb(src, x->rx_buf, x->rx_total, x->rx_arg);
+        }
+    }
+}
+
+int sp1_xport_rx(sp1_xport_t *x, uint16_t src, const uint8_t *frame, int len)
+{
+    int n = SP1_XP_HDR_LEN;
+
+    if (len < SP1_XP_HDR_LEN)
+    {
+        return SP1_XP_E_FRAME;
+    }
+    if (rd16(&frame[1]) != x->addr)
+    {
+        return SP1_XP_E_DST;
+    }
+
+    if (frame[0] & SP1_XP_F_ACK)
+    {
+        if (len < n + SP1_XP_ACK_LEN)
+        {
+            return SP1_XP_E_FRAME;
+        }
+        xp_ack(x, src, frame[n], rd16(&frame[n + 1]));
+        n += SP1_XP_ACK_LEN;
+    }
+    if (frame[0] & SP1_XP_F_DATA)
+    {
+        if (len <= n + SP1_XP_SEG_HDR_LEN)
+        {
+            return SP1_XP_E_FRAME;
+        }
+        xp_seg(x, src, &frame[n], len - n);
+    }
+    return 0;
+}
+
+/* @brief content of byte k of a bench message of len bytes */
+static inline uint8_t xp_bench_byte(uint32_t k, uint16_t len)
+{
+    return (uint8_t)((k * 131) ^ (k >> 8) ^ len);
+}
+
+typedef struct
+{
+    uint32_t bytes;
+    uint32_t corrupt;
+    uint16_t len;
+} xp_bench_rx_t;
+
+static void xp_bench_rx(uint16_t src, const uint8_t *msg, uint16_t len, void *arg)
+{
+    xp_bench_rx_t *r = arg;
+    (void)src;
+
+    for (uint32_t k = 0; k < len; k++)
+    {
+        if (len != r->len || msg[k] != xp_bench_byte(k, len))
+        {
+            r->corrupt++;
+            return;
+        }
+    }
+    r->bytes += len;
+}
+
+/* @brief xorshift32, the loss draws */
+static uint32_t xp_bench_rand(uint32_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+int sp1_xport_bench(uint32_t blocks, int loss_pct, int window, int max, sp1_xport_bench_t *res)
+{
+    xp_bench_rx_t rx_a = {.len = XP_BENCH_LOG}, rx_b = {.len = XP_BENCH_BLOB};
+    uint8_t fa[UINT8_MAX], fb[UINT8_MAX];
+    uint32_t seed = 0x5EED5EEDUL;
+    sp1_xport_t *a, *b;
+    uint8_t *msg;
+
+    memset(res, 0, sizeof(*res));
+    /* each end sized for its messages: one blob each way, not two */
+    a = malloc(SP1_XPORT_SIZE(XP_BENCH_BLOB, XP_BENCH_LOG));
+    b = malloc(SP1_XPORT_SIZE(XP_BENCH_LOG, XP_BENCH_BLOB));
+    msg = malloc(XP_BENCH_BLOB);
+    if (!a || !b || !msg)
+    {
+        free(a);
+        free(b);
+        free(msg);
+        return -1;
+    }
+    if (max > (int)sizeof(fa))
+    {
+        max = sizeof(fa);
+    }
+
+    sp1_xport_init(a, XP_BENCH_A, XP_BENCH_BLOB, XP_BENCH_LOG, xp_bench_rx, &rx_a);
+    sp1_xport_init(b, XP_BENCH_B, XP_BENCH_LOG, XP_BENCH_BLOB, xp_bench_rx, &rx_b);
+    a->window = b->window = (window < 1) ? 1 : (window > SP1_XP_WINDOW) ? SP1_XP_WINDOW : window;
+
+    for (uint32_t blk = 1; blk <= blocks; blk++)
+    {
+        int na, nb;
+
+        if (!sp1_xport_tx_busy(a))
+        {
+            for (uint32_t k = 0; k < XP_BENCH_BLOB; k++)
+            {
+                msg[k] = xp_bench_byte(k, XP_BENCH_BLOB);
+            }
+            sp1_xport_send(a, XP_BENCH_B, msg, XP_BENCH_BLOB);
+        }
+        if (!sp1_xport_tx_busy(b))
+        {
+            for (uint32_t k = 0; k < XP_BENCH_LOG; k++)
+            {
+                msg[k] = xp_bench_byte(k, XP_BENCH_LOG);
+            }
+            sp1_xport_send(b, XP_BENCH_A, msg, XP_BENCH_LOG);
+        }
+
+        /* both frames of a block are built before it, as the MAC takes them */
+        na = sp1_xport_build(a, blk, fa, max);
+        nb = sp1_xport_build(b, blk, fb, max);
+        if (na > 0 && (int)(xp_bench_rand(&seed) % 100) >= loss_pct)
+        {
+            sp1_xport_rx(b, XP_BENCH_A, fa, na);
+        }
+        if (nb > 0 && (int)(xp_bench_rand(&seed) % 100) >= loss_pct)
+        {
+            sp1_xport_rx(a, XP_BENCH_B, fb, nb);
+        }
+    }
+
+    res->ab_bytes = rx_b.bytes;
+    res->ba_bytes = rx_a.bytes;
+    res->ab_segs = a->st.tx_segs;
+    res->ab_retx = a->st.tx_retx;
+    res->ab_fail = a->st.tx_fail;
+    res->corrupt = rx_a.corrupt + rx_b.corrupt;
+
+    free(a);
+    free(b);
+    free(msg);
+    return 0;
+}
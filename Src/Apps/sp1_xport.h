@@ -0,0 +1,209 @@
+/**
+ * @file    sp1_xport.h
+ *
+ * @brief   Bulk transport over SP1 payloads: segmentation, sliding window,
+ *          selective ACKs
+ *
+ *          The MAC carries one SP1 payload per device and per block, about
+ *          70 bytes once secured, and leaves loss recovery to the
+ *          application. This layer sends messages of up to SP1_XP_MSG_MAX
+ *          bytes, config blobs or logs, between the two ends of a link in
+ *          segments of one SP1 payload each. Its frames travel in an
+ *          SP1_TLV_XPORT TLV of the sp1_txq.h frame of the block:
+ *
+ *              | flags | dst, 2 bytes LE | ACK | DATA |
+ *
+ *              ACK  (SP1_XP_F_ACK):  | next expected seq | SACK bitmap, 2 bytes LE |
+ *              DATA (SP1_XP_F_DATA): | seq | msg | total, 2 bytes LE | offset, 2 bytes LE | bytes |
+ *
+ *          Up to SP1_XP_WINDOW segments are in flight. The receiver acks the
+ *          next sequence it expects and, bit i of the SACK bitmap, sequence
+ *          next + 1 + i; the ACK rides on the next frame it sends the other
+ *          way, with data or alone. A segment is sent again when a later one
+ *          is acked first, or after SP1_XP_RTO_BLOCKS blocks doubled per try;
+ *          after SP1_XP_TRIES_MAX tries the message is dropped.
+ *
+ *          sp1_xport_build() fits the frame to the bytes the caller has left
+ *          in the block: a new segment takes whatever the header and a
+ *          pending ACK leave, the last one of a message only what remains.
+ *
+ *          One message is in flight per direction. The first segment of a
+ *          message, offset 0, sets where its sequences start, so either end
+ *          may restart without the other: a receiver drops the segments of
+ *          a new message until its first one, which stays unacked, comes
+ *          again. A receiver reassembles from one peer at a time.
+ *
+ *          No allocation, no RTOS: the caller serializes the calls. The
+ *          caller sizes the message buffers, at the end of the transport:
+ *          SP1_XPORT_SIZE() bytes, SP1_XP_MSG_MAX each way for a session.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef SP1_XPORT_H
+#define SP1_XPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef SP1_XP_MSG_MAX
+#define SP1_XP_MSG_MAX      4096    /**< bytes of a message */
+#endif
+
+#define SP1_XP_F_ACK        0x01
+#define SP1_XP_F_DATA       0x02
+
+#define SP1_XP_HDR_LEN      3
+#define SP1_XP_ACK_LEN      3
+#define SP1_XP_SEG_HDR_LEN  6
+#define SP1_XP_SEG_MIN      8       /**< bytes of a new segment at least, else it waits a block */
+
+#define SP1_XP_WINDOW       16      /**< segments in flight, bits of the SACK bitmap */
+#define SP1_XP_RTO_BLOCKS   3       /**< blocks before a first retransmission */
+#define SP1_XP_RTO_MAX      24
+#define SP1_XP_TRIES_MAX    16
+
+#define SP1_XP_E_BUSY       (-1)    /**< a message is in flight */
+#define SP1_XP_E_SIZE       (-2)    /**< empty, or longer than SP1_XP_MSG_MAX */
+#define SP1_XP_E_FRAME      (-3)    /**< malformed */
+#define SP1_XP_E_DST        (-4)    /**< for another device */
+
+/**
+ * @brief a message of peer src is complete
+ */
+typedef void (*sp1_xport_rx_cb_t)(uint16_t src, const uint8_t *msg, uint16_t len, void *arg);
+
+typedef struct
+{
+    uint32_t tx_msgs;       /**< messages acked in full */
+    uint32_t tx_fail;       /**< messages dropped after SP1_XP_TRIES_MAX tries */
+    uint32_t tx_bytes;      /**< bytes of the messages acked */
+    uint32_t tx_segs;       /**< segments sent, retransmissions included */
+    uint32_t tx_retx;       /**< retransmissions */
+    uint32_t tx_acks;       /**< frames with an ACK */
+    uint32_t rx_msgs;       /**< messages delivered */
+    uint32_t rx_bytes;      /**< bytes of the messages delivered */
+    uint32_t rx_segs;       /**< segments received, duplicates included */
+    uint32_t rx_dup;        /**< segments received already */
+    uint32_t rx_drop;       /**< segments out of the window, of another peer, or malformed */
+} sp1_xport_stats_t;
+
+typedef struct
+{
+    uint32_t tx_block;      /**< block of the last transmission */
+    uint16_t off;
+    uint8_t len;
+    uint8_t tries;
+    bool acked;
+    bool lost;              /**< a later segment was acked first */
+} sp1_xp_seg_t;
+
+typedef struct
+{
+    uint16_t addr;          /**< short address of this device */
+    uint8_t window;         /**< segments in flight at most, 1 to SP1_XP_WINDOW */
+
+    /* sender */
+    uint16_t tx_dst;
+    uint16_t tx_len;        /**< message length, 0: idle */
+    uint16_t tx_off;        /**< bytes segmented so far */
+    uint8_t tx_msg;         /**< message number */
+    uint8_t snd_una;        /**< oldest sequence in flight */
+    uint8_t snd_nxt;        /**< next new sequence */
+    bool ack_turn;          /**< an ACK for another peer than tx_dst goes first */
+    sp1_xp_seg_t seg[SP1_XP_WINDOW];    /**< by sequence % SP1_XP_WINDOW */
+
+    /* receiver */
+    uint16_t rx_src;
+    uint16_t rx_total;
+    uint16_t rx_got;        /**< bytes of the message received */
+    uint16_t rx_msg;        /**< message number, SP1_XP_NO_MSG before the first */
+    uint8_t rcv_nxt;        /**< next sequence expected */
+    uint16_t rcv_sack;      /**< bit i: rcv_nxt + 1 + i received */
+    bool rx_active;         /**< a message is reassembled */
+    bool ack_pending;
+
+    sp1_xport_rx_cb_t rx_cb;
+    void *rx_arg;
+    sp1_xport_stats_t st;
+
+    uint16_t tx_max;        /**< bytes of a message sent, at most */
+    uint16_t rx_max;        /**< and received */
+    uint8_t *rx_buf;        /**< buf + tx_max */
+    uint8_t buf[];          /**< message sent, then the one received */
+} sp1_xport_t;
+
+#define SP1_XP_NO_MSG       0x100
+
+/* bytes of a transport of messages of tx_max bytes sent, rx_max received */
+#define SP1_XPORT_SIZE(tx_max, rx_max)  (sizeof(sp1_xport_t) + (tx_max) + (rx_max))
+
+/**
+ * @brief empty transport of the device of short address addr
+ *
+ * @param x         SP1_XPORT_SIZE(tx_max, rx_max) bytes
+ * @param tx_max    bytes of a message sent, SP1_XP_MSG_MAX at most
+ * @param rx_max    bytes of a message received, SP1_XP_MSG_MAX at most
+ */
+void sp1_xport_init(sp1_xport_t *x, uint16_t addr, uint16_t tx_max, uint16_t rx_max,
+                    sp1_xport_rx_cb_t cb, void *arg);
+
+/**
+ * @brief the peer restarted its session: drop the reassembly and the ACK,
+ *        send the message in flight again from its start
+ */
+void sp1_xport_reset(sp1_xport_t *x);
+
+/**
+ * @brief queue a message for dst, copied
+ *
+ * @return 0, SP1_XP_E_BUSY or SP1_XP_E_SIZE, longer than tx_max
+ */
+int sp1_xport_send(sp1_xport_t *x, uint16_t dst, const uint8_t *msg, uint16_t len);
+
+/**
+ * @brief a message is in flight
+ */
+bool sp1_xport_tx_busy(const sp1_xport_t *x);
+
+/**
+ * @brief sp1_xport_build() has something to send, a segment or an ACK
+ */
+bool sp1_xport_pending(const sp1_xport_t *x);
+
+/**
+ * @brief frame of block, at most max bytes
+ *
+ * @return frame length, 0 if nothing fits or nothing is to be sent
+ */
+int sp1_xport_build(sp1_xport_t *x, uint32_t block, uint8_t *frame, int max);
+
+/**
+ * @brief frame of peer src
+ *
+ * @return 0, SP1_XP_E_FRAME or SP1_XP_E_DST
+ */
+int sp1_xport_rx(sp1_xport_t *x, uint16_t src, const uint8_t *frame, int len);
+
+/* SP1XBENCH result of a run */
+typedef struct
+{
+    uint32_t ab_bytes;      /**< bytes delivered from A to B */
+    uint32_t ba_bytes;      /**< and from B to A */
+    uint32_t ab_segs;       /**< segments A sent */
+    uint32_t ab_retx;       /**< retransmissions of A */
+    uint32_t ab_fail;       /**< messages A dropped */
+    uint32_t corrupt;       /**< messages delivered with a wrong content, both ways */
+} sp1_xport_bench_t;
+
+/**
+ * @brief A sends 4096-byte blobs to B, B 512-byte logs to A over a link
+ *        losing loss_pct percent of the frames each way, one frame per
+ *        block each way, frames of max bytes
+ *
+ * @return 0, -1 if out of memory
+ */
+int sp1_xport_bench(uint32_t blocks, int loss_pct, int window, int max, sp1_xport_bench_t *res);
+
+#endif /* SP1_XPORT_H */
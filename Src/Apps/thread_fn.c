@@ -50,15 +50,98 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 
 #include "cmsis_os.h"
+#include "timers.h"
 #include "reporter.h"
 #include "thread_fn.h"
+#include "cpu_prof.h"
+#include "HAL_timer.h"
+#include "rtls_version.h"
 
 const char THREAD_FN_RET_OK[] = "ok\r\n";
 const char THREAD_FN_RET_KO[] = "KO\r\n";
 
+/* CPU profile of the tasks, sampled by the timer task */
+static cpu_prof_t cpu_prof;
+static TaskStatus_t prof_status[CPU_PROF_TASKS_MAX];
+
+/* @brief cpu_prof source: the FreeRTOS run-time statistics, the switches
+ *        counted in the task numbers, see FreeRTOSConfig.h
+ * */
+static int prof_sample(void *arg, cpu_prof_task_t *t, int max, uint32_t *now)
+{
+    UBaseType_t n;
+
+    (void)arg;
+    n = uxTaskGetSystemState(prof_status, (UBaseType_t)max, now);
+    if (n == 0)
+    {
+        /* more tasks than CPU_PROF_TASKS_MAX */
+        return -1;
+    }
+    for (UBaseType_t i = 0; i < n; i++)
+    {
+        t[i].id = prof_status[i].xTaskNumber;
+        t[i].run = prof_status[i].ulRunTimeCounter;
+        t[i].switches = uxTaskGetTaskNumber(prof_status[i].xHandle);
+        t[i].stack_free = prof_status[i].usStackHighWaterMark * sizeof(StackType_t);
+        strncpy(t[i].name, prof_status[i].pcTaskName, CPU_PROF_NAME_LEN - 1);
+        t[i].name[CPU_PROF_NAME_LEN - 1] = 0;
+    }
+    return (int)n;
+}
+
+static void prof_timer_cb(TimerHandle_t tmr)
+{
+    (void)tmr;
+    vTaskSuspendAll();
+    cpu_prof_sample(&cpu_prof);
+    (void)xTaskResumeAll();
+}
+
+/* @brief the use of the tasks, copied with the scheduler suspended
+ * */
+static int prof_get(cpu_prof_usage_t *u, uint32_t span_us[CPU_PROF_WINDOWS])
+{
+    int n;
+
+    vTaskSuspendAll();
+    n = cpu_prof_get(&cpu_prof, u, CPU_PROF_TASKS_MAX, span_us);
+    (void)xTaskResumeAll();
+    return n;
+}
+
+static const cpu_prof_usage_t *prof_find(const cpu_prof_usage_t *u, int n, uint32_t id)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (u[i].task.id == id)
+        {
+            return &u[i];
+        }
+    }
+    return NULL;
+}
+
+void thread_prof_init(void)
+{
+    cpu_prof_src_t src = {
+        .sample = prof_sample,
+        .arg = NULL,
+        .freq = hal_rt_counter.freq};
+    TimerHandle_t tmr;
+
+    cpu_prof_init(&cpu_prof, &src);
+    tmr = xTimerCreate("CpuProf", pdMS_TO_TICKS(CPU_PROF_PERIOD_MS), pdTRUE, NULL, prof_timer_cb);
+    if (tmr)
+    {
+        xTimerStart(tmr, 0);
+    }
+}
+
 /**
  * @brief show current threads and stack depth
  *
@@ -67,9 +150,12 @@ const char *thread_fn(void)
 {
     const char *ret = THREAD_FN_RET_OK;
 
-    char *pcWriteBuffer = malloc(1024);
+    char *pcWriteBuffer = malloc(1536);
+    cpu_prof_usage_t *usage = malloc(CPU_PROF_TASKS_MAX * sizeof(cpu_prof_usage_t));
+    uint32_t span_us[CPU_PROF_WINDOWS];
+    int n_usage = 0;
 
-    if (pcWriteBuffer)
+    if (pcWriteBuffer && usage)
     {
         TaskStatus_t *pxTaskStatusArray;
         volatile UBaseType_t uxArraySize, x;
@@ -91,18 +177,30 @@ const char *thread_fn(void)
         {
             /* Generate raw status information about each task. */
             uxArraySize = uxTaskGetSystemState(pxTaskStatusArray, uxArraySize, (uint32_t *const)&ulTotalRunTime);
+            n_usage = prof_get(usage, span_us);
 
             /* For each populated position in the pxTaskStatusArray array,
             format the raw data as human readable ASCII data. */
-            sz += sprintf(&pcWriteBuffer[sz], "%-16s\t%s\r\n", "THREAD NAME", "Stack usage");
+            sz += sprintf(&pcWriteBuffer[sz], "%-16s\t%s\t%s\t%s\t%s\r\n", "THREAD NAME", "Stack usage",
+                          "CPU 1s", "CPU 10s", "Switches/s");
             for (x = 0; x < uxArraySize; x++)
             {
                 uint32_t *p = pxTaskStatusArray[x].pxStackBase;
                 uint32_t total = (p[-1] & 0xFFFFUL) - 8;
-                sz += sprintf(&pcWriteBuffer[sz], "%-16s\t%" PRIu32 "/%" PRIu32 "\r\n",
+                const cpu_prof_usage_t *u = prof_find(usage, n_usage, pxTaskStatusArray[x].xTaskNumber);
+                uint32_t s10 = span_us[1] / 1000 ? span_us[1] / 1000 : 1;
+
+                sz += sprintf(&pcWriteBuffer[sz], "%-16s\t%" PRIu32 "/%" PRIu32,
                               pxTaskStatusArray[x].pcTaskName,
                               total - pxTaskStatusArray[x].usStackHighWaterMark * 4,
                               total);
+                if (u)
+                {
+                    sz += sprintf(&pcWriteBuffer[sz], "\t%" PRIu32 ".%02" PRIu32 "%%\t%" PRIu32 ".%02" PRIu32 "%%\t%" PRIu32,
+                                  u->pct[0] / 100, u->pct[0] % 100, u->pct[1] / 100, u->pct[1] % 100,
+                                  (uint32_t)((uint64_t)u->switches[1] * 1000 / s10));
+                }
+                sz += sprintf(&pcWriteBuffer[sz], "\r\n");
             }
             /* The array is no longer needed, free the memory it consumes. */
             vPortFree(pxTaskStatusArray);
@@ -117,10 +215,60 @@ const char *thread_fn(void)
         }
 
         reporter_instance.print((char *)pcWriteBuffer, sz);
-
-        free(pcWriteBuffer);
     }
 
+    free(usage);
+    free(pcWriteBuffer);
     ret = THREAD_FN_RET_OK;
     return (ret);
+}
+
+/**
+ * @brief CPU profile of the tasks, one JSON line:
+ *        {"CPU":{"Build":"<version>","Ms":[<1 s window>,<10 s window>],
+ *         "Tasks":[{"Name":"<task>","Pct":[<1 s>,<10 s>],"Sw":[<1 s>,<10 s>],"Free":<stack bytes>},...],
+ *         "Heap":[<used>,<max used>,<total>]}}
+ *        Pct in 1/100 %, Sw the context switches of the window
+ * */
+const char *thread_cpu_fn(void)
+{
+    const char build[] = FULL_VERSION;
+    const int size = 128 + CPU_PROF_TASKS_MAX * 96;
+    char *str = malloc(size);
+    cpu_prof_usage_t *u = malloc(CPU_PROF_TASKS_MAX * sizeof(cpu_prof_usage_t));
+    uint32_t span_us[CPU_PROF_WINDOWS];
+    int n, sz;
+
+    if (!str || !u)
+    {
+        free(u);
+        free(str);
+        return (THREAD_FN_RET_KO);
+    }
+
+    n = prof_get(u, span_us);
+    sz = snprintf(str, size, "{\"CPU\":{\"Build\":\"%s\",\"Ms\":[%" PRIu32 ",%" PRIu32 "],\"Tasks\":[",
+                  build, span_us[0] / 1000, span_us[1] / 1000);
+    for (int i = 0; i < n && sz < size; i++)
+    {
+        sz += snprintf(&str[sz], size - sz,
+                       "%s{\"Name\":\"%s\",\"Pct\":[%" PRIu32 ",%" PRIu32 "],\"Sw\":[%" PRIu32 ",%" PRIu32 "],\"Free\":%" PRIu32 "}",
+                       i ? "," : "", u[i].task.name, u[i].pct[0], u[i].pct[1],
+                       u[i].switches[0], u[i].switches[1], u[i].task.stack_free);
+    }
+    if (sz < size)
+    {
+        sz += snprintf(&str[sz], size - sz, "],\"Heap\":[%d,%d,%d]}}\r\n",
+                       (int)(configTOTAL_HEAP_SIZE - xPortGetFreeHeapSize()),
+                       (int)(configTOTAL_HEAP_SIZE - xPortGetMinimumEverFreeHeapSize()),
+                       (int)configTOTAL_HEAP_SIZE);
+    }
+    if (sz < size)
+    {
+        reporter_instance.print(str, sz);
+    }
+
+    free(u);
+    free(str);
+    return (sz < size) ? (THREAD_FN_RET_OK) : (THREAD_FN_RET_KO);
 }
\ No newline at end of file
@@ -48,4 +48,10 @@
  * 
  */
 
-const char *thread_fn(void);
\ No newline at end of file
+const char *thread_fn(void);
+
+/* @brief CPU profile of the tasks as a JSON line, see cpu_prof.h */
+const char *thread_cpu_fn(void);
+
+/* @brief sample the CPU profile from now on, before the scheduler starts */
+void thread_prof_init(void);
\ No newline at end of file
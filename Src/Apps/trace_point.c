@@ -0,0 +1,86 @@
+/**
+ * @file    trace_point.c
+ *
+ * @brief   Timestamped trace points of the button to servo path
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdio.h>
+
+#include "trace_point.h"
+#include "reporter.h"
+
+_Static_assert((TRACE_RING_LEN & (TRACE_RING_LEN - 1)) == 0, "power of 2");
+
+#define TRACE_TS_MASK   0x00FFFFFFUL    /**< Rtc counter width */
+
+typedef struct
+{
+    uint32_t ts_id;     /**< Rtc ticks [23:0], trace ID [31:24], 0: never written */
+    uint16_t corr;
+    uint16_t arg;
+} trace_rec_t;
+
+static const char *const trace_names[TRACE_ID_COUNT] = {
+    [TRACE_BLOCK] = "BLOCK",
+    [TRACE_BTN_EDGE] = "BTN_EDGE",
+    [TRACE_BTN_CONFIRM] = "BTN_CONFIRM",
+    [TRACE_BTN_TASK] = "BTN_TASK",
+    [TRACE_SP1_ENQUEUE] = "SP1_ENQUEUE",
+    [TRACE_SP1_RX] = "SP1_RX",
+    [TRACE_RESP_SIGNAL] = "RESP_SIGNAL",
+    [TRACE_RESP_WORKER] = "RESP_WORKER",
+    [TRACE_SERVO_SET] = "SERVO_SET",
+};
+
+static trace_rec_t trace_ring[TRACE_RING_LEN];
+static uint32_t trace_head;
+
+void trace_point_at(trace_id_e id, uint16_t corr, uint16_t arg, uint32_t ts)
+{
+    uint32_t i = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED) & (TRACE_RING_LEN - 1);
+    trace_rec_t *rec = &trace_ring[i];
+
+    rec->corr = corr;
+    rec->arg = arg;
+    /* id + 1: an empty slot reads 0 */
+    __atomic_store_n(&rec->ts_id, (ts & TRACE_TS_MASK) | ((uint32_t)(id + 1) << 24), __ATOMIC_RELEASE);
+}
+
+void trace_dump(bool clear)
+{
+    uint32_t head = __atomic_load_n(&trace_head, __ATOMIC_ACQUIRE);
+    uint32_t n = (head < TRACE_RING_LEN) ? head : TRACE_RING_LEN;
+    char str[64];
+    int len;
+
+    len = snprintf(str, sizeof(str), "TRACE: %lu records, 32768 Hz\r\n", (unsigned long)n);
+    reporter_instance.print(str, len);
+
+    for (uint32_t k = head - n; k != head; k++)
+    {
+        trace_rec_t rec = trace_ring[k & (TRACE_RING_LEN - 1)];
+        uint32_t id = (rec.ts_id >> 24) - 1;
+
+        if (id >= TRACE_ID_COUNT)
+        {
+            continue;
+        }
+        len = snprintf(str, sizeof(str), "TR %lu %s %u %u\r\n",
+                       (unsigned long)(rec.ts_id & TRACE_TS_MASK), trace_names[id],
+                       (unsigned)rec.corr, (unsigned)rec.arg);
+        reporter_instance.print(str, len);
+    }
+
+    if (clear)
+    {
+        /* records written while printing are dropped too */
+        __atomic_store_n(&trace_head, 0, __ATOMIC_RELAXED);
+        for (uint32_t k = 0; k < TRACE_RING_LEN; k++)
+        {
+            trace_ring[k].ts_id = 0;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * @file    trace_point.h
+ *
+ * @brief   Timestamped trace points of the button to servo path
+ *
+ *          TRACE_POINT(id, corr, arg) stores the Rtc timestamp (32768 Hz,
+ *          24 bits), the trace ID, a correlation ID and a 16-bit argument in
+ *          a ring of TRACE_RING_LEN records: one atomic add and two stores,
+ *          lock free and usable from an ISR. The ring keeps the latest
+ *          records, the TRACE command prints them.
+ *
+ *          The correlation ID of a button press is carried in its SP1
+ *          payload, so the dumps of the initiator and of the responder can be
+ *          joined. Both boards also trace the report of every ranging block,
+ *          which tools/trace_merge.py uses to align their clocks.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef TRACE_POINT_H
+#define TRACE_POINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "HAL_rtc.h"
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE    1
+#endif
+
+#ifndef TRACE_RING_LEN
+#define TRACE_RING_LEN  256 /**< records, power of 2 */
+#endif
+
+/* The names printed by trace_dump() are the ones tools/trace_merge.py knows */
+typedef enum {
+    TRACE_BLOCK = 0,        /**< both: report of a block, arg = block index */
+    TRACE_BTN_EDGE,         /**< initiator: first edge of the press */
+    TRACE_BTN_CONFIRM,      /**< initiator: press debounced */
+    TRACE_BTN_TASK,         /**< initiator: button_send_task woken */
+    TRACE_SP1_ENQUEUE,      /**< initiator: press queued for the SP1 frame of the next block */
+    TRACE_SP1_RX,           /**< responder: payload decrypted in report_cb */
+    TRACE_RESP_SIGNAL,      /**< responder: servo action queued */
+    TRACE_RESP_WORKER,      /**< responder: worker task took the action */
+    TRACE_SERVO_SET,        /**< responder: HAL_servo_set_position() done */
+    TRACE_ID_COUNT
+} trace_id_e;
+
+#if TRACE_ENABLE
+#define TRACE_POINT(id, corr, arg)          trace_point_at((id), (corr), (arg), Rtc.getTimestamp())
+#define TRACE_POINT_AT(id, corr, arg, ts)   trace_point_at((id), (corr), (arg), (ts))
+#else
+#define TRACE_POINT(id, corr, arg)          do { } while (0)
+#define TRACE_POINT_AT(id, corr, arg, ts)   do { } while (0)
+#endif
+
+/**
+ * @brief record a trace point with the Rtc timestamp ts
+ */
+void trace_point_at(trace_id_e id, uint16_t corr, uint16_t arg, uint32_t ts);
+
+/**
+ * @brief print the records of the ring, oldest first, and optionally empty it
+ */
+void trace_dump(bool clear);
+
+#endif /* TRACE_POINT_H */
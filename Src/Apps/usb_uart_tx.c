@@ -50,8 +50,7 @@
  */
 
 #include "usb_uart_tx.h"
-#include "circular_buffers.h"
-#include "HAL_lock.h"
+#include "log_arena.h"
 #include "HAL_uart.h"
 #ifdef USB_ENABLE
 #include "HAL_usb.h"
@@ -87,73 +86,58 @@
 
 static uint8_t ubuf[CDC_DATA_FS_MAX_PACKET_SIZE]; /**< linear buffer, to transmit next chunk of data */
 
+static uint8_t report_buf[USB_REPORT_BUFSIZE] __attribute__((aligned(4))); /**< Large USB/UART circular Tx buffer */
+
+/* The report buffer is a multi-producer arena (log_arena.h): any thread or ISR
+ * calling reporter_instance.print() appends without a lock, the flush thread
+ * is the only consumer.
+ */
 static struct _txHandle
 {
-    dw_hal_lockTypeDef lock; /**< locking object  */
-    struct
-    {
-        uint16_t head;
-        uint16_t tail;
-        uint8_t buf[USB_REPORT_BUFSIZE]; /**< Large USB/UART circular Tx buffer */
-    } Report;                            /**< circular report buffer, data to transmit */
+    log_arena_t Report; /**< circular report buffer, data to transmit */
 }
 
 txHandle = {
-    .lock = DW_HAL_NODE_UNLOCKED,
-    .Report.head = 0,
-    .Report.tail = 0
+    .Report = {
+        .head = 0,
+        .tail = 0,
+        .size = USB_REPORT_BUFSIZE,
+        .rd_off = 0,
+        .buf = report_buf
+    }
 };
 
 
 //-----------------------------------------------------------------------------
 // Implementation
 
+/* @fn        reset_report_buf()
+ * @brief     drop all pending output, from any task: the flush thread
+ *             drops it before its next read
+ * */
 int reset_report_buf(void)
 {
-    QHAL_LOCK(&txHandle);
-    txHandle.Report.head = txHandle.Report.tail = 0;
-    QHAL_UNLOCK(&txHandle);
+    log_arena_discard(&txHandle.Report);
     return _NO_ERR;
 }
 
 /* @fn         copy_tx_msg()
  * @brief     put message to circular report buffer
  *             it will be transmitted in background ASAP from flushing thread
- * @return    HAL_BUSY - can not do it now, wait for release
- *             HAL_ERROR- buffer overflow
- *             HAL_OK   - scheduled for transmission
+ * @return    _ERR_TxBuf_Overflow - buffer full, the message is dropped and counted
+ *             _NO_ERR  - scheduled for transmission
  * */
 error_e copy_tx_msg(uint8_t *str, int len)
 {
     error_e ret = _NO_ERR;
-    uint16_t head, tail;
-    const uint16_t size = sizeof(txHandle.Report.buf) / sizeof(txHandle.Report.buf[0]);
 
-    /* add TX msg to circular buffer and increase circular buffer length */
-
-    QHAL_LOCK(&txHandle); //"return HAL_BUSY;" if locked
-    head = txHandle.Report.head;
-    tail = txHandle.Report.tail;
-
-    if (CIRC_SPACE(head, tail, size) > len)
-    {
-        while (len > 0)
-        {
-            txHandle.Report.buf[head] = *(str++);
-            head = (head + 1) & (size - 1);
-            len--;
-        }
-
-        txHandle.Report.head = head;
-    }
-    else
+    if (!log_arena_write(&txHandle.Report, str, len))
     {
         /* if packet can not fit, setup TX Buffer overflow ERROR and exit */
         error_handler(0, _ERR_TxBuf_Overflow);
         ret = _ERR_TxBuf_Overflow;
     }
 
-    QHAL_UNLOCK(&txHandle);
     return ret;
 }
 
@@ -170,6 +154,36 @@ error_e port_tx_msg(uint8_t *str, int len)
     return (ret);
 }
 
+/* @fn        port_tx_reserve
+ * @brief     reserve a contiguous area of len bytes in the report buffer,
+ *             so a message can be formatted in place.
+ *             Must be followed by port_tx_commit(), other producers are
+ *             not held up meanwhile.
+ *
+ * @return    pointer to the area, NULL if the buffer is full: the message
+ *             is dropped, counted and reported here, as by copy_tx_msg()
+ * */
+uint8_t *port_tx_reserve(int len)
+{
+    uint8_t *p = log_arena_claim(&txHandle.Report, len);
+
+    if (!p)
+    {
+        error_handler(0, _ERR_TxBuf_Overflow);
+    }
+    return p;
+}
+
+/* @fn        port_tx_commit
+ * @brief     publish len bytes written to the area from port_tx_reserve(),
+ *             len may be less than reserved, 0 to cancel
+ * */
+void port_tx_commit(uint8_t *p, int len)
+{
+    log_arena_commit(&txHandle.Report, p, len);
+    NotifyFlushTask();
+}
+
 
 //-----------------------------------------------------------------------------
 //     USB/UART report : platform - dependent section
@@ -180,14 +194,17 @@ error_e port_tx_msg(uint8_t *str, int len)
  * @brief    FLUSH should have higher priority than reporter_instance.print()
  *             This shall be called periodically from process, which can not be locked,
  *             i.e. from independent high priority thread / timer etc.
+ *             The only consumer of the report buffer, it does not block producers.
  * */
 error_e flush_report_buf(void)
 {
-    int size = sizeof(txHandle.Report.buf) / sizeof(txHandle.Report.buf[0]);
     int chunk;
     error_e ret = _NO_ERR;
     uint32_t tmr;
 
+    /* a reset_report_buf() drops its output even with no terminal */
+    (void)log_arena_peek(&txHandle.Report, NULL, 0);
+
 #ifndef BT_UART_ENABLE
     if (!get_uartEn()
 #ifdef USB_ENABLE
@@ -197,20 +214,9 @@ error_e flush_report_buf(void)
         return _ERR_Usb_Tx;
 #endif
 
-    QHAL_LOCK(&txHandle); //"return HAL_BUSY;" if locked
-
-    int head = txHandle.Report.head;
-    int tail = txHandle.Report.tail;
-
-    int len = CIRC_CNT(head, tail, size);
-
-#ifdef USB_ENABLE
-    int old_tail = txHandle.Report.tail;
-#endif
-
     Timer.start(&tmr);
 
-    if (len > 0)
+    if (log_arena_peek(&txHandle.Report, ubuf, 1) > 0)
     {
         do
         {
@@ -235,20 +241,17 @@ error_e flush_report_buf(void)
 #endif
 
             /* copy MAX allowed length from circular buffer to linear buffer */
-            chunk = MIN(sizeof(ubuf), len);
+            chunk = (int)log_arena_peek(&txHandle.Report, ubuf, sizeof(ubuf));
 
-            for (int i = 0; i < chunk; i++)
+            if (chunk == 0)
             {
-                ubuf[i] = txHandle.Report.buf[tail];
-                tail = (tail + 1) & (size - 1);
+                break; /**< nothing more published */
             }
 
-            len -= chunk;
-
-            txHandle.Report.tail = tail;
-
             if (get_uartEn())
             {
+                log_arena_consume(&txHandle.Report, (uint32_t)chunk);
+
                 /* setup UART DMA transfer */
                 // if (HAL_UART_Transmit_DMA(&huart3, ubuf, chunk) != HAL_OK)
                 if (!deca_uart_transmit(ubuf, chunk))
@@ -265,21 +268,17 @@ error_e flush_report_buf(void)
                 if (!Usb.transmit(ubuf, chunk))
                 {
                     error_handler(0, _ERR_Usb_Tx); /**< indicate USB transmit error */
-                    txHandle.Report.tail = old_tail;
                     ret = _ERR_Usb_Tx;
-                }
-                else
-                {
-                    old_tail = tail;
+                    break; /**< keep the chunk in the buffer, retry on next flush */
                 }
 #endif
+                log_arena_consume(&txHandle.Report, (uint32_t)chunk);
 #ifdef BT_UART_ENABLE
                 bt_uart_transmit(ubuf, chunk);
 #endif
             }
-        } while (len > 0 && (AppGet()->app_mode & APP_BLOCK_FLUSH));
+        } while (AppGet()->app_mode & APP_BLOCK_FLUSH);
     }
-    QHAL_UNLOCK(&txHandle);
     return ret;
 }
 
@@ -61,6 +61,8 @@ extern "C" {
 error_e copy_tx_msg(uint8_t *str, int len);
 error_e flush_report_buf(void);
 error_e port_tx_msg(uint8_t *str, int len);
+uint8_t *port_tx_reserve(int len);
+void port_tx_commit(uint8_t *p, int len);
 int reset_report_buf(void);
 
 
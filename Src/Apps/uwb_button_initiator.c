@@ -57,9 +57,12 @@
 #include "fira_app_config.h"
 #include "fira_app.h"
 #include "reporter.h"
+#include "dlog.h"
+#include "trace_point.h"
 #include <FreeRTOS.h>
 #include <timers.h>
 #include <task.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -73,6 +76,8 @@ static uint8_t button_press_counter = 0;  /* Increments on each button press */
 static bool payload_sent_this_press = false;  /* Tracks if payload was sent for current press */
 static TaskHandle_t button_send_task_handle = NULL;  /* Task for sending button data */
 static volatile bool pending_button_press = false;  /* Flag set by ISR, cleared by task */
+static button_id_e pending_button_id = BUTTON_SW1;  /* Button of the pending press, for its latency */
+static uint16_t trace_corr = 0;  /* Correlation ID of the last press, carried in its SP1 payload */
 
 /**
  * @brief Timer callback to stop ranging after burst
@@ -81,8 +86,7 @@ static void ranging_burst_timeout(TimerHandle_t xTimer)
 {
     (void)xTimer;
     uwb_button_initiator_stop_ranging();
-    char str[] = "UWB: Burst complete\r\n";
-    reporter_instance.print(str, strlen(str));
+    DLOG_DBG(DLOG_MOD_BTN, "UWB: Burst complete\r\n");
 }
 
 /**
@@ -97,83 +101,32 @@ static void button_send_task(void *pvParameters)
         /* Wait for button press notification */
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
         
-        char task_log[] = "BTN_TASK: Processing button press\r\n";
-        reporter_instance.print(task_log, strlen(task_log));
-        
+        DLOG_DBG(DLOG_MOD_BTN, "BTN_TASK: Processing button press\r\n");
+        TRACE_POINT(TRACE_BTN_TASK, trace_corr, 0);
+
         /* Process pending button press */
         if (pending_button_press)
         {
             pending_button_press = false;
             
-            /* Always send SP1 payload on button press, regardless of RFRAME */
-
-
-            /* Create data parameters structure (libuwbstack signature) */
-            uint8_t payload_data[4] = {'B', 'T', 'N', button_press_counter};
-            char data_log[128];
-            snprintf(data_log, sizeof(data_log),
-                "BTN_TASK: Creating SP1 data_parameters: BTN=%u, session_id=%u, payload_len=%d\r\n",
-                button_press_counter, session_id, (int)sizeof(payload_data));
-            reporter_instance.print(data_log, strlen(data_log));
-
-            struct data_parameters data_params;
-            memset(&data_params, 0, sizeof(data_params));
-            memcpy(data_params.data_payload, payload_data, sizeof(payload_data));
-            data_params.data_payload_len = (int)sizeof(payload_data);
-
-            char send_log[128];
-            int slen = snprintf(send_log, sizeof(send_log),
-                "BTN_TASK: Sending BTN payload [B,T,N,%u] to session=%u\r\n",
-                button_press_counter, session_id);
-            reporter_instance.print(send_log, slen);
-
-            /* Encrypt payload with rolling code using current block number */
-
-            extern uint32_t fira_get_current_block_index(void);
-            uint32_t block_num = fira_get_current_block_index() + 1; // Use next block for sync
-            uint8_t key[16] = {0xA5, 0xC3, 0xF1, 0xB7, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C};
-            uint8_t nonce[13] = {0};
-            memcpy(nonce, &block_num, sizeof(block_num));
-            uint8_t mac[8] = {0};
-            void *ccm_ctx = mcps_crypto_aead_aes_ccm_star_128_create(key);
-            int enc_result = mcps_crypto_aead_aes_ccm_star_128_encrypt(
-                ccm_ctx,
-                nonce,
-                NULL, 0, // No header
-                data_params.data_payload,
-                sizeof(payload_data),
-                mac,
-                sizeof(mac)
-            );
-            char dbg[128];
-            int dbglen = snprintf(dbg, sizeof(dbg),
-                "[DEBUG][INIT] AES-CCM* encrypt block=%lu result=%d len=%d MAC=[%02X %02X %02X %02X %02X %02X %02X %02X]\r\n",
-                (unsigned long)block_num, enc_result, (int)sizeof(payload_data),
-                mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], mac[6], mac[7]);
-            reporter_instance.print(dbg, dbglen);
-            // Append MAC to payload
-            memcpy(data_params.data_payload + sizeof(payload_data), mac, sizeof(mac));
-            data_params.data_payload_len = sizeof(payload_data) + sizeof(mac);
-            mcps_crypto_aead_aes_ccm_star_128_destroy(ccm_ctx);
-
-            /* Send data via FiRa stack (task context) */
-            int ret = fira_helper_send_data(&fira_ctx, session_id, &data_params);
-            char result_log[128];
-            snprintf(result_log, sizeof(result_log),
-                "BTN_TASK: fira_helper_send_data returned %d, session_id=%u, payload=[%02X %02X %02X %02X] %s\r\n",
-                ret, session_id,
-                data_params.data_payload[0], data_params.data_payload[1],
-                data_params.data_payload[2], data_params.data_payload[3],
-                (ret == 0) ? "(SUCCESS)" : "(FAILED)");
-            reporter_instance.print(result_log, strlen(result_log));
-            // Deep debug: print full data_params after send
-            char debug_log[128];
-            snprintf(debug_log, sizeof(debug_log),
-                "[DEBUG] After send: data_payload_len=%d, data_payload=[%02X %02X %02X %02X] (first 4 bytes)\r\n",
-                data_params.data_payload_len,
-                data_params.data_payload[0], data_params.data_payload[1],
-                data_params.data_payload[2], data_params.data_payload[3]);
-            reporter_instance.print(debug_log, strlen(debug_log));
+            /* Queue the press for the SP1 frame of the next block: counter,
+             * then the correlation ID */
+            uint8_t btn[SP1_BTN_LEN];
+
+            sp1_btn_put(btn, button_press_counter, trace_corr);
+
+            DLOG_INFO(DLOG_MOD_BTN, "BTN_TASK: Queueing BTN=%u for session=%" PRIu32 "\r\n",
+                      button_press_counter, session_id);
+
+            int ret = fira_app_sp1_push(SP1_TLV_BTN, btn, sizeof(btn));
+            DLOG(DLOG_MOD_BTN, (ret == 0) ? DLOG_LVL_INFO : DLOG_LVL_ERR,
+                 "BTN_TASK: fira_app_sp1_push returned %d, BTN=%u %s\r\n",
+                 ret, button_press_counter, (ret == 0) ? "(SUCCESS)" : "(FAILED)");
+            if (ret == 0)
+            {
+                button_handler_mark_enqueue(pending_button_id);
+                TRACE_POINT(TRACE_SP1_ENQUEUE, trace_corr, button_press_counter);
+            }
         }
     }
 }
@@ -186,40 +139,36 @@ static void button_send_task(void *pvParameters)
  */
 static void button_event_callback(button_id_e button_id, bool is_pressed)
 {
-    char debug_str[64];
-    int len = snprintf(debug_str, sizeof(debug_str),
-        "BTN_CB[%d] %s\r\n", button_id, is_pressed ? "PRESS" : "RELEASE");
-    reporter_instance.print(debug_str, len);
-    
+    DLOG_DBG(DLOG_MOD_BTN, "BTN_CB[%d] %s\r\n", button_id, is_pressed ? "PRESS" : "RELEASE");
+
     if (is_pressed)
     {
         /* Increment button counter for new press */
         button_press_counter++;
+        trace_corr++;
+        TRACE_POINT_AT(TRACE_BTN_EDGE, trace_corr, button_id, button_handler_get_edge_time(button_id));
+        TRACE_POINT(TRACE_BTN_CONFIRM, trace_corr, button_id);
         payload_sent_this_press = false;
         
-        char btn_press_log[96];
-        int blen = snprintf(btn_press_log, sizeof(btn_press_log),
-            "BTN_ISR: Button %d pressed (counter=%u)\r\n", button_id, button_press_counter);
-        reporter_instance.print(btn_press_log, blen);
-        
+        DLOG_INFO(DLOG_MOD_BTN, "BTN_ISR: Button %d pressed (counter=%u)\r\n", button_id, button_press_counter);
+
         /* Set flag and notify task to send data (task context) */
+        pending_button_id = button_id;
         pending_button_press = true;
         if (button_send_task_handle != NULL)
         {
             /* Use non-ISR notify since we're in timer/task context */
             xTaskNotifyGive(button_send_task_handle);
-            
-            char notified_str[] = "BTN: Task notified\r\n";
-            reporter_instance.print(notified_str, strlen(notified_str));
+
+            DLOG_DBG(DLOG_MOD_BTN, "BTN: Task notified\r\n");
         }
     }
 }
 
 void uwb_button_initiator_init(void)
 {
-    char init_str[] = "INIT: Button Initiator starting\r\n";
-    reporter_instance.print(init_str, strlen(init_str));
-    
+    DLOG_INFO(DLOG_MOD_BTN, "INIT: Button Initiator starting\r\n");
+
     /* Create task to handle button data sending (must run in task context, not ISR) */
     BaseType_t task_result = xTaskCreate(
         button_send_task,
@@ -232,27 +181,23 @@ void uwb_button_initiator_init(void)
     
     if (task_result != pdPASS)
     {
-        char err_str[] = "INIT: ERROR - Failed to create button send task\r\n";
-        reporter_instance.print(err_str, strlen(err_str));
+        DLOG_ERR(DLOG_MOD_BTN, "INIT: ERROR - Failed to create button send task\r\n");
     }
     else
     {
-        char task_str[] = "INIT: Button send task created\r\n";
-        reporter_instance.print(task_str, strlen(task_str));
+        DLOG_DBG(DLOG_MOD_BTN, "INIT: Button send task created\r\n");
     }
     
     /* Initialize button handler */
     button_handler_init();
     
-    char btn_str[] = "INIT: Button handler initialized\r\n";
-    reporter_instance.print(btn_str, strlen(btn_str));
-    
+    DLOG_DBG(DLOG_MOD_BTN, "INIT: Button handler initialized\r\n");
+
     /* Register button callback */
     button_handler_register_callback(button_event_callback);
     
-    char cb_str[] = "INIT: Button callback registered\r\n";
-    reporter_instance.print(cb_str, strlen(cb_str));
-    
+    DLOG_DBG(DLOG_MOD_BTN, "INIT: Button callback registered\r\n");
+
     /* No servo on initiator: responder board handles servo movement */
     
     /* Create timer for ranging burst timeout (5000ms) */
@@ -266,16 +211,14 @@ void uwb_button_initiator_init(void)
     
     is_ranging = false;
     
-    char done_str[] = "INIT: Button Initiator ready\r\n";
-    reporter_instance.print(done_str, strlen(done_str));
+    DLOG_INFO(DLOG_MOD_BTN, "INIT: Button Initiator ready\r\n");
 }
 
 void uwb_button_initiator_start_ranging(void)
 {
     /* Ranging is always on for proper sync. Button triggers servo movement. */
-    char str[] = "UWB: Button pressed! Triggering servo on responder...\r\n";
-    reporter_instance.print(str, strlen(str));
-    
+    DLOG_DBG(DLOG_MOD_BTN, "UWB: Button pressed! Triggering servo on responder...\r\n");
+
     is_ranging = true;
     /* Initiator only sends BTN payload; responder moves its servo upon receipt */
     /* Do not call responder functions locally on initiator */
@@ -290,9 +233,8 @@ void uwb_button_initiator_stop_ranging(void)
 {
     if (is_ranging)
     {
-        char str[] = "UWB: Timer complete.\r\n";
-        reporter_instance.print(str, strlen(str));
-        
+        DLOG_DBG(DLOG_MOD_BTN, "UWB: Timer complete.\r\n");
+
         is_ranging = false;
     }
 }
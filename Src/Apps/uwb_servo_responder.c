@@ -55,12 +55,19 @@
 #include "nrf_gpio.h"
 #include "custom_board.h"
 #include "reporter.h"
+#include "dlog.h"
+#include "trace_point.h"
 #include <stdio.h>
 #include <string.h>
 #include <FreeRTOS.h>
 #include <timers.h>
 #include <task.h>
 #include <queue.h>
+#include <semphr.h>
+#include <stdlib.h>
+#include "nrf.h"
+#include "int_priority.h"
+#include "HAL_rtc.h"
 /* Add near the top with other includes */
 #include "fira_helper.h"
 #include "fira_app_config.h"
@@ -109,17 +116,63 @@ static void led_helper_all_off(void)
     }
 }
 
-static void led_helper_flash_all_blocking(uint32_t flashes, uint32_t ms)
+/* LED pattern engine: the LEDs are toggled from a timer, nothing waits on
+ * them. The pattern is only touched on the timer task, a restart included,
+ * so a toggle never runs against a restart of another task. */
+#define LED_FLASHES         3
+#define LED_FLASH_MS        100
+
+static TimerHandle_t led_pattern_timer = NULL;
+static uint32_t led_pattern_steps = 0;  /* toggles left, timer task only */
+
+static void led_pattern_timer_callback(TimerHandle_t xTimer)
 {
-    for (uint32_t i = 0; i < flashes; i++)
+    /* odd steps left: on, even: off, ends off */
+    if (led_pattern_steps == 0 || --led_pattern_steps == 0)
+    {
+        led_helper_all_off();
+        xTimerStop(xTimer, 0);
+        return;
+    }
+    if (led_pattern_steps & 1)
     {
         led_helper_all_on();
-        vTaskDelay(pdMS_TO_TICKS(ms));
+    }
+    else
+    {
+        led_helper_all_off();
+    }
+}
+
+/* @brief restart of the pattern, on the timer task
+ * */
+static void led_pattern_restart(void *unused, uint32_t flashes)
+{
+    (void)unused;
+
+    /* first "on" now, then one toggle per timer period */
+    led_pattern_steps = 2 * flashes - 1;
+    led_helper_all_on();
+    if (xTimerReset(led_pattern_timer, 0) != pdPASS)
+    {
+        /* timer queue full: no feedback rather than LEDs left on */
+        led_pattern_steps = 0;
         led_helper_all_off();
-        vTaskDelay(pdMS_TO_TICKS(ms));
     }
 }
 
+/* @brief flash all the LEDs, restarts a pattern in progress
+ * */
+static void led_pattern_start(uint32_t flashes)
+{
+    if (led_pattern_timer == NULL || flashes == 0)
+    {
+        return;
+    }
+    /* timer queue full: no feedback */
+    (void)xTimerPendFunctionCall(led_pattern_restart, NULL, flashes, 0);
+}
+
 /* Timer handle for returning servo to neutral position */
 static TimerHandle_t servo_return_timer = NULL;
 
@@ -128,46 +181,78 @@ static TimerHandle_t servo_return_timer = NULL;
 
 /* Toggle state for servo position */
 static bool servo_position_state = false;  /* false -> drive right first, true -> drive left first */
-static uint8_t last_button_counter = 0;  /* Track last processed button counter */
 
 /* Async processing of responder actions */
-static QueueHandle_t responder_event_queue = NULL; /* queue of uint8_t button counters */
+struct responder_cmd_s
+{
+    uint32_t t_rx;      /* Rtc ticks, payload handed over by report_cb */
+    uint16_t corr;      /* trace correlation ID */
+    uint8_t btn_counter;
+    bool bench;         /* RESPBENCH trigger: same path, the servo stays where it is */
+};
+
+static QueueHandle_t responder_event_queue = NULL; /* queue of struct responder_cmd_s */
 static TaskHandle_t responder_worker_task_handle = NULL;
 
+/* RESPBENCH: worker to benchmark handshake */
+static SemaphoreHandle_t bench_done = NULL;
+static volatile uint32_t bench_cyc_servo;
+static volatile uint16_t bench_corr;    /* trigger of bench_cyc_servo */
+
+static void cycle_counter_enable(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
 static void responder_worker_task(void *pvParameters)
 {
     (void)pvParameters;
-    uint8_t btn_counter;
+    struct responder_cmd_s cmd;
     for (;;)
     {
-        if (xQueueReceive(responder_event_queue, &btn_counter, portMAX_DELAY) == pdTRUE)
+        if (xQueueReceive(responder_event_queue, &cmd, portMAX_DELAY) != pdTRUE)
         {
-            /* Debug output */
-            char debug_str[128];
-            snprintf(debug_str, sizeof(debug_str),
-                "RESP: Worker handling button (counter=%u) at tick=%lu\r\n",
-                btn_counter, (unsigned long)xTaskGetTickCount());
-            reporter_instance.print(debug_str, strlen(debug_str));
-
-            /* Flash LEDs non-blocking (uses vTaskDelay) */
-            led_helper_flash_all_blocking(3, 100);
-
-            if (HAL_servo_is_ready())
-            {
-                /* Toggle between full left and full right */
-                uint16_t target_us = servo_position_state ? SERVO_POS_MIN : SERVO_POS_MAX;
-                HAL_servo_set_position(target_us);
-
-                char pos_str[64];
-                int len = snprintf(pos_str, sizeof(pos_str),
-                    "SERVO: Moving to %s (%u us)\r\n",
-                    servo_position_state ? "LEFT" : "RIGHT", (unsigned)target_us);
-                reporter_instance.print(pos_str, len);
-
-                /* Flip state so the next signal moves in the opposite direction */
-                servo_position_state = !servo_position_state;
-                /* Do not start or stop any timer; servo stays at target position */
-            }
+            continue;
+        }
+
+        uint32_t age = Rtc.getTimeElapsed(cmd.t_rx, Rtc.getTimestamp());
+
+        /* 1. actuate */
+        if (cmd.bench)
+        {
+            HAL_servo_set_position(HAL_servo_get_position());
+            bench_cyc_servo = DWT->CYCCNT;
+            bench_corr = cmd.corr;
+            xSemaphoreGive(bench_done);
+            continue;
+        }
+
+        TRACE_POINT(TRACE_RESP_WORKER, cmd.corr, cmd.btn_counter);
+
+        uint16_t target_us = servo_position_state ? SERVO_POS_MIN : SERVO_POS_MAX;
+        bool ready = HAL_servo_is_ready();
+        if (ready)
+        {
+            /* Toggle between full left and full right */
+            HAL_servo_set_position(target_us);
+            TRACE_POINT(TRACE_SERVO_SET, cmd.corr, target_us);
+
+            /* Flip state so the next signal moves in the opposite direction */
+            servo_position_state = !servo_position_state;
+            /* Do not start or stop any timer; servo stays at target position */
+        }
+
+        /* 2. feedback, runs on its own */
+        led_pattern_start(LED_FLASHES);
+
+        /* 3. log */
+        DLOG_INFO(DLOG_MOD_RESP, "RESP: signal_received BTN=%u, latency %lu us\r\n",
+                  cmd.btn_counter, (unsigned long)RTC_TICKS_TO_US(age));
+        if (ready)
+        {
+            DLOG_INFO(DLOG_MOD_RESP, "SERVO: Moving to %s (%u us)\r\n",
+                      (target_us == SERVO_POS_MIN) ? "LEFT" : "RIGHT", (unsigned)target_us);
         }
     }
 }
@@ -199,9 +284,21 @@ void uwb_servo_responder_init(void)
         NULL,
         servo_return_timer_callback
     );
+
+    /* LED feedback pattern, one toggle per period */
+    led_pattern_timer = xTimerCreate(
+        "RespLed",
+        pdMS_TO_TICKS(LED_FLASH_MS),
+        pdTRUE,
+        NULL,
+        led_pattern_timer_callback
+    );
+
+    bench_done = xSemaphoreCreateBinary();
     
-    /* Create responder worker queue & task */
-    responder_event_queue = xQueueCreate(8, sizeof(uint8_t));
+    /* Create responder worker queue & task, above the application tasks so
+     * that it acts as soon as the report task lets go */
+    responder_event_queue = xQueueCreate(8, sizeof(struct responder_cmd_s));
     if (responder_event_queue != NULL)
     {
         BaseType_t tr = xTaskCreate(
@@ -209,52 +306,114 @@ void uwb_servo_responder_init(void)
             "RespWorker",
             768,
             NULL,
-            2,
+            tskIDLE_PRIORITY + (PRIO_RespWorkerTask - osPriorityIdle),
             &responder_worker_task_handle);
         if (tr != pdPASS)
         {
-            char err_str[] = "RESP: ERROR - Worker task create failed\r\n";
-            reporter_instance.print(err_str, strlen(err_str));
+            DLOG_ERR(DLOG_MOD_RESP, "RESP: ERROR - Worker task create failed\r\n");
         }
     }
     
     /* Servo responder initialized */
-    char init_str[] = "RESP: Servo responder initialized\r\n";
-    reporter_instance.print(init_str, strlen(init_str));
+    DLOG_INFO(DLOG_MOD_RESP, "RESP: Servo responder initialized\r\n");
 
     // NOTE: The notification callback must be registered in fira_helper_open() elsewhere in your startup code:
     // fira_helper_open(&fira_ctx, ..., responder_notification_callback, ...);
 }
 
-void uwb_servo_responder_signal_received(uint8_t button_counter)
+void uwb_servo_responder_signal_received(peer_t *peer, uint8_t button_counter, uint16_t corr)
 {
-    /* Deduplicate within responder to avoid repeated triggers for same counter */
-    if (button_counter == last_button_counter)
+    /* Runs in report_cb: no logging here, the worker logs after acting */
+    struct responder_cmd_s cmd = {
+        .t_rx = Rtc.getTimestamp(),
+        .corr = corr,
+        .btn_counter = button_counter,
+        .bench = false,
+    };
+
+    /* Deduplicate per initiator to avoid repeated triggers for same counter */
+    if (((peer->flags & PEER_F_BTN) && button_counter == peer->btn_counter) || responder_event_queue == NULL)
     {
-        char dedup_log[96];
-        snprintf(dedup_log, sizeof(dedup_log),
-            "RESP: signal_received dedup BTN=%u (last=%u)\r\n",
-            button_counter, last_button_counter);
-        reporter_instance.print(dedup_log, strlen(dedup_log));
         return;
     }
-    char recv_log[128];
-    snprintf(recv_log, sizeof(recv_log),
-        "RESP: signal_received BTN=%u, last=%u, tick=%lu\r\n",
-        button_counter, last_button_counter, (unsigned long)xTaskGetTickCount());
-    reporter_instance.print(recv_log, strlen(recv_log));
-    last_button_counter = button_counter;
-
-    /* Enqueue for worker task; keep callback light to avoid stalling FiRa processing */
-    if (responder_event_queue != NULL)
+    peer->btn_counter = button_counter;
+    peer->flags |= PEER_F_BTN;
+
+    TRACE_POINT(TRACE_RESP_SIGNAL, corr, button_counter);
+    if (xQueueSend(responder_event_queue, &cmd, 0) != pdPASS)
+    {
+        DLOG_WARN(DLOG_MOD_RESP, "RESP: queue full, BTN=%u lost\r\n", button_counter);
+    }
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+int uwb_servo_responder_bench(uint32_t n, uint32_t *p50_us, uint32_t *p99_us, uint32_t *max_us)
+{
+    struct responder_cmd_s cmd = { .bench = true };
+    UBaseType_t prio = uxTaskPriorityGet(NULL);
+    uint32_t cyc_per_us = SystemCoreClock / 1000000UL;
+    uint32_t *lat;
+    uint32_t done = 0;
+
+    if (n == 0 || responder_event_queue == NULL || bench_done == NULL)
     {
-        uint8_t bc = button_counter;
-        BaseType_t qret = xQueueSend(responder_event_queue, &bc, 0);
-        char qlog[96];
-        snprintf(qlog, sizeof(qlog),
-            "RESP: signal_received queue send ret=%ld\r\n", (long)qret);
-        reporter_instance.print(qlog, strlen(qlog));
+        return -1;
     }
+    lat = pvPortMalloc(n * sizeof(uint32_t));
+    if (lat == NULL)
+    {
+        return -1;
+    }
+
+    cycle_counter_enable();
+
+    /* post from the report task priority: the worker cannot preempt the
+     * poster, it runs when the poster blocks as report_cb returns */
+    vTaskPrioritySet(NULL, tskIDLE_PRIORITY + (PRIO_ReportTask - osPriorityIdle));
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t t0;
+        BaseType_t got;
+
+        /* the give of a trigger that timed out is not this one's */
+        xSemaphoreTake(bench_done, 0);
+
+        cmd.corr = (uint16_t)i;
+        t0 = DWT->CYCCNT;
+        cmd.t_rx = Rtc.getTimestamp();
+        if (xQueueSend(responder_event_queue, &cmd, 0) != pdPASS)
+        {
+            continue;
+        }
+        do
+        {
+            got = xSemaphoreTake(bench_done, pdMS_TO_TICKS(100));
+        } while (got == pdTRUE && bench_corr != cmd.corr);
+        if (got != pdTRUE)
+        {
+            continue;
+        }
+        lat[done++] = bench_cyc_servo - t0;
+    }
+
+    vTaskPrioritySet(NULL, prio);
+
+    if (done)
+    {
+        qsort(lat, done, sizeof(uint32_t), cmp_u32);
+        *p50_us = lat[(done - 1) / 2] / cyc_per_us;
+        *p99_us = lat[(done - 1) * 99 / 100] / cyc_per_us;
+        *max_us = lat[done - 1] / cyc_per_us;
+    }
+    vPortFree(lat);
+
+    return (int)done;
 }
 
 void uwb_servo_responder_move_servo(uint16_t position_us)
@@ -14,6 +14,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "peer_table.h"
 
 /**
  * @fn void uwb_servo_responder_init(void)
@@ -27,15 +28,33 @@
 void uwb_servo_responder_init(void);
 
 /**
- * @fn void uwb_servo_responder_signal_received(void)
+ * @fn void uwb_servo_responder_signal_received(peer_t *peer, uint8_t button_counter, uint16_t corr)
  *
  * @brief Called when UWB signal is received from initiator
  *
- * Triggers servo movement to indicate reception
+ * Queues a timestamped servo command, the worker task moves the servo
+ * first and then starts the LED feedback. Called from report_cb: it only
+ * stamps and queues, it does not log.
  *
+ * @param peer Initiator of the press, its record keeps the last counter
+ * @param button_counter Press counter of the initiator, repeats are ignored
+ * @param corr Trace correlation ID of the press
  * @return void
  */
-void uwb_servo_responder_signal_received(uint8_t button_counter);
+void uwb_servo_responder_signal_received(peer_t *peer, uint8_t button_counter, uint16_t corr);
+
+/**
+ * @fn int uwb_servo_responder_bench(uint32_t n, uint32_t *p50_us, uint32_t *p99_us, uint32_t *max_us)
+ *
+ * @brief Latency from report_cb to the servo command, RESPBENCH command
+ *
+ * Posts n simulated triggers from the priority of the report task, each
+ * one through the worker queue to HAL_servo_set_position() at the current
+ * position, and measures them with the CPU cycle counter.
+ *
+ * @return number of triggers measured, -1 if the responder is not running
+ */
+int uwb_servo_responder_bench(uint32_t n, uint32_t *p50_us, uint32_t *p99_us, uint32_t *max_us);
 
 /**
  * @fn void uwb_servo_responder_move_servo(uint16_t position_us)
@@ -9,6 +9,7 @@
 
 #include "uwb_signal_monitor.h"
 #include "reporter.h"
+#include "dlog.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -36,8 +37,7 @@ void uwb_signal_monitor_init(void)
     memset(&rx_stats, 0, sizeof(signal_stats_t));
     monitor_initialized = true;
     
-    char msg[] = "UWB_SIGNAL_MONITOR: Initialized\r\n";
-    reporter_instance.print(msg, strlen(msg));
+    DLOG_INFO(DLOG_MOD_MON, "UWB_SIGNAL_MONITOR: Initialized\r\n");
 }
 
 void uwb_signal_monitor_event(bool is_controller, uint16_t remote_addr,
@@ -46,7 +46,6 @@ void uwb_signal_monitor_event(bool is_controller, uint16_t remote_addr,
     if (!monitor_initialized)
         return;
 
-    char event_str[96];
     const char *role = is_controller ? "INIT" : "RESP";
     const char *dir_str = "???";
     
@@ -95,11 +94,9 @@ void uwb_signal_monitor_event(bool is_controller, uint16_t remote_addr,
             stats->payload_packets++;
             break;
     }
-    
-    int len = snprintf(event_str, sizeof(event_str),
-                      "UWB_MON: %s [%s] 0x%04x data=0x%08lx\r\n",
-                      role, dir_str, remote_addr, optional_data);
-    reporter_instance.print(event_str, len);
+
+    DLOG_DBG(DLOG_MOD_MON, "UWB_MON: %s [%s] 0x%04x data=0x%08lx\r\n",
+             role, dir_str, remote_addr, (unsigned long)optional_data);
 }
 
 void uwb_signal_monitor_print_status(bool is_controller)
@@ -128,6 +125,5 @@ void uwb_signal_monitor_reset(void)
 {
     memset(&tx_stats, 0, sizeof(signal_stats_t));
     memset(&rx_stats, 0, sizeof(signal_stats_t));
-    char msg[] = "UWB_SIGNAL_MONITOR: Stats reset\r\n";
-    reporter_instance.print(msg, strlen(msg));
+    DLOG_INFO(DLOG_MOD_MON, "UWB_SIGNAL_MONITOR: Stats reset\r\n");
 }
@@ -79,6 +79,8 @@ enum Priorities {
 
     PRIO_TagPollTask        = osPriorityHigh,
     PRIO_TagRxTask          = osPriorityHigh,
+    PRIO_ReportTask         = osPriorityRealtime, /* UWB MAC report_cb */
+    PRIO_RespWorkerTask     = osPriorityHigh, /* servo actuation, below the UWB MAC tasks */
     PRIO_BlinkTask          = osPriorityNormal,
 
     PRIO_TcfmTask           = osPriorityNormal,
@@ -87,7 +87,8 @@ static const rf_tuning_t rf_tuning_config_flash_default =
     .rxb_ant          = 2,  //select ANT2 as, RX PATH B
     .lna1             = 0,  //BYPASS
     .lna2             = 0,  //BYPASS
-    .pa               = 0   //LOW PA
+    .pa               = 0,  //LOW PA
+    .paverage_mode    = 0
 };
 
 static rf_tuning_t rf_tuning_config_ram __attribute__((section(".rconfig"))) = {0};
@@ -95,6 +95,8 @@ struct rf_tuning_s
     uint8_t     lna1;
     uint8_t     lna2;
     uint8_t     pa;
+    // appended: the fields above keep their offsets in the saved configuration
+    uint8_t       paverage_mode;  /**< PDoA averaging: 0 linear, 1 circular */
 };
 
 typedef struct rf_tuning_s rf_tuning_t;
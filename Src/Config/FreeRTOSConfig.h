@@ -85,10 +85,20 @@
 #define configUSE_MALLOC_FAILED_HOOK                                              0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS                                             0
+#define configGENERATE_RUN_TIME_STATS                                             1
 #define configUSE_TRACE_FACILITY                                                  1
 #define configUSE_STATS_FORMATTING_FUNCTIONS                                      0
 
+/* Run time counter: hal_rt_counter, HAL_timer.c. The task number of the trace
+ * facility, otherwise unused, counts the times a task is switched in; see
+ * cpu_prof.h */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()                                  hal_rt_counter.init()
+#define portGET_RUN_TIME_COUNTER_VALUE()                                          hal_rt_counter.get()
+#define traceTASK_CREATE(pxNewTCB)                                                ((pxNewTCB)->uxTaskNumber = 0)
+#define traceTASK_SWITCHED_IN()                                                   (pxCurrentTCB->uxTaskNumber++)
+/* The report buffer statistics slot of a task deleted is free again, log_arena.h */
+#define traceTASK_DELETE(pxTCB)                                                   log_arena_producer_free(pxTCB)
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                                                     0
 #define configMAX_CO_ROUTINE_PRIORITIES                                           ( 2 )
@@ -176,6 +186,9 @@ standard names - or at least those used in the unmodified vector table. */
 #if !(defined(__ASSEMBLY__) || defined(__ASSEMBLER__))
     #include "nrf.h"
     #include "nrf_assert.h"
+    #include "HAL_timer.h"
+
+    void log_arena_producer_free(void *task);
 
     /* This part of definitions may be problematic in assembly - it uses definitions from files that are not assembly compatible. */
     /* Cortex-M specific definitions. */
@@ -188,6 +188,18 @@ static void spi_fast_rate(void)
     spi->fast_rate(spi->handler);
 }
 
+static void spi_burst_begin(void)
+{
+    struct spi_s *spi = hal_uwb.uwbs->spi;
+    spi->burst_begin(spi->handler);
+}
+
+static void spi_burst_end(void)
+{
+    struct spi_s *spi = hal_uwb.uwbs->spi;
+    spi->burst_end(spi->handler);
+}
+
 static int read_from_spi(uint16_t headerLength, uint8_t *headerBuffer, uint16_t readlength, uint8_t *readBuffer)
 {
     struct spi_s *spi = hal_uwb.uwbs->spi;
@@ -345,11 +357,15 @@ static inline GPIO_PinState port_CheckEXT_IRQ(void)
  * */
 static inline void process_deca_irq(void)
 {
+    spi_burst_begin();
+
     while (port_CheckEXT_IRQ() == GPIO_PIN_SET)
     {
         dwt_isr();
     } // while DW3000 IRQ line active
 
+    spi_burst_end();
+
     if (hal_uwb_sleep_status_get() & UWB_CAN_SLEEP_IN_IRQ)
     {
         hal_uwb_sleep_enter();
@@ -569,5 +585,8 @@ struct hal_uwb_s hal_uwb = {
     .is_sip = hal_uwb_return_false,
     .sip_configure = NULL,
 
+    .spi_burst_begin = spi_burst_begin,
+    .spi_burst_end = spi_burst_end,
+
     .uwbs = NULL
 };
\ No newline at end of file
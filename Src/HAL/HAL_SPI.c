@@ -51,6 +51,7 @@
 
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include "HAL_lock.h"
@@ -67,6 +68,10 @@ static void spi_cs_low_(void *handler);
 static void spi_cs_high_(void *handler);
 static int readfromspi_(void *handler, uint16_t headerLength, const uint8_t *headerBuffer, uint16_t readlength, uint8_t *readBuffer);
 static int writetospi_(void *handler, uint16_t headerLength, const uint8_t *headerBuffer, uint16_t bodylength, const uint8_t *bodyBuffer);
+static int spi_xfer_(void *handler, const spi_seg_t *seg, uint16_t nseg);
+static void spi_burst_begin_(void *handler);
+static void spi_burst_end_(void *handler);
+static void spi_get_stats_(void *handler, spi_stats_t *stats);
 
 typedef struct
 {
@@ -76,6 +81,8 @@ typedef struct
     uint32_t cs_pin;
     nrf_drv_spi_config_t spi_config;
     dw_hal_lockTypeDef lock;
+    uint32_t burst;         /* burst_begin() depth, SPIM stays enabled while > 0 */
+    spi_stats_t stats;
 } spi_handle_t;
 
 static spi_handle_t spi_handler0 = {
@@ -107,6 +114,10 @@ static const struct spi_s spim0 = {
     .read = readfromspi_,
     .write = writetospi_,
     .write_with_crc = NULL,
+    .xfer = spi_xfer_,
+    .burst_begin = spi_burst_begin_,
+    .burst_end = spi_burst_end_,
+    .get_stats = spi_get_stats_,
     .handler = &spi_handler0};
 #endif
 
@@ -119,13 +130,18 @@ static const struct spi_s spim3 = {
     .read = readfromspi_,
     .write = writetospi_,
     .write_with_crc = NULL,
+    .xfer = spi_xfer_,
+    .burst_begin = spi_burst_begin_,
+    .burst_end = spi_burst_end_,
+    .get_stats = spi_get_stats_,
     .handler = &spi_handler3};
 #endif
 
-#define DATALEN1 200
-static uint8_t idatabuf[DATALEN1] = {0}; // Never define this inside the Spi read/write
-static uint8_t itempbuf[DATALEN1] = {0}; // As that will use the stack from the Task, which are not such long!!!!
-                                         // You will face a crashes which are not expected!
+/* Segments up to this size are gathered into one DMA transfer: copying a few
+ * bytes is cheaper than starting EasyDMA once more. It lives on the stack of
+ * the caller, keep it small */
+#define SPI_BOUNCE_LEN  16
+
 uint8_t spi_init_stat = 0; // use 1 for slow, use 2 for fast;
 
 
@@ -278,97 +294,199 @@ static void spi_fast_rate_(void *handler)
     }
 }
 
-static int readfromspi_(void *handler, uint16_t headerLength, const uint8_t *headerBuffer, uint16_t readlength, uint8_t *readBuffer)
+static void spi_lock_(spi_handle_t *spi_handler)
+{
+    while (__atomic_exchange_n(&spi_handler->lock, DW_HAL_NODE_LOCKED, __ATOMIC_ACQUIRE) == DW_HAL_NODE_LOCKED) {}
+}
+
+static void spi_unlock_(spi_handle_t *spi_handler)
+{
+    __atomic_store_n(&spi_handler->lock, DW_HAL_NODE_UNLOCKED, __ATOMIC_RELEASE);
+}
+
+static void spi_burst_begin_(void *handler)
 {
     spi_handle_t *spi_handler = handler;
 
-    while (spi_handler->lock) {}
+    spi_lock_(spi_handler);
+    if (spi_handler->burst++ == 0)
+    {
+        open_spi(&spi_handler->spi_inst);
+        spi_handler->stats.enables++;
+    }
+    spi_unlock_(spi_handler);
+}
 
-    QHAL_LOCK(spi_handler);
+static void spi_burst_end_(void *handler)
+{
+    spi_handle_t *spi_handler = handler;
 
-    open_spi(&spi_handler->spi_inst);
+    spi_lock_(spi_handler);
+    if (spi_handler->burst > 0 && --spi_handler->burst == 0)
+    {
+        close_spi(&spi_handler->spi_inst);
+    }
+    spi_unlock_(spi_handler);
+}
 
-    nrf_gpio_pin_clear(spi_handler->cs_pin);
+static void spi_get_stats_(void *handler, spi_stats_t *stats)
+{
+    spi_handle_t *spi_handler = handler;
+    *stats = spi_handler->stats;
+}
+
+static int spi_dma_(spi_handle_t *spi_handler, const uint8_t *tx, uint16_t txlen, uint8_t *rx, uint16_t rxlen)
+{
+    nrfx_spim_xfer_desc_t const desc = NRFX_SPIM_XFER_TRX(tx, txlen, rx, rxlen);
+
+    spi_handler->stats.dma++;
+    return (nrfx_spim_xfer(&spi_handler->spi_inst.u.spim, &desc, 0) == NRFX_SUCCESS) ? 0 : -1;
+}
+
+/* @brief one DMA transfer of the n segments gathered in tx, scatter what was
+ *        received to them
+ * */
+static int spi_flush_(spi_handle_t *spi_handler, const uint8_t *tx, uint16_t len, const spi_seg_t *seg, uint16_t n)
+{
+    uint8_t rx[SPI_BOUNCE_LEN];
+    bool want_rx = false;
+    int ret;
 
-    if (headerLength + readlength <= 8)
+    for (uint16_t i = 0; i < n; i++)
     {
-        uint8_t out[8] = {0};
-        uint8_t in[8];
-        int idx = 0;
-        for (idx = 0; idx < headerLength; idx++)
-        {
-            out[idx] = headerBuffer[idx];
-        }
-        nrfx_spim_xfer_desc_t const spim_xfer_desc_header = {
-            .p_tx_buffer = out,
-            .tx_length = headerLength + readlength,
-            .p_rx_buffer = in,
-            .rx_length = headerLength + readlength};
-        nrfx_spim_xfer(&spi_handler->spi_inst.u.spim, &spim_xfer_desc_header, 0);
-        for (int i = 0; idx < headerLength + readlength; idx++, i++)
+        want_rx |= (seg[i].rx != NULL);
+    }
+
+    ret = spi_dma_(spi_handler, tx, len, want_rx ? rx : NULL, want_rx ? len : 0);
+
+    for (uint16_t i = 0, off = 0; want_rx && i < n; off += seg[i].len, i++)
+    {
+        if (seg[i].rx)
         {
-            readBuffer[i] = in[idx];
+            memcpy(seg[i].rx, &rx[off], seg[i].len);
         }
     }
-    else
+    return ret;
+}
+
+/* @brief a segment too large to gather: straight from and to the caller's
+ *        buffers, unless EasyDMA cannot read them (flash)
+ * */
+static int spi_seg_dma_(spi_handle_t *spi_handler, const spi_seg_t *seg, uint8_t *bounce)
+{
+    const uint8_t *tx = seg->tx;
+    uint8_t *rx = seg->rx;
+    uint16_t left = seg->len;
+    int ret = 0;
+
+    if ((tx && nrfx_is_in_ram(tx)) || (!tx && rx))
     {
-        nrfx_spim_xfer_desc_t const spim_xfer_desc_header = {
-            .p_tx_buffer = headerBuffer,
-            .tx_length = headerLength,
-            .p_rx_buffer = NULL,
-            .rx_length = 0};
-        nrfx_spim_xfer(&spi_handler->spi_inst.u.spim, &spim_xfer_desc_header, 0);
-
-        nrfx_spim_xfer_desc_t const spim_xfer_desc_body = {
-            .p_tx_buffer = NULL,
-            .tx_length = 0,
-            .p_rx_buffer = readBuffer,
-            .rx_length = readlength,
-        };
-        nrfx_spim_xfer(&spi_handler->spi_inst.u.spim, &spim_xfer_desc_body, 0);
+        return spi_dma_(spi_handler, tx, tx ? left : 0, rx, rx ? left : 0);
     }
-    nrf_gpio_pin_set(spi_handler->cs_pin);
-
-    close_spi(&spi_handler->spi_inst);
 
-    QHAL_UNLOCK(spi_handler);
+    while (left && ret == 0)
+    {
+        uint16_t len = (left < SPI_BOUNCE_LEN) ? left : SPI_BOUNCE_LEN;
+        spi_seg_t part = {.tx = tx, .rx = rx, .len = len};
 
-    return 0;
+        if (tx)
+        {
+            memcpy(bounce, tx, len);
+            tx += len;
+        }
+        else
+        {
+            memset(bounce, 0xFF, len);
+        }
+        spi_handler->stats.copied += len;
+        ret = spi_flush_(spi_handler, bounce, len, &part, 1);
+        rx = rx ? rx + len : NULL;
+        left -= len;
+    }
+    return ret;
 }
 
-static int writetospi_(void *handler, uint16_t headerLength, const uint8_t *headerBuffer, uint16_t bodylength, const uint8_t *bodyBuffer)
+static int spi_xfer_(void *handler, const spi_seg_t *seg, uint16_t nseg)
 {
     spi_handle_t *spi_handler = handler;
-    uint8_t *p1;
-    uint32_t idatalength = headerLength + bodylength;
+    uint8_t bounce[SPI_BOUNCE_LEN];
+    uint16_t pending = 0;   /* bytes gathered in bounce */
+    uint16_t first = 0;     /* first segment gathered */
+    int ret = 0;
 
-    if (idatalength > DATALEN1)
+    spi_lock_(spi_handler);
+
+    if (spi_handler->burst == 0)
     {
-        return NRF_ERROR_NO_MEM;
+        open_spi(&spi_handler->spi_inst);
+        spi_handler->stats.enables++;
     }
+    spi_handler->stats.xfers++;
 
-    while (spi_handler->lock) {}
+    nrf_gpio_pin_clear(spi_handler->cs_pin);
 
-    QHAL_LOCK(spi_handler);
+    for (uint16_t i = 0; i < nseg && ret == 0; i++)
+    {
+        spi_handler->stats.bytes += seg[i].len;
 
-    open_spi(&spi_handler->spi_inst);
+        if (seg[i].len > SPI_BOUNCE_LEN - pending && pending)
+        {
+            ret = spi_flush_(spi_handler, bounce, pending, &seg[first], i - first);
+            pending = 0;
+        }
+        if (ret == 0 && seg[i].len > SPI_BOUNCE_LEN)
+        {
+            ret = spi_seg_dma_(spi_handler, &seg[i], bounce);
+        }
+        else if (ret == 0)
+        {
+            if (pending == 0)
+            {
+                first = i;
+            }
+            if (seg[i].tx)
+            {
+                memcpy(&bounce[pending], seg[i].tx, seg[i].len);
+            }
+            else
+            {
+                memset(&bounce[pending], 0xFF, seg[i].len);
+            }
+            spi_handler->stats.copied += seg[i].len;
+            pending += seg[i].len;
+        }
+    }
+    if (ret == 0 && pending)
+    {
+        ret = spi_flush_(spi_handler, bounce, pending, &seg[first], nseg - first);
+    }
 
-    nrf_gpio_pin_clear(spi_handler->cs_pin);
+    nrf_gpio_pin_set(spi_handler->cs_pin);
 
-    p1 = idatabuf;
-    memcpy(p1, headerBuffer, headerLength);
-    p1 += headerLength;
-    memcpy(p1, bodyBuffer, bodylength);
+    if (spi_handler->burst == 0)
+    {
+        close_spi(&spi_handler->spi_inst);
+    }
 
-    idatalength = headerLength + bodylength;
+    spi_unlock_(spi_handler);
 
-    nrf_drv_spi_transfer(&spi_handler->spi_inst, idatabuf, idatalength, itempbuf, idatalength);
+    return ret;
+}
 
-    nrf_gpio_pin_set(spi_handler->cs_pin);
+static int readfromspi_(void *handler, uint16_t headerLength, const uint8_t *headerBuffer, uint16_t readlength, uint8_t *readBuffer)
+{
+    spi_seg_t const seg[] = {
+        {.tx = headerBuffer, .rx = NULL, .len = headerLength},
+        {.tx = NULL, .rx = readBuffer, .len = readlength}};
 
-    close_spi(&spi_handler->spi_inst);
+    return spi_xfer_(handler, seg, 2);
+}
 
-    QHAL_UNLOCK(spi_handler);
+static int writetospi_(void *handler, uint16_t headerLength, const uint8_t *headerBuffer, uint16_t bodylength, const uint8_t *bodyBuffer)
+{
+    spi_seg_t const seg[] = {
+        {.tx = headerBuffer, .rx = NULL, .len = headerLength},
+        {.tx = bodyBuffer, .rx = NULL, .len = bodylength}};
 
-    return 0;
+    return spi_xfer_(handler, seg, 2);
 }
@@ -54,6 +54,26 @@
 
 #include <stdint.h>
 
+/* One segment of a transaction: len bytes are clocked, tx NULL sends 0xFF,
+ * rx NULL discards what is received */
+struct spi_seg_s
+{
+    const uint8_t *tx;
+    uint8_t *rx;
+    uint16_t len;
+};
+typedef struct spi_seg_s spi_seg_t;
+
+struct spi_stats_s
+{
+    uint32_t xfers;     /* transactions, one CS low window each */
+    uint32_t dma;       /* EasyDMA transfers */
+    uint32_t bytes;     /* bytes clocked */
+    uint32_t copied;    /* bytes that went through the bounce buffer */
+    uint32_t enables;   /* SPIM enable/disable cycles */
+};
+typedef struct spi_stats_s spi_stats_t;
+
 struct spi_s
 {
     void (*cs_low)(void *handler);
@@ -63,6 +83,10 @@ struct spi_s
     int (*read)(void *handler, uint16_t headerLength, const uint8_t *headerBuffer, uint16_t readlength, uint8_t *readBuffer);
     int (*write)(void *handler, uint16_t headerLength, const uint8_t *headerBuffer, uint16_t readlength, const uint8_t *readBuffer);
     int (*write_with_crc)(void *handler, uint16_t headerLength, const uint8_t *headerBuffer, uint16_t bodyLength, const uint8_t *bodyBuffer, uint8_t crc8);
+    int (*xfer)(void *handler, const spi_seg_t *seg, uint16_t nseg);  /* all segments in one CS low window */
+    void (*burst_begin)(void *handler);     /* keep SPIM enabled until burst_end(), nests */
+    void (*burst_end)(void *handler);
+    void (*get_stats)(void *handler, spi_stats_t *stats);
     void *handler;
 };
 typedef struct spi_s spi_t;
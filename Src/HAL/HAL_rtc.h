@@ -54,6 +54,9 @@
 
 #include <stdint.h>
 
+/* The Rtc counts at 32768 Hz */
+#define RTC_TICKS_TO_US(t)  ((uint32_t)(((uint64_t)(t) * 1000000UL) / 32768))
+
 struct hal_rtc_s
 {
     void (*init)(void);
@@ -51,166 +51,205 @@
 
 #include "HAL_servo.h"
 #include "custom_board.h"
-#include "nrf_gpio.h"
-#include "nrf_delay.h"
 #include "FreeRTOS.h"
 #include "task.h"
-#include "reporter.h"
+#include "timers.h"
+#include "dlog.h"
 #include <string.h>
-
-/* Servo state */
-static bool servo_initialized = false;
-static uint16_t current_position = SERVO_POS_CENTER;
+#include <stdio.h>
 
 /* PWM timing constants */
 #define SERVO_PWM_FREQ_HZ         50                 /* 50Hz servo frequency */
 #define SERVO_PERIOD_MS           20                 /* 20ms period */
+#define SERVO_PERIOD_US           (SERVO_PERIOD_MS * 1000)
 #define SERVO_MIN_PULSE_US        1000               /* 1ms minimum pulse width */
 #define SERVO_MAX_PULSE_US        2000               /* 2ms maximum pulse width */
 
-/* Servo PWM task handle */
-/* Servo PWM task handle */
-static TaskHandle_t servo_pwm_task_handle = NULL;
+/* Servo state */
+static const struct hal_servo_backend_s *servo_backend = &ServoPwm;
+static bool servo_initialized = false;
+static uint16_t current_position = SERVO_POS_CENTER;    /* pulse width being output */
+static uint16_t target_position = SERVO_POS_CENTER;     /* end of the smooth move */
+static uint16_t ramp_step_us = 0;                       /* per period, 0: no move in progress */
 
-/**
- * @brief FreeRTOS task for servo PWM generation
- * Generates 50Hz PWM with variable pulse width on GPIO pin
- */
-static void servo_pwm_task(void *p_arg)
+/* Steps the smooth move, one pulse width update per PWM period */
+static TimerHandle_t servo_ramp_timer = NULL;
+
+static uint16_t servo_clamp(uint16_t pulse_width_us)
 {
-    uint16_t pulse_width_us;
-    static uint32_t cycle_count = 0;
-    
-    (void)p_arg;
-    
-    const uint32_t max_cycles = 50; // 1 second of PWM
-    for (uint32_t i = 0; i < max_cycles; ++i) {
-        /* Get current position safely */
-        taskENTER_CRITICAL();
-        pulse_width_us = current_position;
+    if (pulse_width_us < SERVO_MIN_PULSE_US)
+        pulse_width_us = SERVO_MIN_PULSE_US;
+    if (pulse_width_us > SERVO_MAX_PULSE_US)
+        pulse_width_us = SERVO_MAX_PULSE_US;
+    return pulse_width_us;
+}
+
+static void servo_ramp_timer_cb(TimerHandle_t xTimer)
+{
+    bool done;
+
+    taskENTER_CRITICAL();
+    if (ramp_step_us == 0)
+    {
         taskEXIT_CRITICAL();
-        /* Deep debug: log every PWM cycle */
-        char cycle_str[128];
-        int clen = snprintf(cycle_str, sizeof(cycle_str),
-            "[DEBUG][servo_pwm_task] PWM cycle: Pin=%u, Pulse=%u us\r\n", SERVO_PWM_PIN, pulse_width_us);
-        reporter_instance.print(cycle_str, clen);
-
-        /* Generate PWM pulse with microsecond accuracy */
-        nrf_gpio_pin_set(SERVO_PWM_PIN);
-        nrf_delay_us(pulse_width_us); // Accurate high pulse
-        nrf_gpio_pin_clear(SERVO_PWM_PIN);
-
-        /* Calculate remaining time in 20ms period (in microseconds) */
-        uint32_t remaining_us = (SERVO_PERIOD_MS * 1000) - pulse_width_us;
-        if (remaining_us > 0) {
-            // For long remaining time, yield to FreeRTOS for most of it, then busy-wait for the last ~1ms
-            if (remaining_us > 2000) {
-                vTaskDelay(pdMS_TO_TICKS((remaining_us - 1000) / 1000));
-                nrf_delay_us((remaining_us - 1000) % 1000 + 1000);
-            } else {
-                nrf_delay_us(remaining_us);
-            }
-        }
+        xTimerStop(xTimer, 0);
+        return;
+    }
 
-        /* Debug output every 50 cycles (once per second) */
-        cycle_count++;
-        if (cycle_count >= 50)
-        {
-            char pwm_str[64];
-            int len = snprintf(pwm_str, sizeof(pwm_str),
-                "SERVO_PWM: Pin=%u, Pulse=%u us\r\n", SERVO_PWM_PIN, pulse_width_us);
-            reporter_instance.print(pwm_str, len);
-            cycle_count = 0;
-        }
-        /* No extra vTaskDelay(1); needed, period is enforced above */
+    if (current_position < target_position)
+    {
+        current_position = (target_position - current_position > ramp_step_us) ?
+                           (uint16_t)(current_position + ramp_step_us) : target_position;
+    }
+    else
+    {
+        current_position = (current_position - target_position > ramp_step_us) ?
+                           (uint16_t)(current_position - ramp_step_us) : target_position;
+    }
+    done = (current_position == target_position);
+    if (done)
+    {
+        ramp_step_us = 0;
+    }
+    /* under the lock: a concurrent HAL_servo_set_position() is output after
+     * this step, not before it */
+    servo_backend->setPulse(current_position);
+    taskEXIT_CRITICAL();
+
+    if (done)
+    {
+        xTimerStop(xTimer, 0);
+    }
+}
+
+void HAL_servo_set_backend(const struct hal_servo_backend_s *backend)
+{
+    if (!servo_initialized)
+    {
+        servo_backend = (backend != NULL) ? backend : &ServoPwm;
     }
-    nrf_gpio_pin_clear(SERVO_PWM_PIN);
-    char stop_str[] = "SERVO: PWM task finished, output stopped\r\n";
-    reporter_instance.print(stop_str, strlen(stop_str));
-    TaskHandle_t handle = servo_pwm_task_handle;
-    servo_pwm_task_handle = NULL;
-    vTaskDelete(handle);
 }
 
 void HAL_servo_init(void)
 {
-    /* Configure GPIO for servo output */
-    nrf_gpio_cfg_output(SERVO_PWM_PIN);
-    nrf_gpio_pin_clear(SERVO_PWM_PIN);
-    
-    char pin_str[64];
-    int len = snprintf(pin_str, sizeof(pin_str),
-        "SERVO: Configuring GPIO pin %u as output\r\n", SERVO_PWM_PIN);
-    reporter_instance.print(pin_str, len);
-    
+    if (servo_initialized)
+    {
+        return;
+    }
+
+    if (!servo_backend->init(SERVO_PWM_PIN, SERVO_PERIOD_US))
+    {
+        DLOG_ERR(DLOG_MOD_SERVO, "SERVO: ERROR - backend init failed!\r\n");
+        return;
+    }
+
+    if (servo_ramp_timer == NULL)
+    {
+        servo_ramp_timer = xTimerCreate("ServoRamp", pdMS_TO_TICKS(SERVO_PERIOD_MS),
+                                        pdTRUE, NULL, servo_ramp_timer_cb);
+    }
+
     current_position = SERVO_POS_CENTER;
+    target_position = SERVO_POS_CENTER;
+    ramp_step_us = 0;
     servo_initialized = true;
-    char init_str[] = "SERVO: Initialized, PWM task not running until move command.\r\n";
-    reporter_instance.print(init_str, strlen(init_str));
+
+    DLOG_INFO(DLOG_MOD_SERVO, "SERVO: Initialized on pin %u, output idle until move command.\r\n", SERVO_PWM_PIN);
 }
 
 void HAL_servo_set_position(uint16_t pulse_width_us)
 {
+    uint16_t prev;
+
     if (!servo_initialized)
     {
-        char err_str[] = "SERVO: ERROR - Not initialized!\r\n";
-        reporter_instance.print(err_str, strlen(err_str));
+        DLOG_ERR(DLOG_MOD_SERVO, "SERVO: ERROR - Not initialized!\r\n");
         return;
     }
-    
-    /* Clamp to valid range */
-    if (pulse_width_us < SERVO_MIN_PULSE_US)
-        pulse_width_us = SERVO_MIN_PULSE_US;
-    if (pulse_width_us > SERVO_MAX_PULSE_US)
-        pulse_width_us = SERVO_MAX_PULSE_US;
-    
-    /* Log position change (deep debug) */
-    char log_str[128];
-    int len = snprintf(log_str, sizeof(log_str),
-        "[DEBUG][HAL_servo_set_position] Setting position to %u us (was %u us)\r\n", pulse_width_us, current_position);
-    reporter_instance.print(log_str, len);
-    
-    /* Update position atomically */
+
+    pulse_width_us = servo_clamp(pulse_width_us);
+
+    /* Update position atomically, cancelling any ramp in progress */
     taskENTER_CRITICAL();
+    prev = current_position;
     current_position = pulse_width_us;
+    target_position = pulse_width_us;
+    ramp_step_us = 0;
+    servo_backend->setPulse(pulse_width_us);
     taskEXIT_CRITICAL();
 
-        /* Start PWM task if not running */
-    if (servo_pwm_task_handle == NULL) {
-        char start_str[] = "SERVO: Starting PWM task for move\r\n";
-        reporter_instance.print(start_str, strlen(start_str));
-        BaseType_t xReturned = xTaskCreate(
-            servo_pwm_task,
-            "ServosPWM",
-            512,
-            NULL,
-            1,
-            &servo_pwm_task_handle
-        );
-        if (xReturned != pdPASS) {
-            char fail_str[] = "SERVO: Failed to start PWM task!\r\n";
-            reporter_instance.print(fail_str, strlen(fail_str));
-        }
+    /* Log position change (deep debug) */
+    DLOG_DBG(DLOG_MOD_SERVO, "[DEBUG][HAL_servo_set_position] Setting position to %u us (was %u us)\r\n", pulse_width_us, prev);
+}
+
+void HAL_servo_move_smooth(uint16_t pulse_width_us, uint16_t slew_us_per_s)
+{
+    uint32_t step;
+    bool moving;
+
+    if (slew_us_per_s == 0 || servo_ramp_timer == NULL)
+    {
+        HAL_servo_set_position(pulse_width_us);
+        return;
+    }
+
+    if (!servo_initialized)
+    {
+        DLOG_ERR(DLOG_MOD_SERVO, "SERVO: ERROR - Not initialized!\r\n");
+        return;
+    }
+
+    step = ((uint32_t)slew_us_per_s * SERVO_PERIOD_MS) / 1000;
+    if (step == 0)
+    {
+        step = 1;
+    }
+
+    taskENTER_CRITICAL();
+    target_position = servo_clamp(pulse_width_us);
+    ramp_step_us = (target_position != current_position) ? (uint16_t)step : 0;
+    moving = (ramp_step_us != 0);
+    /* Make sure the output runs while ramping from the current position */
+    servo_backend->setPulse(current_position);
+    taskEXIT_CRITICAL();
+
+    if (moving)
+    {
+        xTimerStart(servo_ramp_timer, 0);
     }
 }
 
+bool HAL_servo_is_moving(void)
+{
+    return (ramp_step_us != 0);
+}
+
+uint16_t HAL_servo_get_position(void)
+{
+    return current_position;
+}
+
 void HAL_servo_move_to_position(servo_position_e position)
 {
-    char pos_str[64];
-    int len = snprintf(pos_str, sizeof(pos_str),
-        "SERVO: Moving to position %u us\r\n", (uint16_t)position);
-    reporter_instance.print(pos_str, len);
-    
+    DLOG_DBG(DLOG_MOD_SERVO, "SERVO: Moving to position %u us\r\n", (uint16_t)position);
+
     HAL_servo_set_position((uint16_t)position);
 }
 
 void HAL_servo_stop(void)
 {
-    if (servo_initialized && servo_pwm_task_handle != NULL)
+    if (servo_initialized)
     {
-        vTaskDelete(servo_pwm_task_handle);
-        servo_pwm_task_handle = NULL;
-        nrf_gpio_pin_clear(SERVO_PWM_PIN);
+        taskENTER_CRITICAL();
+        ramp_step_us = 0;
+        target_position = current_position;
+        servo_backend->stop();
+        taskEXIT_CRITICAL();
+
+        if (servo_ramp_timer != NULL)
+        {
+            xTimerStop(servo_ramp_timer, 0);
+        }
     }
 }
 
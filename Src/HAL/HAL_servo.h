@@ -64,13 +64,42 @@ typedef enum {
     SERVO_POS_MAX = 2000       // Full right (~180 degrees)
 } servo_position_e;
 
+/**
+ * @brief Servo pulse generator backend
+ *
+ * The servo HAL only decides which pulse width to output; producing the
+ * 50Hz pulse train is left to a backend. The default one is ServoPwm
+ * (hardware PWM, no CPU load). A host build can plug in a mock with
+ * HAL_servo_set_backend() to record the pulses. Its functions other than
+ * init are called in a critical section of the HAL, and must not block.
+ */
+struct hal_servo_backend_s
+{
+    bool (*init)(uint32_t pin, uint16_t period_us);
+    void (*setPulse)(uint16_t pulse_us);   /* starts the output if stopped, applied at the next period */
+    void (*stop)(void);                    /* output idle low after the current period */
+};
+
+extern const struct hal_servo_backend_s ServoPwm;
+
+/**
+ * @fn void HAL_servo_set_backend(const struct hal_servo_backend_s *backend)
+ *
+ * @brief Select the pulse generator backend, must be called before HAL_servo_init()
+ *
+ * @param backend Backend to use, NULL selects ServoPwm
+ * @return void
+ */
+void HAL_servo_set_backend(const struct hal_servo_backend_s *backend);
+
 /**
  * @fn void HAL_servo_init(void)
  *
  * @brief Initialize servo PWM control
  *
- * Configures PWM peripheral with appropriate frequency and duty cycle
- * for standard servo control (50Hz, 1-2ms pulse width).
+ * Configures the backend with appropriate frequency and duty cycle
+ * for standard servo control (50Hz, 1-2ms pulse width). The output
+ * stays idle until the first position is set.
  *
  * @return void
  */
@@ -81,7 +110,9 @@ void HAL_servo_init(void);
  *
  * @brief Set servo position based on pulse width
  *
- * Sets the servo position by controlling the PWM duty cycle.
+ * Sets the servo position by controlling the PWM duty cycle, the new
+ * pulse width is output from the next 20ms period on. Cancels any
+ * smooth move in progress.
  * Standard servo pulse width range is 1000-2000 microseconds.
  * 1000us = 0 degrees, 1500us = 90 degrees, 2000us = 180 degrees
  *
@@ -100,6 +131,39 @@ void HAL_servo_set_position(uint16_t pulse_width_us);
  */
 void HAL_servo_move_to_position(servo_position_e position);
 
+/**
+ * @fn void HAL_servo_move_smooth(uint16_t pulse_width_us, uint16_t slew_us_per_s)
+ *
+ * @brief Ramp the servo towards a position with a bounded slew rate
+ *
+ * The pulse width is stepped once per PWM period, by at most
+ * slew_us_per_s / 50 microseconds, until the target is reached.
+ * A new call retargets the ramp from the current pulse width.
+ *
+ * @param pulse_width_us Target pulse width in microseconds (1000-2000)
+ * @param slew_us_per_s  Maximum rate of change, 0 moves immediately
+ * @return void
+ */
+void HAL_servo_move_smooth(uint16_t pulse_width_us, uint16_t slew_us_per_s);
+
+/**
+ * @fn bool HAL_servo_is_moving(void)
+ *
+ * @brief Check if a smooth move is still in progress
+ *
+ * @return true while the output has not reached the target
+ */
+bool HAL_servo_is_moving(void);
+
+/**
+ * @fn uint16_t HAL_servo_get_position(void)
+ *
+ * @brief Pulse width currently output, in microseconds
+ *
+ * @return pulse width in microseconds
+ */
+uint16_t HAL_servo_get_position(void);
+
 /**
  * @fn void HAL_servo_stop(void)
  *
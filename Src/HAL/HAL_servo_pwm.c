@@ -0,0 +1,157 @@
+/**
+ * @file    HAL_servo_pwm.c
+ *
+ * @brief   Servo pulse backend on the nRF52 PWM peripheral
+ *
+ *          PWM0 runs from the 1 MHz base clock with a 20000 count top value,
+ *          so one compare unit is 1 us and the period is exactly 20 ms. The
+ *          sequence is a single RAM word played in a loop: EasyDMA re-reads it
+ *          at every period, so a new pulse width written there takes effect at
+ *          the next period boundary without CPU involvement or a glitch.
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdint.h>
+
+#include "HAL_servo.h"
+#include "sdk_config.h"
+
+#include <nrfx_pwm.h>
+
+#if !defined(NRFX_PWM_ENABLED) || !NRFX_PWM_ENABLED
+#error "PWM defined but not enabled"
+#endif
+
+#define SERVO_PWM_BASE_CLOCK    NRF_PWM_CLK_1MHz
+#define SERVO_PWM_TICKS_PER_US  1
+
+/* Bit 15 of a sequence value selects the polarity: set, the output is high
+ * from the start of the period until the compare match, i.e. the value is the
+ * pulse width. */
+#define SERVO_PWM_POLARITY_HIGH 0x8000
+
+static nrfx_pwm_t servo_pwm = NRFX_PWM_INSTANCE(0);
+
+/* Must stay in RAM for EasyDMA */
+static nrf_pwm_values_common_t servo_seq_value;
+
+static nrf_pwm_sequence_t const servo_seq = {
+    .values.p_common = &servo_seq_value,
+    .length = NRF_PWM_VALUES_LENGTH(servo_seq_value),
+    .repeats = 0,
+    .end_delay = 0
+};
+
+/* Output state, changed by the HAL in its critical section and by the
+ * STOPPED event of the PWM */
+typedef enum
+{
+    SERVO_PWM_IDLE = 0,
+    SERVO_PWM_RUNNING,
+    SERVO_PWM_STOPPING,     /**< STOP triggered, the period is ending */
+    SERVO_PWM_RESTARTING    /**< a pulse was set while stopping */
+} servo_pwm_state_e;
+
+static volatile servo_pwm_state_e servo_pwm_state = SERVO_PWM_IDLE;
+static bool servo_pwm_initialized = false;
+
+static void servo_pwm_start(void)
+{
+    nrfx_pwm_simple_playback(&servo_pwm, &servo_seq, 1, NRFX_PWM_FLAG_LOOP);
+    servo_pwm_state = SERVO_PWM_RUNNING;
+}
+
+/* The output is stopped: idle, or running again if a pulse came meanwhile */
+static void servo_pwm_handler(nrfx_pwm_evt_type_t event)
+{
+    if (event != NRFX_PWM_EVT_STOPPED)
+    {
+        return;
+    }
+    if (servo_pwm_state == SERVO_PWM_RESTARTING)
+    {
+        servo_pwm_start();
+    }
+    else
+    {
+        servo_pwm_state = SERVO_PWM_IDLE;
+    }
+}
+
+static bool servo_pwm_init(uint32_t pin, uint16_t period_us)
+{
+    nrfx_pwm_config_t config = {
+        .output_pins = {
+            pin,
+            NRFX_PWM_PIN_NOT_USED,
+            NRFX_PWM_PIN_NOT_USED,
+            NRFX_PWM_PIN_NOT_USED,
+        },
+        .irq_priority = NRFX_PWM_DEFAULT_CONFIG_IRQ_PRIORITY,
+        .base_clock = SERVO_PWM_BASE_CLOCK,
+        .count_mode = NRF_PWM_MODE_UP,
+        .top_value = (uint16_t)(period_us * SERVO_PWM_TICKS_PER_US),
+        .load_mode = NRF_PWM_LOAD_COMMON,
+        .step_mode = NRF_PWM_STEP_AUTO
+    };
+
+    if (servo_pwm_initialized)
+    {
+        return true;
+    }
+
+    /* Only the STOPPED event interrupts, once per stop */
+    if (nrfx_pwm_init(&servo_pwm, &config, servo_pwm_handler) != NRFX_SUCCESS)
+    {
+        return false;
+    }
+
+    servo_pwm_initialized = true;
+    return true;
+}
+
+static void servo_pwm_set_pulse(uint16_t pulse_us)
+{
+    /* A single aligned halfword store, picked up by EasyDMA at the next period */
+    servo_seq_value = (nrf_pwm_values_common_t)((pulse_us * SERVO_PWM_TICKS_PER_US) | SERVO_PWM_POLARITY_HIGH);
+
+    if (!servo_pwm_initialized)
+    {
+        return;
+    }
+    if (servo_pwm_state == SERVO_PWM_IDLE)
+    {
+        servo_pwm_start();
+    }
+    else if (servo_pwm_state == SERVO_PWM_STOPPING)
+    {
+        /* cannot start before it stops: on the STOPPED event */
+        servo_pwm_state = SERVO_PWM_RESTARTING;
+    }
+}
+
+static void servo_pwm_stop(void)
+{
+    if (servo_pwm_state == SERVO_PWM_RUNNING)
+    {
+        /* Does not wait: the current period ends, the pin is left at idle
+         * (low) and the STOPPED event moves to idle */
+        servo_pwm_state = SERVO_PWM_STOPPING;
+        (void)nrfx_pwm_stop(&servo_pwm, false);
+    }
+    else if (servo_pwm_state == SERVO_PWM_RESTARTING)
+    {
+        servo_pwm_state = SERVO_PWM_STOPPING;
+    }
+}
+
+/*********************************************************************************/
+/** @brief Servo pulse backend driven by the PWM0 peripheral
+ */
+const struct hal_servo_backend_s ServoPwm = {
+    .init = &servo_pwm_init,
+    .setPulse = &servo_pwm_set_pulse,
+    .stop = &servo_pwm_stop
+};
@@ -324,6 +324,36 @@ hal_fs_timer_t hal_fs_timer = {
 hal_fs_timer_t hal_fs_timer = {NULL, NULL, NULL, NULL, NULL, NULL, 0};
 #endif
 
+/******************************************************************************
+ *              Run-time statistics counter
+ * TIMER2, free-running at 1MHz on 32 bits: it wraps after 71 minutes, the
+ * statistics take differences. No interrupt, no driver instance.
+ */
+#define RT_COUNTER_TIMER    NRF_TIMER2
+
+static void rt_counter_init(void)
+{
+    nrf_timer_task_trigger(RT_COUNTER_TIMER, NRF_TIMER_TASK_STOP);
+    nrf_timer_mode_set(RT_COUNTER_TIMER, NRF_TIMER_MODE_TIMER);
+    nrf_timer_bit_width_set(RT_COUNTER_TIMER, NRF_TIMER_BIT_WIDTH_32);
+    nrf_timer_frequency_set(RT_COUNTER_TIMER, NRF_TIMER_FREQ_1MHz);
+    nrf_timer_task_trigger(RT_COUNTER_TIMER, NRF_TIMER_TASK_CLEAR);
+    nrf_timer_task_trigger(RT_COUNTER_TIMER, NRF_TIMER_TASK_START);
+}
+
+/* @brief the counter, captured in CC0: a capture interrupted by the context
+ *        switch between its two steps reads the later value of the switch */
+static uint32_t rt_counter_get(void)
+{
+    nrf_timer_task_trigger(RT_COUNTER_TIMER, NRF_TIMER_TASK_CAPTURE0);
+    return nrf_timer_cc_read(RT_COUNTER_TIMER, NRF_TIMER_CC_CHANNEL0);
+}
+
+const struct hal_rt_counter_s hal_rt_counter = {
+    .init = &rt_counter_init,
+    .get = &rt_counter_get,
+    .freq = 1000000};
+
 /*********************************************************************************/
 /** @brief HAL Timer API structure
  */
@@ -104,4 +104,17 @@ struct hal_timer_s
 };
 
 extern const struct hal_timer_s Timer;
+
+/* Free-running counter of the FreeRTOS run-time statistics, see
+ * FreeRTOSConfig.h: it keeps counting while the CPU sleeps in the idle task */
+struct hal_rt_counter_s
+{
+    void (*init)(void);
+    uint32_t (*get)(void);
+
+    /* counter frequency */
+    uint32_t freq;
+};
+
+extern const struct hal_rt_counter_s hal_rt_counter;
 #endif
\ No newline at end of file
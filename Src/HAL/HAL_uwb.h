@@ -156,6 +156,10 @@ struct hal_uwb_s
 
     struct dw_s *uwbs;              // UWB Subsystem connection: SPI, I/O and Driver
 
+    // SPI bursts: SPIM stays enabled between the accesses of a burst
+    void (*spi_burst_begin)(void);
+    void (*spi_burst_end)(void);
+
     void (*stop_all_uwb)(void);
     error_e (*disable_irq_and_reset)(int);
     void (*deinit_callback)(void);
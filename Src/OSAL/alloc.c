@@ -53,6 +53,7 @@
 #include <string.h>
 
 #include "FreeRTOS.h"
+#include "skb_pool.h"
 
 
 /* Define the linked list structure.  This is used to link free blocks in order
@@ -83,6 +84,11 @@ void *malloc(size_t size)
 
 void free(void *ptr)
 {
+    /* sk_buff of the UWB frame path, freed by the MAC with kfree_skb() */
+    if (skb_pool_release(ptr))
+    {
+        return;
+    }
     vPortFree(ptr);
     return;
 }
@@ -49,12 +49,13 @@
  */
 
 #include "create_report_task.h"
+#include "int_priority.h"
 
 error_e create_report_task(void (*report_task)(void const *), task_signal_t *reportTask, uint16_t stackSize)
 {
     error_e ret = _ERR_Cannot_Alloc_Memory;
     reportTask->SignalMask = REPORT_TASK_ALL;
-    osThreadDef(reportTask, report_task, osPriorityRealtime, 0, stackSize / 4);
+    osThreadDef(reportTask, report_task, PRIO_ReportTask, 0, stackSize / 4);
     reportTask->Handle = osThreadCreate(osThread(reportTask), NULL);
     if (reportTask->Handle)
     {
@@ -52,6 +52,8 @@
 
 #include "linux/ieee802154.h"
 #include "linux/skbuff.h"
+#include "skb_pool.h"
+#include "fh_schedule.h"
 
 #define LP_DIAG_PRINTF(...)
 #define LP_DIAG_PRINTF1(...)
@@ -195,9 +197,27 @@ static void lp_timer_fira(void *p_context)
             dwt_config_t *config = dw->config->rxtx_config->pdwCfg;
             const struct dwt_ops_s *dwt_ops =
                 dw->dwt_driver->dwt_ops;
+            fh_hop_t hop;
+            uint32_t t0, t1;
 
-            dwt_ops->configure(dw, config);
             update_channel_pcode = 0;
+
+            /* frequency hop staged on the report path for this block */
+            if (fh_schedule_take(&hop))
+            {
+                config->chan = hop.chan;
+                config->txCode = hop.pcode;
+                config->rxCode = hop.pcode;
+            }
+
+            t0 = htimer->get_tick(htimer);
+            dwt_ops->configure(dw, config);
+            t1 = htimer->get_tick(htimer);
+
+            /* the timer restarts on its compare: t1 < t0 means the calibration
+             * slot was overrun, account the slot length as a lower bound */
+            fh_schedule_account((t1 >= t0) ? (uint32_t)(((uint64_t)(t1 - t0) * 1000000UL) / htimer->freq) : tmp,
+                                (t1 < t0));
         }
     }
     else
@@ -236,8 +256,7 @@ static void lp_timer_fira(void *p_context)
             {
                 ret = ops->tx_frame(dw, dss->tx_skb->data, dss->tx_skb->len + 2 /*IEEE802154_FCS_LEN*/, &dss->txops);
 
-                free(dss->tx_skb->data);
-                free(dss->tx_skb);
+                skb_pool_free(dss->tx_skb);
                 dss->tx_skb = NULL;
             }
             else
@@ -331,8 +350,7 @@ void lp_timer_fira_deinit(struct dwchip_s *dw)
 
     if (dw->mcps_runtime->deep_sleep_state.tx_skb)
     {
-        free(dw->mcps_runtime->deep_sleep_state.tx_skb->data);
-        free(dw->mcps_runtime->deep_sleep_state.tx_skb);
+        skb_pool_free(dw->mcps_runtime->deep_sleep_state.tx_skb);
         dw->mcps_runtime->deep_sleep_state.tx_skb = NULL;
     }
 }
@@ -446,6 +464,7 @@ int dw3000_tx_frame(struct dwchip_s *dw, struct sk_buff *skb, int tx_delayed, ui
     struct dwt_mcps_runtime_s *rt = dw->mcps_runtime;
     struct dw3000_deep_sleep_state *ddss = &dw->mcps_runtime->deep_sleep_state;
     hal_fs_timer_t *htimer = (hal_fs_timer_t *)dw->mcps_runtime->deep_sleep_timer;
+    struct sk_buff *tx_skb = NULL;
 
     struct dw_tx_frame_info_s txops = {.tx_date_dtu /*4ns resolution*/ = tx_date_dtu /* DTU in 4ns resolution */,
                                        .rx_delay_dly = rx_delay_dly,
@@ -472,7 +491,9 @@ int dw3000_tx_frame(struct dwchip_s *dw, struct sk_buff *skb, int tx_delayed, ui
 
     rt->corr_4ns = tx_date_dtu & 0x01; // Tx delayed set in 4ns resolution, but actual Tx is happening on the even time of 8ns
 
-    if (tx_delayed && htimer->start && !rt->need_ranging_clock && (delay_dtu - dw->llhw->shr_dtu) > min_sleep_dtu)
+    /* the frame is kept for the wake up in a pool slot: no slot, no deep sleep */
+    if (tx_delayed && htimer->start && !rt->need_ranging_clock && (delay_dtu - dw->llhw->shr_dtu) > min_sleep_dtu &&
+        (!skb || (skb->len <= SKB_POOL_DATA_LEN && (tx_skb = skb_pool_alloc()) != NULL)))
     {
         { /* implementing only deep sleep power save */
             LP_DEBUG_D0();
@@ -486,22 +507,12 @@ int dw3000_tx_frame(struct dwchip_s *dw, struct sk_buff *skb, int tx_delayed, ui
 
             memcpy(&ddss->txops, &txops, sizeof(ddss->txops));
 
-            if(skb)
+            if (tx_skb)
             {
-
-                struct sk_buff *tx_skb;
-
-                tx_skb = malloc(sizeof(struct sk_buff));
-                tx_skb->data = malloc(skb->len);
                 tx_skb->len = skb->len;
                 memcpy(tx_skb->data, skb->data, skb->len);
-
-                ddss->tx_skb = tx_skb;
-            }
-            else
-            {
-                ddss->tx_skb = NULL;
             }
+            ddss->tx_skb = tx_skb;
 
             if (rt->current_operational_state > DW3000_OP_STATE_DEEP_SLEEP)
             {
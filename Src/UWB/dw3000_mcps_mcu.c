@@ -77,8 +77,10 @@
 
 #include "dw3000_lp_mcu.h"
 #include "create_mcps_Task.h"
+#include "skb_pool.h"
 
 extern uint8_t get_local_pavrg_size(void);
+extern uint8_t get_local_pavrg_mode(void);
 extern int get_rx_ctx_size(void);
 extern uint8_t update_channel_pcode;
 
@@ -109,6 +111,138 @@ static void mcps_wakeup_mac_from_idle(void);
 
 static task_signal_t mcpsTask;
 
+_Static_assert((MCPS_RX_MSG_MAX & (MCPS_RX_MSG_MAX - 1)) == 0, "MCPS_RX_MSG_MAX must be a power of 2");
+
+/* ISR to MCPS task RX ring: the ISR (mcps_rx_cb) is the only producer, the
+ * MCPS task the only consumer. A descriptor and its data belong to the ISR
+ * until published by advancing head, then to the task until released by
+ * advancing tail. When the ring is full the ISR drops the new frame and
+ * reports an RX error instead of overwriting a pending one. */
+static struct
+{
+    dwt_mcps_rx_t desc[MCPS_RX_MSG_MAX];
+    uint8_t data[MCPS_RX_MSG_MAX][MCPS_RX_MSG_LEN];
+    uint32_t head; /* ISR: next descriptor to fill */
+    uint32_t tail; /* task: next descriptor to consume */
+    mcps_rx_ring_stats_t stats;
+} rx_ring = {.stats.depth = MCPS_RX_MSG_MAX};
+
+/* @brief task: oldest published descriptor, NULL if none */
+static dwt_mcps_rx_t *rx_ring_peek(void)
+{
+    uint32_t tail = rx_ring.tail;
+
+    if (tail == __atomic_load_n(&rx_ring.head, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
+    }
+    return &rx_ring.desc[tail & (MCPS_RX_MSG_MAX - 1)];
+}
+
+/* @brief task: give the oldest descriptor back to the ISR */
+static void rx_ring_release(void)
+{
+    __atomic_store_n(&rx_ring.tail, rx_ring.tail + 1, __ATOMIC_RELEASE);
+}
+
+void dw3000_mcps_get_rx_ring_stats(mcps_rx_ring_stats_t *stats)
+{
+    *stats = rx_ring.stats;
+}
+
+/* ISR to handler latency, per event, MCPSLAT command */
+static mcps_latency_t mcps_latency[MCPS_EVT_COUNT];
+static uint32_t mcps_post_ts[MCPS_EVT_COUNT]; /* Rtc time of the pending post */
+static uint32_t mcps_posted;                  /* bit per event: mcps_post_ts[] is pending */
+
+static void mcps_rx_drain(struct mcps802154_llhw *llhw)
+{
+    struct dwchip_s *dw = (struct dwchip_s *)llhw->priv;
+    dwt_mcps_rx_t *rx;
+
+    /* one signal may stand for several frames */
+    while ((rx = rx_ring_peek()) != NULL)
+    {
+        dw->rx = rx;
+        mcps802154_rx_frame(llhw);
+        rx_ring_release();
+    }
+}
+
+static void mcps_rx_error(struct mcps802154_llhw *llhw)
+{
+    mcps802154_rx_error(llhw, MCPS802154_RX_ERROR_OTHER);
+}
+
+/* Handled in this order when a wake carries several events: the order they
+ * happen in within an exchange, the frame events before the MAC timer. */
+static const struct
+{
+    int32_t signal;
+    void (*handler)(struct mcps802154_llhw *llhw);
+} mcps_dispatch[MCPS_EVT_COUNT] = {
+    [MCPS_EVT_TX_DONE] = {MCPS_TASK_TX_DONE, mcps802154_tx_done},
+    [MCPS_EVT_RX] = {MCPS_TASK_RX, mcps_rx_drain},
+    [MCPS_EVT_RX_TIMEOUT] = {MCPS_TASK_RX_TIMEOUT, mcps802154_rx_timeout},
+    [MCPS_EVT_RX_ERROR] = {MCPS_TASK_RX_ERROR, mcps_rx_error},
+    [MCPS_EVT_TIMER] = {MCPS_TASK_TIMER_EXPIRED, mcps802154_timer_expired},
+};
+
+/* @brief ISR or task: signal an event to the MCPS task, time stamped for
+ *        the latency histogram
+ * */
+static void mcps_post(enum mcps_evt_e evt)
+{
+    uint32_t bit = 1UL << evt;
+
+    /* keep the time of the first post not yet handled */
+    if (!(__atomic_load_n(&mcps_posted, __ATOMIC_ACQUIRE) & bit))
+    {
+        mcps_post_ts[evt] = Rtc.getTimestamp();
+        __atomic_fetch_or(&mcps_posted, bit, __ATOMIC_RELEASE);
+    }
+
+    if (osSignalSet(mcpsTask.Handle, mcps_dispatch[evt].signal) == 0x80000000)
+    {
+        error_handler(1, _ERR_Signal_Bad);
+    }
+}
+
+static void mcps_latency_add(enum mcps_evt_e evt)
+{
+    mcps_latency_t *lat = &mcps_latency[evt];
+    uint32_t ticks, bucket;
+
+    if (!(__atomic_fetch_and(&mcps_posted, ~(1UL << evt), __ATOMIC_ACQ_REL) & (1UL << evt)))
+    {
+        return;
+    }
+    ticks = Rtc.getTimeElapsed(mcps_post_ts[evt], Rtc.getTimestamp());
+
+    /* bucket 0: 0 tick, bucket i: [2^(i-1), 2^i) ticks, the last one open */
+    bucket = (ticks == 0) ? 0 : (32 - __builtin_clz(ticks));
+    if (bucket >= MCPS_LAT_BUCKETS)
+    {
+        bucket = MCPS_LAT_BUCKETS - 1;
+    }
+    lat->hist[bucket]++;
+    lat->count++;
+    if (ticks > lat->max)
+    {
+        lat->max = ticks;
+    }
+}
+
+void dw3000_mcps_get_latency(mcps_latency_t lat[MCPS_EVT_COUNT])
+{
+    memcpy(lat, mcps_latency, sizeof(mcps_latency));
+}
+
+void dw3000_mcps_reset_latency(void)
+{
+    memset(mcps_latency, 0, sizeof(mcps_latency));
+}
+
 static void McpsTask(void const *arg)
 {
     struct mcps802154_llhw *local_llhw = (struct mcps802154_llhw *)arg;
@@ -121,30 +255,15 @@ static void McpsTask(void const *arg)
         {
             break;
         }
-        else if (evt.value.signals & MCPS_TASK_TX_DONE)
-        {
-            mcps802154_tx_done(local_llhw);
-        }
-        else if (evt.value.signals & MCPS_TASK_RX_TIMEOUT)
-        {
-            mcps802154_rx_timeout(local_llhw);
-        }
-        else if (evt.value.signals & MCPS_TASK_RX_ERROR)
-        {
-            mcps802154_rx_error(local_llhw,
-                                MCPS802154_RX_ERROR_OTHER);
-        }
-        else if (evt.value.signals & MCPS_TASK_RX)
-        {
-            mcps802154_rx_frame(local_llhw);
-        }
-        else if (evt.value.signals & MCPS_TASK_TIMER_EXPIRED)
-        {
-            mcps802154_timer_expired(local_llhw);
-        }
-        else
+
+        /* the wait cleared every bit it returned: handle them all */
+        for (int i = 0; i < MCPS_EVT_COUNT; i++)
         {
-            // do nothing
+            if (evt.value.signals & mcps_dispatch[i].signal)
+            {
+                mcps_latency_add((enum mcps_evt_e)i);
+                mcps_dispatch[i].handler(local_llhw);
+            }
         }
     }
 
@@ -158,26 +277,17 @@ static void McpsTask(void const *arg)
 
 static void mcps_txdone_cb(const dwt_cb_data_t *txd)
 {
-    if (osSignalSet(mcpsTask.Handle, MCPS_TASK_TX_DONE) == 0x80000000)
-    {
-        error_handler(1, _ERR_Signal_Bad);
-    }
+    mcps_post(MCPS_EVT_TX_DONE);
 }
 
 static void mcps_rxtimeout_cb(const dwt_cb_data_t *rxd)
 {
-    if (osSignalSet(mcpsTask.Handle, MCPS_TASK_RX_TIMEOUT) == 0x80000000)
-    {
-        error_handler(1, _ERR_Signal_Bad);
-    }
+    mcps_post(MCPS_EVT_RX_TIMEOUT);
 }
 
 static void mcps_rxerror_cb(const dwt_cb_data_t *rxd)
 {
-    if (osSignalSet(mcpsTask.Handle, MCPS_TASK_RX_ERROR) == 0x80000000)
-    {
-        error_handler(1, _ERR_Signal_Bad);
-    }
+    mcps_post(MCPS_EVT_RX_ERROR);
 }
 
 /* @brief     ISR layer
@@ -186,19 +296,23 @@ static void mcps_rxerror_cb(const dwt_cb_data_t *rxd)
  * */
 static void mcps_rx_cb(const dwt_cb_data_t *rxd)
 {
-#define MAX_MSG     2
-#define MAX_MSG_LEN 128
-    static uint8_t message[MAX_MSG][MAX_MSG_LEN];
-    static dwt_mcps_rx_t rx[MAX_MSG];
-    static int idx = 0;
-
     struct dwchip_s *dw = rxd->dw;
     const struct dwt_mcps_ops_s *mcps_ops = dw->dwt_driver->dwt_mcps_ops;
     struct dwt_mcps_runtime_s *rt = dw->mcps_runtime;
 
-    struct dwt_mcps_rx_s *pRx = &rx[idx];
+    uint32_t head = rx_ring.head;
+    uint32_t pending = head - __atomic_load_n(&rx_ring.tail, __ATOMIC_ACQUIRE);
+    uint32_t idx = head & (MCPS_RX_MSG_MAX - 1);
+    struct dwt_mcps_rx_s *pRx = &rx_ring.desc[idx];
     uint64_t ts, timebase64;
 
+    if (pending >= MCPS_RX_MSG_MAX)
+    { /* the task is MCPS_RX_MSG_MAX frames behind: keep the pending ones */
+        rx_ring.stats.overruns++;
+        mcps_rxerror_cb(rxd);
+        return;
+    }
+
     pRx->rtcTimeStamp = Rtc.getTimestamp();
 
     /* RX TS in RCTU of local timebase */
@@ -213,18 +327,10 @@ static void mcps_rx_cb(const dwt_cb_data_t *rxd)
 
     if (rxd->datalength)
     {
-        pRx->len = MIN(rxd->datalength, MAX_MSG_LEN);
-        pRx->data = (uint8_t *)&message[idx];
+        pRx->len = MIN(rxd->datalength, MCPS_RX_MSG_LEN);
+        pRx->data = rx_ring.data[idx];
         struct dwt_rw_data_s rd = {(uint8_t *)pRx->data, pRx->len, 0};
         mcps_ops->ioctl(dw, DWT_READRXDATA, 0, (void *)&rd);
-
-        int16_t cfo;
-        mcps_ops->ioctl(dw, DWT_READCLOCKOFFSET, 0, (void *)&cfo);
-
-        pRx->cfo = cfo;
-        /*Below Xtal trimming can be executed in the upper layer: rx[idx].cfo*/
-        int cfo_ppm = (int)((float)cfo * (CLOCK_OFFSET_PPM_TO_RATIO * 1e6 * 100));
-        dw->mcps_runtime->diag.cfo_ppm = cfo_ppm;
     }
     else
     {
@@ -234,18 +340,22 @@ static void mcps_rx_cb(const dwt_cb_data_t *rxd)
         pRx->flags |= DW3000_RX_FLAG_ND;
     }
 
-    dw->rx = pRx;
+    /* CFO, PDOA, STS quality and diagnostics of this frame, see rx_get_frame() */
+    rx_ring.stats.reg_reads += latchStats(dw, &pRx->regs, rt->diag.enable);
 
 #if 0
     if (data->rx_flags & DW3000_CB_DATA_RX_FLAG_AAT)
             rx->flags |= DW3000_RX_FLAG_AACK;
 #endif
 
-    idx = (idx == MAX_MSG - 1) ? 0 : idx + 1;
-    if (osSignalSet(mcpsTask.Handle, MCPS_TASK_RX) == 0x80000000)
+    rx_ring.stats.frames++;
+    if (pending + 1 > rx_ring.stats.hwm)
     {
-        error_handler(1, _ERR_Signal_Bad);
+        rx_ring.stats.hwm = pending + 1;
     }
+    __atomic_store_n(&rx_ring.head, head + 1, __ATOMIC_RELEASE);
+
+    mcps_post(MCPS_EVT_RX);
 }
 
 static int dw3000_setcallbacks(struct dwchip_s *dw)
@@ -565,14 +675,11 @@ static int get_ranging_sts_fom(struct mcps802154_llhw *llhw,
                                struct mcps802154_rx_frame_info *info)
 {
     struct dwchip_s *dw = (struct dwchip_s *)llhw->priv;
-    const struct dwt_mcps_ops_s *mcps_ops = dw->dwt_driver->dwt_mcps_ops;
     dwt_config_t *config = dw->config->rxtx_config->pdwCfg;
 
     /* Max sts_acc_qual value depend on STS length */
     int sts_acc_max = 32 << config->stsLength;
-    s16 sts_acc_qual;
-
-    mcps_ops->ioctl(dw, DWT_READSTSQUALITY, 0, (void *)&sts_acc_qual);
+    s16 sts_acc_qual = dw->rx->regs.sts_qual;
 
     /* DW3000 only support one STS segment. */
     info->ranging_sts_fom[0] = (uint8_t)(CLAMP(1 + sts_acc_qual * 254 / sts_acc_max, 1, 255));
@@ -598,7 +705,8 @@ static int rx_get_frame(struct mcps802154_llhw *llhw, struct sk_buff **skb,
         goto error;
     }
 
-    struct sk_buff *local_skb = malloc(sizeof(struct sk_buff));
+    /* released by the MAC with kfree_skb(), see skb_pool_release() */
+    struct sk_buff *local_skb = skb_pool_alloc();
     *skb = local_skb;
 
     /* Check buffer available */
@@ -617,14 +725,19 @@ static int rx_get_frame(struct mcps802154_llhw *llhw, struct sk_buff **skb,
         info->timestamp_rctu = rx->timeStamp - dw->config->rxtx_config->rxAntDelay;
         info->timestamp_dtu = timestamp_rctu_to_dtu(dw, rx->timeStamp) - llhw->shr_dtu;
 
-        if (dw->mcps_runtime->diag.enable)
+        if (dw->mcps_runtime->diag.enable && rx->regs.diag)
         {
-            calculateStats(dw, &dw->mcps_runtime->diag);
+            /* computed only when a report asks for it, fira_uwb_get_diag() */
+            dw->mcps_runtime->diag.raw = rx->regs.raw;
+            dw->mcps_runtime->diag.pending = true;
         }
     }
 
     if (!(rx->flags & DW3000_RX_FLAG_ND))
     {
+        /* CFO of this frame, read by the ISR */
+        dw->mcps_runtime->diag.cfo_ppm = (int)((float)rx->regs.cfo * (CLOCK_OFFSET_PPM_TO_RATIO * 1e6 * 100));
+
         /* Adjust Clock offset after RX of SP0/SP1 packets only */
         trim_XTAL_proc(dw, &dw->config->xtalTrim, dw->mcps_runtime->diag.cfo_ppm);
     }
@@ -679,9 +792,7 @@ static int rx_get_frame(struct mcps802154_llhw *llhw, struct sk_buff **skb,
 
     if (info->flags & MCPS802154_RX_FRAME_INFO_RANGING_OFFSET)
     {
-        int16_t cfo;
-        dw->dwt_driver->dwt_mcps_ops->ioctl(dw, DWT_READCLOCKOFFSET, 0, (void *)&cfo);
-        info->ranging_offset_rctu = cfo;
+        info->ranging_offset_rctu = rx->regs.cfo;
         /* DW3000 provide directly the ratio (as Q26), so set arbitrarily the ranging
          * interval (denominator) to 1 */
         info->ranging_tracking_interval_rctu = 1 << 26;
@@ -699,7 +810,7 @@ static int rx_get_frame(struct mcps802154_llhw *llhw, struct sk_buff **skb,
 
     if ((*skb)->len == 0)
     {
-        free(*skb);
+        skb_pool_free(*skb);
         *skb = NULL;
     }
 
@@ -721,7 +832,8 @@ static int rx_get_measurement(struct mcps802154_llhw *llhw, void *rx_ctx,
 
     if (hal_uwb.is_aoa() == AOA_ENABLED && info->flags & MCPS802154_RX_MEASUREMENTS_AOAS)
     {
-        info->aoas[0].pdoa_rad_q11 = dw3000_readpdoa(dw);
+        /* PDOA of the frame of rx_get_frame(), read by the ISR */
+        info->aoas[0].pdoa_rad_q11 = dw->rx->regs.pdoa;
         info->n_aoas = 1;
 
         /* rx_ctx is the allocated buffer used for AoA calculation */
@@ -733,6 +845,7 @@ static int rx_get_measurement(struct mcps802154_llhw *llhw, void *rx_ctx,
             in.chan = config->chan;
             in.corr_en = 1;
             in.max_avrg = get_local_pavrg_size();
+            in.avrg_mode = get_local_pavrg_mode();
             in.pdoa_q11 = info->aoas[0].pdoa_rad_q11;
             in.p_deg100 = 100 * (int32_t)((float)(in.pdoa_q11 / 2048.f) * 180.f / M_PI);
 
@@ -1572,8 +1685,5 @@ void dw3000_mcps_unregister(struct dwchip_s *dw)
 
 void mcps_wakeup_mac_from_idle(void)
 {
-    if (osSignalSet(mcpsTask.Handle, MCPS_TASK_TIMER_EXPIRED) == 0x80000000)
-    {
-        error_handler(1, _ERR_Signal_Bad);
-    }
+    mcps_post(MCPS_EVT_TIMER);
 }
\ No newline at end of file
@@ -96,6 +96,44 @@ struct dw3000_deep_sleep_state
     };
 };
 
+#ifndef MCPS_RX_MSG_MAX
+#define MCPS_RX_MSG_MAX     4   /**< depth of the ISR to MCPS task RX ring, power of 2 */
+#endif
+#define MCPS_RX_MSG_LEN     128 /**< largest frame kept by the ISR */
+
+/* CIR diagnostics of one frame, as read at RX */
+struct mcps_diag_cir_s
+{
+    uint32_t accum_count; /* preamble symbols accumulated, or STS length */
+    uint32_t f[3];        /* first path amplitudes, 2 fractional bits */
+    uint32_t cir_power;
+};
+
+/* Diagnostic registers latched at RX, turned into RSSI/NLOS on demand */
+struct mcps_diag_raw_s
+{
+    struct mcps_diag_cir_s cir[3]; /* IPATOV, STS1, STS2 */
+    uint32_t index_fp;             /* IPATOV first path index */
+    uint32_t index_pp;             /* IPATOV peak path index */
+    uint8_t dgc_decision;
+    uint8_t prf64;                 /* IPATOV on the 64 MHz PRF codes */
+    uint8_t dw3000;                /* DW3000 log constant (C0), else D0/E0 */
+    uint8_t sts_on;
+    uint8_t pdoa_m3;
+};
+
+/* Result registers of one frame, read by the ISR in a few block reads while
+ * the SPI burst of the IRQ is open: the MCPS task uses them instead of going
+ * back to the chip, which by then may be receiving the next frame */
+struct dwt_mcps_rx_regs_s
+{
+    int16_t cfo;                /* clock offset, Q26 ratio */
+    int16_t pdoa;               /* [1:-11] radian */
+    int16_t sts_qual;           /* STS accumulation quality, 0 with STS off */
+    bool diag;                  /* raw holds this frame, diagnostics enabled */
+    struct mcps_diag_raw_s raw;
+};
+
 struct dwt_mcps_rx_s
 {
     uint64_t timeStamp; /* Full TimeStamp */
@@ -103,15 +141,50 @@ struct dwt_mcps_rx_s
     uint32_t flags;
     uint8_t *data;
     unsigned int len;
-    int16_t cfo;
+    struct dwt_mcps_rx_regs_s regs;
 };
 typedef struct dwt_mcps_rx_s dwt_mcps_rx_t;
 
+/* ISR to MCPS task RX ring statistics, STAT command */
+struct mcps_rx_ring_stats_s
+{
+    uint32_t depth;     /* descriptors in the ring */
+    uint32_t frames;    /* frames queued by the ISR */
+    uint32_t overruns;  /* frames dropped by the ISR, ring full */
+    uint32_t hwm;       /* most descriptors pending at once */
+    uint32_t reg_reads; /* SPI reads of the result registers, all frames */
+};
+typedef struct mcps_rx_ring_stats_s mcps_rx_ring_stats_t;
+
+/* Events of the MCPS task, in the order they are handled within one wake */
+enum mcps_evt_e
+{
+    MCPS_EVT_TX_DONE = 0,
+    MCPS_EVT_RX,
+    MCPS_EVT_RX_TIMEOUT,
+    MCPS_EVT_RX_ERROR,
+    MCPS_EVT_TIMER,
+    MCPS_EVT_COUNT
+};
+
+#define MCPS_LAT_BUCKETS    10 /* 0, 1, 2-3, 4-7, ... 256+ Rtc ticks (30.5 us) */
+
+/* ISR to handler latency of one event, MCPSLAT command */
+struct mcps_latency_s
+{
+    uint32_t count;
+    uint32_t max;                       /* Rtc ticks */
+    uint32_t hist[MCPS_LAT_BUCKETS];
+};
+typedef struct mcps_latency_s mcps_latency_t;
+
 struct mcps_diag_s
 {
     bool enable;
-    float rssi;
-    float non_line_of_sight;
+    bool pending;       /* raw latched, rssi_mdbm/nlos_pct not computed yet */
+    int32_t rssi_mdbm;  /* IPATOV receive signal level, 0.001 dBm */
+    uint8_t nlos_pct;   /* probability of non line of sight */
+    struct mcps_diag_raw_s raw;
     int32_t cfo_ppm;
     uint32_t CIA_TDOA;
 };
@@ -147,5 +220,8 @@ struct dwchip_s *dw3000_mcps_alloc(void);
 int dw3000_mcps_register(struct dwchip_s *dw);
 void dw3000_mcps_unregister(struct dwchip_s *dw);
 void dw3000_mcps_free(struct dwchip_s *dw);
+void dw3000_mcps_get_rx_ring_stats(mcps_rx_ring_stats_t *stats);
+void dw3000_mcps_get_latency(mcps_latency_t lat[MCPS_EVT_COUNT]);
+void dw3000_mcps_reset_latency(void);
 
 #endif /* __DW3000_MCPS_MCU_H */
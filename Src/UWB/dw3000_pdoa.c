@@ -52,163 +52,40 @@
 
 /* Current implementation characterized for the ML-1.0 antenna */
 
-#include <math.h>
+/* The whole path is integer: PDoA in deg*100, the path difference as a Q30
+ * fraction of the antenna distance and angles in Q15 rad. The characterization
+ * tables are generated by tools/pdoa_lut_gen.py into dw3000_pdoa_lut.h.
+ */
+
 #include <stdlib.h>
 
 #include "dw3000_pdoa.h"
+#include "dw3000_pdoa_lut.h"
 #include "rf_tuning_config.h"
 
-/* clang-format off */
-/* MONALISA CHANNEL 5 */
-#if 0 // PDOA_M3
-    static const double xs_mon_ch5_m3[] = { -169.52599388379204, -164.55029585798817 , -160.03367003367003  , -155.23640661938535 , 
-                                            -150.56637168141592, -145.09003215434083 , -138.81159420289856  , -130.99603174603175 , 
-                                            -123.18204488778055, -113.84177215189874 , -102.67299107142857  ,  -91.66666666666667 , 
-                                             -78.92921686746988,  -66.17794486215539 ,  -52.489329268292686 ,  -38.47277936962751 , 
-                                             -25.19344262295082,  -10.773413897280967,    0.9860681114551083,   15.321236559139784, 
-                                              31.16460396039604,   46.739010989010985,   62.48295454545455  ,   79.0              , 
-                                              93.02919708029196,  105.17538461538462 ,  116.59448818897638  ,  125.65702479338843 , 
-                                             135.40189873417722,  142.97699386503066 ,  151.34635416666666  ,  158.2935656836461  , 
-                                             165.31201044386424,  172.39769820971867 ,  180.0               ,  188.23993808049536 ,
-                                             198.43213296398892 };
-    static const double ys_mon_ch5_m3[] = { -0.02277711059704047  , -0.022690436814620973 , -0.022431075107181914, -0.022000999373923726,
-                                            -0.0214034827508634   , -0.020643072700292697 , -0.019725556401844816, -0.018657916708562303,
-                                            -0.01744827900316916  , -0.016105849359003235 , -0.014640844476237574, -0.01306441392662416 ,
-                                            -0.011388555298520233 , -0.009626022887996853 , -0.007790230630944395, -0.005895150014920516,
-                                            -0.003955203747694204 , -0.0019851559917306244,  0.0                 ,  0.001985155991730628, 
-                                             0.0039552037476942034,  0.005895150014920523 ,  0.007790230630944404,  0.009626022887996888, 
-                                             0.011388555298520233 ,  0.013064413926624103 ,  0.014640844476237608,  0.01610584935900323 ,   
-                                             0.017448279003169222 ,  0.018657916708562265 ,  0.019725556401844816,  0.02064307270029269 ,   
-                                             0.021403482750863533 ,  0.02200099937392368  ,  0.02243107510718191 ,  0.02269043681462098 ,
-                                             0.022777110597040465 };
-#else // PDOA_M1
-    static const double xs_mon_ch5_m1[] = { -167.451, -166.592, -165.733, -161.641,
-                                            -157.549, -150.116, -142.683, -134.165,
-                                            -125.647, -116.942, -108.238,  -97.992,
-                                             -87.746,  -75.604,  -63.462,  -48.720,
-                                             -33.978,  -16.989,    0.0  ,   19.145,
-                                              38.290,   55.524,   72.759,   86.546,
-                                             100.333,  110.570,  120.808,  129.769,
-                                             138.731,  146.481,  154.231,  161.072,
-                                             167.913,  173.938,  179.963,  185.898,
-                                             191.834 };
-    static const double ys_mon_ch5_m1[] = { -0.02277711, -0.02259527, -0.02243108, -0.02183519, 
-                                            -0.02140348, -0.02060275, -0.01972556, -0.01864569, 
-                                            -0.01744828, -0.01607664, -0.01464084, -0.01298905, 
-                                            -0.01138856, -0.00954588, -0.00779023, -0.00581025, 
-                                            -0.0039552 , -0.00191495,  0.0       ,  0.00199575,
-                                             0.0039552 ,  0.00581256,  0.00779023,  0.00948489,  
-                                             0.01138856,  0.01298333,  0.01464084,  0.01606225,  
-                                             0.01744828,  0.01861804,  0.01972556,  0.02061772,  
-                                             0.02140348,  0.02198524,  0.02243108,  0.02270353,  
-                                             0.02277711 };
-#endif
-
-/* MONALISA CHANNEL 9 */
-#if 0 //PDOA_M3
-    static const double xs_mon_ch9_m3[] = { -182.178     , -172.91577143, -163.65354286, -154.39131429,
-                                            -145.12908571, -135.86685714, -126.60462857, -117.3424    ,
-                                            -108.08017143,  -98.81794286,  -89.55571429,  -80.29348571,
-                                             -71.03125714,  -61.76902857,  -52.5068    ,  -43.24457143,
-                                             -33.98234286,  -24.72011429,  -15.45788571,   -6.19565714,
-                                               3.06657143,   12.3288    ,   21.59102857,   30.85325714,
-                                              40.11548571,   49.37771429,   58.63994286,   67.90217143,
-                                              77.1644    ,   86.42662857,   95.68885714,  104.95108571,
-                                             114.21331429,  123.47554286,  132.73777143,  142.         };
-    static const double ys_mon_ch9_m3[] = { -0.0178831 , -0.01753701, -0.01681944, -0.01530936, 
-                                            -0.0133346 , -0.01188188, -0.01064578, -0.0094633 , 
-                                            -0.008383  , -0.00741476, -0.00653003, -0.00569933, 
-                                            -0.00490387, -0.00413532, -0.00338581, -0.00264728, 
-                                            -0.00190919, -0.00115921, -0.00038495,  0.00042524,
-                                             0.0012678 ,  0.00212467,  0.00297723,  0.00381115,  
-                                             0.00463958,  0.00548639,  0.00637547,  0.00732847,  
-                                             0.00836314,  0.00949486,  0.0106894 ,  0.01186556,  
-                                             0.01331466,  0.01548235,  0.0166216 ,  0.01761142 };
-#else //PDOA_M1
-    static const double xs_mon_ch9_m1[] = { -169.84426         , -167.11048, -158.87248000000002 , -149.57176          , 
-                                            -137.69556         , -119.09592,  -92.6935           ,  -62.443799999999996,
-                                             -33.2075          ,    0.0    ,   32.961839999999995,   64.67824          , 
-                                              88.73612         ,  108.79534,  124.74589999999999 ,  137.60603999999998 ,
-                                             147.50220000000002,  161.44412,  176.59868 };
-    static const double ys_mon_ch9_m1[] = { -0.0178831 , -0.01761142, -0.01680462, -0.01548722, 
-                                            -0.01369925, -0.01149504, -0.00894155, -0.00611638,
-                                            -0.00310537,  0.0       ,  0.00310537,  0.00611638,  
-                                             0.00894155,  0.01149504,  0.01369925,  0.01548722, 
-                                             0.01680462,  0.01761142,  0.0178831 };
-#endif
-
-/* JOLIE CHANNEL 5 */
-static const double qm33_jolie_ch5_lut_x[] = {-166.27930196, -157.0024225, -149.55838501, -142.14051332,
-                                            -134.46269704, -127.8210698, -120.92711554, -112.43367106,
-                                            -105.30918511, -96.76697129, -87.82458557, -77.72606262,
-                                            -66.55387036, -55.00572544, -43.65803963, -31.48916832,
-                                            -20.65986893, -10.09601225, 0.0, 8.59879892,
-                                            19.13709153, 29.43074745, 40.56982151, 52.54895667,
-                                            64.78731337, 78.42224659, 92.09874303, 105.79844189,
-                                            118.66624366, 130.41513253, 141.06896151, 150.62280441,
-                                            157.97588953, 164.74276625, 170.5402407, 175.70974943,
-                                            178.43237117};
-
-static const double qm33_jolie_ch5_lut_y[] = {-0.0178831, -0.01781505, -0.01761142, -0.01727375,
-                                            -0.01680462, -0.0162076, -0.01548722, -0.01464898,
-                                            -0.01369925, -0.01264526, -0.01149504, -0.01025733,
-                                            -0.00894155, -0.00755773, -0.00611638, -0.00462849,
-                                            -0.00310537, -0.00155862, 0.0, 0.00155862,
-                                            0.00310537, 0.00462849, 0.00611638, 0.00755773,
-                                            0.00894155, 0.01025733, 0.01149504, 0.01264526,
-                                            0.01369925, 0.01464898, 0.01548722, 0.0162076,
-                                            0.01680462, 0.01727375, 0.01761142, 0.01781505,
-                                            0.0178831};
-
-/* JOLIE CHANNEL 9 */
-static const double qm33_jolie_ch9_lut_x[] = {-194.26382249, -189.94444242, -185.54389927, -179.72945707,
-                                            -174.20326737, -166.48234994, -157.16712186, -146.40031499,
-                                            -134.50440281, -121.27737905, -108.1319426, -94.45667093,
-                                            -80.22686509, -66.92952722, -53.29020472, -40.52899653,
-                                            -26.72033914, -12.96053113, 0.0, 13.25819423,
-                                            26.3242237, 40.06032733, 52.92500285, 65.90989195,
-                                            77.3400328, 89.12909447, 99.33491395, 109.34396358,
-                                            118.4741959, 127.76385629, 136.24735635, 143.07957935,
-                                            149.31089476, 155.68400588, 160.27201659, 163.69689225,
-                                            165.76697029};
-
-static const double qm33_jolie_ch9_lut_y[] = {-0.0178831, -0.01781505, -0.01761142, -0.01727375,
-                                            -0.01680462, -0.0162076, -0.01548722, -0.01464898,
-                                            -0.01369925, -0.01264526, -0.01149504, -0.01025733,
-                                            -0.00894155, -0.00755773, -0.00611638, -0.00462849,
-                                            -0.00310537, -0.00155862, 0.0, 0.00155862,
-                                            0.00310537, 0.00462849, 0.00611638, 0.00755773,
-                                            0.00894155, 0.01025733, 0.01149504, 0.01264526,
-                                            0.01369925, 0.01464898, 0.01548722, 0.0162076,
-                                            0.01680462, 0.01727375, 0.01761142, 0.01781505,
-                                            0.0178831};
-
-/* CUSTOM */
-static const double xs_cst_chn_m1[] = { -182.178     , -172.91577143, -163.65354286, -154.39131429,
-                                        -145.12908571, -135.86685714, -126.60462857, -117.3424    ,
-                                        -108.08017143,  -98.81794286,  -89.55571429,  -80.29348571,
-                                         -71.03125714,  -61.76902857,  -52.5068    ,  -43.24457143,
-                                         -33.98234286,  -24.72011429,  -15.45788571,   -6.19565714,
-                                           3.06657143,   12.3288    ,   21.59102857,   30.85325714,
-                                          40.11548571,   49.37771429,   58.63994286,   67.90217143,
-                                          77.1644    ,   86.42662857,   95.68885714,  104.95108571,
-                                         114.21331429,  123.47554286,  132.73777143,  142.         };
-static const double ys_cst_chn_m1[] = { -0.0178831 , -0.01753701, -0.01681944, -0.01530936, 
-                                        -0.0133346 , -0.01188188, -0.01064578, -0.0094633 , 
-                                        -0.008383  , -0.00741476, -0.00653003, -0.00569933, 
-                                        -0.00490387, -0.00413532, -0.00338581, -0.00264728, 
-                                        -0.00190919, -0.00115921, -0.00038495,  0.00042524,
-                                         0.0012678 ,  0.00212467,  0.00297723,  0.00381115,  
-                                         0.00463958,  0.00548639,  0.00637547,  0.00732847,  
-                                         0.00836314,  0.00949486,  0.0106894 ,  0.01186556,  
-                                         0.01331466,  0.01548235,  0.0166216 ,  0.01761142 };
-/* clang-format on */
-
-const static double *xs;
-const static double *ys;
-static int local_lut_size = -1;
-
-/* Set XS and YS pointers to the correct LUT based on the antenna type */
+#define Q30_ONE                 (1L << 30)
+#define PDOA_LUT_X_FRAC_BITS    4           /* struct pdoa_lut_s x[] */
+#define PI_2_Q15                (51472)     /* pi/2, rad, Q15 */
+#define PI_Q15                  (102944)    /* pi, rad, Q15 */
+
+/* 2^15 / 36000 * 2^16, deg*100 in [0, 36000) to 1/65536 of a turn, Q15 */
+#define DEG100_TO_TURN16_Q15    (59652)
+/* 18000 / pi / 2^15 * 2^16, rad Q15 to deg*100, Q16 */
+#define RAD_Q15_TO_DEG100_Q16   (11459)
+
+/* 2048 * pi / 18000, deg*100 to rad Q11, Q16 */
+#define DEG100_TO_Q11_Q16       ((int32_t)(2048.0 * M_PI / 18000.0 * 65536.0 + 0.5))
+
+/* Path difference / D_M_JL per deg*100 of PDoA without the LUT, Q30 */
+#define PDIFF_RATIO_CH5_Q30     ((int32_t)(L_M_5 / D_M_JL / 36000.0 * Q30_ONE + 0.5))
+#define PDIFF_RATIO_CH9_Q30     ((int32_t)(L_M_9 / D_M_JL / 36000.0 * Q30_ONE + 0.5))
+
+#define PDOA_SHIFT_CH5_DEG100   ((int32_t)(PDOA_INTERVAL_SHIFT_CH5 * 100))
+#define PDOA_SHIFT_CH9_DEG100   ((int32_t)(PDOA_INTERVAL_SHIFT_CH9 * 100))
+
+static const struct pdoa_lut_s *local_lut = NULL;
+
+/* Set the LUT based on the antenna type */
 void pdoaupdate_lut(void)
 {
     rf_tuning_t *rf_tuning = get_rf_tuning_config();
@@ -219,107 +96,277 @@ void pdoaupdate_lut(void)
     case ANT_TYPE_MAN5:
     case ANT_TYPE_CPWING5:
     case ANT_TYPE_CPWING9:
-        local_lut_size = -1;
+        local_lut = NULL;
         break;
     case ANT_TYPE_MONALISA5:
-        xs = xs_mon_ch5_m1;
-        ys = ys_mon_ch5_m1;
-        local_lut_size = sizeof(xs_mon_ch5_m1) / sizeof(xs_mon_ch5_m1[0]);
+        local_lut = &pdoa_lut_mon_ch5;
         break;
     case ANT_TYPE_MONALISA9:
-        xs = xs_mon_ch9_m1;
-        ys = ys_mon_ch9_m1;
-        local_lut_size = sizeof(xs_mon_ch9_m1) / sizeof(xs_mon_ch9_m1[0]);
+        local_lut = &pdoa_lut_mon_ch9;
         break;
     case ANT_TYPE_JOLIE5:
-        xs = qm33_jolie_ch5_lut_x;
-        ys = qm33_jolie_ch5_lut_y;
-        local_lut_size = sizeof(qm33_jolie_ch5_lut_x) / sizeof(qm33_jolie_ch5_lut_x[0]);
+        local_lut = &pdoa_lut_jolie_ch5;
         break;
     case ANT_TYPE_JOLIE9:
-        xs = qm33_jolie_ch9_lut_x;
-        ys = qm33_jolie_ch9_lut_y;
-        local_lut_size = sizeof(qm33_jolie_ch9_lut_x) / sizeof(qm33_jolie_ch9_lut_x[0]);
+        local_lut = &pdoa_lut_jolie_ch9;
         break;
     case ANT_TYPE_CUSTOM:
-        xs = xs_cst_chn_m1;
-        ys = ys_cst_chn_m1;
-        local_lut_size = sizeof(xs_cst_chn_m1) / sizeof(xs_cst_chn_m1[0]);
+        local_lut = &pdoa_lut_cst_chn;
         break;
     default:
         break;
     }
 }
 
-static double pdoa2path_diff(float x)
+/* @brief path difference / D_M_JL, Q30, from the LUT
+ */
+static int32_t pdoa2path_diff(int32_t pdoa_deg100)
 {
+    const struct pdoa_lut_s *lut = local_lut;
+    int32_t x = pdoa_deg100 * (1 << PDOA_LUT_X_FRAC_BITS);
     int i;
-    double dx, dy;
 
-    /* Check if the pointers are initialised*/
-    if (local_lut_size == -1)
+    /* Check if the LUT is set */
+    if (lut == NULL)
     {
         return 0;
     }
 
-    if (x < xs[0])
+    if (x <= lut->x[0])
+    {
+        return lut->r[0]; /* return minimum element */
+    }
+
+    if (x >= lut->x[lut->n - 1])
+    {
+        return lut->r[lut->n - 1]; /* return maximum */
+    }
+
+    /* find i, such that x[i] <= x < x[i+1], a couple of steps from the bucket start */
+    i = lut->bucket[(x - lut->x[0]) >> lut->shift];
+    while (lut->x[i + 1] <= x)
     {
-        return ys[0]; /* return minimum element */
+        i++;
     }
 
-    if (x > xs[local_lut_size - 1])
+    /* interpolate */
+    return lut->r[i] + (int32_t)(((int64_t)lut->slope[i] * (x - lut->x[i])) >> PDOA_LUT_X_FRAC_BITS);
+}
+
+static uint32_t isqrt32(uint32_t v)
+{
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > v)
     {
-        return ys[local_lut_size - 1]; /* return maximum */
+        bit >>= 2;
     }
 
-    /* find i, such that xs[i] <= x < xs[i+1] */
-    for (i = 0; i < local_lut_size - 1; i++)
+    while (bit != 0)
     {
-        if (xs[i + 1] > x)
+        if (v >= res + bit)
         {
-            break;
+            v -= res + bit;
+            res = (res >> 1) + bit;
         }
+        else
+        {
+            res >>= 1;
+        }
+        bit >>= 2;
     }
+    return res;
+}
 
-    /* interpolate */
-    dx = xs[i + 1] - xs[i];
-    dy = ys[i + 1] - ys[i];
-    return ys[i] + (x - xs[i]) * dy / dx;
+/* @brief atan(z), z in [0, 1] Q15, rad Q15
+ */
+static int32_t atan_q15(uint32_t z)
+{
+    uint32_t idx = z >> (15 - PDOA_ATAN_LUT_BITS);
+    uint32_t frac = z & ((1UL << (15 - PDOA_ATAN_LUT_BITS)) - 1);
+
+    if (idx >= (1UL << PDOA_ATAN_LUT_BITS))
+    {
+        return pdoa_atan_lut_q15[1 << PDOA_ATAN_LUT_BITS];
+    }
+    return pdoa_atan_lut_q15[idx] +
+           (((pdoa_atan_lut_q15[idx + 1] - pdoa_atan_lut_q15[idx]) * (int32_t)frac) >> (15 - PDOA_ATAN_LUT_BITS));
+}
+
+/* @brief atan2(y, x), rad Q15 in [-pi, pi]
+ */
+static int32_t atan2_q15(int32_t y, int32_t x)
+{
+    uint32_t ay = (uint32_t)abs(y);
+    uint32_t ax = (uint32_t)abs(x);
+    int32_t ang;
+
+    if ((ax | ay) == 0)
+    {
+        return 0;
+    }
+
+    /* keep (min << 15) in 32 bits */
+    while ((ax | ay) > 0xFFFF)
+    {
+        ax >>= 1;
+        ay >>= 1;
+    }
+
+    if (ay <= ax)
+    {
+        ang = atan_q15((ay << 15) / ax);
+    }
+    else
+    {
+        ang = PI_2_Q15 - atan_q15((ax << 15) / ay);
+    }
+
+    if (x < 0)
+    {
+        ang = PI_Q15 - ang;
+    }
+    return (y < 0) ? -ang : ang;
+}
+
+/* @brief sin(a), a in deg*100, Q15
+ */
+static int32_t sin_q15(int32_t deg100)
+{
+    uint32_t turn, a, idx, frac;
+    int32_t s;
+
+    deg100 %= 36000;
+    if (deg100 < 0)
+    {
+        deg100 += 36000;
+    }
+    turn = ((uint32_t)deg100 * DEG100_TO_TURN16_Q15) >> 15;
+
+    /* quarter wave table */
+    a = turn & 0x3FFF;
+    if (turn & 0x4000)
+    {
+        a = 0x4000 - a;
+    }
+    idx = a >> (14 - PDOA_SIN_LUT_BITS);
+    frac = a & ((1UL << (14 - PDOA_SIN_LUT_BITS)) - 1);
+
+    s = pdoa_sin_lut_q15[idx];
+    if (frac)
+    {
+        s += ((pdoa_sin_lut_q15[idx + 1] - s) * (int32_t)frac) >> (14 - PDOA_SIN_LUT_BITS);
+    }
+    return (turn & 0x8000) ? -s : s;
+}
+
+static int32_t cos_q15(int32_t deg100)
+{
+    return sin_q15(deg100 + 9000);
+}
+
+/* @brief AoA = atan2(r, sqrt(1 - r^2)), r in [-1, 1] Q30, rad Q11
+ */
+static int16_t ratio2aoa_q11(int32_t r)
+{
+    uint32_t a = (uint32_t)abs(r);
+    uint32_t y;
+    int32_t ang;
+
+    if (a > Q30_ONE)
+    {
+        a = Q30_ONE;
+    }
+
+    /* sqrt(1 - r^2), Q15: (1 - r)(1 + r) keeps the precision where r is close to +/-1 */
+    y = isqrt32((uint32_t)(((uint64_t)(Q30_ONE - a) * (Q30_ONE + a)) >> 30));
+    a >>= 15;
+
+    ang = atan2_q15((int32_t)a, (int32_t)y) >> 4;
+    return (int16_t)((r < 0) ? -ang : ang);
 }
 
 //-----------------------------------------------------------------------------
-static void fpdoaaverage(float *inout, struct avrg_s *p)
+/* @brief add (sign 1) or remove (sign -1) a sample from the window sums
+ */
+static void fpdoaaverage_update(struct avrg_s *p, int32_t v, int sign)
 {
-    float accum = 0.f;
-    int tmp_cnt = 0;
+    if (p->mode == PDOA_AVRG_CIRCULAR)
+    {
+        p->sum_sin += sign * sin_q15(v);
+        p->sum_cos += sign * cos_q15(v);
+    }
+    else if (v < 0)
+    {
+        p->sum_neg += sign * v;
+        p->cnt_neg += sign;
+    }
+    else
+    {
+        p->sum_pos += sign * v;
+        p->cnt_pos += sign;
+    }
+}
+
+/* @brief Sliding window average of the PDoA, O(1) per sample
+ *
+ * Linear mode: the mean of the window, or beyond +/-130 deg of the samples
+ * of the same sign as the new one only, so that a window straddling +/-180
+ * does not average to 0. Circular mode: the circular mean, taken close to
+ * the new sample.
+ */
+static void fpdoaaverage(int32_t *inout, struct avrg_s *p)
+{
+    int32_t v = *inout;
+    int32_t accum;
+    int tmp_cnt;
 
     if (p->lcnt >= p->avrg_max)
     {
         p->lcnt = 0;
     }
 
-    p->max_cnt = (p->max_cnt < p->avrg_max) ? (p->max_cnt + 1) : (p->avrg_max);
-
-    if (p->max_cnt > 0)
+    if (p->avrg_max > 0)
     {
-        p->avrg[p->lcnt] = *inout;
-        for (int i = 0; i < p->max_cnt; i++)
+        if (p->max_cnt < p->avrg_max)
         {
-            if (abs(p->avrg[p->lcnt]) > 130)
-            { // average in the array of the same sign as avrg[lcnt]
-                if ((p->avrg[p->lcnt] < 0 && p->avrg[i] < 0) || (p->avrg[p->lcnt] >= 0 && p->avrg[i] >= 0))
-                {
-                    accum += p->avrg[i];
-                    tmp_cnt++;
-                }
+            p->max_cnt++;
+        }
+        else
+        { /* window full: the oldest sample leaves */
+            fpdoaaverage_update(p, p->avrg[p->lcnt], -1);
+        }
+        p->avrg[p->lcnt] = v;
+        fpdoaaverage_update(p, v, 1);
+
+        if (p->mode == PDOA_AVRG_CIRCULAR)
+        {
+            accum = (atan2_q15(p->sum_sin, p->sum_cos) * RAD_Q15_TO_DEG100_Q16) / 65536;
+            if (accum - v > 18000)
+            {
+                accum -= 36000;
+            }
+            else if (accum - v < -18000)
+            {
+                accum += 36000;
+            }
+        }
+        else
+        {
+            if (abs(v / 100) > 130)
+            { // average in the array of the same sign as v
+                accum = (v < 0) ? p->sum_neg : p->sum_pos;
+                tmp_cnt = (v < 0) ? p->cnt_neg : p->cnt_pos;
             }
             else
             {
-                accum += p->avrg[i];
-                tmp_cnt++;
+                accum = p->sum_neg + p->sum_pos;
+                tmp_cnt = p->cnt_neg + p->cnt_pos;
             }
+            /* rounded to the nearest */
+            accum = (accum >= 0) ? ((accum + tmp_cnt / 2) / tmp_cnt) : ((accum - tmp_cnt / 2) / tmp_cnt);
         }
-        accum /= tmp_cnt;
         *inout = accum;
     }
     p->lcnt++;
@@ -331,64 +378,53 @@ static void fpdoaaverage(float *inout, struct avrg_s *p)
  */
 void fpdoa2aoa(struct fpdoa_in_s *pIn, struct pdoa_aoa_s *pRes, void *rx_ctx)
 {
-    float x_m, y_m, l_m, d_m;
-    float p_diff_m; /* Path difference between the ports (m). */
+    int32_t ratio; /* Path difference between the ports / D_M_JL, Q30 */
+    int32_t shift_deg100;
+    int32_t ratio_per_deg100;
 
     struct avrg_s *pavrg = (struct avrg_s *)rx_ctx;
-    float pdoa_deg = (float)pIn->p_deg100 / 100.f;
+    int32_t pdoa_deg100 = pIn->p_deg100;
 
     if (pavrg->avrg_max == 0)
     { /* initializing of pavrg struct */
         pavrg->avrg_max = pIn->max_avrg;
+        pavrg->mode = pIn->avrg_mode;
         /* avrg buff allocated on the next address after pavrg->avrg */
-        pavrg->avrg = (float *)((int)pavrg + (int)sizeof(struct avrg_s));
+        pavrg->avrg = (int32_t *)(pavrg + 1);
     }
 
     if (pIn->chan == 5)
     {
-        l_m = L_M_5;
-        d_m = D_M_JL;
-
-        /* Shift the range of PDOAs out of the board */
-        pdoa_deg = fmodf(pdoa_deg - PDOA_INTERVAL_SHIFT_CH5 + 540.0f, 360.0f) + PDOA_INTERVAL_SHIFT_CH5 - 180.0f;
+        shift_deg100 = PDOA_SHIFT_CH5_DEG100;
+        ratio_per_deg100 = PDIFF_RATIO_CH5_Q30;
     }
     else
     {
-        l_m = L_M_9;
-        d_m = D_M_JL;
-
-        /* Shift the range of PDOAs out of the board */
-        pdoa_deg = fmodf(pdoa_deg - PDOA_INTERVAL_SHIFT_CH9 + 540.0f, 360.0f) + PDOA_INTERVAL_SHIFT_CH9 - 180.0f;
+        shift_deg100 = PDOA_SHIFT_CH9_DEG100;
+        ratio_per_deg100 = PDIFF_RATIO_CH9_Q30;
     }
 
-    if ((abs(pdoa_deg) > 130.0f) && (pdoa_deg * pavrg->prev_avrg < 0.0f))
+    /* Shift the range of PDOAs out of the board */
+    pdoa_deg100 = ((pdoa_deg100 - shift_deg100 + 54000) % 36000) + shift_deg100 - 18000;
+
+    if ((abs(pdoa_deg100 / 100) > 130) && ((int64_t)pdoa_deg100 * pavrg->prev_avrg < 0))
     { // if current value has different sign from prev average, use the original value;
-        pdoa_deg = (float)pIn->p_deg100 / 100.f;
-        // the same as
-        // pdoa_deg = fmod(pdoa_deg - prev_avrg + 540.0f, 360.0f) + prev_avrg - 180.0f;
+        pdoa_deg100 = pIn->p_deg100;
     }
 
-    fpdoaaverage(&pdoa_deg, pavrg);
+    fpdoaaverage(&pdoa_deg100, pavrg);
 
     if (pIn->corr_en)
     { /* Path difference (either LUT or just wave propagation theory). */
-        p_diff_m = pdoa2path_diff(pdoa_deg);
+        ratio = pdoa2path_diff(pdoa_deg100);
     }
     else
     {
-        p_diff_m = pdoa_deg / 360.0f * l_m;
+        int64_t tmp = (int64_t)pdoa_deg100 * ratio_per_deg100;
+        ratio = (tmp > Q30_ONE) ? Q30_ONE : (tmp < -Q30_ONE) ? -Q30_ONE : (int32_t)tmp;
     }
 
-    /* x and y from path difference and range */
-    /* X and y for the purpose of AoA: imagine the dist is 2m */
-    float r_m = 2.0f;
-    x_m = p_diff_m / d_m * r_m;
-    float tmp = (x_m >= 0) ? (x_m) : (-1.f * x_m); /**< Do not optimize*/
-    y_m = (tmp < r_m) ? sqrt(r_m * r_m - x_m * x_m) : 0.0f;
-
     /* results */
-    tmp = atan2f(x_m, y_m);
-
-    pRes->aoa_q11 = (int16_t)(tmp * 2048.0);
-    pRes->pdoa_q11 = (int16_t)(pdoa_deg * 2048 * M_PI / 180.0); // normalized updated pdoa of the current input
+    pRes->aoa_q11 = ratio2aoa_q11(ratio);
+    pRes->pdoa_q11 = (int16_t)((pdoa_deg100 * DEG100_TO_Q11_Q16) / 65536); // normalized updated pdoa of the current input
 }
@@ -79,14 +79,36 @@ extern "C" {
 #define PDOA_INTERVAL_SHIFT_CH9 (-22.0f)
 #endif
 
-/* on allocation of rx_ctx, allocate (avrg_s + size_of(float)*avrg_max) */
+/* PDoA averaging modes, PAVRG command */
+#define PDOA_AVRG_LINEAR   0 /* mean, of the samples of the same sign beyond +/-130 deg */
+#define PDOA_AVRG_CIRCULAR 1 /* circular mean, atan2(sum sin, sum cos) */
+
+/* on allocation of rx_ctx, allocate (avrg_s + size_of(int32_t)*avrg_max) */
 struct avrg_s
 {
-    uint8_t lcnt;     // local counter, loop over 0..max_cnt
-    uint8_t max_cnt;  // increase from 0 to avrg_max
-    uint8_t avrg_max; // size of avrg[] buff, 0 = no averaging
-    float prev_avrg;  // prev avrg result
-    float *avrg;      // must be the last element, the &avrg[0] will be the next address
+    uint8_t lcnt;       // local counter, loop over 0..max_cnt
+    uint8_t max_cnt;    // increase from 0 to avrg_max
+    uint8_t avrg_max;   // size of avrg[] buff, 0 = no averaging
+    uint8_t mode;       // PDOA_AVRG_xxx
+    uint8_t cnt_pos;    // linear: samples >= 0 in the window
+    uint8_t cnt_neg;    // linear: samples < 0 in the window
+    int32_t sum_pos;    // linear: sum of the samples >= 0, deg*100
+    int32_t sum_neg;    // linear: sum of the samples < 0, deg*100
+    int32_t sum_sin;    // circular: sum of sin(samples), Q15
+    int32_t sum_cos;    // circular: sum of cos(samples), Q15
+    int32_t prev_avrg;  // prev avrg result, deg*100
+    int32_t *avrg;      // must be the last element, the &avrg[0] will be the next address
+};
+
+/* PDoA to path difference characterization, see tools/pdoa_lut_gen.py */
+struct pdoa_lut_s
+{
+    const int32_t *x;      // breakpoints, deg*100, Q4
+    const int32_t *r;      // path difference / D_M_JL at x[], clamped to +/-1, Q30
+    const int32_t *slope;  // r[] increment per deg*100 of each segment, Q30
+    const uint8_t *bucket; // segment holding the start of each (1 << shift) wide bucket
+    uint8_t n;             // number of breakpoints
+    uint8_t shift;
 };
 
 struct pdoa_aoa_s
@@ -102,6 +124,7 @@ struct fpdoa_in_s
     uint8_t chan;
     uint8_t corr_en;
     uint8_t max_avrg;
+    uint8_t avrg_mode;
 };
 
 void pdoaupdate_lut(void);
@@ -0,0 +1,243 @@
+/**
+ * @file      dw3000_pdoa_lut.h
+ *
+ * @brief     PDoA to path difference tables, fixed point
+ *
+ *            Generated by tools/pdoa_lut_gen.py, do not edit.
+ *
+ * @author    Development Team
+ *
+ */
+
+#ifndef DW3000_PDOA_LUT_H
+#define DW3000_PDOA_LUT_H
+
+#include "dw3000_pdoa.h"
+
+/* clang-format off */
+
+#define PDOA_ATAN_LUT_BITS  5
+
+/* atan(i / 2^PDOA_ATAN_LUT_BITS), rad, Q15 */
+static const uint16_t pdoa_atan_lut_q15[] = {
+    0, 1024, 2045, 3063, 4075, 5079, 6073, 7057, 8027, 8984, 9925,
+    10849, 11756, 12645, 13514, 14363, 15193, 16002, 16790, 17557, 18304, 19030,
+    19736, 20421, 21086, 21732, 22358, 22966, 23555, 24126, 24679, 25216, 25736,
+};
+
+#define PDOA_SIN_LUT_BITS   6
+
+/* sin(i * pi/2 / 2^PDOA_SIN_LUT_BITS), Q15 */
+static const uint16_t pdoa_sin_lut_q15[] = {
+    0, 804, 1608, 2411, 3212, 4011, 4808, 5602, 6393, 7180, 7962,
+    8740, 9512, 10279, 11039, 11793, 12540, 13279, 14010, 14733, 15447, 16151,
+    16846, 17531, 18205, 18868, 19520, 20160, 20788, 21403, 22006, 22595, 23170,
+    23732, 24279, 24812, 25330, 25833, 26320, 26791, 27246, 27684, 28106, 28511,
+    28899, 29269, 29622, 29957, 30274, 30572, 30853, 31114, 31357, 31581, 31786,
+    31972, 32138, 32286, 32413, 32522, 32610, 32679, 32729, 32758, 32768,
+};
+
+/* MONALISA CHANNEL 5, PDOA_M1 */
+static const int32_t pdoa_mon_ch5_x[] = {
+    -267922, -266547, -265173, -258626, -252078, -240186, -228293, -214664,
+    -201035, -187107, -173181, -156787, -140394, -120966, -101539, -77952,
+    -54365, -27182, 0, 30632, 61264, 88838, 116414, 138474,
+    160533, 176912, 193293, 207630, 221970, 234370, 246770, 257715,
+    268661, 278301, 287941, 297437, 306934,
+};
+
+static const int32_t pdoa_mon_ch5_r[] = {
+    -1367588910, -1356670827, -1346812490, -1311033915, -1285113075, -1237035445,
+    -1184366985, -1119529161, -1047633972, -965277622, -879068961, -779891774,
+    -683794755, -573156104, -467742929, -348860477, -237479103, -114977905,
+    0, 119829318, 237479103, 348999175, 467742929, 569494127,
+    683794755, 779548332, 879068961, 964413614, 1047633972, 1117868993,
+    1184366985, 1237934278, 1285113075, 1320043254, 1346812490, 1363171001,
+    1367588910,
+};
+
+static const int32_t pdoa_mon_ch5_slope[] = {
+    127047, 114799, 87438, 63337, 64686, 70856, 76117, 84403,
+    94608, 99048, 96794, 93793, 91117, 86818, 80643, 75554,
+    72105, 67679, 62590, 61452, 64710, 68897, 73800, 82905,
+    93538, 97206, 95244, 92854, 90626, 85804, 78308, 68962,
+    57975, 44430, 27563, 7443,
+};
+
+static const uint8_t pdoa_mon_ch5_bucket[] = {
+    0, 2, 4, 4, 5, 6, 6, 7, 7, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+    13, 14, 14, 14, 15, 15, 15, 16, 16, 16, 17, 17, 17, 18, 18, 18, 18, 19, 19, 19,
+    19, 20, 20, 20, 21, 21, 21, 22, 22, 22, 23, 23, 23, 24, 24, 25, 25, 26, 26, 27,
+    28, 28, 29, 30, 30, 31, 32, 33, 34, 34, 35,
+};
+
+static const struct pdoa_lut_s pdoa_lut_mon_ch5 = {
+    .x = pdoa_mon_ch5_x,
+    .r = pdoa_mon_ch5_r,
+    .slope = pdoa_mon_ch5_slope,
+    .bucket = pdoa_mon_ch5_bucket,
+    .n = 37,
+    .shift = 13,
+};
+
+/* MONALISA CHANNEL 9, PDOA_M1 */
+static const int32_t pdoa_mon_ch9_x[] = {
+    -271751, -267377, -254196, -239315, -220313, -190553, -148310, -99910,
+    -53132, 0, 52739, 103485, 141978, 174073, 199593, 220170,
+    236004, 258311, 282558,
+};
+
+static const int32_t pdoa_mon_ch9_r[] = {
+    -1073741543, -1057429265, -1008987178, -929887519, -822533779, -690188054,
+    -536870771, -367241211, -186453399, 0, 186453399, 367241211,
+    536870771, 690188054, 822533779, 929887519, 1008987178, 1057429265,
+    1073741543,
+};
+
+static const int32_t pdoa_mon_ch9_slope[] = {
+    59670, 58802, 85048, 90394, 71154, 58071, 56076, 61837,
+    56148, 56566, 57002, 70508, 76432, 82975, 83475, 79929,
+    34746, 10764,
+};
+
+static const uint8_t pdoa_mon_ch9_bucket[] = {
+    0, 1, 3, 3, 4, 5, 5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9,
+    10, 10, 10, 11, 11, 11, 12, 12, 13, 14, 14, 16, 16, 17,
+};
+
+static const struct pdoa_lut_s pdoa_lut_mon_ch9 = {
+    .x = pdoa_mon_ch9_x,
+    .r = pdoa_mon_ch9_r,
+    .slope = pdoa_mon_ch9_slope,
+    .bucket = pdoa_mon_ch9_bucket,
+    .n = 19,
+    .shift = 14,
+};
+
+/* JOLIE CHANNEL 5 */
+static const int32_t pdoa_jolie_ch5_x[] = {
+    -266047, -251204, -239293, -227425, -215140, -204514, -193483, -179894,
+    -168495, -154827, -140519, -124362, -106486, -88009, -69853, -50383,
+    -33056, -16154, 0, 13758, 30619, 47089, 64912, 84078,
+    103660, 125476, 147358, 169278, 189866, 208664, 225710, 240996,
+    252761, 263588, 272864, 281136, 285492,
+};
+
+static const int32_t pdoa_jolie_ch5_r[] = {
+    -1073741543, -1069655668, -1057429265, -1037154798, -1008987178, -973140755,
+    -929887519, -879557705, -822533779, -759249849, -690188054, -615873162,
+    -536870771, -453783106, -367241211, -277904949, -186453399, -93583050,
+    0, 93583050, 186453399, 277904949, 367241211, 453783106,
+    536870771, 615873162, 690188054, 759249849, 822533779, 879557705,
+    929887519, 973140755, 1008987178, 1037154798, 1057429265, 1069655668,
+    1073741543,
+};
+
+static const int32_t pdoa_jolie_ch5_slope[] = {
+    4404, 16424, 27333, 36686, 53975, 62737, 59259, 80041,
+    74081, 77229, 73593, 70711, 71949, 76265, 73414, 84448,
+    87914, 92691, 108833, 88128, 88842, 80199, 72246, 67889,
+    57941, 54339, 50410, 49181, 48536, 47241, 45274, 48750,
+    41626, 34971, 23649, 15008,
+};
+
+static const uint8_t pdoa_jolie_ch5_bucket[] = {
+    0, 1, 2, 3, 5, 6, 8, 9, 10, 11, 12, 13, 14, 14, 15, 16, 17, 18, 19, 20,
+    21, 22, 23, 24, 25, 25, 26, 27, 28, 29, 29, 31, 32, 34,
+};
+
+static const struct pdoa_lut_s pdoa_lut_jolie_ch5 = {
+    .x = pdoa_jolie_ch5_x,
+    .r = pdoa_jolie_ch5_r,
+    .slope = pdoa_jolie_ch5_slope,
+    .bucket = pdoa_jolie_ch5_bucket,
+    .n = 37,
+    .shift = 14,
+};
+
+/* JOLIE CHANNEL 9 */
+static const int32_t pdoa_jolie_ch9_x[] = {
+    -310822, -303911, -296870, -287567, -278725, -266372, -251467, -234241,
+    -215207, -194044, -173011, -151131, -128363, -107087, -85264, -64846,
+    -42753, -20737, 0, 21213, 42119, 64097, 84680, 105456,
+    123744, 142607, 158936, 174950, 189559, 204422, 217996, 228927,
+    238897, 249094, 256435, 261915, 265227,
+};
+
+static const int32_t pdoa_jolie_ch9_r[] = {
+    -1073741543, -1069655668, -1057429265, -1037154798, -1008987178, -973140755,
+    -929887519, -879557705, -822533779, -759249849, -690188054, -615873162,
+    -536870771, -453783106, -367241211, -277904949, -186453399, -93583050,
+    0, 93583050, 186453399, 277904949, 367241211, 453783106,
+    536870771, 615873162, 690188054, 759249849, 822533779, 879557705,
+    929887519, 973140755, 1008987178, 1037154798, 1057429265, 1069655668,
+    1073741543,
+};
+
+static const int32_t pdoa_jolie_ch9_slope[] = {
+    9459, 27783, 34870, 50971, 46429, 46431, 46748, 47934,
+    47845, 52536, 54344, 55518, 62484, 63450, 70006, 66230,
+    67493, 72206, 70585, 71077, 66577, 69445, 66648, 72693,
+    67012, 72818, 69001, 69310, 61386, 59325, 63311, 57527,
+    44198, 44189, 35698, 19739,
+};
+
+static const uint8_t pdoa_jolie_ch9_bucket[] = {
+    0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 8, 9, 9, 10, 10, 10,
+    11, 11, 11, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 16, 16, 16, 17, 17, 18, 18,
+    18, 19, 19, 19, 20, 20, 21, 21, 21, 22, 22, 23, 23, 23, 24, 24, 25, 25, 26, 26,
+    27, 27, 28, 29, 29, 30, 31, 31, 32, 33, 35,
+};
+
+static const struct pdoa_lut_s pdoa_lut_jolie_ch9 = {
+    .x = pdoa_jolie_ch9_x,
+    .r = pdoa_jolie_ch9_r,
+    .slope = pdoa_jolie_ch9_slope,
+    .bucket = pdoa_jolie_ch9_bucket,
+    .n = 37,
+    .shift = 13,
+};
+
+/* CUSTOM */
+static const int32_t pdoa_cst_chn_x[] = {
+    -291485, -276665, -261846, -247026, -232207, -217387, -202567, -187748,
+    -172928, -158109, -143289, -128470, -113650, -98830, -84011, -69191,
+    -54372, -39552, -24733, -9913, 4907, 19726, 34546, 49365,
+    64185, 79004, 93824, 108643, 123463, 138283, 153102, 167922,
+    182741, 197561, 212380, 227200,
+};
+
+static const int32_t pdoa_cst_chn_r[] = {
+    -1073741543, -1052961521, -1009877004, -919208405, -800639373, -713414797,
+    -639196573, -568197815, -503334173, -445198866, -392077687, -342200591,
+    -294439384, -248293913, -203291647, -158948645, -114632061, -69601575,
+    -23113264, 25532366, 76121563, 127569965, 178759585, 228830017,
+    278570818, 329415194, 382797557, 440017820, 502141734, 570092748,
+    641815616, 712434908, 799442131, 929595114, 997998246, 1057429265,
+};
+
+static const int32_t pdoa_cst_chn_slope[] = {
+    22435, 46518, 97888, 128018, 94170, 80128, 76657, 70028,
+    62768, 57351, 53852, 51564, 49820, 48589, 47874, 47848,
+    48616, 50193, 52519, 54617, 55549, 55265, 54061, 53701,
+    54896, 57633, 61780, 67070, 73361, 77439, 76242, 93941,
+    140516, 73855, 64163,
+};
+
+static const uint8_t pdoa_cst_chn_bucket[] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 12, 13, 14, 15, 16, 17, 18, 19, 21,
+    22, 23, 24, 25, 26, 27, 28, 29, 30, 32, 33, 34,
+};
+
+static const struct pdoa_lut_s pdoa_lut_cst_chn = {
+    .x = pdoa_cst_chn_x,
+    .r = pdoa_cst_chn_r,
+    .slope = pdoa_cst_chn_slope,
+    .bucket = pdoa_cst_chn_bucket,
+    .n = 36,
+    .shift = 14,
+};
+
+/* clang-format on */
+
+#endif /* DW3000_PDOA_LUT_H */
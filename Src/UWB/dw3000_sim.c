@@ -0,0 +1,752 @@
+/**
+ * @file    dw3000_sim.c
+ *
+ * @brief   Register-level model of the DW3000 behind dwt_ops/dwt_mcps_ops
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "deca_device_api.h"
+#include "dw3000_sim.h"
+
+#define SIM_REG_FILES       0x20
+#define SIM_REG_LEN         0x400   /**< RX/TX buffers are the largest files used */
+#define SIM_FRAME_LEN       128     /**< largest scripted frame, an 802.15.4 frame */
+#define SIM_DTU_PER_DLY     256     /**< dw_tx_frame_info_s.rx_delay_dly unit, 1.0256 us */
+#define SIM_TS_MASK         0xFFFFFFFFFFULL
+
+#define REG(file, off)      (((uint32_t)(file) << 16) | (off))
+
+/* DW3000 register map, CIA diagnostics not double buffered */
+#define SIM_DEV_ID          REG(0x00, 0x00)
+#define SIM_SYS_TIME        REG(0x00, 0x1C)
+#define SIM_SYS_STATUS      REG(0x00, 0x44)
+#define SIM_RX_FINFO        REG(0x00, 0x4C)
+#define SIM_RX_TIME         REG(0x00, 0x64)
+#define SIM_TX_TIME         REG(0x00, 0x74)
+#define SIM_STS_QUAL        REG(0x02, 0x08)
+#define SIM_DGC_DBG         REG(0x03, 0x60)
+#define SIM_PDOA            REG(0x0C, 0x1E)
+#define SIM_CFO             REG(0x0C, 0x20)
+#define SIM_IP_PP           REG(0x0C, 0x28)
+#define SIM_IP_FP           REG(0x0C, 0x48)
+#define SIM_RX_BUFFER       REG(0x12, 0x00)
+#define SIM_TX_BUFFER       REG(0x14, 0x00)
+
+/* power, F1, F2, F3, accumulation count of IPATOV, STS1, STS2 */
+static const uint32_t sim_cir_regs[3][5] = {
+    {REG(0x0C, 0x2C), REG(0x0C, 0x30), REG(0x0C, 0x34), REG(0x0C, 0x38), REG(0x0C, 0x58)},
+    {REG(0x0C, 0x60), REG(0x0C, 0x64), REG(0x0C, 0x68), REG(0x0D, 0x00), REG(0x0D, 0x20)},
+    {REG(0x0D, 0x3C), REG(0x0D, 0x40), REG(0x0D, 0x44), REG(0x0D, 0x48), REG(0x0D, 0x68)},
+};
+
+typedef struct
+{
+    dw3000_sim_frame_t ev;
+    uint8_t data[SIM_FRAME_LEN];
+    bool used;
+} sim_script_t;
+
+/* One simulated chip, dwchip_s.priv */
+typedef struct
+{
+    struct dwchip_s *dw;        /**< NULL: free */
+    uint8_t reg[SIM_REG_FILES][SIM_REG_LEN];
+    uint32_t now;               /**< chip time, DTU */
+
+    bool rx_on;
+    uint32_t rx_from;           /**< receiver on from this date */
+    bool rx_timeout;
+    uint32_t rx_timeout_at;
+
+    bool tx_pending;
+    uint32_t tx_at;
+    uint16_t tx_len;
+    bool tx_then_rx;
+    uint32_t tx_rx_delay;
+    uint32_t tx_rx_timeout;
+
+    uint32_t status_pending;    /**< SYS_STATUS bits the next ISR reports */
+
+    sim_script_t script[DW3000_SIM_SCRIPT_LEN];
+    dw3000_sim_stats_t stats;
+} sim_t;
+
+static sim_t sim_nodes[DW3000_SIM_NODES];
+static dw3000_sim_tx_hook_t sim_tx_hook;
+
+/* @brief the chip's time ordering: a is at or before b, clock wraps */
+static bool sim_before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) <= 0;
+}
+
+static uint8_t *sim_reg(sim_t *s, uint32_t id, uint16_t index, uint16_t len)
+{
+    uint32_t file = id >> 16;
+    uint32_t off = (id & 0xFFFF) + index;
+
+    if (file >= SIM_REG_FILES || off + len > SIM_REG_LEN)
+    {
+        return NULL;
+    }
+    return &s->reg[file][off];
+}
+
+/* @brief chip side register write, not an SPI access */
+static void sim_put(sim_t *s, uint32_t id, uint64_t val, uint16_t len)
+{
+    uint8_t *p = sim_reg(s, id, 0, len);
+
+    for (uint16_t i = 0; p && i < len; i++)
+    {
+        p[i] = (uint8_t)(val >> (8 * i));
+    }
+}
+
+static uint64_t sim_get(sim_t *s, uint32_t id, uint16_t index, uint16_t len)
+{
+    const uint8_t *p = sim_reg(s, id, index, len);
+    uint64_t val = 0;
+
+    for (uint16_t i = 0; p && i < len; i++)
+    {
+        val |= (uint64_t)p[i] << (8 * i);
+    }
+    return val;
+}
+
+static int16_t sim_sign_extend(uint64_t v, int bits)
+{
+    return (int16_t)((int32_t)((uint32_t)v << (32 - bits)) >> (32 - bits));
+}
+
+/* @brief host side access, one SPI transaction on target */
+static void sim_xfer(struct dwchip_s *dw, uint32_t regFileID, uint16_t index, uint16_t length, uint8_t *buffer,
+                     const spi_modes_e mode)
+{
+    sim_t *s = dw->priv;
+    uint8_t *p;
+
+    s->stats.xfers++;
+    s->stats.xfer_bytes += length;
+
+    if (regFileID == SIM_SYS_TIME && index == 0)
+    {
+        sim_put(s, SIM_SYS_TIME, s->now, 4);
+    }
+
+    p = sim_reg(s, regFileID, index, length);
+    if (!p)
+    {
+        memset(buffer, 0, (mode == DW3000_SPI_RD_BIT) ? length : 0);
+        return;
+    }
+    if (mode == DW3000_SPI_RD_BIT)
+    {
+        memcpy(buffer, p, length);
+    }
+    else
+    {
+        memcpy(p, buffer, length);
+    }
+}
+
+static uint64_t sim_read(struct dwchip_s *dw, uint32_t id, uint16_t index, uint16_t len)
+{
+    uint8_t buf[8] = {0};
+    uint64_t val = 0;
+
+    sim_xfer(dw, id, index, len, buf, DW3000_SPI_RD_BIT);
+    for (uint16_t i = 0; i < len; i++)
+    {
+        val |= (uint64_t)buf[i] << (8 * i);
+    }
+    return val;
+}
+
+/* @brief result registers of a received frame, as the CIA leaves them */
+static void sim_latch_frame(sim_t *s, const dw3000_sim_frame_t *ev, const uint8_t *data)
+{
+    uint32_t cir[5] = {ev->cir_power & 0x1FFFF, ev->fp_ampl & 0x3FFFFF, ev->fp_ampl & 0x3FFFFF,
+                       ev->fp_ampl & 0x3FFFFF, ev->accum & 0xFFF};
+
+    memcpy(sim_reg(s, SIM_RX_BUFFER, 0, ev->len), data, ev->len);
+    sim_put(s, SIM_RX_FINFO, ev->len, 2);
+    sim_put(s, SIM_RX_TIME, ((uint64_t)ev->at_dtu * DW3000_SIM_RCTU_PER_DTU + ev->at_rctu) & SIM_TS_MASK, 5);
+
+    sim_put(s, SIM_PDOA, (uint16_t)ev->pdoa & 0x3FFF, 2);
+    sim_put(s, SIM_CFO, (uint16_t)ev->cfo & 0x1FFF, 2);
+    sim_put(s, SIM_STS_QUAL, (uint16_t)ev->sts_qual & 0xFFF, 2);
+    sim_put(s, SIM_DGC_DBG, (uint32_t)(ev->dgc & 0x7) << 28, 4);
+    sim_put(s, SIM_IP_FP, ev->index_fp, 4);
+    sim_put(s, SIM_IP_PP, (uint32_t)(ev->index_fp >> 6) << 21, 4);
+
+    for (int i = 0; i < 3; i++)
+    {
+        for (int k = 0; k < 5; k++)
+        {
+            sim_put(s, sim_cir_regs[i][k], cir[k], 4);
+        }
+    }
+}
+
+static void sim_rx_arm(sim_t *s, uint32_t from, uint32_t timeout_pac)
+{
+    s->rx_on = true;
+    s->rx_from = from;
+    s->rx_timeout = (timeout_pac != 0);
+    s->rx_timeout_at = from + timeout_pac * DW3000_SIM_PAC_DTU;
+}
+
+/* @brief earliest scripted event, NULL if none */
+static sim_script_t *sim_next_scripted(sim_t *s)
+{
+    sim_script_t *next = NULL;
+
+    for (int i = 0; i < DW3000_SIM_SCRIPT_LEN; i++)
+    {
+        if (s->script[i].used && (!next || sim_before(s->script[i].ev.at_dtu, next->ev.at_dtu)))
+        {
+            next = &s->script[i];
+        }
+    }
+    return next;
+}
+
+/* @brief move the clock to the next event due by target and raise its IRQ
+ *
+ * @return false if none is due
+ */
+static bool sim_step(sim_t *s, uint32_t target)
+{
+    sim_script_t *ev;
+    uint32_t at;
+    int which; /* 0: TX done, 1: scripted, 2: RX timeout */
+
+    for (;;)
+    {
+        ev = sim_next_scripted(s);
+        at = target;
+        which = -1;
+
+        /* at the same date: TX done, then the frame, then the timeout */
+        if (s->tx_pending && sim_before(s->tx_at, at))
+        {
+            at = s->tx_at;
+            which = 0;
+        }
+        if (ev && sim_before(ev->ev.at_dtu, at) && (which < 0 || ev->ev.at_dtu != at))
+        {
+            at = ev->ev.at_dtu;
+            which = 1;
+        }
+        if (s->rx_on && s->rx_timeout && sim_before(s->rx_timeout_at, at) &&
+            (which < 0 || s->rx_timeout_at != at))
+        {
+            at = s->rx_timeout_at;
+            which = 2;
+        }
+        if (which < 0)
+        {
+            return false;
+        }
+        if (sim_before(s->now, at))
+        {
+            s->now = at;
+        }
+        if (which != 1 || (s->rx_on && sim_before(s->rx_from, ev->ev.at_dtu)))
+        {
+            break;
+        }
+        ev->used = false;
+        s->stats.rx_missed++;
+    }
+
+    switch (which)
+    {
+    case 0:
+        s->tx_pending = false;
+        sim_put(s, SIM_TX_TIME, ((uint64_t)s->tx_at * DW3000_SIM_RCTU_PER_DTU) & SIM_TS_MASK, 5);
+        s->status_pending |= DWT_INT_TXFRS_BIT_MASK;
+        s->stats.tx++;
+        if (s->tx_then_rx)
+        {
+            sim_rx_arm(s, s->tx_at + s->tx_rx_delay, s->tx_rx_timeout);
+        }
+        break;
+
+    case 1:
+        ev->used = false;
+        s->rx_on = false;
+        if (ev->ev.type == DW3000_SIM_RX_OK)
+        {
+            sim_latch_frame(s, &ev->ev, ev->data);
+            s->status_pending |= DWT_INT_RXFCG_BIT_MASK;
+            s->stats.rx_ok++;
+        }
+        else
+        {
+            s->status_pending |= DWT_INT_RXFCE_BIT_MASK;
+            s->stats.rx_err++;
+        }
+        break;
+
+    default:
+        s->rx_on = false;
+        s->status_pending |= DWT_INT_RXFTO_BIT_MASK;
+        s->stats.rx_to++;
+        break;
+    }
+    return true;
+}
+
+static void sim_isr(struct dwchip_s *dw)
+{
+    sim_t *s = dw->priv;
+    dwt_cb_data_t cb = {0};
+    uint32_t status;
+    dwt_cb_t fn = NULL;
+
+    /* the ISR reads SYS_STATUS over SPI */
+    sim_put(s, SIM_SYS_STATUS, s->status_pending, 4);
+    status = (uint32_t)sim_read(dw, SIM_SYS_STATUS, 0, 4);
+    s->status_pending = 0;
+    if (!status)
+    {
+        return;
+    }
+    s->stats.irqs++;
+
+    cb.status = status;
+    cb.dw = dw;
+
+    if (status & DWT_INT_TXFRS_BIT_MASK)
+    {
+        fn = dw->callbacks.cbTxDone;
+    }
+    else if (status & DWT_INT_RXFCG_BIT_MASK)
+    {
+        cb.datalength = (uint16_t)sim_read(dw, SIM_RX_FINFO, 0, 2) & 0x3FF;
+        cb.rx_flags = cb.datalength ? 0 : DWT_CB_DATA_RX_FLAG_ND;
+        fn = dw->callbacks.cbRxOk;
+    }
+    else if (status & DWT_INT_RXFTO_BIT_MASK)
+    {
+        fn = dw->callbacks.cbRxTo;
+    }
+    else
+    {
+        fn = dw->callbacks.cbRxErr;
+    }
+
+    sim_put(s, SIM_SYS_STATUS, 0, 4);
+    if (fn)
+    {
+        fn(&cb);
+    }
+}
+
+static int sim_ioctl(struct dwchip_s *dw, dwt_ioctl_e fn, int parm, void *ptr)
+{
+    sim_t *s = dw->priv;
+
+    (void)parm;
+    s->stats.ioctls++;
+
+    switch (fn)
+    {
+    case DWT_READRXDATA:
+    {
+        struct dwt_rw_data_s *rd = (struct dwt_rw_data_s *)ptr;
+        sim_xfer(dw, SIM_RX_BUFFER, rd->offset, rd->length, rd->buffer, DW3000_SPI_RD_BIT);
+        break;
+    }
+    case DWT_READCLOCKOFFSET:
+        *(int16_t *)ptr = sim_sign_extend(sim_read(dw, SIM_CFO, 0, 2), 13);
+        break;
+    case DWT_READPDOA:
+        *(int16_t *)ptr = sim_sign_extend(sim_read(dw, SIM_PDOA, 0, 2), 14);
+        break;
+    case DWT_READSTSQUALITY:
+        *(int16_t *)ptr = sim_sign_extend(sim_read(dw, SIM_STS_QUAL, 0, 2), 12);
+        break;
+    case DWT_GETDGCDECISION:
+        *(uint8_t *)ptr = ((uint8_t)sim_read(dw, SIM_DGC_DBG, 3, 1) >> 4) & 0x7;
+        break;
+    case DWT_NLOS_IPDIAG:
+    {
+        dwt_nlos_ipdiag_t *d = (dwt_nlos_ipdiag_t *)ptr;
+        d->index_fp_u32 = (uint32_t)sim_read(dw, SIM_IP_FP, 0, 4) & 0xFFFF;
+        d->index_pp_u32 = (uint16_t)(((uint32_t)sim_read(dw, SIM_IP_PP, 0, 4) >> 21) << 6);
+        break;
+    }
+    case DWT_NLOS_ALLDIAG:
+    {
+        dwt_nlos_alldiag_t *d = (dwt_nlos_alldiag_t *)ptr;
+        const uint32_t *r = sim_cir_regs[(d->diag_type == IPATOV) ? 0 : (d->diag_type == STS1) ? 1 : 2];
+        d->cir_power = (uint32_t)sim_read(dw, r[0], 0, 4) & ((d->diag_type == IPATOV) ? 0x1FFFF : 0xFFFFF);
+        d->F1 = (uint32_t)sim_read(dw, r[1], 0, 4) & 0x3FFFFF;
+        d->F2 = (uint32_t)sim_read(dw, r[2], 0, 4) & 0x3FFFFF;
+        d->F3 = (uint32_t)sim_read(dw, r[3], 0, 4) & 0x3FFFFF;
+        d->accumCount = (uint32_t)sim_read(dw, r[4], 0, 4) & 0xFFF;
+        d->D = ((uint8_t)sim_read(dw, SIM_DGC_DBG, 3, 1) >> 4) & 0x7;
+        d->result = DWT_SUCCESS;
+        break;
+    }
+    case DWT_READSYSTIMESTAMPHI32:
+        *(uint32_t *)ptr = (uint32_t)sim_read(dw, SIM_SYS_TIME, 0, 4);
+        break;
+    case DWT_READRXTIMESTAMP:
+        sim_xfer(dw, SIM_RX_TIME, 0, 5, (uint8_t *)ptr, DW3000_SPI_RD_BIT);
+        break;
+    case DWT_READTXTIMESTAMP:
+        sim_xfer(dw, SIM_TX_TIME, 0, 5, (uint8_t *)ptr, DW3000_SPI_RD_BIT);
+        break;
+    case DWT_READSYSSTATUSLO:
+        *(uint32_t *)ptr = (uint32_t)sim_read(dw, SIM_SYS_STATUS, 0, 4);
+        break;
+    case DWT_WRITESYSSTATUSLO:
+        s->stats.xfers++;
+        sim_put(s, SIM_SYS_STATUS, sim_get(s, SIM_SYS_STATUS, 0, 4) & ~*(uint32_t *)ptr, 4);
+        break;
+    case DWT_FORCETRXOFF:
+        s->stats.xfers++;
+        s->rx_on = false;
+        s->tx_pending = false;
+        break;
+    default:
+        /* configuration: accepted, no effect on the model */
+        break;
+    }
+    return DWT_SUCCESS;
+}
+
+static int sim_configure(struct dwchip_s *dw, dwt_config_t *config)
+{
+    (void)dw;
+    (void)config;
+    return DWT_SUCCESS;
+}
+
+static int sim_write_tx_data(struct dwchip_s *dw, uint16_t txDataLength, uint8_t *txDataBytes, uint16_t txBufferOffset)
+{
+    sim_xfer(dw, SIM_TX_BUFFER, txBufferOffset, txDataLength, txDataBytes, DW3000_SPI_WR_BIT);
+    return DWT_SUCCESS;
+}
+
+static void sim_write_tx_fctrl(struct dwchip_s *dw, uint16_t txFrameLength, uint16_t txBufferOffset, uint8_t ranging)
+{
+    sim_t *s = dw->priv;
+
+    (void)txBufferOffset;
+    (void)ranging;
+    s->stats.xfers++;
+    s->tx_len = txFrameLength;
+}
+
+static void sim_read_rx_data(struct dwchip_s *dw, uint8_t *buffer, uint16_t length, uint16_t rxBufferOffset)
+{
+    sim_xfer(dw, SIM_RX_BUFFER, rxBufferOffset, length, buffer, DW3000_SPI_RD_BIT);
+}
+
+static void sim_read_acc_data(struct dwchip_s *dw, uint8_t *buffer, uint16_t length, uint16_t accOffset)
+{
+    sim_t *s = dw->priv;
+
+    (void)accOffset;
+    s->stats.xfers++;
+    memset(buffer, 0, length);
+}
+
+static void sim_read_rx_timestamp(struct dwchip_s *dw, uint8_t *timestamp)
+{
+    sim_xfer(dw, SIM_RX_TIME, 0, 5, timestamp, DW3000_SPI_RD_BIT);
+}
+
+static void sim_configure_tx_rf(struct dwchip_s *dw, dwt_txconfig_t *config)
+{
+    (void)dw;
+    (void)config;
+}
+
+static void sim_set_interrupt(struct dwchip_s *dw, uint32_t bitmask_lo, uint32_t bitmask_hi, dwt_INT_options_e INT_options)
+{
+    (void)dw;
+    (void)bitmask_lo;
+    (void)bitmask_hi;
+    (void)INT_options;
+}
+
+static int sim_rx_enable(struct dwchip_s *dw, int mode)
+{
+    sim_t *s = dw->priv;
+
+    (void)mode;
+    sim_rx_arm(s, s->now, 0);
+    return DWT_SUCCESS;
+}
+
+static int sim_initialize(struct dwchip_s *dw, int mode)
+{
+    (void)dw;
+    (void)mode;
+    return DWT_SUCCESS;
+}
+
+static int sim_mcps_init(struct dwchip_s *dw)
+{
+    (void)dw;
+    return DWT_SUCCESS;
+}
+
+static void sim_mcps_deinit(struct dwchip_s *dw)
+{
+    (void)dw;
+}
+
+static int sim_tx_frame(struct dwchip_s *dw, uint8_t *data, size_t len, struct dw_tx_frame_info_s *info)
+{
+    sim_t *s = dw->priv;
+
+    if (len > SIM_FRAME_LEN)
+    {
+        return DWT_ERROR;
+    }
+    sim_xfer(dw, SIM_TX_BUFFER, 0, (uint16_t)len, data, DW3000_SPI_WR_BIT);
+
+    s->tx_pending = true;
+    s->tx_len = (uint16_t)len;
+    s->tx_at = (info->flag & DWT_START_TX_DELAYED) ? info->tx_date_dtu : s->now;
+    s->tx_then_rx = (info->flag & DWT_RESPONSE_EXPECTED) != 0;
+    s->tx_rx_delay = (uint32_t)info->rx_delay_dly * SIM_DTU_PER_DLY;
+    s->tx_rx_timeout = info->rx_timeout_pac;
+    s->rx_on = false;
+
+    /* the date is known now: the medium can schedule the receptions */
+    if (sim_tx_hook)
+    {
+        sim_tx_hook(dw, data, (uint16_t)len, s->tx_at);
+    }
+    return DWT_SUCCESS;
+}
+
+static int sim_mcps_rx_enable(struct dwchip_s *dw, struct dw_rx_frame_info_s *info)
+{
+    sim_t *s = dw->priv;
+
+    s->stats.xfers++;
+    sim_rx_arm(s, info->rx_delayed ? info->rx_date_dtu : s->now, info->rx_timeout_pac);
+    return DWT_SUCCESS;
+}
+
+static int sim_rx_disable(struct dwchip_s *dw)
+{
+    sim_t *s = dw->priv;
+
+    s->stats.xfers++;
+    s->rx_on = false;
+    return DWT_SUCCESS;
+}
+
+static uint64_t sim_get_timestamp(struct dwchip_s *dw)
+{
+    return sim_read(dw, SIM_RX_TIME, 0, 5) & SIM_TS_MASK;
+}
+
+static void sim_get_rx_frame(struct dwchip_s *dw, uint8_t *ptr, size_t len)
+{
+    sim_xfer(dw, SIM_RX_BUFFER, 0, (uint16_t)len, ptr, DW3000_SPI_RD_BIT);
+}
+
+static int sim_set_hrp_uwb_params(struct dwchip_s *dw, int prf, int fsr, int sfd_selector, int phr_rate, int data_rate)
+{
+    (void)dw;
+    (void)prf;
+    (void)fsr;
+    (void)sfd_selector;
+    (void)phr_rate;
+    (void)data_rate;
+    return DWT_SUCCESS;
+}
+
+static int sim_set_channel(struct dwchip_s *dw, int page, int channel, int preamble_code)
+{
+    (void)dw;
+    (void)page;
+    (void)channel;
+    (void)preamble_code;
+    return DWT_SUCCESS;
+}
+
+static int sim_set_hw_addr_filt(struct dwchip_s *dw, struct dw_addr_filt_s *filt, int changed)
+{
+    (void)dw;
+    (void)filt;
+    (void)changed;
+    return DWT_SUCCESS;
+}
+
+static int sim_sys_status_and_or(struct dwchip_s *dw, uint32_t _and, uint32_t _or)
+{
+    sim_t *s = dw->priv;
+
+    s->stats.xfers++;
+    sim_put(s, SIM_SYS_STATUS, (sim_get(s, SIM_SYS_STATUS, 0, 4) & _and) | _or, 4);
+    return DWT_SUCCESS;
+}
+
+static void sim_ack_enable(struct dwchip_s *dw, int enable)
+{
+    (void)dw;
+    (void)enable;
+}
+
+static const struct dwt_ops_s sim_ops = {
+    .configure = sim_configure,
+    .write_tx_data = sim_write_tx_data,
+    .write_tx_fctrl = sim_write_tx_fctrl,
+    .read_rx_data = sim_read_rx_data,
+    .read_acc_data = sim_read_acc_data,
+    .read_rx_timestamp = sim_read_rx_timestamp,
+    .configure_tx_rf = sim_configure_tx_rf,
+    .set_interrupt = sim_set_interrupt,
+    .rx_enable = sim_rx_enable,
+    .initialize = sim_initialize,
+    .xfer = sim_xfer,
+    .ioctl = sim_ioctl,
+    .isr = sim_isr,
+};
+
+static const struct dwt_mcps_ops_s sim_mcps_ops = {
+    .init = sim_mcps_init,
+    .deinit = sim_mcps_deinit,
+    .tx_frame = sim_tx_frame,
+    .rx_enable = sim_mcps_rx_enable,
+    .rx_disable = sim_rx_disable,
+    .get_timestamp = sim_get_timestamp,
+    .get_rx_frame = sim_get_rx_frame,
+    .set_hrp_uwb_params = sim_set_hrp_uwb_params,
+    .set_channel = sim_set_channel,
+    .set_hw_addr_filt = sim_set_hw_addr_filt,
+    .mcps_compat = {
+        .sys_status_and_or = sim_sys_status_and_or,
+        .ack_enable = sim_ack_enable,
+        .set_interrupt = sim_set_interrupt,
+    },
+    .ioctl = sim_ioctl,
+    .isr = sim_isr,
+};
+
+static struct dwt_driver_s sim_driver = {
+    .devid = (uint32_t)DWT_DW3000_PDOA_DEV_ID,
+    .devmatch = 0xFFFFFF0F,
+    .name = "DW3000 sim",
+    .version = "sim",
+    .dwt_ops = &sim_ops,
+    .dwt_mcps_ops = &sim_mcps_ops,
+};
+
+int dw3000_sim_attach(struct dwchip_s *dw)
+{
+    for (int i = 0; i < DW3000_SIM_NODES; i++)
+    {
+        sim_t *s = &sim_nodes[i];
+
+        if (s->dw && s->dw != dw)
+        {
+            continue;
+        }
+        memset(s, 0, sizeof(*s));
+        s->dw = dw;
+        sim_put(s, SIM_DEV_ID, (uint32_t)DWT_DW3000_PDOA_DEV_ID, 4);
+        dw->dwt_driver = &sim_driver;
+        dw->priv = s;
+        return i;
+    }
+    return -1;
+}
+
+void dw3000_sim_detach(struct dwchip_s *dw)
+{
+    sim_t *s = dw->priv;
+
+    if (s)
+    {
+        s->dw = NULL;
+    }
+    dw->priv = NULL;
+}
+
+void dw3000_sim_set_tx_hook(dw3000_sim_tx_hook_t hook)
+{
+    sim_tx_hook = hook;
+}
+
+int dw3000_sim_script(struct dwchip_s *dw, const dw3000_sim_frame_t *ev, int n)
+{
+    sim_t *s = dw->priv;
+    int done = 0;
+
+    for (int i = 0; i < DW3000_SIM_SCRIPT_LEN && done < n; i++)
+    {
+        sim_script_t *slot = &s->script[i];
+
+        if (slot->used)
+        {
+            continue;
+        }
+        slot->ev = ev[done];
+        slot->ev.len = (ev[done].data && ev[done].len <= SIM_FRAME_LEN) ? ev[done].len : 0;
+        if (slot->ev.len)
+        {
+            memcpy(slot->data, ev[done].data, slot->ev.len);
+        }
+        slot->ev.data = slot->data;
+        slot->used = true;
+        done++;
+    }
+    return done;
+}
+
+int dw3000_sim_advance(struct dwchip_s *dw, uint32_t dtu)
+{
+    sim_t *s = dw->priv;
+    uint32_t target = s->now + dtu;
+    int n = 0;
+
+    while (sim_step(s, target))
+    {
+        dw->dwt_driver->dwt_ops->isr(dw);
+        n++;
+    }
+    s->now = target;
+    return n;
+}
+
+uint32_t dw3000_sim_now(struct dwchip_s *dw)
+{
+    return ((sim_t *)dw->priv)->now;
+}
+
+const uint8_t *dw3000_sim_last_tx(struct dwchip_s *dw, uint16_t *len)
+{
+    sim_t *s = dw->priv;
+
+    *len = s->tx_len;
+    return s->stats.tx ? sim_reg(s, SIM_TX_BUFFER, 0, s->tx_len) : NULL;
+}
+
+void dw3000_sim_get_stats(struct dwchip_s *dw, dw3000_sim_stats_t *stats)
+{
+    *stats = ((sim_t *)dw->priv)->stats;
+}
+
+void dw3000_sim_reset_stats(struct dwchip_s *dw)
+{
+    memset(&((sim_t *)dw->priv)->stats, 0, sizeof(dw3000_sim_stats_t));
+}
@@ -0,0 +1,131 @@
+/**
+ * @file    dw3000_sim.h
+ *
+ * @brief   Register-level model of the DW3000 behind dwt_ops/dwt_mcps_ops
+ *
+ *          A host build can run the code of Src/UWB without a board:
+ *          dw3000_sim_attach() points a dwchip_s at a driver whose op tables
+ *          read and write a model register file instead of the SPI. The
+ *          model keeps the chip clock, the receiver and transmitter state,
+ *          and fills the RX result registers (timestamp, CFO, PDOA, STS
+ *          quality, CIR diagnostics, DGC) of every frame at the addresses the
+ *          driver accessors and latchStats() read them from.
+ *
+ *          Traffic is scripted: dw3000_sim_script() queues frames and errors
+ *          at given chip times, dw3000_sim_advance() moves the clock and runs
+ *          the ISR of every event due, which calls the dw->callbacks the
+ *          MCPS layer registered, as the IRQ handler does on target. A frame
+ *          only reaches the callbacks if the receiver is on at its date, else
+ *          it is counted as missed; a receiver left on past its timeout gets
+ *          an RX timeout. Transfers, bytes, ioctls and events are counted for
+ *          benchmarks.
+ *
+ *          Each attached dwchip_s is its own chip, up to DW3000_SIM_NODES:
+ *          dw3000_sim_set_tx_hook() sees every frame handed to tx_frame(),
+ *          with its date, which is how dw3000_sim_medium.c connects them.
+ *
+ *          Only depends on the driver headers and the C library. Not part of
+ *          the firmware project.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef DW3000_SIM_H
+#define DW3000_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "deca_interface.h"
+
+#ifndef DW3000_SIM_SCRIPT_LEN
+#define DW3000_SIM_SCRIPT_LEN   64      /**< scripted events pending at once, per chip */
+#endif
+#ifndef DW3000_SIM_NODES
+#define DW3000_SIM_NODES        16      /**< chips simulated at once */
+#endif
+#define DW3000_SIM_PAC_DTU      2052    /**< receiver timeout unit: PAC of 8 symbols, 1.0256 us each */
+#define DW3000_SIM_RCTU_PER_DTU 256
+
+typedef enum
+{
+    DW3000_SIM_RX_OK = 0,   /**< good frame, RXFCG */
+    DW3000_SIM_RX_ERROR,    /**< PHY header or CRC error */
+} dw3000_sim_evt_e;
+
+/* A scripted event. The fields after len are the result registers of the
+ * frame: the same value goes to all three CIRs (IPATOV, STS1, STS2). */
+typedef struct
+{
+    uint32_t at_dtu;        /**< chip time of the RX marker */
+    uint8_t at_rctu;        /**< and the RCTU past at_dtu, for the RX timestamp */
+    dw3000_sim_evt_e type;
+    const uint8_t *data;    /**< copied when scripted, FCS included; NULL and len 0 for SP3 */
+    uint16_t len;
+    int16_t cfo;            /**< clock offset, Q26 ratio, 13 bits */
+    int16_t pdoa;           /**< [1:-11] radian, 14 bits */
+    int16_t sts_qual;       /**< 12 bits */
+    uint8_t dgc;            /**< DGC decision, 0..6 */
+    uint16_t index_fp;      /**< first path index */
+    uint32_t fp_ampl;       /**< first path amplitudes F1..F3, 22 bits */
+    uint32_t cir_power;     /**< 17 bits */
+    uint16_t accum;         /**< accumulated symbols, 12 bits */
+} dw3000_sim_frame_t;
+
+typedef struct
+{
+    uint32_t xfers;         /**< register accesses, one SPI transaction each on target */
+    uint32_t xfer_bytes;
+    uint32_t ioctls;
+    uint32_t irqs;          /**< ISR runs that found an event */
+    uint32_t tx;
+    uint32_t rx_ok;
+    uint32_t rx_err;
+    uint32_t rx_to;
+    uint32_t rx_missed;     /**< scripted frames with the receiver off */
+} dw3000_sim_stats_t;
+
+/* Called by tx_frame() with the frame and its TX date, chip time of dw */
+typedef void (*dw3000_sim_tx_hook_t)(struct dwchip_s *dw, const uint8_t *data, uint16_t len, uint32_t at_dtu);
+
+/**
+ * @brief make dw a simulated DW3000: driver and priv, chip clock at 0,
+ *        receiver off, empty script, cleared statistics
+ *
+ * @return the chip index, -1 if DW3000_SIM_NODES are attached already
+ */
+int dw3000_sim_attach(struct dwchip_s *dw);
+
+void dw3000_sim_detach(struct dwchip_s *dw);
+
+void dw3000_sim_set_tx_hook(dw3000_sim_tx_hook_t hook);
+
+/**
+ * @brief queue n events for dw, in any order
+ *
+ * @return events queued, fewer than n if the script is full
+ */
+int dw3000_sim_script(struct dwchip_s *dw, const dw3000_sim_frame_t *ev, int n);
+
+/**
+ * @brief move the chip clock forward by dtu and run the ISR of every TX
+ *        done, frame and timeout due by then, in date order
+ *
+ * @return ISR runs
+ */
+int dw3000_sim_advance(struct dwchip_s *dw, uint32_t dtu);
+
+/**
+ * @brief chip time, DTU
+ */
+uint32_t dw3000_sim_now(struct dwchip_s *dw);
+
+/**
+ * @brief last frame handed to tx_frame(), NULL if none
+ */
+const uint8_t *dw3000_sim_last_tx(struct dwchip_s *dw, uint16_t *len);
+
+void dw3000_sim_get_stats(struct dwchip_s *dw, dw3000_sim_stats_t *stats);
+void dw3000_sim_reset_stats(struct dwchip_s *dw);
+
+#endif /* DW3000_SIM_H */
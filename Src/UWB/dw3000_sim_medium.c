@@ -0,0 +1,190 @@
+/**
+ * @file    dw3000_sim_medium.c
+ *
+ * @brief   Simulated radio medium between DW3000 models
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <string.h>
+
+#include "dw3000_sim_medium.h"
+
+#define MEDIUM_RCTU_PER_M_Q16   (213139ULL * 65536ULL / 1000ULL) /**< 1 / (c * 15.65 ps), per meter */
+#define MEDIUM_CFO_PER_PPM_X100 671     /**< Q26 ratio of 0.01 ppm, / 1000 */
+
+/* Result registers of a frame: with these the first path and the CIR power
+ * are within 0.1 dB on a line of sight link, and 12 dB apart in NLOS */
+#define MEDIUM_CIR_POWER        4096
+#define MEDIUM_FP_AMPL          212000
+#define MEDIUM_ACCUM            64
+#define MEDIUM_INDEX_FP         (0x300 << 6)
+#define MEDIUM_STS_QUAL         200
+
+typedef struct
+{
+    struct dwchip_s *dw;
+    uint32_t clock_dtu;
+    int32_t ppm_x100;
+} medium_node_t;
+
+static struct
+{
+    medium_node_t node[DW3000_SIM_NODES];
+    int n;
+    dw3000_medium_link_t link[DW3000_SIM_NODES][DW3000_SIM_NODES];
+    uint32_t rand;
+    dw3000_medium_stats_t stats;
+} medium;
+
+/* @brief xorshift32, the loss draws */
+static uint32_t medium_rand(void)
+{
+    uint32_t x = medium.rand;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    medium.rand = x;
+    return x;
+}
+
+static int medium_find(struct dwchip_s *dw)
+{
+    for (int i = 0; i < medium.n; i++)
+    {
+        if (medium.node[i].dw == dw)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* @brief dw3000_sim tx hook: one reception per other node */
+static void medium_tx(struct dwchip_s *dw, const uint8_t *data, uint16_t len, uint32_t at_dtu)
+{
+    int from = medium_find(dw);
+
+    if (from < 0)
+    {
+        return;
+    }
+    medium.stats.sent++;
+
+    for (int to = 0; to < medium.n; to++)
+    {
+        const dw3000_medium_link_t *l = &medium.link[from][to];
+        dw3000_sim_frame_t f = {0};
+        uint64_t rctu;
+
+        if (to == from)
+        {
+            continue;
+        }
+        if (l->loss_pct && (medium_rand() % 100) < l->loss_pct)
+        {
+            medium.stats.lost++;
+            continue;
+        }
+
+        /* medium time of the TX, then chip time of the receiver */
+        rctu = (((uint64_t)l->distance_cm * MEDIUM_RCTU_PER_M_Q16 / 100) >> 16) + l->latency_rctu;
+        f.at_dtu = at_dtu - medium.node[from].clock_dtu + medium.node[to].clock_dtu +
+                   (uint32_t)(rctu / DW3000_SIM_RCTU_PER_DTU);
+        f.at_rctu = (uint8_t)(rctu % DW3000_SIM_RCTU_PER_DTU);
+
+        f.type = DW3000_SIM_RX_OK;
+        f.data = data;
+        f.len = len;
+        f.cfo = (int16_t)((medium.node[from].ppm_x100 - medium.node[to].ppm_x100) * MEDIUM_CFO_PER_PPM_X100 / 1000);
+        f.pdoa = l->pdoa;
+        f.sts_qual = MEDIUM_STS_QUAL;
+        f.index_fp = MEDIUM_INDEX_FP;
+        f.fp_ampl = l->nlos ? MEDIUM_FP_AMPL / 4 : MEDIUM_FP_AMPL;
+        f.cir_power = MEDIUM_CIR_POWER;
+        f.accum = MEDIUM_ACCUM;
+
+        if (dw3000_sim_script(medium.node[to].dw, &f, 1) == 1)
+        {
+            medium.stats.delivered++;
+        }
+        else
+        {
+            medium.stats.lost++;
+        }
+    }
+}
+
+void dw3000_medium_init(uint32_t seed)
+{
+    for (int i = 0; i < medium.n; i++)
+    {
+        dw3000_sim_detach(medium.node[i].dw);
+    }
+    memset(&medium, 0, sizeof(medium));
+    medium.rand = seed ? seed : 1;
+    dw3000_sim_set_tx_hook(medium_tx);
+}
+
+int dw3000_medium_add(struct dwchip_s *dw, uint32_t clock_dtu, int32_t ppm_x100)
+{
+    int i = medium.n;
+
+    if (i >= DW3000_SIM_NODES || dw3000_sim_attach(dw) < 0)
+    {
+        return -1;
+    }
+    medium.node[i].dw = dw;
+    medium.node[i].clock_dtu = clock_dtu;
+    medium.node[i].ppm_x100 = ppm_x100;
+    /* the chip clock starts at clock_dtu */
+    dw3000_sim_advance(dw, clock_dtu);
+
+    for (int k = 0; k <= i; k++)
+    {
+        dw3000_medium_link_t l = {.distance_cm = DW3000_MEDIUM_DEFAULT_CM};
+
+        medium.link[i][k] = l;
+        medium.link[k][i] = l;
+    }
+    medium.n++;
+    return i;
+}
+
+void dw3000_medium_set_link(int a, int b, const dw3000_medium_link_t *link)
+{
+    if (a < 0 || b < 0 || a >= medium.n || b >= medium.n)
+    {
+        return;
+    }
+    medium.link[a][b] = *link;
+    medium.link[b][a] = *link;
+}
+
+int dw3000_medium_run(uint32_t dtu, uint32_t step_dtu)
+{
+    int irqs = 0;
+
+    if (!step_dtu)
+    {
+        step_dtu = dtu;
+    }
+    while (dtu)
+    {
+        uint32_t step = (dtu < step_dtu) ? dtu : step_dtu;
+
+        for (int i = 0; i < medium.n; i++)
+        {
+            irqs += dw3000_sim_advance(medium.node[i].dw, step);
+        }
+        dtu -= step;
+    }
+    return irqs;
+}
+
+void dw3000_medium_get_stats(dw3000_medium_stats_t *stats)
+{
+    *stats = medium.stats;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file    dw3000_sim_medium.h
+ *
+ * @brief   Simulated radio medium between DW3000 models
+ *
+ *          dw3000_medium_add() attaches a dwchip_s to a simulated chip
+ *          (dw3000_sim.h) and makes it a node of the medium. Every frame a
+ *          node hands to tx_frame() is scripted on all the other nodes at its
+ *          TX date plus the time of flight of the link, in their own chip
+ *          time, with the result registers the link implies:
+ *
+ *          - distance: time of flight, RCTU resolution,
+ *          - loss: percentage of frames dropped, drawn per frame and receiver,
+ *          - latency: extra path delay, as multipath adds to the first path,
+ *          - NLOS: first path 12 dB down against the CIR power, which
+ *            calculateStats() reports as NLOS,
+ *          - the PDOA the receiver measures,
+ *          - the clock offset of both nodes, which gives the CFO.
+ *
+ *          Links are symmetric and default to DW3000_MEDIUM_DEFAULT_CM, no
+ *          loss, line of sight. dw3000_medium_run() moves all the nodes
+ *          forward in steps, running their ISRs: a frame has to be handed
+ *          to tx_frame() at least one step before its TX date, as delayed
+ *          TX always is in a ranging round.
+ *
+ *          Host only, not part of the firmware project.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef DW3000_SIM_MEDIUM_H
+#define DW3000_SIM_MEDIUM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dw3000_sim.h"
+
+#define DW3000_MEDIUM_DEFAULT_CM    100
+
+typedef struct
+{
+    uint32_t distance_cm;
+    uint8_t loss_pct;       /**< 0..100 */
+    uint32_t latency_rctu;  /**< path delay on top of the distance */
+    bool nlos;
+    int16_t pdoa;           /**< [1:-11] radian, at both ends */
+} dw3000_medium_link_t;
+
+typedef struct
+{
+    uint32_t sent;          /**< frames handed to tx_frame() */
+    uint32_t delivered;     /**< receptions scripted */
+    uint32_t lost;          /**< receptions dropped by the link loss */
+} dw3000_medium_stats_t;
+
+/**
+ * @brief empty the medium, seed the loss draws
+ */
+void dw3000_medium_init(uint32_t seed);
+
+/**
+ * @brief attach dw to a simulated chip and make it a node
+ *
+ * @param clock_dtu     chip time of the node when the medium time is 0
+ * @param ppm_x100      crystal offset of the node, 0.01 ppm
+ *
+ * @return the node index, -1 if no chip is left
+ */
+int dw3000_medium_add(struct dwchip_s *dw, uint32_t clock_dtu, int32_t ppm_x100);
+
+/**
+ * @brief set the link between nodes a and b, both ways
+ */
+void dw3000_medium_set_link(int a, int b, const dw3000_medium_link_t *link);
+
+/**
+ * @brief move all the nodes forward by dtu, step_dtu at a time
+ *
+ * @return ISR runs, all nodes
+ */
+int dw3000_medium_run(uint32_t dtu, uint32_t step_dtu);
+
+void dw3000_medium_get_stats(dw3000_medium_stats_t *stats);
+
+#endif /* DW3000_SIM_MEDIUM_H */
@@ -49,169 +49,223 @@
  *
  */
 
-#include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
 
 #include "deca_device_api.h"
 #include "dw3000_statistics.h"
 
-#define SIG_LVL_FACTOR     0.4     // Factor between 0 and 1; default 0.4 from experiments and simulations.
-#define SIG_LVL_THRESHOLD  12      // Threshold unit is dB; default 12dB from experiments and simulations.
-#define ALPHA_PRF_16       113.8   // Constant A for PRF of 16 MHz. See User Manual for more information.
-#define ALPHA_PRF_64       120.7   // Constant A for PRF of 64 MHz. See User Manual for more information.
+/* All levels in 0.001 dB */
+#define SIG_LVL_FACTOR_PCT 40      // Factor between 0 and 1; default 0.4 from experiments and simulations.
+#define SIG_LVL_THRESHOLD  12000   // Threshold unit is dB; default 12dB from experiments and simulations.
+#define ALPHA_PRF_16       113800  // Constant A for PRF of 16 MHz. See User Manual for more information.
+#define ALPHA_PRF_64       120700  // Constant A for PRF of 64 MHz. See User Manual for more information.
 #define RX_CODE_THRESHOLD  8       // For 64 MHz PRF the RX code is 9.
-#define LOG_CONSTANT_C0    63.2    // 10log10(2^21) = 63.2    // See User Manual for more information.
-#define LOG_CONSTANT_D0_E0 51.175  // 10log10(2^17) = 51.175  // See User Manual for more information.
-#define IP_MIN_THRESHOLD   3.3     // Minimum Signal Level in dB. Please see App Notes "APS006 PART 3"
-#define IP_MAX_THRESHOLD   6.0     // Minimum Signal Level in dB. Please see App Notes "APS006 PART 3"
-#define CONSTANT_PR_IP_A   0.39178 // Constant from simulations on DW device accumulator, please see App Notes "APS006 PART 3"
-#define CONSTANT_PR_IP_B   1.31719 // Constant from simulations on DW device accumulator, please see App Notes "APS006 PART 3"
-
-void calculateStats(struct dwchip_s *dw, struct mcps_diag_s *diag)
-{
-    /* Line-of-sight / Non-line-of-sight Variables */
-    uint32_t dev_id, D;
-    dwt_nlos_alldiag_t all_diag;
-    dwt_nlos_ipdiag_t index;
+#define LOG_CONSTANT_C0    63200   // 10log10(2^21) = 63.2    // See User Manual for more information.
+#define LOG_CONSTANT_D0_E0 51175   // 10log10(2^17) = 51.175  // See User Manual for more information.
+#define IP_MIN_THRESHOLD   3300    // Minimum Signal Level in dB. Please see App Notes "APS006 PART 3"
+#define IP_MAX_THRESHOLD   6000    // Minimum Signal Level in dB. Please see App Notes "APS006 PART 3"
+#define CONSTANT_PR_IP_A   39178   // 0.39178, constant from simulations on DW device accumulator, please see App Notes "APS006 PART 3"
+#define CONSTANT_PR_IP_B   131719  // 1.31719, constant from simulations on DW device accumulator, please see App Notes "APS006 PART 3"
+#define DGC_STEP           6000    // 6 dB per DGC decision step
+
+/* Result registers of a frame, CIA diagnostics not double buffered. Same
+ * fields, masks and sign extensions as the driver's DWT_READPDOA,
+ * DWT_READCLOCKOFFSET, DWT_READSTSQUALITY, DWT_NLOS_ALLDIAG, dwt_nlos_ipdiag
+ * and DWT_GETDGCDECISION, which read them one at a time. */
+#define RX_CIA_REG         0x0C001C    // CIA_TDOA_1_PDOA: first register of the block
+#define RX_CIA_LEN         0x50        // .. 0x0C:0x6B, up to the STS1 F2 amplitude
+#define RX_CIA_SHORT_LEN   6           // .. 0x0C:0x21, PDOA and CFO only
+#define RX_PDOA_REG        0x1C
+#define RX_CFO_REG         0x20
+#define RX_STS_REG         0x0D0000    // STS1 F3 amplitude .. STS2 accumulation count
+#define RX_STS_LEN         0x6C
+#define RX_DGC_REG         0x030060    // DGC_DBG, decision in byte 3
+#define RX_STS_QUAL_REG    0x020008    // STS_STS, 12 bit signed quality
+#define RX_ACC_MASK        0xFFF
+#define RX_FP_AMPL_MASK    0x3FFFFF
+#define CIA(reg)           ((reg) - RX_PDOA_REG) // offset in the first block of register 0x0C:reg
 
-    // All float variables used for recording different diagnostic results and probability.
-    float ip_f1, ip_f2, ip_f3, sts1_f1, sts1_f2, sts1_f3, sts2_f1, sts2_f2, sts2_f3 = 0;
-    float ip_n, sts1_n, sts2_n, ip_cp, sts1_cp, sts2_cp, ip_rsl, ip_fsl, sts1_rsl, sts1_fsl, sts2_rsl, sts2_fsl = 0;
-    float pr_nlos, sl_diff_ip, sl_diff_sts1, sl_diff_sts2, sl_diff, index_diff = 0;
-    float alpha, ip_alpha, log_constant = 0;
+#define SIG_LVL_MIN        (SIG_LVL_THRESHOLD * SIG_LVL_FACTOR_PCT / 100)
 
-    dev_id = dw->dwt_driver->devid;
+#define LOG2_LUT_BITS      5
+#define DB_PER_LOG2_Q16    (197283018) /* 10log10(2) in 0.001 dB, Q16 */
+#define DB_OF_ZERO         (-1000000)  /* 10log10(0), well below any real level */
 
-    if ((dev_id == (uint32_t)DWT_DW3000_DEV_ID) || (dev_id == (uint32_t)DWT_DW3000_PDOA_DEV_ID))
+/* log2(1 + i / 2^LOG2_LUT_BITS), Q16 */
+static const uint32_t log2_lut_q16[(1 << LOG2_LUT_BITS) + 1] = {
+    0, 2909, 5732, 8473, 11136, 13727, 16248, 18704,
+    21098, 23433, 25711, 27936, 30109, 32234, 34312, 36346,
+    38336, 40286, 42196, 44068, 45904, 47705, 49472, 51207,
+    52911, 54584, 56229, 57845, 59434, 60997, 62534, 64047,
+    65536,
+};
+
+/* @brief 10log10(x) in 0.001 dB
+ */
+static int32_t db_mdb(uint64_t x)
+{
+    uint32_t e, m, idx, frac;
+    int32_t l;
+
+    if (x == 0)
     {
-        log_constant = LOG_CONSTANT_C0;
+        return DB_OF_ZERO;
     }
-    else
+
+    /* x = 2^e * (1 + m / 2^16) */
+    e = 63 - __builtin_clzll(x);
+    m = (uint32_t)((e >= 16) ? (x >> (e - 16)) : (x << (16 - e))) & 0xFFFF;
+
+    idx = m >> (16 - LOG2_LUT_BITS);
+    frac = m & ((1 << (16 - LOG2_LUT_BITS)) - 1);
+    l = log2_lut_q16[idx] + (((log2_lut_q16[idx + 1] - log2_lut_q16[idx]) * frac) >> (16 - LOG2_LUT_BITS));
+
+    return (int32_t)((((int64_t)e << 16) + l) * DB_PER_LOG2_Q16 >> 32);
+}
+
+/* @brief receive and first path signal levels of one CIR, less the alpha
+ *        and DGC terms common to both
+ */
+static void cir_levels(const struct mcps_diag_cir_s *cir, int32_t log_constant, int32_t *rsl, int32_t *fsl)
+{
+    uint64_t fp = 0;
+    int32_t n2 = 2 * db_mdb(cir->accum_count);
+
+    for (int i = 0; i < 3; i++)
     {
-        log_constant = LOG_CONSTANT_D0_E0;
+        uint64_t f = cir->f[i] / 4; // The First Path Amplitude magnitude value (it has 2 fractional bits)
+        fp += f * f;
     }
-    // Select IPATOV to read Ipatov diagnostic registers from API function dwt_nlos_alldiag()
-    all_diag.diag_type = IPATOV;
-    dw->dwt_driver->dwt_ops->ioctl(dw, DWT_NLOS_ALLDIAG, 0, (void *)&all_diag);
-    ip_alpha = (dw->config->rxtx_config->pdwCfg->rxCode > RX_CODE_THRESHOLD) ? (-(ALPHA_PRF_64 + 1)) : -(ALPHA_PRF_16);
-    ip_n = all_diag.accumCount; // The number of preamble symbols accumulated
-    ip_f1 = all_diag.F1 / 4;    // The First Path Amplitude (point 1) magnitude value (it has 2 fractional bits),
-    ip_f2 = all_diag.F2 / 4;    // The First Path Amplitude (point 2) magnitude value (it has 2 fractional bits),
-    ip_f3 = all_diag.F3 / 4;    // The First Path Amplitude (point 3) magnitude value (it has 2 fractional bits),
-    ip_cp = all_diag.cir_power;
-
-    // Select STS1 to read STS1 diagnostic registers from API function dwt_nlos_alldiag()
-    all_diag.diag_type = STS1;
-    dw->dwt_driver->dwt_ops->ioctl(dw, DWT_NLOS_ALLDIAG, 0, (void *)&all_diag);
-    alpha = -(ALPHA_PRF_64 + 1);
-    sts1_n = all_diag.accumCount; // The number of preamble symbols accumulated
-    sts1_f1 = all_diag.F1 / 4;    // The First Path Amplitude (point 1) magnitude value (it has 2 fractional bits),
-    sts1_f2 = all_diag.F2 / 4;    // The First Path Amplitude (point 2) magnitude value (it has 2 fractional bits),
-    sts1_f3 = all_diag.F3 / 4;    // The First Path Amplitude (point 3) magnitude value (it has 2 fractional bits),
-    sts1_cp = all_diag.cir_power;
-
-    // Select STS2 to read STS2 diagnostic registers from API function dwt_nlos_alldiag()
-    all_diag.diag_type = STS2;
-    dw->dwt_driver->dwt_ops->ioctl(dw, DWT_NLOS_ALLDIAG, 0, (void *)&all_diag);
-    sts2_n = all_diag.accumCount; // The number of preamble symbols accumulated
-    sts2_f1 = all_diag.F1 / 4;    // The First Path Amplitude (point 1) magnitude value (it has 2 fractional bits),
-    sts2_f2 = all_diag.F2 / 4;    // The First Path Amplitude (point 2) magnitude value (it has 2 fractional bits),
-    sts2_f3 = all_diag.F3 / 4;    // The First Path Amplitude (point 3) magnitude value (it has 2 fractional bits),
-    sts2_cp = all_diag.cir_power;
 
     // The calculation of First Path Power Level(FSL) and Receive Signal Power Level(RSL) is taken from
     // DW3000 User Manual section 4.7.1 & 4.7.2
+    *rsl = db_mdb(cir->cir_power) - n2 + log_constant;
+    *fsl = db_mdb(fp) - n2;
+}
 
-    // For IPATOV
-    ip_n *= ip_n;
-    ip_f1 *= ip_f1;
-    ip_f2 *= ip_f2;
-    ip_f3 *= ip_f3;
+/* @brief little endian field of a register block, masked */
+static uint32_t reg_field(const uint8_t *blk, uint32_t off, uint32_t mask)
+{
+    return ((uint32_t)blk[off] | ((uint32_t)blk[off + 1] << 8) |
+            ((uint32_t)blk[off + 2] << 16) | ((uint32_t)blk[off + 3] << 24)) & mask;
+}
 
-    // FOR STS1
-    sts1_n *= sts1_n;
-    sts1_f1 *= sts1_f1;
-    sts1_f2 *= sts1_f2;
-    sts1_f3 *= sts1_f3;
+/* @brief sign extend the low bits of v */
+static int16_t sign_extend(uint32_t v, int bits)
+{
+    return (int16_t)((int32_t)(v << (32 - bits)) >> (32 - bits));
+}
 
-    // For STS2
-    sts2_n *= sts2_n;
-    sts2_f1 *= sts2_f1;
-    sts2_f2 *= sts2_f2;
-    sts2_f3 *= sts2_f3;
+static void cir_fields(struct mcps_diag_cir_s *cir, const uint8_t *acc, const uint8_t *f1, const uint8_t *f2,
+                       const uint8_t *f3, const uint8_t *pwr, uint32_t pwr_mask)
+{
+    cir->accum_count = reg_field(acc, 0, RX_ACC_MASK);
+    cir->f[0] = reg_field(f1, 0, RX_FP_AMPL_MASK);
+    cir->f[1] = reg_field(f2, 0, RX_FP_AMPL_MASK);
+    cir->f[2] = reg_field(f3, 0, RX_FP_AMPL_MASK);
+    cir->cir_power = reg_field(pwr, 0, pwr_mask);
+}
 
-    //    D = all_diag.D * 6;
-    uint8_t tmp = 0;
-    dw->dwt_driver->dwt_ops->ioctl(dw, DWT_GETDGCDECISION, 0, (void *)&tmp);
-    D = tmp * 6;
+int latchStats(struct dwchip_s *dw, struct dwt_mcps_rx_regs_s *regs, bool diag)
+{
+    const struct dwt_ops_s *ops = dw->dwt_driver->dwt_ops;
+    dwt_config_t *cfg = dw->config->rxtx_config->pdwCfg;
+    uint32_t dev_id = dw->dwt_driver->devid;
+    struct mcps_diag_raw_s *raw = &regs->raw;
+    /* + 3: reg_field() reads whole words */
+    uint8_t cia[RX_CIA_LEN + 3], sts[RX_STS_LEN + 3], dgc;
+    uint16_t sts_qual;
+    int n = 0;
 
-    // Calculate the First Signal Level(FSL) and Receive Signal Level(RSL) then subtract FSL from RSL
-    // to find out Signal Level Difference which is compared to defined Signal Threshold.
+    /* PDOA and CFO, and with the diagnostics everything up to STS1 F2 */
+    ops->xfer(dw, RX_CIA_REG, 0, diag ? RX_CIA_LEN : RX_CIA_SHORT_LEN, cia, DW3000_SPI_RD_BIT);
+    n++;
+    regs->pdoa = sign_extend(reg_field(cia, CIA(RX_PDOA_REG) + 2, 0x3FFF), 14);
+    regs->cfo = sign_extend(reg_field(cia, CIA(RX_CFO_REG), 0x1FFF), 13);
 
-    // For the CIR Ipatov.
-    ip_rsl = 10 * log10((float)ip_cp / ip_n) + ip_alpha + log_constant + D;
-    ip_fsl = 10 * log10(((ip_f1 + ip_f2 + ip_f3) / ip_n)) + ip_alpha + D;
+    regs->sts_qual = 0;
+    if (cfg->stsMode != DWT_STS_MODE_OFF)
+    {
+        ops->xfer(dw, RX_STS_QUAL_REG, 0, sizeof(sts_qual), (uint8_t *)&sts_qual, DW3000_SPI_RD_BIT);
+        n++;
+        regs->sts_qual = sign_extend(sts_qual, 12);
+    }
 
-    // Signal Level Difference value for IPATOV.
-    sl_diff_ip = ip_rsl - ip_fsl;
+    regs->diag = diag;
+    if (!diag)
+    {
+        return n;
+    }
 
-    // For the CIR STS1.
-    sts1_rsl = 10 * log10((float)sts1_cp / sts1_n) + alpha + log_constant + D;
-    sts1_fsl = 10 * log10(((sts1_f1 + sts1_f2 + sts1_f3) / sts1_n)) + alpha + D;
+    ops->xfer(dw, RX_STS_REG, 0, RX_STS_LEN, sts, DW3000_SPI_RD_BIT);
+    ops->xfer(dw, RX_DGC_REG, 3, 1, &dgc, DW3000_SPI_RD_BIT);
+    n += 2;
 
-    // For the CIR STS2.
-    sts2_rsl = 10 * log10((float)sts2_cp / sts2_n) + alpha + log_constant + D;
-    sts2_fsl = 10 * log10(((sts2_f1 + sts2_f2 + sts2_f3) / sts2_n)) + alpha + D;
+    cir_fields(&raw->cir[0], &cia[CIA(0x58)], &cia[CIA(0x30)], &cia[CIA(0x34)], &cia[CIA(0x38)],
+               &cia[CIA(0x2C)], 0x1FFFF);
+    cir_fields(&raw->cir[1], &sts[0x20], &cia[CIA(0x64)], &cia[CIA(0x68)], &sts[0x00],
+               &cia[CIA(0x60)], 0xFFFFF);
+    cir_fields(&raw->cir[2], &sts[0x68], &sts[0x40], &sts[0x44], &sts[0x48],
+               &sts[0x3C], 0xFFFFF);
 
-    // STS Mode OFF, Signal Level Difference of STS1 and STS2 is zero.
-    if (dw->config->rxtx_config->pdwCfg->stsMode == DWT_STS_MODE_OFF)
+    /* needed only when the signal level differences are low, but gone by the next frame */
+    raw->index_fp = reg_field(cia, CIA(0x48), 0xFFFF);
+    raw->index_pp = (uint16_t)((reg_field(cia, CIA(0x28), 0xFFFFFFFF) >> 21) << 6);
+
+    raw->dgc_decision = (dgc >> 4) & 0x7;
+
+    raw->prf64 = (cfg->rxCode > RX_CODE_THRESHOLD);
+    raw->dw3000 = (dev_id == (uint32_t)DWT_DW3000_DEV_ID) || (dev_id == (uint32_t)DWT_DW3000_PDOA_DEV_ID);
+    raw->sts_on = (cfg->stsMode != DWT_STS_MODE_OFF);
+    raw->pdoa_m3 = (cfg->pdoaMode == DWT_PDOA_M3);
+
+    return n;
+}
+
+void calculateStats(struct mcps_diag_s *diag)
+{
+    const struct mcps_diag_raw_s *raw = &diag->raw;
+    int32_t log_constant = raw->dw3000 ? LOG_CONSTANT_C0 : LOG_CONSTANT_D0_E0;
+    int32_t ip_alpha = raw->prf64 ? -(ALPHA_PRF_64 + 1000) : -(ALPHA_PRF_16);
+    int32_t rsl[3], fsl[3];
+    int32_t sl_diff_ip, sl_diff_sts1, sl_diff_sts2, sl_diff, pr_nlos;
+
+    if (!diag->pending)
     {
-        sl_diff_sts1 = 0;
-        sl_diff_sts2 = 0;
+        return;
     }
-    else // If PDOA MODE 3 is enabled then there's Signal Level Difference value for all IPATOV, STS1 and STS2.
-    {
-        sl_diff_sts1 = sts1_rsl - sts1_fsl;
+    diag->pending = false;
 
-        // IF PDOA MODE 3 is not enabled then Signal Level Difference of STS2 is zero.
-        if (dw->config->rxtx_config->pdwCfg->pdoaMode != DWT_PDOA_M3)
-        {
-            sl_diff_sts2 = 0;
-        }
-        else
-        {
-            sl_diff_sts2 = sts2_rsl - sts2_fsl;
-        }
+    for (int i = 0; i < 3; i++)
+    {
+        cir_levels(&raw->cir[i], log_constant, &rsl[i], &fsl[i]);
     }
 
-    /* Check for Line-of-sight or Non-line-of-sight */
-    // The Signal Level Threshold is 12 dB, based on the experiments and simulations if the received signal power is above
-    // 12 dB then the Signal is Non Line of Sight.
+    // Signal Level Difference value for IPATOV: alpha and D cancel out.
+    sl_diff_ip = rsl[0] - fsl[0];
 
-    // Calculating the probability of NLOS.
-    // 1. If the signal level difference of IPATOV, STS1 or STS2 is greater than 12 dB then the signal is Non Line of sight.
+    // STS Mode OFF, Signal Level Difference of STS1 and STS2 is zero.
+    // IF PDOA MODE 3 is not enabled then Signal Level Difference of STS2 is zero.
+    sl_diff_sts1 = raw->sts_on ? (rsl[1] - fsl[1]) : 0;
+    sl_diff_sts2 = (raw->sts_on && raw->pdoa_m3) ? (rsl[2] - fsl[2]) : 0;
 
+    /* Check for Line-of-sight or Non-line-of-sight */
+    // 1. If the signal level difference of IPATOV, STS1 or STS2 is greater than 12 dB then the signal is Non Line of sight.
     if ((sl_diff_ip > SIG_LVL_THRESHOLD) || (sl_diff_sts1 > SIG_LVL_THRESHOLD) || (sl_diff_sts2 > SIG_LVL_THRESHOLD))
     {
         pr_nlos = 100;
-        // test_run_info((unsigned char *)"Non-Line of sight");
     }
-
-    // If the received signal power is in between 4.8 dB and 12 dB then there's a possibility that the signal is
-    // Non Line of Sight and probabilty of it being Non Line of Sight signal is calculated.
-
     // 2. If the signal level difference of IPATOV, STS1 or STS2 is greater than
     //    (Signal Level Threshold(12) * Signal Level Factor(0.4)) = 4.8 dB but less than 12 dB, then calculate the
     //    probability of Non Line of sight based on the signal has greater strength(IPATOV, STS1 or STS2).
-
-    else if ((sl_diff_ip > SIG_LVL_THRESHOLD * SIG_LVL_FACTOR) || (sl_diff_sts1 > SIG_LVL_THRESHOLD * SIG_LVL_FACTOR) || (sl_diff_sts2 > SIG_LVL_THRESHOLD * SIG_LVL_FACTOR))
+    else if ((sl_diff_ip > SIG_LVL_MIN) || (sl_diff_sts1 > SIG_LVL_MIN) || (sl_diff_sts2 > SIG_LVL_MIN))
     {
-        if (sl_diff_ip > SIG_LVL_THRESHOLD * SIG_LVL_FACTOR)
+        if (sl_diff_ip > SIG_LVL_MIN)
         {
             sl_diff = sl_diff_ip;
         }
-        else if (sl_diff_sts1 > SIG_LVL_THRESHOLD * SIG_LVL_FACTOR)
+        else if (sl_diff_sts1 > SIG_LVL_MIN)
         {
             sl_diff = sl_diff_sts1;
         }
@@ -220,41 +274,31 @@ void calculateStats(struct dwchip_s *dw, struct mcps_diag_s *diag)
             sl_diff = sl_diff_sts2;
         }
 
-        pr_nlos = 100 * ((sl_diff / SIG_LVL_THRESHOLD - SIG_LVL_FACTOR) / (1 - SIG_LVL_FACTOR));
-        // snprintf(prob_str, sizeof(prob_str), "Probability of NLOS: %3.2f", fabsf(pr_nlos));
-        // test_run_info((unsigned char *)prob_str);
+        // 100 * (sl_diff / threshold - factor) / (1 - factor)
+        pr_nlos = (sl_diff - SIG_LVL_MIN) * 100 / (SIG_LVL_THRESHOLD - SIG_LVL_MIN);
     }
-
-    // 3. If the signal is less than the Combined Threshold (Signal Level Threshold(12) * Signal Level Factor(0.4)) for all three
-    //    IPATOV, STS1 and STS2 reported through dwt_nlos_alldiag() then check the IPATOV Diagnostic First Path and Peak Path Index
-    //    through dwt_nlos_ipdiag().
-
-    //    3.a. If the Index difference is less than 3.3 dB then it's a Line of Sight signal.
-    //    3.b. If the Index difference is greater than 3.3 dB and less than 6 dB then the probability of Non Line of Sight
-    //         is calculated.
-    //    3.c. If the Index level is greater than 6 dB then it's a Non Line of Sight signal.
+    // 3. Otherwise the IPATOV First Path and Peak Path Index difference, in 1/32:
+    //    3.a. less than 3.3 : Line of Sight.
+    //    3.b. between 3.3 and 6 : the probability of Non Line of Sight is calculated.
+    //    3.c. greater than 6 : Non Line of Sight.
     else
     {
-        dwt_nlos_ipdiag(&index);
-        index_diff = ((float)index.index_pp_u32 - (float)index.index_fp_u32) / 32;
+        int32_t index_diff = (int32_t)(((int64_t)raw->index_pp - (int64_t)raw->index_fp) * 1000 / 32);
 
         if (index_diff <= IP_MIN_THRESHOLD)
         {
             pr_nlos = 0;
-            // test_run_info((unsigned char *)"Line of Sight");
         }
-        else if ((index_diff > IP_MIN_THRESHOLD) && (index_diff < IP_MAX_THRESHOLD))
+        else if (index_diff < IP_MAX_THRESHOLD)
         {
-            pr_nlos = 100 * ((CONSTANT_PR_IP_A * index_diff) - CONSTANT_PR_IP_B);
-            // snprintf(prob_str, sizeof(prob_str), "**Probability of NLOS: %3.2f", fabsf(pr_nlos));
-            // test_run_info((unsigned char *)prob_str);
+            pr_nlos = (int32_t)(((int64_t)CONSTANT_PR_IP_A * index_diff / 1000 - CONSTANT_PR_IP_B) / 1000);
         }
         else
         {
             pr_nlos = 100;
-            // test_run_info((unsigned char *)"Non-Line of Sight");
         }
     }
-    diag->rssi = ip_rsl;
-    diag->non_line_of_sight = fabsf(pr_nlos);
+
+    diag->rssi_mdbm = rsl[0] + ip_alpha + raw->dgc_decision * DGC_STEP;
+    diag->nlos_pct = (uint8_t)abs(pr_nlos);
 }
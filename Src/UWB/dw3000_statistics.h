@@ -56,6 +56,19 @@
 #include "deca_interface.h"
 #include "dw3000_mcps_mcu.h"
 
-void calculateStats(struct dwchip_s *dw, struct mcps_diag_s *diag);
+/**
+ * @brief RX ISR: read the result registers of the frame just received into
+ *        regs in block reads, 1 or 2 without diag, 4 with, instead of one
+ *        driver call per field; no arithmetic beyond masking
+ *
+ * @return the number of SPI reads
+ */
+int latchStats(struct dwchip_s *dw, struct dwt_mcps_rx_regs_s *regs, bool diag);
+
+/**
+ * @brief compute diag->rssi_mdbm and diag->nlos_pct from the latched
+ *        registers, in fixed point, if not done yet for this frame
+ */
+void calculateStats(struct mcps_diag_s *diag);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,199 @@
+/**
+ * @file    fh_schedule.c
+ *
+ * @brief   Keyed frequency-hop schedule of the FiRa session
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "mcps_crypto.h"
+#include "fh_schedule.h"
+
+#define FH_AES_BLOCK_LEN    16
+#define FH_RING_LEN         (2 * FH_SCHEDULE_AHEAD)
+#define FH_PENDING          0x10000UL   /**< pending word: staged flag | chan << 8 | pcode */
+
+_Static_assert(FH_SCHEDULE_AHEAD == FH_AES_BLOCK_LEN, "one keystream byte per block");
+
+extern uint8_t update_channel_pcode;
+
+static const uint8_t fh_channels[] = {5, 9};
+static const uint8_t fh_codes_prf16[] = {3, 4};
+static const uint8_t fh_codes_prf64[] = {9, 10, 11, 12};
+
+static struct
+{
+    void *ctx;                  /**< AES-ECB context, NULL when stopped */
+    uint8_t in[FH_AES_BLOCK_LEN];
+    const uint8_t *codes;
+    uint8_t codes_mask;         /**< number of codes - 1, a power of 2 */
+    uint32_t first;             /**< first block held in ring */
+    uint32_t next;              /**< block after the last one held */
+    fh_hop_t ring[FH_RING_LEN];
+    fh_hop_t last;              /**< last hop staged, or the configured one */
+} fh;
+
+static uint32_t fh_pending;
+static fh_schedule_stats_t fh_stats;
+
+/* @brief hops of the FH_SCHEDULE_AHEAD blocks starting at fh.next
+ * */
+static void fh_fill(void)
+{
+    uint32_t counter = fh.next / FH_SCHEDULE_AHEAD;
+    uint8_t out[FH_AES_BLOCK_LEN];
+
+    fh.in[12] = (uint8_t)counter;
+    fh.in[13] = (uint8_t)(counter >> 8);
+    fh.in[14] = (uint8_t)(counter >> 16);
+    fh.in[15] = (uint8_t)(counter >> 24);
+
+    if (mcps_crypto_aes_ecb_128_encrypt(fh.ctx, fh.in, sizeof(fh.in), out) != UWBMAC_SUCCESS)
+    {
+        /* stay on the configured channel rather than lose the peer */
+        memset(out, 0, sizeof(out));
+    }
+
+    for (int i = 0; i < FH_SCHEDULE_AHEAD; i++)
+    {
+        fh_hop_t *hop = &fh.ring[(fh.next + i) % FH_RING_LEN];
+
+        hop->chan = fh_channels[out[i] & 1];
+        hop->pcode = fh.codes[(out[i] >> 1) & fh.codes_mask];
+    }
+    fh.next += FH_SCHEDULE_AHEAD;
+}
+
+int fh_schedule_init(const uint8_t *key, uint32_t session_id, const uint8_t *vupper64,
+                     uint8_t chan, uint8_t pcode)
+{
+    fh_schedule_deinit();
+
+    fh.ctx = mcps_crypto_aes_ecb_128_create(key);
+    if (!fh.ctx)
+    {
+        return -1;
+    }
+
+    fh.in[0] = (uint8_t)session_id;
+    fh.in[1] = (uint8_t)(session_id >> 8);
+    fh.in[2] = (uint8_t)(session_id >> 16);
+    fh.in[3] = (uint8_t)(session_id >> 24);
+    memcpy(&fh.in[4], vupper64, 8);
+
+    if (pcode == 3 || pcode == 4)
+    {
+        fh.codes = fh_codes_prf16;
+        fh.codes_mask = sizeof(fh_codes_prf16) - 1;
+    }
+    else
+    {
+        fh.codes = fh_codes_prf64;
+        fh.codes_mask = sizeof(fh_codes_prf64) - 1;
+    }
+
+    fh.first = 0;
+    fh.next = 0;
+    fh.last.chan = chan;
+    fh.last.pcode = pcode;
+    memset(&fh_stats, 0, sizeof(fh_stats));
+
+    return 0;
+}
+
+void fh_schedule_deinit(void)
+{
+    __atomic_store_n(&fh_pending, 0, __ATOMIC_RELAXED);
+
+    if (fh.ctx)
+    {
+        mcps_crypto_aes_ecb_128_destroy(fh.ctx);
+    }
+    memset(&fh, 0, sizeof(fh));
+}
+
+bool fh_schedule_hop(uint32_t block, fh_hop_t *hop)
+{
+    if (!fh.ctx)
+    {
+        return false;
+    }
+
+    /* jumped back, or further than the ring can follow: restart from block */
+    if (block < fh.first || block >= fh.next + FH_SCHEDULE_AHEAD)
+    {
+        fh.first = block - (block % FH_SCHEDULE_AHEAD);
+        fh.next = fh.first;
+    }
+
+    while (fh.next <= block + FH_SCHEDULE_AHEAD)
+    {
+        fh_fill();
+        if (fh.next - fh.first > FH_RING_LEN)
+        {
+            fh.first += FH_SCHEDULE_AHEAD;
+        }
+    }
+
+    *hop = fh.ring[block % FH_RING_LEN];
+    return true;
+}
+
+bool fh_schedule_stage(uint32_t block, fh_hop_t *hop)
+{
+    uint32_t prev;
+
+    if (!fh_schedule_hop(block, hop))
+    {
+        return false;
+    }
+    if (hop->chan == fh.last.chan && hop->pcode == fh.last.pcode)
+    {
+        return false;
+    }
+    fh.last = *hop;
+
+    prev = __atomic_exchange_n(&fh_pending, FH_PENDING | ((uint32_t)hop->chan << 8) | hop->pcode, __ATOMIC_RELEASE);
+    if (prev)
+    {
+        fh_stats.dropped++;
+    }
+    fh_stats.staged++;
+    __atomic_store_n(&update_channel_pcode, 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+bool fh_schedule_take(fh_hop_t *hop)
+{
+    uint32_t p = __atomic_exchange_n(&fh_pending, 0, __ATOMIC_ACQUIRE);
+
+    if (!p)
+    {
+        return false;
+    }
+    hop->chan = (uint8_t)(p >> 8);
+    hop->pcode = (uint8_t)p;
+    return true;
+}
+
+void fh_schedule_account(uint32_t us, bool late)
+{
+    fh_stats.reconf++;
+    fh_stats.reconf_late += late;
+    fh_stats.reconf_last_us = us;
+    fh_stats.reconf_sum_us += us;
+    if (us > fh_stats.reconf_max_us)
+    {
+        fh_stats.reconf_max_us = us;
+    }
+}
+
+void fh_schedule_get_stats(fh_schedule_stats_t *stats)
+{
+    *stats = fh_stats;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file    fh_schedule.h
+ *
+ * @brief   Keyed frequency-hop schedule of the FiRa session
+ *
+ *          The channel and preamble code of every ranging block come from an
+ *          AES-128 keystream: the session key encrypts {session id, vUpper64,
+ *          counter} and each output byte picks the hop of one block, so two
+ *          nodes with the same key and session parameters follow the same
+ *          sequence without exchanging it. Only channels 5 and 9 are used, and
+ *          only preamble codes of the PRF the session was configured with.
+ *
+ *          Hops are computed FH_SCHEDULE_AHEAD blocks in advance, one AES
+ *          block at a time, on the report path. The hop of the next block is
+ *          staged there and applied by the deep sleep wake-up sequence
+ *          (lp_timer_fira(), update_channel_pcode), which reconfigures the chip
+ *          before the block starts instead of resetting the session.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef FH_SCHEDULE_H
+#define FH_SCHEDULE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FH_SCHEDULE_AHEAD   16  /**< blocks computed in advance, the hops of one AES block */
+
+typedef struct
+{
+    uint8_t chan;   /**< 5 or 9 */
+    uint8_t pcode;  /**< 3..4 (PRF 16M) or 9..12 (PRF 64M) */
+} fh_hop_t;
+
+typedef struct
+{
+    uint32_t staged;        /**< hops handed to the wake-up sequence */
+    uint32_t dropped;       /**< staged hops replaced before a wake-up applied them */
+    uint32_t reconf;        /**< chip reconfigurations on wake-up */
+    uint32_t reconf_late;   /**< reconfigurations that overran their wake-up slot */
+    uint32_t reconf_last_us;
+    uint32_t reconf_max_us;
+    uint32_t reconf_sum_us;
+} fh_schedule_stats_t;
+
+/**
+ * @brief start the schedule of a session, chan and pcode are the configured
+ *        ones: the chip is on them until the first hop
+ *
+ * @return 0 on success, -1 if the AES context could not be created
+ */
+int fh_schedule_init(const uint8_t *key, uint32_t session_id, const uint8_t *vupper64,
+                     uint8_t chan, uint8_t pcode);
+
+/**
+ * @brief stop the schedule, drop any staged hop and the key
+ */
+void fh_schedule_deinit(void);
+
+/**
+ * @brief hop of a block, computes the next FH_SCHEDULE_AHEAD blocks if needed
+ *
+ * @return false if the schedule is not running
+ */
+bool fh_schedule_hop(uint32_t block, fh_hop_t *hop);
+
+/**
+ * @brief stage the hop of block for the next wake-up, if it changes the
+ *        channel or code
+ *
+ * @return true if a hop was staged, *hop holds it
+ */
+bool fh_schedule_stage(uint32_t block, fh_hop_t *hop);
+
+/**
+ * @brief wake-up side: take the staged hop, ISR safe
+ *
+ * @return false if none is staged
+ */
+bool fh_schedule_take(fh_hop_t *hop);
+
+/**
+ * @brief wake-up side: account one reconfiguration of the chip
+ */
+void fh_schedule_account(uint32_t us, bool late);
+
+void fh_schedule_get_stats(fh_schedule_stats_t *stats);
+
+#endif /* FH_SCHEDULE_H */
@@ -0,0 +1,92 @@
+/**
+ * @file    skb_pool.c
+ *
+ * @brief   Fixed pool of sk_buff for the UWB frame path
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "linux/skbuff.h"
+#include "dw3000_mcps_mcu.h"
+#include "skb_pool.h"
+
+/* One RX frame in flight per ISR ring slot, the deferred TX copy and a spare */
+#define SKB_POOL_SIZE   (MCPS_RX_MSG_MAX + 2)
+
+_Static_assert(SKB_POOL_SIZE <= 32, "one bit per slot");
+_Static_assert(SKB_POOL_DATA_LEN >= MCPS_RX_MSG_LEN, "a slot holds any received frame");
+
+struct skb_pool_slot
+{
+    struct sk_buff skb; /**< must be first: the slot address is the sk_buff address */
+    uint8_t data[SKB_POOL_DATA_LEN];
+};
+
+static struct skb_pool_slot pool[SKB_POOL_SIZE];
+static uint32_t pool_used;  /**< bit i: pool[i] taken */
+static skb_pool_stats_t pool_stats = { .size = SKB_POOL_SIZE };
+
+static void atomic_max(uint32_t *p, uint32_t v)
+{
+    uint32_t cur = __atomic_load_n(p, __ATOMIC_RELAXED);
+
+    while (v > cur && !__atomic_compare_exchange_n(p, &cur, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+struct sk_buff *skb_pool_alloc(void)
+{
+    uint32_t used = __atomic_load_n(&pool_used, __ATOMIC_RELAXED);
+    uint32_t free_mask, bit;
+    struct skb_pool_slot *slot;
+
+    do
+    {
+        free_mask = ~used & ((1UL << SKB_POOL_SIZE) - 1);
+        if (!free_mask)
+        {
+            __atomic_fetch_add(&pool_stats.exhausted, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+        bit = (uint32_t)__builtin_ctz(free_mask);
+    } while (!__atomic_compare_exchange_n(&pool_used, &used, used | (1UL << bit), true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    __atomic_fetch_add(&pool_stats.allocs, 1, __ATOMIC_RELAXED);
+    atomic_max(&pool_stats.hwm, (uint32_t)__builtin_popcount(used | (1UL << bit)));
+
+    slot = &pool[bit];
+    memset(&slot->skb, 0, sizeof(slot->skb));
+    slot->skb.head = slot->data;
+    slot->skb.data = slot->data;
+    slot->skb.end = slot->data + SKB_POOL_DATA_LEN;
+
+    return &slot->skb;
+}
+
+bool skb_pool_release(void *p)
+{
+    uintptr_t off = (uintptr_t)p - (uintptr_t)pool;
+
+    if (off >= sizeof(pool))
+    {
+        return false;
+    }
+    __atomic_fetch_and(&pool_used, ~(1UL << (off / sizeof(pool[0]))), __ATOMIC_RELEASE);
+    return true;
+}
+
+void skb_pool_free(struct sk_buff *skb)
+{
+    (void)skb_pool_release(skb);
+}
+
+void skb_pool_get_stats(skb_pool_stats_t *stats)
+{
+    *stats = pool_stats;
+    stats->used = (uint32_t)__builtin_popcount(__atomic_load_n(&pool_used, __ATOMIC_RELAXED));
+}
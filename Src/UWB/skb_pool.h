@@ -0,0 +1,59 @@
+/**
+ * @file    skb_pool.h
+ *
+ * @brief   Fixed pool of sk_buff for the UWB frame path
+ *
+ *          rx_get_frame() and the deferred (deep sleep) TX take their sk_buff,
+ *          and the TX its data copy, from a static pool instead of the heap.
+ *          A slot is claimed and released with a compare-and-swap on a bitmap,
+ *          so both are O(1), lock free and usable from an ISR.
+ *
+ *          The MAC frees the RX sk_buff with kfree_skb(), which ends up in
+ *          free(): free() hands a pool address back with skb_pool_release().
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef SKB_POOL_H
+#define SKB_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SKB_POOL_DATA_LEN   128 /**< data buffer of a slot, an 802.15.4 frame */
+
+struct sk_buff;
+
+typedef struct
+{
+    uint32_t size;      /**< slots in the pool */
+    uint32_t used;      /**< slots taken now */
+    uint32_t hwm;       /**< most slots taken at once */
+    uint32_t allocs;    /**< successful allocations */
+    uint32_t exhausted; /**< allocations refused, pool empty */
+} skb_pool_stats_t;
+
+/**
+ * @brief claim an empty sk_buff, data points to a buffer of SKB_POOL_DATA_LEN
+ *        bytes owned by the slot
+ *
+ * @return NULL if the pool is exhausted (accounted)
+ */
+struct sk_buff *skb_pool_alloc(void);
+
+/**
+ * @brief give a slot back, the buffer must come from skb_pool_alloc()
+ */
+void skb_pool_free(struct sk_buff *skb);
+
+/**
+ * @brief free() hook: release p if it is a pool slot
+ *
+ * @return true if p belonged to the pool
+ */
+bool skb_pool_release(void *p);
+
+void skb_pool_get_stats(skb_pool_stats_t *stats);
+
+#endif /* SKB_POOL_H */
@@ -49,11 +49,16 @@
  *
  */
 
+#include <stdbool.h>
+#include <string.h>
 #include "mcps_crypto.h"
+#include "mcps_crypto_cache.h"
 #include "nrf_crypto_aes.h"
 #include "nrf_crypto_aead.h"
 #include "uwbmac_error.h"
 #include "uwbmac.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
 
 static int nrf_crypto_error_to_std_error(ret_code_t rc)
 {
@@ -166,6 +171,101 @@ uwbmac_error mcps_crypto_aead_aes_ccm_star_128_decrypt(
     return UWBMAC_SUCCESS;
 }
 
+/* Cached AES-CCM* contexts, see mcps_crypto_cache.h */
+static struct ccm_cache_entry
+{
+    bool valid;
+    uint8_t key_id;
+    uint8_t key[NRF_CRYPTO_KEY_SIZE_128 / 8];
+    nrf_crypto_aead_context_t ctx;
+} ccm_cache[MCPS_CRYPTO_CCM_CACHE_SIZE];
+
+/* held from mcps_crypto_ccm_cache_get() to mcps_crypto_ccm_cache_put() */
+static SemaphoreHandle_t ccm_cache_lock = NULL;
+
+static void ccm_cache_release(struct ccm_cache_entry *entry)
+{
+    nrf_crypto_aead_uninit(&entry->ctx);
+    memset(entry->key, 0, sizeof(entry->key));
+    entry->valid = false;
+}
+
+int mcps_crypto_ccm_cache_init(void)
+{
+    if (!ccm_cache_lock)
+    {
+        ccm_cache_lock = xSemaphoreCreateMutex();
+    }
+    return ccm_cache_lock ? 0 : -1;
+}
+
+void *mcps_crypto_ccm_cache_get(uint8_t key_id, const uint8_t *key)
+{
+    struct ccm_cache_entry *entry = NULL;
+
+    if (!ccm_cache_lock)
+    {
+        return NULL;
+    }
+    xSemaphoreTake(ccm_cache_lock, portMAX_DELAY);
+
+    for (int i = 0; i < MCPS_CRYPTO_CCM_CACHE_SIZE; i++)
+    {
+        if (ccm_cache[i].valid && ccm_cache[i].key_id == key_id)
+        {
+            if (memcmp(ccm_cache[i].key, key, sizeof(ccm_cache[i].key)) == 0)
+            {
+                return &ccm_cache[i].ctx;
+            }
+            /* same ID, new key: re-key this slot */
+            ccm_cache_release(&ccm_cache[i]);
+            entry = &ccm_cache[i];
+            break;
+        }
+        if (!ccm_cache[i].valid && !entry)
+        {
+            entry = &ccm_cache[i];
+        }
+    }
+
+    if (entry && nrf_crypto_aead_init(&entry->ctx, &g_nrf_crypto_aes_ccm_128_info,
+                                      (uint8_t *)key) == NRF_SUCCESS)
+    {
+        memcpy(entry->key, key, sizeof(entry->key));
+        entry->key_id = key_id;
+        entry->valid = true;
+        return &entry->ctx;
+    }
+
+    xSemaphoreGive(ccm_cache_lock);
+    return NULL;
+}
+
+void mcps_crypto_ccm_cache_put(void *ctx)
+{
+    if (ctx)
+    {
+        xSemaphoreGive(ccm_cache_lock);
+    }
+}
+
+void mcps_crypto_ccm_cache_flush(void)
+{
+    if (!ccm_cache_lock)
+    {
+        return;
+    }
+    xSemaphoreTake(ccm_cache_lock, portMAX_DELAY);
+    for (int i = 0; i < MCPS_CRYPTO_CCM_CACHE_SIZE; i++)
+    {
+        if (ccm_cache[i].valid)
+        {
+            ccm_cache_release(&ccm_cache[i]);
+        }
+    }
+    xSemaphoreGive(ccm_cache_lock);
+}
+
 struct nrf_ecb_128_context
 {
     nrf_crypto_aes_context_t nrf_ctx;
@@ -0,0 +1,62 @@
+/**
+ * @file    mcps_crypto_cache.h
+ *
+ * @brief   Keyed cache of AES-CCM* contexts on top of mcps_crypto.c
+ *
+ *          mcps_crypto_aead_aes_ccm_star_128_create() allocates a context and
+ *          runs the key schedule on every call. Application code that uses the
+ *          same key for every frame gets a long-lived context from this cache
+ *          instead. Contexts live until mcps_crypto_ccm_cache_flush(), which
+ *          the FiRa app calls when its session is torn down.
+ *
+ *          A context is not re-entrant. mcps_crypto_ccm_cache_get() takes
+ *          the cache lock and mcps_crypto_ccm_cache_put() releases it: the
+ *          tasks that use the cache, the report task and the SP1 data task,
+ *          run one encryption or decryption at a time, and a flush waits
+ *          for the one in progress.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef MCPS_CRYPTO_CACHE_H
+#define MCPS_CRYPTO_CACHE_H
+
+#include <stdint.h>
+#include "mcps_crypto.h"
+
+#define MCPS_CRYPTO_CCM_CACHE_SIZE 2 /**< number of key IDs that can be cached at once */
+
+/**
+ * @brief Create the cache lock, before the first mcps_crypto_ccm_cache_get()
+ *
+ * @return 0, -1 if out of memory
+ */
+int mcps_crypto_ccm_cache_init(void);
+
+/**
+ * @brief Get the cached AES-CCM* context for key_id, creating it on first use,
+ *        and hold the cache until mcps_crypto_ccm_cache_put()
+ *
+ * If key_id is cached with a different key, the context is re-keyed.
+ *
+ * @return context for mcps_crypto_aead_aes_ccm_star_128_encrypt()/_decrypt(),
+ *         or NULL, the cache not held, if it is full, not initialized or the
+ *         key could not be set.
+ *         Never pass it to mcps_crypto_aead_aes_ccm_star_128_destroy().
+ */
+void *mcps_crypto_ccm_cache_get(uint8_t key_id, const uint8_t *key);
+
+/**
+ * @brief Release the cache held by mcps_crypto_ccm_cache_get(), done with ctx
+ *
+ * @param ctx   the context it returned, NULL does nothing
+ */
+void mcps_crypto_ccm_cache_put(void *ctx);
+
+/**
+ * @brief Release all cached contexts and wipe their keys
+ */
+void mcps_crypto_ccm_cache_flush(void);
+
+#endif /* MCPS_CRYPTO_CACHE_H */
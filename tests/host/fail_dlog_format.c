@@ -0,0 +1,20 @@
+/**
+ * @file    fail_dlog_format.c
+ *
+ * @brief   dlog_check_format() at a DLOG site: compiles as it is, fails with
+ *          DLOG_BAD_FORMAT, see the dlog_format tests of CMakeLists.txt
+ *
+ * @author  Development Team
+ *
+ */
+
+#include "dlog.h"
+
+void site(const char *name, int n)
+{
+#ifdef DLOG_BAD_FORMAT
+    DLOG_INFO(DLOG_MOD_FIRA, "%s: %d\r\n", n, name);
+#else
+    DLOG_INFO(DLOG_MOD_FIRA, "%s: %d\r\n", name, n);
+#endif
+}
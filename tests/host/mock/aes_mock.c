@@ -0,0 +1,268 @@
+/**
+ * @file    aes_mock.c
+ *
+ * @brief   AES-128 in software, its CMAC and CCM*, see aes_mock.h
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <string.h>
+
+#include "aes_mock.h"
+
+#define AES_ROUNDS  10
+#define CCM_L       (AES_MOCK_BLOCK - 1 - AES_MOCK_NONCE_LEN)
+
+static const uint8_t sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+static uint8_t xtime(uint8_t x)
+{
+    return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0));
+}
+
+void aes_mock_expand(aes_mock_t *c, const uint8_t *key)
+{
+    uint8_t rcon = 1;
+
+    memcpy(c->rk, key, AES_MOCK_BLOCK);
+    for (int i = AES_MOCK_BLOCK; i < (int)sizeof(c->rk); i += 4)
+    {
+        uint8_t t[4];
+
+        memcpy(t, &c->rk[i - 4], 4);
+        if (i % AES_MOCK_BLOCK == 0)
+        {
+            uint8_t t0 = t[0];
+
+            t[0] = sbox[t[1]] ^ rcon;
+            t[1] = sbox[t[2]];
+            t[2] = sbox[t[3]];
+            t[3] = sbox[t0];
+            rcon = xtime(rcon);
+        }
+        for (int k = 0; k < 4; k++)
+        {
+            c->rk[i + k] = c->rk[i - AES_MOCK_BLOCK + k] ^ t[k];
+        }
+    }
+}
+
+void aes_mock_encrypt(const aes_mock_t *c, const uint8_t *in, uint8_t *out)
+{
+    uint8_t s[AES_MOCK_BLOCK], t[AES_MOCK_BLOCK];
+
+    for (int i = 0; i < AES_MOCK_BLOCK; i++)
+    {
+        s[i] = in[i] ^ c->rk[i];
+    }
+    for (int r = 1; r <= AES_ROUNDS; r++)
+    {
+        /* SubBytes and ShiftRows, the state column by column */
+        for (int i = 0; i < AES_MOCK_BLOCK; i++)
+        {
+            t[i] = sbox[s[(i + 4 * (i % 4)) % AES_MOCK_BLOCK]];
+        }
+        /* MixColumns, but in the last round */
+        for (int col = 0; col < 4; col++)
+        {
+            uint8_t *a = &t[4 * col];
+            uint8_t all = a[0] ^ a[1] ^ a[2] ^ a[3], a0 = a[0];
+
+            if (r == AES_ROUNDS)
+            {
+                break;
+            }
+            a[0] ^= all ^ xtime(a[0] ^ a[1]);
+            a[1] ^= all ^ xtime(a[1] ^ a[2]);
+            a[2] ^= all ^ xtime(a[2] ^ a[3]);
+            a[3] ^= all ^ xtime(a[3] ^ a0);
+        }
+        for (int i = 0; i < AES_MOCK_BLOCK; i++)
+        {
+            s[i] = t[i] ^ c->rk[r * AES_MOCK_BLOCK + i];
+        }
+    }
+    memcpy(out, s, AES_MOCK_BLOCK);
+}
+
+/* @brief counter block i of the nonce */
+static void ccm_ctr(const uint8_t *nonce, unsigned int i, uint8_t *a)
+{
+    a[0] = CCM_L - 1;
+    memcpy(&a[1], nonce, AES_MOCK_NONCE_LEN);
+    a[AES_MOCK_BLOCK - 2] = (uint8_t)(i >> 8);
+    a[AES_MOCK_BLOCK - 1] = (uint8_t)i;
+}
+
+/* @brief x ^= n bytes of buf, then x = E(x) */
+static void ccm_mac_add(const aes_mock_t *c, uint8_t *x, const uint8_t *buf, unsigned int n)
+{
+    while (n)
+    {
+        unsigned int k = (n < AES_MOCK_BLOCK) ? n : AES_MOCK_BLOCK;
+
+        for (unsigned int i = 0; i < k; i++)
+        {
+            x[i] ^= buf[i];
+        }
+        aes_mock_encrypt(c, x, x);
+        buf += k;
+        n -= k;
+    }
+}
+
+/* @brief CBC-MAC of the header and plaintext, mac_len bytes to t */
+static void ccm_mac(const aes_mock_t *c, const uint8_t *nonce, const uint8_t *header, unsigned int header_len,
+                    const uint8_t *data, unsigned int data_len, unsigned int mac_len, uint8_t *t)
+{
+    uint8_t x[AES_MOCK_BLOCK] = {0}, b[AES_MOCK_BLOCK];
+
+    b[0] = (uint8_t)((header_len ? 0x40 : 0) | (((mac_len - 2) / 2) << 3) | (CCM_L - 1));
+    memcpy(&b[1], nonce, AES_MOCK_NONCE_LEN);
+    b[AES_MOCK_BLOCK - 2] = (uint8_t)(data_len >> 8);
+    b[AES_MOCK_BLOCK - 1] = (uint8_t)data_len;
+    ccm_mac_add(c, x, b, AES_MOCK_BLOCK);
+
+    if (header_len)
+    {
+        /* the header length, then the header, to the end of the block */
+        unsigned int k = (header_len < AES_MOCK_BLOCK - 2) ? header_len : AES_MOCK_BLOCK - 2;
+
+        memset(b, 0, sizeof(b));
+        b[0] = (uint8_t)(header_len >> 8);
+        b[1] = (uint8_t)header_len;
+        memcpy(&b[2], header, k);
+        ccm_mac_add(c, x, b, AES_MOCK_BLOCK);
+        ccm_mac_add(c, x, header + k, header_len - k);
+    }
+    ccm_mac_add(c, x, data, data_len);
+    memcpy(t, x, mac_len);
+}
+
+/* @brief data ^= key stream from counter block 1, t ^= counter block 0 */
+static void ccm_crypt(const aes_mock_t *c, const uint8_t *nonce, uint8_t *data, unsigned int data_len,
+                      uint8_t *t, unsigned int mac_len)
+{
+    uint8_t a[AES_MOCK_BLOCK], s[AES_MOCK_BLOCK];
+
+    for (unsigned int i = 0, blk = 1; i < data_len; blk++)
+    {
+        ccm_ctr(nonce, blk, a);
+        aes_mock_encrypt(c, a, s);
+        for (unsigned int k = 0; k < AES_MOCK_BLOCK && i < data_len; k++, i++)
+        {
+            data[i] ^= s[k];
+        }
+    }
+    ccm_ctr(nonce, 0, a);
+    aes_mock_encrypt(c, a, s);
+    for (unsigned int k = 0; k < mac_len; k++)
+    {
+        t[k] ^= s[k];
+    }
+}
+
+/* @brief CMAC subkey: k << 1, xor Rb if the top bit was set */
+static void cmac_dbl(uint8_t *k)
+{
+    uint8_t msb = k[0] >> 7;
+
+    for (int i = 0; i < AES_MOCK_BLOCK - 1; i++)
+    {
+        k[i] = (uint8_t)((k[i] << 1) | (k[i + 1] >> 7));
+    }
+    k[AES_MOCK_BLOCK - 1] = (uint8_t)((k[AES_MOCK_BLOCK - 1] << 1) ^ (msb ? 0x87 : 0));
+}
+
+void aes_mock_cmac(const uint8_t *key, const uint8_t *data, unsigned int data_len, uint8_t *out)
+{
+    uint8_t k[AES_MOCK_BLOCK] = {0}, x[AES_MOCK_BLOCK] = {0};
+    unsigned int n = (data_len + AES_MOCK_BLOCK - 1) / AES_MOCK_BLOCK;
+    unsigned int last;
+    aes_mock_t c;
+
+    aes_mock_expand(&c, key);
+    aes_mock_encrypt(&c, k, k);
+    cmac_dbl(k);
+    n = n ? n : 1;
+    last = data_len - (n - 1) * AES_MOCK_BLOCK;
+
+    for (unsigned int b = 0; b < n - 1; b++)
+    {
+        for (int i = 0; i < AES_MOCK_BLOCK; i++)
+        {
+            x[i] ^= data[b * AES_MOCK_BLOCK + i];
+        }
+        aes_mock_encrypt(&c, x, x);
+    }
+
+    /* a partial last block is padded and takes K2 */
+    if (last < AES_MOCK_BLOCK)
+    {
+        cmac_dbl(k);
+    }
+    for (unsigned int i = 0; i < AES_MOCK_BLOCK; i++)
+    {
+        uint8_t m = (i < last) ? data[(n - 1) * AES_MOCK_BLOCK + i] : (i == last) ? 0x80 : 0;
+
+        x[i] ^= m ^ k[i];
+    }
+    aes_mock_encrypt(&c, x, out);
+}
+
+int aes_mock_ccm(const aes_mock_t *c, bool encrypt, const uint8_t *nonce, const uint8_t *header,
+                 unsigned int header_len, uint8_t *data, unsigned int data_len, uint8_t *mac, unsigned int mac_len)
+{
+    uint8_t t[AES_MOCK_BLOCK], diff = 0;
+
+    if (mac_len > AES_MOCK_BLOCK || (mac_len && (mac_len < 4 || mac_len % 2)))
+    {
+        return AES_MOCK_E_PARAM;
+    }
+    if (encrypt)
+    {
+        if (mac_len)
+        {
+            ccm_mac(c, nonce, header, header_len, data, data_len, mac_len, mac);
+        }
+        ccm_crypt(c, nonce, data, data_len, mac, mac_len);
+        return 0;
+    }
+
+    memcpy(t, mac, mac_len);
+    ccm_crypt(c, nonce, data, data_len, t, mac_len);
+    if (mac_len)
+    {
+        uint8_t m[AES_MOCK_BLOCK];
+
+        ccm_mac(c, nonce, header, header_len, data, data_len, mac_len, m);
+        for (unsigned int k = 0; k < mac_len; k++)
+        {
+            diff |= m[k] ^ t[k];
+        }
+    }
+    if (diff)
+    {
+        memset(data, 0, data_len);
+        return AES_MOCK_E_MIC;
+    }
+    return 0;
+}
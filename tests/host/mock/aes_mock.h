@@ -0,0 +1,52 @@
+/**
+ * @file    aes_mock.h
+ *
+ * @brief   AES-128 in software: the block cipher, CMAC (RFC 4493) and CCM*
+ *          (RFC 3610 with a 13-byte nonce, MIC of 0 to 16 bytes)
+ *
+ *          The crypto of the host tests, behind mcps_crypto.h in
+ *          crypto_mock.c and behind the nRF5 SDK API in nrf_crypto_mock.c.
+ *          Not hardened against side channels.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef AES_MOCK_H
+#define AES_MOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define AES_MOCK_BLOCK      16
+#define AES_MOCK_NONCE_LEN  13
+
+#define AES_MOCK_E_PARAM    (-1)    /**< MIC length not allowed */
+#define AES_MOCK_E_MIC      (-2)    /**< MIC mismatch, the data zeroed */
+
+typedef struct
+{
+    uint8_t rk[(10 + 1) * AES_MOCK_BLOCK];  /**< round keys, 10 rounds */
+} aes_mock_t;
+
+/**
+ * @brief key schedule of key
+ */
+void aes_mock_expand(aes_mock_t *c, const uint8_t *key);
+
+void aes_mock_encrypt(const aes_mock_t *c, const uint8_t *in, uint8_t *out);
+
+/**
+ * @brief CMAC of data_len bytes under key, AES_MOCK_BLOCK bytes to out
+ */
+void aes_mock_cmac(const uint8_t *key, const uint8_t *data, unsigned int data_len, uint8_t *out);
+
+/**
+ * @brief CCM* encryption, or decryption and MIC check, of data in place
+ *
+ * @return 0, AES_MOCK_E_PARAM or AES_MOCK_E_MIC
+ */
+int aes_mock_ccm(const aes_mock_t *c, bool encrypt, const uint8_t *nonce, const uint8_t *header,
+                 unsigned int header_len, uint8_t *data, unsigned int data_len, uint8_t *mac, unsigned int mac_len);
+
+#endif /* AES_MOCK_H */
@@ -0,0 +1,91 @@
+/**
+ * @file    crypto_mock.c
+ *
+ * @brief   Host mcps_crypto.h on the software AES of aes_mock.c: ECB, CMAC
+ *          (RFC 4493) and CCM* (RFC 3610 with a 13-byte nonce, MIC of 0 to
+ *          16 bytes)
+ *
+ *          Stands for the CryptoCell of the target in the host tests, not
+ *          hardened against side channels.
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mcps_crypto.h"
+#include "aes_mock.h"
+
+_Static_assert(MCPS_CRYPTO_AES_CCM_STAR_NONCE_LEN == AES_MOCK_NONCE_LEN, "CCM* nonce length");
+
+static void *aes_create(const uint8_t *key)
+{
+    aes_mock_t *c = malloc(sizeof(*c));
+
+    if (c)
+    {
+        aes_mock_expand(c, key);
+    }
+    return c;
+}
+
+static uwbmac_error aes_error(int r)
+{
+    return (r == AES_MOCK_E_MIC) ? UWBMAC_EBADMSG : (r < 0) ? UWBMAC_EINVAL : UWBMAC_SUCCESS;
+}
+
+uwbmac_error mcps_crypto_cmac_aes_128_digest(const uint8_t *key, const uint8_t *data, unsigned int data_len,
+                                             uint8_t *out)
+{
+    aes_mock_cmac(key, data, data_len, out);
+    return UWBMAC_SUCCESS;
+}
+
+void *mcps_crypto_aead_aes_ccm_star_128_create(const uint8_t *key)
+{
+    return aes_create(key);
+}
+
+void mcps_crypto_aead_aes_ccm_star_128_destroy(void *ctx)
+{
+    free(ctx);
+}
+
+uwbmac_error mcps_crypto_aead_aes_ccm_star_128_encrypt(void *ctx, const uint8_t *nonce, const uint8_t *header,
+                                                       unsigned int header_len, uint8_t *data, unsigned int data_len,
+                                                       uint8_t *mac, unsigned int mac_len)
+{
+    return aes_error(aes_mock_ccm(ctx, true, nonce, header, header_len, data, data_len, mac, mac_len));
+}
+
+uwbmac_error mcps_crypto_aead_aes_ccm_star_128_decrypt(void *ctx, const uint8_t *nonce, const uint8_t *header,
+                                                       unsigned int header_len, uint8_t *data, unsigned int data_len,
+                                                       uint8_t *mac, unsigned int mac_len)
+{
+    return aes_error(aes_mock_ccm(ctx, false, nonce, header, header_len, data, data_len, mac, mac_len));
+}
+
+void *mcps_crypto_aes_ecb_128_create(const uint8_t *key)
+{
+    return aes_create(key);
+}
+
+void mcps_crypto_aes_ecb_128_destroy(void *ctx)
+{
+    free(ctx);
+}
+
+uwbmac_error mcps_crypto_aes_ecb_128_encrypt(void *ctx, const uint8_t *data, unsigned int data_len, uint8_t *out)
+{
+    if (data_len % AES_MOCK_BLOCK)
+    {
+        return UWBMAC_EINVAL;
+    }
+    for (unsigned int i = 0; i < data_len; i += AES_MOCK_BLOCK)
+    {
+        aes_mock_encrypt(ctx, &data[i], &out[i]);
+    }
+    return UWBMAC_SUCCESS;
+}
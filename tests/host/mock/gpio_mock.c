@@ -0,0 +1,99 @@
+/**
+ * @file    gpio_mock.c
+ *
+ * @brief   Host GPIO backend: input levels set by the test, the GPIOTE
+ *          handler called on their edges
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <assert.h>
+
+#include "gpio_mock.h"
+#include "nrfx_gpiote.h"
+
+static bool mock_init;
+static bool mock_low[GPIO_MOCK_PINS];       /**< pulled up */
+static bool mock_enabled[GPIO_MOCK_PINS];
+static nrfx_gpiote_evt_handler_t mock_handler[GPIO_MOCK_PINS];
+
+void gpio_mock_set(uint32_t pin, bool high)
+{
+    assert(pin < GPIO_MOCK_PINS);
+    if (mock_low[pin] == !high)
+    {
+        return;
+    }
+    mock_low[pin] = !high;
+    if (mock_enabled[pin] && mock_handler[pin])
+    {
+        mock_handler[pin](pin, NRF_GPIOTE_POLARITY_TOGGLE);
+    }
+}
+
+bool gpio_mock_enabled(uint32_t pin)
+{
+    return pin < GPIO_MOCK_PINS && mock_enabled[pin];
+}
+
+uint32_t nrf_gpio_pin_read(uint32_t pin_number)
+{
+    assert(pin_number < GPIO_MOCK_PINS);
+    return mock_low[pin_number] ? 0 : 1;
+}
+
+void nrf_gpio_pin_set(uint32_t pin_number)
+{
+    assert(pin_number < GPIO_MOCK_PINS);
+    mock_low[pin_number] = false;
+}
+
+void nrf_gpio_pin_clear(uint32_t pin_number)
+{
+    assert(pin_number < GPIO_MOCK_PINS);
+    mock_low[pin_number] = true;
+}
+
+void nrf_gpio_cfg_output(uint32_t pin_number)
+{
+    assert(pin_number < GPIO_MOCK_PINS);
+}
+
+void nrf_gpio_cfg(uint32_t pin_number, nrf_gpio_pin_dir_t dir, nrf_gpio_pin_input_t input,
+                  nrf_gpio_pin_pull_t pull, nrf_gpio_pin_drive_t drive, nrf_gpio_pin_sense_t sense)
+{
+    assert(pin_number < GPIO_MOCK_PINS);
+    (void)dir;
+    (void)input;
+    (void)pull;
+    (void)drive;
+    (void)sense;
+}
+
+bool nrfx_gpiote_is_init(void)
+{
+    return mock_init;
+}
+
+nrfx_err_t nrfx_gpiote_init(void)
+{
+    mock_init = true;
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_gpiote_in_init(nrfx_gpiote_pin_t pin, const nrfx_gpiote_in_config_t *config,
+                               nrfx_gpiote_evt_handler_t handler)
+{
+    assert(pin < GPIO_MOCK_PINS);
+    (void)config;
+    mock_handler[pin] = handler;
+    return NRFX_SUCCESS;
+}
+
+void nrfx_gpiote_in_event_enable(nrfx_gpiote_pin_t pin, bool int_enable)
+{
+    assert(pin < GPIO_MOCK_PINS);
+    (void)int_enable;
+    mock_enabled[pin] = true;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file    gpio_mock.h
+ *
+ * @brief   Host GPIO backend: input levels set by the test, the GPIOTE
+ *          handler called on their edges
+ *
+ *          The pins are pulled up: high until the test drives them.
+ *          gpio_mock_set() changes the level seen by nrf_gpio_pin_read()
+ *          and, on a change, calls the handler given to nrfx_gpiote_in_init()
+ *          once the event of the pin is enabled, as the PORT event would.
+ *          The firmware drives its outputs with nrf_gpio_pin_set() and
+ *          nrf_gpio_pin_clear(), read back by nrf_gpio_pin_read().
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef GPIO_MOCK_H
+#define GPIO_MOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GPIO_MOCK_PINS  48
+
+/**
+ * @brief drive an input pin, edge handler called on a change
+ */
+void gpio_mock_set(uint32_t pin, bool high);
+
+/**
+ * @brief the edge handler of pin is enabled
+ */
+bool gpio_mock_enabled(uint32_t pin);
+
+#endif /* GPIO_MOCK_H */
@@ -0,0 +1,191 @@
+/**
+ * @file    mcps_mock.c
+ *
+ * @brief   Host MAC: the mcps802154_* side the UWB layer calls
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "linux/skbuff.h"
+#include "mcps_mock.h"
+
+struct mcps_mock_llhw
+{
+    struct mcps802154_llhw llhw;
+    struct ieee802154_hw hw;
+    struct wpan_phy phy;
+    const struct mcps802154_ops *ops;
+    uint8_t priv[] __attribute__((aligned(8)));
+};
+
+static mcps_mock_stats_t mock_stats;
+static uint16_t rx_flags;
+static mcps_mock_evt_e mock_log[MCPS_MOCK_LOG_LEN];
+static uint32_t mock_log_n;     /**< events logged since the reset */
+static uint8_t mock_seq[MCPS_MOCK_LOG_LEN];
+static uint32_t mock_seq_n;     /**< frames with data since the reset */
+
+static void mock_log_add(mcps_mock_evt_e evt)
+{
+    mock_log[mock_log_n++ % MCPS_MOCK_LOG_LEN] = evt;
+}
+
+static const struct mcps802154_ops *mock_ops(struct mcps802154_llhw *llhw)
+{
+    return ((struct mcps_mock_llhw *)llhw)->ops;
+}
+
+struct mcps802154_llhw *mcps802154_alloc_llhw(size_t priv_data_len, const struct mcps802154_ops *ops)
+{
+    struct mcps_mock_llhw *m = calloc(1, sizeof(*m) + priv_data_len);
+
+    if (!m)
+    {
+        return NULL;
+    }
+    m->llhw.hw = &m->hw;
+    m->hw.phy = &m->phy;
+    m->llhw.priv = m->priv;
+    m->ops = ops;
+    return &m->llhw;
+}
+
+void mcps802154_free_llhw(struct mcps802154_llhw *llhw)
+{
+    free(llhw);
+}
+
+int mcps802154_register_llhw(struct mcps802154_llhw *llhw)
+{
+    (void)llhw;
+    return 0;
+}
+
+void mcps802154_unregister_llhw(struct mcps802154_llhw *llhw)
+{
+    (void)llhw;
+}
+
+void mcps802154_rx_frame(struct mcps802154_llhw *llhw)
+{
+    struct mcps802154_rx_frame_info info = {.flags = rx_flags};
+    struct sk_buff *skb = NULL;
+
+    mock_log_add(MCPS_MOCK_RX);
+    if (mock_ops(llhw)->rx_get_frame(llhw, &skb, &info))
+    {
+        mock_stats.rx_get_errors++;
+        return;
+    }
+    mock_stats.rx_frames++;
+    mock_stats.info = info;
+    if (!skb)
+    {
+        mock_stats.rx_no_data++;
+        return;
+    }
+    mock_stats.rx_bytes += skb->len;
+    mock_seq[mock_seq_n++ % MCPS_MOCK_LOG_LEN] = (skb->len > 2) ? skb->data[2] : 0;
+    kfree_skb(skb);
+}
+
+void mcps802154_rx_timeout(struct mcps802154_llhw *llhw)
+{
+    (void)llhw;
+    mock_log_add(MCPS_MOCK_RX_TIMEOUT);
+    mock_stats.rx_timeouts++;
+}
+
+void mcps802154_rx_error(struct mcps802154_llhw *llhw, enum mcps802154_rx_error_type error)
+{
+    (void)llhw;
+    (void)error;
+    mock_log_add(MCPS_MOCK_RX_ERROR);
+    mock_stats.rx_errors++;
+}
+
+void mcps802154_tx_done(struct mcps802154_llhw *llhw)
+{
+    (void)llhw;
+    mock_log_add(MCPS_MOCK_TX_DONE);
+    mock_stats.tx_done++;
+}
+
+void mcps802154_timer_expired(struct mcps802154_llhw *llhw)
+{
+    (void)llhw;
+    mock_log_add(MCPS_MOCK_TIMER);
+    mock_stats.timers++;
+}
+
+/* uwbmac_buf of the malloc platform */
+struct uwbmac_buf *uwbmac_buf_alloc(unsigned int size)
+{
+    struct uwbmac_buf *buf = malloc(sizeof(*buf) + size);
+
+    if (buf)
+    {
+        memset(buf, 0, sizeof(*buf));
+        buf->head = (uint8_t *)(buf + 1);
+        buf->data = buf->head;
+        buf->end = buf->head + size;
+    }
+    return buf;
+}
+
+void uwbmac_buf_free(struct uwbmac_buf *buf)
+{
+    free(buf);
+}
+
+int uwbmac_buf_put_data(struct uwbmac_buf *buf, const void *data, unsigned int len)
+{
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    return 0;
+}
+
+void mcps_mock_set_rx_flags(uint16_t flags)
+{
+    rx_flags = flags;
+}
+
+void mcps_mock_get_stats(mcps_mock_stats_t *stats)
+{
+    *stats = mock_stats;
+}
+
+int mcps_mock_get_log(mcps_mock_evt_e *log, int max)
+{
+    uint32_t first = (mock_log_n > MCPS_MOCK_LOG_LEN) ? mock_log_n - MCPS_MOCK_LOG_LEN : 0;
+    int n = 0;
+
+    for (uint32_t i = first; i < mock_log_n && n < max; i++)
+    {
+        log[n++] = mock_log[i % MCPS_MOCK_LOG_LEN];
+    }
+    return n;
+}
+
+int mcps_mock_get_rx_seq(uint8_t *seq, int max)
+{
+    uint32_t first = (mock_seq_n > MCPS_MOCK_LOG_LEN) ? mock_seq_n - MCPS_MOCK_LOG_LEN : 0;
+    int n = 0;
+
+    for (uint32_t i = first; i < mock_seq_n && n < max; i++)
+    {
+        seq[n++] = mock_seq[i % MCPS_MOCK_LOG_LEN];
+    }
+    return n;
+}
+
+void mcps_mock_reset_stats(void)
+{
+    memset(&mock_stats, 0, sizeof(mock_stats));
+    mock_log_n = 0;
+    mock_seq_n = 0;
+}
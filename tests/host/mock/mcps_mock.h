@@ -0,0 +1,74 @@
+/**
+ * @file    mcps_mock.h
+ *
+ * @brief   Host MAC: the mcps802154_* side the UWB layer calls, as far as a
+ *          test needs it
+ *
+ *          mcps802154_alloc_llhw() allocates the llhw, its hw, phy and
+ *          private data in one block, as the MAC does. The event calls count:
+ *          mcps802154_rx_frame() takes the frame with the rx_get_frame op,
+ *          asking for the info flags of mcps_mock_set_rx_flags(), and frees
+ *          the sk_buff with kfree_skb(). The buffers go through the firmware
+ *          heap, see host_heap.h. The last MCPS_MOCK_LOG_LEN events, and
+ *          sequence numbers of the frames taken, are logged in the order the
+ *          UWB layer delivered them.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef MCPS_MOCK_H
+#define MCPS_MOCK_H
+
+#include <stdint.h>
+#include <net/mcps802154.h>
+
+#define MCPS_MOCK_LOG_LEN   64
+
+typedef enum
+{
+    MCPS_MOCK_TX_DONE = 0,
+    MCPS_MOCK_RX,           /**< a frame, taken or not */
+    MCPS_MOCK_RX_TIMEOUT,
+    MCPS_MOCK_RX_ERROR,
+    MCPS_MOCK_TIMER,
+} mcps_mock_evt_e;
+
+typedef struct
+{
+    uint32_t rx_frames;     /**< taken by rx_get_frame */
+    uint32_t rx_bytes;      /**< of their sk_buff */
+    uint32_t rx_no_data;    /**< without sk_buff, SP3 */
+    uint32_t rx_get_errors; /**< rx_get_frame failed */
+    uint32_t rx_timeouts;
+    uint32_t rx_errors;
+    uint32_t tx_done;
+    uint32_t timers;
+    struct mcps802154_rx_frame_info info;   /**< of the last frame */
+} mcps_mock_stats_t;
+
+void mcps_mock_set_rx_flags(uint16_t flags);
+
+void mcps_mock_get_stats(mcps_mock_stats_t *stats);
+
+/**
+ * @brief events since the reset, oldest first, at most max
+ *
+ * @return events copied
+ */
+int mcps_mock_get_log(mcps_mock_evt_e *log, int max);
+
+/**
+ * @brief sequence numbers (byte 2) of the frames with data taken since the
+ *        reset, oldest first, at most max
+ *
+ * @return sequence numbers copied
+ */
+int mcps_mock_get_rx_seq(uint8_t *seq, int max);
+
+/**
+ * @brief clear the statistics and the logs
+ */
+void mcps_mock_reset_stats(void);
+
+#endif /* MCPS_MOCK_H */
@@ -0,0 +1,127 @@
+/**
+ * @file    nrf_crypto_mock.c
+ *
+ * @brief   Host nRF5 SDK crypto on the software AES of aes_mock.c, as far
+ *          as mcps_crypto.c calls it, see stub/nrf_crypto_aead.h
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <string.h>
+
+#include "nrf_crypto_aead.h"
+#include "nrf_crypto_mock.h"
+
+const nrf_crypto_aes_info_t g_nrf_crypto_aes_ecb_128_info = NRF_CRYPTO_AES_ECB_128;
+const nrf_crypto_aes_info_t g_nrf_crypto_aes_cmac_128_info = NRF_CRYPTO_AES_CMAC_128;
+const nrf_crypto_aead_info_t g_nrf_crypto_aes_ccm_128_info = NRF_CRYPTO_AES_CCM_128;
+
+static uint32_t key_schedules;
+
+static void key_schedule(aes_mock_t *c, const uint8_t *key)
+{
+    aes_mock_expand(c, key);
+    key_schedules++;
+}
+
+uint32_t nrf_crypto_mock_key_schedules(void)
+{
+    return key_schedules;
+}
+
+ret_code_t nrf_crypto_aes_init(nrf_crypto_aes_context_t *ctx, const nrf_crypto_aes_info_t *info,
+                               nrf_crypto_operation_t operation)
+{
+    if (*info == NRF_CRYPTO_AES_CMAC_128 && operation != NRF_CRYPTO_MAC_CALCULATE)
+    {
+        return NRF_ERROR_CRYPTO_INVALID_PARAM;
+    }
+    ctx->info = info;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_crypto_aes_key_set(nrf_crypto_aes_context_t *ctx, uint8_t *key)
+{
+    memcpy(ctx->key, key, sizeof(ctx->key));
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_crypto_aes_finalize(nrf_crypto_aes_context_t *ctx, uint8_t *data_in, size_t data_size,
+                                   uint8_t *data_out, size_t *data_out_size)
+{
+    if (*ctx->info != NRF_CRYPTO_AES_CMAC_128 || *data_out_size < AES_MOCK_BLOCK)
+    {
+        return NRF_ERROR_CRYPTO_INVALID_PARAM;
+    }
+    key_schedules++;
+    aes_mock_cmac(ctx->key, data_in, (unsigned int)data_size, data_out);
+    *data_out_size = AES_MOCK_BLOCK;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_crypto_aes_uninit(nrf_crypto_aes_context_t *ctx)
+{
+    memset(ctx->key, 0, sizeof(ctx->key));
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_crypto_aes_crypt(nrf_crypto_aes_context_t *ctx, const nrf_crypto_aes_info_t *info,
+                                nrf_crypto_operation_t operation, uint8_t *key, uint8_t *iv, uint8_t *data_in,
+                                size_t data_size, uint8_t *data_out, size_t *data_out_size)
+{
+    aes_mock_t c;
+
+    (void)ctx;
+    (void)iv;
+    if (*info != NRF_CRYPTO_AES_ECB_128 || operation != NRF_CRYPTO_ENCRYPT || data_size % AES_MOCK_BLOCK ||
+        *data_out_size < data_size)
+    {
+        return NRF_ERROR_CRYPTO_INVALID_PARAM;
+    }
+    key_schedule(&c, key);
+    for (size_t i = 0; i < data_size; i += AES_MOCK_BLOCK)
+    {
+        aes_mock_encrypt(&c, &data_in[i], &data_out[i]);
+    }
+    *data_out_size = data_size;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_crypto_aead_init(nrf_crypto_aead_context_t *ctx, const nrf_crypto_aead_info_t *info, uint8_t *key)
+{
+    if (!ctx)
+    {
+        return NRF_ERROR_CRYPTO_INVALID_PARAM;
+    }
+    ctx->info = info;
+    key_schedule(&ctx->aes, key);
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_crypto_aead_uninit(void *ctx)
+{
+    nrf_crypto_aead_context_t *c = ctx;
+
+    memset(&c->aes, 0, sizeof(c->aes));
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_crypto_aead_crypt(nrf_crypto_aead_context_t *ctx, nrf_crypto_operation_t operation, uint8_t *nonce,
+                                 uint8_t nonce_size, uint8_t *adata, size_t adata_size, uint8_t *data_in,
+                                 size_t data_in_size, uint8_t *data_out, uint8_t *mac, uint8_t mac_size)
+{
+    int r;
+
+    if (nonce_size != AES_MOCK_NONCE_LEN || operation == NRF_CRYPTO_MAC_CALCULATE)
+    {
+        return NRF_ERROR_CRYPTO_INVALID_PARAM;
+    }
+    if (data_out != data_in)
+    {
+        memmove(data_out, data_in, data_in_size);
+    }
+    r = aes_mock_ccm(&ctx->aes, operation == NRF_CRYPTO_ENCRYPT, nonce, adata, (unsigned int)adata_size, data_out,
+                     (unsigned int)data_in_size, mac, mac_size);
+    return (r == AES_MOCK_E_MIC) ? NRF_ERROR_CRYPTO_AEAD_INVALID_MAC : r ? NRF_ERROR_CRYPTO_INVALID_PARAM : NRF_SUCCESS;
+}
@@ -0,0 +1,21 @@
+/**
+ * @file    nrf_crypto_mock.h
+ *
+ * @brief   Host nRF5 SDK crypto, see stub/nrf_crypto_aead.h: the key
+ *          schedules run, counted
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef NRF_CRYPTO_MOCK_H
+#define NRF_CRYPTO_MOCK_H
+
+#include <stdint.h>
+
+/**
+ * @brief AES key schedules run since the start
+ */
+uint32_t nrf_crypto_mock_key_schedules(void);
+
+#endif /* NRF_CRYPTO_MOCK_H */
@@ -0,0 +1,92 @@
+/**
+ * @file    servo_mock.c
+ *
+ * @brief   Host servo backend: records the pulses the PWM would output
+ *
+ * @author  Development Team
+ *
+ */
+
+#include "servo_mock.h"
+#include "host_rtos.h"
+
+static uint32_t mock_pin;
+static uint16_t mock_period_us;
+static bool mock_running;
+static uint16_t mock_width_us;      /**< latched at the next period */
+static uint64_t mock_next_us;       /**< next period boundary */
+static servo_mock_pulse_t mock_pulse[SERVO_MOCK_PULSES_MAX];
+static int mock_n;
+
+void servo_mock_sync(void)
+{
+    while (mock_running && mock_next_us <= host_time_us())
+    {
+        if (mock_n < SERVO_MOCK_PULSES_MAX)
+        {
+            mock_pulse[mock_n].t_us = mock_next_us;
+            mock_pulse[mock_n].width_us = mock_width_us;
+            mock_n++;
+        }
+        mock_next_us += mock_period_us;
+    }
+}
+
+static bool mock_init(uint32_t pin, uint16_t period_us)
+{
+    mock_pin = pin;
+    mock_period_us = period_us;
+    return period_us > 0;
+}
+
+static void mock_set_pulse(uint16_t pulse_us)
+{
+    /* the periods begun so far keep the width they started with */
+    servo_mock_sync();
+    mock_width_us = pulse_us;
+    if (!mock_running)
+    {
+        mock_running = true;
+        mock_next_us = host_time_us();
+    }
+}
+
+static void mock_stop(void)
+{
+    servo_mock_sync();
+    mock_running = false;
+}
+
+const struct hal_servo_backend_s ServoMock = {
+    .init = mock_init,
+    .setPulse = mock_set_pulse,
+    .stop = mock_stop,
+};
+
+int servo_mock_pulses(const servo_mock_pulse_t **p)
+{
+    servo_mock_sync();
+    *p = mock_pulse;
+    return mock_n;
+}
+
+void servo_mock_clear(void)
+{
+    servo_mock_sync();
+    mock_n = 0;
+}
+
+uint32_t servo_mock_pin(void)
+{
+    return mock_pin;
+}
+
+uint16_t servo_mock_period_us(void)
+{
+    return mock_period_us;
+}
+
+bool servo_mock_running(void)
+{
+    return mock_running;
+}
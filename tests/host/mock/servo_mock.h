@@ -0,0 +1,59 @@
+/**
+ * @file    servo_mock.h
+ *
+ * @brief   Host servo backend: records the pulses the PWM would output
+ *
+ *          ServoMock behaves as ServoPwm on the clock of host_rtos.h: the
+ *          first setPulse() starts a pulse at once, then one pulse per
+ *          period; a new width is latched at the next period boundary; stop()
+ *          lets the current period end. Each pulse is recorded with the time
+ *          of its rising edge, so a test can check the period and jitter of
+ *          the output whatever the time the HAL calls come at.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef SERVO_MOCK_H
+#define SERVO_MOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "HAL_servo.h"
+
+#define SERVO_MOCK_PULSES_MAX   4096
+
+typedef struct
+{
+    uint64_t t_us;      /**< rising edge, host_time_us() */
+    uint16_t width_us;
+} servo_mock_pulse_t;
+
+extern const struct hal_servo_backend_s ServoMock;
+
+/**
+ * @brief record the pulses up to host_time_us()
+ */
+void servo_mock_sync(void);
+
+/**
+ * @brief pulses recorded since the last servo_mock_clear(), synced first
+ *
+ * @return number of pulses, *p the first
+ */
+int servo_mock_pulses(const servo_mock_pulse_t **p);
+
+void servo_mock_clear(void);
+
+/**
+ * @brief pin and period given to init(), 0 before
+ */
+uint32_t servo_mock_pin(void);
+uint16_t servo_mock_period_us(void);
+
+/**
+ * @brief pulses are output
+ */
+bool servo_mock_running(void);
+
+#endif /* SERVO_MOCK_H */
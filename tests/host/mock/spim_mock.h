@@ -0,0 +1,62 @@
+/**
+ * @file    spim_mock.h
+ *
+ * @brief   Host SPIM backend: records the bytes clocked on the wire
+ *
+ *          Each nrfx_spim_xfer() clocks max(tx, rx) bytes: the MOSI bytes,
+ *          0xFF past the TX buffer, are appended to the wire record, the
+ *          MISO bytes come from spim_mock_miso() of their position on the
+ *          wire. A transfer started with the SPIM disabled, the chip select
+ *          high or a TX buffer EasyDMA cannot read (spim_mock_flash) is
+ *          counted as an error, as the hardware would send garbage.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef SPIM_MOCK_H
+#define SPIM_MOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SPIM_MOCK_WIRE_LEN  4096
+#define SPIM_MOCK_FLASH_LEN 256
+
+typedef struct
+{
+    uint32_t dma;       /**< nrfx_spim_xfer() calls */
+    uint32_t enables;   /**< nrf_spim_enable() calls */
+    uint32_t errors;    /**< transfers the hardware would get wrong */
+} spim_mock_stats_t;
+
+/**
+ * @brief memory EasyDMA cannot read, as flash
+ */
+extern uint8_t spim_mock_flash[SPIM_MOCK_FLASH_LEN];
+
+/**
+ * @brief clear the wire record and the counters, cs_pin the chip select
+ */
+void spim_mock_reset(uint32_t cs_pin);
+
+/**
+ * @brief the MISO byte at a position on the wire
+ */
+uint8_t spim_mock_miso(uint32_t pos);
+
+/**
+ * @brief MOSI bytes recorded since the last reset
+ *
+ * @return number of bytes, *mosi the first
+ */
+uint32_t spim_mock_wire(const uint8_t **mosi);
+
+void spim_mock_get_stats(spim_mock_stats_t *stats);
+
+/**
+ * @brief the SPIM is enabled
+ */
+bool spim_mock_enabled(void);
+
+#endif /* SPIM_MOCK_H */
@@ -0,0 +1,46 @@
+/**
+ * @file    FreeRTOS.h
+ *
+ * @brief   Host stand-in: the FreeRTOS types and macros the tested sources use
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFAIL                  pdFALSE
+#define pdPASS                  pdTRUE
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+
+#define configTICK_RATE_HZ      1000
+#define configMAX_PRIORITIES    7
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY         0xf
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY    5
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((TickType_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+
+#define configASSERT(x)         assert(x)
+#define portYIELD_FROM_ISR(x)   ((void)(x))
+
+#define portBYTE_ALIGNMENT      8
+#define portBYTE_ALIGNMENT_MASK 0x0007
+
+/* the CMSIS core register read the port brings in: nonzero in an ISR */
+uint32_t __get_IPSR(void);
+
+void *pvPortMalloc(size_t size);
+void vPortFree(void *p);
+
+#endif /* FREERTOS_H */
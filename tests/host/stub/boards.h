@@ -0,0 +1,22 @@
+/**
+ * @file    boards.h
+ *
+ * @brief   Host stand-in: the board and application error names of the
+ *          nRF5 SDK
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef BOARDS_H
+#define BOARDS_H
+
+#include <assert.h>
+#include "custom_board.h"
+#include "nrf_gpio.h"
+#include "nrf_error.h"
+
+#define APP_IRQ_PRIORITY_MID        4
+#define APP_ERROR_CHECK(err_code)   assert((err_code) == NRF_SUCCESS)
+
+#endif /* BOARDS_H */
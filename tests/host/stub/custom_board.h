@@ -0,0 +1,17 @@
+/**
+ * @file    custom_board.h
+ *
+ * @brief   Host stand-in: the pins of the DWM3001CDK the tested sources name
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef CUSTOM_BOARD_H
+#define CUSTOM_BOARD_H
+
+#define BUTTON_1        2
+#define BUTTON_2        20
+#define SERVO_PWM_PIN   28
+
+#endif /* CUSTOM_BOARD_H */
@@ -0,0 +1,17 @@
+/**
+ * @file    event_groups.h
+ *
+ * @brief   Host stand-in: the event group handle cmsis_os.h names
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef EVENT_GROUPS_H
+#define EVENT_GROUPS_H
+
+#include "FreeRTOS.h"
+
+typedef void *EventGroupHandle_t;
+
+#endif /* EVENT_GROUPS_H */
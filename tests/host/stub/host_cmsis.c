@@ -0,0 +1,155 @@
+/**
+ * @file    host_cmsis.c
+ *
+ * @brief   Host stand-in of the CMSIS-RTOS threads and signals, see
+ *          host_rtos.h
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "cmsis_os.h"
+#include "host_rtos.h"
+#include "nrf.h"
+
+#define HOST_THREADS_MAX    8
+
+struct host_thread_s
+{
+    os_pthread fn;
+    void *arg;
+    int32_t signals;
+    bool delayed;       /**< waits out a delay: runs again on a new signal */
+    jmp_buf wait;       /**< back to host_threads_run(): the thread waits */
+};
+
+#define HOST_CORE_CLOCK     64000000UL  /**< nRF52833 */
+
+CoreDebug_Type host_core_debug;
+uint32_t SystemCoreClock = HOST_CORE_CLOCK;
+static DWT_Type host_dwt;
+
+static struct host_thread_s threads[HOST_THREADS_MAX];
+static struct host_thread_s *current;
+
+DWT_Type *host_dwt_get(void)
+{
+    struct timespec ts;
+
+    if (host_dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        host_dwt.CYCCNT = (uint32_t)(((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec) *
+                                     (SystemCoreClock / 1000000UL) / 1000u);
+    }
+    return &host_dwt;
+}
+
+osThreadId osThreadCreate(const osThreadDef_t *thread_def, void *argument)
+{
+    for (int i = 0; i < HOST_THREADS_MAX; i++)
+    {
+        if (!threads[i].fn)
+        {
+            threads[i].fn = thread_def->pthread;
+            threads[i].arg = argument;
+            threads[i].signals = 0;
+            threads[i].delayed = false;
+            return &threads[i];
+        }
+    }
+    return NULL;
+}
+
+osStatus osThreadTerminate(osThreadId thread_id)
+{
+    struct host_thread_s *t = thread_id;
+
+    t->fn = NULL;
+    return osOK;
+}
+
+int32_t osSignalSet(osThreadId thread_id, int32_t signal)
+{
+    struct host_thread_s *t = thread_id;
+    int32_t prev;
+
+    if (!t || !t->fn)
+    {
+        return 0x80000000;
+    }
+    prev = t->signals;
+    t->signals |= signal;
+    t->delayed = false;
+    return prev;
+}
+
+osEvent osSignalWait(int32_t signals, uint32_t millisec)
+{
+    struct host_thread_s *t = current;
+    osEvent evt = {.status = osEventSignal};
+
+    (void)millisec;
+    if (!t->signals)
+    {
+        longjmp(t->wait, 1);
+    }
+    evt.value.signals = t->signals;
+    t->signals &= ~signals;
+    return evt;
+}
+
+osStatus osDelay(uint32_t millisec)
+{
+    (void)millisec;
+    if (current)
+    {
+        current->delayed = true;
+        longjmp(current->wait, 1);
+    }
+    /* from the test: let the threads signalled run meanwhile */
+    host_threads_run();
+    return osOK;
+}
+
+osStatus osThreadYield(void)
+{
+    return osDelay(0);
+}
+
+/* @brief run t until it waits */
+static void host_thread_step(struct host_thread_s *t)
+{
+    current = t;
+    if (!setjmp(t->wait))
+    {
+        t->fn(t->arg);
+        /* returned: the thread is over */
+        t->fn = NULL;
+    }
+    current = NULL;
+}
+
+int host_threads_run(void)
+{
+    int runs = 0;
+
+    for (bool ran = true; ran;)
+    {
+        ran = false;
+        for (int i = 0; i < HOST_THREADS_MAX; i++)
+        {
+            if (threads[i].fn && threads[i].signals && !threads[i].delayed)
+            {
+                host_thread_step(&threads[i]);
+                ran = true;
+                runs++;
+            }
+        }
+    }
+    return runs;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file    host_dlog.c
+ *
+ * @brief   Host stand-in of dlog.c: every module off unless a test turns it
+ *          on, lines printed at once to stdout
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "dlog.h"
+
+uint8_t dlog_level[DLOG_MOD_COUNT];
+
+bool dlog_is_deferred(void)
+{
+    return false;
+}
+
+void dlog_emit(dlog_module_e mod, dlog_level_e lvl, const char *fmt, const uint32_t *args, int n_args)
+{
+    (void)mod;
+    (void)lvl;
+    (void)fmt;
+    (void)args;
+    (void)n_args;
+}
+
+void dlog_printf(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+}
+
+void dlog_set_level(dlog_module_e mod, dlog_level_e lvl)
+{
+    for (int m = 0; m < DLOG_MOD_COUNT; m++)
+    {
+        if (m == (int)mod || mod == DLOG_MOD_COUNT)
+        {
+            dlog_level[m] = (uint8_t)lvl;
+        }
+    }
+}
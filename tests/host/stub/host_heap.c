@@ -0,0 +1,58 @@
+/**
+ * @file    host_heap.c
+ *
+ * @brief   Host FreeRTOS heap: pvPortMalloc()/vPortFree() on the C library,
+ *          counted
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "host_heap.h"
+
+/* The FreeRTOS heap_4 block header: realloc() of alloc.c reads the size of
+ * a block from it */
+typedef struct
+{
+    void *next;
+    size_t size;    /**< header included */
+} host_block_t;
+
+static host_heap_stats_t heap_stats;
+
+void *pvPortMalloc(size_t size)
+{
+    host_block_t *b = malloc(sizeof(*b) + size);
+
+    heap_stats.mallocs++;
+    if (!b)
+    {
+        return NULL;
+    }
+    b->next = NULL;
+    b->size = sizeof(*b) + size;
+    heap_stats.used += size;
+    return b + 1;
+}
+
+void vPortFree(void *p)
+{
+    host_block_t *b;
+
+    if (!p)
+    {
+        return;
+    }
+    b = (host_block_t *)p - 1;
+    heap_stats.frees++;
+    heap_stats.used -= b->size - sizeof(*b);
+    free(b);
+}
+
+void host_heap_get_stats(host_heap_stats_t *stats)
+{
+    *stats = heap_stats;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file    host_heap.h
+ *
+ * @brief   Host FreeRTOS heap: pvPortMalloc()/vPortFree() on the C library,
+ *          counted
+ *
+ *          The firmware sources of a host test allocate through alloc.c,
+ *          built with malloc, calloc, realloc and free renamed host_fw_*:
+ *          the calls reach pvPortMalloc()/vPortFree() as on target, while
+ *          the C library and the sanitizers keep their own malloc.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef HOST_HEAP_H
+#define HOST_HEAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct
+{
+    uint32_t mallocs;   /**< pvPortMalloc() calls */
+    uint32_t frees;     /**< vPortFree() calls on a block */
+    size_t used;        /**< bytes allocated now */
+} host_heap_stats_t;
+
+void host_heap_get_stats(host_heap_stats_t *stats);
+
+#endif /* HOST_HEAP_H */
@@ -0,0 +1,30 @@
+/**
+ * @file    host_rtc.c
+ *
+ * @brief   Host stand-in of the RTC: its 24-bit counter at 32768 Hz on the
+ *          clock of host_rtos.h
+ *
+ * @author  Development Team
+ *
+ */
+
+#include "HAL_rtc.h"
+#include "host_rtos.h"
+
+#define HOST_RTC_FREQ   32768
+#define HOST_RTC_MASK   0xFFFFFF
+
+static uint32_t host_rtc_get_counter(void)
+{
+    return (uint32_t)(host_time_us() * HOST_RTC_FREQ / 1000000) & HOST_RTC_MASK;
+}
+
+static uint32_t host_rtc_get_time_elapsed(uint32_t start, uint32_t stop)
+{
+    return (stop - start) & HOST_RTC_MASK;
+}
+
+const struct hal_rtc_s Rtc = {
+    .getTimestamp = &host_rtc_get_counter,
+    .getTimeElapsed = &host_rtc_get_time_elapsed,
+};
@@ -0,0 +1,265 @@
+/**
+ * @file    host_rtos.c
+ *
+ * @brief   Host stand-in of the FreeRTOS calls the tested sources make, on a
+ *          simulated clock
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "semphr.h"
+#include "host_rtos.h"
+
+#define HOST_US_PER_TICK    (1000000 / configTICK_RATE_HZ)
+
+struct host_timer_s
+{
+    TickType_t period;
+    TickType_t expiry;
+    bool reload;
+    bool active;
+    void *id;
+    TimerCallbackFunction_t cb;
+    struct host_timer_s *next;
+};
+
+struct host_sem_s
+{
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+static uint64_t now_us;
+static struct host_timer_s *timers;     /**< by creation */
+
+/* the task and ISR state of each thread of a multi-threaded test */
+static __thread void *host_task;
+static __thread const char *host_task_name;
+static __thread bool host_isr;
+
+uint64_t host_time_us(void)
+{
+    return now_us;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(now_us / HOST_US_PER_TICK);
+}
+
+void host_time_advance_us(uint64_t us)
+{
+    uint64_t end = now_us + us;
+
+    for (;;)
+    {
+        uint64_t next = (now_us / HOST_US_PER_TICK + 1) * HOST_US_PER_TICK;
+        TickType_t tick;
+
+        if (next > end)
+        {
+            break;
+        }
+        now_us = next;
+        tick = xTaskGetTickCount();
+
+        /* a callback may start another timer due at this tick: rescan */
+        for (bool fired = true; fired;)
+        {
+            fired = false;
+            for (struct host_timer_s *t = timers; t; t = t->next)
+            {
+                if (t->active && t->expiry == tick)
+                {
+                    t->active = t->reload;
+                    t->expiry += t->period;
+                    t->cb(t);
+                    fired = true;
+                }
+            }
+        }
+    }
+    now_us = end;
+}
+
+void host_task_enter(void *task, const char *name)
+{
+    host_task = task;
+    host_task_name = name;
+}
+
+void host_isr_set(bool isr)
+{
+    host_isr = isr;
+}
+
+uint32_t __get_IPSR(void)
+{
+    return host_isr ? 16 : 0;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return host_task;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return host_task ? taskSCHEDULER_RUNNING : taskSCHEDULER_NOT_STARTED;
+}
+
+char *pcTaskGetName(TaskHandle_t task)
+{
+    return (char *)((task == NULL || task == host_task) && host_task_name ? host_task_name : "");
+}
+
+void vTaskSuspendAll(void)
+{
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+    return pdFALSE;
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t reload, void *id,
+                           TimerCallbackFunction_t cb)
+{
+    struct host_timer_s *t = calloc(1, sizeof(*t)), **p = &timers;
+
+    (void)name;
+    if (!t || period == 0)
+    {
+        free(t);
+        return NULL;
+    }
+    t->period = period;
+    t->reload = reload;
+    t->id = id;
+    t->cb = cb;
+    while (*p)
+    {
+        p = &(*p)->next;
+    }
+    *p = t;
+    return t;
+}
+
+BaseType_t xTimerStart(TimerHandle_t t, TickType_t wait)
+{
+    (void)wait;
+    t->expiry = xTaskGetTickCount() + t->period;
+    t->active = true;
+    return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t t, TickType_t wait)
+{
+    (void)wait;
+    t->active = false;
+    return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t t, TickType_t period, TickType_t wait)
+{
+    t->period = period;
+    return xTimerStart(t, wait);
+}
+
+BaseType_t xTimerDelete(TimerHandle_t t, TickType_t wait)
+{
+    struct host_timer_s **p = &timers;
+
+    (void)wait;
+    while (*p && *p != t)
+    {
+        p = &(*p)->next;
+    }
+    if (*p)
+    {
+        *p = t->next;
+        free(t);
+    }
+    return pdPASS;
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t t)
+{
+    return t->active;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t t)
+{
+    return t->id;
+}
+
+int host_timers_active(void)
+{
+    int n = 0;
+
+    for (struct host_timer_s *t = timers; t; t = t->next)
+    {
+        n += t->active;
+    }
+    return n;
+}
+
+static SemaphoreHandle_t host_sem_create(UBaseType_t count, UBaseType_t max)
+{
+    struct host_sem_s *s = malloc(sizeof(*s));
+
+    if (s)
+    {
+        s->count = count;
+        s->max = max;
+    }
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return host_sem_create(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return host_sem_create(0, 1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait)
+{
+    (void)wait;
+    if (s->count == 0)
+    {
+        return pdFAIL;
+    }
+    s->count--;
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+    if (s->count >= s->max)
+    {
+        return pdFAIL;
+    }
+    s->count++;
+    return pdPASS;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s)
+{
+    free(s);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t s)
+{
+    return s->count;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file    host_rtos.h
+ *
+ * @brief   Simulated time and threads of the host tests
+ *
+ *          The FreeRTOS stand-ins of this directory run on a clock the test
+ *          moves: one tick per millisecond, the software timers fire from
+ *          host_time_advance_us() at their tick, in order.
+ *
+ *          The CMSIS threads of host_cmsis.c run from host_threads_run(),
+ *          one after the other, each until it waits for a signal it does not
+ *          have or delays. A thread runs from the start of its function each
+ *          time: the event loops of the firmware tasks keep no state across
+ *          a wait. A thread that delayed runs again on its next signal
+ *          only, with the signals it left pending.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef HOST_RTOS_H
+#define HOST_RTOS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief microseconds since the start of the test
+ */
+uint64_t host_time_us(void);
+
+/**
+ * @brief move the clock us forward, firing the timers that fall due
+ */
+void host_time_advance_us(uint64_t us);
+
+/**
+ * @brief software timers running
+ */
+int host_timers_active(void);
+
+/**
+ * @brief the calling thread runs as task, named name, from now on; NULL:
+ *        the scheduler has not started, the default
+ */
+void host_task_enter(void *task, const char *name);
+
+/**
+ * @brief the calling thread runs an ISR, or is back in its task
+ */
+void host_isr_set(bool isr);
+
+/**
+ * @brief run the threads signalled, until none is
+ *
+ * @return thread runs
+ */
+int host_threads_run(void);
+
+#endif /* HOST_RTOS_H */
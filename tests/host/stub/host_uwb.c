@@ -0,0 +1,187 @@
+/**
+ * @file    host_uwb.c
+ *
+ * @brief   Host stand-ins of the UWB HAL and of the application getters the
+ *          UWB layer calls
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdlib.h>
+
+#include "HAL_uwb.h"
+#include "HAL_SPI.h"
+#include "HAL_timer.h"
+#include "HAL_error.h"
+#include "dw3000_mcps_mcu.h"
+#include "dw3000_pdoa.h"
+#include "dw3000_sim.h"
+#include "host_uwb.h"
+
+static struct dwchip_s uwbs_chip;
+
+static void host_spi_rate(void *handler)
+{
+    (void)handler;
+}
+
+static struct spi_s host_spi = {
+    .slow_rate = host_spi_rate,
+    .fast_rate = host_spi_rate,
+};
+
+static struct dw_s host_uwbs = {
+    .spi = &host_spi,
+    .dw = &uwbs_chip,
+};
+
+static void host_uwb_nop(void)
+{
+}
+
+static void host_uwb_sleep_status_set(sleep_status_t status)
+{
+    hal_uwb.vsleep_status = status;
+}
+
+static aoa_enable_t host_uwb_is_aoa(void)
+{
+    return AOA_ENABLED;
+}
+
+struct hal_uwb_s hal_uwb = {
+    .enableIRQ = host_uwb_nop,
+    .disableIRQ = host_uwb_nop,
+    .reset = host_uwb_nop,
+    .wakeup_start = host_uwb_nop,
+    .wakeup_end = host_uwb_nop,
+    .wakeup_with_io = host_uwb_nop,
+    .sleep_status_set = host_uwb_sleep_status_set,
+    .is_aoa = host_uwb_is_aoa,
+    .uwbs = &host_uwbs,
+};
+
+/* Fast sleep timer */
+static struct
+{
+    void *dwchip;
+    void (*cb)(void *);
+    bool armed;
+} fs_timer;
+
+static void host_fs_timer_init(void *self, void *dwchip, void (*cb)(void *))
+{
+    (void)self;
+    fs_timer.dwchip = dwchip;
+    fs_timer.cb = cb;
+    fs_timer.armed = false;
+}
+
+static void host_fs_timer_start(void *self, bool int_en, uint32_t next_cc_us, int corr_tick)
+{
+    (void)self;
+    (void)next_cc_us;
+    (void)corr_tick;
+    fs_timer.armed = int_en;
+}
+
+static void host_fs_timer_stop(void *self)
+{
+    (void)self;
+    fs_timer.armed = false;
+}
+
+static uint32_t const host_fs_timer_get_tick(void *self)
+{
+    (void)self;
+    return 0;
+}
+
+hal_fs_timer_t hal_fs_timer = {
+    .init = host_fs_timer_init,
+    .start = host_fs_timer_start,
+    .stop = host_fs_timer_stop,
+    .get_tick = host_fs_timer_get_tick,
+    .freq = 1000000,
+};
+
+bool host_fs_timer_fire(void)
+{
+    if (!fs_timer.armed || !fs_timer.cb)
+    {
+        return false;
+    }
+    fs_timer.armed = false;
+    fs_timer.cb(fs_timer.dwchip);
+    return true;
+}
+
+bool host_fs_timer_armed(void)
+{
+    return fs_timer.armed;
+}
+
+struct dwchip_s *host_uwb_open(struct dwt_mcps_config_s *config)
+{
+    struct dwchip_s *dw;
+
+    dw3000_sim_attach(&uwbs_chip);
+    dw = dw3000_mcps_alloc();
+    if (!dw)
+    {
+        return NULL;
+    }
+    dw3000_sim_attach(dw);
+    dw->config = config;
+    dw3000_mcps_register(dw);
+    return dw;
+}
+
+void host_uwb_close(struct dwchip_s *dw)
+{
+    dw3000_mcps_unregister(dw);
+    dw3000_sim_detach(dw);
+    dw3000_mcps_free(dw);
+    dw3000_sim_detach(&uwbs_chip);
+}
+
+/* Application side */
+void error_handler(int block, error_e err)
+{
+    (void)block;
+    (void)err;
+    abort();
+}
+
+struct dwchip_s *dwt_update_dw(struct dwchip_s *new_dw)
+{
+    static struct dwchip_s *cur;
+    struct dwchip_s *old = cur;
+
+    cur = new_dw;
+    return old;
+}
+
+uint8_t get_local_pavrg_size(void)
+{
+    return 0;
+}
+
+uint8_t get_local_pavrg_mode(void)
+{
+    return 0;
+}
+
+int get_rx_ctx_size(void)
+{
+    return sizeof(struct avrg_s);
+}
+
+void hw_debug_D0(void)
+{
+}
+
+void hw_debug_D1(void)
+{
+}
@@ -0,0 +1,48 @@
+/**
+ * @file    host_uwb.h
+ *
+ * @brief   Host stand-ins of the UWB HAL: the DW3000 of hal_uwb and the fast
+ *          sleep timer the deep sleep path programs
+ *
+ *          hal_uwb.uwbs->dw is the chip dw3000_mcps_alloc() copies its
+ *          driver from: host_uwb_open() makes it a dw3000_sim.h model, then
+ *          allocates and registers the MCPS chip on a model of its own, as
+ *          fira_uwb_mcps_init() does on target.
+ *
+ *          hal_fs_timer only records its last start(): the test fires it
+ *          with host_fs_timer_fire(), which calls the callback the deep
+ *          sleep path registered, as the timer interrupt does.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef HOST_UWB_H
+#define HOST_UWB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "deca_interface.h"
+
+/**
+ * @brief the MCPS chip on the model, configured with config, registered
+ *
+ * @return NULL if out of memory
+ */
+struct dwchip_s *host_uwb_open(struct dwt_mcps_config_s *config);
+
+void host_uwb_close(struct dwchip_s *dw);
+
+/**
+ * @brief interrupt of the fast sleep timer, if started with int_en
+ *
+ * @return true if the callback ran
+ */
+bool host_fs_timer_fire(void);
+
+/**
+ * @brief the fast sleep timer waits to interrupt
+ */
+bool host_fs_timer_armed(void);
+
+#endif /* HOST_UWB_H */
@@ -0,0 +1,38 @@
+/**
+ * @file    nrf.h
+ *
+ * @brief   Host stand-in: the debug registers of the cycle counter, which
+ *          counts at SystemCoreClock on the monotonic clock once enabled
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef NRF_H
+#define NRF_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct
+{
+    uint32_t CTRL;
+    uint32_t CYCCNT;
+} DWT_Type;
+
+extern CoreDebug_Type host_core_debug;
+extern uint32_t SystemCoreClock;
+
+/* @brief the registers, CYCCNT brought to the current time */
+DWT_Type *host_dwt_get(void);
+
+#define CoreDebug                   (&host_core_debug)
+#define DWT                         (host_dwt_get())
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+
+#endif /* NRF_H */
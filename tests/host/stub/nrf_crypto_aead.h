@@ -0,0 +1,38 @@
+/**
+ * @file    nrf_crypto_aead.h
+ *
+ * @brief   Host stand-in: the nRF5 SDK AEAD API that mcps_crypto.c uses,
+ *          AES-CCM* 128, on the software AES of mock/nrf_crypto_mock.c
+ *
+ *          A context holds its key schedule, as the CryptoCell backend
+ *          holds its key: nrf_crypto_aead_init() runs it, no allocation.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef NRF_CRYPTO_AEAD_H__
+#define NRF_CRYPTO_AEAD_H__
+
+#include "nrf_crypto_aes.h"
+
+typedef enum
+{
+    NRF_CRYPTO_AES_CCM_128,
+} nrf_crypto_aead_info_t;
+
+typedef struct
+{
+    const nrf_crypto_aead_info_t *info;
+    aes_mock_t aes;
+} nrf_crypto_aead_context_t;
+
+extern const nrf_crypto_aead_info_t g_nrf_crypto_aes_ccm_128_info;
+
+ret_code_t nrf_crypto_aead_init(nrf_crypto_aead_context_t *ctx, const nrf_crypto_aead_info_t *info, uint8_t *key);
+ret_code_t nrf_crypto_aead_uninit(void *ctx);
+ret_code_t nrf_crypto_aead_crypt(nrf_crypto_aead_context_t *ctx, nrf_crypto_operation_t operation, uint8_t *nonce,
+                                 uint8_t nonce_size, uint8_t *adata, size_t adata_size, uint8_t *data_in,
+                                 size_t data_in_size, uint8_t *data_out, uint8_t *mac, uint8_t mac_size);
+
+#endif /* NRF_CRYPTO_AEAD_H__ */
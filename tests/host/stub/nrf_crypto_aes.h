@@ -0,0 +1,61 @@
+/**
+ * @file    nrf_crypto_aes.h
+ *
+ * @brief   Host stand-in: the nRF5 SDK AES API that mcps_crypto.c uses,
+ *          ECB and CMAC, on the software AES of mock/nrf_crypto_mock.c
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef NRF_CRYPTO_AES_H__
+#define NRF_CRYPTO_AES_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "nrf_error.h"
+#include "aes_mock.h"
+
+#define NRF_ERROR_CRYPTO_ERR_BASE               0x8500
+#define NRF_ERROR_CRYPTO_FEATURE_UNAVAILABLE    (NRF_ERROR_CRYPTO_ERR_BASE + 0x03)
+#define NRF_ERROR_CRYPTO_BUSY                   (NRF_ERROR_CRYPTO_ERR_BASE + 0x04)
+#define NRF_ERROR_CRYPTO_INVALID_PARAM          (NRF_ERROR_CRYPTO_ERR_BASE + 0x20)
+#define NRF_ERROR_CRYPTO_ALLOC_FAILED           (NRF_ERROR_CRYPTO_ERR_BASE + 0x40)
+#define NRF_ERROR_CRYPTO_STACK_OVERFLOW         (NRF_ERROR_CRYPTO_ERR_BASE + 0x41)
+#define NRF_ERROR_CRYPTO_AEAD_INVALID_MAC       (NRF_ERROR_CRYPTO_ERR_BASE + 0xA0)
+
+#define NRF_CRYPTO_KEY_SIZE_128 128
+
+typedef enum
+{
+    NRF_CRYPTO_ENCRYPT = 0,
+    NRF_CRYPTO_DECRYPT = 1,
+    NRF_CRYPTO_MAC_CALCULATE = 2,
+} nrf_crypto_operation_t;
+
+typedef enum
+{
+    NRF_CRYPTO_AES_ECB_128,
+    NRF_CRYPTO_AES_CMAC_128,
+} nrf_crypto_aes_info_t;
+
+typedef struct
+{
+    const nrf_crypto_aes_info_t *info;
+    uint8_t key[NRF_CRYPTO_KEY_SIZE_128 / 8];
+} nrf_crypto_aes_context_t;
+
+extern const nrf_crypto_aes_info_t g_nrf_crypto_aes_ecb_128_info;
+extern const nrf_crypto_aes_info_t g_nrf_crypto_aes_cmac_128_info;
+
+ret_code_t nrf_crypto_aes_init(nrf_crypto_aes_context_t *ctx, const nrf_crypto_aes_info_t *info,
+                               nrf_crypto_operation_t operation);
+ret_code_t nrf_crypto_aes_key_set(nrf_crypto_aes_context_t *ctx, uint8_t *key);
+ret_code_t nrf_crypto_aes_finalize(nrf_crypto_aes_context_t *ctx, uint8_t *data_in, size_t data_size,
+                                   uint8_t *data_out, size_t *data_out_size);
+ret_code_t nrf_crypto_aes_uninit(nrf_crypto_aes_context_t *ctx);
+ret_code_t nrf_crypto_aes_crypt(nrf_crypto_aes_context_t *ctx, const nrf_crypto_aes_info_t *info,
+                                nrf_crypto_operation_t operation, uint8_t *key, uint8_t *iv, uint8_t *data_in,
+                                size_t data_size, uint8_t *data_out, size_t *data_out_size);
+
+#endif /* NRF_CRYPTO_AES_H__ */
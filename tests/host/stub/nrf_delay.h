@@ -0,0 +1,18 @@
+/**
+ * @file    nrf_delay.h
+ *
+ * @brief   Host stand-in: the busy waits of the nRF5 SDK
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef NRF_DELAY_H__
+#define NRF_DELAY_H__
+
+#include <stdint.h>
+
+void nrf_delay_us(uint32_t us);
+void nrf_delay_ms(uint32_t ms);
+
+#endif /* NRF_DELAY_H__ */
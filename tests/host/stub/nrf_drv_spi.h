@@ -0,0 +1,102 @@
+/**
+ * @file    nrf_drv_spi.h
+ *
+ * @brief   Host stand-in: the SPI driver and the SPIM transfer of the nRF5
+ *          SDK, on spim_mock.c. SPIM0 is the DW3000 port.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef NRF_DRV_SPI_H__
+#define NRF_DRV_SPI_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "nrf_error.h"
+#include "nrfx_errors.h"
+#include "nrf_spim.h"
+
+#define NRFX_SPIM0_ENABLED      1
+#define NRFX_SPIM3_ENABLED      0
+#define NRFX_SPIM0_INST_IDX     0
+#define NRFX_SPIM3_INST_IDX     1
+#define SPI0_INSTANCE_INDEX     0
+#define SPI3_INSTANCE_INDEX     3
+#define SPI0_USE_EASY_DMA       1
+#define SPI3_USE_EASY_DMA       1
+#define NRFX_SPIM_PIN_NOT_USED  0xFF
+
+typedef struct
+{
+    NRF_SPIM_Type *p_reg;
+    uint8_t drv_inst_idx;
+} nrfx_spim_t;
+
+typedef struct
+{
+    uint8_t inst_idx;
+    union
+    {
+        nrfx_spim_t spim;
+    } u;
+    bool use_easy_dma;
+} nrf_drv_spi_t;
+
+typedef enum
+{
+    NRF_DRV_SPI_MODE_0 = 0,
+    NRF_DRV_SPI_MODE_1,
+    NRF_DRV_SPI_MODE_2,
+    NRF_DRV_SPI_MODE_3,
+} nrf_drv_spi_mode_t;
+
+typedef enum
+{
+    NRF_DRV_SPI_BIT_ORDER_MSB_FIRST = 0,
+    NRF_DRV_SPI_BIT_ORDER_LSB_FIRST,
+} nrf_drv_spi_bit_order_t;
+
+typedef struct
+{
+    uint8_t sck_pin;
+    uint8_t mosi_pin;
+    uint8_t miso_pin;
+    uint8_t ss_pin;
+    uint8_t irq_priority;
+    uint8_t orc;
+    uint32_t frequency;
+    nrf_drv_spi_mode_t mode;
+    nrf_drv_spi_bit_order_t bit_order;
+} nrf_drv_spi_config_t;
+
+typedef void (*nrf_drv_spi_evt_handler_t)(void const *p_event, void *p_context);
+
+ret_code_t nrf_drv_spi_init(nrf_drv_spi_t const *p_instance, nrf_drv_spi_config_t const *p_config,
+                            nrf_drv_spi_evt_handler_t handler, void *p_context);
+void nrf_drv_spi_uninit(nrf_drv_spi_t const *p_instance);
+
+typedef struct
+{
+    uint8_t const *p_tx_buffer;
+    size_t tx_length;
+    uint8_t *p_rx_buffer;
+    size_t rx_length;
+} nrfx_spim_xfer_desc_t;
+
+#define NRFX_SPIM_XFER_TRX(p_tx_buf, tx_len, p_rx_buf, rx_len) \
+    {                                                          \
+        .p_tx_buffer = (uint8_t const *)(p_tx_buf),            \
+        .tx_length = (tx_len),                                 \
+        .p_rx_buffer = (p_rx_buf),                             \
+        .rx_length = (rx_len),                                 \
+    }
+
+nrfx_err_t nrfx_spim_xfer(nrfx_spim_t const *p_instance, nrfx_spim_xfer_desc_t const *p_xfer_desc,
+                          uint32_t flags);
+
+/* EasyDMA reads RAM only */
+bool nrfx_is_in_ram(void const *p_object);
+
+#endif /* NRF_DRV_SPI_H__ */
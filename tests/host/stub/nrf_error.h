@@ -0,0 +1,19 @@
+/**
+ * @file    nrf_error.h
+ *
+ * @brief   Host stand-in: the nRF5 SDK error codes
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef NRF_ERROR_H__
+#define NRF_ERROR_H__
+
+#include <stdint.h>
+
+typedef uint32_t ret_code_t;
+
+#define NRF_SUCCESS     0
+
+#endif /* NRF_ERROR_H__ */
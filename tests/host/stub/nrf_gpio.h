@@ -0,0 +1,55 @@
+/**
+ * @file    nrf_gpio.h
+ *
+ * @brief   Host stand-in: the GPIO names of the board headers, the pin calls
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef NRF_GPIO_H__
+#define NRF_GPIO_H__
+
+#include <stdint.h>
+
+#define NRF_GPIO_PIN_MAP(port, pin) (((port) << 5) | ((pin) & 0x1F))
+
+typedef enum
+{
+    NRF_GPIO_PIN_NOPULL = 0,
+    NRF_GPIO_PIN_PULLDOWN = 1,
+    NRF_GPIO_PIN_PULLUP = 3,
+} nrf_gpio_pin_pull_t;
+
+typedef enum
+{
+    NRF_GPIO_PIN_DIR_INPUT = 0,
+    NRF_GPIO_PIN_DIR_OUTPUT = 1,
+} nrf_gpio_pin_dir_t;
+
+typedef enum
+{
+    NRF_GPIO_PIN_INPUT_CONNECT = 0,
+    NRF_GPIO_PIN_INPUT_DISCONNECT = 1,
+} nrf_gpio_pin_input_t;
+
+typedef enum
+{
+    NRF_GPIO_PIN_S0S1 = 0,
+    NRF_GPIO_PIN_H0H1 = 3,
+} nrf_gpio_pin_drive_t;
+
+typedef enum
+{
+    NRF_GPIO_PIN_NOSENSE = 0,
+} nrf_gpio_pin_sense_t;
+
+/* on the pins of gpio_mock.c */
+uint32_t nrf_gpio_pin_read(uint32_t pin_number);
+void nrf_gpio_pin_set(uint32_t pin_number);
+void nrf_gpio_pin_clear(uint32_t pin_number);
+void nrf_gpio_cfg_output(uint32_t pin_number);
+void nrf_gpio_cfg(uint32_t pin_number, nrf_gpio_pin_dir_t dir, nrf_gpio_pin_input_t input,
+                  nrf_gpio_pin_pull_t pull, nrf_gpio_pin_drive_t drive, nrf_gpio_pin_sense_t sense);
+
+#endif /* NRF_GPIO_H__ */
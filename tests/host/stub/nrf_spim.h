@@ -0,0 +1,29 @@
+/**
+ * @file    nrf_spim.h
+ *
+ * @brief   Host stand-in: the SPIM peripheral, on spim_mock.c
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef NRF_SPIM_H__
+#define NRF_SPIM_H__
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t ENABLE;
+} NRF_SPIM_Type;
+
+extern NRF_SPIM_Type host_spim0;
+extern NRF_SPIM_Type host_spim3;
+
+#define NRF_SPIM0   (&host_spim0)
+#define NRF_SPIM3   (&host_spim3)
+
+void nrf_spim_enable(NRF_SPIM_Type *p_reg);
+void nrf_spim_disable(NRF_SPIM_Type *p_reg);
+
+#endif /* NRF_SPIM_H__ */
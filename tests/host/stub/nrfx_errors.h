@@ -0,0 +1,20 @@
+/**
+ * @file    nrfx_errors.h
+ *
+ * @brief   Host stand-in: the nrfx error codes
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef NRFX_ERRORS_H__
+#define NRFX_ERRORS_H__
+
+typedef enum
+{
+    NRFX_SUCCESS = 0,
+    NRFX_ERROR_NO_MEM = 1,
+    NRFX_ERROR_BUSY = 2,
+} nrfx_err_t;
+
+#endif /* NRFX_ERRORS_H__ */
@@ -0,0 +1,53 @@
+/**
+ * @file    nrfx_gpiote.h
+ *
+ * @brief   Host stand-in: the GPIOTE input calls, on the pins of gpio_mock.c
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef NRFX_GPIOTE_H__
+#define NRFX_GPIOTE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nrf_gpio.h"
+#include "nrfx_errors.h"
+
+typedef uint32_t nrfx_gpiote_pin_t;
+
+typedef enum
+{
+    NRF_GPIOTE_POLARITY_LOTOHI = 1,
+    NRF_GPIOTE_POLARITY_HITOLO = 2,
+    NRF_GPIOTE_POLARITY_TOGGLE = 3,
+} nrf_gpiote_polarity_t;
+
+typedef struct
+{
+    nrf_gpiote_polarity_t sense;
+    nrf_gpio_pin_pull_t pull;
+    bool is_watcher;
+    bool hi_accuracy;
+    bool skip_gpio_setup;
+} nrfx_gpiote_in_config_t;
+
+#define NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(hi_accu) \
+    {                                               \
+        .sense = NRF_GPIOTE_POLARITY_TOGGLE,        \
+        .pull = NRF_GPIO_PIN_NOPULL,                \
+        .is_watcher = false,                        \
+        .hi_accuracy = (hi_accu),                   \
+        .skip_gpio_setup = false,                   \
+    }
+
+typedef void (*nrfx_gpiote_evt_handler_t)(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action);
+
+bool nrfx_gpiote_is_init(void);
+nrfx_err_t nrfx_gpiote_init(void);
+nrfx_err_t nrfx_gpiote_in_init(nrfx_gpiote_pin_t pin, const nrfx_gpiote_in_config_t *config,
+                               nrfx_gpiote_evt_handler_t handler);
+void nrfx_gpiote_in_event_enable(nrfx_gpiote_pin_t pin, bool int_enable);
+
+#endif /* NRFX_GPIOTE_H__ */
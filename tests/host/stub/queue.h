@@ -0,0 +1,17 @@
+/**
+ * @file    queue.h
+ *
+ * @brief   Host stand-in: the queue handle cmsis_os.h names
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef void *QueueHandle_t;
+
+#endif /* QUEUE_H */
@@ -0,0 +1,30 @@
+/**
+ * @file    semphr.h
+ *
+ * @brief   Host stand-in: semaphores and mutexes of a single thread
+ *
+ *          A take that would block fails at once, whatever the wait: with
+ *          one thread nothing could give it meanwhile.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef SEMPHR_H
+#define SEMPHR_H
+
+#include "FreeRTOS.h"
+
+typedef struct host_sem_s *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s);
+void vSemaphoreDelete(SemaphoreHandle_t s);
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t s);
+
+#define xSemaphoreGiveFromISR(s, woken)     xSemaphoreGive(s)
+#define xSemaphoreTakeFromISR(s, woken)     xSemaphoreTake((s), 0)
+
+#endif /* SEMPHR_H */
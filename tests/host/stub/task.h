@@ -0,0 +1,33 @@
+/**
+ * @file    task.h
+ *
+ * @brief   Host stand-in: a single thread, critical sections are no-ops;
+ *          the task a thread runs as is set by host_task_enter()
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define taskENTER_CRITICAL_FROM_ISR()   0
+#define taskEXIT_CRITICAL_FROM_ISR(x)   ((void)(x))
+
+#define taskSCHEDULER_NOT_STARTED       ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING           ((BaseType_t)2)
+
+TickType_t xTaskGetTickCount(void);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskGetSchedulerState(void);
+char *pcTaskGetName(TaskHandle_t task);
+
+#endif /* TASK_H */
@@ -0,0 +1,33 @@
+/**
+ * @file    timers.h
+ *
+ * @brief   Host stand-in: software timers on the clock of host_rtos.h
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef TIMERS_H
+#define TIMERS_H
+
+#include "FreeRTOS.h"
+
+typedef struct host_timer_s *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t xTimer);
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t reload, void *id,
+                           TimerCallbackFunction_t cb);
+BaseType_t xTimerStart(TimerHandle_t t, TickType_t wait);
+BaseType_t xTimerStop(TimerHandle_t t, TickType_t wait);
+BaseType_t xTimerChangePeriod(TimerHandle_t t, TickType_t period, TickType_t wait);
+BaseType_t xTimerDelete(TimerHandle_t t, TickType_t wait);
+BaseType_t xTimerIsTimerActive(TimerHandle_t t);
+void *pvTimerGetTimerID(TimerHandle_t t);
+
+#define xTimerReset(t, wait)                        xTimerStart((t), (wait))
+#define xTimerStartFromISR(t, woken)                xTimerStart((t), 0)
+#define xTimerStopFromISR(t, woken)                 xTimerStop((t), 0)
+#define xTimerResetFromISR(t, woken)                xTimerStart((t), 0)
+#define xTimerChangePeriodFromISR(t, p, woken)      xTimerChangePeriod((t), (p), 0)
+
+#endif /* TIMERS_H */
@@ -0,0 +1,70 @@
+/**
+ * @file    test.h
+ *
+ * @brief   Checks of the host tests
+ *
+ *          Each test is a program: CHECK() reports a failed condition and
+ *          carries on, test_done() gives the exit status for ctest.
+ *          test_cycles() times the host benchmarks: the time stamp counter
+ *          on x86, nanoseconds elsewhere.
+ *
+ * @author  Development Team
+ *
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static int test_checks;
+static int test_failures;
+
+#define CHECK(cond)                                                                     \
+    do                                                                                  \
+    {                                                                                   \
+        test_checks++;                                                                  \
+        if (!(cond))                                                                    \
+        {                                                                               \
+            test_failures++;                                                            \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);    \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                  \
+    do                                                                                  \
+    {                                                                                   \
+        long long a_ = (long long)(a), b_ = (long long)(b);                             \
+        test_checks++;                                                                  \
+        if (a_ != b_)                                                                   \
+        {                                                                               \
+            test_failures++;                                                            \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",           \
+                    __FILE__, __LINE__, #a, #b, a_, b_);                                \
+        }                                                                               \
+    } while (0)
+
+static inline uint64_t test_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline int test_done(const char *name)
+{
+    printf("%s: %d checks, %d failed\n", name, test_checks, test_failures);
+    return test_failures ? 1 : 0;
+}
+
+#endif /* TEST_H */
@@ -0,0 +1,146 @@
+/**
+ * @file    test_button.c
+ *
+ * @brief   button_handler.c on bouncy waveforms: one change per press or
+ *          release, confirmed BUTTON_LOCKOUT_MS after its first edge, and no
+ *          timer running while idle
+ *
+ * @author  Development Team
+ *
+ */
+
+#include "test.h"
+#include "host_rtos.h"
+#include "gpio_mock.h"
+#include "button_handler.h"
+#include "custom_board.h"
+#include "reporter.h"
+
+#define EVENTS_MAX  16
+#define TICK_US     1000    /**< the timers run on the tick */
+#define RTC_US      31      /**< an Rtc tick, rounded up */
+#define END_US      1000000
+
+typedef struct
+{
+    uint32_t t_us;
+    bool high;
+} edge_t;
+
+typedef struct
+{
+    button_id_e id;
+    bool pressed;
+    uint64_t t_us;
+} event_t;
+
+/* SW1, pulled up: low is pressed */
+static const edge_t wave[] = {
+    /* press, 3 ms of bounce: 6 bounces */
+    {1000, 0}, {1200, 1}, {1500, 0}, {1900, 1}, {2400, 0}, {3000, 1}, {4000, 0},
+    /* release, 2 ms of bounce: 4 bounces */
+    {204000, 1}, {204300, 0}, {204800, 1}, {205500, 0}, {206000, 1},
+    /* 100 us glitch: 1 bounce, no change */
+    {400000, 0}, {400100, 1},
+    /* double press 60 ms apart: 2 bounces */
+    {500000, 0}, {500200, 1}, {500400, 0}, {560000, 1}, {620000, 0}, {680000, 1},
+};
+
+/* the first edge of each change */
+static const event_t want[] = {
+    {BUTTON_SW1, true, 1000},    {BUTTON_SW1, false, 204000}, {BUTTON_SW1, true, 500000},
+    {BUTTON_SW1, false, 560000}, {BUTTON_SW1, true, 620000},  {BUTTON_SW1, false, 680000},
+};
+
+static event_t events[EVENTS_MAX];
+static int n_events;
+
+static error_e report_print(char *buff, int len)
+{
+    (void)buff;
+    (void)len;
+    return _NO_ERR;
+}
+
+reporter_t reporter_instance = {.print = report_print};
+
+static void on_button(button_id_e id, bool pressed)
+{
+    if (n_events < EVENTS_MAX)
+    {
+        events[n_events++] = (event_t){id, pressed, host_time_us()};
+    }
+}
+
+static void run_to(uint64_t t_us)
+{
+    host_time_advance_us(t_us - host_time_us());
+}
+
+int main(void)
+{
+    button_stats_t st;
+
+    button_handler_init();
+    button_handler_register_callback(on_button);
+    CHECK(gpio_mock_enabled(BUTTON_1));
+    CHECK(gpio_mock_enabled(BUTTON_2));
+    CHECK_EQ(host_timers_active(), 0);
+
+    for (size_t i = 0; i < sizeof(wave) / sizeof(wave[0]); i++)
+    {
+        run_to(wave[i].t_us);
+        /* idle between the changes */
+        if (i == 0 || wave[i].t_us - wave[i - 1].t_us > BUTTON_LOCKOUT_MS * 1000)
+        {
+            CHECK_EQ(host_timers_active(), 0);
+        }
+        gpio_mock_set(BUTTON_1, wave[i].high);
+        CHECK_EQ(host_timers_active(), 1);
+    }
+    run_to(END_US);
+    CHECK_EQ(host_timers_active(), 0);
+
+    /* each change once, the lockout after its first edge, to the tick */
+    CHECK_EQ(n_events, (int)(sizeof(want) / sizeof(want[0])));
+    for (int i = 0; i < n_events && i < (int)(sizeof(want) / sizeof(want[0])); i++)
+    {
+        uint64_t lockout = events[i].t_us - want[i].t_us;
+
+        CHECK_EQ(events[i].id, want[i].id);
+        CHECK_EQ(events[i].pressed, want[i].pressed);
+        CHECK(lockout > BUTTON_LOCKOUT_MS * 1000 - TICK_US && lockout <= BUTTON_LOCKOUT_MS * 1000);
+    }
+    CHECK(!button_is_pressed(BUTTON_SW1));
+    CHECK(!button_is_pressed(BUTTON_SW2));
+
+    button_handler_get_stats(&st);
+    CHECK_EQ(st.presses, 3);
+    CHECK_EQ(st.bounces, 6 + 4 + 1 + 2);
+    CHECK_EQ(st.glitches, 1);
+    CHECK(st.confirm_max_us <= BUTTON_LOCKOUT_MS * 1000 + RTC_US);
+    CHECK(st.confirm_sum_us > 3 * (BUTTON_LOCKOUT_MS * 1000 - TICK_US));
+
+    /* SW2 on its own timer while SW1 bounces, the enqueue from its edge */
+    button_handler_reset_stats();
+    n_events = 0;
+    gpio_mock_set(BUTTON_2, false);
+    run_to(END_US + 5000);
+    gpio_mock_set(BUTTON_1, false);
+    gpio_mock_set(BUTTON_1, true);
+    CHECK_EQ(host_timers_active(), 2);
+    run_to(END_US + 50000);
+    CHECK_EQ(n_events, 1);
+    CHECK_EQ(events[0].id, BUTTON_SW2);
+    CHECK(events[0].pressed);
+    CHECK(button_is_pressed(BUTTON_SW2));
+    CHECK_EQ(button_handler_get_edge_time(BUTTON_SW2), (uint32_t)((uint64_t)END_US * 32768 / 1000000));
+    button_handler_mark_enqueue(BUTTON_SW2);
+    button_handler_get_stats(&st);
+    CHECK_EQ(st.enqueued, 1);
+    CHECK(st.enqueue_last_us >= 50000 - RTC_US && st.enqueue_last_us <= 50000 + RTC_US);
+    CHECK_EQ(st.glitches, 1);
+    CHECK_EQ(host_timers_active(), 0);
+
+    return test_done("button");
+}
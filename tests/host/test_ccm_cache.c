@@ -0,0 +1,217 @@
+/**
+ * @file    test_ccm_cache.c
+ *
+ * @brief   AES-CCM* contexts of mcps_crypto.c: a context per call against
+ *          the keyed cache, decryptions per second and heap operations,
+ *          none per decryption once the cache is warm; re-keying, a full
+ *          cache and a flush
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "test.h"
+#include "host_heap.h"
+#include "nrf_crypto_mock.h"
+#include "mcps_crypto.h"
+#include "mcps_crypto_cache.h"
+
+#define FRAMES      5000
+#define DATA_LEN    32          /**< an SP1 payload */
+#define MIC_LEN     8
+#define KEY_ID      1
+
+/* RFC 3610, packet vector #1 */
+static const uint8_t key[16] = {0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+                                0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF};
+static const uint8_t nonce[MCPS_CRYPTO_AES_CCM_STAR_NONCE_LEN] = {0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00,
+                                                                  0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+static const uint8_t hdr[8] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
+static const uint8_t plain[23] = {0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13,
+                                  0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E};
+static const uint8_t cipher[23] = {0x58, 0x8C, 0x97, 0x9A, 0x61, 0xC6, 0x63, 0xD2, 0xF0, 0x66, 0xD0, 0xC2,
+                                   0xC0, 0xF9, 0x89, 0x80, 0x6D, 0x5F, 0x6B, 0x61, 0xDA, 0xC3, 0x84};
+static const uint8_t mic[MIC_LEN] = {0x17, 0xE8, 0xD1, 0x2C, 0xFD, 0xF9, 0x26, 0xE0};
+
+typedef struct
+{
+    uint64_t cycles;
+    double per_s;
+    uint32_t heap_ops;
+    uint32_t key_schedules;
+} run_t;
+
+static uint8_t frame[DATA_LEN];
+static uint8_t frame_mic[MIC_LEN];
+
+static uint32_t heap_ops(void)
+{
+    host_heap_stats_t h;
+
+    host_heap_get_stats(&h);
+    return h.mallocs + h.frees;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* @brief decrypt frame in place of a copy, as report_cb() does */
+static void decrypt(void *ctx)
+{
+    uint8_t data[DATA_LEN], m[MIC_LEN];
+
+    memcpy(data, frame, DATA_LEN);
+    memcpy(m, frame_mic, MIC_LEN);
+    CHECK_EQ(mcps_crypto_aead_aes_ccm_star_128_decrypt(ctx, nonce, hdr, sizeof(hdr), data, DATA_LEN, m, MIC_LEN),
+             UWBMAC_SUCCESS);
+    CHECK_EQ(data[DATA_LEN - 1], DATA_LEN - 1);
+}
+
+/* @brief FRAMES decryptions, a context created for each or the cached one */
+static void run(bool cached, run_t *r)
+{
+    uint32_t ops = heap_ops(), ks = nrf_crypto_mock_key_schedules();
+    double t = now_s();
+    uint64_t c0 = test_cycles();
+
+    for (int i = 0; i < FRAMES; i++)
+    {
+        void *ctx;
+
+        if (cached)
+        {
+            ctx = mcps_crypto_ccm_cache_get(KEY_ID, key);
+            CHECK(ctx != NULL);
+            decrypt(ctx);
+            mcps_crypto_ccm_cache_put(ctx);
+        }
+        else
+        {
+            ctx = mcps_crypto_aead_aes_ccm_star_128_create(key);
+            CHECK(ctx != NULL);
+            decrypt(ctx);
+            mcps_crypto_aead_aes_ccm_star_128_destroy(ctx);
+        }
+    }
+    r->cycles = (test_cycles() - c0) / FRAMES;
+    r->per_s = FRAMES / (now_s() - t);
+    r->heap_ops = heap_ops() - ops;
+    r->key_schedules = nrf_crypto_mock_key_schedules() - ks;
+}
+
+static void check_vector(void)
+{
+    uint8_t data[sizeof(plain)], m[MIC_LEN];
+    void *ctx;
+
+    /* a context of its own */
+    memcpy(data, plain, sizeof(plain));
+    ctx = mcps_crypto_aead_aes_ccm_star_128_create(key);
+    CHECK(ctx != NULL);
+    CHECK_EQ(mcps_crypto_aead_aes_ccm_star_128_encrypt(ctx, nonce, hdr, sizeof(hdr), data, sizeof(data), m, MIC_LEN),
+             UWBMAC_SUCCESS);
+    mcps_crypto_aead_aes_ccm_star_128_destroy(ctx);
+    CHECK(!memcmp(data, cipher, sizeof(cipher)));
+    CHECK(!memcmp(m, mic, MIC_LEN));
+
+    /* the cached one */
+    ctx = mcps_crypto_ccm_cache_get(KEY_ID, key);
+    CHECK(ctx != NULL);
+    CHECK_EQ(mcps_crypto_aead_aes_ccm_star_128_decrypt(ctx, nonce, hdr, sizeof(hdr), data, sizeof(data), m, MIC_LEN),
+             UWBMAC_SUCCESS);
+    CHECK(!memcmp(data, plain, sizeof(plain)));
+
+    /* a MIC off by a bit: rejected, the data wiped, the context still good */
+    memcpy(data, cipher, sizeof(cipher));
+    memcpy(m, mic, MIC_LEN);
+    m[0] ^= 1;
+    CHECK_EQ(mcps_crypto_aead_aes_ccm_star_128_decrypt(ctx, nonce, hdr, sizeof(hdr), data, sizeof(data), m, MIC_LEN),
+             UWBMAC_EBADMSG);
+    CHECK_EQ(data[0], 0);
+    memcpy(data, cipher, sizeof(cipher));
+    m[0] ^= 1;
+    CHECK_EQ(mcps_crypto_aead_aes_ccm_star_128_decrypt(ctx, nonce, hdr, sizeof(hdr), data, sizeof(data), m, MIC_LEN),
+             UWBMAC_SUCCESS);
+    mcps_crypto_ccm_cache_put(ctx);
+}
+
+static void check_bench(void)
+{
+    run_t per_call, cached;
+    void *ctx;
+
+    for (int i = 0; i < DATA_LEN; i++)
+    {
+        frame[i] = (uint8_t)i;
+    }
+    ctx = mcps_crypto_aead_aes_ccm_star_128_create(key);
+    CHECK_EQ(mcps_crypto_aead_aes_ccm_star_128_encrypt(ctx, nonce, hdr, sizeof(hdr), frame, DATA_LEN, frame_mic,
+                                                       MIC_LEN),
+             UWBMAC_SUCCESS);
+    mcps_crypto_aead_aes_ccm_star_128_destroy(ctx);
+
+    run(false, &per_call);
+    CHECK_EQ(per_call.heap_ops, 2 * FRAMES);
+    CHECK_EQ(per_call.key_schedules, FRAMES);
+
+    /* warm: not a heap operation nor a key schedule per decryption */
+    ctx = mcps_crypto_ccm_cache_get(KEY_ID, key);
+    mcps_crypto_ccm_cache_put(ctx);
+    run(true, &cached);
+    CHECK_EQ(cached.heap_ops, 0);
+    CHECK_EQ(cached.key_schedules, 0);
+
+    printf("ccm_cache: per call %llu cycles, %.0f decrypts/s, %.1f heap ops per decrypt\n",
+           (unsigned long long)per_call.cycles, per_call.per_s, (double)per_call.heap_ops / FRAMES);
+    printf("ccm_cache: cached   %llu cycles, %.0f decrypts/s, %.1f heap ops per decrypt\n",
+           (unsigned long long)cached.cycles, cached.per_s, (double)cached.heap_ops / FRAMES);
+}
+
+static void check_keys(void)
+{
+    static const uint8_t key2[16] = {0x01};
+    uint32_t ops = heap_ops(), ks = nrf_crypto_mock_key_schedules();
+    void *a, *b;
+
+    /* a new key under the ID: the slot re-keyed in place */
+    a = mcps_crypto_ccm_cache_get(KEY_ID, key2);
+    CHECK(a != NULL);
+    mcps_crypto_ccm_cache_put(a);
+    CHECK_EQ(nrf_crypto_mock_key_schedules() - ks, 1);
+
+    /* a second ID in the other slot, then no room for a third */
+    b = mcps_crypto_ccm_cache_get(KEY_ID + 1, key);
+    CHECK(b != NULL && b != a);
+    mcps_crypto_ccm_cache_put(b);
+    CHECK(mcps_crypto_ccm_cache_get(KEY_ID + 2, key) == NULL);
+    CHECK_EQ(nrf_crypto_mock_key_schedules() - ks, 2);
+
+    /* flushed: keyed again on the next use */
+    mcps_crypto_ccm_cache_flush();
+    a = mcps_crypto_ccm_cache_get(KEY_ID, key);
+    CHECK(a != NULL);
+    mcps_crypto_ccm_cache_put(a);
+    CHECK_EQ(nrf_crypto_mock_key_schedules() - ks, 3);
+    CHECK_EQ(heap_ops() - ops, 0);
+}
+
+int main(void)
+{
+    CHECK(mcps_crypto_ccm_cache_get(KEY_ID, key) == NULL);
+    CHECK_EQ(mcps_crypto_ccm_cache_init(), 0);
+
+    check_vector();
+    check_bench();
+    check_keys();
+    mcps_crypto_ccm_cache_flush();
+    return test_done("ccm_cache");
+}
@@ -0,0 +1,182 @@
+/**
+ * @file    test_cpu_prof.c
+ *
+ * @brief   Per-task CPU profile from a mock source: windows filling up,
+ *          the counter wrapping, a change of load, tasks created and
+ *          deleted, source failures
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "test.h"
+#include "cpu_prof.h"
+
+#define MOCK_TASKS_MAX  20
+#define MOCK_FREQ       1000000     /**< counter at 1 MHz */
+#define MOCK_START      0xFFF00000u /**< the counter wraps after about 1 s */
+#define PERIOD_US       (CPU_PROF_PERIOD_MS * 1000)
+
+/* A task of the mock: its share of the counter in 1/100 % and its switches
+ * per second */
+typedef struct
+{
+    uint32_t id;
+    uint32_t share;
+    uint32_t sw_per_s;
+    uint32_t run;
+    uint32_t sw;
+    bool alive;
+    const char *name;
+} mock_task_t;
+
+static mock_task_t mt[MOCK_TASKS_MAX];
+static int n_mt;
+static uint32_t now = MOCK_START;
+static bool src_fail;
+
+static int mock_sample(void *arg, cpu_prof_task_t *t, int max, uint32_t *n)
+{
+    int k = 0;
+
+    (void)arg;
+    if (src_fail)
+    {
+        return -1;
+    }
+    for (int i = 0; i < n_mt; i++)
+    {
+        if (!mt[i].alive)
+        {
+            continue;
+        }
+        if (k == max)
+        {
+            return -1;
+        }
+        t[k].id = mt[i].id;
+        t[k].run = mt[i].run;
+        t[k].switches = mt[i].sw;
+        t[k].stack_free = 100 + i;
+        strncpy(t[k].name, mt[i].name, CPU_PROF_NAME_LEN - 1);
+        t[k].name[CPU_PROF_NAME_LEN - 1] = '\0';
+        k++;
+    }
+    *n = now;
+    return k;
+}
+
+static void mock_add(const char *name, uint32_t share, uint32_t sw_per_s)
+{
+    mt[n_mt] = (mock_task_t){.id = (uint32_t)n_mt + 1, .share = share, .sw_per_s = sw_per_s, .alive = true, .name = name};
+    n_mt++;
+}
+
+/* @brief periods of CPU_PROF_PERIOD_MS, each sampled */
+static void run(cpu_prof_t *p, int periods)
+{
+    for (int k = 0; k < periods; k++)
+    {
+        now += PERIOD_US;
+        for (int i = 0; i < n_mt; i++)
+        {
+            if (mt[i].alive)
+            {
+                mt[i].run += (uint32_t)((uint64_t)PERIOD_US * mt[i].share / 10000);
+                mt[i].sw += (uint32_t)((uint64_t)PERIOD_US * mt[i].sw_per_s / 1000000);
+            }
+        }
+        CHECK_EQ(cpu_prof_sample(p), 0);
+    }
+}
+
+static const cpu_prof_usage_t *find(const cpu_prof_usage_t *u, int n, const char *name)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (!strcmp(u[i].task.name, name))
+        {
+            return &u[i];
+        }
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    static cpu_prof_t p;
+    static const cpu_prof_src_t src = {mock_sample, NULL, MOCK_FREQ};
+    cpu_prof_usage_t u[CPU_PROF_TASKS_MAX];
+    const cpu_prof_usage_t *t;
+    uint32_t span[CPU_PROF_WINDOWS];
+    int n;
+
+    mock_add("IDLE", 9000, 1000);
+    mock_add("McpsTask", 500, 400);
+    mock_add("Report", 500, 200);
+    cpu_prof_init(&p, &src);
+
+    /* no window before 2 samples */
+    CHECK_EQ(cpu_prof_get(&p, u, CPU_PROF_TASKS_MAX, span), 0);
+    CHECK_EQ(span[0], 0);
+    CHECK_EQ(cpu_prof_sample(&p), 0);
+    n = cpu_prof_get(&p, u, CPU_PROF_TASKS_MAX, span);
+    CHECK_EQ(n, 3);
+    CHECK_EQ(span[0], 0);
+    CHECK_EQ(u[0].pct[0], 0);
+    CHECK_EQ(u[2].task.stack_free, 102);
+
+    /* windows short of their length */
+    run(&p, 5);
+    n = cpu_prof_get(&p, u, CPU_PROF_TASKS_MAX, span);
+    CHECK_EQ(span[0], 500000);
+    CHECK_EQ(span[1], 500000);
+    CHECK((t = find(u, n, "IDLE")) && t->pct[0] == 9000);
+    CHECK((t = find(u, n, "McpsTask")) && t->switches[1] == 200);
+
+    /* full windows, across the wrap of the counter */
+    run(&p, 200);
+    n = cpu_prof_get(&p, u, CPU_PROF_TASKS_MAX, span);
+    CHECK_EQ(span[0], 1000000);
+    CHECK(span[1] >= 10000000 && span[1] < 11000000);
+    CHECK((t = find(u, n, "IDLE")) && t->pct[0] == 9000 && t->pct[1] == 9000);
+    CHECK((t = find(u, n, "Report")) && t->switches[0] == 200);
+
+    /* McpsTask at 50% for the last second: all of the short window, about
+     * a tenth of the long one */
+    mt[0].share = 4500;
+    mt[1].share = 5000;
+    run(&p, 10);
+    n = cpu_prof_get(&p, u, CPU_PROF_TASKS_MAX, span);
+    CHECK((t = find(u, n, "McpsTask")) && t->pct[0] == 5000 && t->pct[1] > 900 && t->pct[1] < 1400);
+
+    /* a task created counts from 0, a task deleted is gone */
+    mock_add("DataTask", 300, 50);
+    mt[2].alive = false;
+    mt[0].share = 4700;
+    run(&p, 3);
+    n = cpu_prof_get(&p, u, CPU_PROF_TASKS_MAX, span);
+    CHECK_EQ(n, 3);
+    CHECK(!find(u, n, "Report"));
+    CHECK((t = find(u, n, "DataTask")) && t->pct[0] == 90 && t->switches[0] == 15);
+
+    /* the source fails: nothing reported until it samples again */
+    src_fail = true;
+    CHECK_EQ(cpu_prof_sample(&p), -1);
+    CHECK_EQ(cpu_prof_get(&p, u, CPU_PROF_TASKS_MAX, span), 0);
+    src_fail = false;
+    run(&p, 1);
+    CHECK_EQ(cpu_prof_get(&p, u, CPU_PROF_TASKS_MAX, span), 3);
+
+    /* more tasks than a sample holds */
+    while (n_mt < MOCK_TASKS_MAX)
+    {
+        mock_add("X", 0, 0);
+    }
+    CHECK_EQ(cpu_prof_sample(&p), -1);
+
+    return test_done("cpu_prof");
+}
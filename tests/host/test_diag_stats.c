@@ -0,0 +1,150 @@
+/**
+ * @file    test_diag_stats.c
+ *
+ * @brief   calculateStats() in fixed point against the float formulas of the
+ *          DW3000 User Manual 4.7, on diagnostic register tuples
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <math.h>
+
+#include "test.h"
+#include "dw3000_statistics.h"
+
+#define RSSI_TOL_MDB    10      /**< 0.01 dB */
+#define NLOS_TOL_PCT    1
+
+/* One reception: IPATOV, STS1, STS2 as {accum, F1, F2, F3, power}, the
+ * IPATOV first and peak path indexes, the DGC decision and the config bits.
+ * The amplitudes put the signal level difference of each case on a side of
+ * the 4.8 and 12 dB thresholds, the indexes on a side of 3.3 and 6. */
+typedef struct
+{
+    const char *what;
+    uint32_t cir[3][5];
+    uint32_t index_fp, index_pp;
+    uint8_t dgc, prf64, dw3000, sts_on, pdoa_m3;
+} tuple_t;
+
+static const tuple_t tuples[] = {
+    {"LOS 1 m", {{64, 76557, 65074, 53590, 9800}, {0}, {0}}, 0x2F00, 0x2F40, 0, 1, 0, 0, 0},
+    {"LOS 10 m", {{63, 17023, 14470, 11916, 610}, {0}, {0}}, 0x2F10, 0x2F60, 2, 1, 0, 0, 0},
+    {"LOS far, DGC", {{60, 4315, 3668, 3020, 45}, {0}, {0}}, 0x2F20, 0x2F80, 5, 1, 0, 0, 0},
+    {"LOS, DW3000 C0", {{64, 182375, 155019, 127663, 3900}, {0}, {0}}, 0x2F00, 0x2F30, 1, 1, 1, 0, 0},
+    {"LOS, PRF16", {{64, 45594, 38755, 31916, 3900}, {0}, {0}}, 0x2F00, 0x2F30, 1, 0, 0, 0, 0},
+    {"through wall", {{62, 12134, 10313, 8493, 980}, {0}, {0}}, 0x2E80, 0x2F40, 3, 1, 0, 0, 0},
+    {"body blocked", {{64, 4837, 4111, 3386, 620}, {0}, {0}}, 0x2E00, 0x2F80, 4, 1, 0, 0, 0},
+    {"late first path", {{64, 12589, 10701, 8812, 420}, {0}, {0}}, 0x2F00, 0x2F00 + 150, 2, 1, 0, 0, 0},
+    {"late peak", {{64, 12589, 10701, 8812, 420}, {0}, {0}}, 0x2F00, 0x2F00 + 260, 2, 1, 0, 0, 0},
+    {"STS1 NLOS", {{63, 17023, 14470, 11916, 610}, {64, 9892, 8408, 6924, 820}, {0}}, 0x2F10, 0x2F40, 2, 1, 0, 1, 0},
+    {"STS2 NLOS, PDOA M3", {{63, 17023, 14470, 11916, 610}, {64, 17023, 14470, 11916, 610}, {64, 5767, 4902, 4037, 700}},
+     0x2F10, 0x2F40, 2, 1, 0, 1, 1},
+    {"STS2 ignored, PDOA M1", {{63, 17023, 14470, 11916, 610}, {64, 17023, 14470, 11916, 610}, {64, 2921, 2483, 2045, 900}},
+     0x2F10, 0x2F40, 2, 1, 0, 1, 0},
+};
+
+/* @brief the float levels of one CIR, without the alpha and DGC terms */
+static void ref_levels(const uint32_t c[5], double log_constant, double *rsl, double *fsl)
+{
+    double n = (double)c[0] * c[0];
+    double f1 = c[1] / 4, f2 = c[2] / 4, f3 = c[3] / 4;
+
+    *rsl = 10 * log10((double)c[4] / n) + log_constant;
+    *fsl = 10 * log10((f1 * f1 + f2 * f2 + f3 * f3) / n);
+}
+
+/* @brief the float calculateStats() the fixed point one replaces */
+static void ref_stats(const tuple_t *t, double *rssi, double *nlos)
+{
+    double log_constant = t->dw3000 ? 63.2 : 51.175;
+    double ip_alpha = t->prf64 ? -(120.7 + 1) : -113.8;
+    double rsl[3], fsl[3], d[3], sl;
+
+    for (int i = 0; i < 3; i++)
+    {
+        ref_levels(t->cir[i], log_constant, &rsl[i], &fsl[i]);
+        d[i] = rsl[i] - fsl[i];
+    }
+    d[1] = t->sts_on ? d[1] : 0;
+    d[2] = (t->sts_on && t->pdoa_m3) ? d[2] : 0;
+
+    if (d[0] > 12 || d[1] > 12 || d[2] > 12)
+    {
+        *nlos = 100;
+    }
+    else if (d[0] > 4.8 || d[1] > 4.8 || d[2] > 4.8)
+    {
+        sl = (d[0] > 4.8) ? d[0] : (d[1] > 4.8) ? d[1] : d[2];
+        *nlos = 100 * ((sl / 12 - 0.4) / (1 - 0.4));
+    }
+    else
+    {
+        double index_diff = ((double)t->index_pp - (double)t->index_fp) / 32;
+
+        *nlos = (index_diff <= 3.3) ? 0 : (index_diff < 6.0) ? 100 * (0.39178 * index_diff - 1.31719) : 100;
+    }
+    *nlos = fabs(*nlos);
+    *rssi = rsl[0] + ip_alpha + t->dgc * 6;
+}
+
+static void latch(struct mcps_diag_s *diag, const tuple_t *t)
+{
+    struct mcps_diag_raw_s *raw = &diag->raw;
+
+    for (int i = 0; i < 3; i++)
+    {
+        raw->cir[i].accum_count = t->cir[i][0];
+        raw->cir[i].f[0] = t->cir[i][1];
+        raw->cir[i].f[1] = t->cir[i][2];
+        raw->cir[i].f[2] = t->cir[i][3];
+        raw->cir[i].cir_power = t->cir[i][4];
+    }
+    raw->index_fp = t->index_fp;
+    raw->index_pp = t->index_pp;
+    raw->dgc_decision = t->dgc;
+    raw->prf64 = t->prf64;
+    raw->dw3000 = t->dw3000;
+    raw->sts_on = t->sts_on;
+    raw->pdoa_m3 = t->pdoa_m3;
+    diag->pending = true;
+}
+
+int main(void)
+{
+    struct mcps_diag_s diag = {0};
+    int classes[3] = {0};   /* LOS, probable, NLOS */
+
+    for (size_t i = 0; i < sizeof(tuples) / sizeof(tuples[0]); i++)
+    {
+        const tuple_t *t = &tuples[i];
+        double rssi, nlos;
+        int32_t want_mdbm;
+
+        ref_stats(t, &rssi, &nlos);
+        want_mdbm = (int32_t)lround(rssi * 1000);
+
+        latch(&diag, t);
+        calculateStats(&diag);
+        CHECK(!diag.pending);
+        if (abs(diag.rssi_mdbm - want_mdbm) > RSSI_TOL_MDB || fabs(diag.nlos_pct - nlos) > NLOS_TOL_PCT)
+        {
+            fprintf(stderr, "%s: %d mdBm %d%%, float %d mdBm %.1f%%\n", t->what, (int)diag.rssi_mdbm,
+                    diag.nlos_pct, (int)want_mdbm, nlos);
+        }
+        CHECK(abs(diag.rssi_mdbm - want_mdbm) <= RSSI_TOL_MDB);
+        CHECK(fabs(diag.nlos_pct - nlos) <= NLOS_TOL_PCT);
+        classes[(diag.nlos_pct == 0) ? 0 : (diag.nlos_pct == 100) ? 2 : 1]++;
+    }
+    /* the tuples cover the three branches */
+    CHECK(classes[0] > 0 && classes[1] > 0 && classes[2] > 0);
+
+    /* computed once per latched frame */
+    diag.raw.cir[0].cir_power *= 4;
+    diag.rssi_mdbm = 1;
+    calculateStats(&diag);
+    CHECK_EQ(diag.rssi_mdbm, 1);
+
+    return test_done("diag_stats");
+}
@@ -0,0 +1,337 @@
+/**
+ * @file    test_dlog.c
+ *
+ * @brief   dlog.c with bin_report.c: the line of a DLOG site printed at once
+ *          and the same line expanded from its deferred frame, as
+ *          tools/bin_report_decode.py does; levels and modules; the cycles
+ *          a deferred site saves
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "test.h"
+#include "dlog.h"
+#include "bin_report.h"
+#include "crc16.h"
+#include "debug_config.h"
+#include "reporter.h"
+
+#define OUT_MAX         512
+#define BENCH_N         20000
+
+static debug_config_t dbg;
+static char out[OUT_MAX];
+static int out_len;
+static int frames;
+
+/* the format strings and %s arguments of the frames: in the image, as the
+ * decoder finds them by their address */
+static const char DLOG_SECTION probe[] = "";
+static const char name[] = "RESP";
+static char long_str[300];
+
+debug_config_t *get_debug_config(void)
+{
+    return &dbg;
+}
+
+static error_e report_print(char *buff, int len)
+{
+    if (out_len + len <= OUT_MAX)
+    {
+        memcpy(&out[out_len], buff, len);
+        out_len += len;
+    }
+    return _NO_ERR;
+}
+
+static uint8_t *report_reserve(int len)
+{
+    return (out_len + len <= OUT_MAX) ? (uint8_t *)&out[out_len] : NULL;
+}
+
+static void report_commit(uint8_t *area, int len)
+{
+    (void)area;
+    out_len += len;
+}
+
+reporter_t reporter_instance = {.print = report_print};
+
+/* @brief the pointer of a 32-bit address: the upper half of the image's */
+static const char *resolve(uint32_t addr, const char *want)
+{
+    uintptr_t base = (uintptr_t)probe & ~(uintptr_t)0xFFFFFFFFu;
+
+    for (int k = -1; k <= 1; k++)
+    {
+        const char *p = (const char *)(base + (uintptr_t)((int64_t)k * 0x100000000LL) + addr);
+
+        if ((uintptr_t)p >= (uintptr_t)probe - 0x10000000 && (uintptr_t)p <= (uintptr_t)probe + 0x10000000 &&
+            (!want || p == want))
+        {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* @brief fmt expanded with 32-bit arguments, as format_log() of
+ *        bin_report_decode.py */
+static int expand(char *dst, int max, const char *fmt, const uint32_t *args, int n_args,
+                  const char *const *strs)
+{
+    int len = 0, a = 0, s = 0;
+
+    while (*fmt && len < max - 1)
+    {
+        char spec[16];
+        int k = 0;
+        char conv;
+        uint32_t v;
+
+        if (*fmt != '%')
+        {
+            dst[len++] = *fmt++;
+            continue;
+        }
+        spec[k++] = *fmt++;
+        while (strchr("-+ #0123456789.", *fmt) && k < 12)
+        {
+            spec[k++] = *fmt++;
+        }
+        while (strchr("hlzjt", *fmt))
+        {
+            fmt++;  /**< length modifiers dropped */
+        }
+        conv = *fmt++;
+        if (conv == '%')
+        {
+            dst[len++] = '%';
+            continue;
+        }
+        v = (a < n_args) ? args[a++] : 0;
+        spec[k++] = (conv == 'i') ? 'd' : conv;
+        spec[k] = '\0';
+        switch (conv)
+        {
+        case 'd':
+        case 'i':
+            len += snprintf(&dst[len], max - len, spec, (int32_t)v);
+            break;
+        case 'c':
+            len += snprintf(&dst[len], max - len, spec, v & 0xFF);
+            break;
+        case 's':
+            len += snprintf(&dst[len], max - len, spec, resolve(v, strs[s++]));
+            break;
+        default:
+            len += snprintf(&dst[len], max - len, spec, v);
+            break;
+        }
+    }
+    dst[len] = '\0';
+    return len;
+}
+
+/* @brief the deferred frame in out: sealed, of mod/lvl, the line of fmt
+ *        with its arguments equal to ref */
+static void check_frame(int line, dlog_module_e mod, dlog_level_e lvl, const char *fmt, int n_args,
+                        const char *ref, const char *const *strs)
+{
+    const uint8_t *f = (const uint8_t *)out;
+    uint32_t args[DLOG_ARGS_MAX];
+    uint32_t fmt_id;
+    uint16_t len;
+    char text[OUT_MAX];
+
+    if (out_len < BIN_REPORT_HDR_LEN + BIN_REPORT_LOG_HDR_LEN + BIN_REPORT_CRC_LEN)
+    {
+        printf("%s:%d: no frame\n", __FILE__, line);
+        CHECK(false);
+        return;
+    }
+    len = (uint16_t)(f[3] | (f[4] << 8));
+    CHECK_EQ(f[0], BIN_REPORT_SYNC0);
+    CHECK_EQ(f[1], BIN_REPORT_SYNC1);
+    CHECK_EQ(f[2], BIN_REPORT_TYPE_LOG);
+    CHECK_EQ(len, BIN_REPORT_LOG_HDR_LEN + 4 * n_args);
+    CHECK_EQ(out_len, BIN_REPORT_HDR_LEN + len + BIN_REPORT_CRC_LEN);
+    CHECK_EQ(calc_crc16((uint8_t *)&f[2], (uint16_t)(BIN_REPORT_HDR_LEN - 2 + len)),
+             f[BIN_REPORT_HDR_LEN + len] | (f[BIN_REPORT_HDR_LEN + len + 1] << 8));
+
+    memcpy(&fmt_id, &f[BIN_REPORT_HDR_LEN], 4);
+    CHECK_EQ(f[BIN_REPORT_HDR_LEN + 4], mod);
+    CHECK_EQ(f[BIN_REPORT_HDR_LEN + 5], lvl);
+    memcpy(args, &f[BIN_REPORT_HDR_LEN + BIN_REPORT_LOG_HDR_LEN], 4 * n_args);
+
+    /* the format by its address, then the line */
+    const char *img_fmt = resolve(fmt_id, NULL);
+    CHECK(img_fmt && !strcmp(img_fmt, fmt));
+    if (img_fmt)
+    {
+        expand(text, sizeof(text), img_fmt, args, n_args, strs);
+        if (strcmp(text, ref))
+        {
+            printf("%s:%d: deferred \"%s\" != \"%s\"\n", __FILE__, line, text, ref);
+            CHECK(false);
+        }
+    }
+    frames++;
+}
+
+static void check_line(int line, const char *ref)
+{
+    int n = (int)strlen(ref);
+
+    if (n > DLOG_LINE_MAX - 1)
+    {
+        n = DLOG_LINE_MAX - 1;  /**< cut as dlog_printf() does */
+    }
+    if (out_len != n || memcmp(out, ref, n))
+    {
+        printf("%s:%d: \"%.*s\" != \"%.*s\"\n", __FILE__, line, out_len, out, n, ref);
+        CHECK(false);
+    }
+}
+
+/* A site printed at once, then deferred through print() and through
+ * reserve()/commit(): the same line each time */
+#define ROUND_TRIP(strs, fmt, ...)                                                                  \
+    do                                                                                              \
+    {                                                                                               \
+        char ref_[OUT_MAX];                                                                         \
+        const uint32_t n_[] = {0 DLOG_MAP(DLOG_U32, ##__VA_ARGS__)};                                \
+                                                                                                    \
+        snprintf(ref_, sizeof(ref_), fmt, ##__VA_ARGS__);                                           \
+        dbg.binReportEn = 0;                                                                        \
+        out_len = 0;                                                                                \
+        DLOG_WARN(DLOG_MOD_SERVO, fmt, ##__VA_ARGS__);                                              \
+        check_line(__LINE__, ref_);                                                                 \
+        dbg.binReportEn = 1;                                                                        \
+        for (int r_ = 0; r_ < 2; r_++)                                                              \
+        {                                                                                           \
+            reporter_instance.reserve = r_ ? report_reserve : NULL;                                 \
+            reporter_instance.commit = r_ ? report_commit : NULL;                                   \
+            out_len = 0;                                                                            \
+            DLOG_WARN(DLOG_MOD_SERVO, fmt, ##__VA_ARGS__);                                          \
+            check_frame(__LINE__, DLOG_MOD_SERVO, DLOG_LVL_WARN, fmt, (int)(sizeof(n_) / 4) - 1,    \
+                        ref_, strs);                                                                \
+        }                                                                                           \
+        reporter_instance.reserve = NULL;                                                           \
+        reporter_instance.commit = NULL;                                                            \
+        dbg.binReportEn = 0;                                                                        \
+    } while (0)
+
+static void check_round_trip(void)
+{
+    static const char *const no_str[] = {NULL};
+    static const char *const one_str[] = {name};
+    static const char *const long_strs[] = {long_str};
+    int8_t neg8 = -7;
+    int16_t neg16 = -1234;
+    long neg = -100000L;
+    unsigned long big = 4000000000UL;
+
+    ROUND_TRIP(no_str, "no argument\r\n");
+    ROUND_TRIP(no_str, "%%d is not an argument, 100%%\r\n");
+    ROUND_TRIP(no_str, "%d %i %u\r\n", -1, 2147483647, 4294967295u);
+    ROUND_TRIP(no_str, "%ld %lu %d %d\r\n", neg, big, neg8, neg16);
+    ROUND_TRIP(no_str, "0x%04x 0x%08X %x %o\r\n", 0xCAu, 0xDEADBEEFu, 0u, 8u);
+    ROUND_TRIP(no_str, "[%5d|%-5d|%05u|%+d]\r\n", 42, 42, 42u, 42);
+    ROUND_TRIP(no_str, "%c%c%c\r\n", 'O', 'K', '!');
+    ROUND_TRIP(one_str, "%s: SP1 counter=%lu accepted, len=%d\r\n", name, 123456UL, 12);
+    ROUND_TRIP(no_str, "%u %u %u %u %u %u %u %u\r\n", 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u);
+    ROUND_TRIP(no_str, "[%02X %02X %02X %02X %02X %02X %02X] (first 7 bytes)\r\n", 0xA5, 0x5A, 0x00, 0xFF, 0x10, 0x01,
+               0x7F);
+
+    /* a line past DLOG_LINE_MAX is cut when printed at once, whole when
+     * deferred */
+    memset(long_str, 'x', sizeof(long_str) - 1);
+    ROUND_TRIP(long_strs, "%s\r\n", long_str);
+}
+
+static void check_levels(void)
+{
+    int evals = 0;
+    char str[OUT_MAX];
+
+    /* under the level of the module: nothing, the arguments not evaluated */
+    out_len = 0;
+    DLOG_DBG(DLOG_MOD_FIRA, "%d\r\n", ++evals);
+    CHECK_EQ(out_len, 0);
+    CHECK_EQ(evals, 0);
+    DLOG_INFO(DLOG_MOD_FIRA, "%d\r\n", ++evals);
+    CHECK_EQ(evals, 1);
+    check_line(__LINE__, "1\r\n");
+
+    dlog_set_level(DLOG_MOD_FIRA, DLOG_LVL_DBG);
+    out_len = 0;
+    DLOG_DBG(DLOG_MOD_FIRA, "%d\r\n", ++evals);
+    check_line(__LINE__, "2\r\n");
+    out_len = 0;
+    DLOG_DBG(DLOG_MOD_BTN, "%d\r\n", ++evals);
+    CHECK_EQ(out_len, 0);
+
+    dlog_set_level(DLOG_MOD_COUNT, DLOG_LVL_OFF);
+    out_len = 0;
+    DLOG_ERR(DLOG_MOD_MON, "%d\r\n", ++evals);
+    CHECK_EQ(out_len, 0);
+    CHECK_EQ(evals, 2);
+
+    CHECK_EQ(dlog_module_by_name("SERVO"), DLOG_MOD_SERVO);
+    CHECK_EQ(dlog_module_by_name("FIRA"), DLOG_MOD_FIRA);
+    CHECK_EQ(dlog_module_by_name("servo"), DLOG_MOD_COUNT);
+    dlog_set_level(dlog_module_by_name("RESP"), DLOG_LVL_WARN);
+    out_len = 0;
+    dlog_report_levels();
+    snprintf(str, sizeof(str), "FIRA=0 BTN=0 RESP=2 SERVO=0 MON=0 (max %u)\r\n", DLOG_LEVEL_MAX);
+    check_line(__LINE__, str);
+    dlog_set_level(DLOG_MOD_COUNT, DLOG_LEVEL_DEFAULT);
+}
+
+/* @brief cycles of a ranging path site, printed at once or deferred */
+static uint64_t bench(bool deferred)
+{
+    uint64_t t0;
+
+    dbg.binReportEn = deferred;
+    reporter_instance.reserve = deferred ? report_reserve : NULL;
+    reporter_instance.commit = deferred ? report_commit : NULL;
+    t0 = test_cycles();
+    for (uint32_t b = 0; b < BENCH_N; b++)
+    {
+        out_len = 0;
+        DLOG_INFO(DLOG_MOD_FIRA, "%s: Block %lu measurements=%d stopped_reason=%u diag_rssi_ddbm=%d diag_nlos=%d%%\r\n",
+                  name, (unsigned long)b, 8, 0xFFu, -853, 12);
+    }
+    t0 = test_cycles() - t0;
+    reporter_instance.reserve = NULL;
+    reporter_instance.commit = NULL;
+    dbg.binReportEn = 0;
+    return t0 / BENCH_N;
+}
+
+int main(void)
+{
+    uint64_t now, deferred;
+
+    CHECK_EQ(dlog_level[DLOG_MOD_FIRA], DLOG_LEVEL_DEFAULT);
+    CHECK(!dlog_is_deferred());
+
+    check_round_trip();
+    CHECK_EQ(frames, 22);
+    check_levels();
+
+    now = bench(false);
+    deferred = bench(true);
+    printf("dlog: %llu cycles printed at once, %llu deferred, %llu saved per line\n", (unsigned long long)now,
+           (unsigned long long)deferred, (unsigned long long)(now - deferred));
+    CHECK(deferred < now);
+
+    return test_done("dlog");
+}
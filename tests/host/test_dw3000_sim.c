@@ -0,0 +1,170 @@
+/**
+ * @file    test_dw3000_sim.c
+ *
+ * @brief   The DW3000 model on its own, through dwt_ops/dwt_mcps_ops: the
+ *          callbacks of scripted frames, the result registers, the receiver
+ *          window and timeout, delayed TX
+ *
+ * @author  Development Team
+ *
+ */
+
+#include "test.h"
+#include "dw3000_sim.h"
+#include "deca_device_api.h"
+
+#define FRAME_LEN       12
+#define RX_AT_DTU       1000
+#define MISSED_AT_DTU   20000       /**< receiver off */
+#define TX_AT_DTU       40000
+#define LATE_AT_DTU     50000       /**< after the RX timeout of the response */
+#define ERROR_AT_DTU    60000
+#define RX_DLY          10          /**< response RX after the TX, 1.0256 us */
+#define RX_TIMEOUT_PAC  2
+
+static struct dwchip_s chip;
+static uint8_t frame[FRAME_LEN] = {0x41, 0x88, 0x07};
+static dw3000_sim_frame_t ev = {
+    .type = DW3000_SIM_RX_OK,
+    .data = frame,
+    .len = FRAME_LEN,
+    .cfo = -1234,
+    .pdoa = -3000,
+    .sts_qual = -100,
+    .dgc = 5,
+    .index_fp = 0x4C40,
+    .fp_ampl = 0x123456,
+    .cir_power = 0x1ABCD,
+    .accum = 64,
+};
+
+static int n_ok, n_to, n_err, n_tx;
+static uint16_t rx_len;
+static uint64_t rx_ts;
+
+/* @brief the result registers of ev, through the driver accessors */
+static void rx_ok(const dwt_cb_data_t *d)
+{
+    const struct dwt_ops_s *ops = d->dw->dwt_driver->dwt_ops;
+    dwt_nlos_alldiag_t all = {.diag_type = STS2};
+    dwt_nlos_ipdiag_t ip = {0};
+    uint8_t buf[FRAME_LEN] = {0};
+    struct dwt_rw_data_s rd = {buf, d->datalength, 0};
+    int16_t v;
+    uint8_t dgc;
+
+    n_ok++;
+    rx_len = d->datalength;
+    rx_ts = d->dw->dwt_driver->dwt_mcps_ops->get_timestamp(d->dw);
+
+    ops->ioctl(d->dw, DWT_READCLOCKOFFSET, 0, &v);
+    CHECK_EQ(v, ev.cfo);
+    ops->ioctl(d->dw, DWT_READPDOA, 0, &v);
+    CHECK_EQ(v, ev.pdoa);
+    ops->ioctl(d->dw, DWT_READSTSQUALITY, 0, &v);
+    CHECK_EQ(v, ev.sts_qual);
+    ops->ioctl(d->dw, DWT_GETDGCDECISION, 0, &dgc);
+    CHECK_EQ(dgc, ev.dgc);
+    ops->ioctl(d->dw, DWT_NLOS_ALLDIAG, 0, &all);
+    CHECK_EQ(all.F2, ev.fp_ampl);
+    CHECK_EQ(all.accumCount, ev.accum);
+    CHECK_EQ(all.cir_power, ev.cir_power);
+    CHECK_EQ(all.D, ev.dgc);
+    ops->ioctl(d->dw, DWT_NLOS_IPDIAG, 0, &ip);
+    CHECK_EQ(ip.index_fp_u32, ev.index_fp);
+    CHECK_EQ(ip.index_pp_u32, ev.index_fp);
+    ops->ioctl(d->dw, DWT_READRXDATA, 0, &rd);
+    CHECK_EQ(buf[0], frame[0]);
+    CHECK_EQ(buf[2], frame[2]);
+}
+
+static void rx_to(const dwt_cb_data_t *d)
+{
+    (void)d;
+    n_to++;
+}
+
+static void rx_err(const dwt_cb_data_t *d)
+{
+    (void)d;
+    n_err++;
+}
+
+static void tx_done(const dwt_cb_data_t *d)
+{
+    (void)d;
+    n_tx++;
+}
+
+int main(void)
+{
+    const struct dwt_mcps_ops_s *mcps;
+    struct dw_rx_frame_info_s rx_info = {0};
+    struct dw_tx_frame_info_s tx_info = {
+        .tx_date_dtu = TX_AT_DTU,
+        .rx_delay_dly = RX_DLY,
+        .rx_timeout_pac = RX_TIMEOUT_PAC,
+        .flag = DWT_START_TX_DELAYED | DWT_RESPONSE_EXPECTED,
+    };
+    dw3000_sim_frame_t script[4];
+    const uint8_t *sent;
+    dw3000_sim_stats_t st;
+    uint16_t len;
+
+    CHECK(dw3000_sim_attach(&chip) >= 0);
+    mcps = chip.dwt_driver->dwt_mcps_ops;
+    chip.callbacks.cbRxOk = rx_ok;
+    chip.callbacks.cbRxTo = rx_to;
+    chip.callbacks.cbRxErr = rx_err;
+    chip.callbacks.cbTxDone = tx_done;
+
+    for (int i = 0; i < 4; i++)
+    {
+        script[i] = ev;
+    }
+    script[0].at_dtu = RX_AT_DTU;
+    script[1].at_dtu = MISSED_AT_DTU;
+    script[2].at_dtu = LATE_AT_DTU;
+    script[3].at_dtu = ERROR_AT_DTU;
+    script[3].type = DW3000_SIM_RX_ERROR;
+    CHECK_EQ(dw3000_sim_script(&chip, script, 4), 4);
+
+    /* a frame while the receiver is on, its timestamp to the DTU */
+    mcps->rx_enable(&chip, &rx_info);
+    CHECK_EQ(dw3000_sim_advance(&chip, 10000), 1);
+    CHECK_EQ(n_ok, 1);
+    CHECK_EQ(rx_len, FRAME_LEN);
+    CHECK_EQ(rx_ts, (uint64_t)RX_AT_DTU * DW3000_SIM_RCTU_PER_DTU);
+
+    /* the receiver off after a frame: the next one is missed */
+    dw3000_sim_advance(&chip, 15000);
+    CHECK_EQ(n_ok, 1);
+
+    /* a delayed TX, the response window times out before the late frame */
+    CHECK_EQ(mcps->tx_frame(&chip, frame, FRAME_LEN, &tx_info), 0);
+    dw3000_sim_advance(&chip, 30000);
+    sent = dw3000_sim_last_tx(&chip, &len);
+    CHECK(sent != NULL);
+    CHECK_EQ(len, FRAME_LEN);
+    CHECK_EQ(n_tx, 1);
+    CHECK_EQ(n_to, 1);
+    CHECK_EQ(n_ok, 1);
+
+    /* an error frame with the receiver on */
+    rx_info.rx_delayed = 0;
+    mcps->rx_enable(&chip, &rx_info);
+    dw3000_sim_advance(&chip, 10000);
+    CHECK_EQ(n_err, 1);
+
+    dw3000_sim_get_stats(&chip, &st);
+    CHECK_EQ(st.tx, 1);
+    CHECK_EQ(st.rx_ok, 1);
+    CHECK_EQ(st.rx_err, 1);
+    CHECK_EQ(st.rx_to, 1);
+    CHECK_EQ(st.rx_missed, 2);
+    CHECK(st.xfers > 0);
+    CHECK_EQ(dw3000_sim_now(&chip), 65000);
+
+    dw3000_sim_detach(&chip);
+    return test_done("dw3000_sim");
+}
@@ -0,0 +1,237 @@
+/**
+ * @file    test_fh_schedule.c
+ *
+ * @brief   fh_schedule.c: the hops of a key, in any access order, staged to
+ *          the deep sleep wake-up that reconfigures the chip
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <string.h>
+
+#include "test.h"
+#include "host_rtos.h"
+#include "host_uwb.h"
+#include "fh_schedule.h"
+#include "linux/skbuff.h"
+#include "net/mcps802154.h"
+
+#define SESSION_ID  0x12345678UL
+#define BLOCKS      1024
+#define FRAME_LEN   20
+
+static const uint8_t key[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+static const uint8_t vupper64[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+/* AES-128(key, {SESSION_ID, vupper64, counter} LE), counters 0 and 1, from
+ * OpenSSL: one byte per block */
+static const uint8_t keystream[2 * FH_SCHEDULE_AHEAD] = {
+    0x47, 0xaa, 0x48, 0x0c, 0xf4, 0x1e, 0x82, 0x09, 0x72, 0x01, 0xa8, 0xd3, 0xfa, 0xab, 0x20, 0x86,
+    0x75, 0x93, 0x25, 0xc7, 0x02, 0x8c, 0x94, 0x67, 0x2c, 0x89, 0xe7, 0x9c, 0x52, 0xfc, 0xc1, 0xac,
+};
+
+static dwt_config_t phy = {
+    .chan = 9,
+    .txPreambLength = DWT_PLEN_64,
+    .rxPAC = DWT_PAC8,
+    .txCode = 9,
+    .rxCode = 9,
+    .sfdType = DWT_SFD_IEEE_4Z,
+    .dataRate = DWT_BR_6M8,
+    .phrMode = DWT_PHRMODE_STD,
+    .phrRate = DWT_PHRRATE_STD,
+    .sfdTO = (64 + 1 + 8 - 8),
+    .stsMode = DWT_STS_MODE_OFF,
+    .stsLength = DWT_STS_LEN_64,
+    .pdoaMode = DWT_PDOA_M1,
+};
+static dwt_txconfig_t tx_phy;
+static rxtx_configure_t rxtx = {.pdwCfg = &phy, .txConfig = &tx_phy};
+static dwt_mcps_config_t conf = {.rxtx_config = &rxtx};
+
+static fh_hop_t ref[BLOCKS];
+
+static bool hop_eq(const fh_hop_t *a, const fh_hop_t *b)
+{
+    return a->chan == b->chan && a->pcode == b->pcode;
+}
+
+/* @brief the hops of the first two AES blocks, and channels and codes of
+ *        the PRF only, evenly used */
+static void check_keystream(void)
+{
+    static const uint8_t codes[] = {9, 10, 11, 12};
+    uint32_t chans[2] = {0}, use[4] = {0};
+    fh_hop_t hop;
+
+    CHECK_EQ(fh_schedule_init(key, SESSION_ID, vupper64, 9, 9), 0);
+    for (uint32_t b = 0; b < BLOCKS; b++)
+    {
+        CHECK(fh_schedule_hop(b, &ref[b]));
+        CHECK(ref[b].chan == 5 || ref[b].chan == 9);
+        CHECK(ref[b].pcode >= 9 && ref[b].pcode <= 12);
+        chans[ref[b].chan == 9]++;
+        use[(ref[b].pcode - 9) & 3]++;
+    }
+    for (int b = 0; b < 2 * FH_SCHEDULE_AHEAD; b++)
+    {
+        CHECK_EQ(ref[b].chan, (keystream[b] & 1) ? 9 : 5);
+        CHECK_EQ(ref[b].pcode, codes[(keystream[b] >> 1) & 3]);
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        CHECK(chans[i] > BLOCKS * 2 / 5 && chans[i] < BLOCKS * 3 / 5);
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(use[i] > BLOCKS / 5 && use[i] < BLOCKS * 3 / 10);
+    }
+
+    /* PRF 16M: codes 3 and 4 */
+    CHECK_EQ(fh_schedule_init(key, SESSION_ID, vupper64, 5, 3), 0);
+    for (uint32_t b = 0; b < BLOCKS; b++)
+    {
+        CHECK(fh_schedule_hop(b, &hop));
+        CHECK_EQ(hop.chan, ref[b].chan);
+        CHECK(hop.pcode == 3 || hop.pcode == 4);
+    }
+    fh_schedule_deinit();
+    CHECK(!fh_schedule_hop(0, &hop));
+}
+
+/* @brief a peer that joins late, jumps or goes back gets the same hops;
+ *        another key or session does not */
+static void check_peers(void)
+{
+    static const uint32_t order[] = {500, 501, 499, 3, 1023, 16, 15, 17, 700, 0, 64, 63, 32 + 16, 900, 899, 1};
+    uint8_t other[16];
+    int same = 0;
+    fh_hop_t hop;
+
+    CHECK_EQ(fh_schedule_init(key, SESSION_ID, vupper64, 9, 9), 0);
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+    {
+        CHECK(fh_schedule_hop(order[i], &hop));
+        CHECK(hop_eq(&hop, &ref[order[i]]));
+    }
+    for (int b = BLOCKS - 1; b >= 0; b -= 7)
+    {
+        CHECK(fh_schedule_hop((uint32_t)b, &hop));
+        CHECK(hop_eq(&hop, &ref[b]));
+    }
+
+    memcpy(other, key, sizeof(other));
+    other[15] ^= 1;
+    CHECK_EQ(fh_schedule_init(other, SESSION_ID, vupper64, 9, 9), 0);
+    for (uint32_t b = 0; b < BLOCKS; b++)
+    {
+        fh_schedule_hop(b, &hop);
+        same += hop_eq(&hop, &ref[b]);
+    }
+    /* 1 in 8 by chance */
+    CHECK(same < BLOCKS / 4);
+
+    same = 0;
+    CHECK_EQ(fh_schedule_init(key, SESSION_ID + 1, vupper64, 9, 9), 0);
+    for (uint32_t b = 0; b < BLOCKS; b++)
+    {
+        fh_schedule_hop(b, &hop);
+        same += hop_eq(&hop, &ref[b]);
+    }
+    CHECK(same < BLOCKS / 4);
+    fh_schedule_deinit();
+}
+
+/* @brief only changes are staged, the last one staged wins */
+static void check_stage(void)
+{
+    fh_schedule_stats_t st;
+    fh_hop_t hop, taken;
+    uint32_t b = 1, c;
+
+    CHECK_EQ(fh_schedule_init(key, SESSION_ID, vupper64, ref[0].chan, ref[0].pcode), 0);
+    CHECK(!fh_schedule_stage(0, &hop));
+    CHECK(!fh_schedule_take(&taken));
+
+    while (hop_eq(&ref[b], &ref[0]))
+    {
+        b++;
+    }
+    CHECK(fh_schedule_stage(b, &hop));
+    CHECK(hop_eq(&hop, &ref[b]));
+    CHECK(!fh_schedule_stage(b, &hop));
+
+    for (c = b + 1; hop_eq(&ref[c], &ref[b]); c++)
+    {
+    }
+    CHECK(fh_schedule_stage(c, &hop));
+    fh_schedule_get_stats(&st);
+    CHECK_EQ(st.staged, 2);
+    CHECK_EQ(st.dropped, 1);
+
+    CHECK(fh_schedule_take(&taken));
+    CHECK(hop_eq(&taken, &ref[c]));
+    CHECK(!fh_schedule_take(&taken));
+    fh_schedule_deinit();
+}
+
+/* @brief a hop staged before a deep sleep TX is on the chip when it sends */
+static void check_wake_up(void)
+{
+    struct mcps802154_tx_frame_config tx_cfg = {.flags = MCPS802154_TX_FRAME_CONFIG_TIMESTAMP_DTU};
+    static const uint8_t frame[FRAME_LEN] = {0x41, 0x88};
+    fh_schedule_stats_t st;
+    struct dwchip_s *dw;
+    struct sk_buff *tx;
+    uint32_t now = 0, b = 1;
+    fh_hop_t hop;
+
+    dw = host_uwb_open(&conf);
+    CHECK(dw != NULL);
+    CHECK_EQ(dw->mcps_ops->start(dw->llhw), 0);
+    tx = alloc_skb(FRAME_LEN, GFP_KERNEL);
+    skb_put_data(tx, frame, FRAME_LEN - FCS_LEN);
+
+    CHECK_EQ(fh_schedule_init(key, SESSION_ID, vupper64, phy.chan, phy.txCode), 0);
+    while (hop_eq(&ref[b], &(fh_hop_t){phy.chan, phy.txCode}))
+    {
+        b++;
+    }
+    CHECK(fh_schedule_stage(b, &hop));
+    CHECK(hop_eq(&hop, &ref[b]));
+
+    CHECK_EQ(dw->mcps_ops->get_current_timestamp_dtu(dw->llhw, &now), 0);
+    tx_cfg.timestamp_dtu = now + US_TO_DTU(10000);
+    CHECK_EQ(dw->mcps_ops->tx_frame(dw->llhw, tx, &tx_cfg, 0, 0), 0);
+    /* still on the configured channel while asleep */
+    CHECK_EQ(phy.chan, 9);
+    while (host_fs_timer_armed())
+    {
+        host_fs_timer_fire();
+    }
+    CHECK_EQ(phy.chan, hop.chan);
+    CHECK_EQ(phy.txCode, hop.pcode);
+    CHECK_EQ(phy.rxCode, hop.pcode);
+
+    fh_schedule_get_stats(&st);
+    CHECK_EQ(st.reconf, 1);
+    CHECK_EQ(st.reconf_late, 0);
+    CHECK(!fh_schedule_take(&hop));
+
+    host_threads_run();
+    fh_schedule_deinit();
+    kfree_skb(tx);
+    dw->mcps_ops->stop(dw->llhw);
+    host_uwb_close(dw);
+}
+
+int main(void)
+{
+    check_keystream();
+    check_peers();
+    check_stage();
+    check_wake_up();
+    return test_done("fh_schedule");
+}
@@ -0,0 +1,121 @@
+/**
+ * @file    test_fira_report.c
+ *
+ * @brief   JSON report of the ranging blocks: its text, the SP1 sequence,
+ *          the buffer grown for a block; then REPORTBENCH over 1 to
+ *          PEER_TABLE_MAX controlees on the host
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "fira_report.h"
+#include "common_fira.h"
+#include "peer_table.h"
+#include "reporter.h"
+#include "debug_config.h"
+
+#define BENCH_BLOCKS    200
+
+static error_e report_print(char *buff, int len)
+{
+    (void)buff;
+    (void)len;
+    return _NO_ERR;
+}
+
+reporter_t reporter_instance = {.print = report_print};
+
+/* JSON reports, binary ones for REPORTBENCH only */
+debug_config_t *get_debug_config(void)
+{
+    static debug_config_t dbg;
+
+    return &dbg;
+}
+
+static void check_text(void)
+{
+    static struct ranging_results results;
+    struct string_measurement s = {.str = malloc(FIRA_REPORT_STR_SIZE), .len = FIRA_REPORT_STR_SIZE};
+    struct ranging_measurements *rm = results.measurements;
+    uint32_t seq = 0;
+    int len;
+
+    results.block_index = 7;
+    results.n_measurements = 2;
+    rm[0].short_addr = 0x0A;
+    rm[0].distance_mm = 1234;
+    rm[0].local_aoa_measurements[0].pdoa_2pi = 1 << 14;
+    rm[0].local_aoa_measurements[0].aoa_2pi = -(1 << 13);
+    rm[0].local_aoa_measurements[0].aoa_fom = 100;
+    rm[1].short_addr = 0xBEEF;
+    rm[1].status = 2;
+
+    len = fira_report_block_json(&s, &results, -3, NULL);
+    CHECK_EQ(len, (int)strlen(s.str));
+    CHECK(!strcmp(s.str, "{\"Block\":7, \"results\":["
+                         "{\"Addr\":\"0x000a\",\"Status\":\"Ok\",\"D_cm\":123,\"LPDoA_deg\":90.00,"
+                         "\"LAoA_deg\":-45.00,\"LFoM\":100,\"RAoA_deg\":0.00,\"CFO_100ppm\":-3},"
+                         "{\"Addr\":\"0xbeef\",\"Status\":\"Err\"}]"));
+
+    /* a payload the MAC has not reported yet: its sequence and data, once */
+    rm[0].payload_seq_sent = 5;
+    rm[0].sp1_data_len = 3;
+    rm[0].sp1_data[0] = 0x01;
+    rm[0].sp1_data[1] = 0xA2;
+    rm[0].sp1_data[2] = 0x3C;
+    fira_report_block_json(&s, &results, 0, &seq);
+    CHECK(strstr(s.str, ",\"CFO_100ppm\":0,\"SEQ\":5,\"DATA\":\"01:A2:3C\"}") != NULL);
+    CHECK_EQ(seq, 5);
+    fira_report_block_json(&s, &results, 0, &seq);
+    CHECK(strstr(s.str, "SEQ") == NULL);
+
+    /* a full block: grown a measurement at a time, room for the end left */
+    results.n_measurements = FIRA_CONTROLEES_MAX;
+    for (int i = 0; i < FIRA_CONTROLEES_MAX; i++)
+    {
+        rm[i] = rm[0];
+        rm[i].short_addr = (uint16_t)i;
+    }
+    len = fira_report_block_json(&s, &results, 0, NULL);
+    CHECK_EQ(len, (int)strlen(s.str));
+    CHECK_EQ(s.len % FIRA_REPORT_STR_SIZE, 0);
+    CHECK(s.len >= len + FIRA_REPORT_STR_TAIL_SIZE);
+    CHECK(s.len < len + FIRA_REPORT_STR_SIZE + FIRA_REPORT_STR_TAIL_SIZE + FIRA_REPORT_STR_SIZE);
+    free(s.str);
+}
+
+static void check_bench(void)
+{
+    fira_report_bench_t res;
+
+    CHECK_EQ(fira_report_bench(0, BENCH_BLOCKS, &res), -1);
+    CHECK_EQ(fira_report_bench(PEER_TABLE_MAX + 1, BENCH_BLOCKS, &res), -1);
+
+    for (int n = 1; n <= PEER_TABLE_MAX; n *= 2)
+    {
+        int rounds = fira_report_bench(n, BENCH_BLOCKS, &res);
+
+        CHECK_EQ(rounds, (n + FIRA_CONTROLEES_MAX - 1) / FIRA_CONTROLEES_MAX);
+        CHECK(res.json_cyc > res.bin_cyc);
+        CHECK(res.str_len >= FIRA_REPORT_STR_SIZE);
+        CHECK_EQ(peer_table_count(), 0);
+        printf("REPORTBENCH: %d peers, %d reports/block, %lu us/block, lookup+state %lu ns, JSON %lu ns per peer, %u B buffer\n",
+               n, rounds, (unsigned long)res.block_us, (unsigned long)res.state_ns, (unsigned long)res.json_ns,
+               res.str_len);
+        printf("REPORTBENCH: %d peers, JSON %lu cycles, binary %lu cycles per block, binary %lu ns per peer\n", n,
+               (unsigned long)res.json_cyc, (unsigned long)res.bin_cyc, (unsigned long)res.bin_ns);
+    }
+}
+
+int main(void)
+{
+    check_text();
+    check_bench();
+    return test_done("fira_report");
+}
@@ -0,0 +1,439 @@
+/**
+ * @file    test_log_arena.c
+ *
+ * @brief   Report buffer with N producer threads and the flush thread as
+ *          consumer: each message out whole and in order, or counted as a
+ *          drop of its producer; discards asked by another task meanwhile;
+ *          the statistics slots of tasks deleted and of handles reused
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "log_arena.h"
+#include "reporter.h"
+#include "host_rtos.h"
+
+#define ARENA_SIZE      4096
+#define PRODUCERS       8               /**< tasks, plus one ISR */
+#define ISR_ID          PRODUCERS
+#define MSGS            5000            /**< per producer */
+#define MSG_HDR         6               /**< len, producer, seq LE */
+#define MSG_MAX         64
+#define CHUNK_MAX       300             /**< consumer reads of 1 to CHUNK_MAX bytes */
+#define DISCARD_EVERY   2000            /**< messages of the discarding task */
+#define REPORT_MAX      4096
+
+typedef struct
+{
+    int id;
+    uint32_t accepted;
+    uint32_t dropped;
+    uint32_t bytes;                     /**< as LOGSTAT counts them: claimed */
+} producer_t;
+
+typedef struct
+{
+    int32_t last_seq[PRODUCERS + 1];
+    uint32_t received[PRODUCERS + 1];
+    uint32_t missing[PRODUCERS + 1];
+    uint32_t out_of_order;
+    uint32_t corrupt;
+    uint32_t cut;                       /**< messages cut by a discard */
+    uint8_t carry[MSG_MAX];
+    int n_carry;
+} stream_t;
+
+static uint8_t arena_buf[ARENA_SIZE] __attribute__((aligned(4)));
+static log_arena_t arena;
+static int tasks[PRODUCERS + 2];        /**< their addresses are the task handles */
+static const char *names[PRODUCERS + 1] = {"Task0", "Task1", "Task2", "Task3", "Task4", "Task5", "Task6", "Task7"};
+static producer_t prod[PRODUCERS + 1];
+static volatile bool producers_done;
+static volatile bool discarding;
+
+static char report[REPORT_MAX];
+static int report_len;
+
+static error_e report_print(char *buff, int len)
+{
+    if (report_len + len < REPORT_MAX)
+    {
+        memcpy(&report[report_len], buff, len);
+        report_len += len;
+    }
+    return _NO_ERR;
+}
+
+reporter_t reporter_instance = {.print = report_print};
+
+static uint32_t rnd(uint32_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+static uint8_t pattern(int id, uint32_t seq, int k)
+{
+    return (uint8_t)(id * 37 + seq * 11 + k);
+}
+
+/* @brief LOGSTAT line of a producer: its bytes and drops, false if none */
+static bool logstat(const char *name, unsigned long *bytes, unsigned long *drops)
+{
+    char line[128], n[16];
+    unsigned long rate, hwm;
+
+    report_len = 0;
+    log_arena_report();
+    report[report_len] = '\0';
+    for (char *p = report, *e; (e = strstr(p, "\r\n")); p = e + 2)
+    {
+        int len = (int)(e - p);
+
+        memcpy(line, p, len);
+        line[len] = '\0';
+        if (sscanf(line, "%15s %lu %lu %lu %lu", n, &rate, bytes, drops, &hwm) == 5 && !strcmp(n, name))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* A producer: messages of MSG_HDR to MSG_MAX bytes, written whole or
+ * formatted in place */
+static void *producer(void *arg)
+{
+    producer_t *p = arg;
+    uint32_t x = 0x9e3779b9u * (p->id + 1);
+    uint8_t msg[MSG_MAX];
+
+    if (p->id == ISR_ID)
+    {
+        host_isr_set(true);
+    }
+    else
+    {
+        host_task_enter(&tasks[p->id], names[p->id]);
+    }
+
+    for (uint32_t seq = 0; seq < MSGS; seq++)
+    {
+        int len = MSG_HDR + rnd(&x) % (MSG_MAX - MSG_HDR + 1);
+        uint8_t *m = msg;
+        bool reserve = rnd(&x) & 1;
+
+        if (reserve && !(m = log_arena_claim(&arena, MSG_MAX)))
+        {
+            p->dropped++;
+            sched_yield();
+            continue;
+        }
+        m[0] = (uint8_t)len;
+        m[1] = (uint8_t)p->id;
+        memcpy(&m[2], &seq, 4);
+        for (int k = MSG_HDR; k < len; k++)
+        {
+            m[k] = pattern(p->id, seq, k);
+        }
+        if (reserve)
+        {
+            /* less than reserved */
+            log_arena_commit(&arena, m, len);
+        }
+        else if (!log_arena_write(&arena, msg, len))
+        {
+            p->dropped++;
+            sched_yield();
+            continue;
+        }
+        p->accepted++;
+        p->bytes += reserve ? MSG_MAX : len;
+    }
+    return NULL;
+}
+
+/* @brief a message out of the stream */
+static void stream_msg(stream_t *s, const uint8_t *m)
+{
+    int id = m[1];
+    int32_t seq;
+
+    memcpy(&seq, &m[2], 4);
+    if (id > PRODUCERS)
+    {
+        s->corrupt++;
+        return;
+    }
+    for (int k = MSG_HDR; k < m[0]; k++)
+    {
+        if (m[k] != pattern(id, (uint32_t)seq, k))
+        {
+            s->corrupt++;
+            return;
+        }
+    }
+    if (seq <= s->last_seq[id])
+    {
+        s->out_of_order++;
+    }
+    s->missing[id] += (uint32_t)(seq - s->last_seq[id] - 1);
+    s->last_seq[id] = seq;
+    s->received[id]++;
+}
+
+static void stream_bytes(stream_t *s, const uint8_t *b, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        s->carry[s->n_carry++] = b[i];
+        if (s->carry[0] < MSG_HDR || s->carry[0] > MSG_MAX)
+        {
+            s->corrupt++;
+            s->n_carry = 0;
+        }
+        else if (s->n_carry == s->carry[0])
+        {
+            stream_msg(s, s->carry);
+            s->n_carry = 0;
+        }
+    }
+}
+
+/* The flush thread: reads of any size, consumed once read */
+static void *consumer(void *arg)
+{
+    stream_t *s = arg;
+    uint32_t x = 12345;
+    uint8_t chunk[CHUNK_MAX];
+
+    for (;;)
+    {
+        bool done = producers_done;
+        uint32_t tail = arena.tail;
+        uint32_t n = log_arena_peek(&arena, chunk, 1 + rnd(&x) % CHUNK_MAX);
+
+        /* only a discard moves the tail on a peek: it drops the rest of a
+         * message partly out */
+        if (arena.tail != tail && s->n_carry)
+        {
+            s->cut++;
+            s->n_carry = 0;
+        }
+        if (n == 0 && done)
+        {
+            break;
+        }
+        stream_bytes(s, chunk, (int)n);
+        log_arena_consume(&arena, n);
+    }
+    return NULL;
+}
+
+/* Another task resets the output meanwhile, as STOP does */
+static void *discarder(void *arg)
+{
+    (void)arg;
+    host_task_enter(&tasks[PRODUCERS + 1], "CmdTask");
+    while (discarding)
+    {
+        for (volatile int i = 0; i < DISCARD_EVERY; i++)
+        {
+        }
+        log_arena_discard(&arena);
+    }
+    return NULL;
+}
+
+/* @brief N producers and the consumer, with a discarding task or not */
+static void run(stream_t *s, bool discards)
+{
+    pthread_t th[PRODUCERS + 1], cons, disc;
+    uint64_t t0 = test_cycles();
+    uint64_t bytes = 0;
+
+    memset(s, 0, sizeof(*s));
+    memset(prod, 0, sizeof(prod));
+    for (int i = 0; i <= PRODUCERS; i++)
+    {
+        s->last_seq[i] = -1;
+        prod[i].id = i;
+    }
+    producers_done = false;
+    discarding = discards;
+
+    pthread_create(&cons, NULL, consumer, s);
+    if (discards)
+    {
+        pthread_create(&disc, NULL, discarder, NULL);
+    }
+    for (int i = 0; i <= PRODUCERS; i++)
+    {
+        pthread_create(&th[i], NULL, producer, &prod[i]);
+    }
+    for (int i = 0; i <= PRODUCERS; i++)
+    {
+        pthread_join(th[i], NULL);
+        bytes += prod[i].bytes;
+    }
+    discarding = false;
+    if (discards)
+    {
+        pthread_join(disc, NULL);
+    }
+    producers_done = true;
+    pthread_join(cons, NULL);
+
+    printf("log_arena: %d producers%s: %.1f cycles per byte through\n", PRODUCERS + 1,
+           discards ? ", discards" : "", (double)(test_cycles() - t0) / bytes);
+}
+
+static void check_producers(void)
+{
+    static stream_t s;
+    unsigned long bytes, drops;
+    uint32_t dropped = 0;
+
+    log_arena_init(&arena, arena_buf, ARENA_SIZE);
+    run(&s, false);
+
+    /* all out, whole and in order, but the drops, each counted where it was */
+    CHECK_EQ(s.corrupt, 0);
+    CHECK_EQ(s.out_of_order, 0);
+    CHECK_EQ(s.n_carry, 0);
+    for (int i = 0; i <= PRODUCERS; i++)
+    {
+        CHECK_EQ(prod[i].accepted + prod[i].dropped, MSGS);
+        CHECK_EQ(s.received[i], prod[i].accepted);
+        CHECK_EQ(s.missing[i] + (MSGS - 1 - s.last_seq[i]), prod[i].dropped);
+        CHECK(logstat((i == ISR_ID) ? "ISR/other" : names[i], &bytes, &drops));
+        CHECK_EQ(drops, prod[i].dropped);
+        dropped += prod[i].dropped;
+        if (i != ISR_ID)
+        {
+            CHECK_EQ(bytes, prod[i].bytes);
+        }
+    }
+    CHECK(dropped > 0);
+    CHECK_EQ(log_arena_peek(&arena, NULL, 1), 0);
+
+    /* the tasks deleted: their slots free */
+    for (int i = 0; i < PRODUCERS; i++)
+    {
+        log_arena_producer_free(&tasks[i]);
+        CHECK(!logstat(names[i], &bytes, &drops));
+    }
+}
+
+static void check_discards(void)
+{
+    static stream_t s;
+    static const char a[] = "before", b[] = "after";
+    uint8_t out[16];
+
+    /* what is claimed before the reset goes, what comes after stays */
+    log_arena_init(&arena, arena_buf, ARENA_SIZE);
+    host_task_enter(&tasks[0], "Task0");
+    log_arena_write(&arena, (const uint8_t *)a, sizeof(a));
+    log_arena_discard(&arena);
+    log_arena_write(&arena, (const uint8_t *)b, sizeof(b));
+    CHECK_EQ(log_arena_peek(&arena, out, sizeof(out)), sizeof(b));
+    CHECK(!memcmp(out, b, sizeof(b)));
+    log_arena_consume(&arena, sizeof(b));
+
+    /* claimed, not published yet: dropped once published */
+    uint8_t *p = log_arena_claim(&arena, sizeof(a));
+    log_arena_discard(&arena);
+    CHECK_EQ(log_arena_peek(&arena, out, sizeof(out)), 0);
+    memcpy(p, a, sizeof(a));
+    log_arena_commit(&arena, p, sizeof(a));
+    log_arena_write(&arena, (const uint8_t *)b, sizeof(b));
+    CHECK_EQ(log_arena_peek(&arena, out, sizeof(out)), sizeof(b));
+    CHECK(!memcmp(out, b, sizeof(b)));
+    log_arena_consume(&arena, sizeof(b));
+    host_task_enter(NULL, NULL);
+    log_arena_producer_free(&tasks[0]);
+
+    /* resets while the producers run: whatever comes out is whole, but the
+     * message a reset cuts, and in order */
+    run(&s, true);
+    CHECK_EQ(s.corrupt, 0);
+    CHECK_EQ(s.out_of_order, 0);
+    uint32_t received = 0, accepted = 0;
+    for (int i = 0; i <= PRODUCERS; i++)
+    {
+        CHECK(s.received[i] <= prod[i].accepted);
+        received += s.received[i];
+        accepted += prod[i].accepted;
+        log_arena_producer_free(&tasks[i]);
+    }
+    CHECK(received < accepted);
+    log_arena_producer_free(&tasks[PRODUCERS + 1]);
+}
+
+static void check_slots(void)
+{
+    static int handles[3 * LOG_ARENA_PRODUCERS_MAX];
+    static const uint8_t m[20];
+    unsigned long bytes, drops, shared;
+
+    log_arena_init(&arena, arena_buf, ARENA_SIZE);
+    CHECK(logstat("ISR/other", &shared, &drops));
+
+    /* a session task after the other: each takes the slot the previous
+     * one freed, none falls back to the shared one */
+    for (int i = 0; i < 3 * LOG_ARENA_PRODUCERS_MAX; i++)
+    {
+        host_task_enter(&handles[i], "DataTask");
+        CHECK(log_arena_write(&arena, m, sizeof(m)));
+        CHECK(logstat("DataTask", &bytes, &drops));
+        CHECK_EQ(bytes, sizeof(m));
+        log_arena_producer_free(&handles[i]);
+        log_arena_discard(&arena);
+        log_arena_peek(&arena, NULL, 0);
+    }
+    CHECK(logstat("ISR/other", &bytes, &drops));
+    CHECK_EQ(bytes, shared);
+
+    /* a handle reused: the new task's name, its own counts */
+    host_task_enter(&handles[0], "DataTask");
+    log_arena_write(&arena, m, 10);
+    log_arena_producer_free(&handles[0]);
+    host_task_enter(&handles[0], "Other");
+    log_arena_write(&arena, m, 5);
+    CHECK(!logstat("DataTask", &bytes, &drops));
+    CHECK(logstat("Other", &bytes, &drops));
+    CHECK_EQ(bytes, 5);
+    log_arena_producer_free(&handles[0]);
+
+    /* more live tasks than slots: the others share the last one */
+    for (int i = 0; i <= LOG_ARENA_PRODUCERS_MAX; i++)
+    {
+        host_task_enter(&handles[i], (i < LOG_ARENA_PRODUCERS_MAX) ? "Live" : "Extra");
+        log_arena_discard(&arena);
+        log_arena_peek(&arena, NULL, 0);
+        log_arena_write(&arena, m, 1);
+    }
+    CHECK(!logstat("Extra", &bytes, &drops));
+    CHECK(logstat("ISR/other", &bytes, &drops));
+    CHECK_EQ(bytes, shared + 1);
+    host_task_enter(NULL, NULL);
+}
+
+int main(void)
+{
+    check_producers();
+    check_discards();
+    check_slots();
+    return test_done("log_arena");
+}
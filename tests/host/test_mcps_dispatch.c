@@ -0,0 +1,174 @@
+/**
+ * @file    test_mcps_dispatch.c
+ *
+ * @brief   McpsTask() on the DW3000 model: every event pending at a wake
+ *          handled once, in the order of an exchange, and its latency
+ *
+ * @author  Development Team
+ *
+ */
+
+#include "test.h"
+#include "host_rtos.h"
+#include "host_uwb.h"
+#include "mcps_mock.h"
+#include "dw3000_sim.h"
+#include "dw3000_mcps_mcu.h"
+#include "linux/skbuff.h"
+
+#define FRAME_LEN       20          /**< FCS included */
+#define RX_FRAMES       2           /**< frames of an RX wake */
+#define AT_DTU          1000
+#define IDLE_DTU        US_TO_DTU(5000)
+#define SETTLE_DTU      US_TO_DTU(1000)     /**< past the TX done and the RX timeout */
+#define LATENCY_US      1000        /**< post to wake: 32 or 33 Rtc ticks */
+#define LATENCY_BUCKET  6           /**< [32, 64) ticks */
+
+static dwt_config_t phy = {
+    .chan = 9,
+    .txPreambLength = DWT_PLEN_64,
+    .rxPAC = DWT_PAC8,
+    .txCode = 9,
+    .rxCode = 9,
+    .sfdType = DWT_SFD_IEEE_4Z,
+    .dataRate = DWT_BR_6M8,
+    .phrMode = DWT_PHRMODE_STD,
+    .phrRate = DWT_PHRRATE_STD,
+    .sfdTO = (64 + 1 + 8 - 8),
+    .stsMode = DWT_STS_MODE_OFF,
+    .stsLength = DWT_STS_LEN_64,
+    .pdoaMode = DWT_PDOA_M1,
+};
+static dwt_txconfig_t tx_phy;
+static rxtx_configure_t rxtx = {.pdwCfg = &phy, .txConfig = &tx_phy};
+static dwt_mcps_config_t conf = {.rxtx_config = &rxtx};
+
+static const uint8_t frame[FRAME_LEN] = {0x41, 0x88, 0x01, 0xCA, 0xDE};
+
+/* The MCPS_EVT_* order: the handlers of a wake run in it */
+static const mcps_mock_evt_e evt_of[MCPS_EVT_COUNT] = {
+    [MCPS_EVT_TX_DONE] = MCPS_MOCK_TX_DONE,
+    [MCPS_EVT_RX] = MCPS_MOCK_RX,
+    [MCPS_EVT_RX_TIMEOUT] = MCPS_MOCK_RX_TIMEOUT,
+    [MCPS_EVT_RX_ERROR] = MCPS_MOCK_RX_ERROR,
+    [MCPS_EVT_TIMER] = MCPS_MOCK_TIMER,
+};
+
+/* @brief the ISR of evt runs, the MCPS task does not */
+static void post(struct dwchip_s *dw, struct sk_buff *tx, enum mcps_evt_e evt)
+{
+    const struct mcps802154_ops *ops = dw->mcps_ops;
+    struct mcps802154_rx_frame_config rx_cfg = {.timeout_dtu = -1};
+    struct mcps802154_tx_frame_config tx_cfg = {0};
+    dw3000_sim_frame_t ev = {.type = DW3000_SIM_RX_OK, .data = frame, .len = FRAME_LEN};
+    uint32_t now = 0;
+
+    switch (evt)
+    {
+    case MCPS_EVT_TX_DONE:
+        CHECK_EQ(ops->tx_frame(dw->llhw, tx, &tx_cfg, 0, 0), 0);
+        break;
+    case MCPS_EVT_RX:
+        for (int i = 0; i < RX_FRAMES; i++)
+        {
+            CHECK_EQ(ops->rx_enable(dw->llhw, &rx_cfg, 0, 0), 0);
+            ev.at_dtu = dw3000_sim_now(dw) + AT_DTU;
+            CHECK_EQ(dw3000_sim_script(dw, &ev, 1), 1);
+            dw3000_sim_advance(dw, 2 * AT_DTU);
+        }
+        return;
+    case MCPS_EVT_RX_TIMEOUT:
+        rx_cfg.timeout_dtu = AT_DTU;
+        CHECK_EQ(ops->rx_enable(dw->llhw, &rx_cfg, 0, 0), 0);
+        break;
+    case MCPS_EVT_RX_ERROR:
+        CHECK_EQ(ops->rx_enable(dw->llhw, &rx_cfg, 0, 0), 0);
+        ev.type = DW3000_SIM_RX_ERROR;
+        ev.at_dtu = dw3000_sim_now(dw) + AT_DTU;
+        CHECK_EQ(dw3000_sim_script(dw, &ev, 1), 1);
+        break;
+    case MCPS_EVT_TIMER:
+        /* the fast sleep timer ends the idle */
+        CHECK_EQ(ops->get_current_timestamp_dtu(dw->llhw, &now), 0);
+        CHECK_EQ(ops->idle(dw->llhw, true, now + IDLE_DTU), 0);
+        CHECK(host_fs_timer_fire());
+        return;
+    default:
+        return;
+    }
+    dw3000_sim_advance(dw, SETTLE_DTU);
+}
+
+int main(void)
+{
+    mcps_mock_evt_e log[MCPS_MOCK_LOG_LEN];
+    mcps_latency_t lat[MCPS_EVT_COUNT];
+    struct dwchip_s *dw;
+    struct sk_buff *tx;
+    int masks = 0;
+
+    dw = host_uwb_open(&conf);
+    CHECK(dw != NULL);
+    CHECK_EQ(dw->mcps_ops->start(dw->llhw), 0);
+    tx = alloc_skb(FRAME_LEN, GFP_KERNEL);
+    CHECK(tx != NULL);
+    skb_put_data(tx, frame, FRAME_LEN - FCS_LEN);
+    dw3000_mcps_reset_latency();
+
+    /* every set of events, posted in reverse, handled in one wake */
+    for (uint32_t mask = 1; mask < (1UL << MCPS_EVT_COUNT); mask++)
+    {
+        mcps_mock_evt_e want[MCPS_MOCK_LOG_LEN];
+        int n = 0, got;
+
+        mcps_mock_reset_stats();
+        for (int e = MCPS_EVT_COUNT - 1; e >= 0; e--)
+        {
+            if (mask & (1UL << e))
+            {
+                post(dw, tx, (enum mcps_evt_e)e);
+            }
+        }
+        for (int e = 0; e < MCPS_EVT_COUNT; e++)
+        {
+            for (int k = 0; (mask & (1UL << e)) && k < ((e == MCPS_EVT_RX) ? RX_FRAMES : 1); k++)
+            {
+                want[n++] = evt_of[e];
+            }
+        }
+        CHECK_EQ(mcps_mock_get_log(log, MCPS_MOCK_LOG_LEN), 0);
+
+        host_time_advance_us(LATENCY_US);
+        CHECK_EQ(host_threads_run(), 1);
+
+        got = mcps_mock_get_log(log, MCPS_MOCK_LOG_LEN);
+        CHECK_EQ(got, n);
+        for (int i = 0; i < n && i < got; i++)
+        {
+            CHECK_EQ(log[i], want[i]);
+        }
+        masks++;
+    }
+
+    /* each event in half the sets, all LATENCY_US after their post */
+    dw3000_mcps_get_latency(lat);
+    for (int e = 0; e < MCPS_EVT_COUNT; e++)
+    {
+        CHECK_EQ(lat[e].count, (uint32_t)(masks + 1) / 2);
+        CHECK_EQ(lat[e].hist[LATENCY_BUCKET], lat[e].count);
+        CHECK(lat[e].max >= 32 && lat[e].max <= 33);
+    }
+    dw3000_mcps_reset_latency();
+    dw3000_mcps_get_latency(lat);
+    CHECK_EQ(lat[MCPS_EVT_RX].count, 0);
+
+    /* STOP with an event pending: the task exits, nothing is handled */
+    mcps_mock_reset_stats();
+    post(dw, tx, MCPS_EVT_TX_DONE);
+    kfree_skb(tx);
+    dw->mcps_ops->stop(dw->llhw);
+    host_uwb_close(dw);
+    CHECK_EQ(mcps_mock_get_log(log, MCPS_MOCK_LOG_LEN), 0);
+
+    return test_done("mcps_dispatch");
+}
@@ -0,0 +1,141 @@
+/**
+ * @file    test_mcps_rx_ring.c
+ *
+ * @brief   ISR to MCPS task RX ring on the DW3000 model: more frames than it
+ *          holds before one drain, the new ones dropped, counted and reported
+ *          as RX errors, the pending ones delivered whole and in order
+ *
+ * @author  Development Team
+ *
+ */
+
+#include "test.h"
+#include "host_rtos.h"
+#include "host_uwb.h"
+#include "mcps_mock.h"
+#include "dw3000_sim.h"
+#include "dw3000_mcps_mcu.h"
+
+#define FRAME_LEN       20          /**< FCS included */
+#define AT_DTU          1000
+#define LATENCY_US      1000
+#define OVERRUN         3           /**< frames past a full ring */
+#define ROUNDS          5
+
+static dwt_config_t phy = {
+    .chan = 9,
+    .txPreambLength = DWT_PLEN_64,
+    .rxPAC = DWT_PAC8,
+    .txCode = 9,
+    .rxCode = 9,
+    .sfdType = DWT_SFD_IEEE_4Z,
+    .dataRate = DWT_BR_6M8,
+    .phrMode = DWT_PHRMODE_STD,
+    .phrRate = DWT_PHRRATE_STD,
+    .sfdTO = (64 + 1 + 8 - 8),
+    .stsMode = DWT_STS_MODE_OFF,
+    .stsLength = DWT_STS_LEN_64,
+    .pdoaMode = DWT_PDOA_M1,
+};
+static dwt_txconfig_t tx_phy;
+static rxtx_configure_t rxtx = {.pdwCfg = &phy, .txConfig = &tx_phy};
+static dwt_mcps_config_t conf = {.rxtx_config = &rxtx};
+
+/* @brief the ISR takes frames of sequence numbers seq.., the MCPS task does
+ *        not run */
+static void receive(struct dwchip_s *dw, uint8_t seq, int n)
+{
+    struct mcps802154_rx_frame_config rx_cfg = {.timeout_dtu = -1};
+    uint8_t frame[FRAME_LEN] = {0x41, 0x88};
+    dw3000_sim_frame_t ev = {.type = DW3000_SIM_RX_OK, .data = frame, .len = FRAME_LEN};
+
+    for (int i = 0; i < n; i++)
+    {
+        frame[2] = (uint8_t)(seq + i);
+        CHECK_EQ(dw->mcps_ops->rx_enable(dw->llhw, &rx_cfg, 0, 0), 0);
+        ev.at_dtu = dw3000_sim_now(dw) + AT_DTU;
+        CHECK_EQ(dw3000_sim_script(dw, &ev, 1), 1);
+        dw3000_sim_advance(dw, 2 * AT_DTU);
+    }
+}
+
+/* @brief one drain of frames seq.. of which the ring kept the first taken,
+ *        overrun frames after it */
+static void check_drain(uint8_t seq, int taken, int overrun)
+{
+    mcps_mock_evt_e log[MCPS_MOCK_LOG_LEN];
+    uint8_t got[MCPS_MOCK_LOG_LEN];
+    mcps_mock_stats_t st;
+    int n;
+
+    host_time_advance_us(LATENCY_US);
+    CHECK_EQ(host_threads_run(), 1);
+
+    /* the pending frames, then a single RX error for all the dropped */
+    n = mcps_mock_get_log(log, MCPS_MOCK_LOG_LEN);
+    CHECK_EQ(n, taken + (overrun ? 1 : 0));
+    for (int i = 0; i < taken && i < n; i++)
+    {
+        CHECK_EQ(log[i], MCPS_MOCK_RX);
+    }
+    if (overrun)
+    {
+        CHECK_EQ(log[n - 1], MCPS_MOCK_RX_ERROR);
+    }
+
+    /* none overwritten: the oldest ones, in the order received */
+    n = mcps_mock_get_rx_seq(got, MCPS_MOCK_LOG_LEN);
+    CHECK_EQ(n, taken);
+    for (int i = 0; i < n; i++)
+    {
+        CHECK_EQ(got[i], (uint8_t)(seq + i));
+    }
+    mcps_mock_get_stats(&st);
+    CHECK_EQ(st.rx_frames, taken);
+    CHECK_EQ(st.rx_bytes, taken * (FRAME_LEN - FCS_LEN));
+    CHECK_EQ(st.rx_errors, overrun ? 1 : 0);
+    mcps_mock_reset_stats();
+}
+
+int main(void)
+{
+    mcps_rx_ring_stats_t st0, st;
+    struct dwchip_s *dw;
+    uint8_t seq = 0;
+
+    dw = host_uwb_open(&conf);
+    CHECK(dw != NULL);
+    CHECK_EQ(dw->mcps_ops->start(dw->llhw), 0);
+    dw3000_mcps_get_rx_ring_stats(&st0);
+    CHECK_EQ(st0.depth, MCPS_RX_MSG_MAX);
+
+    /* a full ring: all delivered, no overrun */
+    mcps_mock_reset_stats();
+    receive(dw, seq, MCPS_RX_MSG_MAX);
+    check_drain(seq, MCPS_RX_MSG_MAX, 0);
+    seq += MCPS_RX_MSG_MAX;
+    dw3000_mcps_get_rx_ring_stats(&st);
+    CHECK_EQ(st.overruns, st0.overruns);
+    CHECK_EQ(st.hwm, MCPS_RX_MSG_MAX);
+
+    /* OVERRUN more, round after round, the index of the ring wrapping */
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        receive(dw, seq, MCPS_RX_MSG_MAX + OVERRUN + r);
+        dw3000_mcps_get_rx_ring_stats(&st);
+        CHECK_EQ(st.overruns - st0.overruns, (uint32_t)(OVERRUN * (r + 1) + r * (r + 1) / 2));
+        check_drain(seq, MCPS_RX_MSG_MAX, OVERRUN + r);
+        seq += MCPS_RX_MSG_MAX + OVERRUN + r;
+    }
+    dw3000_mcps_get_rx_ring_stats(&st);
+    CHECK_EQ(st.frames - st0.frames, (uint32_t)(MCPS_RX_MSG_MAX * (ROUNDS + 1)));
+    CHECK_EQ(st.hwm, MCPS_RX_MSG_MAX);
+
+    /* room again after the drain */
+    receive(dw, seq, 1);
+    check_drain(seq, 1, 0);
+
+    dw->mcps_ops->stop(dw->llhw);
+    host_uwb_close(dw);
+    return test_done("mcps_rx_ring");
+}
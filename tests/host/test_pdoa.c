@@ -0,0 +1,486 @@
+/**
+ * @file    test_pdoa.c
+ *
+ * @brief   PDoA to AoA in fixed point against the double precision formulas
+ *          it replaced, over the PDoA range of every antenna and channel;
+ *          the O(1) window average against the O(N) loop it replaced, both
+ *          modes; cycles per conversion of each
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "dw3000_pdoa.h"
+#include "rf_tuning_config.h"
+
+#define AOA_ERR_MAX_DEG     0.5
+#define PDOA_ERR_MAX_Q11    1
+#define CIRC_ERR_MAX_DEG100 3           /**< 0.03 deg */
+#define AVRG_MAX            40          /**< windows tested, 1 to AVRG_MAX */
+#define WALK_SAMPLES        3000
+#define BENCH_CALLS         200000
+
+/* The characterizations of the double precision code, dw3000_pdoa.c before
+ * the fixed point tables of tools/pdoa_lut_gen.py: PDoA deg, path
+ * difference m */
+
+static const double ref_mon_ch5_x[] = {
+    -167.451, -166.592, -165.733, -161.641, -157.549, -150.116,
+    -142.683, -134.165, -125.647, -116.942, -108.238, -97.992,
+    -87.746, -75.604, -63.462, -48.720, -33.978, -16.989,
+    0.0, 19.145, 38.290, 55.524, 72.759, 86.546,
+    100.333, 110.570, 120.808, 129.769, 138.731, 146.481,
+    154.231, 161.072, 167.913, 173.938, 179.963, 185.898,
+    191.834
+};
+
+static const double ref_mon_ch5_y[] = {
+    -0.02277711, -0.02259527, -0.02243108, -0.02183519, -0.02140348, -0.02060275,
+    -0.01972556, -0.01864569, -0.01744828, -0.01607664, -0.01464084, -0.01298905,
+    -0.01138856, -0.00954588, -0.00779023, -0.00581025, -0.0039552, -0.00191495,
+    0.0, 0.00199575, 0.0039552, 0.00581256, 0.00779023, 0.00948489,
+    0.01138856, 0.01298333, 0.01464084, 0.01606225, 0.01744828, 0.01861804,
+    0.01972556, 0.02061772, 0.02140348, 0.02198524, 0.02243108, 0.02270353,
+    0.02277711
+};
+
+static const double ref_mon_ch9_x[] = {
+    -169.84426, -167.11048, -158.87248000000002, -149.57176, -137.69556, -119.09592,
+    -92.6935, -62.443799999999996, -33.2075, 0.0, 32.961839999999995, 64.67824,
+    88.73612, 108.79534, 124.74589999999999, 137.60603999999998, 147.50220000000002, 161.44412,
+    176.59868
+};
+
+static const double ref_mon_ch9_y[] = {
+    -0.0178831, -0.01761142, -0.01680462, -0.01548722, -0.01369925, -0.01149504,
+    -0.00894155, -0.00611638, -0.00310537, 0.0, 0.00310537, 0.00611638,
+    0.00894155, 0.01149504, 0.01369925, 0.01548722, 0.01680462, 0.01761142,
+    0.0178831
+};
+
+static const double ref_jolie_ch5_x[] = {
+    -166.27930196, -157.0024225, -149.55838501, -142.14051332, -134.46269704, -127.8210698,
+    -120.92711554, -112.43367106, -105.30918511, -96.76697129, -87.82458557, -77.72606262,
+    -66.55387036, -55.00572544, -43.65803963, -31.48916832, -20.65986893, -10.09601225,
+    0.0, 8.59879892, 19.13709153, 29.43074745, 40.56982151, 52.54895667,
+    64.78731337, 78.42224659, 92.09874303, 105.79844189, 118.66624366, 130.41513253,
+    141.06896151, 150.62280441, 157.97588953, 164.74276625, 170.5402407, 175.70974943,
+    178.43237117
+};
+
+static const double ref_jolie_ch5_y[] = {
+    -0.0178831, -0.01781505, -0.01761142, -0.01727375, -0.01680462, -0.0162076,
+    -0.01548722, -0.01464898, -0.01369925, -0.01264526, -0.01149504, -0.01025733,
+    -0.00894155, -0.00755773, -0.00611638, -0.00462849, -0.00310537, -0.00155862,
+    0.0, 0.00155862, 0.00310537, 0.00462849, 0.00611638, 0.00755773,
+    0.00894155, 0.01025733, 0.01149504, 0.01264526, 0.01369925, 0.01464898,
+    0.01548722, 0.0162076, 0.01680462, 0.01727375, 0.01761142, 0.01781505,
+    0.0178831
+};
+
+static const double ref_jolie_ch9_x[] = {
+    -194.26382249, -189.94444242, -185.54389927, -179.72945707, -174.20326737, -166.48234994,
+    -157.16712186, -146.40031499, -134.50440281, -121.27737905, -108.1319426, -94.45667093,
+    -80.22686509, -66.92952722, -53.29020472, -40.52899653, -26.72033914, -12.96053113,
+    0.0, 13.25819423, 26.3242237, 40.06032733, 52.92500285, 65.90989195,
+    77.3400328, 89.12909447, 99.33491395, 109.34396358, 118.4741959, 127.76385629,
+    136.24735635, 143.07957935, 149.31089476, 155.68400588, 160.27201659, 163.69689225,
+    165.76697029
+};
+
+static const double ref_jolie_ch9_y[] = {
+    -0.0178831, -0.01781505, -0.01761142, -0.01727375, -0.01680462, -0.0162076,
+    -0.01548722, -0.01464898, -0.01369925, -0.01264526, -0.01149504, -0.01025733,
+    -0.00894155, -0.00755773, -0.00611638, -0.00462849, -0.00310537, -0.00155862,
+    0.0, 0.00155862, 0.00310537, 0.00462849, 0.00611638, 0.00755773,
+    0.00894155, 0.01025733, 0.01149504, 0.01264526, 0.01369925, 0.01464898,
+    0.01548722, 0.0162076, 0.01680462, 0.01727375, 0.01761142, 0.01781505,
+    0.0178831
+};
+
+static const double ref_cst_chn_x[] = {
+    -182.178, -172.91577143, -163.65354286, -154.39131429, -145.12908571, -135.86685714,
+    -126.60462857, -117.3424, -108.08017143, -98.81794286, -89.55571429, -80.29348571,
+    -71.03125714, -61.76902857, -52.5068, -43.24457143, -33.98234286, -24.72011429,
+    -15.45788571, -6.19565714, 3.06657143, 12.3288, 21.59102857, 30.85325714,
+    40.11548571, 49.37771429, 58.63994286, 67.90217143, 77.1644, 86.42662857,
+    95.68885714, 104.95108571, 114.21331429, 123.47554286, 132.73777143, 142.
+};
+
+static const double ref_cst_chn_y[] = {
+    -0.0178831, -0.01753701, -0.01681944, -0.01530936, -0.0133346, -0.01188188,
+    -0.01064578, -0.0094633, -0.008383, -0.00741476, -0.00653003, -0.00569933,
+    -0.00490387, -0.00413532, -0.00338581, -0.00264728, -0.00190919, -0.00115921,
+    -0.00038495, 0.00042524, 0.0012678, 0.00212467, 0.00297723, 0.00381115,
+    0.00463958, 0.00548639, 0.00637547, 0.00732847, 0.00836314, 0.00949486,
+    0.0106894, 0.01186556, 0.01331466, 0.01548235, 0.0166216, 0.01761142
+};
+
+typedef struct
+{
+    antenna_type_e ant;
+    const double *x;
+    const double *y;
+    int n;
+} ref_lut_t;
+
+#define REF_LUT(a, t) {a, ref_##t##_x, ref_##t##_y, sizeof(ref_##t##_x) / sizeof(ref_##t##_x[0])}
+
+static const ref_lut_t luts[] = {
+    {ANT_TYPE_NONE, NULL, NULL, 0},
+    REF_LUT(ANT_TYPE_MONALISA5, mon_ch5),
+    REF_LUT(ANT_TYPE_MONALISA9, mon_ch9),
+    REF_LUT(ANT_TYPE_JOLIE5, jolie_ch5),
+    REF_LUT(ANT_TYPE_JOLIE9, jolie_ch9),
+    REF_LUT(ANT_TYPE_CUSTOM, cst_chn),
+};
+
+/* The rx_ctx of a peer: the window follows struct avrg_s */
+typedef struct
+{
+    struct avrg_s s;
+    int32_t buf[AVRG_MAX];
+} avrg_ctx_t;
+
+/* The O(N) average of the fixed point code before the running sums */
+typedef struct
+{
+    uint8_t lcnt;
+    uint8_t max_cnt;
+    uint8_t avrg_max;
+    uint8_t mode;
+    int32_t prev_avrg;
+    int32_t avrg[AVRG_MAX];
+} ref_avrg_t;
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/* @brief the PDoA moved out of the board, deg */
+static double ref_shift(double pdoa_deg, uint8_t chan)
+{
+    double shift = (chan == 5) ? PDOA_INTERVAL_SHIFT_CH5 : PDOA_INTERVAL_SHIFT_CH9;
+
+    return fmod(pdoa_deg - shift + 540.0, 360.0) + shift - 180.0;
+}
+
+static double ref_path_diff(const ref_lut_t *lut, double x)
+{
+    int i;
+
+    if (!lut->x)
+    {
+        return 0;
+    }
+    if (x < lut->x[0])
+    {
+        return lut->y[0];
+    }
+    /* at the last breakpoint too: the scan below would run past it */
+    if (x >= lut->x[lut->n - 1])
+    {
+        return lut->y[lut->n - 1];
+    }
+    for (i = 0; i < lut->n - 1; i++)
+    {
+        if (lut->x[i + 1] > x)
+        {
+            break;
+        }
+    }
+    return lut->y[i] + (x - lut->x[i]) * (lut->y[i + 1] - lut->y[i]) / (lut->x[i + 1] - lut->x[i]);
+}
+
+/* @brief AoA, deg, of the double precision code without averaging */
+static double ref_aoa(const ref_lut_t *lut, int32_t p_deg100, uint8_t chan, uint8_t corr_en, double *pdoa_deg)
+{
+    double p_diff_m, x;
+
+    *pdoa_deg = ref_shift(p_deg100 / 100.0, chan);
+    if (corr_en)
+    {
+        p_diff_m = ref_path_diff(lut, *pdoa_deg);
+    }
+    else
+    {
+        p_diff_m = *pdoa_deg / 360.0 * ((chan == 5) ? L_M_5 : L_M_9);
+    }
+    x = p_diff_m / D_M_JL;
+    return atan2(x, (fabs(x) < 1.0) ? sqrt(1.0 - x * x) : 0.0) * 180.0 / M_PI;
+}
+
+/* @brief the PDoA of fpdoa2aoa() before the average, deg*100 */
+static int32_t ref_wrap(int32_t p_deg100, uint8_t chan, int32_t prev_avrg)
+{
+    int32_t shift = (chan == 5) ? (int32_t)(PDOA_INTERVAL_SHIFT_CH5 * 100) : (int32_t)(PDOA_INTERVAL_SHIFT_CH9 * 100);
+    int32_t p = ((p_deg100 - shift + 54000) % 36000) + shift - 18000;
+
+    if ((abs(p / 100) > 130) && ((int64_t)p * prev_avrg < 0))
+    {
+        p = p_deg100;
+    }
+    return p;
+}
+
+/* @brief the linear average, rescanning the window */
+static int32_t ref_avrg_linear(ref_avrg_t *p, int32_t v)
+{
+    int32_t accum = 0;
+    int tmp_cnt = 0;
+
+    if (p->lcnt >= p->avrg_max)
+    {
+        p->lcnt = 0;
+    }
+    p->max_cnt = (p->max_cnt < p->avrg_max) ? (p->max_cnt + 1) : (p->avrg_max);
+    p->avrg[p->lcnt] = v;
+    for (int i = 0; i < p->max_cnt; i++)
+    {
+        if (abs(v / 100) > 130)
+        {
+            if ((v < 0 && p->avrg[i] < 0) || (v >= 0 && p->avrg[i] >= 0))
+            {
+                accum += p->avrg[i];
+                tmp_cnt++;
+            }
+        }
+        else
+        {
+            accum += p->avrg[i];
+            tmp_cnt++;
+        }
+    }
+    accum = (accum >= 0) ? ((accum + tmp_cnt / 2) / tmp_cnt) : ((accum - tmp_cnt / 2) / tmp_cnt);
+    p->lcnt++;
+    p->prev_avrg = accum;
+    return accum;
+}
+
+/* @brief a - b on the circle, deg*100 in [-18000, 18000) */
+static int32_t diff_circ(int32_t a, int32_t b)
+{
+    return (((a - b) % 36000) + 54000) % 36000 - 18000;
+}
+
+/* @brief the circular mean of the window in double, deg*100 within 180 deg
+ *        of the new sample */
+static int32_t ref_avrg_circular(ref_avrg_t *p, int32_t v)
+{
+    double s = 0, c = 0;
+
+    if (p->lcnt >= p->avrg_max)
+    {
+        p->lcnt = 0;
+    }
+    p->max_cnt = (p->max_cnt < p->avrg_max) ? (p->max_cnt + 1) : (p->avrg_max);
+    p->avrg[p->lcnt] = v;
+    for (int i = 0; i < p->max_cnt; i++)
+    {
+        s += sin(p->avrg[i] * M_PI / 18000.0);
+        c += cos(p->avrg[i] * M_PI / 18000.0);
+    }
+    p->lcnt++;
+    p->prev_avrg = v + diff_circ((int32_t)lround(atan2(s, c) * 18000.0 / M_PI), v);
+    return p->prev_avrg;
+}
+
+static void set_antenna(antenna_type_e ant)
+{
+    get_rf_tuning_config()->antenna.port1 = ant;
+    pdoaupdate_lut();
+}
+
+/* Every 0.01 deg of PDoA, each antenna, channel and correction, no
+ * averaging: AoA within AOA_ERR_MAX_DEG of the double precision formulas */
+static void check_sweep(void)
+{
+    double err_max = 0;
+
+    for (unsigned l = 0; l < sizeof(luts) / sizeof(luts[0]); l++)
+    {
+        set_antenna(luts[l].ant);
+        for (uint8_t chan = 5; chan <= 9; chan += 4)
+        {
+            for (uint8_t corr = 0; corr <= 1; corr++)
+            {
+                for (int32_t p = -18000; p <= 18000; p++)
+                {
+                    struct fpdoa_in_s in = {.p_deg100 = p, .chan = chan, .corr_en = corr};
+                    avrg_ctx_t ctx = {0};
+                    struct pdoa_aoa_s out;
+                    double pdoa_deg, aoa, err;
+
+                    fpdoa2aoa(&in, &out, &ctx);
+                    aoa = ref_aoa(&luts[l], p, chan, corr, &pdoa_deg);
+                    err = fabs(out.aoa_q11 / 2048.0 * 180.0 / M_PI - aoa);
+                    if (err > err_max)
+                    {
+                        err_max = err;
+                    }
+                    if (err >= AOA_ERR_MAX_DEG)
+                    {
+                        fprintf(stderr, "antenna %d ch%d corr %d pdoa %d: aoa %f, %f\n", luts[l].ant, chan, corr, p,
+                                out.aoa_q11 / 2048.0 * 180.0 / M_PI, aoa);
+                    }
+                    CHECK(err < AOA_ERR_MAX_DEG);
+                    CHECK(abs(out.pdoa_q11 - (int16_t)(pdoa_deg * 2048 * M_PI / 180.0)) <= PDOA_ERR_MAX_Q11);
+                }
+            }
+        }
+    }
+    CHECK(err_max > 0);
+    printf("pdoa: AoA error at most %.3f deg\n", err_max);
+}
+
+/* @brief a PDoA walk, deg*100 in [-18000, 18000): noisy steps around a
+ *        drifting angle, at center to start */
+static void walk(int32_t *p, int n, int32_t center, int32_t noise)
+{
+    int32_t a = center;
+
+    for (int i = 0; i < n; i++)
+    {
+        a += (int32_t)(rnd() % 201) - 100;
+        p[i] = a + (int32_t)(rnd() % (2 * noise + 1)) - noise;
+        p[i] = ((p[i] % 36000) + 54000) % 36000 - 18000;
+    }
+}
+
+/* Walks through the window as it fills and wraps, around 0 and across
+ * +/-180 deg: the linear average equal to the O(N) loop, the circular one
+ * within CIRC_ERR_MAX_DEG100 of the double precision mean */
+static void check_average(void)
+{
+    static int32_t p[WALK_SAMPLES];
+    static const int32_t centers[] = {0, 9000, 17500, -17500, 18000};
+    static const int32_t noises[] = {200, 1500, 6000};
+    int32_t circ_err_max = 0;
+    uint32_t linear_mismatch = 0;
+
+    set_antenna(ANT_TYPE_JOLIE5);
+    for (uint8_t mode = PDOA_AVRG_LINEAR; mode <= PDOA_AVRG_CIRCULAR; mode++)
+    {
+        for (unsigned c = 0; c < sizeof(centers) / sizeof(centers[0]); c++)
+        {
+            for (unsigned z = 0; z < sizeof(noises) / sizeof(noises[0]); z++)
+            {
+                walk(p, WALK_SAMPLES, centers[c], noises[z]);
+                for (uint8_t w = 1; w <= AVRG_MAX; w++)
+                {
+                    for (uint8_t chan = 5; chan <= 9; chan += 4)
+                    {
+                        avrg_ctx_t ctx = {0};
+                        ref_avrg_t ref = {.avrg_max = w, .mode = mode};
+
+                        for (int i = 0; i < WALK_SAMPLES; i++)
+                        {
+                            struct fpdoa_in_s in = {.p_deg100 = p[i], .chan = chan, .corr_en = 1,
+                                                    .max_avrg = w, .avrg_mode = mode};
+                            struct pdoa_aoa_s out;
+                            int32_t v = ref_wrap(p[i], chan, ref.prev_avrg);
+
+                            fpdoa2aoa(&in, &out, &ctx);
+                            if (mode == PDOA_AVRG_LINEAR)
+                            {
+                                linear_mismatch += (ctx.s.prev_avrg != ref_avrg_linear(&ref, v));
+                            }
+                            else
+                            {
+                                int32_t err = abs(diff_circ(ctx.s.prev_avrg, ref_avrg_circular(&ref, v)));
+
+                                if (err > circ_err_max)
+                                {
+                                    circ_err_max = err;
+                                }
+                            }
+                        }
+                        CHECK_EQ(ctx.s.max_cnt, w);
+                    }
+                }
+            }
+        }
+    }
+    CHECK_EQ(linear_mismatch, 0);
+    CHECK(circ_err_max <= CIRC_ERR_MAX_DEG100);
+    printf("pdoa: circular mean error at most %d deg*100\n", circ_err_max);
+}
+
+/* Cycles per conversion: fpdoa2aoa() against the double precision code
+ * without averaging, and with the largest window against the O(N) loop.
+ * The host has a double FPU, the nRF52 has not: the gain on the target
+ * is larger than here. */
+static void bench(void)
+{
+    static int32_t p[1024];
+    volatile int32_t sink = 0;
+    uint64_t t0, t_fix, t_ref, t_avrg, t_loop;
+    avrg_ctx_t ctx = {0};
+    ref_avrg_t ref = {.avrg_max = AVRG_MAX};
+    double pdoa_deg;
+
+    set_antenna(ANT_TYPE_JOLIE5);
+    walk(p, 1024, 0, 6000);
+
+    t0 = test_cycles();
+    for (int i = 0; i < BENCH_CALLS; i++)
+    {
+        struct fpdoa_in_s in = {.p_deg100 = p[i & 1023], .chan = 5, .corr_en = 1};
+        struct pdoa_aoa_s out;
+
+        memset(&ctx, 0, sizeof(ctx.s));
+        fpdoa2aoa(&in, &out, &ctx);
+        sink += out.aoa_q11;
+    }
+    t_fix = test_cycles() - t0;
+
+    t0 = test_cycles();
+    for (int i = 0; i < BENCH_CALLS; i++)
+    {
+        sink += (int32_t)ref_aoa(&luts[3], p[i & 1023], 5, 1, &pdoa_deg);
+    }
+    t_ref = test_cycles() - t0;
+
+    memset(&ctx, 0, sizeof(ctx));
+    t0 = test_cycles();
+    for (int i = 0; i < BENCH_CALLS; i++)
+    {
+        struct fpdoa_in_s in = {.p_deg100 = p[i & 1023], .chan = 5, .corr_en = 1, .max_avrg = AVRG_MAX};
+        struct pdoa_aoa_s out;
+
+        fpdoa2aoa(&in, &out, &ctx);
+        sink += out.aoa_q11;
+    }
+    t_avrg = test_cycles() - t0;
+
+    t0 = test_cycles();
+    for (int i = 0; i < BENCH_CALLS; i++)
+    {
+        sink += ref_avrg_linear(&ref, ref_wrap(p[i & 1023], 5, ref.prev_avrg));
+    }
+    t_loop = test_cycles() - t0;
+
+    (void)sink;
+    printf("pdoa: cycles per call: fixed point %.0f, double %.0f; window of %d: fpdoa2aoa %.0f, O(N) average alone %.0f\n",
+           (double)t_fix / BENCH_CALLS, (double)t_ref / BENCH_CALLS, AVRG_MAX, (double)t_avrg / BENCH_CALLS,
+           (double)t_loop / BENCH_CALLS);
+}
+
+int main(void)
+{
+    check_sweep();
+    check_average();
+    bench();
+    return test_done("pdoa");
+}
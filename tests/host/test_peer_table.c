@@ -0,0 +1,272 @@
+/**
+ * @file    test_peer_table.c
+ *
+ * @brief   Peer table: addresses of one home slot, the probe wrapping past
+ *          the last slot, a full table, the records dropped by a reset and
+ *          the windows kept across one; random sessions against a plain
+ *          list of the peers
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <string.h>
+
+#include "test.h"
+#include "peer_table.h"
+#include "reporter.h"
+
+#define HASH_MUL        0x9E3779B1UL    /**< as peer_table.c */
+#define COLLIDING       6
+#define RANDOM_SESSIONS 2000
+#define RANDOM_OPS      200
+#define RANDOM_ADDRS    (3 * PEER_TABLE_MAX)
+
+static int lines;
+
+static error_e report_print(char *buff, int len)
+{
+    (void)buff;
+    (void)len;
+    lines++;
+    return _NO_ERR;
+}
+
+reporter_t reporter_instance = {.print = report_print};
+
+static uint32_t x = 1;
+
+static uint32_t rnd(void)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static uint32_t home(uint16_t addr)
+{
+    return (uint32_t)(addr * HASH_MUL) >> (32 - PEER_TABLE_SLOT_BITS);
+}
+
+/* @brief the first n addresses from 1 of home slot s */
+static void colliding(uint32_t s, uint16_t *addr, int n)
+{
+    for (uint32_t a = 1; n > 0 && a <= UINT16_MAX; a++)
+    {
+        if (home((uint16_t)a) == s)
+        {
+            *addr++ = (uint16_t)a;
+            n--;
+        }
+    }
+    CHECK_EQ(n, 0);
+}
+
+static void check_collisions(void)
+{
+    uint16_t last[COLLIDING + 1], first[COLLIDING];
+    peer_t *p[COLLIDING];
+
+    /* of the last slot, one of them not added: the probes wrap to the
+     * first slots, where those of the first slot go after them */
+    colliding(PEER_TABLE_SLOTS - 1, last, COLLIDING + 1);
+    colliding(0, first, COLLIDING);
+    peer_table_reset(false);
+    for (int i = 0; i < COLLIDING; i++)
+    {
+        p[i] = peer_table_add(last[i]);
+        CHECK(p[i] != NULL);
+        CHECK(peer_table_add(first[i]) != NULL);
+    }
+    CHECK_EQ(peer_table_count(), 2 * COLLIDING);
+    for (int i = 0; i < COLLIDING; i++)
+    {
+        CHECK(peer_table_find(last[i]) == p[i]);
+        CHECK_EQ(peer_table_find(last[i])->addr, last[i]);
+        CHECK_EQ(peer_table_find(first[i])->addr, first[i]);
+        CHECK(peer_table_add(last[i]) == p[i]);
+    }
+    CHECK(peer_table_find(last[COLLIDING]) == NULL);
+    CHECK_EQ(peer_table_count(), 2 * COLLIDING);
+
+    /* insertion order */
+    for (int i = 0; i < COLLIDING; i++)
+    {
+        CHECK_EQ(peer_table_get(2 * i)->addr, last[i]);
+        CHECK_EQ(peer_table_get(2 * i + 1)->addr, first[i]);
+    }
+}
+
+static void check_full(void)
+{
+    peer_t *p;
+
+    peer_table_reset(false);
+    for (int i = 0; i < PEER_TABLE_MAX; i++)
+    {
+        CHECK(peer_table_add((uint16_t)(0x100 + i)) != NULL);
+    }
+    CHECK_EQ(peer_table_count(), PEER_TABLE_MAX);
+
+    /* no room for another, the peers still found */
+    CHECK(peer_table_add(0x0001) == NULL);
+    CHECK(peer_table_find(0x0001) == NULL);
+    p = peer_table_add(0x100 + PEER_TABLE_MAX - 1);
+    CHECK(p != NULL && p == peer_table_get(PEER_TABLE_MAX - 1));
+    for (int i = 0; i < PEER_TABLE_MAX; i++)
+    {
+        CHECK(peer_table_find((uint16_t)(0x100 + i)) == peer_table_get(i));
+    }
+    CHECK(peer_table_get(-1) == NULL);
+    CHECK(peer_table_get(PEER_TABLE_MAX) == NULL);
+    CHECK_EQ(peer_table_count(), PEER_TABLE_MAX);
+
+    lines = 0;
+    peer_table_print();
+    CHECK_EQ(lines, 1 + PEER_TABLE_MAX);
+}
+
+static void check_reset(void)
+{
+    peer_t *p;
+
+    /* dropped: none found, added again from zero */
+    peer_table_reset(false);
+    p = peer_table_add(0x0A);
+    peer_table_measure(p, 3, 0, 1000);
+    p->sp1_rp.top = 5;
+    peer_table_add(0x0B)->sp1_rp.top = 6;
+    peer_table_add(0x0C)->sp1_rp.top = 7;
+
+    peer_table_reset(false);
+    CHECK_EQ(peer_table_count(), 0);
+    CHECK(peer_table_find(0x0A) == NULL);
+    CHECK(peer_table_get(0) == NULL);
+    p = peer_table_add(0x0A);
+    CHECK_EQ(p->sp1_rp.top, 0);
+    CHECK_EQ(p->n_ok, 0);
+    CHECK_EQ(p->flags, 0);
+    p->sp1_rp.top = 5;
+    peer_table_add(0x0B)->sp1_rp.top = 6;
+    peer_table_add(0x0C)->sp1_rp.top = 7;
+
+    /* kept: the windows of the peers of the last session only */
+    peer_table_reset(true);
+    CHECK_EQ(peer_table_count(), 0);
+    CHECK(peer_table_find(0x0C) == NULL);
+    CHECK_EQ(peer_table_add(0x0C)->sp1_rp.top, 7);
+    CHECK_EQ(peer_table_add(0x0D)->sp1_rp.top, 0);
+    CHECK_EQ(peer_table_add(0x0A)->sp1_rp.top, 5);
+    peer_table_reset(true);
+    CHECK_EQ(peer_table_add(0x0B)->sp1_rp.top, 0);  /**< not in the last session */
+    CHECK_EQ(peer_table_add(0x0A)->sp1_rp.top, 5);
+}
+
+static void check_measure(void)
+{
+    peer_t *p;
+
+    peer_table_reset(false);
+    p = peer_table_add(0x0A);
+    peer_table_measure(p, 1, 2, 5000);
+    CHECK_EQ(p->n_err, 1);
+    CHECK_EQ(p->flags & PEER_F_DIST, 0);
+    peer_table_measure(p, 2, 0, 1000);
+    CHECK_EQ(p->dist_mm, 1000);
+    peer_table_measure(p, 3, 0, 2000);
+    CHECK_EQ(p->dist_mm, 1250);
+    peer_table_measure(p, 4, 0, 250);
+    CHECK_EQ(p->dist_mm, 1000);
+    CHECK_EQ(p->n_ok, 3);
+    CHECK_EQ(p->last_block, 4);
+}
+
+/* Sessions of random peers, reset with or without their windows, against
+ * the list of the peers of the session and of the last one */
+static void check_random(void)
+{
+    uint16_t cur[PEER_TABLE_MAX], prev[PEER_TABLE_MAX];
+    uint32_t cur_top[PEER_TABLE_MAX], prev_top[PEER_TABLE_MAX];
+    int n_cur = 0, n_prev = 0;
+    uint32_t mark = 0;
+
+    peer_table_reset(false);
+    for (int s = 0; s < RANDOM_SESSIONS; s++)
+    {
+        int ops = 1 + rnd() % RANDOM_OPS;
+
+        for (int o = 0; o < ops; o++)
+        {
+            uint16_t addr = (uint16_t)(1 + rnd() % RANDOM_ADDRS);
+            int i = 0;
+            peer_t *p;
+
+            while (i < n_cur && cur[i] != addr)
+            {
+                i++;
+            }
+            if (rnd() & 1)
+            {
+                p = peer_table_find(addr);
+                CHECK((p != NULL) == (i < n_cur));
+                CHECK(!p || p == peer_table_get(i));
+                continue;
+            }
+
+            p = peer_table_add(addr);
+            if (i < n_cur)
+            {
+                CHECK(p == peer_table_get(i));
+            }
+            else if (n_cur == PEER_TABLE_MAX)
+            {
+                CHECK(p == NULL);
+            }
+            else
+            {
+                uint32_t top = 0;
+
+                for (int k = 0; k < n_prev; k++)
+                {
+                    top = (prev[k] == addr) ? prev_top[k] : top;
+                }
+                CHECK(p != NULL && p == peer_table_get(n_cur));
+                if (p)
+                {
+                    CHECK_EQ(p->addr, addr);
+                    CHECK_EQ(p->sp1_rp.top, top);
+                    p->sp1_rp.top = ++mark;
+                }
+                cur[n_cur] = addr;
+                cur_top[n_cur++] = mark;
+            }
+        }
+        CHECK_EQ(peer_table_count(), n_cur);
+
+        if (rnd() % 4)
+        {
+            memcpy(prev, cur, sizeof(cur));
+            memcpy(prev_top, cur_top, sizeof(cur_top));
+            n_prev = n_cur;
+            peer_table_reset(true);
+        }
+        else
+        {
+            n_prev = 0;
+            peer_table_reset(false);
+        }
+        n_cur = 0;
+    }
+}
+
+int main(void)
+{
+    check_collisions();
+    check_full();
+    check_reset();
+    check_measure();
+    check_random();
+    peer_table_reset(false);
+    return test_done("peer_table");
+}
@@ -0,0 +1,227 @@
+/**
+ * @file    test_rx_regs.c
+ *
+ * @brief   The result registers of a frame, read by the RX ISR in block
+ *          reads: the count of reads per frame, and latchStats() against the
+ *          per-field accessors of the driver
+ *
+ * @author  Development Team
+ *
+ */
+
+#include "test.h"
+#include "host_rtos.h"
+#include "host_uwb.h"
+#include "mcps_mock.h"
+#include "dw3000_sim.h"
+#include "dw3000_statistics.h"
+#include "linux/skbuff.h"
+#include "net/mcps802154.h"
+
+#define FRAME_LEN   20          /**< FCS included */
+#define AT_DTU      1000
+#define ROUNDS      10
+#define DECODES     64
+
+static dwt_config_t phy = {
+    .chan = 9,
+    .txPreambLength = DWT_PLEN_64,
+    .rxPAC = DWT_PAC8,
+    .txCode = 9,
+    .rxCode = 9,
+    .sfdType = DWT_SFD_IEEE_4Z,
+    .dataRate = DWT_BR_6M8,
+    .phrMode = DWT_PHRMODE_STD,
+    .phrRate = DWT_PHRRATE_STD,
+    .sfdTO = (64 + 1 + 8 - 8),
+    .stsMode = DWT_STS_MODE_OFF,
+    .stsLength = DWT_STS_LEN_64,
+    .pdoaMode = DWT_PDOA_M1,
+};
+static dwt_txconfig_t tx_phy;
+static rxtx_configure_t rxtx = {.pdwCfg = &phy, .txConfig = &tx_phy};
+static dwt_mcps_config_t conf = {.rxtx_config = &rxtx};
+
+static const uint8_t frame[FRAME_LEN] = {0x41, 0x88, 0x01, 0xCA, 0xDE};
+
+static uint32_t seed = 1;
+
+static uint32_t lcg(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+/* @brief the result registers of frame i, signed fields both ways */
+static void fill(dw3000_sim_frame_t *ev, uint32_t i, bool random)
+{
+    ev->type = DW3000_SIM_RX_OK;
+    ev->data = frame;
+    ev->len = FRAME_LEN;
+    ev->cfo = (int16_t)(random ? (int32_t)(lcg() & 0x1FFF) - 0x1000 : 100 + (int32_t)i);
+    ev->pdoa = (int16_t)(random ? (int32_t)(lcg() & 0x3FFF) - 0x2000 : -1500 + 100 * (int32_t)i);
+    ev->sts_qual = (int16_t)(random ? (int32_t)(lcg() & 0xFFF) - 0x800 : 40 + (int32_t)i);
+    ev->dgc = (uint8_t)(random ? lcg() % 7 : i % 7);
+    ev->index_fp = (uint16_t)(random ? lcg() : 0x2F00 + 8 * i);
+    ev->fp_ampl = random ? lcg() & 0x3FFFFF : 12000 + i;
+    ev->cir_power = random ? lcg() & 0x1FFFF : 600 + i;
+    ev->accum = (uint16_t)(random ? lcg() & 0xFFF : 64);
+}
+
+/* @brief one frame received and taken by the MAC */
+static void receive(struct dwchip_s *dw, dw3000_sim_frame_t *ev)
+{
+    struct mcps802154_rx_frame_config rx_cfg = {.timeout_dtu = -1};
+
+    CHECK_EQ(dw->mcps_ops->rx_enable(dw->llhw, &rx_cfg, 0, 0), 0);
+    ev->at_dtu = dw3000_sim_now(dw) + AT_DTU;
+    CHECK_EQ(dw3000_sim_script(dw, ev, 1), 1);
+    dw3000_sim_advance(dw, 2 * AT_DTU);
+    host_threads_run();
+}
+
+/* @brief ROUNDS frames with STS and the diagnostics on or off: the reads of
+ *        the result registers per frame, and the values the MAC gets
+ *
+ * @return SPI accesses per frame, ISR and MCPS task
+ */
+static uint32_t check_rx(struct dwchip_s *dw, bool sts, bool diag)
+{
+    struct mcps_diag_s *d = &dw->mcps_runtime->diag;
+    mcps_rx_ring_stats_t r0, r1;
+    mcps_mock_stats_t m0, m1;
+    dw3000_sim_stats_t s;
+
+    phy.stsMode = sts ? DWT_STS_MODE_1 : DWT_STS_MODE_OFF;
+    d->enable = diag;
+    dw3000_mcps_get_rx_ring_stats(&r0);
+    mcps_mock_get_stats(&m0);
+    dw3000_sim_reset_stats(dw);
+
+    for (uint32_t i = 0; i < ROUNDS; i++)
+    {
+        dw3000_sim_frame_t ev = {0};
+
+        fill(&ev, i, false);
+        d->pending = false;
+        receive(dw, &ev);
+
+        mcps_mock_get_stats(&m1);
+        CHECK_EQ(m1.info.ranging_offset_rctu, ev.cfo);
+        CHECK_EQ(d->pending, diag);
+        if (diag)
+        {
+            CHECK_EQ(d->raw.cir[0].f[0], ev.fp_ampl);
+            CHECK_EQ(d->raw.cir[0].cir_power, ev.cir_power);
+            CHECK_EQ(d->raw.cir[0].accum_count, ev.accum);
+            CHECK_EQ(d->raw.index_fp, ev.index_fp);
+            CHECK_EQ(d->raw.dgc_decision, ev.dgc);
+            CHECK_EQ(d->raw.sts_on, sts);
+        }
+    }
+
+    dw3000_mcps_get_rx_ring_stats(&r1);
+    mcps_mock_get_stats(&m1);
+    dw3000_sim_get_stats(dw, &s);
+    CHECK_EQ(m1.rx_frames - m0.rx_frames, ROUNDS);
+    CHECK_EQ(r1.frames - r0.frames, ROUNDS);
+    /* PDOA and CFO, STS quality, CIR of STS and DGC decision */
+    CHECK_EQ(r1.reg_reads - r0.reg_reads, ROUNDS * (1 + sts + 2 * diag));
+    return s.xfers / ROUNDS;
+}
+
+/* @brief the block reads decode as the driver's per-field accessors */
+static void check_decode(struct dwchip_s *dw)
+{
+    const struct dwt_ops_s *ops = dw->dwt_driver->dwt_ops;
+    static const int types[3] = {IPATOV, STS1, STS2};
+
+    phy.stsMode = DWT_STS_MODE_1;
+    dw->mcps_runtime->diag.enable = false;
+    for (uint32_t i = 0; i < DECODES; i++)
+    {
+        struct dwt_mcps_rx_regs_s regs;
+        dw3000_sim_frame_t ev = {0};
+        dwt_nlos_ipdiag_t ip = {0};
+        dw3000_sim_stats_t s0, s1;
+        int16_t v;
+        uint8_t dgc;
+        int n;
+
+        fill(&ev, i, true);
+        receive(dw, &ev);
+
+        dw3000_sim_get_stats(dw, &s0);
+        n = latchStats(dw, &regs, true);
+        dw3000_sim_get_stats(dw, &s1);
+        CHECK_EQ(n, 4);
+        CHECK_EQ(s1.xfers - s0.xfers, (uint32_t)n);
+
+        ops->ioctl(dw, DWT_READCLOCKOFFSET, 0, &v);
+        CHECK_EQ(regs.cfo, v);
+        CHECK_EQ(regs.cfo, ev.cfo);
+        ops->ioctl(dw, DWT_READPDOA, 0, &v);
+        CHECK_EQ(regs.pdoa, v);
+        ops->ioctl(dw, DWT_READSTSQUALITY, 0, &v);
+        CHECK_EQ(regs.sts_qual, v);
+        ops->ioctl(dw, DWT_GETDGCDECISION, 0, &dgc);
+        CHECK_EQ(regs.raw.dgc_decision, dgc);
+        ops->ioctl(dw, DWT_NLOS_IPDIAG, 0, &ip);
+        CHECK_EQ(regs.raw.index_fp, ip.index_fp_u32);
+        CHECK_EQ(regs.raw.index_pp, ip.index_pp_u32);
+        for (int k = 0; k < 3; k++)
+        {
+            dwt_nlos_alldiag_t all = {.diag_type = types[k]};
+
+            ops->ioctl(dw, DWT_NLOS_ALLDIAG, 0, &all);
+            CHECK_EQ(regs.raw.cir[k].accum_count, all.accumCount);
+            CHECK_EQ(regs.raw.cir[k].f[0], all.F1);
+            CHECK_EQ(regs.raw.cir[k].f[1], all.F2);
+            CHECK_EQ(regs.raw.cir[k].f[2], all.F3);
+            CHECK_EQ(regs.raw.cir[k].cir_power, all.cir_power);
+        }
+        CHECK(regs.diag);
+        CHECK(regs.raw.sts_on);
+        CHECK(regs.raw.prf64);
+    }
+
+    /* STS off: PDOA and CFO only */
+    phy.stsMode = DWT_STS_MODE_OFF;
+    {
+        struct dwt_mcps_rx_regs_s regs;
+
+        CHECK_EQ(latchStats(dw, &regs, false), 1);
+        CHECK_EQ(regs.sts_qual, 0);
+        CHECK(!regs.diag);
+    }
+}
+
+int main(void)
+{
+    uint32_t xfers[2][2];
+    struct dwchip_s *dw;
+
+    dw = host_uwb_open(&conf);
+    CHECK(dw != NULL);
+    CHECK_EQ(dw->mcps_ops->start(dw->llhw), 0);
+    mcps_mock_set_rx_flags(MCPS802154_RX_FRAME_INFO_TIMESTAMP_DTU | MCPS802154_RX_FRAME_INFO_RANGING_OFFSET);
+
+    for (int sts = 0; sts < 2; sts++)
+    {
+        for (int diag = 0; diag < 2; diag++)
+        {
+            xfers[sts][diag] = check_rx(dw, sts, diag);
+        }
+    }
+    /* nothing else per field, on the ISR side or the task side */
+    CHECK_EQ(xfers[0][1] - xfers[0][0], 2);
+    CHECK_EQ(xfers[1][1] - xfers[1][0], 2);
+    CHECK_EQ(xfers[1][0] - xfers[0][0], 1);
+
+    check_decode(dw);
+
+    phy.stsMode = DWT_STS_MODE_OFF;
+    dw->mcps_ops->stop(dw->llhw);
+    host_uwb_close(dw);
+    return test_done("rx_regs");
+}
@@ -0,0 +1,189 @@
+/**
+ * @file    test_servo.c
+ *
+ * @brief   HAL_servo.c on the recording backend: period, jitter, slew
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdlib.h>
+
+#include "test.h"
+#include "host_rtos.h"
+#include "servo_mock.h"
+#include "HAL_servo.h"
+#include "custom_board.h"
+
+#define PERIOD_US   20000
+
+/* The PWM backend is not on the host: the tests must select the mock */
+static bool pwm_init(uint32_t pin, uint16_t period_us)
+{
+    (void)pin;
+    (void)period_us;
+    return false;
+}
+
+static void pwm_set_pulse(uint16_t pulse_us)
+{
+    (void)pulse_us;
+}
+
+static void pwm_stop(void)
+{
+}
+
+const struct hal_servo_backend_s ServoPwm = {pwm_init, pwm_set_pulse, pwm_stop};
+
+/* Every edge on the grid of the first one: no period error, no jitter */
+static void check_grid(const servo_mock_pulse_t *p, int n, uint64_t t0)
+{
+    uint64_t worst = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        uint64_t off = (p[i].t_us - t0) % PERIOD_US;
+
+        off = (off > PERIOD_US / 2) ? PERIOD_US - off : off;
+        worst = (off > worst) ? off : worst;
+        if (i > 0)
+        {
+            CHECK_EQ(p[i].t_us - p[i - 1].t_us, PERIOD_US);
+        }
+    }
+    CHECK_EQ(worst, 0);
+}
+
+int main(void)
+{
+    const servo_mock_pulse_t *p;
+    uint64_t t0;
+    int n;
+
+    HAL_servo_set_backend(&ServoMock);
+    HAL_servo_init();
+    CHECK(HAL_servo_is_ready());
+    CHECK_EQ(servo_mock_pin(), SERVO_PWM_PIN);
+    CHECK_EQ(servo_mock_period_us(), PERIOD_US);
+
+    /* idle until the first position */
+    host_time_advance_us(100000);
+    CHECK_EQ(servo_mock_pulses(&p), 0);
+
+    /* a position set at any time: one pulse per period from then on */
+    host_time_advance_us(3217);
+    t0 = host_time_us();
+    HAL_servo_set_position(1200);
+    host_time_advance_us(1000000);
+    n = servo_mock_pulses(&p);
+    CHECK_EQ(n, 51);
+    CHECK_EQ(p[0].t_us, t0);
+    check_grid(p, n, t0);
+    for (int i = 0; i < n; i++)
+    {
+        CHECK_EQ(p[i].width_us, 1200);
+    }
+
+    /* a change mid-period is output from the next boundary, same grid */
+    servo_mock_clear();
+    host_time_advance_us(7500);
+    HAL_servo_set_position(1800);
+    host_time_advance_us(200000);
+    n = servo_mock_pulses(&p);
+    CHECK_EQ(n, 10);
+    check_grid(p, n, t0);
+    for (int i = 0; i < n; i++)
+    {
+        CHECK_EQ(p[i].width_us, 1800);
+    }
+
+    /* out of range widths are clamped */
+    HAL_servo_set_position(500);
+    CHECK_EQ(HAL_servo_get_position(), 1000);
+    HAL_servo_set_position(2500);
+    CHECK_EQ(HAL_servo_get_position(), 2000);
+    HAL_servo_move_to_position(SERVO_POS_MIN);
+    CHECK_EQ(HAL_servo_get_position(), SERVO_POS_MIN);
+
+    /* ramp 1000 -> 2000 at 500 us/s: 10 us per period, about 2 s */
+    host_time_advance_us(60000);
+    servo_mock_clear();
+    HAL_servo_move_smooth(2000, 500);
+    CHECK(HAL_servo_is_moving());
+    host_time_advance_us(2100000);
+    CHECK(!HAL_servo_is_moving());
+    CHECK_EQ(HAL_servo_get_position(), 2000);
+    n = servo_mock_pulses(&p);
+    check_grid(p, n, t0);
+    {
+        int first_2000 = -1;
+
+        for (int i = 1; i < n; i++)
+        {
+            CHECK(p[i].width_us >= p[i - 1].width_us);
+            CHECK(p[i].width_us - p[i - 1].width_us <= 10);
+            if (first_2000 < 0 && p[i].width_us == 2000)
+            {
+                first_2000 = i;
+            }
+        }
+        /* 100 steps, each at most a period late */
+        CHECK(first_2000 >= 100 && first_2000 <= 102);
+        /* slew over any second within the bound */
+        for (int i = 50; i < n; i++)
+        {
+            CHECK(p[i].width_us - p[i - 50].width_us <= 500);
+        }
+    }
+
+    /* retargeted mid-ramp: turns back from where it is */
+    servo_mock_clear();
+    HAL_servo_move_smooth(1000, 2000);
+    host_time_advance_us(200000);
+    {
+        uint16_t mid = HAL_servo_get_position();
+
+        CHECK(HAL_servo_is_moving());
+        CHECK(mid < 2000 && mid > 1000);
+        HAL_servo_move_smooth(1800, 1000);
+        host_time_advance_us(20000);
+        CHECK(HAL_servo_get_position() > mid);
+        CHECK(HAL_servo_get_position() - mid <= 20);
+    }
+    host_time_advance_us(1000000);
+    CHECK(!HAL_servo_is_moving());
+    CHECK_EQ(HAL_servo_get_position(), 1800);
+    n = servo_mock_pulses(&p);
+    check_grid(p, n, t0);
+    for (int i = 1; i < n; i++)
+    {
+        CHECK(abs(p[i].width_us - p[i - 1].width_us) <= 40);
+    }
+
+    /* a position set cancels the ramp */
+    HAL_servo_move_smooth(2000, 100);
+    host_time_advance_us(100000);
+    HAL_servo_set_position(1300);
+    CHECK(!HAL_servo_is_moving());
+    host_time_advance_us(500000);
+    CHECK_EQ(HAL_servo_get_position(), 1300);
+
+    /* stop: the period under way ends, then nothing */
+    HAL_servo_stop();
+    CHECK(!servo_mock_running());
+    servo_mock_clear();
+    host_time_advance_us(500000);
+    CHECK_EQ(servo_mock_pulses(&p), 0);
+
+    /* and a new position starts a new grid */
+    host_time_advance_us(1111);
+    t0 = host_time_us();
+    HAL_servo_set_position(1500);
+    host_time_advance_us(100000);
+    n = servo_mock_pulses(&p);
+    CHECK_EQ(n, 6);
+    check_grid(p, n, t0);
+
+    return test_done("servo");
+}
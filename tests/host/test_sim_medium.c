@@ -0,0 +1,127 @@
+/**
+ * @file    test_sim_medium.c
+ *
+ * @brief   DW3000 models joined by the simulated radio medium: time of
+ *          flight, loss, path latency, NLOS, PDOA and CFO of each link, in
+ *          the chip time of each node
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdlib.h>
+
+#include "test.h"
+#include "dw3000_sim_medium.h"
+#include "dw3000_statistics.h"
+#include "deca_device_api.h"
+
+#define NODES           12
+#define CLOCK_STEP_DTU  100000      /**< chip time of node i at medium time 0: i steps */
+#define PPM_STEP_X100   100         /**< crystal of node i: i ppm */
+#define TX_AT_DTU       500000
+#define RUN_DTU         1000000
+#define STEP_DTU        25000
+#define FRAME_LEN       20
+#define CM_PER_RCTU     0.46917     /**< c x 15.65 ps */
+#define NODE_NLOS       3
+#define NODE_LOST       5
+#define NODE_PDOA       2
+#define NODE_LATE       7
+#define PDOA            500
+#define LATENCY_RCTU    1000
+
+static struct dwchip_s chips[NODES];
+static int n_rx[NODES];
+static uint64_t rx_ts[NODES];
+static int16_t cfo[NODES], pdoa[NODES];
+static struct mcps_diag_s diag[NODES];
+
+/* @brief the timestamp and the result registers of the node */
+static void rx_ok(const dwt_cb_data_t *d)
+{
+    const struct dwt_ops_s *ops = d->dw->dwt_driver->dwt_ops;
+    int i = (int)(d->dw - chips);
+    struct mcps_diag_raw_s *raw = &diag[i].raw;
+    dwt_nlos_alldiag_t all = {.diag_type = IPATOV};
+    dwt_nlos_ipdiag_t ip = {0};
+
+    n_rx[i]++;
+    rx_ts[i] = d->dw->dwt_driver->dwt_mcps_ops->get_timestamp(d->dw);
+    ops->ioctl(d->dw, DWT_READCLOCKOFFSET, 0, &cfo[i]);
+    ops->ioctl(d->dw, DWT_READPDOA, 0, &pdoa[i]);
+
+    ops->ioctl(d->dw, DWT_NLOS_ALLDIAG, 0, &all);
+    ops->ioctl(d->dw, DWT_NLOS_IPDIAG, 0, &ip);
+    raw->cir[0] = (struct mcps_diag_cir_s){all.accumCount, {all.F1, all.F2, all.F3}, all.cir_power};
+    raw->index_fp = ip.index_fp_u32;
+    raw->index_pp = ip.index_pp_u32;
+    raw->dgc_decision = all.D;
+    raw->prf64 = 1;
+    raw->dw3000 = 1;
+    diag[i].pending = true;
+    calculateStats(&diag[i]);
+}
+
+int main(void)
+{
+    static const uint8_t frame[FRAME_LEN] = {0x41, 0x88, 0x03};
+    struct dw_tx_frame_info_s tx_info = {.tx_date_dtu = TX_AT_DTU, .flag = DWT_START_TX_DELAYED};
+    struct dw_rx_frame_info_s rx_info = {0};
+    dw3000_medium_stats_t st;
+
+    dw3000_medium_init(42);
+    for (int i = 0; i < NODES; i++)
+    {
+        CHECK_EQ(dw3000_medium_add(&chips[i], i * CLOCK_STEP_DTU, i * PPM_STEP_X100), i);
+        chips[i].callbacks.cbRxOk = rx_ok;
+    }
+    for (int i = 1; i < NODES; i++)
+    {
+        dw3000_medium_link_t l = {
+            .distance_cm = 100u * i,
+            .nlos = (i == NODE_NLOS),
+            .loss_pct = (i == NODE_LOST) ? 100 : 0,
+            .pdoa = (i == NODE_PDOA) ? PDOA : 0,
+            .latency_rctu = (i == NODE_LATE) ? LATENCY_RCTU : 0,
+        };
+
+        dw3000_medium_set_link(0, i, &l);
+        chips[i].dwt_driver->dwt_mcps_ops->rx_enable(&chips[i], &rx_info);
+    }
+
+    /* node 0 sends, all the others listen */
+    CHECK_EQ(chips[0].dwt_driver->dwt_mcps_ops->tx_frame(&chips[0], (uint8_t *)frame, FRAME_LEN, &tx_info), 0);
+    CHECK(dw3000_medium_run(RUN_DTU, STEP_DTU) >= NODES - 1);
+
+    dw3000_medium_get_stats(&st);
+    CHECK_EQ(st.sent, 1);
+    CHECK_EQ(st.delivered, NODES - 2);
+    CHECK_EQ(st.lost, 1);
+    CHECK_EQ(n_rx[0], 0);
+    CHECK_EQ(n_rx[NODE_LOST], 0);
+
+    for (int i = 1; i < NODES; i++)
+    {
+        uint64_t tx_rctu = (uint64_t)(TX_AT_DTU + i * CLOCK_STEP_DTU) * DW3000_SIM_RCTU_PER_DTU;
+        int64_t tof;
+
+        if (i == NODE_LOST)
+        {
+            continue;
+        }
+        CHECK_EQ(n_rx[i], 1);
+        /* the time of flight in the receiver's clock, to 1 cm */
+        tof = (int64_t)(rx_ts[i] - tx_rctu) - ((i == NODE_LATE) ? LATENCY_RCTU : 0);
+        CHECK(abs((int)(tof * CM_PER_RCTU) - 100 * i) <= 1);
+
+        CHECK_EQ(pdoa[i], (i == NODE_PDOA) ? PDOA : 0);
+        CHECK_EQ(diag[i].nlos_pct, (i == NODE_NLOS) ? 100 : 0);
+        /* the receivers' crystals are i ppm faster than the sender's */
+        CHECK(cfo[i] < 0);
+        CHECK(abs(cfo[i] - i * cfo[1]) <= i);
+    }
+
+    dw3000_medium_init(1);
+    return test_done("sim_medium");
+}
@@ -0,0 +1,174 @@
+/**
+ * @file    test_skb_pool.c
+ *
+ * @brief   The frame path of dw3000_mcps_mcu.c on the DW3000 model: no heap
+ *          call per frame once ranging runs, RX nor deep sleep TX
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <string.h>
+
+#include "test.h"
+#include "host_rtos.h"
+#include "host_heap.h"
+#include "host_uwb.h"
+#include "mcps_mock.h"
+#include "skb_pool.h"
+#include "dw3000_sim.h"
+#include "linux/skbuff.h"
+
+#define ROUNDS      100
+#define WARMUP      3
+#define FRAME_LEN   20                  /**< FCS included */
+#define RX_AT_DTU   1000
+#define TX_IN_DTU   US_TO_DTU(10000)    /**< well past the deep sleep wake up */
+#define HELD_MAX    16                  /**< more than the pool holds */
+
+static dwt_config_t phy = {
+    .chan = 9,
+    .txPreambLength = DWT_PLEN_64,
+    .rxPAC = DWT_PAC8,
+    .txCode = 9,
+    .rxCode = 9,
+    .sfdType = DWT_SFD_IEEE_4Z,
+    .dataRate = DWT_BR_6M8,
+    .phrMode = DWT_PHRMODE_STD,
+    .phrRate = DWT_PHRRATE_STD,
+    .sfdTO = (64 + 1 + 8 - 8),
+    .stsMode = DWT_STS_MODE_OFF,
+    .stsLength = DWT_STS_LEN_64,
+    .pdoaMode = DWT_PDOA_M1,
+};
+static dwt_txconfig_t tx_phy;
+static rxtx_configure_t rxtx = {.pdwCfg = &phy, .txConfig = &tx_phy};
+static dwt_mcps_config_t conf = {.rxtx_config = &rxtx};
+
+static const uint8_t frame[FRAME_LEN] = {0x41, 0x88, 0x01, 0xCA, 0xDE};
+
+static uint32_t now_dtu(struct dwchip_s *dw)
+{
+    uint32_t ts = 0;
+
+    CHECK_EQ(dw->mcps_ops->get_current_timestamp_dtu(dw->llhw, &ts), 0);
+    return ts;
+}
+
+/* A frame received, then one sent from deep sleep */
+static void round_trip(struct dwchip_s *dw, struct sk_buff *tx)
+{
+    const struct mcps802154_ops *ops = dw->mcps_ops;
+    struct mcps802154_rx_frame_config rx_cfg = {.timeout_dtu = -1};
+    struct mcps802154_tx_frame_config tx_cfg = {.flags = MCPS802154_TX_FRAME_CONFIG_TIMESTAMP_DTU};
+    dw3000_sim_frame_t ev = {.type = DW3000_SIM_RX_OK, .data = frame, .len = FRAME_LEN};
+    int steps = 0;
+
+    CHECK_EQ(ops->rx_enable(dw->llhw, &rx_cfg, 0, 0), 0);
+    ev.at_dtu = dw3000_sim_now(dw) + RX_AT_DTU;
+    CHECK_EQ(dw3000_sim_script(dw, &ev, 1), 1);
+    dw3000_sim_advance(dw, 2 * RX_AT_DTU);
+    host_threads_run();
+
+    tx_cfg.timestamp_dtu = now_dtu(dw) + TX_IN_DTU;
+    CHECK_EQ(ops->tx_frame(dw->llhw, tx, &tx_cfg, 0, 0), 0);
+    CHECK(host_fs_timer_armed());
+    /* DEEP_SLEEP, WAKE_UP, INIT_RC, IDLE_RC, then the TX */
+    while (host_fs_timer_armed() && steps < 8)
+    {
+        CHECK(host_fs_timer_fire());
+        steps++;
+    }
+    CHECK_EQ(steps, 5);
+    dw3000_sim_advance(dw, TX_IN_DTU);
+    host_threads_run();
+}
+
+int main(void)
+{
+    host_heap_stats_t h0, h1;
+    skb_pool_stats_t p0, p1;
+    mcps_mock_stats_t m0, m1;
+    dw3000_sim_stats_t s;
+    struct dwchip_s *dw;
+    struct sk_buff *tx;
+    uint16_t len;
+
+    dw = host_uwb_open(&conf);
+    CHECK(dw != NULL);
+    CHECK_EQ(dw->mcps_ops->start(dw->llhw), 0);
+
+    /* the MAC's TX frame, room for the FCS the chip appends */
+    tx = alloc_skb(FRAME_LEN, GFP_KERNEL);
+    CHECK(tx != NULL);
+    skb_put_data(tx, frame, FRAME_LEN - FCS_LEN);
+
+    for (int i = 0; i < WARMUP; i++)
+    {
+        round_trip(dw, tx);
+    }
+
+    host_heap_get_stats(&h0);
+    skb_pool_get_stats(&p0);
+    mcps_mock_get_stats(&m0);
+    dw3000_sim_reset_stats(dw);
+
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        round_trip(dw, tx);
+    }
+
+    host_heap_get_stats(&h1);
+    skb_pool_get_stats(&p1);
+    mcps_mock_get_stats(&m1);
+    dw3000_sim_get_stats(dw, &s);
+
+    /* every frame went through, each with its sk_buff */
+    CHECK_EQ(m1.rx_frames - m0.rx_frames, ROUNDS);
+    CHECK_EQ(m1.rx_bytes - m0.rx_bytes, ROUNDS * (FRAME_LEN - FCS_LEN));
+    CHECK_EQ(m1.tx_done - m0.tx_done, ROUNDS);
+    CHECK_EQ(s.tx, ROUNDS);
+    CHECK_EQ(s.rx_ok, ROUNDS);
+    CHECK(dw3000_sim_last_tx(dw, &len) != NULL);
+    CHECK_EQ(len, FRAME_LEN);
+
+    /* from the pool, not the heap */
+    CHECK_EQ(h1.mallocs - h0.mallocs, 0);
+    CHECK_EQ(h1.frees - h0.frees, 0);
+    CHECK_EQ(p1.allocs - p0.allocs, 2 * ROUNDS);
+    CHECK_EQ(p1.used, 0);
+    CHECK_EQ(p1.exhausted, 0);
+    CHECK(p1.hwm <= 2);
+
+    /* pool empty: the TX goes without deep sleep, from the MAC's sk_buff */
+    {
+        struct sk_buff *held[HELD_MAX];
+        struct mcps802154_tx_frame_config tx_cfg = {.flags = MCPS802154_TX_FRAME_CONFIG_TIMESTAMP_DTU};
+        int n = 0;
+
+        while (n < HELD_MAX && (held[n] = skb_pool_alloc()) != NULL)
+        {
+            n++;
+        }
+        CHECK_EQ((uint32_t)n, p1.size);
+        host_heap_get_stats(&h0);
+        tx_cfg.timestamp_dtu = now_dtu(dw) + TX_IN_DTU;
+        CHECK_EQ(dw->mcps_ops->tx_frame(dw->llhw, tx, &tx_cfg, 0, 0), 0);
+        CHECK(!host_fs_timer_armed());
+        skb_pool_get_stats(&p1);
+        CHECK_EQ(p1.exhausted, 2);
+        dw3000_sim_advance(dw, TX_IN_DTU);
+        host_threads_run();
+        host_heap_get_stats(&h1);
+        CHECK_EQ(h1.mallocs - h0.mallocs, 0);
+        while (n > 0)
+        {
+            skb_pool_free(held[--n]);
+        }
+    }
+
+    kfree_skb(tx);
+    dw->mcps_ops->stop(dw->llhw);
+    host_uwb_close(dw);
+    return test_done("skb_pool");
+}
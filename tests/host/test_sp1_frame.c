@@ -0,0 +1,252 @@
+/**
+ * @file    test_sp1_frame.c
+ *
+ * @brief   SP1 frames: the anti-replay window against a reference set, the
+ *          nonce of each sender and direction, tampered frames, the session
+ *          key and the windows of the peers across a session run again
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <string.h>
+
+#include "test.h"
+#include "sp1_frame.h"
+#include "peer_table.h"
+#include "mcps_crypto.h"
+#include "reporter.h"
+
+#define SESSION_ID      0x12345678UL
+#define RANDOM_CTRS     200000
+#define RANDOM_SPAN     3000
+#define RANDOM_RUN      5000        /**< counters per window, from empty */
+#define CTR_BASE        100
+#define CTRL_ADDR       0x0001
+#define PEER_A          0x0010
+#define PEER_B          0x0020
+#define PEER_C          0x0030
+#define BENCH_FRAMES    2000
+
+static const uint8_t key[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+static const uint8_t vupper64[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+/* AES-CMAC(key, {1, "SP1 payload", 0, SESSION_ID LE, vupper64, 0x0080}),
+ * from OpenSSL */
+static const uint8_t session_key[SP1_KEY_LEN] = {0x87, 0xf3, 0xee, 0xfa, 0x47, 0xcf, 0xec, 0x74,
+                                                 0x30, 0x5a, 0x29, 0x52, 0x4d, 0x6a, 0x1e, 0x82};
+
+static const uint8_t payload[6] = {'B', 'T', 'N', 7, 1, 2};
+
+static error_e report_print(char *buff, int len)
+{
+    (void)buff;
+    (void)len;
+    return _NO_ERR;
+}
+
+reporter_t reporter_instance = {.print = report_print};
+
+/* @brief ctr accepted by rp, as sp1_frame_open() does after the MIC */
+static bool accept(sp1_replay_t *rp, uint32_t ctr)
+{
+    if (!sp1_replay_check(rp, ctr))
+    {
+        return false;
+    }
+    sp1_replay_update(rp, ctr);
+    return true;
+}
+
+static void check_window(void)
+{
+    static uint8_t seen[CTR_BASE + RANDOM_SPAN];
+    sp1_replay_t rp = {0}, w = {0};
+    uint32_t x = 1, top = 0;
+    bool any = false;
+
+    /* replays, reordered within the window, 63 and 64 back, a jump */
+    CHECK(accept(&rp, 5));
+    CHECK(!accept(&rp, 5));
+    CHECK(accept(&rp, 10));
+    CHECK(accept(&rp, 8));
+    CHECK(!accept(&rp, 8));
+    CHECK(accept(&rp, 100));
+    CHECK(accept(&rp, 100 - (SP1_REPLAY_WINDOW - 1)));
+    CHECK(!accept(&rp, 100 - SP1_REPLAY_WINDOW));
+    CHECK(accept(&rp, 1000));
+    CHECK(accept(&rp, 999));
+    CHECK(!accept(&rp, 1000));
+    CHECK_EQ(rp.top, 1000);
+
+    /* past 0xFFFFFFFF */
+    CHECK(accept(&w, 0xFFFFFFF0UL));
+    CHECK(accept(&w, 0xFFFFFFFFUL));
+    CHECK(accept(&w, 0));
+    CHECK(accept(&w, 3));
+    CHECK(accept(&w, 0xFFFFFFF5UL));
+    CHECK(!accept(&w, 0xFFFFFFFFUL));
+    CHECK(!accept(&w, 0));
+    CHECK_EQ(w.top, 3);
+    CHECK(!accept(&w, 3u - SP1_REPLAY_WINDOW));
+    CHECK(accept(&w, 3u - (SP1_REPLAY_WINDOW - 1)));
+
+    /* random counters against the set of those accepted */
+    memset(&rp, 0, sizeof(rp));
+    for (int i = 0; i < RANDOM_CTRS; i++)
+    {
+        uint32_t c;
+        bool want;
+
+        if (i % RANDOM_RUN == 0)
+        {
+            memset(seen, 0, sizeof(seen));
+            memset(&rp, 0, sizeof(rp));
+            any = false;
+        }
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        c = CTR_BASE + x % RANDOM_SPAN;
+        want = !seen[c] && (!any || c > top || top - c < SP1_REPLAY_WINDOW);
+        CHECK_EQ(accept(&rp, c), want);
+        if (want)
+        {
+            seen[c] = 1;
+            top = (!any || c > top) ? c : top;
+            any = true;
+        }
+    }
+}
+
+static void check_frames(void *ctx)
+{
+    uint8_t f[sizeof(payload) + SP1_FRAME_OVERHEAD], g[sizeof(f)], out[sizeof(payload)];
+    sp1_replay_t rp = {0};
+    uint32_t ctr, d0;
+
+    CHECK_EQ(sp1_frame_seal(ctx, 42, CTRL_ADDR, SP1_DIR_DOWN, payload, sizeof(payload), f, sizeof(f)),
+             (int)sizeof(f));
+    CHECK_EQ(sp1_frame_seal(ctx, 42, CTRL_ADDR, SP1_DIR_DOWN, payload, sizeof(payload), f, sizeof(f) - 1),
+             SP1_E_SHORT);
+
+    /* one decryption, none for the replay */
+    d0 = sp1_frame_decrypts();
+    CHECK_EQ(sp1_frame_open(ctx, &rp, CTRL_ADDR, SP1_DIR_DOWN, f, sizeof(f), out, &ctr), (int)sizeof(payload));
+    CHECK_EQ(ctr, 42);
+    CHECK(memcmp(out, payload, sizeof(payload)) == 0);
+    CHECK_EQ(sp1_frame_open(ctx, &rp, CTRL_ADDR, SP1_DIR_DOWN, f, sizeof(f), out, &ctr), SP1_E_REPLAY);
+    CHECK_EQ(sp1_frame_decrypts() - d0, 1);
+
+    /* the same counter from another sender, or the other way: another
+     * nonce, another key stream, and not the MIC of the controller's */
+    CHECK_EQ(sp1_frame_seal(ctx, 42, PEER_A, SP1_DIR_UP, payload, sizeof(payload), g, sizeof(g)),
+             (int)sizeof(g));
+    CHECK(memcmp(&f[SP1_CTR_LEN], &g[SP1_CTR_LEN], sizeof(payload)) != 0);
+    CHECK_EQ(sp1_frame_seal(ctx, 42, CTRL_ADDR, SP1_DIR_UP, payload, sizeof(payload), g, sizeof(g)),
+             (int)sizeof(g));
+    CHECK(memcmp(&f[SP1_CTR_LEN], &g[SP1_CTR_LEN], sizeof(payload)) != 0);
+    memset(&rp, 0, sizeof(rp));
+    CHECK_EQ(sp1_frame_open(ctx, &rp, PEER_A, SP1_DIR_DOWN, f, sizeof(f), out, &ctr), SP1_E_AUTH);
+    CHECK_EQ(sp1_frame_open(ctx, &rp, CTRL_ADDR, SP1_DIR_UP, f, sizeof(f), out, &ctr), SP1_E_AUTH);
+    CHECK_EQ(rp.bitmap, 0);
+
+    /* a tampered counter or ciphertext, the window left as it was */
+    CHECK_EQ(sp1_frame_open(ctx, &rp, CTRL_ADDR, SP1_DIR_DOWN, f, sizeof(f), out, &ctr), (int)sizeof(payload));
+    sp1_frame_seal(ctx, 43, CTRL_ADDR, SP1_DIR_DOWN, payload, sizeof(payload), g, sizeof(g));
+    g[1] ^= 1;
+    CHECK_EQ(sp1_frame_open(ctx, &rp, CTRL_ADDR, SP1_DIR_DOWN, g, sizeof(g), out, &ctr), SP1_E_AUTH);
+    CHECK_EQ(rp.top, 42);
+    g[1] ^= 1;
+    g[SP1_CTR_LEN] ^= 0x80;
+    CHECK_EQ(sp1_frame_open(ctx, &rp, CTRL_ADDR, SP1_DIR_DOWN, g, sizeof(g), out, &ctr), SP1_E_AUTH);
+    CHECK_EQ(out[0], 0);
+    g[SP1_CTR_LEN] ^= 0x80;
+    CHECK_EQ(sp1_frame_open(ctx, &rp, CTRL_ADDR, SP1_DIR_DOWN, g, sizeof(g), out, &ctr), (int)sizeof(payload));
+    CHECK_EQ(rp.top, 43);
+    CHECK_EQ(sp1_frame_open(ctx, &rp, CTRL_ADDR, SP1_DIR_DOWN, g, SP1_FRAME_OVERHEAD, out, &ctr), SP1_E_SHORT);
+}
+
+static void check_session_key(void)
+{
+    uint8_t other[8] = {1, 2, 3, 4, 5, 6, 7, 9};
+    uint8_t k1[SP1_KEY_LEN];
+
+    CHECK_EQ(sp1_frame_session_key(key, SESSION_ID, vupper64), 1);
+    CHECK(memcmp(sp1_frame_key(), session_key, SP1_KEY_LEN) == 0);
+    CHECK_EQ(sp1_frame_tx_next(), 1);
+    CHECK_EQ(sp1_frame_tx_next(), 2);
+
+    /* the same session again: the counter goes on */
+    CHECK_EQ(sp1_frame_session_key(key, SESSION_ID, vupper64), 0);
+    CHECK_EQ(sp1_frame_tx_next(), 3);
+
+    /* another vUpper64 or session ID: another key, the counter from 1 */
+    CHECK_EQ(sp1_frame_session_key(key, SESSION_ID, other), 1);
+    memcpy(k1, sp1_frame_key(), SP1_KEY_LEN);
+    CHECK(memcmp(k1, session_key, SP1_KEY_LEN) != 0);
+    CHECK_EQ(sp1_frame_tx_next(), 1);
+    CHECK_EQ(sp1_frame_session_key(key, SESSION_ID + 1, other), 1);
+    CHECK(memcmp(k1, sp1_frame_key(), SP1_KEY_LEN) != 0);
+}
+
+/* @brief the windows of the peers across a session run again */
+static void check_peer_windows(void *ctx)
+{
+    uint8_t f[sizeof(payload) + SP1_FRAME_OVERHEAD], out[sizeof(payload)];
+    peer_t *a, *b;
+    uint32_t ctr;
+
+    peer_table_reset(false);
+    a = peer_table_add(PEER_A);
+    b = peer_table_add(PEER_B);
+    sp1_frame_seal(ctx, 7, PEER_A, SP1_DIR_UP, payload, sizeof(payload), f, sizeof(f));
+    CHECK_EQ(sp1_frame_open(ctx, &a->sp1_rp, PEER_A, SP1_DIR_UP, f, sizeof(f), out, &ctr), (int)sizeof(payload));
+    b->sp1_rp.top = 9;
+    b->sp1_rp.bitmap = 1;
+    a->n_sp1 = 1;
+
+    /* same key, the peers in another order with a new one: each keeps its
+     * own window, the frame of the last run stays a replay */
+    peer_table_reset(true);
+    CHECK(peer_table_add(PEER_C) != NULL);
+    b = peer_table_add(PEER_B);
+    a = peer_table_add(PEER_A);
+    CHECK_EQ(peer_table_count(), 3);
+    CHECK_EQ(peer_table_find(PEER_C)->sp1_rp.bitmap, 0);
+    CHECK_EQ(b->sp1_rp.top, 9);
+    CHECK_EQ(a->sp1_rp.top, 7);
+    CHECK_EQ(a->n_sp1, 0);
+    CHECK_EQ(sp1_frame_open(ctx, &a->sp1_rp, PEER_A, SP1_DIR_UP, f, sizeof(f), out, &ctr), SP1_E_REPLAY);
+
+    /* a new key: all empty */
+    peer_table_reset(false);
+    a = peer_table_add(PEER_A);
+    CHECK_EQ(a->sp1_rp.bitmap, 0);
+    peer_table_reset(false);
+}
+
+int main(void)
+{
+    sp1_bench_t res[2];
+    void *ctx;
+
+    check_window();
+
+    ctx = mcps_crypto_aead_aes_ccm_star_128_create(key);
+    CHECK(ctx != NULL);
+    check_frames(ctx);
+    check_peer_windows(ctx);
+    mcps_crypto_aead_aes_ccm_star_128_destroy(ctx);
+
+    check_session_key();
+
+    /* SP1BENCH: one decryption per frame accepted, each delivered once */
+    CHECK_EQ(sp1_frame_bench(BENCH_FRAMES, res), 0);
+    CHECK_EQ(res[0].decrypts, res[0].accepted);
+    CHECK_EQ(res[0].accepted + res[0].replays, res[0].delivered);
+    CHECK(res[1].decrypts > res[1].accepted);
+
+    return test_done("sp1_frame");
+}
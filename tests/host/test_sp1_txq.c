@@ -0,0 +1,348 @@
+/**
+ * @file    test_sp1_txq.c
+ *
+ * @brief   SP1 message queue: priorities, order, repacking in a block,
+ *          eviction, TLV parsing; then two devices sending their queues and
+ *          transports sealed per frame over a lossy link, each repack sealed
+ *          again under a counter of its own
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "sp1_txq.h"
+#include "sp1_xport.h"
+#include "sp1_frame.h"
+#include "mcps_crypto.h"
+
+#define ADDR_A          0x0001      /**< the controller */
+#define ADDR_B          0x0002
+#define LINK_BLOCKS     20000
+#define LOSS_ONE_IN     10
+#define BTN_ONE_IN      10
+#define TELEM_ONE_IN    3
+#define TELEM_LEN       20
+#define BLOB_LEN        4096
+#define BENCH_BLOCKS    20000
+
+static const uint8_t key[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+static uint8_t v[SP1_TXQ_VAL_MAX + 1] = {1, 2, 3};
+
+/* @brief fill of a frame with an XPORT TLV of the room left, 8 bytes at least */
+static int fill_room(void *arg, uint32_t block, uint8_t *buf, int room)
+{
+    static const uint8_t z[SP1_TXQ_VAL_MAX];
+
+    (void)arg;
+    (void)block;
+    return (room - SP1_TLV_HDR_LEN >= 8) ? sp1_tlv_put(buf, room, SP1_TLV_XPORT, z, room - SP1_TLV_HDR_LEN) : 0;
+}
+
+/* @brief types of the TLVs of a frame, their count */
+static int parse(const uint8_t *f, int n, uint8_t *types)
+{
+    const uint8_t *p = f, *val;
+    uint8_t type, len;
+    int k = 0, r;
+
+    while ((r = sp1_tlv_next(&p, f + n, &type, &val, &len)) == 1)
+    {
+        types[k++] = type;
+    }
+    CHECK_EQ(r, 0);
+    return k;
+}
+
+static void check_queue(void)
+{
+    static sp1_txq_t q;
+    uint8_t f[SP1_TXQ_FRAME_MAX], ty[SP1_TXQ_SLOTS + 2];
+    int n;
+
+    /* urgent first, each priority in order */
+    sp1_txq_init(&q);
+    CHECK_EQ(sp1_txq_push(&q, 0, SP1_TLV_TELEM, v, 12), 0);
+    CHECK_EQ(sp1_txq_push(&q, 0, SP1_TLV_TELEM, v, 13), 0);
+    CHECK_EQ(sp1_txq_push(&q, 0, SP1_TLV_BTN, v, 3), 0);
+    CHECK(sp1_txq_pending(&q));
+    n = sp1_txq_pack(&q, 1, f, sizeof(f), NULL, NULL);
+    CHECK_EQ(n, 5 + 14 + 15);
+    CHECK_EQ(parse(f, n, ty), 3);
+    CHECK_EQ(ty[0], SP1_TLV_BTN);
+    CHECK_EQ(ty[1], SP1_TLV_TELEM);
+    CHECK_EQ(f[5 + 1], 12);
+    CHECK(!sp1_txq_pending(&q));
+
+    /* packed again in the block: the new message joins, the others stay,
+     * the fill takes the rest */
+    CHECK_EQ(sp1_txq_push(&q, 0, SP1_TLV_BTN, v, 3), 0);
+    n = sp1_txq_pack(&q, 1, f, sizeof(f), fill_room, NULL);
+    CHECK_EQ(n, SP1_TXQ_FRAME_MAX);
+    CHECK_EQ(parse(f, n, ty), 5);
+    CHECK_EQ(ty[0], SP1_TLV_BTN);
+    CHECK_EQ(ty[1], SP1_TLV_BTN);
+    CHECK_EQ(ty[4], SP1_TLV_XPORT);
+
+    /* the block over: its messages sent */
+    CHECK_EQ(sp1_txq_push(&q, 1, SP1_TLV_BTN, v, 3), 0);
+    CHECK_EQ(q.st.sent[SP1_TXQ_URGENT], 2);
+    CHECK_EQ(q.st.sent[SP1_TXQ_NORMAL], 2);
+    CHECK_EQ(q.st.delay_max[SP1_TXQ_URGENT], 1);
+    CHECK_EQ(sp1_txq_pack(&q, 2, f, sizeof(f), NULL, NULL), 5);
+
+    /* a message that does not fit holds the smaller ones behind it, the
+     * lower priority fills in */
+    sp1_txq_init(&q);
+    sp1_txq_push(&q, 0, SP1_TLV_TELEM, v, 40);
+    sp1_txq_push(&q, 0, SP1_TLV_TELEM, v, 40);
+    sp1_txq_push(&q, 0, SP1_TLV_TELEM, v, 5);
+    sp1_txq_push(&q, 0, SP1_TLV_XPORT, v, 10);
+    n = sp1_txq_pack(&q, 1, f, sizeof(f), NULL, NULL);
+    CHECK_EQ(n, 42 + 12);
+    CHECK_EQ(parse(f, n, ty), 2);
+    CHECK_EQ(ty[0], SP1_TLV_TELEM);
+    CHECK_EQ(ty[1], SP1_TLV_XPORT);
+    n = sp1_txq_pack(&q, 2, f, sizeof(f), NULL, NULL);
+    CHECK_EQ(n, 42 + 7);
+    CHECK_EQ(parse(f, n, ty), 2);
+    sp1_txq_pack(&q, 3, f, sizeof(f), NULL, NULL);
+    CHECK_EQ(q.st.delay_max[SP1_TXQ_NORMAL], 2);
+
+    /* full: a message takes the slot of a lower priority, or fails */
+    sp1_txq_init(&q);
+    for (int i = 0; i < SP1_TXQ_SLOTS; i++)
+    {
+        CHECK_EQ(sp1_txq_push(&q, 0, (i < 8) ? SP1_TLV_XPORT : SP1_TLV_TELEM, v, 4), 0);
+    }
+    CHECK_EQ(sp1_txq_push(&q, 0, SP1_TLV_TELEM, v, 4), 0);
+    CHECK_EQ(q.st.dropped[SP1_TXQ_BULK], 1);
+    CHECK_EQ(sp1_txq_push(&q, 0, SP1_TLV_BTN, v, 4), 0);
+    CHECK_EQ(q.st.dropped[SP1_TXQ_BULK], 2);
+    for (int i = 0; i < 6; i++)
+    {
+        sp1_txq_push(&q, 0, SP1_TLV_TELEM, v, 4);
+    }
+    CHECK_EQ(q.st.dropped[SP1_TXQ_BULK], 8);
+    CHECK_EQ(sp1_txq_push(&q, 0, SP1_TLV_TELEM, v, 4), SP1_TXQ_E_FULL);
+    CHECK_EQ(q.st.dropped[SP1_TXQ_NORMAL], 1);
+    CHECK_EQ(sp1_txq_push(&q, 0, SP1_TLV_BTN, v, 4), 0);
+    CHECK_EQ(sp1_txq_push(&q, 0, SP1_TLV_XPORT, v, 0), SP1_TXQ_E_SIZE);
+    CHECK_EQ(sp1_txq_push(&q, 0, SP1_TLV_XPORT, v, SP1_TXQ_VAL_MAX + 1), SP1_TXQ_E_SIZE);
+
+    /* the largest value fills the frame */
+    sp1_txq_init(&q);
+    CHECK_EQ(sp1_txq_push(&q, 0, SP1_TLV_TELEM, v, SP1_TXQ_VAL_MAX), 0);
+    CHECK_EQ(sp1_txq_pack(&q, 1, f, sizeof(f), fill_room, NULL), SP1_TXQ_FRAME_MAX);
+
+    /* truncated TLVs */
+    {
+        static const uint8_t b[] = {SP1_TLV_BTN, 5, 0, 0}, c[] = {SP1_TLV_BTN};
+        const uint8_t *p = b, *val;
+        uint8_t type, len;
+
+        CHECK_EQ(sp1_tlv_next(&p, b + sizeof(b), &type, &val, &len), -1);
+        p = c;
+        CHECK_EQ(sp1_tlv_next(&p, c + sizeof(c), &type, &val, &len), -1);
+    }
+}
+
+/* A device: its queue, its transport and the transport frame of its block,
+ * as fira_app.c holds them */
+typedef struct
+{
+    sp1_txq_t q;
+    sp1_xport_t *x;
+    uint16_t addr;
+    uint8_t dir;
+    sp1_replay_t rp;        /**< of the frames of the other device */
+    uint8_t xp_frame[SP1_TXQ_VAL_MAX];
+    int xp_len;
+    uint32_t xp_block;
+    uint32_t last_ctr;
+    int btn_rx;
+    int msgs;
+    int corrupt;
+} node_t;
+
+static int fill_xport(void *arg, uint32_t block, uint8_t *buf, int room)
+{
+    node_t *n = arg;
+
+    if (n->xp_len <= 0 || block != n->xp_block)
+    {
+        int max = room - SP1_TLV_HDR_LEN;
+
+        n->xp_len = sp1_xport_build(n->x, block, n->xp_frame, (max < (int)sizeof(n->xp_frame)) ? max : (int)sizeof(n->xp_frame));
+        n->xp_block = block;
+    }
+    return (n->xp_len > 0) ? sp1_tlv_put(buf, room, SP1_TLV_XPORT, n->xp_frame, n->xp_len) : 0;
+}
+
+static void on_msg(uint16_t src, const uint8_t *msg, uint16_t len, void *arg)
+{
+    node_t *n = arg;
+
+    (void)src;
+    for (int i = 0; i < len; i++)
+    {
+        if (msg[i] != (uint8_t)(i * 7))
+        {
+            n->corrupt++;
+            return;
+        }
+    }
+    n->msgs++;
+}
+
+/* @brief frame of n for block, packed and sealed as data_task does: each
+ *        packing under the next counter */
+static int send(node_t *n, void *ctx, uint32_t block, uint8_t *frame, int max)
+{
+    uint8_t plain[SP1_TXQ_FRAME_MAX];
+    uint32_t ctr;
+    int len = sp1_txq_pack(&n->q, block, plain, sizeof(plain), fill_xport, n);
+
+    if (len <= 0)
+    {
+        return 0;
+    }
+    ctr = sp1_frame_tx_next();
+    CHECK((int32_t)(ctr - n->last_ctr) > 0);
+    n->last_ctr = ctr;
+    return sp1_frame_seal(ctx, ctr, n->addr, n->dir, plain, (uint16_t)len, frame, (uint16_t)max);
+}
+
+static void receive(node_t *n, const node_t *src, void *ctx, const uint8_t *frame, int flen)
+{
+    uint8_t plain[SP1_TXQ_FRAME_MAX];
+    const uint8_t *p = plain, *val;
+    uint8_t type, len;
+    uint32_t ctr;
+    int plen, r;
+
+    plen = sp1_frame_open(ctx, &n->rp, src->addr, src->dir, frame, (uint16_t)flen, plain, &ctr);
+    CHECK(plen > 0);
+    while ((r = sp1_tlv_next(&p, plain + plen, &type, &val, &len)) == 1)
+    {
+        if (type == SP1_TLV_BTN)
+        {
+            CHECK_EQ(len, 3);
+            n->btn_rx++;
+        }
+        else if (type == SP1_TLV_XPORT)
+        {
+            sp1_xport_rx(n->x, src->addr, val, len);
+        }
+    }
+    CHECK_EQ(r, 0);
+}
+
+static void check_link(void)
+{
+    static node_t a, b;
+    static uint8_t big[BLOB_LEN];
+    uint8_t fa[SP1_TXQ_FRAME_MAX + SP1_FRAME_OVERHEAD], fb[sizeof(fa)], first[sizeof(fa)];
+    uint32_t x = 1, btn = 0, resealed = 0;
+    void *ctx;
+
+    for (int i = 0; i < BLOB_LEN; i++)
+    {
+        big[i] = (uint8_t)(i * 7);
+    }
+    ctx = mcps_crypto_aead_aes_ccm_star_128_create(key);
+    a.x = malloc(SP1_XPORT_SIZE(BLOB_LEN, BLOB_LEN));
+    b.x = malloc(SP1_XPORT_SIZE(BLOB_LEN, BLOB_LEN));
+    a.addr = ADDR_A;
+    a.dir = SP1_DIR_DOWN;
+    b.addr = ADDR_B;
+    b.dir = SP1_DIR_UP;
+    sp1_txq_init(&a.q);
+    sp1_txq_init(&b.q);
+    sp1_xport_init(a.x, ADDR_A, BLOB_LEN, BLOB_LEN, on_msg, &a);
+    sp1_xport_init(b.x, ADDR_B, BLOB_LEN, BLOB_LEN, on_msg, &b);
+
+    for (uint32_t blk = 1; blk < LINK_BLOCKS; blk++)
+    {
+        int na, nb;
+
+        x = x * 1103515245 + 12345;
+        if (!sp1_xport_tx_busy(a.x))
+        {
+            sp1_xport_send(a.x, ADDR_B, big, BLOB_LEN);
+        }
+        na = send(&a, ctx, blk, fa, sizeof(fa));
+
+        /* a message queued in the block: packed and sealed again, another
+         * counter, another key stream */
+        if ((x >> 16) % BTN_ONE_IN == 0)
+        {
+            int n0 = na;
+
+            memcpy(first, fa, sizeof(fa));
+            btn += (sp1_txq_push(&a.q, blk - 1, SP1_TLV_BTN, v, 3) == 0);
+            na = send(&a, ctx, blk, fa, sizeof(fa));
+            if (n0 > 0)
+            {
+                resealed++;
+                CHECK(memcmp(first, fa, SP1_CTR_LEN) != 0);
+            }
+        }
+        if ((x >> 20) % TELEM_ONE_IN == 0)
+        {
+            sp1_txq_push(&a.q, blk - 1, SP1_TLV_TELEM, v, TELEM_LEN);
+            na = send(&a, ctx, blk, fa, sizeof(fa));
+        }
+        nb = send(&b, ctx, blk, fb, sizeof(fb));
+
+        x = x * 1103515245 + 12345;
+        if (na > 0 && (x >> 16) % LOSS_ONE_IN)
+        {
+            receive(&b, &a, ctx, fa, na);
+        }
+        if (nb > 0 && (x >> 20) % LOSS_ONE_IN)
+        {
+            receive(&a, &b, ctx, fb, nb);
+        }
+    }
+
+    /* the presses on air, most of them received; the blobs through */
+    CHECK(resealed > 0);
+    CHECK_EQ(a.q.st.dropped[SP1_TXQ_URGENT], 0);
+    CHECK(a.q.st.sent[SP1_TXQ_URGENT] + 1 >= btn);
+    CHECK(b.btn_rx * 10 >= (int)btn * 8);
+    CHECK(b.msgs > 0);
+    CHECK_EQ(b.corrupt, 0);
+    CHECK(a.x->st.tx_fail * 20 < a.x->st.tx_msgs);
+
+    mcps_crypto_aead_aes_ccm_star_128_destroy(ctx);
+    free(a.x);
+    free(b.x);
+}
+
+static void check_bench(void)
+{
+    sp1_txq_bench_t r[2];
+
+    for (int pct = 10; pct <= 90; pct += 40)
+    {
+        CHECK_EQ(sp1_txq_bench(BENCH_BLOCKS, pct, r), 0);
+        /* no press lost, each out in its block; one payload per block loses some */
+        CHECK_EQ(r[0].lost[SP1_TXQ_URGENT], 0);
+        CHECK(r[0].delay_max[SP1_TXQ_URGENT] <= 1);
+        CHECK(r[1].lost[SP1_TXQ_URGENT] > 0);
+        CHECK(r[0].sent[SP1_TXQ_NORMAL] > r[1].sent[SP1_TXQ_NORMAL]);
+    }
+}
+
+int main(void)
+{
+    check_queue();
+    check_link();
+    check_bench();
+    return test_done("sp1_txq");
+}
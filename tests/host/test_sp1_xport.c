@@ -0,0 +1,223 @@
+/**
+ * @file    test_sp1_xport.c
+ *
+ * @brief   SP1 transport over lossy links: three devices on a broadcast
+ *          medium with loss, restarts and resets of either end, frames of
+ *          any size; malformed frames; SP1XBENCH against the loss rate
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "sp1_xport.h"
+
+#define ADDR_A          1
+#define ADDR_B          2
+#define ADDR_C          3
+#define BLOCKS          200000
+#define LOSS_PCT        15      /**< per receiver and frame */
+#define RESTART_ONE_IN  3000    /**< blocks */
+#define C_MSG_MAX       300     /**< C sends logs to A */
+#define FRAME_MIN       7
+#define FRAME_SPAN      66      /**< frames of FRAME_MIN to FRAME_MIN + FRAME_SPAN - 1 bytes */
+#define JUNK_FRAMES     100000
+#define JUNK_MAX        64
+#define BENCH_BLOCKS    20000
+#define BENCH_FRAME     72
+
+typedef struct
+{
+    uint32_t msgs;
+    uint32_t bytes;
+    uint32_t corrupt;
+} rx_t;
+
+static uint32_t seed = 7;
+
+static uint32_t rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static uint8_t pattern(uint32_t k, uint16_t len)
+{
+    return (uint8_t)((k * 131) ^ (k >> 8) ^ len);
+}
+
+static void on_msg(uint16_t src, const uint8_t *msg, uint16_t len, void *arg)
+{
+    rx_t *r = arg;
+
+    (void)src;
+    for (uint32_t k = 0; k < len; k++)
+    {
+        if (msg[k] != pattern(k, len))
+        {
+            r->corrupt++;
+            return;
+        }
+    }
+    r->msgs++;
+    r->bytes += len;
+}
+
+static void fill(uint8_t *msg, uint16_t len)
+{
+    for (uint32_t k = 0; k < len; k++)
+    {
+        msg[k] = pattern(k, len);
+    }
+}
+
+/* @brief frame of src to the two others, each losing LOSS_PCT percent */
+static void broadcast(sp1_xport_t *to1, sp1_xport_t *to2, uint16_t src, const uint8_t *f, int n)
+{
+    if (n <= 0)
+    {
+        return;
+    }
+    if (rnd() % 100 >= LOSS_PCT)
+    {
+        sp1_xport_rx(to1, src, f, n);
+    }
+    if (rnd() % 100 >= LOSS_PCT)
+    {
+        sp1_xport_rx(to2, src, f, n);
+    }
+}
+
+static void check_lossy(void)
+{
+    static uint8_t msg[SP1_XP_MSG_MAX];
+    uint8_t fa[UINT8_MAX], fb[UINT8_MAX], fc[UINT8_MAX], junk[JUNK_MAX];
+    rx_t ra = {0}, rb = {0}, rc = {0};
+    uint32_t sends_a = 0, sends_c = 0;
+    sp1_xport_t *a, *b, *c;
+
+    a = malloc(SP1_XPORT_SIZE(SP1_XP_MSG_MAX, SP1_XP_MSG_MAX));
+    b = malloc(SP1_XPORT_SIZE(SP1_XP_MSG_MAX, SP1_XP_MSG_MAX));
+    c = malloc(SP1_XPORT_SIZE(C_MSG_MAX, SP1_XP_MSG_MAX));
+    sp1_xport_init(a, ADDR_A, SP1_XP_MSG_MAX, SP1_XP_MSG_MAX, on_msg, &ra);
+    sp1_xport_init(b, ADDR_B, SP1_XP_MSG_MAX, SP1_XP_MSG_MAX, on_msg, &rb);
+    sp1_xport_init(c, ADDR_C, C_MSG_MAX, SP1_XP_MSG_MAX, on_msg, &rc);
+    CHECK_EQ(sp1_xport_send(c, ADDR_A, msg, C_MSG_MAX + 1), SP1_XP_E_SIZE);
+
+    for (uint32_t blk = 1; blk < BLOCKS; blk++)
+    {
+        int max = FRAME_MIN + rnd() % FRAME_SPAN;
+        int na, nb, nc;
+
+        /* A to B mostly, to C at times; C to A */
+        if (!sp1_xport_tx_busy(a))
+        {
+            uint16_t len = 1 + rnd() % SP1_XP_MSG_MAX;
+
+            fill(msg, len);
+            CHECK_EQ(sp1_xport_send(a, (rnd() % 4) ? ADDR_B : ADDR_C, msg, len), 0);
+            sends_a++;
+        }
+        if (!sp1_xport_tx_busy(c))
+        {
+            uint16_t len = 1 + rnd() % C_MSG_MAX;
+
+            fill(msg, len);
+            CHECK_EQ(sp1_xport_send(c, ADDR_A, msg, len), 0);
+            sends_c++;
+        }
+
+        /* B restarts and A sees it, as report_cb does; either end of a
+         * link resets on its own */
+        if (rnd() % RESTART_ONE_IN == 0)
+        {
+            sp1_xport_init(b, ADDR_B, SP1_XP_MSG_MAX, SP1_XP_MSG_MAX, on_msg, &rb);
+            sp1_xport_reset(a);
+        }
+        if (rnd() % RESTART_ONE_IN == 0)
+        {
+            sp1_xport_reset(a);
+        }
+        if (rnd() % RESTART_ONE_IN == 0)
+        {
+            sp1_xport_reset(b);
+        }
+
+        na = sp1_xport_build(a, blk, fa, max);
+        nb = sp1_xport_build(b, blk, fb, max);
+        nc = sp1_xport_build(c, blk, fc, max);
+        CHECK(na <= max && nb <= max && nc <= max);
+        broadcast(b, c, ADDR_A, fa, na);
+        broadcast(a, c, ADDR_B, fb, nb);
+        broadcast(a, b, ADDR_C, fc, nc);
+    }
+
+    /* every message delivered intact or given up, few given up */
+    CHECK_EQ(ra.corrupt + rb.corrupt + rc.corrupt, 0);
+    CHECK(a->st.tx_msgs + a->st.tx_fail <= sends_a);
+    CHECK(a->st.tx_msgs + a->st.tx_fail + 1 >= sends_a);
+    CHECK(a->st.tx_fail * 20 < a->st.tx_msgs);
+    CHECK(c->st.tx_fail * 20 < c->st.tx_msgs);
+    CHECK(c->st.tx_msgs + c->st.tx_fail + 1 >= sends_c);
+    CHECK(ra.msgs >= c->st.tx_msgs);
+    CHECK(rb.msgs + rc.msgs + 1 >= a->st.tx_msgs);
+    CHECK(a->st.tx_retx > 0);
+    CHECK(rb.msgs > 0 && rc.msgs > 0);
+
+    /* random frames for B: rejected or dropped, nothing delivered wrong */
+    for (int i = 0; i < JUNK_FRAMES; i++)
+    {
+        int n = rnd() % JUNK_MAX;
+
+        for (int k = 0; k < n; k++)
+        {
+            junk[k] = (uint8_t)rnd();
+        }
+        if (n > 2)
+        {
+            junk[1] = ADDR_B;
+            junk[2] = 0;
+        }
+        sp1_xport_rx(b, ADDR_A, junk, n);
+    }
+    CHECK_EQ(rb.corrupt, 0);
+
+    free(a);
+    free(b);
+    free(c);
+}
+
+static void check_bench(void)
+{
+    static const int loss[] = {0, 10, 30, 50};
+    sp1_xport_bench_t w16[4], w1[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK_EQ(sp1_xport_bench(BENCH_BLOCKS, loss[i], SP1_XP_WINDOW, BENCH_FRAME, &w16[i]), 0);
+        CHECK_EQ(sp1_xport_bench(BENCH_BLOCKS, loss[i], 1, BENCH_FRAME, &w1[i]), 0);
+        CHECK_EQ(w16[i].corrupt + w1[i].corrupt, 0);
+        CHECK(w16[i].ab_bytes > 0 && w16[i].ba_bytes > 0);
+        /* the window keeps the link busy while ACKs come back */
+        CHECK(w16[i].ab_bytes > w1[i].ab_bytes);
+        if (i > 0)
+        {
+            CHECK(w16[i].ab_bytes < w16[i - 1].ab_bytes);
+            CHECK(w16[i].ab_retx > w16[i - 1].ab_retx);
+        }
+    }
+    CHECK_EQ(w16[0].ab_retx, 0);
+    CHECK_EQ(w16[0].ab_fail, 0);
+}
+
+int main(void)
+{
+    check_lossy();
+    check_bench();
+    return test_done("sp1_xport");
+}
@@ -0,0 +1,233 @@
+/**
+ * @file    test_spi.c
+ *
+ * @brief   HAL_SPI.c on the recording SPIM: bytes on the wire, scatter and
+ *          gather of the segments, the flash bounce, bursts, DMA counts
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <string.h>
+
+#include "test.h"
+#include "gpio_mock.h"
+#include "spim_mock.h"
+#include "nrf_gpio.h"
+#include "HAL_SPI.h"
+
+#define CS_PIN      17
+#define BODY_LEN    100
+#define RX_LEN      127     /**< a frame */
+#define FLASH_LEN   40
+#define REG_READS   10
+
+static const spi_port_config_t port = {
+    .idx = 0, .cs = CS_PIN, .clk = 16, .mosi = 18, .miso = 19, .min_freq = 2000000, .max_freq = 32000000,
+};
+
+static const struct spi_s *spi;
+
+/* @brief the wire since the last reset holds tx at pos */
+static bool wire_is(uint32_t pos, const uint8_t *tx, uint32_t len)
+{
+    const uint8_t *mosi;
+    uint32_t n = spim_mock_wire(&mosi);
+
+    return pos + len <= n && memcmp(&mosi[pos], tx, len) == 0;
+}
+
+/* @brief rx holds the MISO bytes of the wire from pos */
+static bool miso_is(uint32_t pos, const uint8_t *rx, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if (rx[i] != spim_mock_miso(pos + i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void reset(spi_stats_t *st)
+{
+    spim_mock_reset(CS_PIN);
+    spi->get_stats(spi->handler, st);
+}
+
+/* @brief the counters of the port since reset() */
+static void delta(const spi_stats_t *st0, spi_stats_t *d)
+{
+    spi_stats_t st;
+
+    spi->get_stats(spi->handler, &st);
+    d->xfers = st.xfers - st0->xfers;
+    d->dma = st.dma - st0->dma;
+    d->bytes = st.bytes - st0->bytes;
+    d->copied = st.copied - st0->copied;
+    d->enables = st.enables - st0->enables;
+}
+
+static void check_read_write(void)
+{
+    static const uint8_t hdr[2] = {0x81, 0x02};
+    uint8_t rd[RX_LEN], body[BODY_LEN];
+    spim_mock_stats_t m;
+    spi_stats_t st0, d;
+    const uint8_t *mosi;
+
+    for (int i = 0; i < BODY_LEN; i++)
+    {
+        body[i] = (uint8_t)i;
+    }
+
+    /* a register: header and value in one DMA */
+    reset(&st0);
+    CHECK_EQ(spi->read(spi->handler, 1, hdr, 4, rd), 0);
+    delta(&st0, &d);
+    CHECK_EQ(d.xfers, 1);
+    CHECK_EQ(d.dma, 1);
+    CHECK_EQ(d.enables, 1);
+    CHECK_EQ(spim_mock_wire(&mosi), 5);
+    CHECK_EQ(mosi[0], 0x81);
+    CHECK_EQ(mosi[1], 0xFF);
+    CHECK(miso_is(1, rd, 4));
+    CHECK(!spim_mock_enabled());
+    CHECK_EQ(nrf_gpio_pin_read(CS_PIN), 1);
+
+    /* a frame: the header gathered, the body straight to the buffer */
+    reset(&st0);
+    CHECK_EQ(spi->read(spi->handler, 2, hdr, RX_LEN, rd), 0);
+    delta(&st0, &d);
+    CHECK_EQ(d.dma, 2);
+    CHECK_EQ(d.bytes, 2 + RX_LEN);
+    CHECK_EQ(d.copied, 2);
+    CHECK_EQ(spim_mock_wire(&mosi), 2 + RX_LEN);
+    CHECK(wire_is(0, hdr, 2));
+    CHECK(miso_is(2, rd, RX_LEN));
+
+    /* a write from RAM: no copy of the body */
+    reset(&st0);
+    CHECK_EQ(spi->write(spi->handler, 2, hdr, BODY_LEN, body), 0);
+    delta(&st0, &d);
+    CHECK_EQ(d.dma, 2);
+    CHECK_EQ(d.copied, 2);
+    CHECK(wire_is(0, hdr, 2));
+    CHECK(wire_is(2, body, BODY_LEN));
+
+    /* a write from flash: bounced through RAM */
+    for (int i = 0; i < FLASH_LEN; i++)
+    {
+        spim_mock_flash[i] = (uint8_t)(0xA0 + i);
+    }
+    reset(&st0);
+    CHECK_EQ(spi->write(spi->handler, 2, hdr, FLASH_LEN, spim_mock_flash), 0);
+    delta(&st0, &d);
+    CHECK_EQ(d.copied, 2 + FLASH_LEN);
+    CHECK(wire_is(2, spim_mock_flash, FLASH_LEN));
+
+    spim_mock_get_stats(&m);
+    CHECK_EQ(m.errors, 0);
+}
+
+static void check_segments(void)
+{
+    uint8_t h1 = 0x10, h2 = 0x20, a[4], b[4], big[50], fill[16] = {0};
+    spim_mock_stats_t m;
+    spi_stats_t st0, d;
+    const uint8_t *mosi;
+
+    /* small segments: gathered in one DMA, scattered back */
+    {
+        const spi_seg_t seg[] = {{&h1, NULL, 1}, {NULL, a, 4}, {&h2, NULL, 1}, {NULL, b, 4}};
+
+        reset(&st0);
+        CHECK_EQ(spi->xfer(spi->handler, seg, 4), 0);
+        delta(&st0, &d);
+        CHECK_EQ(d.xfers, 1);
+        CHECK_EQ(d.dma, 1);
+        CHECK_EQ(spim_mock_wire(&mosi), 10);
+        CHECK_EQ(mosi[0], 0x10);
+        CHECK_EQ(mosi[1], 0xFF);
+        CHECK_EQ(mosi[5], 0x20);
+        CHECK(miso_is(1, a, 4));
+        CHECK(miso_is(6, b, 4));
+    }
+
+    /* small, large, small, small: the large one alone between two DMAs */
+    {
+        const spi_seg_t seg[] = {{&h1, NULL, 1}, {NULL, big, sizeof(big)}, {&h2, NULL, 1}, {NULL, a, 4}};
+
+        reset(&st0);
+        CHECK_EQ(spi->xfer(spi->handler, seg, 4), 0);
+        delta(&st0, &d);
+        CHECK_EQ(d.dma, 3);
+        CHECK_EQ(spim_mock_wire(&mosi), 1 + sizeof(big) + 1 + 4);
+        CHECK(miso_is(1, big, sizeof(big)));
+        CHECK(miso_is(2 + sizeof(big), a, 4));
+    }
+
+    /* the bounce buffer full, one byte more */
+    {
+        const spi_seg_t seg[] = {{fill, NULL, sizeof(fill)}, {&h1, NULL, 1}};
+
+        reset(&st0);
+        CHECK_EQ(spi->xfer(spi->handler, seg, 2), 0);
+        delta(&st0, &d);
+        CHECK_EQ(d.dma, 2);
+        CHECK_EQ(spim_mock_wire(&mosi), sizeof(fill) + 1);
+        CHECK_EQ(mosi[sizeof(fill)], 0x10);
+    }
+
+    spim_mock_get_stats(&m);
+    CHECK_EQ(m.errors, 0);
+}
+
+static void check_burst(void)
+{
+    static const uint8_t hdr = 0x81;
+    spim_mock_stats_t m;
+    spi_stats_t st0, d;
+    uint8_t rd[4];
+
+    /* nested: the SPIM enabled once, until the outer end */
+    reset(&st0);
+    spi->burst_begin(spi->handler);
+    spi->burst_begin(spi->handler);
+    for (int i = 0; i < REG_READS; i++)
+    {
+        CHECK_EQ(spi->read(spi->handler, 1, &hdr, sizeof(rd), rd), 0);
+    }
+    CHECK(spim_mock_enabled());
+    spi->burst_end(spi->handler);
+    CHECK(spim_mock_enabled());
+    spi->burst_end(spi->handler);
+    CHECK(!spim_mock_enabled());
+    delta(&st0, &d);
+    CHECK_EQ(d.xfers, REG_READS);
+    CHECK_EQ(d.dma, REG_READS);
+    CHECK_EQ(d.enables, 1);
+    spim_mock_get_stats(&m);
+    CHECK_EQ(m.enables, 1);
+    CHECK_EQ(m.errors, 0);
+
+    /* an unbalanced end does not disable a port in use */
+    spi->burst_end(spi->handler);
+    CHECK_EQ(spi->read(spi->handler, 1, &hdr, sizeof(rd), rd), 0);
+    CHECK(!spim_mock_enabled());
+    spim_mock_get_stats(&m);
+    CHECK_EQ(m.errors, 0);
+}
+
+int main(void)
+{
+    spi = init_spi(&port);
+    CHECK(spi != NULL);
+    CHECK_EQ(nrf_gpio_pin_read(CS_PIN), 1);
+
+    check_read_write();
+    check_segments();
+    check_burst();
+    return test_done("spi");
+}
@@ -0,0 +1,309 @@
+/**
+ * @file    test_trace_point.c
+ *
+ * @brief   Trace points: the ring wrapping and dumped oldest first, the
+ *          24-bit timestamps, writers on several threads, and the
+ *          correlation ID of a press through its sealed SP1 payload, joined
+ *          on the dumps of both ends as tools/trace_merge.py does
+ *
+ * @author  Development Team
+ *
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#include "test.h"
+#include "host_rtos.h"
+#include "trace_point.h"
+#include "sp1_txq.h"
+#include "sp1_frame.h"
+#include "mcps_crypto.h"
+#include "reporter.h"
+
+#define OUT_MAX         (64 * (TRACE_RING_LEN + 1))
+#define WRITERS         4
+#define WRITER_FEW      (TRACE_RING_LEN / WRITERS - 4)  /**< all of them fit */
+#define WRITER_MANY     20000
+#define PRESSES         8
+#define CORR_FIRST      0xFFFB      /**< wraps to 0 on the way */
+#define ADDR_INIT       0x0001
+#define TS_MASK         0x00FFFFFFUL
+
+typedef struct
+{
+    uint32_t ts;
+    int id;
+    unsigned corr;
+    unsigned arg;
+} rec_t;
+
+static const char *const names[TRACE_ID_COUNT] = {
+    "BLOCK", "BTN_EDGE", "BTN_CONFIRM", "BTN_TASK", "SP1_ENQUEUE", "SP1_RX", "RESP_SIGNAL", "RESP_WORKER", "SERVO_SET",
+};
+
+static const uint8_t key[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+
+static char out[OUT_MAX];
+static int out_len;
+static rec_t recs[TRACE_RING_LEN + 1];
+
+static error_e report_print(char *buff, int len)
+{
+    if (out_len + len < OUT_MAX)
+    {
+        memcpy(&out[out_len], buff, len);
+        out_len += len;
+        out[out_len] = '\0';
+    }
+    return _NO_ERR;
+}
+
+reporter_t reporter_instance = {.print = report_print};
+
+/* @brief records of a trace_dump(), the count of its header */
+static int dump(bool clear, int *n_hdr)
+{
+    char name[16];
+    char *line;
+    unsigned long ts;
+    int n = 0;
+
+    out_len = 0;
+    out[0] = '\0';
+    trace_dump(clear);
+
+    line = out;
+    CHECK_EQ(sscanf(line, "TRACE: %d records, 32768 Hz", n_hdr), 1);
+    while ((line = strstr(line, "\r\n")) != NULL && line[2] != '\0')
+    {
+        rec_t *r = &recs[n];
+
+        line += 2;
+        if (n == TRACE_RING_LEN || sscanf(line, "TR %lu %15s %u %u", &ts, name, &r->corr, &r->arg) != 4)
+        {
+            CHECK(false);
+            break;
+        }
+        r->ts = (uint32_t)ts;
+        r->id = -1;
+        for (int i = 0; i < TRACE_ID_COUNT; i++)
+        {
+            if (!strcmp(name, names[i]))
+            {
+                r->id = i;
+            }
+        }
+        CHECK(r->id >= 0);
+        n++;
+    }
+    return n;
+}
+
+static void check_wrap(void)
+{
+    uint32_t total = 3 * TRACE_RING_LEN + 5;
+    int n, hdr;
+
+    /* a few: all of them */
+    for (uint32_t k = 0; k < 10; k++)
+    {
+        TRACE_POINT_AT(TRACE_BLOCK, (uint16_t)k, (uint16_t)~k, k);
+    }
+    n = dump(false, &hdr);
+    CHECK_EQ(hdr, 10);
+    CHECK_EQ(n, 10);
+    CHECK_EQ(recs[9].corr, 9);
+
+    /* cleared: none */
+    dump(true, &hdr);
+    n = dump(false, &hdr);
+    CHECK_EQ(hdr, 0);
+    CHECK_EQ(n, 0);
+
+    /* round after round: the last TRACE_RING_LEN, oldest first, the
+     * timestamps cut to the 24 bits of the Rtc */
+    for (uint32_t k = 0; k < total; k++)
+    {
+        TRACE_POINT_AT((trace_id_e)(k % TRACE_ID_COUNT), (uint16_t)k, (uint16_t)(k * 3), k * 100000);
+    }
+    n = dump(true, &hdr);
+    CHECK_EQ(hdr, TRACE_RING_LEN);
+    CHECK_EQ(n, TRACE_RING_LEN);
+    for (int j = 0; j < n; j++)
+    {
+        uint32_t k = total - TRACE_RING_LEN + j;
+
+        CHECK_EQ(recs[j].id, (int)(k % TRACE_ID_COUNT));
+        CHECK_EQ(recs[j].corr, (uint16_t)k);
+        CHECK_EQ(recs[j].arg, (uint16_t)(k * 3));
+        CHECK_EQ(recs[j].ts, (k * 100000) & TS_MASK);
+    }
+
+    /* TRACE_POINT(): the Rtc now */
+    host_time_advance_us(1000000);
+    TRACE_POINT(TRACE_SERVO_SET, 1, 2);
+    n = dump(true, &hdr);
+    CHECK_EQ(n, 1);
+    CHECK_EQ(recs[0].ts, Rtc.getTimestamp());
+}
+
+typedef struct
+{
+    pthread_t th;
+    uint16_t w;
+    uint32_t n;
+} writer_t;
+
+/* writer w: corr its index and count, arg and ts derived from them */
+static void *writer(void *arg)
+{
+    writer_t *wr = arg;
+
+    for (uint32_t s = 0; s < wr->n; s++)
+    {
+        uint16_t corr = (uint16_t)((wr->w << 12) | (s & 0xFFF));
+
+        TRACE_POINT_AT(TRACE_RESP_WORKER, corr, (uint16_t)~corr, (uint32_t)corr * 7);
+    }
+    return NULL;
+}
+
+static void run_writers(uint32_t n)
+{
+    writer_t wr[WRITERS];
+
+    for (int w = 0; w < WRITERS; w++)
+    {
+        wr[w].w = (uint16_t)w;
+        wr[w].n = n;
+        CHECK_EQ(pthread_create(&wr[w].th, NULL, writer, &wr[w]), 0);
+    }
+    for (int w = 0; w < WRITERS; w++)
+    {
+        pthread_join(wr[w].th, NULL);
+    }
+}
+
+static void check_writers(void)
+{
+    int last[WRITERS];
+    int n, hdr;
+
+    /* room for all: none lost, none mixed with another, each writer's in
+     * its order */
+    run_writers(WRITER_FEW);
+    n = dump(true, &hdr);
+    CHECK_EQ(hdr, WRITERS * WRITER_FEW);
+    CHECK_EQ(n, WRITERS * WRITER_FEW);
+    for (int w = 0; w < WRITERS; w++)
+    {
+        last[w] = -1;
+    }
+    for (int j = 0; j < n; j++)
+    {
+        int w = recs[j].corr >> 12, s = recs[j].corr & 0xFFF;
+
+        CHECK_EQ(recs[j].id, TRACE_RESP_WORKER);
+        CHECK_EQ(recs[j].arg, (uint16_t)~recs[j].corr);
+        CHECK_EQ(recs[j].ts, recs[j].corr * 7);
+        CHECK(w < WRITERS);
+        if (w < WRITERS)
+        {
+            CHECK_EQ(s, last[w] + 1);
+            last[w] = s;
+        }
+    }
+    for (int w = 0; w < WRITERS; w++)
+    {
+        CHECK_EQ(last[w], WRITER_FEW - 1);
+    }
+
+    /* the ring wrapped by all of them: a full ring of their records */
+    run_writers(WRITER_MANY);
+    n = dump(true, &hdr);
+    CHECK_EQ(hdr, TRACE_RING_LEN);
+    CHECK_EQ(n, TRACE_RING_LEN);
+    for (int j = 0; j < n; j++)
+    {
+        CHECK_EQ(recs[j].id, TRACE_RESP_WORKER);
+        CHECK((recs[j].corr >> 12) < WRITERS);
+    }
+}
+
+/* Presses of the initiator: traced, put in the SP1 frame of a block and
+ * sealed; opened by the responder, which traces the correlation ID it
+ * read. Both trace into the one ring here, the join is the same. */
+static void check_sp1_corr(void)
+{
+    static sp1_txq_t q;
+    uint8_t plain[SP1_TXQ_FRAME_MAX], frame[SP1_TXQ_FRAME_MAX + SP1_FRAME_OVERHEAD], rx[SP1_TXQ_FRAME_MAX];
+    sp1_replay_t rp = {0};
+    uint16_t corr = CORR_FIRST;
+    int n, hdr, joined = 0;
+    void *ctx;
+
+    ctx = mcps_crypto_aead_aes_ccm_star_128_create(key);
+    CHECK(ctx != NULL);
+    sp1_txq_init(&q);
+
+    for (uint32_t blk = 1; blk <= PRESSES; blk++, corr++)
+    {
+        const uint8_t *p = rx, *val;
+        uint8_t btn[SP1_BTN_LEN], type, len, counter;
+        uint16_t got;
+        uint32_t ctr;
+        int plen, flen;
+
+        TRACE_POINT(TRACE_BTN_CONFIRM, corr, 0);
+        CHECK_EQ(sp1_btn_put(btn, (uint8_t)blk, corr), SP1_BTN_LEN);
+        CHECK_EQ(sp1_txq_push(&q, blk, SP1_TLV_BTN, btn, sizeof(btn)), 0);
+        TRACE_POINT(TRACE_SP1_ENQUEUE, corr, (uint16_t)blk);
+
+        plen = sp1_txq_pack(&q, blk, plain, sizeof(plain), NULL, NULL);
+        CHECK_EQ(plen, SP1_TLV_HDR_LEN + SP1_BTN_LEN);
+        flen = sp1_frame_seal(ctx, blk, ADDR_INIT, SP1_DIR_DOWN, plain, (uint16_t)plen, frame, sizeof(frame));
+        CHECK_EQ(flen, plen + SP1_FRAME_OVERHEAD);
+        host_time_advance_us(2000);
+
+        CHECK_EQ(sp1_frame_open(ctx, &rp, ADDR_INIT, SP1_DIR_DOWN, frame, (uint16_t)flen, rx, &ctr), plen);
+        CHECK_EQ(sp1_tlv_next(&p, rx + plen, &type, &val, &len), 1);
+        CHECK_EQ(type, SP1_TLV_BTN);
+        CHECK(sp1_btn_get(val, len, &counter, &got));
+        TRACE_POINT(TRACE_SP1_RX, got, counter);
+        CHECK(!sp1_btn_get(val, SP1_BTN_LEN - 1, &counter, &got));
+    }
+    mcps_crypto_aead_aes_ccm_star_128_destroy(ctx);
+
+    /* each press of the initiator joined with the reception of the
+     * responder by its correlation ID, later, under the same counter */
+    n = dump(true, &hdr);
+    CHECK_EQ(n, 3 * PRESSES);
+    for (int i = 0; i < n; i++)
+    {
+        if (recs[i].id != TRACE_BTN_CONFIRM)
+        {
+            continue;
+        }
+        for (int j = i + 1; j < n; j++)
+        {
+            if (recs[j].id == TRACE_SP1_RX && recs[j].corr == recs[i].corr)
+            {
+                CHECK_EQ(recs[j].arg, recs[i + 1].arg);
+                CHECK(recs[j].ts > recs[i].ts);
+                joined++;
+                break;
+            }
+        }
+    }
+    CHECK_EQ(joined, PRESSES);
+}
+
+int main(void)
+{
+    check_wrap();
+    check_writers();
+    check_sp1_corr();
+    return test_done("trace_point");
+}
@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""Decode the binary ranging report stream (BINREP 1) of the FiRa app.
+
+Reads frames produced by Src/Apps/bin_report.c from a serial port or a
+captured file, checks the CRC16, and prints one JSON line per block in the
+same shape as the firmware's text output.
+
+Log frames (DLOG in Src/Apps/dlog.h) carry the flash address of their format
+string and the raw arguments; they are expanded with the strings of the
+firmware image given by --elf. Bytes outside frames are passed through.
+
+    python3 tools/bin_report_decode.py /dev/ttyACM0
+    python3 tools/bin_report_decode.py capture.bin --stats
+    python3 tools/bin_report_decode.py /dev/ttyACM0 --elf Output/Debug/Exe/app.elf
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+HDR_LEN = 5
+CRC_LEN = 2
+TYPE_BLOCK = 1
+TYPE_STOP = 2
+TYPE_LOG = 3
+TYPE_TEXT = None
+BLOCK_HDR = struct.Struct("<IBBhBBh")
+MEAS = struct.Struct("<HBBihhhBBBBH")
+STOP = struct.Struct("<IBB")
+LOG_HDR = struct.Struct("<IBB")
+FLAG_DIAG = 0x01
+FLAG_RESPONDER = 0x02
+STOP_REASONS = {0: "Stop request", 1: "Inband Stop", 2: "Max attempts"}
+LOG_MODULES = ["FIRA", "BTN", "RESP", "SERVO", "MON"]
+LOG_LEVELS = ["OFF", "ERR", "WARN", "INFO", "DBG"]
+
+
+def _reverse8(b):
+    return int("{:08b}".format(b)[::-1], 2)
+
+
+_REV = [_reverse8(i) for i in range(256)]
+_TABLE = []
+for _i in range(256):
+    _c = _i << 8
+    for _ in range(8):
+        _c = ((_c << 1) ^ (0x1021 if _c & 0x8000 else 0)) & 0xFFFF
+    _TABLE.append(_c)
+
+
+def crc16(data):
+    """Same as calc_crc16() in Src/Helpers/crc16.c."""
+    crc = 0
+    for b in data:
+        crc = (_TABLE[((crc >> 8) ^ _REV[b]) & 0xFF] ^ (crc << 8)) & 0xFFFF
+    return (_REV[crc >> 8] << 8) | _REV[crc & 0xFF]
+
+
+def q16_to_deg(v):
+    return 360.0 * v / (1 << 16)
+
+
+def decode_block(payload):
+    block, n, flags, rssi_ddbm, nlos, _ver, cfo = BLOCK_HDR.unpack_from(payload, 0)
+    out = {"Block": block, "results": []}
+    off = BLOCK_HDR.size
+    for _ in range(n):
+        (addr, status, _slot, dist_mm, lpdoa, laoa, raoa,
+         lfom, _rfom, _rssi, _sp1_len, seq) = MEAS.unpack_from(payload, off)
+        off += MEAS.size
+        res = {"Addr": "0x%04x" % addr, "Status": "Err" if status else "Ok"}
+        if status == 0:
+            res["D_cm"] = int(dist_mm / 10)
+            res["LPDoA_deg"] = round(q16_to_deg(lpdoa), 2)
+            res["LAoA_deg"] = round(q16_to_deg(laoa), 2)
+            res["LFoM"] = lfom
+            res["RAoA_deg"] = round(q16_to_deg(raoa), 2)
+            res["CFO_100ppm"] = cfo
+            if seq:
+                res["SEQ"] = seq
+        out["results"].append(res)
+    if flags & FLAG_DIAG:
+        out["RSSI_dBm"] = "%.1f" % (rssi_ddbm / 10.0) if rssi_ddbm < 0 else "Invalid"
+        out["NLOS_%"] = nlos
+    return out
+
+
+def decode_stop(payload):
+    block, reason, _ver = STOP.unpack_from(payload, 0)
+    return {"Session Stopped": STOP_REASONS.get(reason, "Unknown"), "Block": block}
+
+
+class Image:
+    """Loadable sections of the firmware ELF (32-bit little endian), by address."""
+
+    SHT_NOBITS = 8
+    SHF_ALLOC = 2
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError("%s: not a 32-bit little endian ELF" % path)
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (_name, stype, flags, addr, off, size,
+             _link, _info, _align, _entsize) = struct.unpack_from("<10I", data, shoff + i * shentsize)
+            if flags & self.SHF_ALLOC and stype != self.SHT_NOBITS and size:
+                self.sections.append((addr, data[off:off + size]))
+
+    def cstring(self, addr):
+        for base, blob in self.sections:
+            if base <= addr < base + len(blob):
+                end = blob.find(b"\0", addr - base)
+                return blob[addr - base:end if end >= 0 else None].decode("latin-1")
+        return None
+
+
+# C conversion specification, length modifiers are dropped for Python
+_CONV = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+
+def format_log(image, fmt, args):
+    """Expand a DLOG format with its 32-bit arguments like the firmware's printf."""
+    out = []
+    pos = 0
+    it = iter(args)
+    for m in _CONV.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        spec, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        v = next(it, 0)
+        if conv in "di":
+            out.append(("%" + spec + "d") % (v - (1 << 32) if v & 0x80000000 else v))
+        elif conv == "s":
+            s = image.cstring(v) if image else None
+            out.append(("%" + spec + "s") % (s if s is not None else "<0x%08x>" % v))
+        elif conv == "p":
+            out.append("0x%08x" % v)
+        elif conv == "c":
+            out.append(("%" + spec + "c") % (v & 0xFF))
+        else:
+            out.append(("%" + spec + conv) % v)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def decode_log(payload, image):
+    fmt_id, module, level = LOG_HDR.unpack_from(payload, 0)
+    n = (len(payload) - LOG_HDR.size) // 4
+    args = struct.unpack_from("<%dI" % n, payload, LOG_HDR.size)
+    fmt = image.cstring(fmt_id) if image else None
+    if fmt is None:
+        mod = LOG_MODULES[module] if module < len(LOG_MODULES) else str(module)
+        lvl = LOG_LEVELS[level] if level < len(LOG_LEVELS) else str(level)
+        return "[%s/%s] fmt=0x%08x args=%s\r\n" % (mod, lvl, fmt_id, " ".join("0x%x" % a for a in args))
+    return format_log(image, fmt, args)
+
+
+def frames(stream):
+    """Yield (type, payload, frame_len) for every frame with a valid CRC, and
+    (TYPE_TEXT, bytes, 0) for anything in between."""
+    buf = bytearray()
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                if len(buf) > 1:
+                    yield TYPE_TEXT, bytes(buf[:-1]), 0
+                del buf[:-1]
+                break
+            if start:
+                yield TYPE_TEXT, bytes(buf[:start]), 0
+            del buf[:start]
+            if len(buf) < HDR_LEN:
+                break
+            ftype = buf[2]
+            plen = buf[3] | (buf[4] << 8)
+            total = HDR_LEN + plen + CRC_LEN
+            if len(buf) < total:
+                break
+            crc = buf[HDR_LEN + plen] | (buf[HDR_LEN + plen + 1] << 8)
+            if crc16(buf[2:HDR_LEN + plen]) != crc:
+                yield TYPE_TEXT, bytes(buf[:1]), 0  # false sync, text output or corruption
+                del buf[:1]
+                continue
+            yield ftype, bytes(buf[HDR_LEN:HDR_LEN + plen]), total
+            del buf[:total]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("source", help="serial device or captured file, '-' for stdin")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--stats", action="store_true",
+                    help="print binary vs. equivalent JSON bytes per block at the end")
+    ap.add_argument("--elf", help="firmware image, expands the log frames")
+    args = ap.parse_args()
+
+    image = Image(args.elf) if args.elf else None
+
+    if args.source == "-":
+        stream = sys.stdin.buffer
+    elif args.source.startswith("/dev/"):
+        import serial  # pyserial, only needed for live capture
+        stream = serial.Serial(args.source, args.baud, timeout=None)
+    else:
+        stream = open(args.source, "rb")
+
+    blocks = bin_bytes = json_bytes = 0
+    try:
+        for ftype, payload, flen in frames(stream):
+            if ftype == TYPE_BLOCK:
+                obj = decode_block(payload)
+            elif ftype == TYPE_STOP:
+                obj = decode_stop(payload)
+            elif ftype == TYPE_LOG:
+                sys.stdout.write(decode_log(payload, image).replace("\r\n", "\n"))
+                sys.stdout.flush()
+                continue
+            elif ftype == TYPE_TEXT:
+                sys.stdout.write(payload.decode("latin-1").replace("\r\n", "\n"))
+                sys.stdout.flush()
+                continue
+            else:
+                continue
+            line = json.dumps(obj, separators=(",", ":"))
+            print(line, flush=True)
+            if ftype == TYPE_BLOCK:
+                blocks += 1
+                bin_bytes += flen
+                json_bytes += len(line) + 2  # firmware terminates with \r\n
+    except KeyboardInterrupt:
+        pass
+
+    if args.stats and blocks:
+        print("blocks=%d bin_bytes/block=%.1f json_bytes/block=%.1f ratio=%.2f"
+              % (blocks, bin_bytes / blocks, json_bytes / blocks, json_bytes / bin_bytes),
+              file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
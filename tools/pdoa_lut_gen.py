@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+"""Generate the fixed-point PDoA to path difference tables of dw3000_pdoa.c.
+
+The antenna characterizations below (PDoA in degrees, path difference in
+meters) are the source of the tables. Each one is written to
+Src/UWB/dw3000_pdoa_lut.h as:
+
+  - the breakpoints in 0.01 degree units, Q4: rounding them to 0.01 degree
+    moves the corners next to +/-90 degrees by up to 0.5 degree of AoA,
+  - the path difference divided by the antenna distance D_M_JL, Q30, not
+    clamped: fpdoa2aoa() clamps the interpolated value to +/-1,
+  - the slope of every segment, Q30 per 0.01 degree,
+  - a bucket index: the PDoA axis is cut in 2^shift wide buckets and each
+    bucket holds the segment its start falls in, so a lookup is a shift plus
+    at most a couple of compares instead of a scan.
+
+The arctangent table used to turn the ratio into an angle and the quarter
+wave sine table of the circular PDoA average are written too.
+
+    python3 tools/pdoa_lut_gen.py [-o Src/UWB/dw3000_pdoa_lut.h]
+
+Rerun it after changing a characterization and commit the output.
+"""
+
+import argparse
+import math
+import os
+
+D_M_JL = 0.017883104683497245  # dw3000_pdoa.h, antenna distance used by fpdoa2aoa()
+
+Q30 = 1 << 30
+X_FRAC_BITS = 4     # dw3000_pdoa.c PDOA_LUT_X_FRAC_BITS
+ATAN_LUT_BITS = 5   # 33 points on [0, 1], < 0.005 deg after interpolation
+BUCKET_SEGS_MAX = 2  # breakpoints allowed inside one bucket
+SIN_LUT_BITS = 6    # 65 points on [0, pi/2], < 0.01 deg of circular mean
+
+# (name, comment, xs [deg], ys [m])
+ANTENNAS = [
+    ("mon_ch5", "MONALISA CHANNEL 5, PDOA_M1",
+     [-167.451, -166.592, -165.733, -161.641,
+      -157.549, -150.116, -142.683, -134.165,
+      -125.647, -116.942, -108.238, -97.992,
+      -87.746, -75.604, -63.462, -48.720,
+      -33.978, -16.989, 0.0, 19.145,
+      38.290, 55.524, 72.759, 86.546,
+      100.333, 110.570, 120.808, 129.769,
+      138.731, 146.481, 154.231, 161.072,
+      167.913, 173.938, 179.963, 185.898,
+      191.834],
+     [-0.02277711, -0.02259527, -0.02243108, -0.02183519,
+      -0.02140348, -0.02060275, -0.01972556, -0.01864569,
+      -0.01744828, -0.01607664, -0.01464084, -0.01298905,
+      -0.01138856, -0.00954588, -0.00779023, -0.00581025,
+      -0.0039552, -0.00191495, 0.0, 0.00199575,
+      0.0039552, 0.00581256, 0.00779023, 0.00948489,
+      0.01138856, 0.01298333, 0.01464084, 0.01606225,
+      0.01744828, 0.01861804, 0.01972556, 0.02061772,
+      0.02140348, 0.02198524, 0.02243108, 0.02270353,
+      0.02277711]),
+    ("mon_ch9", "MONALISA CHANNEL 9, PDOA_M1",
+     [-169.84426, -167.11048, -158.87248000000002, -149.57176,
+      -137.69556, -119.09592, -92.6935, -62.443799999999996,
+      -33.2075, 0.0, 32.961839999999995, 64.67824,
+      88.73612, 108.79534, 124.74589999999999, 137.60603999999998,
+      147.50220000000002, 161.44412, 176.59868],
+     [-0.0178831, -0.01761142, -0.01680462, -0.01548722,
+      -0.01369925, -0.01149504, -0.00894155, -0.00611638,
+      -0.00310537, 0.0, 0.00310537, 0.00611638,
+      0.00894155, 0.01149504, 0.01369925, 0.01548722,
+      0.01680462, 0.01761142, 0.0178831]),
+    ("jolie_ch5", "JOLIE CHANNEL 5",
+     [-166.27930196, -157.0024225, -149.55838501, -142.14051332,
+      -134.46269704, -127.8210698, -120.92711554, -112.43367106,
+      -105.30918511, -96.76697129, -87.82458557, -77.72606262,
+      -66.55387036, -55.00572544, -43.65803963, -31.48916832,
+      -20.65986893, -10.09601225, 0.0, 8.59879892,
+      19.13709153, 29.43074745, 40.56982151, 52.54895667,
+      64.78731337, 78.42224659, 92.09874303, 105.79844189,
+      118.66624366, 130.41513253, 141.06896151, 150.62280441,
+      157.97588953, 164.74276625, 170.5402407, 175.70974943,
+      178.43237117],
+     [-0.0178831, -0.01781505, -0.01761142, -0.01727375,
+      -0.01680462, -0.0162076, -0.01548722, -0.01464898,
+      -0.01369925, -0.01264526, -0.01149504, -0.01025733,
+      -0.00894155, -0.00755773, -0.00611638, -0.00462849,
+      -0.00310537, -0.00155862, 0.0, 0.00155862,
+      0.00310537, 0.00462849, 0.00611638, 0.00755773,
+      0.00894155, 0.01025733, 0.01149504, 0.01264526,
+      0.01369925, 0.01464898, 0.01548722, 0.0162076,
+      0.01680462, 0.01727375, 0.01761142, 0.01781505,
+      0.0178831]),
+    ("jolie_ch9", "JOLIE CHANNEL 9",
+     [-194.26382249, -189.94444242, -185.54389927, -179.72945707,
+      -174.20326737, -166.48234994, -157.16712186, -146.40031499,
+      -134.50440281, -121.27737905, -108.1319426, -94.45667093,
+      -80.22686509, -66.92952722, -53.29020472, -40.52899653,
+      -26.72033914, -12.96053113, 0.0, 13.25819423,
+      26.3242237, 40.06032733, 52.92500285, 65.90989195,
+      77.3400328, 89.12909447, 99.33491395, 109.34396358,
+      118.4741959, 127.76385629, 136.24735635, 143.07957935,
+      149.31089476, 155.68400588, 160.27201659, 163.69689225,
+      165.76697029],
+     [-0.0178831, -0.01781505, -0.01761142, -0.01727375,
+      -0.01680462, -0.0162076, -0.01548722, -0.01464898,
+      -0.01369925, -0.01264526, -0.01149504, -0.01025733,
+      -0.00894155, -0.00755773, -0.00611638, -0.00462849,
+      -0.00310537, -0.00155862, 0.0, 0.00155862,
+      0.00310537, 0.00462849, 0.00611638, 0.00755773,
+      0.00894155, 0.01025733, 0.01149504, 0.01264526,
+      0.01369925, 0.01464898, 0.01548722, 0.0162076,
+      0.01680462, 0.01727375, 0.01761142, 0.01781505,
+      0.0178831]),
+    ("cst_chn", "CUSTOM",
+     [-182.178, -172.91577143, -163.65354286, -154.39131429,
+      -145.12908571, -135.86685714, -126.60462857, -117.3424,
+      -108.08017143, -98.81794286, -89.55571429, -80.29348571,
+      -71.03125714, -61.76902857, -52.5068, -43.24457143,
+      -33.98234286, -24.72011429, -15.45788571, -6.19565714,
+      3.06657143, 12.3288, 21.59102857, 30.85325714,
+      40.11548571, 49.37771429, 58.63994286, 67.90217143,
+      77.1644, 86.42662857, 95.68885714, 104.95108571,
+      114.21331429, 123.47554286, 132.73777143, 142.0],
+     [-0.0178831, -0.01753701, -0.01681944, -0.01530936,
+      -0.0133346, -0.01188188, -0.01064578, -0.0094633,
+      -0.008383, -0.00741476, -0.00653003, -0.00569933,
+      -0.00490387, -0.00413532, -0.00338581, -0.00264728,
+      -0.00190919, -0.00115921, -0.00038495, 0.00042524,
+      0.0012678, 0.00212467, 0.00297723, 0.00381115,
+      0.00463958, 0.00548639, 0.00637547, 0.00732847,
+      0.00836314, 0.00949486, 0.0106894, 0.01186556,
+      0.01331466, 0.01548235, 0.0166216, 0.01761142]),
+]
+
+
+def to_lut(xs, ys):
+    x = [int(round(v * 100 * (1 << X_FRAC_BITS))) for v in xs]
+    r = [int(round(v / D_M_JL * Q30)) for v in ys]
+    # slope from the rounded breakpoints, so the segments still join up
+    slope = [int(round((r[i + 1] - r[i]) * (1 << X_FRAC_BITS) / (x[i + 1] - x[i]))) for i in range(len(x) - 1)]
+
+    # widest buckets that keep the compare loop short
+    for shift in range(16, X_FRAC_BITS - 1, -1):
+        nb = ((x[-1] - x[0]) >> shift) + 1
+        bucket = []
+        worst = 0
+        for b in range(nb):
+            lo = x[0] + (b << shift)
+            hi = lo + (1 << shift)
+            seg = max(i for i in range(len(x) - 1) if x[i] <= lo)
+            bucket.append(seg)
+            worst = max(worst, sum(1 for v in x[seg + 1:-1] if v < hi))
+        if worst <= BUCKET_SEGS_MAX:
+            return x, r, slope, shift, bucket
+    raise ValueError("breakpoints too close")
+
+
+def c_array(ctype, name, values, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join("%d" % v for v in values[i:i + per_line]) + ",")
+    return "static const %s %s[] = {\n%s\n};\n" % (ctype, name, "\n".join(lines))
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("-o", "--output", default=os.path.join(here, "..", "Src", "UWB", "dw3000_pdoa_lut.h"))
+    args = ap.parse_args()
+
+    out = [
+        "/**",
+        " * @file      dw3000_pdoa_lut.h",
+        " *",
+        " * @brief     PDoA to path difference tables, fixed point",
+        " *",
+        " *            Generated by tools/pdoa_lut_gen.py, do not edit.",
+        " *",
+        " * @author    Development Team",
+        " *",
+        " */",
+        "",
+        "#ifndef DW3000_PDOA_LUT_H",
+        "#define DW3000_PDOA_LUT_H",
+        "",
+        '#include "dw3000_pdoa.h"',
+        "",
+        "/* clang-format off */",
+        "",
+        "#define PDOA_ATAN_LUT_BITS  %d" % ATAN_LUT_BITS,
+        "",
+        "/* atan(i / 2^PDOA_ATAN_LUT_BITS), rad, Q15 */",
+        c_array("uint16_t", "pdoa_atan_lut_q15",
+                [int(round(math.atan(i / (1 << ATAN_LUT_BITS)) * (1 << 15)))
+                 for i in range((1 << ATAN_LUT_BITS) + 1)], 11),
+        "#define PDOA_SIN_LUT_BITS   %d" % SIN_LUT_BITS,
+        "",
+        "/* sin(i * pi/2 / 2^PDOA_SIN_LUT_BITS), Q15 */",
+        c_array("uint16_t", "pdoa_sin_lut_q15",
+                [int(round(math.sin(i * math.pi / 2 / (1 << SIN_LUT_BITS)) * (1 << 15)))
+                 for i in range((1 << SIN_LUT_BITS) + 1)], 11),
+    ]
+
+    for name, comment, xs, ys in ANTENNAS:
+        x, r, slope, shift, bucket = to_lut(xs, ys)
+        out += [
+            "/* %s */" % comment,
+            c_array("int32_t", "pdoa_%s_x" % name, x, 8),
+            c_array("int32_t", "pdoa_%s_r" % name, r, 6),
+            c_array("int32_t", "pdoa_%s_slope" % name, slope, 8),
+            c_array("uint8_t", "pdoa_%s_bucket" % name, bucket, 20),
+            "static const struct pdoa_lut_s pdoa_lut_%s = {" % name,
+            "    .x = pdoa_%s_x," % name,
+            "    .r = pdoa_%s_r," % name,
+            "    .slope = pdoa_%s_slope," % name,
+            "    .bucket = pdoa_%s_bucket," % name,
+            "    .n = %d," % len(x),
+            "    .shift = %d," % shift,
+            "};",
+            "",
+        ]
+
+    out += ["/* clang-format on */", "", "#endif /* DW3000_PDOA_LUT_H */", ""]
+
+    with open(args.output, "w", newline="\n") as f:
+        f.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
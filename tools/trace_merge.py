@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""Merge the TRACE dumps of the initiator and the responder into a per-stage
+latency breakdown of every button press.
+
+Each board prints its trace ring with the TRACE command (Src/Apps/trace_point.c):
+
+    TR <rtc ticks> <name> <correlation id> <arg>
+
+Capture the output of both boards to files; other lines are ignored. The
+timestamps are the 24-bit, 32768 Hz RTC of each board. The two clocks are
+aligned on the BLOCK records, which both boards write in the report of the
+same ranging block: a least squares fit over the common blocks gives the
+offset and the drift. The spread of the residuals is printed: the reports of
+the two boards are a few ms apart in a block, which bounds the accuracy of
+the stages that cross from one board to the other.
+
+    python3 tools/trace_merge.py init.log resp.log
+    python3 tools/trace_merge.py init.log resp.log --csv presses.csv
+"""
+
+import argparse
+import re
+import statistics
+import sys
+
+RTC_HZ = 32768
+TS_WRAP = 1 << 24
+
+INIT_STAGES = ["BTN_EDGE", "BTN_CONFIRM", "BTN_TASK", "SP1_ENQUEUE"]
+RESP_STAGES = ["SP1_RX", "RESP_SIGNAL", "RESP_WORKER", "SERVO_SET"]
+STAGES = INIT_STAGES + RESP_STAGES
+
+LINE = re.compile(r"TR (\d+) (\w+) (\d+) (\d+)")
+
+
+def load(path):
+    """Records of a dump as (seconds, name, corr, arg), RTC wraps undone."""
+    recs = []
+    base = 0
+    prev = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = LINE.search(line)
+            if not m:
+                continue
+            ts = int(m.group(1))
+            if prev is not None and ts < prev:
+                base += TS_WRAP
+            prev = ts
+            recs.append(((base + ts) / RTC_HZ, m.group(2), int(m.group(3)), int(m.group(4))))
+    return recs
+
+
+def fit_clock(init, resp):
+    """resp_time = a * init_time + b over the blocks reported by both boards."""
+    init_blocks = {}
+    for t, name, _, arg in init:
+        if name == "BLOCK":
+            init_blocks.setdefault(arg, t)
+    pairs = [(init_blocks[arg], t) for t, name, _, arg in resp if name == "BLOCK" and arg in init_blocks]
+    if not pairs:
+        sys.exit("no common BLOCK records: dump both boards while the session runs")
+
+    xs = [p[0] for p in pairs]
+    ys = [p[1] for p in pairs]
+    if len(pairs) > 1 and max(xs) > min(xs):
+        mx, my = statistics.fmean(xs), statistics.fmean(ys)
+        a = sum((x - mx) * (y - my) for x, y in pairs) / sum((x - mx) ** 2 for x in xs)
+        b = my - a * mx
+    else:
+        a, b = 1.0, ys[0] - xs[0]
+    resid = [y - (a * x + b) for x, y in pairs]
+    return a, b, len(pairs), max(abs(r) for r in resid)
+
+
+def presses(init, resp, a, b):
+    """{corr: {stage: time on the responder clock}}, first record of each stage."""
+    out = {}
+    for recs, conv in ((init, lambda t: a * t + b), (resp, lambda t: t)):
+        for t, name, corr, _ in recs:
+            if name in STAGES:
+                out.setdefault(corr, {}).setdefault(name, conv(t))
+    return out
+
+
+def pct(vals, p):
+    vals = sorted(vals)
+    return vals[min(len(vals) - 1, int(round(p / 100 * (len(vals) - 1))))]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("init", help="TRACE dump of the initiator")
+    ap.add_argument("resp", help="TRACE dump of the responder")
+    ap.add_argument("--csv", help="write one line per press")
+    args = ap.parse_args()
+
+    init, resp = load(args.init), load(args.resp)
+    a, b, n_blocks, resid = fit_clock(init, resp)
+    print("clock: %d common blocks, drift %+.1f ppm, residual max %.2f ms" % (n_blocks, (a - 1) * 1e6, resid * 1e3))
+
+    table = presses(init, resp, a, b)
+    steps = list(zip(STAGES, STAGES[1:]))
+    deltas = {s: [] for s in steps}
+    total = []
+    rows = []
+
+    for corr in sorted(table):
+        st = table[corr]
+        row = [corr]
+        for s in steps:
+            d = (st[s[1]] - st[s[0]]) * 1e3 if s[0] in st and s[1] in st else None
+            if d is not None:
+                deltas[s].append(d)
+            row.append(d)
+        end = (st[STAGES[-1]] - st[STAGES[0]]) * 1e3 if STAGES[0] in st and STAGES[-1] in st else None
+        if end is not None:
+            total.append(end)
+        rows.append(row + [end])
+
+    print("%-26s %6s %9s %9s %9s" % ("stage", "n", "p50 ms", "p99 ms", "max ms"))
+    for s in steps:
+        v = deltas[s]
+        if v:
+            print("%-26s %6d %9.2f %9.2f %9.2f" % ("%s->%s" % s, len(v), pct(v, 50), pct(v, 99), max(v)))
+        else:
+            print("%-26s %6d" % ("%s->%s" % s, 0))
+    if total:
+        print("%-26s %6d %9.2f %9.2f %9.2f" % ("press->servo", len(total), pct(total, 50), pct(total, 99), max(total)))
+
+    if args.csv:
+        with open(args.csv, "w") as f:
+            f.write(",".join(["corr"] + ["%s->%s" % s for s in steps] + ["total"]) + "\n")
+            for row in rows:
+                f.write(",".join("" if v is None else ("%.3f" % v if isinstance(v, float) else str(v)) for v in row) + "\n")
+
+
+if __name__ == "__main__":
+    main()